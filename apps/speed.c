@@ -97,6 +97,7 @@ VirtualLock(
 #define MAX_ECDH_SIZE   256
 #define MISALIGN        64
 #define MAX_FFDH_SIZE 1024
+#define MAX_BATCH_SIG_SIZE (15360 / 8)
 
 #ifndef RSA_DEFAULT_PRIME_NUM
 # define RSA_DEFAULT_PRIME_NUM 2
@@ -133,6 +134,7 @@ static int do_multi(int multi, int size_num);
 static int domlock = 0;
 static int testmode = 0;
 static int testmoderesult = 0;
+static int batch = 1;
 
 static const int lengths_list[] = {
     16, 64, 256, 1024, 8 * 1024, 16 * 1024
@@ -236,7 +238,7 @@ typedef enum OPTION_choice {
     OPT_ELAPSED, OPT_EVP, OPT_HMAC, OPT_DECRYPT, OPT_ENGINE, OPT_MULTI,
     OPT_MR, OPT_MB, OPT_MISALIGN, OPT_ASYNCJOBS, OPT_R_ENUM, OPT_PROV_ENUM,
     OPT_CONFIG, OPT_PRIMES, OPT_SECONDS, OPT_BYTES, OPT_AEAD, OPT_CMAC,
-    OPT_MLOCK, OPT_TESTMODE, OPT_KEM, OPT_SIG
+    OPT_MLOCK, OPT_TESTMODE, OPT_KEM, OPT_SIG, OPT_DRBG, OPT_BATCH
 } OPTION_CHOICE;
 
 const OPTIONS speed_options[] = {
@@ -262,6 +264,8 @@ const OPTIONS speed_options[] = {
     {"engine", OPT_ENGINE, 's', "Use engine, possibly a hardware device"},
 #endif
     {"primes", OPT_PRIMES, 'p', "Specify number of primes (for RSA only)"},
+    {"batch", OPT_BATCH, 'p',
+     "Specify number of signatures per call (for RSA, ECDSA and EdDSA)"},
     {"mlock", OPT_MLOCK, '-', "Lock memory for better result determinism"},
     {"testmode", OPT_TESTMODE, '-', "Run the speed command in test mode"},
     OPT_CONFIG_OPTION,
@@ -270,6 +274,7 @@ const OPTIONS speed_options[] = {
     {"evp", OPT_EVP, 's', "Use EVP-named cipher or digest"},
     {"hmac", OPT_HMAC, 's', "HMAC using EVP-named digest"},
     {"cmac", OPT_CMAC, 's', "CMAC using EVP-named cipher"},
+    {"drbg", OPT_DRBG, 's', "DRBG using EVP_RAND-named random generator"},
     {"decrypt", OPT_DECRYPT, '-',
      "Time decryption instead of encryption (only EVP)"},
     {"aead", OPT_AEAD, '-',
@@ -304,7 +309,7 @@ enum {
     D_CBC_RC2, D_CBC_RC5, D_CBC_BF, D_CBC_CAST,
     D_CBC_128_AES, D_CBC_192_AES, D_CBC_256_AES,
     D_CBC_128_CML, D_CBC_192_CML, D_CBC_256_CML,
-    D_EVP, D_GHASH, D_RAND, D_EVP_CMAC, D_KMAC128, D_KMAC256,
+    D_EVP, D_GHASH, D_RAND, D_EVP_CMAC, D_KMAC128, D_KMAC256, D_DRBG,
     ALGOR_NUM
 };
 /* name of algorithms to test. MUST BE KEEP IN SYNC with above enum ! */
@@ -315,7 +320,7 @@ static const char *names[ALGOR_NUM] = {
     "rc2-cbc", "rc5-cbc", "blowfish", "cast-cbc",
     "aes-128-cbc", "aes-192-cbc", "aes-256-cbc",
     "camellia-128-cbc", "camellia-192-cbc", "camellia-256-cbc",
-    "evp", "ghash", "rand", "cmac", "kmac128", "kmac256"
+    "evp", "ghash", "rand", "cmac", "kmac128", "kmac256", "drbg(CTR-DRBG)"
 };
 
 /* list of configured algorithm (remaining), with some few alias */
@@ -359,6 +364,7 @@ static const OPT_PAIR doit_choices[] = {
     {"rand", D_RAND},
     {"kmac128", D_KMAC128},
     {"kmac256", D_KMAC256},
+    {"drbg", D_DRBG},
 };
 
 static double results[ALGOR_NUM][SIZE_NUM];
@@ -526,6 +532,11 @@ typedef struct loopargs_st {
     size_t buflen;
     size_t sigsize;
     size_t encsize;
+    unsigned char *batch_sig_malloc;
+    unsigned char **batch_sig;
+    size_t *batch_siglen;
+    const unsigned char **batch_tbs;
+    size_t *batch_tbslen;
     EVP_PKEY_CTX *rsa_sign_ctx[RSA_NUM];
     EVP_PKEY_CTX *rsa_verify_ctx[RSA_NUM];
     EVP_PKEY_CTX *rsa_encrypt_ctx[RSA_NUM];
@@ -540,6 +551,7 @@ typedef struct loopargs_st {
 #ifndef OPENSSL_NO_ECX
     EVP_MD_CTX *eddsa_ctx[EdDSA_NUM];
     EVP_MD_CTX *eddsa_ctx2[EdDSA_NUM];
+    EVP_PKEY_CTX *eddsa_verify_ctx[EdDSA_NUM];
 #endif /* OPENSSL_NO_ECX */
 #ifndef OPENSSL_NO_SM2
     EVP_MD_CTX *sm2_ctx[SM2_NUM];
@@ -556,6 +568,7 @@ typedef struct loopargs_st {
 #endif
     EVP_CIPHER_CTX *ctx;
     EVP_MAC_CTX *mctx;
+    EVP_RAND_CTX *rctx;
     EVP_PKEY_CTX *kem_gen_ctx[MAX_KEM_NUM];
     EVP_PKEY_CTX *kem_encaps_ctx[MAX_KEM_NUM];
     EVP_PKEY_CTX *kem_decaps_ctx[MAX_KEM_NUM];
@@ -581,6 +594,8 @@ static char *evp_hmac_name = NULL;
 static const char *evp_md_name = NULL;
 static char *evp_mac_ciphername = "aes-128-cbc";
 static char *evp_cmac_name = NULL;
+static char *evp_drbg_randname = "CTR-DRBG";
+static char *evp_drbg_name = NULL;
 
 static void dofail(void)
 {
@@ -621,6 +636,14 @@ static int have_cipher(const char *name)
     return ret;
 }
 
+static int have_rand(const char *name)
+{
+    EVP_RAND *rand = EVP_RAND_fetch(app_get0_libctx(), name, app_get0_propq());
+
+    EVP_RAND_free(rand);
+    return rand != NULL;
+}
+
 static int EVP_Digest_loop(const char *mdname, ossl_unused int algindex, void *args)
 {
     loopargs_t *tempargs = *(loopargs_t **) args;
@@ -868,6 +891,74 @@ static int RAND_bytes_loop(void *args)
     return count;
 }
 
+/*
+ * Instantiates a DRBG of type |name| chained to the primary DRBG for each
+ * of the |loopargs|, using AES-256 or SHA-256 (with HMAC if it takes a MAC)
+ * if it takes a cipher or a digest.
+ */
+static int drbg_setup(const char *name,
+                      loopargs_t *loopargs, unsigned int loopargs_len)
+{
+    EVP_RAND *rand;
+    EVP_RAND_CTX *parent = RAND_get0_primary(app_get0_libctx());
+    const OSSL_PARAM *settable;
+    OSSL_PARAM params[3], *p = params;
+    unsigned int i;
+    int ret = 0;
+
+    rand = EVP_RAND_fetch(app_get0_libctx(), name, app_get0_propq());
+    if (rand == NULL || parent == NULL)
+        goto end;
+
+    settable = EVP_RAND_settable_ctx_params(rand);
+    if (OSSL_PARAM_locate_const(settable, OSSL_DRBG_PARAM_MAC) != NULL)
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_MAC,
+                                                "HMAC", 0);
+    if (OSSL_PARAM_locate_const(settable, OSSL_DRBG_PARAM_CIPHER) != NULL)
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_CIPHER,
+                                                "AES-256-CTR", 0);
+    else if (OSSL_PARAM_locate_const(settable, OSSL_DRBG_PARAM_DIGEST) != NULL)
+        *p++ = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_DIGEST,
+                                                "SHA256", 0);
+    *p = OSSL_PARAM_construct_end();
+
+    for (i = 0; i < loopargs_len; i++) {
+        loopargs[i].rctx = EVP_RAND_CTX_new(rand, parent);
+        if (loopargs[i].rctx == NULL
+            || !EVP_RAND_instantiate(loopargs[i].rctx, 0, 0, NULL, 0, params))
+            goto end;
+    }
+    ret = 1;
+
+ end:
+    EVP_RAND_free(rand);
+    return ret;
+}
+
+static void drbg_teardown(loopargs_t *loopargs, unsigned int loopargs_len)
+{
+    unsigned int i;
+
+    for (i = 0; i < loopargs_len; i++) {
+        EVP_RAND_CTX_free(loopargs[i].rctx);
+        loopargs[i].rctx = NULL;
+    }
+}
+
+static int DRBG_loop(void *args)
+{
+    loopargs_t *tempargs = *(loopargs_t **) args;
+    unsigned char *buf = tempargs->buf;
+    int count;
+
+    for (count = 0; COND(c[D_DRBG][testnum]); count++) {
+        if (!EVP_RAND_generate(tempargs->rctx, buf, lengths[testnum],
+                               0, 0, NULL, 0))
+            return -1;
+    }
+    return count;
+}
+
 static int decrypt = 0;
 static int EVP_Update_loop(void *args)
 {
@@ -985,6 +1076,22 @@ static int EVP_Update_loop_aead(void *args)
     return realcount;
 }
 
+/*
+ * Sets up the batch for verifying |batch| copies of the signature |sig| of
+ * the first |tbslen| bytes of buf
+ */
+static void set_batch_signature(loopargs_t *tempargs, const unsigned char *sig,
+                                size_t siglen, size_t tbslen)
+{
+    int j;
+
+    for (j = 0; j < batch; j++) {
+        memcpy(tempargs->batch_sig[j], sig, siglen);
+        tempargs->batch_siglen[j] = siglen;
+        tempargs->batch_tbslen[j] = tbslen;
+    }
+}
+
 static int RSA_sign_loop(void *args)
 {
     loopargs_t *tempargs = *(loopargs_t **) args;
@@ -994,6 +1101,23 @@ static int RSA_sign_loop(void *args)
     EVP_PKEY_CTX **rsa_sign_ctx = tempargs->rsa_sign_ctx;
     int ret, count;
 
+    if (batch > 1) {
+        for (count = 0; COND(rsa_c[testnum][0]); count += batch) {
+            ret = EVP_PKEY_sign_batch(rsa_sign_ctx[testnum], batch,
+                                      tempargs->batch_sig,
+                                      tempargs->batch_siglen,
+                                      MAX_BATCH_SIG_SIZE, tempargs->batch_tbs,
+                                      tempargs->batch_tbslen);
+            if (ret <= 0) {
+                BIO_printf(bio_err, "RSA sign failure\n");
+                dofail();
+                count = -1;
+                break;
+            }
+        }
+        return count;
+    }
+
     for (count = 0; COND(rsa_c[testnum][0]); count++) {
         *rsa_num = tempargs->buflen;
         ret = EVP_PKEY_sign(rsa_sign_ctx[testnum], buf2, rsa_num, buf, 36);
@@ -1167,6 +1291,24 @@ static int ECDSA_verify_loop(void *args)
     EVP_PKEY_CTX **ecdsa_verify_ctx = tempargs->ecdsa_verify_ctx;
     int ret, count;
 
+    if (batch > 1) {
+        for (count = 0; COND(ecdsa_c[testnum][1]); count += batch) {
+            ret = EVP_PKEY_verify_batch(ecdsa_verify_ctx[testnum], batch,
+                                        (const unsigned char *const *)
+                                        tempargs->batch_sig,
+                                        tempargs->batch_siglen,
+                                        tempargs->batch_tbs,
+                                        tempargs->batch_tbslen, NULL);
+            if (ret <= 0) {
+                BIO_printf(bio_err, "ECDSA verify failure\n");
+                dofail();
+                count = -1;
+                break;
+            }
+        }
+        return count;
+    }
+
     for (count = 0; COND(ecdsa_c[testnum][1]); count++) {
         ret = EVP_PKEY_verify(ecdsa_verify_ctx[testnum], buf2, ecdsa_num,
                               buf, 20);
@@ -1234,6 +1376,25 @@ static int EdDSA_verify_loop(void *args)
     size_t eddsasigsize = tempargs->sigsize;
     int ret, count;
 
+    if (batch > 1) {
+        for (count = 0; COND(eddsa_c[testnum][1]); count += batch) {
+            ret = EVP_PKEY_verify_batch(tempargs->eddsa_verify_ctx[testnum],
+                                        batch,
+                                        (const unsigned char *const *)
+                                        tempargs->batch_sig,
+                                        tempargs->batch_siglen,
+                                        tempargs->batch_tbs,
+                                        tempargs->batch_tbslen, NULL);
+            if (ret != 1) {
+                BIO_printf(bio_err, "EdDSA verify failure\n");
+                dofail();
+                count = -1;
+                break;
+            }
+        }
+        return count;
+    }
+
     for (count = 0; COND(eddsa_c[testnum][1]); count++) {
         ret = EVP_DigestVerifyInit(edctx[testnum], NULL, NULL, NULL, NULL);
         if (ret == 0) {
@@ -1989,6 +2150,15 @@ int speed_main(int argc, char **argv)
             evp_mac_ciphername = opt_arg();
             doit[D_EVP_CMAC] = 1;
             break;
+        case OPT_DRBG:
+            if (!have_rand(opt_arg())) {
+                BIO_printf(bio_err, "%s: %s is an unknown random generator\n",
+                           prog, opt_arg());
+                goto end;
+            }
+            evp_drbg_randname = opt_arg();
+            doit[D_DRBG] = 1;
+            break;
         case OPT_DECRYPT:
             decrypt = 1;
             break;
@@ -2063,6 +2233,14 @@ int speed_main(int argc, char **argv)
         case OPT_PRIMES:
             primes = opt_int_arg();
             break;
+        case OPT_BATCH:
+            batch = opt_int_arg();
+            if (batch < 1 || batch > 1024) {
+                BIO_printf(bio_err, "%s: batch size must be 1 to 1024\n",
+                           prog);
+                goto end;
+            }
+            break;
         case OPT_SECONDS:
             seconds.sym = seconds.rsa = seconds.dsa = seconds.ecdsa
                         = seconds.ecdh = seconds.eddsa
@@ -2421,6 +2599,26 @@ int speed_main(int argc, char **argv)
         loopargs[i].buf2 = loopargs[i].buf2_malloc + misalign;
         loopargs[i].buflen = buflen - misalign;
         loopargs[i].sigsize = buflen - misalign;
+        if (batch > 1) {
+            int j;
+
+            loopargs[i].batch_sig_malloc =
+                app_malloc(batch * MAX_BATCH_SIG_SIZE, "batch signatures");
+            loopargs[i].batch_sig =
+                app_malloc(batch * sizeof(unsigned char *), "batch");
+            loopargs[i].batch_siglen =
+                app_malloc(batch * sizeof(size_t), "batch");
+            loopargs[i].batch_tbs =
+                app_malloc(batch * sizeof(unsigned char *), "batch");
+            loopargs[i].batch_tbslen =
+                app_malloc(batch * sizeof(size_t), "batch");
+            for (j = 0; j < batch; j++) {
+                loopargs[i].batch_sig[j] =
+                    loopargs[i].batch_sig_malloc + j * MAX_BATCH_SIG_SIZE;
+                loopargs[i].batch_tbs[j] = loopargs[i].buf;
+                loopargs[i].batch_tbslen[j] = 36;
+            }
+        }
         loopargs[i].secret_a = app_malloc(MAX_ECDH_SIZE, "ECDH secret a");
         loopargs[i].secret_b = app_malloc(MAX_ECDH_SIZE, "ECDH secret b");
 #ifndef OPENSSL_NO_DH
@@ -2453,7 +2651,7 @@ int speed_main(int argc, char **argv)
 
     /* No parameters; turn on everything. */
     if (argc == 0 && !doit[D_EVP] && !doit[D_HMAC]
-        && !doit[D_EVP_CMAC] && !do_kems && !do_sigs) {
+        && !doit[D_EVP_CMAC] && !doit[D_DRBG] && !do_kems && !do_sigs) {
         memset(doit, 1, sizeof(doit));
         doit[D_EVP] = doit[D_EVP_CMAC] = 0;
         ERR_set_mark();
@@ -2479,6 +2677,8 @@ int speed_main(int argc, char **argv)
         } else {
             doit[D_HMAC] = 0;
         }
+        if (!have_rand(evp_drbg_randname))
+            doit[D_DRBG] = 0;
         ERR_pop_to_mark();
         memset(rsa_doit, 1, sizeof(rsa_doit));
 #ifndef OPENSSL_NO_DH
@@ -2973,6 +3173,30 @@ int speed_main(int argc, char **argv)
         mac_teardown(&mac, loopargs, loopargs_len);
     }
 
+    if (doit[D_DRBG]) {
+        evp_drbg_name = app_malloc(sizeof("drbg()")
+                                   + strlen(evp_drbg_randname), "DRBG name");
+        sprintf(evp_drbg_name, "drbg(%s)", evp_drbg_randname);
+        names[D_DRBG] = evp_drbg_name;
+
+        if (!drbg_setup(evp_drbg_randname, loopargs, loopargs_len)) {
+            BIO_printf(bio_err, "Cannot set up %s\n", evp_drbg_randname);
+            dofail();
+            drbg_teardown(loopargs, loopargs_len);
+            goto end;
+        }
+        for (testnum = 0; testnum < size_num; testnum++) {
+            print_message(names[D_DRBG], lengths[testnum], seconds.sym);
+            Time_F(START);
+            count = run_benchmark(async_jobs, DRBG_loop, loopargs);
+            d = Time_F(STOP);
+            print_result(D_DRBG, testnum, count, d);
+            if (count < 0)
+                break;
+        }
+        drbg_teardown(loopargs, loopargs_len);
+    }
+
     for (i = 0; i < loopargs_len; i++)
         if (RAND_bytes(loopargs[i].buf, 36) <= 0)
             goto end;
@@ -3263,6 +3487,9 @@ int speed_main(int argc, char **argv)
                                    loopargs[i].sigsize,
                                    loopargs[i].buf, 20) <= 0)
                 st = 0;
+            else if (batch > 1)
+                set_batch_signature(&loopargs[i], loopargs[i].buf2,
+                                    loopargs[i].sigsize, 20);
         }
         if (!st) {
             BIO_printf(bio_err,
@@ -3419,6 +3646,25 @@ int speed_main(int argc, char **argv)
                 EVP_PKEY_free(ed_pkey);
                 break;
             }
+            if (batch > 1) {
+                EVP_SIGNATURE *ed_sig =
+                    EVP_SIGNATURE_fetch(app_get0_libctx(),
+                                        ed_curves[testnum].name,
+                                        app_get0_propq());
+
+                loopargs[i].eddsa_verify_ctx[testnum] =
+                    EVP_PKEY_CTX_new(ed_pkey, NULL);
+                if (ed_sig == NULL
+                    || loopargs[i].eddsa_verify_ctx[testnum] == NULL
+                    || EVP_PKEY_verify_message_init(loopargs[i].eddsa_verify_ctx[testnum],
+                                                    ed_sig, NULL) <= 0)
+                    st = 0;
+                EVP_SIGNATURE_free(ed_sig);
+                if (st == 0) {
+                    EVP_PKEY_free(ed_pkey);
+                    break;
+                }
+            }
 
             EVP_PKEY_free(ed_pkey);
             ed_pkey = NULL;
@@ -3464,6 +3710,9 @@ int speed_main(int argc, char **argv)
                                       loopargs[i].buf, 20);
                 if (st != 1)
                     break;
+                if (batch > 1)
+                    set_batch_signature(&loopargs[i], loopargs[i].buf2,
+                                        loopargs[i].sigsize, 20);
             }
             if (st != 1) {
                 BIO_printf(bio_err,
@@ -4417,6 +4666,11 @@ int speed_main(int argc, char **argv)
     for (i = 0; i < loopargs_len; i++) {
         OPENSSL_free(loopargs[i].buf_malloc);
         OPENSSL_free(loopargs[i].buf2_malloc);
+        OPENSSL_free(loopargs[i].batch_sig_malloc);
+        OPENSSL_free(loopargs[i].batch_sig);
+        OPENSSL_free(loopargs[i].batch_siglen);
+        OPENSSL_free(loopargs[i].batch_tbs);
+        OPENSSL_free(loopargs[i].batch_tbslen);
 
         BN_free(bn);
         EVP_PKEY_CTX_free(genctx);
@@ -4448,6 +4702,7 @@ int speed_main(int argc, char **argv)
         for (k = 0; k < EdDSA_NUM; k++) {
             EVP_MD_CTX_free(loopargs[i].eddsa_ctx[k]);
             EVP_MD_CTX_free(loopargs[i].eddsa_ctx2[k]);
+            EVP_PKEY_CTX_free(loopargs[i].eddsa_verify_ctx[k]);
         }
 #endif /* OPENSSL_NO_ECX */
 #ifndef OPENSSL_NO_SM2
@@ -4487,6 +4742,7 @@ int speed_main(int argc, char **argv)
     }
     OPENSSL_free(evp_hmac_name);
     OPENSSL_free(evp_cmac_name);
+    OPENSSL_free(evp_drbg_name);
     for (k = 0; k < kems_algs_len; k++)
         OPENSSL_free(kems_algname[k]);
     if (kem_stack != NULL)
@@ -1,5 +1,5 @@
 /*
- * Copyright 2005-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2005-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -29,6 +29,10 @@
 #  define IP_MTU      14        /* linux is lame */
 # endif
 
+# if defined(OPENSSL_SYS_LINUX)
+#  include <netinet/udp.h>
+# endif
+
 # if OPENSSL_USE_IPV6 && !defined(IPPROTO_IPV6)
 #  define IPPROTO_IPV6 41       /* windows is lame */
 # endif
@@ -127,16 +131,32 @@
 #   else
 #     define BIO_CMSG_ALLOC_LEN_3   0
 #   endif
+#   if defined(UDP_SEGMENT)
+    /* A UDP segment size may accompany the local address */
+#     define BIO_CMSG_ALLOC_LEN_4   BIO_CMSG_SPACE(sizeof(int))
+#   else
+#     define BIO_CMSG_ALLOC_LEN_4   0
+#   endif
 #   define BIO_MAX(X,Y) ((X) > (Y) ? (X) : (Y))
 #   define BIO_CMSG_ALLOC_LEN                                        \
-        BIO_MAX(BIO_CMSG_ALLOC_LEN_1,                                \
-                BIO_MAX(BIO_CMSG_ALLOC_LEN_2, BIO_CMSG_ALLOC_LEN_3))
+        (BIO_MAX(BIO_CMSG_ALLOC_LEN_1,                               \
+                 BIO_MAX(BIO_CMSG_ALLOC_LEN_2, BIO_CMSG_ALLOC_LEN_3)) \
+         + BIO_CMSG_ALLOC_LEN_4)
 #  endif
 #  if (defined(IP_PKTINFO) || defined(IP_RECVDSTADDR)) && defined(IPV6_RECVPKTINFO)
 #   define SUPPORT_LOCAL_ADDR
 #  endif
 # endif
 
+/*
+ * UDP generic segmentation offload (sending several datagrams of the same
+ * size as a single buffer) and its receive side counterpart.
+ */
+# if defined(OPENSSL_SYS_LINUX) && defined(UDP_SEGMENT) && defined(UDP_GRO) \
+    && (M_METHOD == M_METHOD_RECVMMSG || M_METHOD == M_METHOD_RECVMSG)
+#  define SUPPORT_UDP_SEGMENT
+# endif
+
 # define BIO_MSG_N(array, stride, n) (*(BIO_MSG *)((char *)(array) + (n)*(stride)))
 
 static int dgram_write(BIO *h, const char *buf, int num);
@@ -216,6 +236,8 @@ typedef struct bio_dgram_data_st {
     OSSL_TIME socket_timeout;
     unsigned int peekmode;
     char local_addr_enabled;
+    char gso_enabled;
+    char gro_enabled;
 } bio_dgram_data;
 
 # ifndef OPENSSL_NO_SCTP
@@ -544,6 +566,17 @@ static int enable_local_addr(BIO *b, int enable) {
 }
 # endif
 
+# if defined(SUPPORT_UDP_SEGMENT)
+/* Determines whether the socket is a UDP socket knowing the given option. */
+static int udp_opt_supported(BIO *b, int opt)
+{
+    int val = 0;
+    socklen_t len = sizeof(val);
+
+    return getsockopt(b->num, IPPROTO_UDP, opt, &val, &len) == 0;
+}
+# endif
+
 static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
 {
     long ret = 1;
@@ -999,6 +1032,62 @@ static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
         *(int *)ptr = data->local_addr_enabled;
         break;
 
+    case BIO_CTRL_DGRAM_GET_GSO_CAP:
+# if defined(SUPPORT_UDP_SEGMENT)
+        ret = udp_opt_supported(b, UDP_SEGMENT);
+# else
+        ret = 0;
+# endif
+        break;
+
+    case BIO_CTRL_DGRAM_SET_GSO_ENABLE:
+# if defined(SUPPORT_UDP_SEGMENT)
+        /* The segment size is passed with each message, nothing to set up */
+        num = num > 0;
+        if (num && !udp_opt_supported(b, UDP_SEGMENT)) {
+            ret = 0;
+            break;
+        }
+        data->gso_enabled = (char)num;
+# else
+        ret = 0;
+# endif
+        break;
+
+    case BIO_CTRL_DGRAM_GET_GSO_ENABLE:
+        *(int *)ptr = data->gso_enabled;
+        break;
+
+    case BIO_CTRL_DGRAM_GET_GRO_CAP:
+# if defined(SUPPORT_UDP_SEGMENT)
+        ret = udp_opt_supported(b, UDP_GRO);
+# else
+        ret = 0;
+# endif
+        break;
+
+    case BIO_CTRL_DGRAM_SET_GRO_ENABLE:
+# if defined(SUPPORT_UDP_SEGMENT)
+        num = num > 0;
+        if (num != data->gro_enabled) {
+            sockopt_val = (int)num;
+            if (setsockopt(b->num, IPPROTO_UDP, UDP_GRO,
+                           &sockopt_val, sizeof(sockopt_val)) < 0) {
+                ret = 0;
+                break;
+            }
+
+            data->gro_enabled = (char)num;
+        }
+# else
+        ret = 0;
+# endif
+        break;
+
+    case BIO_CTRL_DGRAM_GET_GRO_ENABLE:
+        *(int *)ptr = data->gro_enabled;
+        break;
+
     case BIO_CTRL_DGRAM_GET_EFFECTIVE_CAPS:
         ret = (long)(BIO_DGRAM_CAP_HANDLES_DST_ADDR
                      | BIO_DGRAM_CAP_HANDLES_SRC_ADDR
@@ -1300,6 +1389,71 @@ static int pack_local(BIO *b, MSGHDR_TYPE *mh, const BIO_ADDR *local) {
 }
 # endif
 
+# if defined(SUPPORT_UDP_SEGMENT)
+/*
+ * Attaches a UDP_SEGMENT control message after any control message already
+ * packed if the message carries a segment size and GSO is enabled, so that
+ * the kernel splits it into several datagrams.
+ */
+static void pack_segment(BIO *b, struct msghdr *mh, unsigned char *control,
+                         const BIO_MSG *msg)
+{
+    bio_dgram_data *data = b->ptr;
+    size_t off = mh->msg_control != NULL ? mh->msg_controllen : 0;
+    size_t seg = (size_t)(msg->flags & BIO_MSG_SEGMENT_SIZE_MASK);
+    uint16_t val = (uint16_t)seg;
+    struct cmsghdr *cmsg;
+
+    if (!data->gso_enabled || seg == 0 || seg >= msg->data_len)
+        return;
+
+    cmsg = (struct cmsghdr *)(control + off);
+    cmsg->cmsg_len   = BIO_CMSG_LEN(sizeof(val));
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type  = UDP_SEGMENT;
+    memcpy(BIO_CMSG_DATA(cmsg), &val, sizeof(val));
+
+    mh->msg_control    = control;
+    mh->msg_controllen = off + BIO_CMSG_SPACE(sizeof(val));
+}
+
+/* Makes room for a UDP_GRO control message if GRO is enabled. */
+static void prepare_segment(BIO *b, struct msghdr *mh, unsigned char *control)
+{
+    bio_dgram_data *data = b->ptr;
+
+    if (data->gro_enabled && mh->msg_control == NULL) {
+        mh->msg_control    = control;
+        mh->msg_controllen = BIO_CMSG_ALLOC_LEN;
+    }
+}
+
+/*
+ * Extracts the segment size of a message coalesced by GRO from the control
+ * buffer, or 0 if it was received as a single datagram.
+ */
+static uint64_t extract_segment(BIO *b, struct msghdr *mh)
+{
+    bio_dgram_data *data = b->ptr;
+    struct cmsghdr *cmsg;
+    int val;
+
+    if (!data->gro_enabled)
+        return 0;
+
+    for (cmsg = BIO_CMSG_FIRSTHDR(mh); cmsg != NULL;
+         cmsg = BIO_CMSG_NXTHDR(mh, cmsg)) {
+        if (cmsg->cmsg_level != IPPROTO_UDP || cmsg->cmsg_type != UDP_GRO)
+            continue;
+
+        memcpy(&val, BIO_CMSG_DATA(cmsg), sizeof(val));
+        return val > 0 ? (uint64_t)val & BIO_MSG_SEGMENT_SIZE_MASK : 0;
+    }
+
+    return 0;
+}
+# endif
+
 /*
  * Converts flags passed to BIO_sendmmsg or BIO_recvmmsg to syscall flags. You
  * should mask out any system flags returned by this function you cannot support
@@ -1388,6 +1542,9 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
                 return 0;
             }
         }
+#  if defined(SUPPORT_UDP_SEGMENT)
+        pack_segment(b, &mh[i].msg_hdr, control[i], &BIO_MSG_N(msg, stride, i));
+#  endif
     }
 
     /* Do the batch */
@@ -1425,6 +1582,9 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
             return 0;
         }
     }
+#  if defined(SUPPORT_UDP_SEGMENT)
+    pack_segment(b, &mh, control, msg);
+#  endif
 
     l = sendmsg(b->num, &mh, sysflags);
     if (l < 0) {
@@ -1581,6 +1741,9 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
             *num_processed = 0;
             return 0;
         }
+#  if defined(SUPPORT_UDP_SEGMENT)
+        prepare_segment(b, &mh[i].msg_hdr, control[i]);
+#  endif
     }
 
     /* Do the batch */
@@ -1593,7 +1756,11 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
 
     for (i = 0; i < (size_t)ret; ++i) {
         BIO_MSG_N(msg, stride, i).data_len = mh[i].msg_len;
+#  if defined(SUPPORT_UDP_SEGMENT)
+        BIO_MSG_N(msg, stride, i).flags    = extract_segment(b, &mh[i].msg_hdr);
+#  else
         BIO_MSG_N(msg, stride, i).flags    = 0;
+#  endif
         /*
          * *(msg->peer) will have been filled in by recvmmsg;
          * for msg->local we parse the control data returned
@@ -1629,6 +1796,9 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
         *num_processed = 0;
         return 0;
     }
+#  if defined(SUPPORT_UDP_SEGMENT)
+    prepare_segment(b, &mh, control);
+#  endif
 
     l = recvmsg(b->num, &mh, sysflags);
     if (l < 0) {
@@ -1638,7 +1808,11 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
     }
 
     msg->data_len   = (size_t)l;
+#  if defined(SUPPORT_UDP_SEGMENT)
+    msg->flags      = extract_segment(b, &mh);
+#  else
     msg->flags      = 0;
+#  endif
 
     if (msg->local != NULL)
         if (extract_local(b, &mh, msg->local) < 1)
@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -30,6 +30,9 @@ struct ossl_lib_ctx_st {
     void *global_properties;
     void *drbg;
     void *drbg_nonce;
+#ifndef OPENSSL_NO_EC
+    void *ec_pre_comp;
+#endif
     CRYPTO_THREAD_LOCAL rcu_local_key;
 #ifndef FIPS_MODULE
     void *provider_conf;
@@ -41,6 +44,9 @@ struct ossl_lib_ctx_st {
     OSSL_METHOD_STORE *store_loader_store;
     void *self_test_cb;
     void *indicator_cb;
+# ifndef OPENSSL_NO_THREAD_FETCH_CACHE
+    void *evp_fetch_cache;
+# endif
 #endif
 #if defined(OPENSSL_THREADS)
     void *threads;
@@ -107,6 +113,13 @@ static int context_init(OSSL_LIB_CTX *ctx)
     ctx->provider_conf = ossl_prov_conf_ctx_new(ctx);
     if (ctx->provider_conf == NULL)
         goto err;
+
+# ifndef OPENSSL_NO_THREAD_FETCH_CACHE
+    /* P2. Holds method references, so must go before the provider store */
+    ctx->evp_fetch_cache = ossl_evp_fetch_cache_new(ctx);
+    if (ctx->evp_fetch_cache == NULL)
+        goto err;
+# endif
 #endif
 
     /* P2. */
@@ -169,6 +182,12 @@ static int context_init(OSSL_LIB_CTX *ctx)
     if (ctx->drbg_nonce == NULL)
         goto err;
 
+#ifndef OPENSSL_NO_EC
+    ctx->ec_pre_comp = ossl_ec_pre_comp_cache_new(ctx);
+    if (ctx->ec_pre_comp == NULL)
+        goto err;
+#endif
+
 #ifndef FIPS_MODULE
     ctx->self_test_cb = ossl_self_test_set_callback_new(ctx);
     if (ctx->self_test_cb == NULL)
@@ -244,6 +263,14 @@ static void context_deinit_objs(OSSL_LIB_CTX *ctx)
         ctx->provider_conf = NULL;
     }
 
+# ifndef OPENSSL_NO_THREAD_FETCH_CACHE
+    /* P2. */
+    if (ctx->evp_fetch_cache != NULL) {
+        ossl_evp_fetch_cache_free(ctx->evp_fetch_cache);
+        ctx->evp_fetch_cache = NULL;
+    }
+# endif
+
     /*
      * P2. We want decoder_store/decoder_cache to be cleaned up before the
      * provider store
@@ -310,6 +337,13 @@ static void context_deinit_objs(OSSL_LIB_CTX *ctx)
         ctx->drbg_nonce = NULL;
     }
 
+#ifndef OPENSSL_NO_EC
+    if (ctx->ec_pre_comp != NULL) {
+        ossl_ec_pre_comp_cache_free(ctx->ec_pre_comp);
+        ctx->ec_pre_comp = NULL;
+    }
+#endif
+
 #ifndef FIPS_MODULE
     if (ctx->indicator_cb != NULL) {
         ossl_indicator_set_callback_free(ctx->indicator_cb);
@@ -581,6 +615,10 @@ void *ossl_lib_ctx_get_data(OSSL_LIB_CTX *ctx, int index)
         return ctx->drbg;
     case OSSL_LIB_CTX_DRBG_NONCE_INDEX:
         return ctx->drbg_nonce;
+#ifndef OPENSSL_NO_EC
+    case OSSL_LIB_CTX_EC_PRE_COMP_INDEX:
+        return ctx->ec_pre_comp;
+#endif
 #ifndef FIPS_MODULE
     case OSSL_LIB_CTX_PROVIDER_CONF_INDEX:
         return ctx->provider_conf;
@@ -600,6 +638,10 @@ void *ossl_lib_ctx_get_data(OSSL_LIB_CTX *ctx, int index)
         return ctx->self_test_cb;
     case OSSL_LIB_CTX_INDICATOR_CB_INDEX:
         return ctx->indicator_cb;
+# ifndef OPENSSL_NO_THREAD_FETCH_CACHE
+    case OSSL_LIB_CTX_EVP_FETCH_CACHE_INDEX:
+        return ctx->evp_fetch_cache;
+# endif
 #endif
 #ifndef OPENSSL_NO_THREAD_POOL
     case OSSL_LIB_CTX_THREAD_INDEX:
@@ -1,5 +1,5 @@
 /*
- * Copyright 2001-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2001-2025 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright (c) 2002, Oracle and/or its affiliates. All rights reserved
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
@@ -359,6 +359,24 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
 int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *);
 int ossl_ec_wNAF_have_precompute_mult(const EC_GROUP *group);
 
+/*
+ * Multi-scalar multiplication with Pippenger's bucket method, in ec_mult.c.
+ * It is not constant time, and is used instead of interleaved wNAF when at
+ * least EC_PIPPENGER_MIN_POINTS points are to be multiplied, which only
+ * happens with public scalars. On the generic GFp methods, in an optimised
+ * build, the bucket method overtakes wNAF at about 80 points on P-256 and
+ * breaks even with it from 128 to about 224 points on P-384.
+ */
+# define EC_PIPPENGER_MIN_POINTS 128
+# define EC_PIPPENGER_MAX_WINDOW 14
+int ossl_ec_pippenger_mul(const EC_GROUP *group, EC_POINT *r,
+                          const BIGNUM *scalar, size_t num,
+                          const EC_POINT *points[], const BIGNUM *scalars[],
+                          BN_CTX *ctx);
+size_t ossl_ec_pippenger_window_bits(size_t num, int bits);
+int ossl_ec_pippenger_recode(int *digits, size_t numdigits, size_t w,
+                             const BIGNUM *scalar);
+
 /* method functions in ecp_smpl.c */
 int ossl_ec_GFp_simple_group_init(EC_GROUP *);
 void ossl_ec_GFp_simple_group_finish(EC_GROUP *);
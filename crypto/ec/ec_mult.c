@@ -1,5 +1,5 @@
 /*
- * Copyright 2001-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2001-2025 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright (c) 2002, Oracle and/or its affiliates. All rights reserved
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
@@ -21,6 +21,7 @@
 #include "crypto/bn.h"
 #include "ec_local.h"
 #include "internal/refcount.h"
+#include "crypto/context.h"
 
 /*
  * This file implements the wNAF-based interleaving multi-exponentiation method
@@ -47,6 +48,9 @@ struct ec_pre_comp_st {
     CRYPTO_REF_COUNT references;
 };
 
+static EC_PRE_COMP *ec_pre_comp_get(const EC_GROUP *group, int create,
+                                    BN_CTX *ctx);
+
 static EC_PRE_COMP *ec_pre_comp_new(const EC_GROUP *group)
 {
     EC_PRE_COMP *ret = NULL;
@@ -424,6 +428,7 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
     EC_POINT ***val_sub = NULL; /* pointers to sub-arrays of 'val' or
                                  * 'pre_comp->points' */
     const EC_PRE_COMP *pre_comp = NULL;
+    EC_PRE_COMP *shared_pre_comp = NULL;
     int num_scalar = 0;         /* flag: will be set to 1 if 'scalar' must be
                                  * treated like other scalars, i.e.
                                  * precomputation is not available */
@@ -459,6 +464,14 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
         }
     }
 
+    /*
+     * With many points, the bucket method beats interleaving their wNAFs by
+     * far, even with precomputed multiples of the generator.
+     */
+    if (num + (scalar != NULL ? 1 : 0) >= EC_PIPPENGER_MIN_POINTS)
+        return ossl_ec_pippenger_mul(group, r, scalar, num, points, scalars,
+                                     ctx);
+
     if (scalar != NULL) {
         generator = EC_GROUP_get0_generator(group);
         if (generator == NULL) {
@@ -466,9 +479,17 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
             goto err;
         }
 
-        /* look if we can use precomputed multiples of generator */
+        /*
+         * look if we can use precomputed multiples of generator, either the
+         * group's own or ones done for another group for the same curve
+         */
 
         pre_comp = group->pre_comp.ec;
+        if (pre_comp == NULL) {
+            ERR_set_mark();
+            pre_comp = shared_pre_comp = ec_pre_comp_get(group, 0, ctx);
+            ERR_pop_to_mark();
+        }
         if (pre_comp && pre_comp->numblocks
             && (EC_POINT_cmp(group, generator, pre_comp->points[0], ctx) ==
                 0)) {
@@ -793,11 +814,215 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
         OPENSSL_free(val);
     }
     OPENSSL_free(val_sub);
+    EC_ec_pre_comp_free(shared_pre_comp);
     return ret;
 }
 
 /*-
- * ossl_ec_wNAF_precompute_mult()
+ * Returns the window size, in bits, for which the bucket method needs the
+ * fewest point additions to multiply num points by scalars of up to bits bits:
+ * each of the bits / w + 1 windows takes one addition per point, and two per
+ * bucket to sum the 2^(w-1) buckets up.
+ */
+size_t ossl_ec_pippenger_window_bits(size_t num, int bits)
+{
+    size_t w, best_w = 2, cost, best_cost = SIZE_MAX;
+
+    for (w = 2; w <= EC_PIPPENGER_MAX_WINDOW; w++) {
+        cost = ((size_t)bits / w + 1) * (num + ((size_t)1 << w));
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_w = w;
+        }
+    }
+    return best_w;
+}
+
+/*-
+ * Recodes |scalar| into numdigits signed digits of w bits each, such that
+ *      scalar = \sum digits[j] * 2^(j*w)
+ * with -2^(w-1) <= digits[j] <= 2^(w-1), so that buckets are only needed for
+ * the multiples 1 to 2^(w-1) of each point.
+ * Returns 0 if |scalar| is too long for numdigits digits.
+ */
+int ossl_ec_pippenger_recode(int *digits, size_t numdigits, size_t w,
+                             const BIGNUM *scalar)
+{
+    int sign = BN_is_negative(scalar) ? -1 : 1;
+    int carry = 0, d;
+    size_t j, k;
+
+    if ((size_t)BN_num_bits(scalar) >= numdigits * w)
+        return 0;
+
+    for (j = 0; j < numdigits; j++) {
+        d = carry;
+        for (k = 0; k < w; k++)
+            if (BN_is_bit_set(scalar, (int)(j * w + k)))
+                d += 1 << k;
+        carry = d > (1 << (w - 1));
+        if (carry)
+            d -= 1 << w;
+        digits[j] = sign * d;
+    }
+    return 1;
+}
+
+/*-
+ * Compute
+ *      \sum scalars[i]*points[i],
+ * also including
+ *      scalar*generator
+ * in the addition if scalar != NULL, with Pippenger's bucket method.
+ *
+ * For each window of w bits, from the most significant one down, every
+ * point is added to the bucket for its digit in that window, and the
+ * buckets are summed up with their multiples in 2 * 2^(w-1) additions.
+ * With enough points, this takes far fewer additions per point than
+ * ossl_ec_wNAF_mul() does, and needs no precomputation per point.
+ *
+ * This is not constant time, so it must only be used for public scalars.
+ */
+int ossl_ec_pippenger_mul(const EC_GROUP *group, EC_POINT *r,
+                          const BIGNUM *scalar, size_t num,
+                          const EC_POINT *points[], const BIGNUM *scalars[],
+                          BN_CTX *ctx)
+{
+    const EC_POINT *generator = NULL;
+    size_t totalnum = num + (scalar != NULL ? 1 : 0);
+    size_t w, numdigits, numbuckets, i, j, k, b;
+    int bits = 0, d, ret = 0;
+    int *digits = NULL;
+    EC_POINT **val = NULL;      /* the points, followed by their inverses */
+    EC_POINT **buckets = NULL;
+    unsigned char *used = NULL;
+    EC_POINT *sum = NULL, *acc = NULL;
+
+    if (scalar != NULL) {
+        generator = EC_GROUP_get0_generator(group);
+        if (generator == NULL) {
+            ERR_raise(ERR_LIB_EC, EC_R_UNDEFINED_GENERATOR);
+            return 0;
+        }
+    }
+    if (totalnum == 0)
+        return EC_POINT_set_to_infinity(group, r);
+
+    for (i = 0; i < totalnum; i++) {
+        d = BN_num_bits(i < num ? scalars[i] : scalar);
+        if (d > bits)
+            bits = d;
+    }
+    w = ossl_ec_pippenger_window_bits(totalnum, bits);
+    numdigits = (size_t)bits / w + 1;
+    numbuckets = (size_t)1 << (w - 1);
+
+    if (totalnum > SIZE_MAX / (2 * sizeof(*val))
+        || totalnum > SIZE_MAX / (numdigits * sizeof(*digits))) {
+        ERR_raise(ERR_LIB_EC, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    digits = OPENSSL_malloc(totalnum * numdigits * sizeof(*digits));
+    val = OPENSSL_zalloc(2 * totalnum * sizeof(*val));
+    buckets = OPENSSL_zalloc(numbuckets * sizeof(*buckets));
+    used = OPENSSL_malloc(numbuckets);
+    sum = EC_POINT_new(group);
+    acc = EC_POINT_new(group);
+    if (digits == NULL || val == NULL || buckets == NULL || used == NULL
+        || sum == NULL || acc == NULL)
+        goto err;
+
+    for (i = 0; i < totalnum; i++) {
+        if (!ossl_ec_pippenger_recode(digits + i * numdigits, numdigits, w,
+                                      i < num ? scalars[i] : scalar)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+        val[i] = EC_POINT_dup(i < num ? points[i] : generator, group);
+        if (val[i] == NULL)
+            goto err;
+    }
+
+    /* Adding affine points into the buckets is cheaper */
+    if (!EC_POINTs_make_affine(group, totalnum, val, ctx))
+        goto err;
+
+    for (i = 0; i < totalnum; i++) {
+        val[totalnum + i] = EC_POINT_dup(val[i], group);
+        if (val[totalnum + i] == NULL
+            || !EC_POINT_invert(group, val[totalnum + i], ctx))
+            goto err;
+    }
+    for (b = 0; b < numbuckets; b++)
+        if ((buckets[b] = EC_POINT_new(group)) == NULL)
+            goto err;
+
+    if (!EC_POINT_set_to_infinity(group, r))
+        goto err;
+
+    for (j = numdigits; j-- > 0;) {
+        for (k = 0; k < w && !EC_POINT_is_at_infinity(group, r); k++)
+            if (!EC_POINT_dbl(group, r, r, ctx))
+                goto err;
+
+        memset(used, 0, numbuckets);
+        for (i = 0; i < totalnum; i++) {
+            const EC_POINT *p;
+
+            d = digits[i * numdigits + j];
+            if (d == 0)
+                continue;
+            p = d > 0 ? val[i] : val[totalnum + i];
+            b = (size_t)(d > 0 ? d : -d) - 1;
+            if (!used[b]) {
+                if (!EC_POINT_copy(buckets[b], p))
+                    goto err;
+                used[b] = 1;
+            } else if (!EC_POINT_add(group, buckets[b], buckets[b], p, ctx)) {
+                goto err;
+            }
+        }
+
+        /*
+         * acc = \sum (b + 1) * buckets[b], summing up the running sums of
+         * the buckets from the top one down
+         */
+        if (!EC_POINT_set_to_infinity(group, sum)
+            || !EC_POINT_set_to_infinity(group, acc))
+            goto err;
+        for (b = numbuckets; b-- > 0;) {
+            if (used[b] && !EC_POINT_add(group, sum, sum, buckets[b], ctx))
+                goto err;
+            if (!EC_POINT_add(group, acc, acc, sum, ctx))
+                goto err;
+        }
+        if (!EC_POINT_add(group, r, r, acc, ctx))
+            goto err;
+    }
+
+    ret = 1;
+
+ err:
+    if (val != NULL) {
+        for (i = 0; i < 2 * totalnum; i++)
+            EC_POINT_free(val[i]);
+        OPENSSL_free(val);
+    }
+    if (buckets != NULL) {
+        for (b = 0; b < numbuckets; b++)
+            EC_POINT_free(buckets[b]);
+        OPENSSL_free(buckets);
+    }
+    OPENSSL_free(digits);
+    OPENSSL_free(used);
+    EC_POINT_free(sum);
+    EC_POINT_free(acc);
+    return ret;
+}
+
+/*-
+ * ec_pre_comp_compute()
  * creates an EC_PRE_COMP object with preprecomputed multiples of the generator
  * for use with wNAF splitting as implemented in ossl_ec_wNAF_mul().
  *
@@ -816,24 +1041,21 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
  * points[2^(w-1)*numblocks-1]     = (2^(w-1)) *  2^(blocksize*(numblocks-1)) * generator
  * points[2^(w-1)*numblocks]       = NULL
  */
-int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
+static EC_PRE_COMP *ec_pre_comp_compute(const EC_GROUP *group, BN_CTX *ctx)
 {
     const EC_POINT *generator;
     EC_POINT *tmp_point = NULL, *base = NULL, **var;
     const BIGNUM *order;
     size_t i, bits, w, pre_points_per_block, blocksize, numblocks, num;
     EC_POINT **points = NULL;
-    EC_PRE_COMP *pre_comp;
-    int ret = 0;
+    EC_PRE_COMP *pre_comp, *ret = NULL;
     int used_ctx = 0;
 #ifndef FIPS_MODULE
     BN_CTX *new_ctx = NULL;
 #endif
 
-    /* if there is an old EC_PRE_COMP object, throw it away */
-    EC_pre_comp_free(group);
     if ((pre_comp = ec_pre_comp_new(group)) == NULL)
-        return 0;
+        return NULL;
 
     generator = EC_GROUP_get0_generator(group);
     if (generator == NULL) {
@@ -952,9 +1174,8 @@ int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
     pre_comp->points = points;
     points = NULL;
     pre_comp->num = num;
-    SETPRECOMP(group, ec, pre_comp);
+    ret = pre_comp;
     pre_comp = NULL;
-    ret = 1;
 
  err:
     if (used_ctx)
@@ -975,6 +1196,141 @@ int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
     return ret;
 }
 
+/*
+ * Every decoded key or imported set of domain parameters gets an EC_GROUP
+ * of its own, so precomputed multiples of the generator are also shared
+ * through the library context: the cache holds a copy of each group for
+ * which a precomputation was done, and other groups with the same method
+ * and curve parameters borrow a reference to it.  The method has to match
+ * as well, because the points are stored in its internal representation.
+ * The cache is small and only ever grows, it is meant to hold the handful
+ * of curves that an application actually uses.
+ */
+#define EC_PRE_COMP_CACHE_MAX   32
+
+typedef struct {
+    CRYPTO_RWLOCK *lock;
+    /* Set once the cache holds a group, read without the lock */
+    uint64_t populated;
+    size_t num;
+    EC_GROUP *groups[EC_PRE_COMP_CACHE_MAX];
+} EC_PRE_COMP_CACHE;
+
+void *ossl_ec_pre_comp_cache_new(OSSL_LIB_CTX *libctx)
+{
+    EC_PRE_COMP_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+
+    cache->lock = CRYPTO_THREAD_lock_new();
+    if (cache->lock == NULL) {
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void ossl_ec_pre_comp_cache_free(void *vcache)
+{
+    EC_PRE_COMP_CACHE *cache = vcache;
+    size_t i;
+
+    if (cache == NULL)
+        return;
+
+    for (i = 0; i < cache->num; i++)
+        EC_GROUP_free(cache->groups[i]);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+/* Must be called with the cache lock held */
+static EC_PRE_COMP *ec_pre_comp_cache_find(const EC_PRE_COMP_CACHE *cache,
+                                           const EC_GROUP *group, BN_CTX *ctx)
+{
+    size_t i;
+
+    for (i = 0; i < cache->num; i++) {
+        const EC_GROUP *cached = cache->groups[i];
+
+        if (cached->meth == group->meth
+            && EC_GROUP_cmp(cached, group, ctx) == 0)
+            return EC_ec_pre_comp_dup(cached->pre_comp.ec);
+    }
+    return NULL;
+}
+
+/*
+ * Returns a reference to precomputed multiples of the generator of |group|
+ * from the library context cache.  If there are none and |create| is set,
+ * they are computed and, room permitting, added to the cache.
+ */
+static EC_PRE_COMP *ec_pre_comp_get(const EC_GROUP *group, int create,
+                                    BN_CTX *ctx)
+{
+    EC_PRE_COMP_CACHE *cache
+        = ossl_lib_ctx_get_data(group->libctx, OSSL_LIB_CTX_EC_PRE_COMP_INDEX);
+    EC_PRE_COMP *pre_comp, *found;
+    EC_GROUP *cached = NULL;
+    uint64_t populated = 0;
+
+    if (cache == NULL)
+        return create ? ec_pre_comp_compute(group, ctx) : NULL;
+
+    /*
+     * This is called for every multiplication by the generator of a group
+     * without precomputation of its own, so skip the lock and the group
+     * comparisons until there is something to find.
+     */
+    if (!create
+        && (!CRYPTO_atomic_load(&cache->populated, &populated, cache->lock)
+            || populated == 0))
+        return NULL;
+
+    if (!CRYPTO_THREAD_read_lock(cache->lock))
+        return NULL;
+    pre_comp = ec_pre_comp_cache_find(cache, group, ctx);
+    CRYPTO_THREAD_unlock(cache->lock);
+    if (pre_comp != NULL || !create)
+        return pre_comp;
+
+    if ((pre_comp = ec_pre_comp_compute(group, ctx)) == NULL)
+        return NULL;
+
+    if (!CRYPTO_THREAD_write_lock(cache->lock))
+        return pre_comp;
+    /* Another thread may have got there first */
+    if ((found = ec_pre_comp_cache_find(cache, group, ctx)) != NULL) {
+        EC_ec_pre_comp_free(pre_comp);
+        pre_comp = found;
+    } else if (cache->num < EC_PRE_COMP_CACHE_MAX
+               && (cached = EC_GROUP_dup(group)) != NULL) {
+        EC_pre_comp_free(cached);
+        /* |group| may well be freed before the cache is */
+        pre_comp->group = cached;
+        SETPRECOMP(cached, ec, EC_ec_pre_comp_dup(pre_comp));
+        cache->groups[cache->num++] = cached;
+    }
+    CRYPTO_THREAD_unlock(cache->lock);
+    /* Not under the lock, which CRYPTO_atomic_store() may need itself */
+    if (cached != NULL)
+        (void)CRYPTO_atomic_store(&cache->populated, 1, cache->lock);
+    return pre_comp;
+}
+
+int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
+{
+    EC_PRE_COMP *pre_comp;
+
+    /* if there is an old EC_PRE_COMP object, throw it away */
+    EC_pre_comp_free(group);
+    if ((pre_comp = ec_pre_comp_get(group, 1, ctx)) == NULL)
+        return 0;
+    SETPRECOMP(group, ec, pre_comp);
+    return 1;
+}
+
 int ossl_ec_wNAF_have_precompute_mult(const EC_GROUP *group)
 {
     return HAVEPRECOMP(group, ec);
@@ -1,5 +1,5 @@
 /*
- * Copyright 2002-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2002-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -30,6 +30,9 @@
  */
 #define MAX_ECDSA_SIGN_RETRIES 8
 
+/* The number of signatures handled at once by ossl_ecdsa_verify_batch() */
+#define ECDSA_VERIFY_BATCH_SIZE 64
+
 static int ecdsa_sign_setup(EC_KEY *eckey, BN_CTX *ctx_in,
                             BIGNUM **kinvp, BIGNUM **rp,
                             const unsigned char *dgst, int dlen,
@@ -441,6 +444,221 @@ int ossl_ecdsa_verify(int type, const unsigned char *dgst, int dgst_len,
     return ret;
 }
 
+static ECDSA_SIG *ecdsa_sig_decode(const unsigned char *sigbuf, int sig_len)
+{
+    ECDSA_SIG *s;
+    const unsigned char *p = sigbuf;
+    unsigned char *der = NULL;
+    int derlen;
+
+    if ((s = d2i_ECDSA_SIG(NULL, &p, sig_len)) == NULL)
+        return NULL;
+    /* Ensure signature uses DER and doesn't have trailing garbage */
+    derlen = i2d_ECDSA_SIG(s, &der);
+    if (derlen != sig_len || memcmp(sigbuf, der, derlen) != 0) {
+        ECDSA_SIG_free(s);
+        s = NULL;
+    }
+    OPENSSL_free(der);
+    return s;
+}
+
+/*-
+ * Verifies num DER encoded signatures sig of the digests dgst with eckey,
+ * as ossl_ecdsa_verify() does for each of them, and sets results[i] to 1
+ * for each valid and to 0 for each invalid or malformed signature. If
+ * results is NULL, gives up as soon as an invalid signature is found.
+ *
+ * As ECDSA signatures only carry the x coordinate of the point they are
+ * checked against, they cannot be checked together with a single
+ * multi-scalar multiplication the way EdDSA signatures can. What is shared
+ * is the setup and the inversions of the s values, of which Montgomery's
+ * trick computes up to ECDSA_VERIFY_BATCH_SIZE with a single inversion and
+ * three multiplications each.
+ *
+ * returns
+ *      1: all signatures correct
+ *      0: some signature incorrect
+ *     -1: error
+ */
+int ossl_ecdsa_verify_batch(size_t num, const unsigned char *const *dgst,
+                            const size_t *dgst_len,
+                            const unsigned char *const *sig,
+                            const size_t *sig_len, int *results,
+                            EC_KEY *eckey)
+{
+    ECDSA_SIG *s[ECDSA_VERIFY_BATCH_SIZE];
+    BIGNUM *c[ECDSA_VERIFY_BATCH_SIZE];
+    size_t idx[ECDSA_VERIFY_BATCH_SIZE];
+    BN_CTX *ctx = NULL;
+    const BIGNUM *order;
+    BIGNUM *u1, *u2, *m, *X, *inv;
+    EC_POINT *point = NULL;
+    const EC_GROUP *group;
+    const EC_POINT *pub_key;
+    size_t i, j, k, n = 0;
+    int ret = -1, all_valid = 1, valid, bits, len;
+
+    if (results != NULL)
+        for (i = 0; i < num; i++)
+            results[i] = 0;
+
+    if (eckey == NULL || (group = EC_KEY_get0_group(eckey)) == NULL ||
+        (pub_key = EC_KEY_get0_public_key(eckey)) == NULL) {
+        ERR_raise(ERR_LIB_EC, EC_R_MISSING_PARAMETERS);
+        return -1;
+    }
+
+    /* Only the built in methods can be short cut */
+    if (eckey->meth->verify != ossl_ecdsa_verify
+        || eckey->meth->verify_sig != ossl_ecdsa_verify_sig
+        || group->meth->ecdsa_verify_sig != ossl_ecdsa_simple_verify_sig) {
+        for (i = 0; i < num; i++) {
+            if (dgst_len[i] > INT_MAX || sig_len[i] > INT_MAX)
+                valid = 0;
+            else if ((valid = ECDSA_verify(0, dgst[i], (int)dgst_len[i],
+                                           sig[i], (int)sig_len[i],
+                                           eckey)) < 0)
+                return -1;
+            if (results != NULL)
+                results[i] = valid;
+            else if (!valid)
+                return 0;
+            all_valid = all_valid && valid;
+        }
+        return all_valid;
+    }
+
+    if (!EC_KEY_can_sign(eckey)) {
+        ERR_raise(ERR_LIB_EC, EC_R_CURVE_DOES_NOT_SUPPORT_SIGNING);
+        return -1;
+    }
+
+    ctx = BN_CTX_new_ex(eckey->libctx);
+    if (ctx == NULL) {
+        ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+        return -1;
+    }
+    BN_CTX_start(ctx);
+    u1 = BN_CTX_get(ctx);
+    u2 = BN_CTX_get(ctx);
+    m = BN_CTX_get(ctx);
+    X = BN_CTX_get(ctx);
+    inv = BN_CTX_get(ctx);
+    for (k = 0; k < ECDSA_VERIFY_BATCH_SIZE; k++)
+        c[k] = BN_CTX_get(ctx);
+    if (c[ECDSA_VERIFY_BATCH_SIZE - 1] == NULL) {
+        ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+        goto err;
+    }
+
+    order = EC_GROUP_get0_order(group);
+    if (order == NULL) {
+        ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
+        goto err;
+    }
+    bits = BN_num_bits(order);
+
+    if ((point = EC_POINT_new(group)) == NULL) {
+        ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
+        goto err;
+    }
+
+    for (i = 0; i < num; i = j) {
+        /* Decode the signatures, and multiply up the s values */
+        for (j = i, n = 0; j < num && n < ECDSA_VERIFY_BATCH_SIZE; j++) {
+            if (sig_len[j] > INT_MAX
+                || (s[n] = ecdsa_sig_decode(sig[j], (int)sig_len[j])) == NULL)
+                goto invalid;
+            if (BN_is_zero(s[n]->r) || BN_is_negative(s[n]->r) ||
+                BN_ucmp(s[n]->r, order) >= 0 || BN_is_zero(s[n]->s) ||
+                BN_is_negative(s[n]->s) || BN_ucmp(s[n]->s, order) >= 0) {
+                ECDSA_SIG_free(s[n]);
+                goto invalid;
+            }
+            if (n == 0 ? BN_copy(c[0], s[0]->s) == NULL
+                       : !BN_mod_mul(c[n], c[n - 1], s[n]->s, order, ctx)) {
+                ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                idx[n++] = j;
+                goto err;
+            }
+            idx[n++] = j;
+            continue;
+ invalid:
+            all_valid = 0;
+            if (results == NULL) {
+                ret = 0;
+                goto err;
+            }
+        }
+        if (n == 0)
+            continue;
+
+        /*
+         * Invert the product, and get the inverse of each s by multiplying
+         * it with the product of the others, c[k] = inv(s[k]) in the end.
+         */
+        if (!ossl_ec_group_do_inverse_ord(group, inv, c[n - 1], ctx)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+            goto err;
+        }
+        for (k = n - 1; k > 0; k--) {
+            if (!BN_mod_mul(c[k], inv, c[k - 1], order, ctx)
+                || !BN_mod_mul(inv, inv, s[k]->s, order, ctx)) {
+                ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                goto err;
+            }
+        }
+        if (BN_copy(c[0], inv) == NULL) {
+            ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+            goto err;
+        }
+
+        /* The rest is as in ossl_ecdsa_simple_verify_sig() */
+        for (k = 0; k < n; k++) {
+            /* Need to truncate digest if it is too long */
+            len = dgst_len[idx[k]] > (size_t)(bits + 7) / 8
+                  ? (bits + 7) / 8 : (int)dgst_len[idx[k]];
+            if (!BN_bin2bn(dgst[idx[k]], len, m)
+                || ((8 * len > bits) && !BN_rshift(m, m, 8 - (bits & 0x7)))
+                || !BN_mod_mul(u1, m, c[k], order, ctx)
+                || !BN_mod_mul(u2, s[k]->r, c[k], order, ctx)) {
+                ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                goto err;
+            }
+            if (!EC_POINT_mul(group, point, u1, pub_key, u2, ctx)
+                || !EC_POINT_get_affine_coordinates(group, point, X, NULL,
+                                                    ctx)) {
+                ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
+                goto err;
+            }
+            if (!BN_nnmod(u1, X, order, ctx)) {
+                ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                goto err;
+            }
+            valid = BN_ucmp(u1, s[k]->r) == 0;
+            if (results != NULL) {
+                results[idx[k]] = valid;
+            } else if (!valid) {
+                ret = 0;
+                goto err;
+            }
+            all_valid = all_valid && valid;
+        }
+        for (k = 0; k < n; k++)
+            ECDSA_SIG_free(s[k]);
+        n = 0;
+    }
+    ret = all_valid;
+ err:
+    for (k = 0; k < n; k++)
+        ECDSA_SIG_free(s[k]);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    EC_POINT_free(point);
+    return ret;
+}
+
 int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
                                  const ECDSA_SIG *sig, EC_KEY *eckey)
 {
@@ -1,5 +1,5 @@
 /*
- * Copyright 2023-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -217,12 +217,19 @@ static void felem_scalar128(widefelem out, limb scalar)
         out[i] *= scalar;
 }
 
+static void felem_reduce(felem out, const widefelem in);
+
 /*-
  * felem_neg sets |out| to |-in|
  * On entry:
  *   in[i] < 2^60 - 2^29
  * On exit:
- *   out[i] < 2^60
+ *   out[i] < 2^56 for i < 6,
+ *   out[6] <= 2^48
+ *
+ * The output is reduced, as the negated point may be returned as is by
+ * point_add() when the accumulator is the point at infinity, and
+ * felem_contract() only accepts reduced input.
  */
 static void felem_neg(felem out, const felem in)
 {
@@ -243,13 +250,16 @@ static void felem_neg(felem out, const felem in)
     static const limb two60m4 = (((limb) 1) << 60)
                               - (((limb) 1) << 4);
 
-    out[0] = two60p44m12 - in[0];
-    out[1] = two60m52m4 - in[1];
-    out[2] = two60m28m4 - in[2];
-    out[3] = two60m4 - in[3];
-    out[4] = two60m4 - in[4];
-    out[5] = two60m4 - in[5];
-    out[6] = two60m4 - in[6];
+    widefelem tmp = { 0 };
+
+    tmp[0] = two60p44m12 - in[0];
+    tmp[1] = two60m52m4 - in[1];
+    tmp[2] = two60m28m4 - in[2];
+    tmp[3] = two60m4 - in[3];
+    tmp[4] = two60m4 - in[4];
+    tmp[5] = two60m4 - in[5];
+    tmp[6] = two60m4 - in[6];
+    felem_reduce(out, tmp);
 }
 
 /*-
@@ -1245,6 +1255,14 @@ static void point_add(felem x3, felem y3, felem z3,
  * Tables for other points have table[i] = iG for i in 0 .. 16.
  */
 
+/*
+ * ecp_nistp384_table.c has a larger table for multiplications of the standard
+ * generator on its own, i.e. key generation and signing: for each of the 77
+ * 5-bit windows of the scalar it holds 1G .. 16G, scaled by 2^(5*window),
+ * in affine coordinates.
+ */
+extern const felem ossl_ec_nistp384_precomputed[77][16][2];
+
 /* gmul is the table of precomputed base points */
 static const felem gmul[16][3] = {
 {{0, 0, 0, 0, 0, 0, 0},
@@ -1355,6 +1373,34 @@ static void select_point(const limb idx, unsigned int size,
     }
 }
 
+/*
+ * select_point_affine selects the |idx|th multiple from one subtable of
+ * ossl_ec_nistp384_precomputed and copies it to out, as a point with z = 1,
+ * or the point at infinity for |idx| = 0.
+ */
+static void select_point_affine(const limb idx, const felem table[16][2],
+                                felem out[3])
+{
+    unsigned int i, j;
+    limb *outlimbs = &out[0][0];
+
+    memset(out, 0, sizeof(*out) * 3);
+
+    for (i = 0; i < 16; i++) {
+        const limb *inlimbs = &table[i][0][0];
+        limb mask = (i + 1) ^ idx;
+
+        mask |= mask >> 4;
+        mask |= mask >> 2;
+        mask |= mask >> 1;
+        mask &= 1;
+        mask--;
+        for (j = 0; j < NLIMBS * 2; j++)
+            outlimbs[j] |= inlimbs[j] & mask;
+        out[2][0] |= mask & 1;
+    }
+}
+
 /* get_bit returns the |i|th bit in |in| */
 static char get_bit(const felem_bytearray in, int i)
 {
@@ -1454,6 +1500,47 @@ static void batch_mul(felem x_out, felem y_out, felem z_out,
     felem_assign(z_out, nq[2]);
 }
 
+/*
+ * Multiplication of the standard generator by |g_scalar| using the large
+ * precomputed table: the scalar is recoded into 77 signed 5-bit digits and
+ * the multiples digit * 2^(5*i) * G are looked up and added up, which
+ * takes no doublings at all.  Output point (X, Y, Z) is stored in x_out,
+ * y_out, z_out
+ */
+static void g_mul_precomputed(felem x_out, felem y_out, felem z_out,
+                              const u8 *g_scalar)
+{
+    int i;
+    felem nq[3], tmp[4];
+    limb bits;
+    u8 sign, digit;
+
+    /* set nq to the point at infinity */
+    memset(nq, 0, sizeof(nq));
+
+    for (i = 0; i < 77; i++) {
+        bits = get_bit(g_scalar, 5 * i + 4) << 5;
+        bits |= get_bit(g_scalar, 5 * i + 3) << 4;
+        bits |= get_bit(g_scalar, 5 * i + 2) << 3;
+        bits |= get_bit(g_scalar, 5 * i + 1) << 2;
+        bits |= get_bit(g_scalar, 5 * i) << 1;
+        bits |= get_bit(g_scalar, 5 * i - 1);
+        ossl_ec_GFp_nistp_recode_scalar_bits(&sign, &digit, bits);
+
+        /* select the point to add or subtract, in constant time */
+        select_point_affine(digit, ossl_ec_nistp384_precomputed[i], tmp);
+        felem_neg(tmp[3], tmp[1]); /* (X, -Y, Z) is the negative point */
+        copy_conditional(tmp[1], tmp[3], (-(limb) sign));
+
+        point_add(nq[0],  nq[1],  nq[2],
+                  nq[0],  nq[1],  nq[2], 1,
+                  tmp[0], tmp[1], tmp[2]);
+    }
+    felem_assign(x_out, nq[0]);
+    felem_assign(y_out, nq[1]);
+    felem_assign(z_out, nq[2]);
+}
+
 /* Precomputation for the group generator. */
 struct nistp384_pre_comp_st {
     felem g_pre_comp[16][3];
@@ -1858,12 +1945,17 @@ int ossl_ec_GFp_nistp384_points_mul(const EC_GROUP *group, EC_POINT *r,
         } else {
             num_bytes = BN_bn2lebinpad(scalar, g_secret, sizeof(g_secret));
         }
-        /* do the multiplication with generator precomputation */
-        batch_mul(x_out, y_out, z_out,
-                  (const felem_bytearray(*))secrets, num_points,
-                  g_secret,
-                  mixed, (const felem(*)[17][3])pre_comp,
-                  (const felem(*)[3])g_pre_comp);
+        if (num_points == 0
+            && memcmp(g_pre_comp[1], gmul[1], sizeof(gmul[1])) == 0)
+            /* the standard generator on its own: use the large table */
+            g_mul_precomputed(x_out, y_out, z_out, g_secret);
+        else
+            /* do the multiplication with generator precomputation */
+            batch_mul(x_out, y_out, z_out,
+                      (const felem_bytearray(*))secrets, num_points,
+                      g_secret,
+                      mixed, (const felem(*)[17][3])pre_comp,
+                      (const felem(*)[3])g_pre_comp);
     } else {
         /* do the multiplication without generator precomputation */
         batch_mul(x_out, y_out, z_out,
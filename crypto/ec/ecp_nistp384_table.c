@@ -0,0 +1,5112 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * This is the precomputed constant time access table for the code in
+ * ecp_nistp384.c, for the default generator. The table consists of 77
+ * subtables, each subtable contains 16 affine points:
+ * subtable 0:   1*  (2^0)*G, 2*  (2^0)*G, ... , 16*  (2^0)*G,
+ * subtable 1:   1*  (2^5)*G, 2*  (2^5)*G, ... , 16*  (2^5)*G,
+ * ...
+ * subtable 76:  1*(2^380)*G, 2*(2^380)*G, ... , 16*(2^380)*G,
+ * There are 77 tables because a signed, 5-bit window form of the scalar is
+ * used and ceil(385/5) = 77.  The sign is implemented by negating the affine
+ * point when required and the zero digit by the point at infinity.
+ *
+ * The affine points are encoded as two field elements, x and y, each of seven
+ * 56-bit limbs in little-endian order, as used by ecp_nistp384.c.
+ */
+
+#include <stdint.h>
+
+extern const uint64_t ossl_ec_nistp384_precomputed[77][16][2][7];
+const uint64_t ossl_ec_nistp384_precomputed[77][16][2][7] = {
+    {
+        {{0x00545e3872760ab7, 0x00f25dbf55296c3a, 0x00e082542a385502, 0x008ba79b9859f741,
+          0x0020ad746e1d3b62, 0x0005378eb1c71ef3, 0x0000aa87ca22be8b},
+         {0x00431d7c90ea0e5f, 0x00b1ce1d7e819d7a, 0x0013b5f0b8c00a60, 0x00289a147ce9da31,
+          0x0092dc29f8f41dbd, 0x002c6f5d9e98bf92, 0x00003617de4a9626}},
+        {{0x0096a9c75295df61, 0x00e86ebe0e64f85b, 0x00d19fb96e9e4fe0, 0x00a6f434d651d207,
+          0x005b97f089025959, 0x00d2d969260045c5, 0x000008d999057ba3},
+         {0x00501e700a940e80, 0x0043e94d39e22d61, 0x005f256ab4255ffd, 0x00bc6cc43e904e50,
+          0x006dba74b275d875, 0x003cedb7bfe8dffd, 0x00008e80f1fa5b1b}},
+        {{0x00d7e5c70500c831, 0x00bbae5026580d02, 0x0040d3566da6b408, 0x00202dcd06bea4f2,
+          0x00dc7d98cb9d3910, 0x00fa1464793c7e5f, 0x0000077a41d4606f},
+         {0x005f28600a2f1df1, 0x00bd6be4b5d298b6, 0x000edc111eacc24a, 0x0085115aa5f7684c,
+          0x00a9fc998520b41c, 0x0042837d0bbe9602, 0x0000c995f7ca0b0c}},
+        {{0x00efd631c63e1835, 0x00a1597e3a5120e1, 0x00ad51dcfc9d1589, 0x000b4ca0aca55dc8,
+          0x00321deb97e709bd, 0x009298c1c8aad977, 0x0000138251cd52ac},
+         {0x009f1c02b270ed67, 0x0087be37bba56954, 0x00cf792aa4dced73, 0x008abc09f3ab0e63,
+          0x00ab56616dc45d91, 0x002e1631e8a28181, 0x0000cacae29869a6}},
+        {{0x00bcdbc3836d84bc, 0x002f4a1ca297e60a, 0x00cbe56583b03788, 0x00bff98fc54f6661,
+          0x0025e467f208e51d, 0x00c777573cac5ea0, 0x000011de24a2c251},
+         {0x004414abe6c1713a, 0x00686d0ae8fb3318, 0x0033b6901aeb3177, 0x0054d5dee88c9865,
+          0x0000e7c5284b4477, 0x00f92d0f5837e90a, 0x00008fa696c77440}},
+        {{0x0037f0854e35c5df, 0x007d7202ff30e509, 0x00f2625738302131, 0x007f0f5da51cbd41,
+          0x002d15d3c33ebcbb, 0x00d2b2226fe0d26f, 0x0000627be1acd064},
+         {0x0033a408d3f0f934, 0x005b8d84e1653117, 0x00613715441604c4, 0x00644f774c99864f,
+          0x004f1575b2c95352, 0x00b1c21be6dda6c1, 0x000009766a4cb3f8}},
+        {{0x000f05b48fb6d0e1, 0x00526f55b9ebb204, 0x009dfa7b1c508b05, 0x00fbea5ffa2d58cc,
+          0x004edffead6fe997, 0x004788f29f8ebf23, 0x0000283c1d7365ce},
+         {0x00664cdac512ef8c, 0x004ede32a78f9e64, 0x00d01dbd225630d8, 0x00ed799729d9c92c,
+          0x001690471a61d867, 0x001b88ba52efdb8c, 0x00009475c99061e4}},
+        {{0x00e9b269d822c87d, 0x0058d6f403d5ece6, 0x0073256f11fb5a32, 0x00be58190a900c3c,
+          0x00fa383445bf227f, 0x00e0be75114297a6, 0x00001692778ea596},
+         {0x006abfa4022b0ad2, 0x00e1e9cdd1708d6f, 0x00c2ec0eec196bad, 0x006d521cd4bd1c30,
+          0x00b8fd0e22554adc, 0x00106a835388ba3d, 0x0000dcd2365700d4}},
+        {{0x0055e4461079118b, 0x00528bfee2b9535c, 0x00e285fb6e21c388, 0x001e6fd3bac6cb1e,
+          0x0025b78f2216f729, 0x00cb3ef1bf29b8b0, 0x00008f0a39a4049b},
+         {0x002da4f9ac664af8, 0x003efedfd51b6826, 0x0054aed9b3029e74, 0x00a3c400c6b76788,
+          0x00c3a9799a9b3d7c, 0x0001d6452c4a5322, 0x000062c77e1438b6}},
+        {{0x00cb2d13186658fb, 0x0085ab507bf91aa9, 0x0029291238cced8e, 0x00b79b9e88931d5c,
+          0x004fde864f372d90, 0x007eec678d29d6ef, 0x0000a669c5563bd6},
+         {0x00784f6ab73a21dd, 0x008195248288d997, 0x0078c3b705a8296d, 0x000c183c31c502df,
+          0x00f0ecddf7011955, 0x00279f22d9083db5, 0x0000a988b72ae7c1}},
+        {{0x00356f3b55b4ddd8, 0x00b66e3afb81d626, 0x0014892d3f8c4749, 0x005837c37456c9fd,
+          0x004816c57fe935ed, 0x00b998da1eeec290, 0x0000099056e27da7},
+         {0x005dba8138c5e0bb, 0x00d51263aaff357d, 0x00f41b52a3255466, 0x00dfc363fd43ff93,
+          0x00c5e0396fc4eed8, 0x00ab96688505544a, 0x00002e4c0c234e30}},
+        {{0x00da2ea77d2a7022, 0x005e22da817cb466, 0x00691a481406da4a, 0x001f6d0e21648af2,
+          0x00f683d08c2ed5e4, 0x009289ab3ac421dc, 0x0000952a7a349bd4},
+         {0x00f6bacce21bd16e, 0x00a64589743e229e, 0x00096196b50d031a, 0x00ce18a0ebb9028b,
+          0x00f66f2e09fb8036, 0x00bc0563052deae6, 0x0000a0320faf84b5}},
+        {{0x00f1ca1e3b5cbce7, 0x00f441abd99f1baa, 0x00d1f0f11c139ee5, 0x00f01f873f6267bc,
+          0x00fcc6ab9632bff9, 0x00ea5bafdaf5002f, 0x0000a567ba97b67a},
+         {0x0023a12736f429cc, 0x00cb8272218a7d64, 0x00e057857d66776b, 0x0046932ec086329b,
+          0x00164ecc51855950, 0x003318644e4147af, 0x0000de1b38b3989f}},
+        {{0x00209accf0f59ea0, 0x00a24dbc02de6637, 0x00eb651cca2c41ab, 0x00d23e7dc95de541,
+          0x0089d2b0877b1dff, 0x00c2396bbeac481b, 0x0000e8c8f94d44fb},
+         {0x00ee5c9e1b67b888, 0x008ba05509de22d7, 0x0013a09d0f48fc46, 0x00e7728d79c83194,
+          0x0052c8a933b86191, 0x008ae0932bcbf6de, 0x0000891ae44356fc}},
+        {{0x0088701a9606860b, 0x00557a10b6383b4b, 0x00f7da7c4e9ca849, 0x00fff01c205b21f9,
+          0x0013525522a94156, 0x0001058cc15c11d8, 0x0000b3d13fc8b32b},
+         {0x005d588d33f7bd62, 0x0024f8b284af5098, 0x004373dfbfd9838d, 0x001d749af484d111,
+          0x00164b1beebac4a1, 0x0062a61b049b2536, 0x0000152919e7df91}},
+        {{0x0062b892401dafcf, 0x00bc773d157811a4, 0x009428a8583bac8e, 0x00e5152cf6a464fa,
+          0x0031511a6b80dff0, 0x00369c5fbd88e2b2, 0x0000d5d89c3b5282},
+         {0x0022b755ebab3673, 0x000cb8f49bf22368, 0x007e440a7abad121, 0x000e2a3bdb9caba5,
+          0x009448f1d41d4fc4, 0x0006d241816d5e9a, 0x0000d815229de129}}
+    },
+    {
+        {{0x00e82fe55ff86ed6, 0x009b88e217ecd3cc, 0x002cc4acaf5c4481, 0x006d99af63612ccf,
+          0x00d9b2b49f81618d, 0x00c6678bab99df1f, 0x00007f7356c5e0fb},
+         {0x00ee2ce86961877b, 0x001513aa614bc253, 0x00995968c751c75d, 0x00e0c3e6f2ea6b40,
+          0x004ca6622bc55e5d, 0x000a4a43d1a5fb9b, 0x0000e003b31de205}},
+        {{0x0069c70f9327605f, 0x009d94cbe63fde1d, 0x00fc9a8425a3ea63, 0x00d26608f259a599,
+          0x006073612ea5e5ab, 0x00780046e3584176, 0x0000c1e179aa178a},
+         {0x0045f0b4856f8ea5, 0x001860c20ddeb88b, 0x001eafa21b56eef3, 0x00a2420eabf7e829,
+          0x000371b2adc07640, 0x00a6d609ba617165, 0x0000c3842f6e4dbc}},
+        {{0x000baf95df631f31, 0x00f0dce3e120b948, 0x00ffbd00f0adc0d8, 0x0096c17366a3c96a,
+          0x00656c267feddc92, 0x006d9a472531fcb6, 0x0000bfd801ad6a37},
+         {0x008acf513a27a7d1, 0x0088532493771e64, 0x00774dd05492cf61, 0x00ac5ffa46d69435,
+          0x001ac4e92328ce3a, 0x00857da807195a5c, 0x000065d6edc632c2}},
+        {{0x00dd08caecd5d092, 0x007d3bb68665089b, 0x009778d6d1606c15, 0x0053e2d9d979df1c,
+          0x00f3ce49e82fa56f, 0x007552a26882916c, 0x000079da1e5e2897},
+         {0x00e76ee7f82499f9, 0x00202bef0ac83965, 0x00ccd72eb9eb96d0, 0x00839f861cb157aa,
+          0x00099d076e16e4dc, 0x009c5d7c6a5afb8b, 0x000057a8e52c2d2b}},
+        {{0x00413941bab189e3, 0x008b3deea1d9ea9a, 0x0025982c13263306, 0x00415fedf1ed85ff,
+          0x00f3cb9eaedaeda2, 0x00f009a330f281a9, 0x0000fc9893654d3f},
+         {0x00a2775f2febc9f4, 0x0006ea570abaabad, 0x00fc2521f84de995, 0x00add781a36a5a68,
+          0x00f71015c8e078f7, 0x00c84f595a15e6ef, 0x0000cdcb2d488894}},
+        {{0x00b4e413152f9349, 0x00ea946375a1a29d, 0x00be0e78dbdd430f, 0x0086167246040a00,
+          0x00fe41b9c1f25455, 0x001357cc0812bd76, 0x00003589f99e1a25},
+         {0x007dca9ef939eb7e, 0x00eefcec8bcd7349, 0x002d245d0de18971, 0x00a9c8e05f48e04d,
+          0x00624078ed9b44a4, 0x00ba6f71be5081c5, 0x0000b416706e879b}},
+        {{0x00705588dbb872d2, 0x000aedacb721ae96, 0x00f78c239705d557, 0x008b69265b0edc18,
+          0x0073181237cca44b, 0x0099145916119868, 0x0000ded56a5bd7b8},
+         {0x00c9d71aee6d6138, 0x00b0f4896d3dc6da, 0x00809b877d8c6a25, 0x0010a273d7ea426c,
+          0x00ebeb4e30eb6172, 0x001bed31bdcce8ae, 0x0000a60f11a6bbc9}},
+        {{0x005ea78776ead2e4, 0x00f03cead4d0dcbd, 0x0092a7dffdedb8e0, 0x00351bc35ea2193f,
+          0x00c5018ab3f2467a, 0x009255deda6f0636, 0x000021a4f5d36926},
+         {0x000ab4d409ea07cb, 0x004f9cbc926b834a, 0x00aa967f587edd57, 0x000372df0c6a6a72,
+          0x008d35e0d78d4d86, 0x004591e9a595ae82, 0x0000388492365051}},
+        {{0x0068c2dbb27a37bd, 0x006e5d92fcda561a, 0x00cfe46e48af6623, 0x0008fbde4ec9804f,
+          0x00941fea379938df, 0x00a43076183ebf74, 0x0000aae36b8197d5},
+         {0x006f5f7f289136b4, 0x000d88aa59cdd209, 0x00fa63a27ea413a9, 0x00e8e54bea0984a6,
+          0x00eb706a5bc19780, 0x00257ce29ba41591, 0x0000d18e2104ec50}},
+        {{0x00f772b3624db892, 0x00c8c6148b69f617, 0x008d7fab39b43059, 0x00aa8f174b83bb6c,
+          0x0071e5163c8ed103, 0x00a54e4316bb6b67, 0x0000170633b3c599},
+         {0x0088e20a74605515, 0x00a679cdd8fdbb7d, 0x0015b41c6da25922, 0x00ca6531fbbbe535,
+          0x00e1a6d1e315506f, 0x009f93f49ab476b6, 0x00003d8ba0ff748c}},
+        {{0x00186d850b1ec252, 0x00b58d9ead182de4, 0x00d13659eeeb8362, 0x00a0dd0d3f6ce80a,
+          0x00d1c1f53d90cc98, 0x00cb21b5eb6af2f2, 0x0000a1dc8131b59b},
+         {0x0033e490add7a475, 0x00ce292b7d206187, 0x001488cf60a95c03, 0x005998016ced0621,
+          0x00c0d4779279a0aa, 0x000349887e5ef078, 0x0000fe7bdf93d267}},
+        {{0x0022dbcdb4e78f7a, 0x00f81e0b94a83b82, 0x00a4917cb6f2c903, 0x000505b9fc29c978,
+          0x00fd802a19c766b9, 0x00c9e346518887ef, 0x0000ab277aa51141},
+         {0x00abbc809e45b32e, 0x00460ff7ebabc3e4, 0x00d46343281deb23, 0x00f8bcf734a8205d,
+          0x00835e881aca4501, 0x0042004ae38c9934, 0x0000eca4185d027a}},
+        {{0x0032062acb65d820, 0x00e2afc697928dc9, 0x00c557b8c9c2797d, 0x00704437e681cc6a,
+          0x00190cb97df2ca9e, 0x00fdd72855f35dc7, 0x00000b4b5ca6a780},
+         {0x00707d3c47a93b02, 0x003fb0cf715627c4, 0x00e7d90aa25089ac, 0x0037913d482dd864,
+          0x003bfd8b3f6a3d37, 0x0049577adc98959d, 0x0000f4b4d427ccfd}},
+        {{0x00eb1b1d9833d359, 0x00e73ced2226a33d, 0x00871c6ab7eb6983, 0x007c93d228641c40,
+          0x00936f2c66f59f42, 0x0056e51af80ee759, 0x00004eab8f881507},
+         {0x000a9d982b161f15, 0x00445bc8e345dbbb, 0x0092160d98d230d9, 0x00ffba8a8cbc78b2,
+          0x004a8b6e84612467, 0x00060430404b8f91, 0x0000f6c72980f801}},
+        {{0x00c89c364b62f883, 0x004cfcfb7b551f35, 0x009c78e60219f90b, 0x005323ec646f9f3d,
+          0x003b98eb6c81ed1e, 0x0071f37e97b0a835, 0x000083154a794dc1},
+         {0x00d792bab30a7ed7, 0x0009c86d1a5ffc78, 0x00a0fe97387eeb9a, 0x00d80877a69519e1,
+          0x00ae559fb337af88, 0x008c7618def96937, 0x0000ecff13782b11}},
+        {{0x00bcf5bfd2b95e4b, 0x00e43551349b6e4b, 0x00f55ab413cce8bf, 0x00d718ecc0571533,
+          0x002b213ebd69fc19, 0x003b9b74de9e043a, 0x0000aa42feaf7511},
+         {0x00e51296c4bc5137, 0x003fa5a80ce91dab, 0x00bf6d1cdfa1f055, 0x00e013e684f78601,
+          0x00e76ab9175bf2d5, 0x00030a40b275b835, 0x0000798ad0576904}}
+    },
+    {
+        {{0x004322e0d779e702, 0x0000f8db51c149ea, 0x00bf17678598a1d0, 0x000a120b84400f88,
+          0x007c3bff7b4edf8a, 0x00fce2ae476d2946, 0x00002b5278c05f0d},
+         {0x002ce6b2d2715150, 0x00d7bd67cafaf09c, 0x00007625521fae41, 0x00762390f609c720,
+          0x00c7d9e377494933, 0x00108795cca3cfe2, 0x0000497e45e2747b}},
+        {{0x0013a117388408ce, 0x008db0a44d9d6b89, 0x00da61fca10951c4, 0x00bdca717f07216a,
+          0x00066e64a5abad7d, 0x009a714deb02729a, 0x0000298b8179063d},
+         {0x0020effa9b92f017, 0x009b9d648d5ce1f6, 0x007c695890d23f60, 0x000064532b7dca4c,
+          0x00810e1db554da34, 0x005682e610d9f066, 0x0000fcf63e77d4c8}},
+        {{0x00add8aa8113d8f0, 0x00530a2a9991ebc1, 0x00173ecbff0d47d7, 0x007cf42c3c8a05d2,
+          0x005ea7fbf159698d, 0x002a71d47176219c, 0x000064dfeaa4ac96},
+         {0x005e4e0ee0b5f811, 0x0020ae710da0f505, 0x00d77a8359e792ca, 0x00fc3ec059b0d56b,
+          0x00e2ad8cea06b053, 0x00e6949409667082, 0x0000d2b186a9e7d2}},
+        {{0x00e8105825adc9ec, 0x005a4c1873b2bb00, 0x00f95d1f591a8d8e, 0x006c27f447a7a882,
+          0x0061d3475cc7168a, 0x0062be679662c034, 0x0000b251813991dc},
+         {0x0058b510e701e4d0, 0x002be81708eedf79, 0x001f4f79204a6e5f, 0x00abedb90eb0b25e,
+          0x001bee251a479632, 0x00c2d5242dc35ab0, 0x0000a89fbdb7f910}},
+        {{0x006f12ff405094d0, 0x00b6ae1bfb68b966, 0x00884ab07fa39689, 0x00eb081a46421626,
+          0x002ae42289c303b6, 0x00ff1ced8807922e, 0x0000a2d8e6722779},
+         {0x0072b1493c4aa83a, 0x009aa64414fd6c51, 0x008700938697f8e8, 0x00e93911bd1a1fac,
+          0x005fa1545fc4efaa, 0x0011780694ceb246, 0x00001d74ef401fdf}},
+        {{0x00059d297f4bc13d, 0x004762a87740fd8b, 0x0058baac1d2420a5, 0x00b5be3d2c4870f3,
+          0x00517092edb3cdb2, 0x000c10fa97a2d4bd, 0x00006309e90f8af6},
+         {0x0024ba46f91f96f0, 0x0069a4a94f9b7f9c, 0x00adef39ddfaae4d, 0x005b933ac7def6e4,
+          0x006c4ec7ec3df006, 0x002319320b4a1f3b, 0x00002c2b5607b79c}},
+        {{0x0092a54aa7df98a6, 0x00a6100e04d2b546, 0x0010dd7a763fd0ff, 0x0051ff8bbd893d31,
+          0x00325720c7afd2c8, 0x00cbc0d8e94bcebf, 0x000095dc470d1d87},
+         {0x00bf40655e677b4e, 0x00b337b0a43bc79d, 0x00f0da23128b9177, 0x00335a238ca1f3d9,
+          0x00c83c17e678b502, 0x00f23136debf80de, 0x0000c5f6990ac268}},
+        {{0x0005913d56e39561, 0x00fcbf4c8a33b2a1, 0x00643ad10d716be4, 0x00db0fe66f06d76d,
+          0x0034d276b1d53c2c, 0x007049ee4863b8a8, 0x0000a14bdd8290ee},
+         {0x0042b03621be6ba9, 0x00af12234df738ad, 0x00704bb128741dde, 0x00320d54529ee9be,
+          0x0037fd53c63eed04, 0x001b3f258b28d91b, 0x00008c7c4cecbc5c}},
+        {{0x00eb9ad2758be117, 0x0027c888eb2fe79d, 0x00a940984d7e8142, 0x0004aabc75373224,
+          0x007fea2cf6b0a1e7, 0x00f70602fa9f9152, 0x0000741d9904bb9c},
+         {0x00b445f0ca9d1d84, 0x004d0cc444beee26, 0x00f5d19f8e2cbfb2, 0x00ba9f2799758ed9,
+          0x008f5f19c30e174b, 0x002f48437a859b53, 0x0000ed779b819801}},
+        {{0x00f3d08e6486f3cd, 0x00e5d4ad26ad7ba4, 0x008e174dc5be7c13, 0x00d4c40aff3d9bb3,
+          0x00b865c198a3e1e8, 0x00e2e4d9950ef6d0, 0x00000f3985407307},
+         {0x00ee1a8b8746f759, 0x000363c14323fff7, 0x00ff3ee6c6bb90fb, 0x00310d115eb8e16f,
+          0x00a09275dd61d2c6, 0x00a588584705673b, 0x000096c20ab905c7}},
+        {{0x00cd977b724db445, 0x00ce73a3884c4c8e, 0x00890f0a8f03d5cf, 0x00f0fced1d775460,
+          0x0085475759d69a2c, 0x0079284f944044ad, 0x0000240a8ab1791d},
+         {0x00c08cd6a675d42d, 0x00878be53ef9da9c, 0x00b35b0b7d6ac58d, 0x00f13647a6fe6771,
+          0x008564def58e8f62, 0x00632c55dda47c3e, 0x00006135dc4ce18d}},
+        {{0x006e27bd4d25c424, 0x00c019e426a10b82, 0x00220742c59db8df, 0x002a6b35c5092b08,
+          0x00c13ac654f5dc25, 0x00dffda183fceb96, 0x0000b4648d7c7ef2},
+         {0x0059355a7f359e09, 0x007dcf4a08e8e522, 0x00ad64faa491703f, 0x002498e2c28f88d8,
+          0x0008604728c50b23, 0x00ac72c96a5bfd39, 0x0000978a4cefb0e5}},
+        {{0x008ffa64d1302483, 0x008f9877795cf9c5, 0x002f5083388c48cf, 0x00f798a1f9c70f98,
+          0x00a51153d2ed847d, 0x0034b61456ec7ffa, 0x00004a7ec2734212},
+         {0x0066be51bae0af87, 0x00a11e1cf9561b6b, 0x003a231ae5a9c238, 0x00d61bfc2c718ad4,
+          0x00175b58f2e8c08c, 0x007c058af2c0bb77, 0x00008c1946630686}},
+        {{0x006f94b6007f5e02, 0x007bf2045eb033b6, 0x00afd8fab9d404bd, 0x009ca2b91e9d9a7c,
+          0x00d59b28500eee46, 0x00d93bac3ace8225, 0x00009090bf0792ef},
+         {0x009433038e519b44, 0x005ce5398153d383, 0x005ef15d3943860f, 0x00753d0b2cadb152,
+          0x005203a4614e9345, 0x0024aa354a58af85, 0x00000af9b2a0d8f8}},
+        {{0x0091d7cbdeb55327, 0x005981f50a27b784, 0x005739311b233325, 0x00601ff9933c77b6,
+          0x00a7638e46997168, 0x005b176f1b7416e4, 0x000096e04ada2cf2},
+         {0x0076fdf6ddfd7e94, 0x00a1dbce26d55a80, 0x00a50bd717e08221, 0x001aba9d730936db,
+          0x00f07bc17a2434ca, 0x008a5f1b0625f07b, 0x00008de734c293a4}},
+        {{0x007db3e3fbd684c3, 0x0008d3460708de32, 0x008a2c0fac02311a, 0x001161a482ae7591,
+          0x004d34147f6349d9, 0x0012afffe63565ec, 0x0000ad8aaa7a7a37},
+         {0x003aae6b4c4e0fcc, 0x001f09c902c68ec6, 0x007970460778dda0, 0x00812cbc1fd538d2,
+          0x00b0e20b3ce66a2a, 0x00545f7b67b2f9d0, 0x0000c465c8b2be2e}}
+    },
+    {
+        {{0x0027dde075d5c4b0, 0x00cea21d4e8a3221, 0x0093e7e26891e329, 0x00e6516f2c0f2330,
+          0x0061f549efa237f7, 0x00a3222045d0766f, 0x00006a557a974d1f},
+         {0x007ecaed53c7cfbd, 0x002a079b08d99d1d, 0x00342d4d21071534, 0x00296c9e9a7932eb,
+          0x00e98e4cbb8b410e, 0x001e0c6c4bd55c18, 0x0000fe8c04ae4d2e}},
+        {{0x005f7103450dcda4, 0x00aeaf210005fb7b, 0x00afe7e9f447991d, 0x0060a1e9a4399186,
+          0x00f6a67980bf2bf9, 0x006d3f517356192b, 0x000013ee2f3c97b9},
+         {0x00b0f721220244b8, 0x00495fe6860a4b3c, 0x007b4d1751ada1ce, 0x00f55e10eec0a143,
+          0x00bedc045b0af9b4, 0x00ea0770f25a5e9c, 0x00004c1548bc5c11}},
+        {{0x0039fa728e491aaa, 0x00d90e68fdf0230f, 0x00b0f827aea2f4ae, 0x002eca233e08de26,
+          0x00c4ed2dde24d089, 0x002e31b77ebc20e9, 0x0000ec0d94fe675c},
+         {0x0004f90d90a4efc2, 0x0008a79dab767961, 0x005f6916c4415d89, 0x00e8f2cc004811c8,
+          0x00f1d69950e621dd, 0x00c2d2ae549231df, 0x00000cada5a115fd}},
+        {{0x009f493c2458e73f, 0x00dc4a6cb303f5d7, 0x0083f90fcdc09c2b, 0x008416a886c2ff95,
+          0x001ba6d5d26fdc9a, 0x00412d6f59f0d742, 0x00007537fb3f9fac},
+         {0x0062a6438e9aa5ca, 0x0069536a5d17be43, 0x001ca846f902f61b, 0x00df5c24a993bf86,
+          0x003a52456ca17052, 0x004514038ae226f0, 0x00009843123578d2}},
+        {{0x00af093cd9e958e9, 0x00e07ecdf446839c, 0x00ede1a280c208e1, 0x007d528cfb8fc2ce,
+          0x003c59da743c3788, 0x00a96e8b2b2e4179, 0x00005b0ceb281c2b},
+         {0x00bab2b0484a5a71, 0x000e85a6fc27d534, 0x00c330645d8f948a, 0x00357c33c119c304,
+          0x0055ae59269cf0ad, 0x0036ab36b26364bf, 0x0000565cd9c122a5}},
+        {{0x00417504b8b665a1, 0x00f07e74bf56b668, 0x002d60b6f0eca183, 0x0017ba4cbea1ee5c,
+          0x00b418715737b2f6, 0x0071f3d0c55e3a8e, 0x00006218bbe22a1d},
+         {0x00c961dd2e431b8a, 0x002b887411fbd85d, 0x0003977476ee8b7a, 0x00d5ceb5dc8dfe54,
+          0x0036a0b4fa9deab7, 0x0021edc7123d7668, 0x0000521772025c12}},
+        {{0x0098a0d28907fc1e, 0x00128b36fb674e99, 0x00fd93ae84539e45, 0x0067e5a537281c21,
+          0x00e474ba4c4492ae, 0x0046b2eef409f46d, 0x00003f5e2a408a7b},
+         {0x0020f27fa6673863, 0x00092f4d9ac24d7c, 0x00ea36a12266651a, 0x00e7c5a21a837822,
+          0x00f41799ba70f604, 0x00a2d7e614a30a9b, 0x0000a714ff58c9d3}},
+        {{0x0037e0d269c85ecb, 0x008102999361286e, 0x0058b3d9673abbac, 0x0055f23a8fd92c79,
+          0x00eede1604cd923f, 0x0032251242086943, 0x00003081c2942616},
+         {0x001db5e857e414e8, 0x007271a255c8d933, 0x009fc82773c061a2, 0x003ae1da09d22756,
+          0x00959fbf34b21e0d, 0x00a279afaf751889, 0x00000dc36448d686}},
+        {{0x00c69afd0a6953d1, 0x004e634b49dfea2c, 0x008579a01629c771, 0x003a6aa34dc1123d,
+          0x006cb467d9d38199, 0x00a8d2095d80500b, 0x00000adfd6a7a0ca},
+         {0x00ad4caae65b3a8b, 0x00dd6d7214cbd914, 0x006acc10614608c9, 0x0040afdee77791f1,
+          0x00fb66215b58df95, 0x00dac16471282ad9, 0x000058e066400879}},
+        {{0x001aebec1e2017b7, 0x00967eab67561266, 0x00262d29930b45b5, 0x009e8281178abcf8,
+          0x00d7928e0041b594, 0x00c1c5cdbc35c1b5, 0x0000a7d93ab64c2b},
+         {0x0055243d023f9a38, 0x00a4f50f75ef4d58, 0x00a69a90044b0340, 0x0086be2a07f767bb,
+          0x00da27a83e85fc9e, 0x0094b7ba70b2e036, 0x0000be24a58e7fe6}},
+        {{0x00c6e59ac4fbc4de, 0x00d1cf5aedd4ddc7, 0x00ffde1dd819bcf1, 0x00b8b04eb68aecdf,
+          0x00229101c8471102, 0x00f8d5339ebe1fc9, 0x00003f87a1cdacd6},
+         {0x007027e138238b4a, 0x00b1591395a6027f, 0x00e0f91d8f4642e4, 0x001fc5992f2525a2,
+          0x00027b49bf04f3e7, 0x000d7da143f1db1e, 0x0000660422d47f49}},
+        {{0x0032fd701e0c26c4, 0x006f3fd446629734, 0x005e18511ae33593, 0x00ed502fbb92cd82,
+          0x006021821b467e3b, 0x0017a4140281cc6e, 0x0000fb80b971e163},
+         {0x00abdf5945834034, 0x002c371f43a3842b, 0x00825a3e0bd52621, 0x001c75f8f5832217,
+          0x0034c86341167cbd, 0x00347c5f5d4e7845, 0x00000a83651e91f2}},
+        {{0x008963b5fbc5c18d, 0x00dadf46d5e0e3ce, 0x009f64f04460c9fb, 0x004e03cf8c9139a1,
+          0x00686044c7112282, 0x00a182889bc55542, 0x0000b289efda3d7c},
+         {0x0007d31d2195e07d, 0x000c5e3c92c46bf0, 0x004ce94fc84f768f, 0x00f28f4a559b91a6,
+          0x00f670b5233729a2, 0x00a07c5e259a38ef, 0x000057f51d304a7f}},
+        {{0x002549a533d7f511, 0x0045fb5a689dcc6e, 0x000add2b17872e2a, 0x003f7f43ca5ae533,
+          0x00489a17a98610b4, 0x00a3a706f67c17ba, 0x00009530cf6c29af},
+         {0x005b73a884ec5b5b, 0x00100cc1566a8569, 0x00da7e50060fb239, 0x00474d66902cb980,
+          0x0039db5c544c3f8c, 0x00b8ddd442e44cca, 0x000027d4a1127b5a}},
+        {{0x008fec43322ff7ac, 0x005527144ba06f25, 0x00dce218723f75c2, 0x00c27b948909801c,
+          0x00d98f16874e5a10, 0x0011916713f2e210, 0x0000d4d188007c09},
+         {0x00ac5b2c9d80a556, 0x00c3587fd7901fa5, 0x003ea4fdd9a9ada6, 0x0083cc396ed5bf90,
+          0x00de0c092d558f94, 0x0088de5889a5c17e, 0x00002bd034b97e68}},
+        {{0x00d607738454893d, 0x00f27fbd7b9285d5, 0x006f8b7c12a8418f, 0x004250941e770d4f,
+          0x002c2457175b8ad5, 0x00beed072eec3b2a, 0x0000c8a919a7ea65},
+         {0x007bacff2abf9f3d, 0x006b50120fedc052, 0x005d3a8fe0112bb1, 0x00a800cf7e3667d9,
+          0x00d7ce0ad51a34c1, 0x00fda6a3ecae11c9, 0x00001f46ec4ce583}}
+    },
+    {
+        {{0x0065876369feeee8, 0x00f7de8d4a71ddb0, 0x00862fb21fd4b1fd, 0x0099cee80c69c951,
+          0x00c26343ccd9fa55, 0x0093513fd704b7c1, 0x0000f910ebfbb408},
+         {0x00787c6e78a34642, 0x004625a14c33ef67, 0x000709f4a12ee5ee, 0x00568a25622a10ae,
+          0x00e6509710aff206, 0x000a737648b908b5, 0x0000c62e2af74719}},
+        {{0x00eff3770a75674c, 0x0056c4ebde570515, 0x005266e0a101a6e4, 0x00cf28893122f2ea,
+          0x0018e5519c842751, 0x007d5129e474428b, 0x0000f167656e5406},
+         {0x00174338bac64d61, 0x00866fd35de55727, 0x006f68e20e9ac9ad, 0x00d59d2e69855351,
+          0x005fc17891152472, 0x00873ed25ebe80ee, 0x0000f422050f1fa8}},
+        {{0x00d5e1cf6a2d14c2, 0x000b6be159fef47c, 0x00862b9ad41bda75, 0x006e538ef8cc44a0,
+          0x0076cf88eee614aa, 0x007554c82e105a6c, 0x00001d2f846b6060},
+         {0x00de417cf62402fd, 0x00dc3dc83f40e213, 0x00aef6234d7ff83d, 0x00136514ebded521,
+          0x00c99d735721fe31, 0x00e383d0b97c701d, 0x0000269975febb7b}},
+        {{0x00b474740e62d3d8, 0x001b9a1d2c3763bc, 0x009d79d4898d9b91, 0x0054425b98f32032,
+          0x00d044a11f4ee011, 0x0076d776c2928d8a, 0x00000c8d7badb4f1},
+         {0x009a34e595a7f829, 0x00bb70055dba142d, 0x0034e36aed4131b1, 0x00bb6257de00a0b8,
+          0x006ab4f1e81d3037, 0x003c2ec479075fa2, 0x00001b273c7cc888}},
+        {{0x0060e9524a726836, 0x00eeff7734e1fded, 0x0087138028cdfdac, 0x009bfb09d1e397c0,
+          0x008d58f3694a192a, 0x00db23683a731a01, 0x0000434ba50a70b5},
+         {0x00f8141e8b5b24e2, 0x00f0549b3de864c8, 0x000ae66342cdd56c, 0x00568993a490dc95,
+          0x0044b9bb559028fa, 0x009d5fce45cd819b, 0x000006d9727daf7c}},
+        {{0x006bc75cfb474f38, 0x007fe0718b62f387, 0x00624a568fa26256, 0x0000b58de0b8af92,
+          0x00be96537eb9c14a, 0x00153a6a237ccb44, 0x0000ab122caf2c23},
+         {0x00c23e7493cbabda, 0x003c7dc920018113, 0x00794d3fdf740d08, 0x006b75c1242b816a,
+          0x000ebadd272c5e5c, 0x005986c14af28f60, 0x000045b0ccd7a7e2}},
+        {{0x00fdfbd805e9acba, 0x0041b5a82dca5087, 0x0024ca63705972a7, 0x002e9b5cfffdb269,
+          0x0069891ec5f200d7, 0x00a3da4f5870bdc6, 0x00005658c342644d},
+         {0x00b58e199c087a59, 0x00788b951d1bbb24, 0x0073e94bbaf892f4, 0x0088400b5e1cac4f,
+          0x00a288269d1e25fd, 0x003ae5d1e5964040, 0x0000ff44484d2b31}},
+        {{0x002b3701e06f50cd, 0x009aa252d3f51217, 0x0014845658284cba, 0x0041bce5c1822194,
+          0x000dace44955f949, 0x000e8f89a3a94296, 0x00002bae9f8314e5},
+         {0x00895667fe54475f, 0x00362119726bd1a4, 0x002970234bd059ff, 0x005db67b793260c4,
+          0x006feaedb416422b, 0x0048724b0f1e5913, 0x000089c34851a324}},
+        {{0x009e7e35a0439c38, 0x0014c4f0245daa12, 0x009c9c57ec890145, 0x000d7f0c9cf5b8a9,
+          0x006c6f542daf9e60, 0x00bf7c032495f771, 0x00006b0b5d5b078d},
+         {0x00709b2b04e05afa, 0x00cb5910f5363e45, 0x000ea7cd14f16488, 0x00096f355a7ee5c4,
+          0x00000bd9140df242, 0x003636dc32d8acde, 0x00008f416c5bc5fd}},
+        {{0x0087b3d34dbdc173, 0x004766126c811e8a, 0x00c8d5eae84dc9df, 0x0042d2438a08530a,
+          0x0085faca77ba88a1, 0x00794ecb3b2f7948, 0x000084335e294da1},
+         {0x00f7cc1a2faf5be9, 0x00046f02aa86aa69, 0x00afe781a3e45a73, 0x003f4d668a55e6a7,
+          0x0030e1d220e0eb48, 0x00719fe3d17fb3af, 0x0000a119cd9a351f}},
+        {{0x00b63f51f60c87a3, 0x00b72db742916a47, 0x00fcea70137cf2ea, 0x00ecf2b5cf3d9345,
+          0x00b87463fbd42ea3, 0x003638ca2349e519, 0x0000a5d5fa965098},
+         {0x007d3e4716ed0f20, 0x009a4dae1915e844, 0x005aba3fe49e9de1, 0x006292dcf98f1c98,
+          0x00f9798ba45723b2, 0x005e99f3ad16bef2, 0x0000bd5b8b76fe24}},
+        {{0x004dc02e7516febf, 0x00f22127fe20bdcf, 0x00a4dc39ff9b16c3, 0x0047c0159e4ef467,
+          0x00f1d77507d62928, 0x002cef69beb328e1, 0x000016579f72b861},
+         {0x0014d513d6c25c21, 0x006dfcae5d010efd, 0x00e28b4c9680ef63, 0x00c39b0c8237cec7,
+          0x00b71a9ce6f2c951, 0x00f4df0a196117c4, 0x0000386943e90194}},
+        {{0x00d68110fab432fc, 0x0017418259cb7c4a, 0x00ef4a66a1133dd1, 0x00d97af82b50d31d,
+          0x00fba539e6438c89, 0x005ccded8c1f9725, 0x0000dab88a82028e},
+         {0x00f51c072cc2f600, 0x0042db0537991e27, 0x00d3cf624431d97c, 0x00314fb7c7b06d82,
+          0x008276ab36bdfaad, 0x007bd6d8f9963e08, 0x00005a07ad761258}},
+        {{0x005a75b3370723f1, 0x00157d7fcb96371a, 0x00c3e67166ec30ae, 0x0066293f6e7c846b,
+          0x006dab1d6d4c94fa, 0x007521e0967165ba, 0x00009b22c2f226a5},
+         {0x0068e9d834e8e67d, 0x00f8a967896579b8, 0x00d716e880717101, 0x00c5da132d82c61d,
+          0x00b878b7d7455590, 0x002a54bfe039e1ad, 0x0000d7578cf0b55e}},
+        {{0x0074cbbb92874e94, 0x006b1967f7cf41d6, 0x00805f7a02ddf6b4, 0x001eef8eb6d60f99,
+          0x00b6321c93fff0dd, 0x00853a1a7daf3ed4, 0x0000c26e128d1b26},
+         {0x00379247274278ec, 0x00bd20e47c2e6428, 0x00802d6d044b8872, 0x0065caee946bb14c,
+          0x002ad78c775d6ca5, 0x00c1d8f7191c4af4, 0x000062cc960afc84}},
+        {{0x00043ffbbb5ef8a6, 0x003c62ccd4759025, 0x00a560f5afd2e219, 0x00f776ee76c96307,
+          0x0019b09636a26654, 0x00128daaaa4f9faa, 0x00003e9c2dd27f00},
+         {0x00b681bea912e417, 0x003bfa205d7508b9, 0x00c3aba26b122df3, 0x0087023f04685d8c,
+          0x002de357bc005209, 0x004f6bad380091b0, 0x00008e3337f55d67}}
+    },
+    {
+        {{0x00e3af9a82a0214b, 0x00ac26174b97edee, 0x005fb5a0c71086c1, 0x00c46b360775d7a2,
+          0x004a5c2525c4cf4c, 0x004185325c084e0b, 0x0000145ebfb0196c},
+         {0x00f4f6f0198b3d09, 0x00af8984d53cab95, 0x00817be18227f9f2, 0x008ef190c65f228d,
+          0x002a15b0d32ff6e7, 0x001cd1de0255464b, 0x0000d3129e29ed51}},
+        {{0x00f8cc52c65daa14, 0x009c332523fc8aed, 0x000e6efe6d576d47, 0x00f97cb7737a1cb6,
+          0x00574144d6ce03e9, 0x00a7aa49e244bf17, 0x000061378049d80c},
+         {0x00ccf72f3e7daec7, 0x00bd2ca71e7669af, 0x00da29fb53b04c88, 0x00a034670cfa2c4e,
+          0x000e624b91d1e2b0, 0x00b855a2248bf7d2, 0x0000451266c8e7ac}},
+        {{0x00f237e92ab97da8, 0x00fa10cc4885cc67, 0x0055fd6e2538d067, 0x00cd96da32735416,
+          0x002f1d6d310acade, 0x009184ad9a7defc6, 0x0000dd77d5578b79},
+         {0x00634eed8a06da5f, 0x001e4964a8a0279c, 0x001049a50cd76a34, 0x0066a89654484147,
+          0x00bcdce5048362d4, 0x005a71c7841da753, 0x000080d61716412f}},
+        {{0x009ba3487789af7f, 0x00e89e7557fd5c63, 0x002a447423ab7e33, 0x000595b342a76e30,
+          0x0099a7745b6aeec7, 0x00a1d914ee54e47a, 0x00001a4bb4fd10a2},
+         {0x00f77ad5a1692068, 0x007f69f8dc0dd01f, 0x00ad303b87cfe451, 0x004c82135571e192,
+          0x00e1d3ed99a741a5, 0x00ceaafd0c500739, 0x00004533347c139b}},
+        {{0x004fa8b58d0d3c6b, 0x0028d797453bdea0, 0x004d0d03bcecb7af, 0x00751690cc43ac7c,
+          0x004ab18fc9c5c783, 0x00eade8d77ca019f, 0x00000d3687647fcd},
+         {0x00bfa4482b5ace41, 0x0058c569d0e49937, 0x0033667add1f1dba, 0x00b7451f22629ce5,
+          0x0025fa4f8d738bb5, 0x00b02d38d46edb75, 0x00004661a2d64e9c}},
+        {{0x0043e73fc24eea05, 0x0018be4a4ba0259b, 0x007a2c3b3ab86a75, 0x00df2774723babfd,
+          0x0091ae8d3996d542, 0x001462a4bdd3a59b, 0x00001c12d02b6fd2},
+         {0x0053358a496190ef, 0x0094074a9de9e624, 0x00da3b41f600e897, 0x00d6950d8bac4f31,
+          0x008601f211335881, 0x00f335c5ece960bb, 0x0000d2ce10ec87d1}},
+        {{0x00454bac86eeb9f5, 0x00a76e77bd74e9d3, 0x00255d36a15154a4, 0x00742ce2f50c9a06,
+          0x00e47b7ed7c2a70d, 0x003d0da98d336f65, 0x0000cba2cd4f86f1},
+         {0x003f645f6a80d9a1, 0x0057f97fa2e9aa7d, 0x00ef155f766eaad5, 0x00fb159f0bec3d7b,
+          0x00075bd52c9d980c, 0x003066e5e38a3455, 0x00007c9266d2bc54}},
+        {{0x00a993cc5712ffa2, 0x005debd6cff1e318, 0x006f2bc686a7f678, 0x00830a0d97304856,
+          0x00199d695f8dfd4a, 0x00889898dc64ea82, 0x0000995b5b2a319c},
+         {0x0067ebd36d293338, 0x00a729518a9a551f, 0x00639b8e1e809893, 0x0078f712f289f3b0,
+          0x0022305395b29110, 0x006542df966b7d27, 0x000029e5ae4f3539}},
+        {{0x001fa91b42faeefc, 0x001ed32bcbb489da, 0x0005984bb6cd36e9, 0x001c7b5338befde3,
+          0x00753d68117c2f7d, 0x008b597a7ca0ed17, 0x0000a6a18c5cba76},
+         {0x00641e3fc736074d, 0x007cee75494de19d, 0x00950be36e5067eb, 0x0054867331462584,
+          0x002d5be83b16db6f, 0x008c4007db7b200a, 0x000086ab1d50ce9e}},
+        {{0x0076f0e4bdff85ea, 0x003f5b7a1ade6457, 0x0026c922627cc0d2, 0x00c9f300c9abe4b6,
+          0x00605f3dd22ee63a, 0x001529624359e9b4, 0x0000453ed235ec67},
+         {0x003519dcf4b8c4a2, 0x001598ea7c6dcbad, 0x00c51515d5f79d97, 0x000a1765399883f6,
+          0x004ef9fbfe10fdc1, 0x008b4289c14d5c5d, 0x00009881a4abd884}},
+        {{0x00f20afc91b8df1b, 0x008bc50e522d4d73, 0x00333bc015693b3e, 0x00a21ef7c229579f,
+          0x001ec36fe07eee6e, 0x00fc8a2d2d11b402, 0x0000e40dffdf158f},
+         {0x00f0331dc7c8f44a, 0x005226f4c70bc489, 0x0056f28e5d235487, 0x00a3170d717693c9,
+          0x00f9973b61e9d0b4, 0x00d7725aa56d7b3d, 0x0000a1e4e5a0609c}},
+        {{0x000dd2bbce1f1675, 0x00e23fc8bc579372, 0x00a45a1ec67c86aa, 0x00351a5ff73054dd,
+          0x008cec1d4b3f46a5, 0x00c199277683f482, 0x0000f2efcda38051},
+         {0x00b0f80111b868c1, 0x00e2474513e2088f, 0x0003022c47aa4759, 0x0068705959a03d2d,
+          0x0044ae553bd6a047, 0x0019f2098360e482, 0x0000da6a9f9a23d1}},
+        {{0x00e7adb1c897d8f3, 0x005409e9a70d44ed, 0x00a689d22312e715, 0x0096f62a4cc04fad,
+          0x00462e28140f57cc, 0x0013e52d4d133f75, 0x000011e30cbeb783},
+         {0x00441d0580a99af5, 0x001b10ad72879a0c, 0x00ec2b0706c2b7a4, 0x005bd3d35ac2ba16,
+          0x00cd236c6faf5558, 0x00fbc6ccc8f9f3e6, 0x00003cc5112b864e}},
+        {{0x00d7a61daaf53163, 0x00e0fb1b7e57371c, 0x0085085ca927cc0f, 0x00972c20c9a0c579,
+          0x0097da945ee01417, 0x00b2835eb0b000ea, 0x0000cab98b62bac4},
+         {0x001fca9bba700584, 0x003a47ebb3f29d10, 0x000ee53d4780d903, 0x00e6f7bc869510f8,
+          0x00425fe1dbeb5943, 0x001799b2c1e3e75d, 0x00003beba4dbdffc}},
+        {{0x007e09605f2afc46, 0x00cc918e04daacab, 0x005ac8c8000921ec, 0x00799364921af116,
+          0x00a7da7e8e66f59c, 0x0017dbfe366b2e7e, 0x00001f43fb833c51},
+         {0x001a3150858dc921, 0x003ef0478b67cbe8, 0x00d3896f0b5f249f, 0x00076525ccc98064,
+          0x00073de438245ae4, 0x00f857b21421fc92, 0x00003207733fd67d}},
+        {{0x007413001580ee63, 0x00232de392c17172, 0x0071fd81259f6bb5, 0x00c94f7c33e0f05b,
+          0x00a5a102a84e06a3, 0x006adb3dca9d222d, 0x0000e52b9b0d8457},
+         {0x00997dc7e4a704db, 0x00932844b8df447f, 0x00dee10ed4b59d96, 0x00d842f98b4db920,
+          0x0064684c234659f9, 0x0000a4fdfe562edf, 0x0000f757edbe7a38}}
+    },
+    {
+        {{0x00b00841cddc521e, 0x002af68c57c7608b, 0x00ad9183a9c70b6f, 0x006e1cf66fa052dd,
+          0x0070420799457dc8, 0x004a496aa1a811d7, 0x0000a53063f55d4f},
+         {0x005ff48042848025, 0x00efbb1b6411e9a4, 0x00576adb3b812844, 0x00a8801995f0b663,
+          0x0031f284077315a3, 0x004ce10b85cab2d3, 0x0000150c10ee0eec}},
+        {{0x00dbfd58a1a61c3c, 0x00c74566d210b5f5, 0x0075d466aa8c99b9, 0x00a1da201a37ed91,
+          0x006280718d8d948a, 0x006e9a2601dcf98b, 0x0000d2209fb4095b},
+         {0x003719f4b163f359, 0x0033cbec9083ba9e, 0x001f59582b75bdc8, 0x00537c70924941d1,
+          0x003af40b682f77ef, 0x00231ba20670c59e, 0x0000c73d6ac92a93}},
+        {{0x00ab2223d8776498, 0x00d3695b4bfe81e0, 0x009c1ce1af55d2e1, 0x0047056f31854d2d,
+          0x00cfb06781f4ac1a, 0x0012b6d1dcc2d94e, 0x00009036d0791cb5},
+         {0x006596c3d4c3b2b8, 0x009656f9d0d7678d, 0x00ea02b052d2ff9c, 0x00f2d2ce16dfbd04,
+          0x006517fd6732b521, 0x0069354195651093, 0x0000b06a16d8eca9}},
+        {{0x00c3b9d675ef7ece, 0x006c2d84439ac81a, 0x0016ee89fb8a4534, 0x000e29eed161a162,
+          0x00d258a2a5be804e, 0x00b8956272beeb51, 0x0000ba2213c7ad62},
+         {0x002346250328049b, 0x00a0c08e055df002, 0x003826deab8ddab5, 0x00df5f1ec14759e1,
+          0x0056b3829132448e, 0x00869e1c7edccc10, 0x0000a8fdb93c446d}},
+        {{0x00e3073b91dae8ec, 0x00e6cfb987b7360d, 0x006b98684f1d944d, 0x00bb325c037f6ff1,
+          0x00bf53251a4bed8c, 0x0019fa6b4b8ad649, 0x00000a47161c9061},
+         {0x00cce246656f6fb2, 0x002f98f0b2fe6a2c, 0x00bab13426e08e1f, 0x00a5fe45b697f5fc,
+          0x000a631b05ff4a48, 0x000a6d5925c9f8dc, 0x000024c0815ec679}},
+        {{0x001edac696341903, 0x00c984ea95681d5e, 0x0028490ac8433f4f, 0x000ee0ff843d5a4a,
+          0x0036bebe073c6068, 0x00cf10df36d1ac1a, 0x00004272cc0da334},
+         {0x003473d47636c262, 0x00b72e22481a0d01, 0x005bb2e3c7a318d4, 0x003afda38edaf560,
+          0x0049a8c5afeb2a5b, 0x00645698c741a80b, 0x000025a44c03f641}},
+        {{0x00617ee3e0053ba5, 0x000cba87f1998f18, 0x00889131522afe25, 0x003d1c264da0d3ca,
+          0x00c5794b5d50cb08, 0x00f8983fa0afadab, 0x00000228c0a8c2b5},
+         {0x008b24aaa79eab4e, 0x00b8cd28e79c3db2, 0x009c50ed0f924900, 0x00246b3c3117e0b1,
+          0x00ac575378e0b4d0, 0x00fd5d066f424dae, 0x00004e1b69149d49}},
+        {{0x00b8e103cba5648b, 0x00b9c4ba2239ebac, 0x00aa4ef0651062e1, 0x0079969669337ef5,
+          0x0081c70a39bbaf3a, 0x005d9352c59e322b, 0x00001aeccc3245ae},
+         {0x002f2e570abad918, 0x007dc971234eced6, 0x007f58553d2d44c9, 0x00578d212b456002,
+          0x00992f9226930e51, 0x003761b12e5af154, 0x0000dd24a95db874}},
+        {{0x00c7ff154a96a3be, 0x00b59370bd8ef525, 0x00ea62399bb9ab01, 0x0063e8e7100ce18c,
+          0x009368bde736b919, 0x00c878b541eabbb1, 0x000028f61d4f9fd7},
+         {0x00a1863493e61c2d, 0x009af7f3e469605d, 0x00acd9802b0b0590, 0x003543af577ab305,
+          0x002b5234c058cc66, 0x00290f7b6eca329a, 0x00000040709dc650}},
+        {{0x00f38ca9f85faafd, 0x002f9ae0affb89b8, 0x00b29f001855141c, 0x007ce667faaa3726,
+          0x008522290adaead5, 0x0093bca6c47e076c, 0x0000314109d632f6},
+         {0x00f80f5b183b584d, 0x001dab6cb6b9f5fd, 0x00ae257640f5001b, 0x00d10566033cf89e,
+          0x009f106453487839, 0x003777d83741e6b1, 0x0000e99b2dd75fa2}},
+        {{0x0040c97d96accd30, 0x00cefb8c0dde848e, 0x006bf35e618e6d72, 0x00a0c59afa335a71,
+          0x00a81007ef07e1b8, 0x00ccf6f78e68de71, 0x00005740b2d0c390},
+         {0x00cde27e06fc6895, 0x00cc9c328e41a567, 0x00d159c052229e48, 0x0012c65d0f88b542,
+          0x00731c6af97a57a6, 0x009979473a460989, 0x0000895196a1c855}},
+        {{0x0025663c031046bf, 0x00d28d804b19a408, 0x00d72c679c020e33, 0x00ef388a139d97e6,
+          0x0074183052e60d5f, 0x00301b47cb1991cb, 0x00007248a3aa81c4},
+         {0x0090122e6c71c09f, 0x00883c2a0fd9bf55, 0x008439f1609a6d67, 0x009f1ce7a1dfb2d6,
+          0x00e134c53f712ec1, 0x00f7f5f0e1abcaa8, 0x000046b6c5f1fe24}},
+        {{0x007cdd3f7b92fbd9, 0x0007168174eb308b, 0x0066d83f71249ca2, 0x00f23b3a43de3f43,
+          0x00cac0f03dff0cbc, 0x00f44f72339d999a, 0x0000ef0043e4fc46},
+         {0x00a296b6a740cb4c, 0x00c0edfcc662a0a1, 0x00b261f7f743ddab, 0x00fe4f0e9e458f37,
+          0x00fd2db438f2b2ba, 0x00037a767589f53e, 0x00007e2f935e74a3}},
+        {{0x00445f7666065bbb, 0x0004fc35b8bd331b, 0x002cdc2838a901e8, 0x009af7ed88c74716,
+          0x00430f57da275c9e, 0x00ac7dc166ff78e3, 0x00007cb0ec8ceec2},
+         {0x008e82f39f1a7cee, 0x003f3e2bb350fd41, 0x002b80ad189949ad, 0x00e1e5977904ffd4,
+          0x00363334df04500c, 0x00785d90349ac139, 0x000063b47ce67dca}},
+        {{0x00ddc5e7e087b2b4, 0x009f44e20e21f90f, 0x0071ce170d6b62a1, 0x00cab55bb451c7e0,
+          0x005981b29d3bb5a7, 0x009efd3383e40896, 0x00001aea94896848},
+         {0x00eda0ab4a89f99e, 0x00cf889753db68b6, 0x0010107a71d4359a, 0x008e95c70ff6510f,
+          0x002d2a445cabf01b, 0x0025a9816ec67e56, 0x00002dc023b6cd59}},
+        {{0x00e5bf6004091d03, 0x0039a7cab0712591, 0x0024a7e894700005, 0x004a384f83e71f69,
+          0x008d2bb248cda178, 0x00a6632273b22015, 0x0000a489d11a239b},
+         {0x00aec01248801bce, 0x00609a2169436001, 0x0096d5656a523edf, 0x004921fd6c21c19c,
+          0x004e2540ec1273c0, 0x00873350bfece27b, 0x0000be1290e410d3}}
+    },
+    {
+        {{0x00f18c09aa3fb52c, 0x00c236663653f592, 0x003def604f9014ad, 0x00d5bcc56e671102,
+          0x0002cd0a9a0efb45, 0x00cc031fa55ddf3f, 0x00004b43356e9d4a},
+         {0x00d9f2169b02d0fc, 0x00eb064745427c79, 0x005912a408b0098b, 0x006721b63b1f8fce,
+          0x007a28b14f1dc95a, 0x00e625c9914c8e08, 0x0000bf9224587fbd}},
+        {{0x004afca6e2d987d4, 0x0088f99bcf52783f, 0x00fb2ae8f15ed929, 0x002ef0ef360b81f5,
+          0x008df192ed0f1774, 0x0096c8de81c101b5, 0x000081edb994ebba},
+         {0x005201c42fd6596f, 0x00151f366014c344, 0x001b10e4fd21d29c, 0x0014996f8c6e489e,
+          0x00dbbbac54c04482, 0x005b438bb04837cd, 0x0000c4c6090f1b6e}},
+        {{0x00c016b22d821a33, 0x00ca05aeb81a0c8d, 0x006e2322e4d95532, 0x0022aba06e838b2c,
+          0x004f95ef88beca04, 0x006b8d946d53a9d8, 0x00001919bb2f9141},
+         {0x00a640a726cb9e40, 0x0012a08b2b972976, 0x00e5467f85adf32f, 0x005aec3a5abd1109,
+          0x001907e1250e4115, 0x0056ac3a2a9b22f4, 0x000047591b08d3cb}},
+        {{0x007b6d93e8609cc8, 0x008e5bed64388d1a, 0x00a87a2df918143f, 0x0017a4e86d714592,
+          0x00ff2b8aaf9c0a14, 0x00e174354e527db5, 0x0000aa03e980804c},
+         {0x008d4f9ae781eb7a, 0x006eb15d719cae1a, 0x009fc74dbe90bcb2, 0x005d04916810d634,
+          0x0002599137bf8db9, 0x0062e5c2d56ae4cf, 0x0000d2dc77b07d00}},
+        {{0x00581484d34009fc, 0x008f5b3722dd40a6, 0x003ce1b03a2fdc4b, 0x009eac7b4e127f41,
+          0x00ddc32630dcf9c2, 0x0095f4fbdb18f1f0, 0x0000b8824af9cc1f},
+         {0x00564b5f1bab1b6b, 0x00125edcd30e6f96, 0x00743c8a65718a19, 0x009a34bda92e3770,
+          0x0017074be16475d1, 0x00c7720a68f63584, 0x0000a7e2c267524e}},
+        {{0x00f49e68515c4a00, 0x00ceb5c06373bbe0, 0x00df24c308593c32, 0x00acecca7acecfa4,
+          0x00188dffce3bb178, 0x00440be670a1dcf2, 0x0000bbf460402797},
+         {0x003df39cb819ac40, 0x003faa0361933251, 0x00ecfa3657db3799, 0x00cbc582fc8de3b1,
+          0x00d52bd87dc3a1f8, 0x000602d97533df28, 0x00008e54e373340d}},
+        {{0x00773a9058531e38, 0x00becc8243849232, 0x0024e78cdd6e4f86, 0x00736aba702c7838,
+          0x004f76646875edbc, 0x00c358455d4c358c, 0x0000dd54bbf8c72f},
+         {0x00567c23175dcb5c, 0x0089e3004d97fb7c, 0x00aca6e31207e528, 0x00ff3b1028c6a2bb,
+          0x00d4bbcf20fe6e8b, 0x0092b490de9a55a4, 0x00000378b8c220e3}},
+        {{0x009ebc7ef2c6f6fe, 0x00779f0cc9b8e4af, 0x007c6a441f61eb94, 0x007057cfaf08b658,
+          0x00816cd4802c808d, 0x00b5ab3eff91fdaf, 0x0000bf84a9a55523},
+         {0x00d7d33910b4db22, 0x00f1018cf9af8ab4, 0x008305faaaafa3f0, 0x00e03861e334b95b,
+          0x001dbc7337c3ac67, 0x00d51feae4442f48, 0x0000707b147c0f5f}},
+        {{0x0000e158c27b35e9, 0x003f6b33002ad9f9, 0x00ea5936017ef21a, 0x001b45a10a4c9418,
+          0x00bdc4204c84bbc5, 0x004ecf45bd4c36ff, 0x0000c13b52cd7906},
+         {0x007e461303aa4d23, 0x005746dc623cba6f, 0x00c5d82436d50326, 0x0034ab1792e4fc35,
+          0x001100f95a069ce5, 0x00d31357b34ee148, 0x00001779985dc2aa}},
+        {{0x00c711d361ebc815, 0x00084448108f90a9, 0x00f7712f7d7664da, 0x00e46fdb59b24582,
+          0x006666b75ee49e24, 0x00dfa536cadcf752, 0x00002e5e7996a9a7},
+         {0x00b5b1370191bb2b, 0x007025fd368c718e, 0x00ef96fe69d66d2d, 0x0007aeb867f0e1e3,
+          0x00b987f9be8d43d9, 0x00d838fc821c0036, 0x0000a2f45f095bec}},
+        {{0x001baad32938facf, 0x00bf0dea361e7456, 0x0016a39527191b6a, 0x00d5d459914260ed,
+          0x0067adf20859c348, 0x006dd845d6314f5f, 0x0000088c51642cf5},
+         {0x00dec363472740e6, 0x008b4fa5d785f5ce, 0x0025b803f9aee127, 0x007592e14f8ff150,
+          0x006c395ec322aae3, 0x00e51785d7aaceda, 0x000052c4453ed760}},
+        {{0x0094b6a9893e6202, 0x0060b96c06093553, 0x00cbe8c3edfa6a79, 0x00d16e4a21da8c89,
+          0x00c568d8cf7a733b, 0x0070205df9b62575, 0x000086d0a707c7f6},
+         {0x001d7a48581b6cf7, 0x00dac21d27efd7cb, 0x0042fd32cbeb0a31, 0x001addfd217db558,
+          0x0096ebe6fdac9bf1, 0x00aa19e068a2dc01, 0x00007caa50ff7303}},
+        {{0x009e84cbfddb012a, 0x00e60debb7cbbfd8, 0x003ad9767d8e2f41, 0x0078c23a85612a17,
+          0x00536e4f5579e025, 0x00673af69c283676, 0x0000b3ff3dad8ba1},
+         {0x0084dfa6b77b24c5, 0x00a85afba7fa6c30, 0x003a66cc266a3358, 0x00332857391ead1f,
+          0x00aff4211ede971e, 0x003349d40e20b916, 0x0000df2fe6a2c631}},
+        {{0x00d00608b13a7398, 0x005f8223dd622bb0, 0x0071286e41ef4f7a, 0x0041530e21f45efc,
+          0x00f7ff02176ddf55, 0x007a461535e77e51, 0x0000bebf9d8339c7},
+         {0x0013dbf33ebc699d, 0x0087e29fe4e12ab8, 0x00c22ec9ea416749, 0x00a49fba6979ff29,
+          0x004017aac3d8f9fd, 0x003cb8fc005bdc48, 0x0000f883e6f2093d}},
+        {{0x00fbb2cb805d1987, 0x0093b7784ff22cb9, 0x00accb41b5f74d27, 0x00c991ffa30a9b0d,
+          0x006fc00a843a36db, 0x007dcb923ae88bfe, 0x00003965ad1aae02},
+         {0x00c69ad65db748d8, 0x00d6c949809a39b7, 0x0055c27c58b0cded, 0x0067e0187731a8ed,
+          0x003c12243d568616, 0x0086843847bd470f, 0x000052e32725faa1}},
+        {{0x00d89c74ee69fc0f, 0x005177777bd97ccb, 0x004a03955391ceaa, 0x001b6fcf81e11357,
+          0x00591d1598bb969c, 0x000842d1c6bce564, 0x00001ec28025ba33},
+         {0x001e4b9e34829dc8, 0x0007d15b2aaddefd, 0x001c25ecf4741b00, 0x0070ba0b4d391dee,
+          0x0042b396d41ee6ec, 0x00279ce3c9e311a9, 0x00007bbc02cdba9a}}
+    },
+    {
+        {{0x00588514f72584e0, 0x00d20f019aca87ee, 0x0096ea7a5c797d3b, 0x00d2a5cf08c78f7b,
+          0x00aad0f1941d8442, 0x008c828d84f3be60, 0x0000f94dfea620ad},
+         {0x00748e64ebf46b90, 0x00f42702e421d6e8, 0x008aeaddfd7f0c86, 0x00b65e4ead4f1850,
+          0x00a85c8cbe0387e0, 0x001c47301157448c, 0x000018bafdaea14b}},
+        {{0x005dcfcc46fb3d63, 0x0024cd1072534d0f, 0x00d66ac75da695a6, 0x00d47a1044b6ad34,
+          0x003a465c0b3ccf02, 0x0070bd24d1f00555, 0x00006f44b85f8cea},
+         {0x00d48d41969ed02c, 0x00fe8715b257759e, 0x0031d382eccc2ef7, 0x00d3971d8ec19b2b,
+          0x00c087d625cea93d, 0x004ec3abe969010a, 0x000098aa85b54c25}},
+        {{0x00d6e579ce5bb23d, 0x009f9702e205b5fa, 0x00381b3ec947b3a2, 0x00bada0b0cf46434,
+          0x008386ca91734cb6, 0x00ee25f2738a4037, 0x00006e212c08e61d},
+         {0x00b64f205879ffcc, 0x000a78f901b566aa, 0x00b663e92693167e, 0x00e5f9a3c7ac9d40,
+          0x0079c0be288b5e15, 0x004c181151aba50e, 0x00008062ab95f1f8}},
+        {{0x00ac48cfb197a532, 0x000949b5427a45db, 0x00b0e2bc84c91c01, 0x00e14bf6a69f5b65,
+          0x005b3908868f43c3, 0x00efdc36035df6ff, 0x0000392891c93aff},
+         {0x008f0e95436f4606, 0x0079798025fca883, 0x006843d830f35447, 0x00fda86fe55c8e9f,
+          0x005b61f5a1e52b94, 0x008fdeb44d516241, 0x0000a6980802fb96}},
+        {{0x00687860177695ba, 0x00c654e98d75324f, 0x00f2b27a8494ae48, 0x00014a062fb17c14,
+          0x00d6f26f33f4c480, 0x005fc92e6650a8bb, 0x00000253acb6a601},
+         {0x00939727eca833b6, 0x009355c98dad56bf, 0x009eae2dff7fb6ea, 0x003ce21087e65d76,
+          0x000b7c757f3d115d, 0x00eaf6dd72d4e950, 0x00007d3d78b3e1b9}},
+        {{0x003221c33a402c13, 0x00f01ee363064215, 0x0078f5bae06cf79b, 0x005d32d663f14be7,
+          0x003e5c6d9a132e4c, 0x00f1c39bb4b33270, 0x0000518da662de95},
+         {0x008f54ee1039efa1, 0x00b3c2e2b6e4b86d, 0x0050056e3c508f57, 0x00da4b231abc6d89,
+          0x006f3383981a2685, 0x00bbd2c877553863, 0x000067c3228c1d06}},
+        {{0x007abf7b2e6d4f35, 0x00279aafc41abdc4, 0x0059f1486bbf801b, 0x0009b26f1463d3b4,
+          0x00de2b7a41eef4b3, 0x0043975046e8d74b, 0x000095dd8005dd7f},
+         {0x00a39d2ae3c913e5, 0x00028199f6e18ecc, 0x00e6c41f7bb74f06, 0x00da12b437b7a180,
+          0x00795b9518362bcf, 0x00ba8d8bf5ffb137, 0x00000f2f231c2624}},
+        {{0x00dc55ae2790df1b, 0x002ac6b174686a7d, 0x00e90eaa795f0220, 0x00f6f1e3bbed107a,
+          0x00a50644c6a67ca3, 0x009898b23eb9cf20, 0x000002e76b3efd46},
+         {0x0041388ee298cd81, 0x00779b41bbfec23c, 0x00d0193a47b4dc12, 0x00a2c08dacc9e426,
+          0x00bfac8d4ed47bc4, 0x00fdaaba16e6c9a1, 0x000053d24077d10e}},
+        {{0x0082ae1a29e8d10b, 0x003e00f904fc83e4, 0x00d0d80ba93de0dc, 0x006369b41672639e,
+          0x00c598e917274efc, 0x008dedc4d9955fef, 0x00006bebab22b1b6},
+         {0x00b267d4500f2aa1, 0x008ac157aaed1bd9, 0x00fcbc23fdc92eba, 0x00a7e153769b504a,
+          0x00ed6e997be09393, 0x007cc1156a9c024d, 0x000054be04c50e60}},
+        {{0x00b1e38a80affe06, 0x001c32f7510977b0, 0x0011acd765ab2dca, 0x0063e3c10015dd0e,
+          0x00a83b87e639ed7a, 0x00a37c46cef58041, 0x0000f58c8f8b479f},
+         {0x00ddd05089d31735, 0x0054bf481eed32c3, 0x0020369842c72c79, 0x00ed21484dc8c311,
+          0x007988aaf387f769, 0x007c25f5d40a9f24, 0x0000dcfd5e5b9448}},
+        {{0x007ae8e41b181733, 0x00a53122495e5dc6, 0x0053567bf3e99908, 0x001693b6acd29998,
+          0x00b0f8443693a42c, 0x003a40f5ddd1aa94, 0x0000aab27aad613e},
+         {0x007d5fb0f75b5b57, 0x00ec1c641e9df2ce, 0x00447af48a17e79b, 0x00ba62eeb28a34d4,
+          0x00dc8fc0cd86ae09, 0x0002c9fd8d6f1ed2, 0x0000848650f952dd}},
+        {{0x009b4810636aeca1, 0x0040f39405514c69, 0x006167306f357b8c, 0x00c98959cbcc4033,
+          0x00355448db4e6996, 0x005178945f14ca2e, 0x0000baae29ee5b9a},
+         {0x00f7aa36b7261045, 0x00ba11442662aced, 0x00b342cf8c899c02, 0x00201b781e9d292b,
+          0x009950498b1cefd9, 0x0073fcccc56a2695, 0x00000ff0a21d6251}},
+        {{0x002d085e9819d858, 0x00e036888859c00c, 0x00395ca94d00d496, 0x007e7f8f59206ee5,
+          0x00abc72550d04285, 0x005994821a716fac, 0x0000457db27541e3},
+         {0x0094736196f6f3bd, 0x00ebb7c0cd55052c, 0x00cb893ed69ab816, 0x00a07dc9a86b88a8,
+          0x00270064399049a8, 0x00ac8f325f4abe58, 0x00009e2e91113451}},
+        {{0x002b24b27e983395, 0x00958658cb93e80d, 0x00aa09115059ce5e, 0x00f8062719c1ee00,
+          0x00dafa797bdda5d4, 0x000a81b3848c77aa, 0x00005a58d9bf2d87},
+         {0x00382f52025a1b0a, 0x002c2263f6dbab0b, 0x0009af75e1749928, 0x00b93ec1949c7a45,
+          0x00d9625cc24e34f2, 0x0075a58fb358106c, 0x000073aa6417fea2}},
+        {{0x00995fb4a3a8f329, 0x00bdad5b8067547f, 0x0063899ae9b7f83f, 0x0064432b3825fd65,
+          0x00f3ddfb3fe49dac, 0x0004ac8bec7c271c, 0x0000a920c72a52f8},
+         {0x00a6d3645651d4d1, 0x00a84d2344270c8b, 0x00425bb49f056276, 0x0068a46ae475902e,
+          0x00c00d466914e0b1, 0x00ed8e008da86a7c, 0x0000688e1925fc6f}},
+        {{0x00e2f3013c8769ed, 0x00d66a6cde423d14, 0x0001f9b585bc3774, 0x00c19636f5aa5137,
+          0x00209aad893c8008, 0x00e90a40964ab2a9, 0x0000038bf01ef8e1},
+         {0x00b187e28fda1cec, 0x0036a436f7626072, 0x00452a957afbe568, 0x00f2b6ac21028308,
+          0x00e336274059981a, 0x008f8f92573f3da3, 0x00008b23082270d9}}
+    },
+    {
+        {{0x0054c7b3cd2a0fa1, 0x005b49e4f7287e70, 0x006239417d0c57de, 0x00f757571dcd5a04,
+          0x00b825b305ff0f39, 0x0005d3407b161207, 0x00005ac7ca646ec8},
+         {0x0071ac20a1f0c1e9, 0x00018d9ffdb927cd, 0x008a7cad09b62feb, 0x00c3b52c06ad9306,
+          0x007bf01df9c9380e, 0x00d6d8f733da2aad, 0x00004dff2dab40e7}},
+        {{0x00efbe1c9ac7d6d5, 0x0035bff699284216, 0x00273b415f7a5263, 0x00c5c2766c7b349b,
+          0x0012323b6b172df4, 0x000af62364e85d0d, 0x0000e90d5235a25a},
+         {0x00743211ed1a91e6, 0x0072e95b859e5136, 0x00845b6770c4212d, 0x008cb85c9a5b6ba0,
+          0x00ad527f49551d65, 0x00e92451f89c5dce, 0x0000c15cbae167ef}},
+        {{0x00b8aac23d0a3a3d, 0x00b7a243df476961, 0x004a2b9820976af4, 0x008c4b05b07c879e,
+          0x0074c05facd99095, 0x00c701727f5a2e0f, 0x0000654d385089a9},
+         {0x00173e7b1eeb1bc2, 0x00e85ed31cb592db, 0x005854e3dc93dab0, 0x00e8b3d7ed205dc0,
+          0x008e322ff7ae521e, 0x002f5178ffdae674, 0x000064d3dd86dad9}},
+        {{0x00a3180c63716fe5, 0x00e465dda835c3a3, 0x00c677493c2690c3, 0x00380f69a509a8bc,
+          0x009c8b7a861a28eb, 0x0033ab3badd35e7e, 0x00008857eb032eb8},
+         {0x001f8988f5a80335, 0x0029677ee6121094, 0x00f6b3274ee31eaf, 0x000f1971f0f27f55,
+          0x00e56ff1bc80c36d, 0x00d7f1324744980b, 0x00000d7e9bd7aff7}},
+        {{0x00decf80de54ec0d, 0x0093f607d2a5ba83, 0x003746c2415b211d, 0x00560a1ae7dfce8a,
+          0x007afdeac7b9e73b, 0x008a932b3553e182, 0x000027e70207f885},
+         {0x001715743065ee05, 0x008502705a22e7e9, 0x00dc76f58775aa7b, 0x0000095c61766991,
+          0x00d791fca0fadcff, 0x00767cb6f8f5d363, 0x0000f1cf751ceae1}},
+        {{0x00b2535d6333d033, 0x00aa73a616ca2d9c, 0x004ca7ff4bb293bb, 0x0016c98ebf4e1098,
+          0x003f17cc406a5d3a, 0x00d2a9d54401aec4, 0x000065b6ee19c6a0},
+         {0x0082b607bc401df5, 0x00fc25b57c989b7f, 0x003d0855875e7e87, 0x0093fe007e1a9a91,
+          0x004e7457235d7c50, 0x0041339ade81bd26, 0x000073ca11b7baec}},
+        {{0x00d66e0b94473655, 0x00fc08f8ca0a22e2, 0x003fe3325af58559, 0x005c381339ba0a45,
+          0x0046fa356c03b54e, 0x00867ad35e424a8d, 0x00000367a9b5420a},
+         {0x00ea5889ab4c080e, 0x002c77ae403f577f, 0x005cd684e59f1387, 0x00f3788563137823,
+          0x0031256ee2f2e6e3, 0x00fbfb7ef24f34fb, 0x0000669bb1c94a39}},
+        {{0x0012e340f47168ac, 0x00d3a09008070591, 0x00a1cc7fdedf3917, 0x008512e48ab6971d,
+          0x00f6297ecbd8aa25, 0x00b6a3804100caa7, 0x0000f19c3f9b433e},
+         {0x00e0b1762d8b523f, 0x0078cb39d2cf6c45, 0x008bee4928be1b70, 0x005a620149af40b6,
+          0x0038904565d24d48, 0x00090c4a1e9b515d, 0x0000ae61a171f610}},
+        {{0x005256b767602319, 0x00db0cec8289b7b5, 0x00c30127ace8c490, 0x00bd4ca8761790a4,
+          0x00795407c8b8200b, 0x00672cb2b20998e2, 0x000068fd5c393d9d},
+         {0x004f6c3ac2c89456, 0x00deb1d1fe5b4ca0, 0x00cba77cfbe0a6a7, 0x006b12dfbd30deca,
+          0x0045741eaa591307, 0x00a9449c1851e189, 0x0000aa6167a0d16f}},
+        {{0x00d2764b3d832949, 0x002277f0bbfb2949, 0x00bb73c2994e9233, 0x007db0f77d5e7e8f,
+          0x00a36d0a01c17e18, 0x00111fb8c12d13b8, 0x0000b78608bd5fa2},
+         {0x0041226001a06e66, 0x00c7f03548442fb3, 0x00f2016e53be9dd1, 0x00d0320be556e78d,
+          0x009f297224555c71, 0x00b61b8a0fbd4326, 0x0000912ea799851e}},
+        {{0x00f0aae7c45e074d, 0x00fad0c0876de8f4, 0x00ee324ce3f81fb9, 0x00fa0a8c62375c03,
+          0x00ca7578acbcf47f, 0x0060de36b11f8541, 0x00003a5f60a64ce1},
+         {0x0089ab05322c2146, 0x001009a62f0880d4, 0x00addaea2c1fc9e9, 0x00d2deb617d54ee8,
+          0x00c8f3a6e5b98fcc, 0x005255f14916478b, 0x0000445ca22d38be}},
+        {{0x007f4d5c49f4031f, 0x000d51ea2d68b5bf, 0x00938fa88d5c955b, 0x00389238a9cbf343,
+          0x00ca986659f84e9f, 0x00489288299fbe19, 0x00003a56098f7876},
+         {0x004993ef90e24715, 0x008a0ad4fe7a402d, 0x00b43770956d9f0f, 0x008272b21da854f1,
+          0x00f275baec2bd528, 0x00324051beace596, 0x000077a5923152b4}},
+        {{0x00b4d0a0fee7e7a9, 0x00c43450ca627d16, 0x00473af29b3de1ae, 0x00cfc8493e0e66c7,
+          0x000a09839a492dc6, 0x0057a918803abc1f, 0x0000f453c6166680},
+         {0x0091d2edb91569dc, 0x006360fb897d9f26, 0x00794e355c48da09, 0x0070d27074bda2a8,
+          0x00fae179eb15cd47, 0x005b471fee3a7f0e, 0x0000f7f9ae90061b}},
+        {{0x00028aeab68f04c3, 0x00bcc37924b104f4, 0x00d1a468efc5afc4, 0x0066cac003eb2756,
+          0x00b8ce6f3f37f5cc, 0x00d8a7438c7b0718, 0x0000c5f6f0ade3ba},
+         {0x00b93429dfc33aae, 0x004c1905e6b6b411, 0x006e5020bfcdd7a8, 0x00d329ae65055509,
+          0x009c7a4a37e7f0b1, 0x002ccaef176f4b12, 0x000043080f9c7177}},
+        {{0x0007c671eddf12f2, 0x006edb5dcf9e954f, 0x003d7d750595453c, 0x00ffa025e7c38362,
+          0x005537f260756615, 0x00b1d3f205868d6f, 0x00009dfbf4d5cf79},
+         {0x00b77d8fcae23ede, 0x00d721d1928b8e29, 0x006db28bb04031e0, 0x001a20e9529f9833,
+          0x004f272bf9b80bde, 0x00e8f2a75e0dd46b, 0x0000a2faf4c8f9e9}},
+        {{0x0012b0ef98ead16f, 0x00864706825d81c1, 0x00c05d71483b5478, 0x0077258ff1a45c8f,
+          0x0031bea401034bc5, 0x0073057ef609d88a, 0x0000a46a47ddf469},
+         {0x0020da3240448eeb, 0x00e56ca459fa0ece, 0x006b69f6fb491c25, 0x00637265138c96ec,
+          0x009ae89999443876, 0x009d9185854e3731, 0x00002fa72bd3d53e}}
+    },
+    {
+        {{0x00bc769c51032bf1, 0x0055a6236442c537, 0x00bef906a056aa32, 0x006c89583a8814ad,
+          0x0033ff31bb7b6db5, 0x0057b329676ef73b, 0x0000e6ca49e150d4},
+         {0x00801510f83d65d6, 0x0083444782094e61, 0x005d56e9baec9290, 0x002ced0257698952,
+          0x00b245c5ab2683e7, 0x00df5132e5722e34, 0x0000fba7e4ada13d}},
+        {{0x00002aab1d45a723, 0x005f4e14360bc1c9, 0x00e50f3e56a453e9, 0x003923e885664b60,
+          0x002d62ba742c86b1, 0x001a617764fb2e24, 0x0000a71b35dce05d},
+         {0x00448b99b6904e62, 0x006e9e070539817e, 0x002352f40c442e70, 0x004789d1cbc9f598,
+          0x00bef1ac969402b1, 0x00eaac11ca9df186, 0x000039661ecb0210}},
+        {{0x00038571420cebdd, 0x00f9abb0662802e2, 0x009131ea37b515c0, 0x0088e936ebc2d269,
+          0x0000ce362d959bf2, 0x000005e6f6c7ca65, 0x0000599a0b8fb55d},
+         {0x0055fb8fb25d2777, 0x00ef47caf29ea1b6, 0x0084d7795f0477d3, 0x0073e890d641be06,
+          0x00c3ee583ec22ba9, 0x00ec48dd9d0d814a, 0x0000cd03bf4b6dfd}},
+        {{0x00004b5dced7e5ce, 0x00bb163706e5acb5, 0x0084c733aa386073, 0x00ecb753834fa638,
+          0x004cd0d472c8dab9, 0x003dfceb3468e987, 0x0000dae976e4bee3},
+         {0x001f4f0c28fd84dd, 0x00946ae323431bf6, 0x00975da6e7e8f32b, 0x005e9f0ecce8c517,
+          0x008a86b5a121a936, 0x00705bed5b9f08ff, 0x00007453fe3054d9}},
+        {{0x00cc51e188900b72, 0x00523fd6cebafe3b, 0x0098e565da9c96a5, 0x00b0b442cf5d0d7d,
+          0x00d2a217761a32be, 0x00ad4cc8c470454f, 0x00003a16e57c2f59},
+         {0x00b7961011f1f637, 0x005f64d4dcbdac6f, 0x00d4c02937f6f893, 0x00c626d4b5741f0b,
+          0x00c4f179b938c8a8, 0x00ec5308c972e408, 0x00005d508ea3723f}},
+        {{0x007b0d37b96166dc, 0x0093899125aa6b5d, 0x007eb4e13e444685, 0x00562e0d719bfe1d,
+          0x00be010ec2ed332d, 0x00fc22461d88942c, 0x00005e92884d5dc1},
+         {0x00df5a7139416bc5, 0x0068a4daab42250d, 0x00b95f4af81a2dff, 0x00dfdfcc51cffd90,
+          0x006cd381c0931cf9, 0x0079bea430f9caf4, 0x0000b2756a7483e2}},
+        {{0x0090335803b38170, 0x00753041407400f4, 0x0016a2adf1b2c2cc, 0x00e98f9c4f2a23dc,
+          0x004ab48d8a3f7d7a, 0x0032b007e5f72092, 0x00009c8fb9ffe48d},
+         {0x0085bcd30401f683, 0x0006853b74737be9, 0x000bb5dce3f88dd2, 0x002a8e53985f19b6,
+          0x0090b5d76d3eee5b, 0x004acee7e04e92c8, 0x0000339431c1a92e}},
+        {{0x0019dcd22c7c7546, 0x009160cfbb432be7, 0x00f2c7b417a1524a, 0x001ff1c027d767e4,
+          0x001e64aec86d690a, 0x00ed086ddaac3340, 0x0000ef9793b48957},
+         {0x0066d45884a55c90, 0x001461930f815864, 0x00386f80e8cb13a5, 0x005b16fba63b7a34,
+          0x00831c2d0762a1f0, 0x00bf4b96fdf9d948, 0x00009dca578f4f22}},
+        {{0x0002ed7e7be7b84b, 0x00164a71dfdce404, 0x00b5c6b801055c7e, 0x0035b5e6dfcc40ac,
+          0x004b055c6f8e170e, 0x00edd0f5d2b22e83, 0x0000284ccc6b57db},
+         {0x0067599b0c10cc35, 0x00e65d1616c7b9e3, 0x001598fff3ce150e, 0x00cd244ce55d6187,
+          0x00999dfa311333b5, 0x00844125650b2299, 0x0000dee2f74f1cee}},
+        {{0x00bf0ab6f945122c, 0x00f6741af2d17634, 0x0027da4512582b4b, 0x003571f8d1fa32b8,
+          0x0097b73393fac2dd, 0x004efceb4d3931dc, 0x0000ca847d5b97d0},
+         {0x00c35eb4bfc3b56e, 0x005a25f3c888b98c, 0x0046d2b33303882e, 0x00feb003dbfc3fc0,
+          0x00f26065c3a030a4, 0x000171969aadf9ac, 0x00000046c6532ed1}},
+        {{0x00c92b5e43a10edf, 0x005ca98c838c80af, 0x0057d8f38c62596f, 0x00d697138f8fe521,
+          0x009fe0e0a63dc0d8, 0x00268f204d4bfa7d, 0x000026ac826cd11c},
+         {0x00d301ae968264f7, 0x0029aa0c9cc0e273, 0x001d63fd8a8fe76f, 0x00bd9b674b4c62b9,
+          0x0094973c8e722014, 0x00f36327a0b1d4bc, 0x00008b6b97956a10}},
+        {{0x00bc2935df1a900a, 0x00d0cd09514aa75f, 0x00beb9df29e09405, 0x00e900be5a3a6ed5,
+          0x00c80a6ae8e55664, 0x00c10dd6c84589f5, 0x0000d4959c58c8cf},
+         {0x009c6f4d9cf42f28, 0x00aa9cbaff37f90b, 0x00403b9e0c943f24, 0x00cbc303a52910d0,
+          0x008c2f09a8875122, 0x0062bcccec281458, 0x000051c27d749092}},
+        {{0x00d3880097319a93, 0x009b094d9d08dbb5, 0x00aa1ef10523331f, 0x00639dd15099de69,
+          0x00fa18faba20c553, 0x00d4ce78f89caddb, 0x0000f3974ba18004},
+         {0x0051f58c3dc76416, 0x00a624b410fab1ad, 0x0012d4de1f63ec93, 0x00a70451f86c0b1a,
+          0x008804db6e4bc1c4, 0x0002a0724ef3ddd4, 0x000075f14688f5a9}},
+        {{0x00cb7e561c23b12c, 0x00ae0c879a4e1e93, 0x00a954cf2c6a1ec7, 0x005652db96d49cd5,
+          0x00fc49e7cc980523, 0x00143e8de3a6e5ca, 0x00001921cd9deeea},
+         {0x00295c9b51a0a57d, 0x00178a6cbf825d27, 0x00271f1b8be92ded, 0x009e09a1f40bc5b6,
+          0x00dfe1efb2778350, 0x0094bff59e2f3e88, 0x0000a9f57d3d1ee2}},
+        {{0x00eb0780fcefab09, 0x002bb672eaca3e87, 0x00a8e5dc8c7abc9e, 0x00a7e9d0c03e0074,
+          0x0074582726ea5f75, 0x00ec67c89886c97e, 0x000010f0fbcb6292},
+         {0x0004545f8912cec4, 0x001e65d219ce62b6, 0x007f551adafb724f, 0x005f8d41f0896306,
+          0x00d0893c777d5a67, 0x0094dcd85b2e9801, 0x000025bd94707903}},
+        {{0x00ca6c71bfbe84d9, 0x0040c298b09beea5, 0x0048983f800c35ae, 0x0056339cae1461dd,
+          0x00d4cdd03b68a37d, 0x00c6833f02150e82, 0x0000612a8a5a5698},
+         {0x008a302430c12f57, 0x00403212dba706bd, 0x008b15fd79160964, 0x00c1dd52588c3341,
+          0x0096fbae3e755d1a, 0x00e32edea522cd99, 0x00004e1241f4f476}}
+    },
+    {
+        {{0x00b2c9a3f521fba5, 0x009f8764941e5674, 0x00423f9174e82134, 0x00ca72220c3ef7d2,
+          0x006f718b089308ab, 0x00147dfec29bad20, 0x0000a6e91f7bc788},
+         {0x00c7be14dcacfd16, 0x004a2de07399c551, 0x0046822311e1e4be, 0x00d5ae1ef21a835c,
+          0x00a91c42738c524d, 0x00bf6f986a639d7a, 0x0000c1ee3a5cd2b8}},
+        {{0x008075a99c901612, 0x0087fceb3b8adb78, 0x00f47ffa25319e1f, 0x00e67355a1a13dba,
+          0x007090cdf55bf77d, 0x0081a05ff9b4a358, 0x00001c9680815fc5},
+         {0x005bb6c2f06dca9e, 0x00123e4fd22a600c, 0x00f72325c589d376, 0x0030bb885eed4ac3,
+          0x0008a6caedce0302, 0x001ebb8aaf499bb6, 0x0000779876a7a9b8}},
+        {{0x008ab13587701659, 0x00dd9e2db74caa66, 0x00f09680b59b6ef6, 0x006d058ee0ca5da3,
+          0x00ab7f7be3bc5e1a, 0x0057d2dfd485e708, 0x000073fae51b3244},
+         {0x005f2a611fef25de, 0x00ea86632fd0fa70, 0x0052470e5fedf17e, 0x00aa66e47da9c95f,
+          0x006ff0cf4ec13f68, 0x001434d245f89240, 0x000064ed15c580e4}},
+        {{0x00c6cd44835b8661, 0x003dc92eb815fde3, 0x00201b6b8ff2dcd3, 0x00a3d9b940e0dc27,
+          0x00029a72b32935e9, 0x00caf98ef8efdb3b, 0x0000fc233221c846},
+         {0x006508aef4a66823, 0x00ec8bc484e91b56, 0x00a9d2ad4f49a7ea, 0x009b8e3a056c125d,
+          0x00e3177d06faa37f, 0x00fed3f6d074fb4c, 0x00006e5f3c6924dd}},
+        {{0x00eb1e8e269539f4, 0x006dab14f6328f64, 0x00e53b37c77f8c46, 0x000d9090a0e27b85,
+          0x00bca972c63474c0, 0x00a14663b732cf1c, 0x0000e45498643353},
+         {0x00da854e42090544, 0x0061f6c655447a1e, 0x00ed923871ffdf19, 0x0056947e932fad0a,
+          0x00608b8a8df88668, 0x003ce14bd59e4b7a, 0x00001a913f932bac}},
+        {{0x000070cc221c5a52, 0x00e13cdc203ae092, 0x00f252899b80f05e, 0x003710469315a064,
+          0x00f175aaba5b829b, 0x00916cef7c73b144, 0x0000aa29fa410031},
+         {0x00d4e6af14bebf3e, 0x004eeca63d371d51, 0x008c39beccb8cd7c, 0x002b00a0eb515d65,
+          0x00e2c4ef4876c8d7, 0x0061438c90dff21c, 0x0000e4da82f4bb0e}},
+        {{0x00c110ada2d00c01, 0x006e1af585336e9f, 0x009c0c57adea0b4b, 0x00092a64dda59525,
+          0x00e36a36c72f6833, 0x00d5a25968f9953a, 0x00001dc538e3a713},
+         {0x004a593432894547, 0x00acdf63daaa97bf, 0x00778fa5f7aabc4d, 0x00e240e008c19ea0,
+          0x00b62230bb7abef4, 0x0056e55004d586db, 0x000079f69ecdd927}},
+        {{0x000cd9e1070afd50, 0x00afe6ae81c7a00a, 0x007a2cbdcb9ac50d, 0x003dbaa1a3529dac,
+          0x00c1815fddcd812e, 0x00a71e533f87a724, 0x0000251dc53322b7},
+         {0x009a2d5f4f43e59b, 0x00f4841aa395faa4, 0x004cfedc2cead58c, 0x00fa9dec7fa8a616,
+          0x0019435dd1f0f100, 0x00d72922136fc146, 0x00006d179b97dfac}},
+        {{0x00053583ba7cbc19, 0x009972ffeeaf4793, 0x006519747e225654, 0x0038528c826dc695,
+          0x00591cb2eefe9d65, 0x001f147da5eb0df8, 0x0000e4af6958daf4},
+         {0x00af6e2457b0c8ff, 0x0058f6789d293d08, 0x00337d66a540d0c6, 0x00055022296c300a,
+          0x009373f608bb80cf, 0x009993f46da64353, 0x0000048966fb2309}},
+        {{0x000c9be8e0eec0fe, 0x007388e84bdd389d, 0x00cc7d32b2588180, 0x00d2d86f0555050c,
+          0x00857a0151fd3727, 0x00069944cb214149, 0x0000ed7c84226885},
+         {0x005ceb0722fec7e4, 0x00dbba0457cfce8e, 0x0044baaf4f72c09b, 0x00666c6473e26d22,
+          0x004e736ca1513fb2, 0x0071409133ca7b67, 0x000040bd8ba3f39a}},
+        {{0x00fc7ba2db99e5e2, 0x002c0054b656eb40, 0x002a1b152600e12b, 0x00f86d6631c8f517,
+          0x00db0c6cd3f41af5, 0x00ec425c03813d25, 0x0000be99e09b44bd},
+         {0x00bbb785ac181ec9, 0x00971ef499931865, 0x00f3137c7fe716b2, 0x0077b709c6d5e93b,
+          0x0051de8678838d14, 0x00a651f1b0d732e4, 0x00006bd8e05e1d63}},
+        {{0x00b9ad0ff4905e43, 0x0086ee37eca54a3f, 0x00353d78dc102fe7, 0x00288ad901e322a8,
+          0x0066fc4b636f7945, 0x007affebbaf6f20c, 0x0000c6b9ac45b25e},
+         {0x00775e3de4b0d002, 0x0082448856eaf693, 0x00ad7cf2c7ddf2c8, 0x00146daad6f51bea,
+          0x005e8960e2f5e335, 0x00f1c364a3b7b620, 0x0000acac7b93ba02}},
+        {{0x00a1442f527e2e0a, 0x001a6b5d2ffc3cf7, 0x007c208b5b88a3c3, 0x00748835e1157b90,
+          0x000e25b0868ae8a6, 0x00c3efff18d12b08, 0x0000ab2022853665},
+         {0x00a5a0141077cc21, 0x00d54994762cc8f5, 0x008c4c98eb2e5ff5, 0x006940804b9f23da,
+          0x001b0b6ab2fa60c3, 0x00d0ed4ff2fc0505, 0x0000fb6f059b4950}},
+        {{0x00b2ab97a2925092, 0x00b28f6e3d9c4c07, 0x00e9b9da2b037963, 0x00f578ca8474f98e,
+          0x00a99e568da787aa, 0x0087acc8269bf490, 0x000051e183996e65},
+         {0x00633a6b5f1126c6, 0x002a72deb07060c9, 0x0027a50d6e17b66b, 0x00e5b55d76d76dbb,
+          0x003e4eed53e43a5c, 0x002e7bfd26d75ed7, 0x00007b51bcda781c}},
+        {{0x00553d3a3b3bd3df, 0x00119337fd6ff228, 0x00145a16f3d3a1fd, 0x00a75756ed69a779,
+          0x00c5f76c4839df16, 0x008749a832c583af, 0x00006e80e727bf3a},
+         {0x0075bd71d97725cc, 0x00fe7d22bbc6897f, 0x008288b6df500a64, 0x00ff45476a42827c,
+          0x002514c6595d46e5, 0x00f79636d0e632c9, 0x0000e8dc574a1c1b}},
+        {{0x003c90eaa39e3ca6, 0x00872eb0d7a7efe7, 0x00cfd9c156447c61, 0x00399adb267670e3,
+          0x0068b5e4abe7bf81, 0x003489690bc09c8d, 0x0000d115e87e1bfe},
+         {0x002ba4ad935b6f0e, 0x002eceee09f482c4, 0x0030a12bdced8698, 0x0039d5587d4d2a47,
+          0x0006468c7ad07d79, 0x004d5e5bfd4cf2b1, 0x0000c9810f88c438}}
+    },
+    {
+        {{0x00f32039cd485d1c, 0x000bfae77ef3f977, 0x0062b5c0a09f0af1, 0x002316a602881ed5,
+          0x00919df538c088ac, 0x008b1fb697e0ffc0, 0x000056a80dae6bac},
+         {0x00ec580cfac5bc04, 0x0009fdece4d5a417, 0x000aa9a07232c769, 0x004384667e280102,
+          0x00e4be6cff06b5d1, 0x00802bbc65e264b1, 0x00004fabc2bf1259}},
+        {{0x0046d2723409b530, 0x0071435ba694922c, 0x005ca5726746a9fc, 0x00666930ad12b9fd,
+          0x008a0230c757ec66, 0x0042f84bff4f4fa1, 0x0000732d828e4858},
+         {0x00e474ac1fa405a2, 0x00f51ed65a4e9cd6, 0x00b4e90aee4286a3, 0x0000c28756940ce0,
+          0x00589d0d4f64e383, 0x00f4f78a8f5a2873, 0x000017a7b15838bc}},
+        {{0x000ab604b3433d4b, 0x0059140927dea6f3, 0x00ffde0e8a2caedb, 0x005219fd1c06df6f,
+          0x00f4d020c78f615a, 0x003a4ecdcbc47597, 0x000054d9a28ecf11},
+         {0x00d64b95d61b480e, 0x00cd974a9e1f1078, 0x0012f08c2b562b4a, 0x00641652a2e8be98,
+          0x0078e580077fbe3b, 0x00fdc1057f360e0a, 0x000003328ae9a21b}},
+        {{0x00f2cec170defeaa, 0x00bdde95b5ca029f, 0x00a6c7015377a5a2, 0x0055568081290414,
+          0x0004ffd928b63589, 0x0065bdc61becffd0, 0x0000cf27b81a7e5c},
+         {0x00b21507b53274a5, 0x00f0b4e322208209, 0x00b89d7eb7f22030, 0x007e4af01bb80179,
+          0x00c081b6988bca56, 0x004b6042062db6a4, 0x00005f8a40c1778f}},
+        {{0x0041bae350f71b37, 0x00f597bcef6e2359, 0x00ce013d33ad0c38, 0x00b32aa10edff9a6,
+          0x005c2047ee5216e4, 0x000c994d3f7ac250, 0x0000e212c96705fd},
+         {0x00289c25e3f2d65a, 0x0064e8d238618d29, 0x0080ee2ecf978969, 0x00ddb0d30e7e47e0,
+          0x0056653e1b1ed32a, 0x000085b23a6a7be0, 0x0000ad0585178a97}},
+        {{0x000eb40d89ab86e2, 0x00807d1b47937dc7, 0x005b870e07e45754, 0x00711e0e4ad9e87f,
+          0x0008e139af2288f7, 0x00b0d0c767bfe05a, 0x0000b43b20736bcc},
+         {0x00429fa6a4997923, 0x00df25c0a8728de1, 0x0068b2184b478101, 0x00f5bb5c183d2541,
+          0x0053d41a4000889a, 0x006550f1b5b0fcb8, 0x00006ce209f0b84b}},
+        {{0x0078cd91006de51e, 0x00fe0f871d2d4e9d, 0x00150eec86e6b6be, 0x0042692ef264333a,
+          0x009265285d6e9a68, 0x0020d5251c548a3e, 0x00008d3ba527a053},
+         {0x00fbe064902faafa, 0x0073600ad0dd860a, 0x004b5497c6acb879, 0x00276f72b59025a5,
+          0x00e51486dd294231, 0x00877b3ffe816d47, 0x0000b74748b6975b}},
+        {{0x00a863ae5d6d42ea, 0x00a9255dba99568c, 0x007ccd31bfaa5e0b, 0x001ce29f5ab66f70,
+          0x00cda6c0d1088a87, 0x00f1a73d35395c18, 0x0000abc9270edecb},
+         {0x0055999271ab778b, 0x00a89705691abe5e, 0x002897f0628d7b58, 0x0096231cf38ed8d1,
+          0x00e2202e60cd0de3, 0x00a4076b22a03225, 0x0000747c0c310055}},
+        {{0x00fb271609043946, 0x00ac3656e24cb5b2, 0x007a94a7b024cb9f, 0x00cebc1cbdd78cc2,
+          0x00f9e5e7449b90c2, 0x005dbd9acfa90bab, 0x00007f930400248e},
+         {0x007093705d20f9d7, 0x001178659170cb50, 0x009be14b96df842b, 0x000f9d2c4a767d13,
+          0x00f22de4e4db57f1, 0x00250e0cd475ff90, 0x0000fdee6c186139}},
+        {{0x0074fa1db479feba, 0x00df34bc3ec70315, 0x008f460d052a907f, 0x004f9205da46f8c6,
+          0x0017bab0555f7b81, 0x0056aff438c16e50, 0x0000b620e7285a34},
+         {0x0074751a4efa3436, 0x00ad893a70035ba4, 0x00bb77673386ff3a, 0x0071caf3ee7375b8,
+          0x006bafffd3689894, 0x00877c5f8352c8a0, 0x00003d90f6acba7e}},
+        {{0x008938e8c2fdb130, 0x0001bcaf9ae02d43, 0x00ec7487f6fd950d, 0x00c87c9a14c388db,
+          0x008cdb98c851aeea, 0x0046680c45664263, 0x00000bf7a2ce4db4},
+         {0x00d95dee28a2b441, 0x0049d39563ecb4d0, 0x00a46f4c35813a53, 0x006acb0da47a4143,
+          0x00e7b6bc8592ce88, 0x00457eca98c9bf22, 0x0000dcd6f9c1f34b}},
+        {{0x00482bfc91699d72, 0x00b5a419a613b063, 0x00eb78fa26749dfc, 0x0080480d673b7971,
+          0x00aa24cdf2d909a4, 0x001da0c5a013ab0e, 0x0000f11daabdbcfe},
+         {0x00bdc3c1f75ec95a, 0x001022e10b12fa84, 0x0060dfa6aade7e9f, 0x0043e8d15e24c70b,
+          0x005b84fbf2fe7c16, 0x00145acbcf363982, 0x0000a43d589daf2a}},
+        {{0x00b1cc596d3ceb1a, 0x007bdc84afcb927e, 0x004e452ef41c732d, 0x0091e4263bd0aba4,
+          0x00021331301d5267, 0x00fec48b15fbf70a, 0x0000ee5c68fc82a8},
+         {0x00136d34f22c4040, 0x00ace7519aa101ff, 0x00bdc5e01782f71d, 0x00ff981503c7d6a0,
+          0x001380851a0df664, 0x007c81b18eeca79d, 0x000018d9cbfd257d}},
+        {{0x009b879e7b0c78cd, 0x0051de43c7943581, 0x0051e12b4ced57e6, 0x0026f629ae6b6dee,
+          0x0008f2dd24fc876c, 0x00e3df6936c26328, 0x000014c7a7064a90},
+         {0x00a31ce8318ca85b, 0x00943c570d514ac4, 0x003f7c2830ab0548, 0x000154f4b5306615,
+          0x008a4fb1055a9b8c, 0x00a319a1518ea9b9, 0x00002cc49179960b}},
+        {{0x00361d29e707a28d, 0x002432d936de4326, 0x004c4f6f73be470b, 0x000ce6fb163c3150,
+          0x005329c1827f255e, 0x002a49566c934064, 0x000034fbdd7bc912},
+         {0x00bfdc4e4b087320, 0x00c44e3dc83cfbdc, 0x004c7a802f2a9d8c, 0x006738fbb635bbff,
+          0x0087bee24cc250c8, 0x00667a81098c8b1b, 0x0000c09091aa1f56}},
+        {{0x00ba5918d74d9642, 0x009cdedfa0f56d06, 0x003d8cbae3ef92dd, 0x005f6f39bf74c1ac,
+          0x00cfe67c2fce93bf, 0x00c718ff348797e2, 0x0000079dc566510c},
+         {0x00ecd5d0c16bb523, 0x009d50cc51c42fa0, 0x0038892459a929f4, 0x008484b5f1362755,
+          0x00806f8862637770, 0x0087bc89a8437e5c, 0x0000a64da09a5d90}}
+    },
+    {
+        {{0x00e82b526c694c8f, 0x005f4375774c695f, 0x0026d8a3726790e2, 0x000c7c94185c489f,
+          0x00a46991e97122d2, 0x001437a59b02054b, 0x0000c4d678b7b8b5},
+         {0x005b973ca0083b43, 0x007d7dc8794d87ee, 0x00d2f9d685715e05, 0x0059bd3eccbacce7,
+          0x0023a3b2c4d69c5a, 0x003d61cbd5e2b84e, 0x0000d2cbf566d4f0}},
+        {{0x008012b65beaf257, 0x00dfd7c3a63f5925, 0x00440096173fa62d, 0x0023aec713410902,
+          0x008218a536e9ab06, 0x008e49d2a06a0326, 0x0000681f0677ca14},
+         {0x004a189c24ca4464, 0x0014387aa9286134, 0x00dca2d5f6fc51c6, 0x00a845f2ed2827d8,
+          0x0043e4fe6e923c08, 0x0001eae2e30f8779, 0x0000738623a90a90}},
+        {{0x004065cdb47f36a1, 0x006345328117d61b, 0x0045cc27a9441450, 0x00e012166cbba2dd,
+          0x001d3872534957d5, 0x002a0f3c4196dba0, 0x0000b167bed98f86},
+         {0x00575127cd654b99, 0x00826ca9e454dc51, 0x0047645bf81d323d, 0x00a763a0b93a4b48,
+          0x001af8572b15c22a, 0x00ad431130317126, 0x000098af8a19e42d}},
+        {{0x00dfe318bd1d983f, 0x0039a69c71f77e70, 0x00cce1c1fe578186, 0x00811056b54227b6,
+          0x0022f47036c458ca, 0x00f3117da8a40436, 0x0000c35ce6fd098a},
+         {0x00a998464e59416c, 0x00a38659966ec51c, 0x0011dee3e163da37, 0x00185df2a4d71c1f,
+          0x0086f3ad20d76a35, 0x007e898de0563145, 0x0000eb1ebb615fdf}},
+        {{0x0043cd803c6e61fe, 0x00997cdddfe211e9, 0x006501ea0e90e946, 0x00325c9fa0d655a0,
+          0x00854a6adb9e1410, 0x000c87209e7c4c3d, 0x0000c155d4037f07},
+         {0x009a16fbbf3c1395, 0x00fdf6cfc04a03ff, 0x002293589bc8181d, 0x0098d4bd57c673cb,
+          0x00f93d5d0fd821ea, 0x0031261177e84f45, 0x0000fed751cd08e0}},
+        {{0x003cfb4c4b2102be, 0x0092a0e0dd6341dd, 0x00fe16251d1001dc, 0x00aa48bc43ea6699,
+          0x00b9f00d0482cc0a, 0x00b63b092d567b71, 0x00007fb3d81a47ad},
+         {0x00aa7d238a8db3f8, 0x000771098796afb6, 0x0090e797f8658989, 0x00cf9434f46dcf7f,
+          0x00818850ed22db0b, 0x00252fd1cf12a8ac, 0x0000da6a1aed0d1b}},
+        {{0x00ebd78ce9b71c22, 0x00cc174e2f35449f, 0x0041a260f082069d, 0x00b3cb92abe20f30,
+          0x0010ce61877e8a19, 0x008ee505e2dd3800, 0x00005248399e1ea7},
+         {0x003c4ca49d2323e6, 0x0064229156e4d839, 0x00da8ccdffd9d752, 0x00596150932c9e7b,
+          0x0048c73c4bd050f0, 0x0041e7be610834dc, 0x00005e08026a041d}},
+        {{0x00605cbf1d845828, 0x0083086b74dd327a, 0x007a250b7a729d33, 0x00964452bdb00cd4,
+          0x009d39eda5a5f852, 0x006ac71e39d6df7a, 0x000089ac606a3a97},
+         {0x00df5dd5defb5093, 0x0053c326a847c509, 0x00a6e1c388f2916f, 0x00eed7cec97fe24d,
+          0x007bbbe84d38da8e, 0x00ccb49efe7f18e3, 0x0000310ab22e1ec6}},
+        {{0x00c6c9dd217b1ae7, 0x0028afdf2fb5b718, 0x00b596634e26205b, 0x000b648bfbe2ce08,
+          0x007041ab89077be2, 0x007b1a563fd0e849, 0x0000d40a2b27cf89},
+         {0x006f6fa4ba42db27, 0x0093e73b7a489bde, 0x002fc9b8ca209096, 0x003e12eb2d86a87c,
+          0x006f15eabbc617d5, 0x0071994da6b17cef, 0x0000a005cc77173f}},
+        {{0x000732ce2dd8062c, 0x00239e6faf3b9f6c, 0x005d573cbb166780, 0x0067d13842a75adb,
+          0x00b119084262941f, 0x00cb67cc93190209, 0x0000b49332f4c135},
+         {0x0085dd3bea88916e, 0x0033cc25e9062109, 0x00421bff0993c16b, 0x0021882c63c89597,
+          0x00bc816762362891, 0x00cb1d631ab5376c, 0x00001f053f1384d9}},
+        {{0x0009ce664dbc9aff, 0x00f36f5908b0ac51, 0x001d5c854592fac6, 0x00a15eb81b5f8a06,
+          0x00a0eb94a2e2a566, 0x00acd7ec324cf977, 0x0000798e0d307e0c},
+         {0x001ed565ec12c4a2, 0x0009de4a4008399f, 0x007db4ea8e16e6b7, 0x0007a914d55e4ed9,
+          0x0041416163aa60b4, 0x00a1066323d0276a, 0x00002dbe7866f378}},
+        {{0x00148a3b4012ca29, 0x00e2102fa278b2ba, 0x00e3c3642bf1f860, 0x00f36e3e4da7dbad,
+          0x00009c9ff0bd2294, 0x00f8b9729b03318e, 0x00009b542fad8af1},
+         {0x003c6c0829400e0f, 0x003e15e0139d2bd9, 0x0006bf1a0b996f01, 0x000b6fc1bcc2051b,
+          0x0088e0c4db79ddb8, 0x00a99092c4e3154d, 0x00002fee4881b6f0}},
+        {{0x009302daa7ab7f4b, 0x00e9692b1ae07a61, 0x00cccf154bbe89dd, 0x0091eb8d4aadba7a,
+          0x00164eff3bc8a96c, 0x00c06e849b708563, 0x0000befd29efc5ba},
+         {0x00c26474ed8f7774, 0x005fdef584c304d8, 0x00504aff1ce01218, 0x005a56b346585e54,
+          0x00028f06282672b8, 0x0024a5cba1f43303, 0x00007d923b8f4da9}},
+        {{0x00815a37091d5ee3, 0x004778cd8595c0ab, 0x00fe1dda5bbb3621, 0x0094239811b8f581,
+          0x00218f0a9e291cf2, 0x00fffc0b235d8387, 0x00002eb0d79fb04a},
+         {0x00e2cf9fff635e71, 0x00d3b07802cc521a, 0x002baf01976edde6, 0x002248b116c78967,
+          0x005b36cbc99c4cb0, 0x003fc1d590e224ea, 0x0000a1a5c79d3ed1}},
+        {{0x008fffb050396af1, 0x0025bc5bf2248798, 0x00f7593c132d0f71, 0x00d1e714a031a717,
+          0x006beb5d5dca6bdb, 0x008fde82c7bf20ee, 0x0000601da637b7dd},
+         {0x00e6b6e94beb162e, 0x00b275f68f46650e, 0x0091c4ac53fff5ea, 0x00f1fbcf54dc451c,
+          0x008659bb3d2f0e86, 0x00bee53ee09d259a, 0x0000e430b60e8eed}},
+        {{0x00fa99eec2092094, 0x000bba59c1ed8981, 0x00967d57f6631104, 0x0008b0f0c6c29d6e,
+          0x006646b54753eabe, 0x00d8081399b2fe2f, 0x0000cd7a241c6f86},
+         {0x001cf1f374a69dff, 0x000e38c89b4280fe, 0x000d2db209571379, 0x00a0542409b1f921,
+          0x00c76369d75cc779, 0x006bd50785eb35ca, 0x0000c85915d21672}}
+    },
+    {
+        {{0x009fce54aa512848, 0x000175f0fc3c7888, 0x00f84cd2acdf4911, 0x001e13abcd664b02,
+          0x007100d35000ccf0, 0x0040a4500665d0a2, 0x0000c1e78f614d99},
+         {0x000bb38e59400b97, 0x00bc1e54c7c9c4a8, 0x00ad1d52f6959ce4, 0x00d3f11bc7573263,
+          0x00ddee4a19ae5678, 0x0067fc9fb80f557c, 0x00003e97e0582eca}},
+        {{0x002883e90694f300, 0x000c030a3c58353d, 0x008a098604ed6673, 0x00cd59f8e03d037a,
+          0x00069fb0c2eff497, 0x00abbc9ab3530f5e, 0x0000777dcf2ee16e},
+         {0x00eabca2753bff36, 0x000b22f01fd34683, 0x0051f8d1d397dfe5, 0x00ad29a9c3f51797,
+          0x001a85b12567d53d, 0x0063fe9705b04e5c, 0x000093ba92cdb48d}},
+        {{0x0035ad1e98a59171, 0x00af5d8691b009a1, 0x00a33f082e717d65, 0x00a51a4399abed92,
+          0x00804a9f2d25d4b7, 0x009f584421954b0d, 0x0000a897a3f79fcc},
+         {0x000e38f706f35527, 0x009f69e1d089742f, 0x0080c78f25023df8, 0x006b10a05deec58a,
+          0x00f2d5ea7c3154f3, 0x0008b5eaeb725bab, 0x0000e4241115d799}},
+        {{0x0045111a9211fa73, 0x000ad306a39bd4ac, 0x007ddaf57c5ece69, 0x005831213c1cf687,
+          0x0058221b7707a815, 0x004c2a85c3003bb6, 0x000059de5a56e034},
+         {0x008ac4c7a45d9e35, 0x00059cf49c0bee46, 0x00518ef2acbb02e3, 0x008199fac336089f,
+          0x008f5c25a41ca1e0, 0x00513afeb4cd34a0, 0x0000411d2298d916}},
+        {{0x00f56d23f558242f, 0x003540e986e8358d, 0x00aaa282a1e4f283, 0x00a45f2a68a8f781,
+          0x0057c71d47982219, 0x0075b0aead815178, 0x00002d99ed55b84a},
+         {0x00104618ebd0732b, 0x0090c8ab34844296, 0x00b1a0bcbe7e76dd, 0x000f95a125a62e9e,
+          0x007868b86d6d2785, 0x00dde904e6e42ebe, 0x00002a0368b80fcc}},
+        {{0x0049d1a03026d1c6, 0x00aa71caa4a38527, 0x0008be6a6cc73ac4, 0x007bdd3a7d255e0d,
+          0x00f337ba73e709b4, 0x000c1463a603b69e, 0x00008674aa424d46},
+         {0x006a43023a46ec19, 0x007481d1d5ea0878, 0x009d4b118f8f8d17, 0x0019388a384b9f59,
+          0x008b091a529c0d6e, 0x0022e9ee70d3d7bb, 0x000091e8c6cbf2ac}},
+        {{0x005e1b8eda719850, 0x005ade24ee59a9bb, 0x0006aab26c654caa, 0x00a576f9f61038e5,
+          0x00a988285f40553f, 0x00061a90d188cda3, 0x00006d22916afb0c},
+         {0x00cdb57b10529553, 0x0078305ae11b6e06, 0x008c2636439bee08, 0x0057870161a3ed59,
+          0x0036272e63cc111f, 0x001f874bc88c6615, 0x00000ad17a856153}},
+        {{0x00f5bf9cfb2b8c90, 0x00648f9a4fa1475b, 0x000c2dc71892cad1, 0x0090f1aaf052764f,
+          0x00319d5fdde89ac2, 0x006cdaddcec5d1fd, 0x0000b2d9a835fa36},
+         {0x00308e16564cc6e0, 0x008da29446a19edf, 0x00631a4e4eaef713, 0x00e67fb56ec907fd,
+          0x005e70037040e01b, 0x003c6204b14185c1, 0x0000e8cc597d0578}},
+        {{0x004cb2618bd3151e, 0x00776a64ca2b1014, 0x000114af8bc148ed, 0x00e590f4fecd1393,
+          0x00ddecd95185e9c8, 0x00f970581231847d, 0x0000531f6547cebc},
+         {0x0075cf0685a57d97, 0x00e23d749124aaf7, 0x00c43b7d195dc698, 0x006a6f83f78db5ab,
+          0x00b44a9c55f1d596, 0x0012050ad2a53b6a, 0x00009a6cfce24484}},
+        {{0x00a4e071d9bd84c5, 0x00c91281210a2b39, 0x00dbf6868ecf107f, 0x00bdf65eb5e5456d,
+          0x008356c9fae236a3, 0x001b56cc754cb50d, 0x00005118aded32a5},
+         {0x00f331bdafb7eabf, 0x00e33cb8adc9fc57, 0x00c8607292ffe785, 0x00f9dc2be4f2cb7c,
+          0x0096a4bcfe1cb4dc, 0x0043e669360283bf, 0x00003465cc7ac539}},
+        {{0x0016bf5d8833b98b, 0x0035a43fd547668a, 0x00416c0a45e60526, 0x0043feea86a320c2,
+          0x00f50f31155ef7a3, 0x007367f6a44a7d65, 0x000067f5c933c4cd},
+         {0x00d1e17f11a4a33b, 0x00a0f90858dd18d8, 0x00e4f80a8480c949, 0x009c7907124a637f,
+          0x0014939c3dc24ffb, 0x00680ac186984e8c, 0x0000efaa388eb42c}},
+        {{0x00361718d63e042e, 0x00e322b106c1720d, 0x0099b61580fe2614, 0x00ea83a64a3001e9,
+          0x00c0dad61a321d5f, 0x000eb253e42b48b1, 0x000033c647e284fc},
+         {0x004644e0d330e54e, 0x00299066b172a7ba, 0x0086f66936cb4fc4, 0x00403978ebdd0b03,
+          0x0090172ed20d4d26, 0x002a845515a2c9cf, 0x000083cbbf35ab9e}},
+        {{0x00321b6a25954d49, 0x004f55496f556993, 0x0037cd843d7cdf79, 0x00ccb9bbd9ef0483,
+          0x00c9dac003872dd0, 0x008bf5e66adb6c80, 0x0000e5198653fa49},
+         {0x00c065bd987a49e9, 0x009c6f611d769fde, 0x00b219de614dbbae, 0x002a75ee5dced16a,
+          0x00e9825831b913c9, 0x0066241d9734f133, 0x00000a4c850b452b}},
+        {{0x00c361a2a62be2b0, 0x00425ceda064ca40, 0x0092606faf61527c, 0x009bdc2c0dadd62f,
+          0x008f2921860d9bf7, 0x00fd8bb2a2fe9e86, 0x0000a9083fb32c3a},
+         {0x00ac314389e2de85, 0x001b77f01adc22ce, 0x0083ebcc1f5a66d6, 0x00edf15fa1e5214c,
+          0x00085e1726c0ee99, 0x00170a9ef1136685, 0x0000a6a8d747546a}},
+        {{0x00b1c96b72eebddb, 0x00ea9ce085a17beb, 0x00e34974f10a954e, 0x0081c6e14784e49e,
+          0x00a48eae5b3deee0, 0x00cde9595ede3bd1, 0x00009abc1e3d784e},
+         {0x001c582e2c2f3ba2, 0x00f80de8c0ae0fd5, 0x0034adc22c2dd10a, 0x0039b7d839e997bd,
+          0x007eb50645bdb4af, 0x00b7da0e22872e23, 0x0000f10934b65b87}},
+        {{0x008a0f476c50b635, 0x002a646ee15b65d7, 0x0018bb9b505123f4, 0x0067de9b7b49039e,
+          0x005bc287c3ce15b7, 0x0049c985fce4076e, 0x00009934d3f89e87},
+         {0x007b3fd5cf2276b6, 0x0092d54ebae7c658, 0x00ccda6bc9c96396, 0x006853d583b8f671,
+          0x00135f29efd09ef2, 0x00d70863e816dec9, 0x00005ffb0e4e132b}}
+    },
+    {
+        {{0x00d1c76646909e86, 0x00c47fd16642cf3a, 0x00f4a693786760f2, 0x00c688fcbd8d4e49,
+          0x00c9c9fef49cecbe, 0x007a2f755e10d353, 0x0000febe258abe45},
+         {0x00d40a196b5caef1, 0x000b1dc72505d16a, 0x003ea95530546828, 0x00573f7c67499b7e,
+          0x00ed425a51c5b45e, 0x0034052611283229, 0x000067f8693822ec}},
+        {{0x00a8e784bbc7e72a, 0x0062bcefe97e5beb, 0x002e417fb221ec1d, 0x0054de88afbcc432,
+          0x0003dc6aaba96295, 0x00b7cbbb4003bdc9, 0x00004ec12d78d084},
+         {0x0093107bc3d9d39a, 0x0084036af9e4de90, 0x00c2069360410287, 0x002491c59f6e0920,
+          0x00f4c8cf01993809, 0x00fa8be716ccfd49, 0x00005d74a6c96f80}},
+        {{0x00c7e8383fb1bc31, 0x00ddea6ce9d89d46, 0x0035dfcea82728c8, 0x0085dbba3a66cc6e,
+          0x00047555b023a5ba, 0x00b15fbfc3c4ca40, 0x0000f2cb52409b86},
+         {0x00eca1c7cff32d57, 0x007b1f8a329205b9, 0x00fe254a86a9f492, 0x0019d10bb6cf40a4,
+          0x0023eb07d804d4cd, 0x00be85084a5a08ed, 0x000041acdb6b2200}},
+        {{0x004a5541574a2d7a, 0x006b1f0baff67e21, 0x0014685cb49e8bb2, 0x0005f1dbe9e8e8a3,
+          0x005b43936ad56435, 0x0083a1b212876541, 0x0000fdff5d78e52e},
+         {0x0015e976978e2b11, 0x002e10d4d391b8e7, 0x00d8dd2d7ec4dcc7, 0x005963c951ef01a9,
+          0x000b944a00377f99, 0x00aa4c13f5d41ff1, 0x00004db0bc427857}},
+        {{0x00ac4b2db701f1eb, 0x00359464f25ce391, 0x001c3086b7999aad, 0x00054b320439feee,
+          0x00c6c4c94e62762f, 0x00d60300bf0b00cc, 0x0000f2164d338a62},
+         {0x00daf5eb05d745eb, 0x007ba703950db1e9, 0x00603baa23b90143, 0x0015ef751bd44c29,
+          0x00671e1a31397848, 0x00bbafc8dd9e0d6b, 0x0000dd6e9502e3c2}},
+        {{0x00db6411aec88628, 0x00bc73fb16426502, 0x00100d31231291f6, 0x00e2a5bd00ce88b7,
+          0x006463b9f4c7a281, 0x0038ba111143ce09, 0x00000abb03a34669},
+         {0x00a306faef49f86a, 0x00bdf66d3e0be954, 0x00e9a725caf5313b, 0x00943275c9c4d58b,
+          0x00a783e1e88a2401, 0x00271b91cb81403d, 0x0000115548145608}},
+        {{0x000d530a8f0348e4, 0x00e7a0d4a701a679, 0x0061c79680114245, 0x00e44621eefa071c,
+          0x00f1aca3baeeb3fb, 0x003dea125817b48e, 0x000097e3e509d4ea},
+         {0x00677fc2de6c8ec6, 0x00fc1adc040b3f15, 0x00ee5a5554c88ff1, 0x00a31a295a76e310,
+          0x005c12f3a54b555e, 0x00b4cd30e184df3e, 0x000020a413869357}},
+        {{0x00c86b9043ad5051, 0x0044a7037db03463, 0x00634f6bbc3e3e5a, 0x006d59f0c5464719,
+          0x008ece33bcbee39a, 0x00410789b81c4f6a, 0x000079d29243dcde},
+         {0x004e0ce5928f3240, 0x00d9da7579045dce, 0x0058ec1346f4b32d, 0x0094918c2e24c45a,
+          0x005bbb074204b656, 0x00b877e225dcce67, 0x000099a5cf1bd320}},
+        {{0x00454a7848303c9b, 0x00a79730492f75c0, 0x00b07fa6c187ada5, 0x00518c9ace5127f0,
+          0x002ee3e2e3ac4ec3, 0x00a88a3abf136b48, 0x0000c874b9be5578},
+         {0x00c5788aac2cb705, 0x00813a1ee069858c, 0x007dc1da43a33709, 0x00a8eb78e20313a5,
+          0x00940513a77f2d2b, 0x002ba04e7736069a, 0x0000f521b99ce1fb}},
+        {{0x007e156476bd8239, 0x0031d5091c49539a, 0x00f0d807c3370709, 0x00162a17664e186c,
+          0x0029423e9208cb2e, 0x002641890e6e9e16, 0x0000104bd81a2e5c},
+         {0x006e79d15cc3ac52, 0x00341da944bb844d, 0x0029e27e3d0c9930, 0x00730bcb164fc1ee,
+          0x009be1b5673d7d95, 0x0047ff7312b6a1fd, 0x00005cfbd277b9f0}},
+        {{0x002cfb3d9554885d, 0x0031f5f645785d05, 0x00afca6e7e9d0256, 0x0031f558ce50cc3d,
+          0x0094ae37a2c7244e, 0x0041aa52dff1556d, 0x0000daec5f3298fe},
+         {0x0073471185d35cac, 0x00f60b5b3c1b0bda, 0x0083e418982e47da, 0x00fcb405ea140801,
+          0x00a26c60f34b412d, 0x006a5697f19da327, 0x0000b22b6fe52e12}},
+        {{0x00055ec4806b25b9, 0x0072700435537f53, 0x007fff2f1d534d73, 0x00685c744024285f,
+          0x00fccc15a826a607, 0x0064175373d22c8a, 0x0000f28fdd5c09c3},
+         {0x000ecebf7e3444b7, 0x00666e6047de7434, 0x009e4276b92387b1, 0x00375a08e3dffd42,
+          0x0013bc807ca1600f, 0x00690e47bb254e93, 0x00008d53372b64b5}},
+        {{0x00b75401ae51090a, 0x0069aa704f097fb7, 0x0075f03921cd422e, 0x0050606ec521933d,
+          0x005c689e1313f2c7, 0x002202704571f852, 0x00003598bdc39f18},
+         {0x00856df3176acd15, 0x00d5c9d52ec14ab6, 0x006b25bd4f9068de, 0x00e8b566be775c77,
+          0x008f83cb5c5c72b2, 0x001773db794010d3, 0x00001466b5b18532}},
+        {{0x006e3b9f7b00a982, 0x00a4df49dcbd7188, 0x00b942db236b2614, 0x004cf495fd64c230,
+          0x0083964424ced6aa, 0x00769a8f866e0199, 0x000037b9b726a36c},
+         {0x00e562fc4514eb3a, 0x00b41571478cd6cc, 0x00d2cc2c531144a1, 0x00fa7f8fd303a11a,
+          0x00c29a847fdee32e, 0x0064ce5c8871db8f, 0x00002e4da390e514}},
+        {{0x00f21dadec1fbdff, 0x003b294d3fbed9d9, 0x00c6f302aac88a4a, 0x009f9f3ab43f4483,
+          0x003ad4cb7dcf7cc7, 0x0020ecab35b32d86, 0x0000e7eb4038ef97},
+         {0x0032454ec15d2b51, 0x00ffb4be59846138, 0x00fac5fc65d30ed9, 0x00f3a6eaa6c39f64,
+          0x00849598deb7d448, 0x001224e0ba338b53, 0x00007d01dda0d93f}},
+        {{0x00eef9adef78aedd, 0x00a8854edc6a2277, 0x0097932633426449, 0x0059aef854b99176,
+          0x004fc6886d8caf00, 0x0097398fcd880361, 0x00001c30f1e31b3b},
+         {0x00ee56e9752242d0, 0x0083f710fce62ae5, 0x00a188a23a7ee4a7, 0x00bcbbb181949f9f,
+          0x001e48ee5c2494b5, 0x00d6fb80d471914a, 0x0000a3e17f44c2fd}}
+    },
+    {
+        {{0x0062fe2f08d7e82f, 0x0044818591e9ec07, 0x00cf1cc0d4b1950f, 0x003e1774a6b4ef28,
+          0x00ec952d7a9336d4, 0x0047487aa7ae1287, 0x0000b31975d3f879},
+         {0x006a90424a220ca4, 0x002b9530560a02b9, 0x008b6186f30e9900, 0x009ca19d833de7b1,
+          0x00dcbd8e63628bc1, 0x001327185b2584e7, 0x0000df11408c7c37}},
+        {{0x00f1a766394b44df, 0x0018f7c700ea1841, 0x00a4c4dd3e107bb8, 0x0021ea2fec04c9e7,
+          0x006b608a2c60bdca, 0x0036adbd5034660b, 0x0000de9b67f32654},
+         {0x0069f3d907279157, 0x00cb99520452e531, 0x00ad354e9bc18edf, 0x00f3f566c03e6b29,
+          0x004f4dbf82df7261, 0x00365835d2f32ac9, 0x0000e3ec604ac8bf}},
+        {{0x001452f8fdcbae9e, 0x000c600a39bbe8f8, 0x002e85e282800c98, 0x0038bbb994139504,
+          0x002eb54881e4eff1, 0x00b44779aeec021c, 0x000097bca53aba07},
+         {0x0018edcca562a5ad, 0x00d400e29aceb107, 0x004c29e3065f8ddd, 0x007289c366468711,
+          0x0055d6aeb5fc567f, 0x00bf31d7d62d4ff9, 0x000010fe0badf517}},
+        {{0x0099761f3a9d8caf, 0x00d9c0ccbab7337a, 0x00cd0b05c74b4d95, 0x00f1ae0df729c526,
+          0x002db5a3a5224bc9, 0x004334f48cc13689, 0x0000470df2a08d56},
+         {0x001f6a9e6c143072, 0x00622f82c88f214f, 0x0039d6ba3734656b, 0x00271bf944547234,
+          0x0042d777c7790f33, 0x00bb8d4655716c99, 0x0000e36389ce96fc}},
+        {{0x00bad8a389660fd5, 0x003a258d3a30daee, 0x0068fba00599d57a, 0x0056be797f899543,
+          0x009c65918be7fae5, 0x007de9065a02c3d7, 0x00004326dca8fca2},
+         {0x00a0e56f965e5c25, 0x006883711eb85a5b, 0x006021cb759c406c, 0x0047e3e4d7142fd0,
+          0x00115d79e2c681a6, 0x00ad8d493ef951df, 0x0000b7c8cbb7b438}},
+        {{0x00e9f7f36beaadcf, 0x00db5d61ac012cb8, 0x008cd5ac6e49dd5a, 0x00d3bd2d5de84ef6,
+          0x00e1fb0ec31b8eaf, 0x00b36d3d86e2de85, 0x0000bddcae2c43cf},
+         {0x004945f983140338, 0x00e1c3ba44eb6c84, 0x00375da71a67dec0, 0x00caf4db732c68ad,
+          0x0091b672cc674249, 0x0091376782775daa, 0x000074b4ab69a378}},
+        {{0x00971ad60b3dfef9, 0x00a3f41e5c16f88c, 0x002f5bc1f6a4f963, 0x0074700240c5998a,
+          0x00b05895bb705b42, 0x00d1c578331a1570, 0x00001ea4e3baf6c7},
+         {0x00b45ae7b50018fe, 0x0016e8fa45e55c8e, 0x00b6e14efba8cc4d, 0x007d224aa94cd285,
+          0x009ad5656a1db1b3, 0x00b734b622674788, 0x00002fceaf70ee53}},
+        {{0x00f4a89d4fab638f, 0x000fe0b54cfa539e, 0x002612e11d7667f0, 0x00fcefd79901a807,
+          0x0003d730889a1b41, 0x0046991ce5a8e2b0, 0x000022517a05d20f},
+         {0x001bf7bdcc4ee7c5, 0x0030b94ead0cf4dd, 0x00c33f87fd3b7c21, 0x0062009965ffa68f,
+          0x00fee08f76e23ff9, 0x0084ca30d476828b, 0x000076bd1c1a551d}},
+        {{0x0099bfbfd129f4bd, 0x000fed02d03b97c6, 0x002593557e1505a0, 0x00520a173e7f268c,
+          0x00995fc21699edd4, 0x00c751b1a19750d3, 0x0000b0197f858ce2},
+         {0x000c477c9ffe0af9, 0x002a5374a14cce6e, 0x00af11baedd1ec8f, 0x0014e2701257fb07,
+          0x005f323eafacab09, 0x00e868ec8441b569, 0x0000cfdad3978a0c}},
+        {{0x000450aeedf2bf7c, 0x000c95e8a48f9d37, 0x00599de60c124f6c, 0x009e73f363b7d6c4,
+          0x00f250d3f887ab49, 0x00269e2b0f81c91d, 0x00008039f80c763d},
+         {0x001bc4cb9194d7f9, 0x00688b1f29b3d575, 0x00042e19bc755521, 0x00da25fd439fb67e,
+          0x00d33a4fa00c2d52, 0x00dbde20b8097264, 0x00004e177e8d18f6}},
+        {{0x00d12555538ac2d9, 0x0078cc26b04a6d40, 0x0074ad4b35776aba, 0x0029e473a9cc98e8,
+          0x00e8413601600a56, 0x001308b182034683, 0x00007eba70c45a23},
+         {0x00a353925319b3ea, 0x00c12486d214b17f, 0x00ebfaf6420eda42, 0x009c2144622f1585,
+          0x00b170767f95e4a8, 0x0056f1b4c2582d70, 0x0000daa3ace780df}},
+        {{0x00ba185e7b20a355, 0x00f145aac5ad4ef0, 0x004bbdf49b19e5ea, 0x005481d4f61bc562,
+          0x000296f58da64d7c, 0x00d7991f466c02fb, 0x00003c800f88700d},
+         {0x006b70fef2cba317, 0x00d14afca3a337de, 0x00858c1a93f4df22, 0x00a7a09d0bb1607f,
+          0x004882ff7316b539, 0x004d25f1ae58ca5d, 0x00001bc9ec25789f}},
+        {{0x009ccdfa3386b130, 0x007d46d65f982bde, 0x00681dfea4838b0a, 0x00da9c8b50478f45,
+          0x00dd351f3a60ea0e, 0x00b0486972ed984e, 0x0000362c57461138},
+         {0x00d37d1487e9b696, 0x00108790b962ec4d, 0x00835467b25ba461, 0x0094fb3b95085139,
+          0x009b59376f86000d, 0x003623a9227510a0, 0x0000cf1fc429e2bc}},
+        {{0x009fb91585c0dca4, 0x00be423eed7ab8d3, 0x004f7d50f480cffd, 0x005624cce7ca50d7,
+          0x008a7e0e4493a94f, 0x002ed0fe54938a4d, 0x0000bebb7c4b16f5},
+         {0x0067f3f030012f95, 0x00210673a3279628, 0x00b4815c6ea1442d, 0x0090b65af47463cd,
+          0x0001a2015f11206e, 0x0034ec254214bb35, 0x0000a15f427c5eb0}},
+        {{0x0072ab760762bd3e, 0x00ae126ed283de1f, 0x00212aec4e7ce4e6, 0x008e466318f41b94,
+          0x001a6beb82c70c90, 0x00223fd312f034f3, 0x0000dac28ec2b070},
+         {0x00aeca932809e73d, 0x000fa43e22398635, 0x00063379e3200f0e, 0x00f6d9fd48855862,
+          0x00fde8f26978fcad, 0x00cdf5b15af695fa, 0x0000b6200c0a8922}},
+        {{0x00658a429a87bddb, 0x00ef12749c85ede7, 0x00cd8cc5b531ddbe, 0x00195b04d3f94c76,
+          0x00c4a862f1f8e726, 0x0096f57430740ebe, 0x0000f84e292b7bcc},
+         {0x00b05a6f05afad92, 0x00fb80dccd2a07ad, 0x008616ebe27e6f60, 0x0029ab1ca6e5f7a4,
+          0x00c19cdbd94d431d, 0x00865619c9c477ac, 0x00003948f91f6c08}}
+    },
+    {
+        {{0x00058252d8ea58f2, 0x00a0b4f4404f38f2, 0x002bca21cdbd77ab, 0x0038a39d9fdbcca4,
+          0x004c4ee470e0dd6f, 0x00a0d51621e068c1, 0x00003db8468d0dcd},
+         {0x00fe05aba7c1d2a2, 0x00fd54f16e6c26f4, 0x003708b6461312bf, 0x00907626c5a80f41,
+          0x001638fd0087dda7, 0x003a4b32fbb97083, 0x0000385ea9629f7c}},
+        {{0x0075a86751e8ef2b, 0x001321b700697ade, 0x005e809892c1344a, 0x00b97879ced95ff5,
+          0x00cca36e3d325ebf, 0x00738d1fbc32679d, 0x00005a94da88e716},
+         {0x00830772c67fe39c, 0x00fe2918ce4ecf6a, 0x00725417ae5c5a7f, 0x006f2873832285bc,
+          0x00e9c2aeca5ac8b1, 0x00cf9b3653179152, 0x0000396f6cf9833a}},
+        {{0x0010325e38471f9b, 0x0039a26e310863aa, 0x005d20b71f616b74, 0x0006e6720efbbf58,
+          0x00eb05a0ad7b3f89, 0x0028e84c580ccc63, 0x00008df8685e54d0},
+         {0x00acf848dcf87dd5, 0x00921e1a0de86d08, 0x00fd744c685cd5c2, 0x007cfcd1dcddd747,
+          0x005fab5cda4d536a, 0x00c03f871f1b11c2, 0x000090189a300cd5}},
+        {{0x008ddc4808bd0cb6, 0x0073ecfc1d4a6803, 0x0029ed4184dc3e6a, 0x0059fafcf6ca4c61,
+          0x00cadfeccde93ee6, 0x00dcdfde42e060cd, 0x0000899bb138027e},
+         {0x00017e404dc899c5, 0x003eec7c0b49d3a2, 0x00143e301f02dd09, 0x001c3af83bff7933,
+          0x00c8f4247b66844c, 0x00cb693fd1063b71, 0x0000729605b27284}},
+        {{0x0052b0c67d28454a, 0x002804127e2b65d4, 0x00ac5069b20105fe, 0x000f5c934de0e710,
+          0x005e3c3fdf5cc47b, 0x00b8d41762394abd, 0x00004b4a56a2b673},
+         {0x00dd73de5f3cba5c, 0x00fb8cad5f74365e, 0x00f7a5bacea8ec25, 0x0077221bdbab7f9a,
+          0x007b6de00d717f32, 0x0094101665d1a5ea, 0x000053c02734e3a5}},
+        {{0x00c37d5e04bacdc7, 0x00856d1fa45683d0, 0x0024db4545a44032, 0x00167f0bf0fd34ef,
+          0x004d6e408b58606c, 0x004b72ba9d7d7c69, 0x0000a6d2a7d11c20},
+         {0x0031f9191a054bf4, 0x00e2fe6dd3d0c597, 0x003ed85dff1c17fc, 0x000c90dd0840c38d,
+          0x00bc0f6a3b2d6260, 0x0001bf25451caf45, 0x00007af00a676e8c}},
+        {{0x009ac3cc0fd3f1fa, 0x00c478ba53d130f8, 0x00128ed1e3daeffd, 0x00438d98f04ec470,
+          0x00869aacce9aeb72, 0x0060c9fdc08b4cfe, 0x00008d8ba43f2d61},
+         {0x00c98a5e2de1b944, 0x00889384526188cc, 0x00192655a45462f8, 0x006f802c0c0242c6,
+          0x009ce27fec537888, 0x00a8062b3beb5e8d, 0x00005aa398cecb4a}},
+        {{0x00c8835640a566e4, 0x002fc852f856bc1e, 0x0078263796fd471c, 0x00ab0f109fa8c8b3,
+          0x00f1fa008e3ba3e5, 0x00b69857bf0a2370, 0x0000f4095b6fedee},
+         {0x00472dffb3ee6deb, 0x00f70d31ea077699, 0x00058a9437e5637a, 0x008651b370202b59,
+          0x00d736ce896e8f4e, 0x003cb3ab946c508a, 0x0000bf6ec45490a1}},
+        {{0x00f13410da3f2794, 0x008687dad379af63, 0x001ce5dc5ba566b1, 0x00b1be8a930b8b2a,
+          0x00e27e4561a57472, 0x00d93d2e199bd4d8, 0x0000087808894eeb},
+         {0x004819f87d93c35f, 0x00832cd4d597d177, 0x00b54fb8ff776b2c, 0x00d0ce9c31f5b68e,
+          0x00207bc6fb69f8a9, 0x004671781ea900b3, 0x0000de2a76a7abe5}},
+        {{0x0084ffadfe61ba18, 0x001d898da9845bc4, 0x002bcc2c8d45642f, 0x007b381b919f7b40,
+          0x00c13aace539ebc3, 0x0068806f7043a936, 0x000052d25f0fed2f},
+         {0x0021682f6ceef851, 0x00a694084e8fb7c5, 0x00cd432c772d0d69, 0x009c55574eb2bcb4,
+          0x00c5f1fd05a5ba00, 0x0018c7d12746c4c7, 0x0000260562dab5bf}},
+        {{0x00cd72099358fec4, 0x006c5e0ace151c91, 0x0093d4121cd1f16a, 0x00d1d8215537edf4,
+          0x0034c3e3865ccf79, 0x00a533e2a084947a, 0x0000f1f14031ed6f},
+         {0x00571d98f763c39e, 0x00bc585d8f31dce8, 0x0016b89d5bab5edc, 0x0092dd4149d08b55,
+          0x000f3e62d1547f57, 0x0034675155b91840, 0x0000a57bd55ce6fe}},
+        {{0x00971d2023488bce, 0x00ea11800314a7b0, 0x00000554cdcc9acd, 0x0085908cd466a8cf,
+          0x0039de49b6ff64f1, 0x00ce7610440e351b, 0x00009396aa9f20c1},
+         {0x00bbe4e36f949921, 0x00a298c8222944b0, 0x00b6e1812b54bb76, 0x0087b184c24e5508,
+          0x00d7b6df3cd7e0f5, 0x00edbd24491398d9, 0x00001f54674f2ce6}},
+        {{0x00a22aa6792be4be, 0x0037d1400331be00, 0x00f10061ae54912e, 0x00bbd2d869da7322,
+          0x0057058e2f8c0a50, 0x00e671414301d859, 0x0000c899470de868},
+         {0x0085c1629126d880, 0x00094a480da7c144, 0x00f0dd41351c9f2b, 0x007f360e710eb700,
+          0x004caf12fd6f4570, 0x008232a33816ee59, 0x000034c4b3222a53}},
+        {{0x00c1e07d0f9f6773, 0x00990a0d266f7431, 0x00afc265ac7f11e8, 0x00c0b338ca9434aa,
+          0x00e82d776ecae5f8, 0x0047dfc6ab3c63d2, 0x000024600d9344d8},
+         {0x0012d6949141e660, 0x00466a516d8f5235, 0x003a47c592b92b45, 0x00ab1466031bc505,
+          0x005af71ed81eb653, 0x00ca5a142ac6c769, 0x00001b55d7fde616}},
+        {{0x00ffffeb6536668a, 0x004ceabc3d1c0cec, 0x009e2792bc1edfde, 0x00f7fa0e9ae943fb,
+          0x00c6dca5c4ef5829, 0x00b7ab64ff19a6ef, 0x0000f663362f2d94},
+         {0x00daef3221c68aa1, 0x00dc08e144d853db, 0x00705ef243183567, 0x006c90e324e018dd,
+          0x002602fb3f541fd0, 0x00ea4e9f5d47b052, 0x00003617872840d8}},
+        {{0x007181987cd61cb4, 0x003dc4a2a968874f, 0x001d8d800be7eeeb, 0x00a8453fd4965c48,
+          0x008b845d3d61b0b3, 0x00511ae1d07ec704, 0x0000ede509ef54b0},
+         {0x005b81b54c8b3eed, 0x005bcf785d3008c8, 0x000fb23d9ff27e2d, 0x00fde11706d82459,
+          0x00305c3247f11a99, 0x00bff5515a1ff3f4, 0x00009c3b0c3c92f4}}
+    },
+    {
+        {{0x0060625afb8918e1, 0x00e28cfb91a48d06, 0x00f9a4ea7fb7bae6, 0x004b46abcf6bf2ea,
+          0x00e05378f7ac22f0, 0x00035ca8f4ac78c7, 0x00002173d930442c},
+         {0x00a2e1d0c12c30fa, 0x00f74d46996e6d93, 0x0055e3742b308f65, 0x00513a7a59023151,
+          0x005b2030ffd57fad, 0x00f4d39e08e59d31, 0x00003ba2c954cb36}},
+        {{0x006a7b03cc73280d, 0x006c9dc9ca80a00a, 0x003d4f310fe3aace, 0x00b63026cd7cc82e,
+          0x007592de0fde27d3, 0x0040d2008cdb1ef7, 0x000018f1bcd78212},
+         {0x00de8fd37b60092e, 0x00d44c20110d7b4c, 0x00ef072c1dfef0d9, 0x00e223b7702be43f,
+          0x000d276c554c231d, 0x00b2c1b515ba0a4f, 0x00006b0ffa39a42b}},
+        {{0x00aad20d23954e04, 0x000ae0ccaeb36590, 0x006b3d353c8bae1a, 0x001b2c4da6612cfe,
+          0x00b91f06cf93df7c, 0x00554619881fe07f, 0x0000874fc4e9a617},
+         {0x00b432304c3f2251, 0x0020a07ea789e976, 0x0063b114b34f3e8c, 0x0026bd2874a67b9a,
+          0x005df50bbd921adf, 0x00602712302e6017, 0x00007b99c3adfa34}},
+        {{0x00022566843354fa, 0x001f296d03b7b64a, 0x0021cd1c65ed19b1, 0x0039bfb9cce6d86f,
+          0x00420b94846a727b, 0x00df6d79cb7bf169, 0x00009d755d13234e},
+         {0x007f33fb67903be8, 0x00ea934078f9eda1, 0x00af52e6f955fa15, 0x00321df41e0f85c2,
+          0x00eab7947ce2a463, 0x00eabb43b47a5af5, 0x0000c490547b2bdb}},
+        {{0x00dac60872e2aecb, 0x000648af6dc07ae5, 0x00ddc09dcf7106c7, 0x006c396f86c68a34,
+          0x00deec3f4a6da926, 0x00b41483e75b7aa4, 0x0000b93ae4734500},
+         {0x0001e85ad43c567e, 0x0013a01908f935f3, 0x004715293bfb8cbb, 0x00d0e69604676a6c,
+          0x00e1f3be41c6301d, 0x0085be83255dc2fb, 0x0000dd480cd24416}},
+        {{0x00819045f266d6fa, 0x00b228285643be1b, 0x0006fad83225282a, 0x00becdf0700147e9,
+          0x00ec19113a1bfd26, 0x002ce6d8f4e9948f, 0x00001f4eb7f012d1},
+         {0x0054dd5ffa20677d, 0x006ca60c0140f0a9, 0x00fd4394f947113a, 0x0008b07c8c5bdf5e,
+          0x0084a49a837d4d72, 0x00a8882ff0e0b8e0, 0x0000cd714fdcd9df}},
+        {{0x0075f9bfebc01bae, 0x00e8608c153a0978, 0x00eaa86e78d52c23, 0x00bb955b5888d81a,
+          0x0090a18825429f32, 0x0095f58c5770d392, 0x0000d376a29d1dd8},
+         {0x0041e024615af39b, 0x00d672cc174322a8, 0x002d1c32687c3ea4, 0x001086f1b60f9b32,
+          0x00f9491cc50b3ee9, 0x009c72e5efa2de8a, 0x0000bf28693e0625}},
+        {{0x005dd912622e4d42, 0x001d9a368ae12169, 0x008caba006a54343, 0x009a7d39146e549c,
+          0x007b2e5c037d5298, 0x00e3d2a8007c9760, 0x0000699df0e0fd60},
+         {0x00875d46f0d5cc0b, 0x006f4403324e141c, 0x00968ee6f8538f1f, 0x00be44c2a65ad5bb,
+          0x001d6b41cacd5146, 0x00cc9b7ecda80b45, 0x0000db2cc56addba}},
+        {{0x005bb52a6623a72e, 0x0004b792eca38f80, 0x002903777fef87b2, 0x008d200ff5e01470,
+          0x001ac956ef94917a, 0x005896c99df629fb, 0x0000d86d0cbcabae},
+         {0x004c178cd2d13bdc, 0x005976fc206b8f05, 0x002b1b6ddf036619, 0x0090051e0773b3d9,
+          0x00f3b14f4ad622b7, 0x007578090941fa39, 0x0000f25e981eb13d}},
+        {{0x004624513ce10df0, 0x00c19542ab89feeb, 0x00f5929495ea5268, 0x0011830a260f0a52,
+          0x0085a2d8d28206ff, 0x0006eb1fb8a5a7f5, 0x0000413ee756767f},
+         {0x00eee5a7c5d7d6ae, 0x000052131e3eb577, 0x00769f3edb13d44c, 0x00e7cbd063460390,
+          0x00ff3577b365fd9e, 0x006fdc05d2ecc2f7, 0x0000d5643d9bebd9}},
+        {{0x00aa5aa6a9b6f669, 0x00dc3663f1b656d0, 0x001dd3b9c504dee4, 0x00010d1a17821790,
+          0x0087e1dfef4bc893, 0x0038895a8e8a40a6, 0x0000bc31f50662f1},
+         {0x00bc56eaa9856789, 0x00c7fa1965c3505c, 0x0028aaac5310c975, 0x005f1f9a84b81f3c,
+          0x0074984b73d260eb, 0x00f2ee7e731a87e2, 0x000075d590a9e829}},
+        {{0x000345d49d807cab, 0x0045954bac3acb24, 0x009c9709bc0e9736, 0x00599c6b8653684a,
+          0x00c3726b8991ef6c, 0x00064ba8104ecb0a, 0x00008cb820f267a1},
+         {0x008a9b12bfadeb38, 0x00f7a4eafb0e2f0d, 0x00294a2a14d56f8e, 0x000679cfe827264c,
+          0x00cf1a767753851d, 0x002e18ddc7244022, 0x000099c442dacb1f}},
+        {{0x004cfdc042d7ac6c, 0x002566ef9aedc981, 0x00943d9d2d8ed202, 0x00415a2e3f400d6d,
+          0x009c08d2922a3eeb, 0x00ee4b04b7000caa, 0x0000a8573342f33e},
+         {0x000b8b510731b042, 0x007e820f4334c636, 0x00b0a5fc4be32187, 0x0048f5c043ff5b3a,
+          0x001ba4efa390958d, 0x00c1c967747c1b0c, 0x000081dfd7933445}},
+        {{0x00f3e5d887d69143, 0x001d04335f48c150, 0x00ef83b9306a381c, 0x00526b2dcbd02576,
+          0x00fdc1369c2a0058, 0x00df1a87df245006, 0x0000a22c58b177c8},
+         {0x003dfdb79161f5da, 0x00789e2ffc6dcf5c, 0x00b9080a9dd0d5dd, 0x009f42d134e1acc9,
+          0x006c360704f6b2f2, 0x00c4ff87b745b2d2, 0x0000c383c99520b2}},
+        {{0x00e9e6cc3b181d9a, 0x00800e59bb23297a, 0x008688b7fedcdba5, 0x00dc01b3fdade3d5,
+          0x007a4860bdbaf63f, 0x0088eef2eafd6f6e, 0x0000a98979803121},
+         {0x00e69616359a8e19, 0x001a1107a5895023, 0x003c2bdf5d353dc3, 0x0053fb6df7698a20,
+          0x003685d0556f006c, 0x003619e3e8894579, 0x000007f6892a8b5a}},
+        {{0x005361146c236097, 0x00681c71cbf6b8fd, 0x00b1dfb3d5b03233, 0x00e23ad957c2beb3,
+          0x000bbcc9f874de9e, 0x00c1d06e908b4ed4, 0x0000f39eadf112b4},
+         {0x007351b06303e910, 0x008e2550e7f46cec, 0x0005283f634d4bf8, 0x005a805f42528636,
+          0x003eeade06617524, 0x0029f96dc2f741a5, 0x0000c66dc376be00}}
+    },
+    {
+        {{0x00024711cc902a90, 0x00acb2e579ab4fe1, 0x00af818a4b4d57b1, 0x00a17c7bec49c3de,
+          0x004280482d726a8b, 0x00128dd0f0a90f3b, 0x00004387c1c3fa3c},
+         {0x002ce76543cf5c3a, 0x00de6cee5ef58f0a, 0x00403e42fa561ca6, 0x00bc54d6f9cb9731,
+          0x007155f925fb4ff1, 0x004a9ce731b7b9bc, 0x00002609076bd7b2}},
+        {{0x00c1b328d8ee21c9, 0x000c91558717db39, 0x008b3f8686a92c3e, 0x0018141b1a4b5880,
+          0x00ca7abc43603909, 0x00bd1bd6e98b0d37, 0x0000f532389a060c},
+         {0x007e183923d86ecd, 0x0031b1085a4e9a7a, 0x005abe64360331ea, 0x00a2124163bc40ce,
+          0x003a82babd22cfb2, 0x008e696f04caa2de, 0x0000b9d2852cc3b3}},
+        {{0x002f1a5d6a177814, 0x00ba75332c984d84, 0x00e4f6c59fea185f, 0x007dbdf88b923fa6,
+          0x0094197b664c443b, 0x0030bb653049dba9, 0x0000cdf71b97c0c7},
+         {0x00853a9eaab4213b, 0x0027b3df0ed739df, 0x00600ccaced9b816, 0x0068f2cce4affde6,
+          0x00970c8c26771e43, 0x001682e90bb8674b, 0x0000dd1a3cff8310}},
+        {{0x009927c2779fa568, 0x00f027c20b658a96, 0x0005080336c4eb0e, 0x00ce9b050d33df43,
+          0x00dab49bfb590ecf, 0x00c073d1bdab6c10, 0x0000a5c22c7da00a},
+         {0x00cb982cb77d597f, 0x00a29e8ce352d7e5, 0x0049d7f536db6f3a, 0x008b67679ae17dab,
+          0x00a66c3f30ebed9f, 0x00865fdec9bfb542, 0x00009be8c8da2c89}},
+        {{0x00faa15e04100e8e, 0x00d2c0b3b6345159, 0x004029ea9526f8f1, 0x003f8560789e48bc,
+          0x008a5a3d6778c97e, 0x00ba3edab188372b, 0x000058678aeb2672},
+         {0x00b424eb103bf4f2, 0x00e52401933d45af, 0x008f9409ae51d269, 0x003b9ca554b7b1a8,
+          0x00266c46facb0280, 0x004605f00e0c1c2b, 0x0000675c65db0285}},
+        {{0x00cea65f9fbf5de5, 0x003c487f58dd3a7c, 0x007cb5b8f7c2cc70, 0x006b7bdefe8a91cb,
+          0x00d69d606e1a959e, 0x00e7d764b3f91021, 0x00000418585a723e},
+         {0x007e5c7c5b797de2, 0x00698a0d83371c6a, 0x0091e4bd2494aa90, 0x008a0f010c56ad8f,
+          0x00ddb1024e83ce07, 0x003114741b85ff12, 0x0000f190be7e5754}},
+        {{0x0047dc08f8b6275e, 0x006f7c8603ec8a8a, 0x004d2925997d7f95, 0x003374cdd847895c,
+          0x00ae039f638fdb3a, 0x00d3f2e97f2e0883, 0x0000e7da3887d495},
+         {0x009be1d3e4ae9016, 0x008d4bbbf03b0822, 0x004f51ea0a4a5323, 0x003ccaac26925c79,
+          0x00246efe41ff0842, 0x0081054b9ac69cee, 0x000086d31593e4b1}},
+        {{0x00288ebbb932196e, 0x00900f46db70be9e, 0x005e4e978b125166, 0x005669eb850d0930,
+          0x00eb7302d65ebcaf, 0x003b94eff6eba448, 0x0000e90123163bd2},
+         {0x006592a0822fed98, 0x006aedbd15553e9b, 0x00df2b9ffa4d111a, 0x00ca741397f2490c,
+          0x0093f447de8c4e7d, 0x0063943a0072f0b4, 0x0000bc486607ebc2}},
+        {{0x00d0599585db066f, 0x0012875db7c1fc77, 0x0069e9abf99ec414, 0x007c5eda3f008fd1,
+          0x00c8196bd9408ea4, 0x0071df59a2d4504c, 0x00009e8db6aeb9e7},
+         {0x00918f76897fef29, 0x00800516d8b55712, 0x00c33d2fb1d2e27a, 0x009aab20c09ce7f7,
+          0x0002099383f86ac8, 0x00362dcbf6eeef64, 0x00008d08d797a72d}},
+        {{0x005cbf46b820cc41, 0x0051ffe2208a3992, 0x00e73084bc48d181, 0x001338db1e629ed4,
+          0x0092f5a9f60b9d3b, 0x00d4665b9467e662, 0x00001a770f8f129f},
+         {0x0061f6017845743c, 0x000a861ea8c13398, 0x00875dbc3fd7a0ab, 0x00286a9c70ab88d4,
+          0x008318af4efef311, 0x00c2357993c5fd46, 0x0000daabebf43cc4}},
+        {{0x00cda0bf6cbe14df, 0x003cbdcf6ea8fc0c, 0x00ed0b08133249cb, 0x00b7917c811995c8,
+          0x003f921b6c6d7e59, 0x00299b56e0c389e2, 0x00008b9001d2f1c0},
+         {0x00bef8c14959cf93, 0x00690fb0bb055697, 0x004756b543fde3a6, 0x00286266075e4129,
+          0x00013c84070fba73, 0x00b00ece377250cc, 0x0000efcbe8267acc}},
+        {{0x001b1d5c1d5a9710, 0x002ea8af1d1e2042, 0x005e6a4a2925291d, 0x005c0d93509f54e3,
+          0x00cf9e1d908b8fcd, 0x000c1bf543472870, 0x0000c9472cae24c4},
+         {0x00fb0f10f4bc26e1, 0x00cc1efc2455d104, 0x002c72fcf7dbe6bd, 0x00f72b42a82388b6,
+          0x002f22aed932612a, 0x00517639ed089299, 0x00009e769bd554f4}},
+        {{0x009005d46d9f9062, 0x002367200e1d2e42, 0x0011c3ad40f8f4ba, 0x0081af24d0e5cf3f,
+          0x00bf43550368618b, 0x00d71c9e8f1e6432, 0x0000838a344b04b3},
+         {0x0072d3f9a7e46921, 0x00c2637ce30c5550, 0x000aedaed9bb3ac1, 0x00fd810475065f06,
+          0x00107f7f974fd668, 0x00b842455eaaf637, 0x0000a1ee25c2b34e}},
+        {{0x005b763bcad68884, 0x00b359e02c66779a, 0x00aea15207d55aa2, 0x00b4e18052a3c6db,
+          0x00d7366b93f0298e, 0x00bc0476962f417d, 0x0000c1e6e5e4fafe},
+         {0x00af35a2b7cf818c, 0x00f9a8c58f3797ad, 0x00e0f8d84364c29f, 0x00287efc3545e38f,
+          0x001400f35f70404b, 0x00a814eeceec4398, 0x0000f89cf775716a}},
+        {{0x00755cc0d2a5b4f0, 0x0037cc70a83a82bb, 0x00a924344956be6b, 0x003e4f554fed1361,
+          0x00a537d34210358f, 0x00cfaff59d542ae2, 0x00004065435bafe0},
+         {0x0058de61436fdcdb, 0x000bcaa3780a54c7, 0x003fec168bb481cd, 0x00faeebe678f0575,
+          0x007ff820ac003aa8, 0x00ef0b06c56378fd, 0x0000a39548f3fc70}},
+        {{0x00c535f4758b8517, 0x003955b633caaea3, 0x0039deb9b06671f9, 0x0039deef30f4f1cb,
+          0x0040b28a0cb9837a, 0x0066142b787ae461, 0x0000a6276cffd19f},
+         {0x00da54ebd4ff6c15, 0x00ec2afad4613f47, 0x00b3e2d88f635b81, 0x00e6ef27895a3911,
+          0x0086aca4ac1ca076, 0x008aea0a0f7ae178, 0x000012e78aaaf011}}
+    },
+    {
+        {{0x0003b2f6364f3d9b, 0x00075972dcbd7697, 0x004054a63592ffe3, 0x00da220c9b0a8ce9,
+          0x00bd4c63422454f0, 0x00d8af7dbe997ec1, 0x0000a3f973765d6b},
+         {0x00bdc0141fb62abf, 0x000e8ccaba0102ac, 0x0028076eec6c9fe7, 0x003251dfef194258,
+          0x0084c4a3f72bf2a5, 0x005953061b2bce4e, 0x0000228c22283343}},
+        {{0x009429a83dba7976, 0x00ecfa7889c3f021, 0x002688257d50ffeb, 0x00865c96688e5e8b,
+          0x003824c1be42b59a, 0x00ed0baad8a9a5ca, 0x00005007df563b0f},
+         {0x00a7928964b4c044, 0x009236a122379c26, 0x00f75d4dc8b971a8, 0x0073ec8bc104e20d,
+          0x002dfc3f732efa89, 0x001405dc28a26e81, 0x000068fb60a65787}},
+        {{0x000e4636a2f45920, 0x009c05409ebd770e, 0x00d52ff96bde359f, 0x00ee7fce776b418b,
+          0x00993067d015e540, 0x00105eb1a009c8d5, 0x000039525bfee4c5},
+         {0x009fdfd35f85aabb, 0x00e9da3d0d23d71f, 0x00cdb0f7a5dbb729, 0x0074212bbe4789de,
+          0x00f420a25285a9f1, 0x0043eaa38e24db16, 0x00004c788de4cfdd}},
+        {{0x00a43c8ce361626a, 0x00c61742ceba6ed5, 0x0053682d570a083e, 0x002b98b6dbd460ae,
+          0x002d9204f4b0550a, 0x006dc9f4ef04eba2, 0x0000aeceb2d5ddeb},
+         {0x004566631fa863f4, 0x00f2311d104da94a, 0x0045e4186ef720f7, 0x005ac83157da61ab,
+          0x0054e5df24abc077, 0x009e099599711656, 0x0000858175324b6c}},
+        {{0x00538a11bcea77e9, 0x0042308765d06c53, 0x0001a9ccb6bb6630, 0x00895a49378b8890,
+          0x000fd3c4053deb2c, 0x00fba6eb38b669a7, 0x0000be7aa0b1478a},
+         {0x0022ce90ce6dd6c7, 0x00b483eb7c6327c3, 0x00e417f8d2b66f7e, 0x00147cc0f5360fdf,
+          0x00cc5c27e0d4854d, 0x005cc36298ba9e17, 0x00004ab43385af67}},
+        {{0x009bfbf1c3413abd, 0x0077fd588cf2c816, 0x00ba44f315c950be, 0x00c6945405417345,
+          0x00134d24db6ba33e, 0x008d648afbf0b8dd, 0x00000c2cd7c2b28f},
+         {0x001d606961041f5f, 0x0012389582da4030, 0x003335bc4f97281d, 0x00c8571525c4046b,
+          0x00a08a6cd8172259, 0x00e6cb3e6c1b0865, 0x0000adddbe6e791e}},
+        {{0x0091c9f4cb882c2a, 0x000f76e7044bfefc, 0x00b8c8c08f797207, 0x00d4ff0df33316e0,
+          0x0099d51cbacc4cab, 0x00f0890cd92abc54, 0x0000a925d0a924ce},
+         {0x003ced4e78ae5070, 0x00ddb0f638d2c028, 0x00dbfe1ddfc25ecb, 0x00ddd88c0660b86c,
+          0x00df0d1434b687c1, 0x00597c1eca46cb43, 0x00006a0d7c7003ba}},
+        {{0x0011fc57c3a5a01a, 0x008f0dfb69b4f29b, 0x00c43684fe3d462c, 0x00ef91c31596abde,
+          0x001da970bd4a5771, 0x005560704c5c0ef5, 0x000011f391606494},
+         {0x00363315d8434a8a, 0x00b179b4b2e5d3ed, 0x00a71b44db54413a, 0x00b667823d500a4c,
+          0x00aa5c7f57251617, 0x000a55c8039a1c4e, 0x000005be970dc0e4}},
+        {{0x003613fc200bd009, 0x006a2ba9ccf36ffa, 0x00fa5ec560615246, 0x00cea1d73c6b094f,
+          0x00ab240c153cba5d, 0x006ccc7b2c6f2bb3, 0x000015938aeb17f2},
+         {0x0091a5fb626c8f40, 0x0067cf966a45006d, 0x0041d9bfc9258eb0, 0x009dddd487e9d5df,
+          0x006a23f7c89ca60c, 0x007cab506529d555, 0x000098bde7e5c990}},
+        {{0x001956ca46fab11f, 0x00aaf7e07c14fe1d, 0x00c2df1c10ec7c4c, 0x00a64dcae8fe39bc,
+          0x007119d13eca8ec2, 0x00205416a4f4d204, 0x000034f82f6a7bce},
+         {0x0025fc329f63cd80, 0x00041b1eac67a3eb, 0x009a48f9ac9e7113, 0x009ff939410094ce,
+          0x00c589ab4bb43be7, 0x003d936bb4781345, 0x0000343f6ef9343a}},
+        {{0x0067d5629332de10, 0x00dc4ceabbdd2a0c, 0x00ec59b00c9822e4, 0x001c77bf24cedbd9,
+          0x00696f8b26aa86ed, 0x006b976eb0d91770, 0x0000e09e59ce98ab},
+         {0x009b39215cc8cf01, 0x00d6e18df925a576, 0x001e878887069f7b, 0x00d9ee11e20453d8,
+          0x000b1dbec7ac1d50, 0x0025ea8bd33df781, 0x0000e8b8fa6a8600}},
+        {{0x00021d1a35411ead, 0x005a91f9ec8b5b75, 0x0035e56ec0d6ed4a, 0x00f66842a4ddf6ae,
+          0x00dc39bb5b6f2450, 0x007c4d53291228a2, 0x00002f0e7aa3652b},
+         {0x0056807d443530ea, 0x0041f69a385fb8e8, 0x00d18830fdbfc7af, 0x008aaf854589bf3d,
+          0x00cb878feeea51f7, 0x0062f0e2c9b330e3, 0x00000a4c9c17cf5d}},
+        {{0x00b75282241c6172, 0x0014a79bf9f6bcee, 0x00e8d098e75604f2, 0x00b2a16dcf572a4b,
+          0x0028f2a5c7c78139, 0x00608942a1034aa2, 0x00004ef64fcf1c99},
+         {0x000d8620eb0005a7, 0x00f1732379b1f39a, 0x00c7c1f1184207eb, 0x001ef0d5ae37d64b,
+          0x004bfe5a866927a6, 0x005a523f9bf3a075, 0x0000d97759ff042e}},
+        {{0x006d538369ff9d3d, 0x006494b86d4fc43c, 0x00bcef3513761a1b, 0x00bb3ae4e25b98dc,
+          0x003274378388e07c, 0x005170859815edaa, 0x000041ea17047d87},
+         {0x00ea70fcd1743c42, 0x00db90929002725c, 0x003b7fb39787945b, 0x00197c5cc079e4c7,
+          0x007c1bc98e3fb2d0, 0x008dfc52fd810e0f, 0x000096c6244e9474}},
+        {{0x006cc166d8937fd2, 0x00eb91fd74725faf, 0x00cb64128ddcf33b, 0x00b65a408a7d5577,
+          0x00f4730b4812d0aa, 0x0076f9d8aea60e5c, 0x00002eb0d1e664c6},
+         {0x0087490c2a6c7650, 0x006d5d4b724da590, 0x0081ff99fdd76c87, 0x00b2f4d7f5941f5e,
+          0x00559b2de9e8bbf7, 0x00474157f044cb02, 0x00001eefdd96b436}},
+        {{0x00fed8ddde151060, 0x0061b30add81d522, 0x007ea86ca648b686, 0x006d9fa8d0c86714,
+          0x00fdb4238ea6e63c, 0x00b4d63caec84571, 0x00001b8607872971},
+         {0x006e8711de1aa18f, 0x00727a5b5d3e242c, 0x00a1a4e95e69630c, 0x0038b8d1161dbef0,
+          0x006059b73750825e, 0x007307cbefa5933f, 0x0000bd60a0400f59}}
+    },
+    {
+        {{0x00147632821a86f9, 0x003ff4643fbe8a80, 0x003423c8d610e50a, 0x000562c17fd2bc60,
+          0x006aca2e5ff6e813, 0x003fc3e8c7985bc0, 0x0000064752e97130},
+         {0x00d3a7ecc9821894, 0x00b638f7b8a3b3e0, 0x00f80dc2df972fa9, 0x00dd8c9e89c22e28,
+          0x001b2937baf6f7b7, 0x0000080815776729, 0x0000930471319adc}},
+        {{0x005d563d97a70627, 0x00b7784d629ee3c8, 0x0016dc78034f652b, 0x00e21212f8d9f295,
+          0x00f320b0fc6ac9ff, 0x001233a60dc05785, 0x0000727b1e05c9f8},
+         {0x003f967c5651c107, 0x00c35abcc9454e79, 0x006d9b270122a489, 0x00d140177da41ae5,
+          0x0016ff176962f38d, 0x000ae7c4a6106e48, 0x0000ba2656c1bcc9}},
+        {{0x00a9efa62321c99d, 0x00b0172ec189ddf1, 0x008e2294e5d8a9f1, 0x0070ca97d8716b0a,
+          0x004b4de6c7d9779e, 0x004b8634dad2f690, 0x000007d55c0cbd9e},
+         {0x0016bc7d34f9593a, 0x00e7450249bb0834, 0x00c6f41a9b5dc5c4, 0x00f474733609b4eb,
+          0x006f17e3c98f2238, 0x007a4f4db97ec0a7, 0x0000b366bce70199}},
+        {{0x00dfd72bc34f6278, 0x00f0db1649c4fc14, 0x00fdc39cb2737e6b, 0x00d3ddd71f92d8b6,
+          0x00c9420292d67fcd, 0x00af4e0bfd0f5888, 0x0000314ac7fb2388},
+         {0x0055fc6eea2f9b4d, 0x0086e61a9f058cbf, 0x00644a109e94356b, 0x0095ed33b7f44672,
+          0x00d28f4bd8105f38, 0x0029e8f6e2c7a580, 0x0000603cb4916a42}},
+        {{0x00b504102a9573eb, 0x008303c0be7a0b16, 0x001998b5a2dd195a, 0x00fc20b373cf0a86,
+          0x00fff17cc16594a8, 0x00b727a94d49c610, 0x0000a936ce8f8aee},
+         {0x003da6af93d52871, 0x009a509f4e51281b, 0x005f524f98c75f35, 0x0081d02270175add,
+          0x004cadac3b987af7, 0x0042576a82cb43cb, 0x0000e95f565c9e00}},
+        {{0x003f390ce8462171, 0x00bb7d7083e3c0a4, 0x00cae1be80bfb8b9, 0x006228daa0c1b62c,
+          0x00f5cb2f8ab9903a, 0x005b9ede8c467a8c, 0x0000c805c04b8e74},
+         {0x00c6b8f13938d98e, 0x00bec0fa32384571, 0x009da44f399fb772, 0x0043ff484d2b0195,
+          0x001566aea360617c, 0x00ea309206f373fc, 0x0000de32a49eecf4}},
+        {{0x009c367929768cb0, 0x007ecd6a2de77b32, 0x00d12c6e2229a019, 0x009af86940379bcf,
+          0x0036070352a6edf2, 0x006bc8f9c4d1bade, 0x00000c7a9fba3c87},
+         {0x00eeffccb9558d39, 0x00a700e970927c79, 0x004e54fa6f2f4508, 0x00088fa7827fe7df,
+          0x00bfbe124b3c12c1, 0x000a2bd806d4c904, 0x0000cade916578b8}},
+        {{0x00b75bfdf5324c87, 0x003a183eeed861c9, 0x00d243b8def60a3e, 0x0005243e7e9c12af,
+          0x00f0736dc4450f94, 0x00704a74c6968859, 0x00002e4e9ade4ec7},
+         {0x009f735cc4a0143d, 0x0034d24d7ccd32c2, 0x00839c623b324ecc, 0x003f872163030730,
+          0x002dcd7d47d08954, 0x006994eca60f71d8, 0x0000ec1ef93ebbc3}},
+        {{0x00124adc813f6f59, 0x0040fcafb07515a5, 0x00f730b224556200, 0x004d854ed5173701,
+          0x00f0590787828f38, 0x003743d165b856e1, 0x0000b4af4e1535ef},
+         {0x00455270b1690533, 0x00de77276c554ff7, 0x0075323df9354226, 0x00b1689dadbcaeda,
+          0x008efb5811cd1352, 0x00fd338140cdc693, 0x0000be611ecdbb61}},
+        {{0x001ad41afd20503e, 0x002281e3deca88fa, 0x00b3302c8e778f9a, 0x00d7f5e07c817303,
+          0x0001d41eb64bc061, 0x00fc7669e42c92b4, 0x0000331aa9564cf0},
+         {0x00c168f182ac5abc, 0x00b9626b5051218f, 0x00bd9d96d2534460, 0x00e1006f0719cd9a,
+          0x0018cc97b5396571, 0x005698cd9c01e00f, 0x0000f648a4dfb881}},
+        {{0x00dc8ed8ec868f8d, 0x0055d60c746d8de2, 0x00754d3304f747c9, 0x00275fd0809d5425,
+          0x000997e94d6719e5, 0x0062e9da6ae36dcc, 0x000017b3036e2b4b},
+         {0x00d8c7453c9fa3a0, 0x003695c7b9c9ebd0, 0x00e6b8cb995c4930, 0x0012686e31a6b7d9,
+          0x0002ef601bfa016e, 0x0042558e1d62b940, 0x00001eb2ec9abcb7}},
+        {{0x00f9bb1cab83cd24, 0x00d2de43b41638ed, 0x007ffd4025d826d4, 0x003a33710b478776,
+          0x00e21bb327956049, 0x00ad6091e0b8a7d4, 0x0000dd3e3a20853c},
+         {0x00eb4b22744ee861, 0x004ae093ed7d92c5, 0x001f4b61ecd216c7, 0x00c39907cee53614,
+          0x00921231b76b5e72, 0x008102de7a419841, 0x000042c2cb8f62e7}},
+        {{0x002ee9bc73318395, 0x006d4f1514aeebd0, 0x00bb4bf4b1c9d763, 0x006739a7f8762fa6,
+          0x00fa6ed889bb04a0, 0x00d6b1840575e3af, 0x0000187029e1c57a},
+         {0x009ab461e4103284, 0x00de67898177c2bb, 0x0061147d1dc4001f, 0x000eb9cd7f668a28,
+          0x00245d9711fa3d17, 0x006ce89be1477b64, 0x0000bc5a64b58703}},
+        {{0x0095f28c8ed41930, 0x00bf14f94211a8c3, 0x00f565b4a2de0d2d, 0x0078784dfb71f47a,
+          0x00739b46175bf855, 0x00593ebfaa1a56b2, 0x0000512d92e4d3eb},
+         {0x00b74a1de7ea0948, 0x006e00ecec3ce437, 0x00b42a5e9632b1f2, 0x00ab96466bf4876b,
+          0x00e5122ae7cf291f, 0x00624ef28ee0d3fb, 0x0000b94809549699}},
+        {{0x000591ca110a0a4b, 0x00a8c60e9e412ef2, 0x00df5703f924b29b, 0x00a836260c097052,
+          0x00679cb0e4ca6d18, 0x00fd71ad33c09ab7, 0x0000fd4e4b084bab},
+         {0x00c0803579814387, 0x00ccd5e944f210b2, 0x00d027c7c256a02e, 0x008c90020803a440,
+          0x0067c6ab7e4eda25, 0x00e345d321e5a8fb, 0x0000eda317c9928a}},
+        {{0x0015681e7c8ef3d0, 0x00092a22463ea81c, 0x00c7400dccbb7294, 0x002c9a4b5e3835d0,
+          0x00e198eadc9b8906, 0x0092a0c1839805f3, 0x0000f6f048056031},
+         {0x001fb42cb582a2c1, 0x00a2871dba7c90f2, 0x00295b5b56bfb63d, 0x00cc1b5ff23561c9,
+          0x0077698d3ade08b2, 0x003725cbb7781a1c, 0x0000ae7650d5eeaa}}
+    },
+    {
+        {{0x00af1a2cbb0a893e, 0x00221ccfbe4d1b6f, 0x006ecd71b7ab65a9, 0x002645d77bc9436a,
+          0x004cd87676997c4f, 0x001d10d139f507ec, 0x00002cc111cd05f1},
+         {0x00d63da38c099f48, 0x00b2d15730d22611, 0x0030e1c292a5c839, 0x00772731091037a1,
+          0x008b2686f13a818f, 0x004592da0dff1bc4, 0x00003a5f27850b00}},
+        {{0x00e11ee78f502fdc, 0x001fb7802f474173, 0x006dd72465c85ce5, 0x0066130c26a05c4b,
+          0x00cc2b0ca7c8e6fc, 0x0044f8a8b70f6cf2, 0x00006fa9fe2e78bc},
+         {0x003aa05ae6935da0, 0x004713265cb960af, 0x00dfe834b9af4fa6, 0x00a0b4b270a9c5f7,
+          0x006bef3cfe35cf21, 0x0026805d789929fb, 0x0000d9e505a9707c}},
+        {{0x00074e920a2af4cd, 0x0072a65e89666d92, 0x003f50ed89009e77, 0x006a828a1d91fd88,
+          0x008fa4a1c986b5d9, 0x004cd6f1670e5829, 0x00001cd0f3555daf},
+         {0x00b5ddf44229a560, 0x00d1f4055e390021, 0x009063f0b59d1501, 0x0067332eb50176b9,
+          0x00d8251c5e1e3ca5, 0x002b3df0c642aeba, 0x00007d3f6b8fd7eb}},
+        {{0x004c3c1c268106ab, 0x007c605251d5e5e5, 0x007ce9236f3fd055, 0x00a07bed4317ff8f,
+          0x00ea90086a163adf, 0x00f2463bdfaa52a3, 0x0000a7fc27f272bf},
+         {0x007c662739df6db2, 0x0065a47c8791a299, 0x00d8e8e859da35b3, 0x00a9a55def5c5a7f,
+          0x00b96729939226dd, 0x00f217167c9adf81, 0x0000344ad7d91c82}},
+        {{0x001074c4978cee8a, 0x00f1caf38c493875, 0x00e5f1de67dc3732, 0x00bf9dd48fa22b6d,
+          0x007287100eed107b, 0x0040dc04841241d4, 0x00005ce0e6ea400e},
+         {0x00a78a2140f9438a, 0x0025f31709b3b9f8, 0x00d8374c07d8dfdc, 0x0066e29cb587feb6,
+          0x0098cbc2487c0c12, 0x009da344b24d45c7, 0x00001485367902ff}},
+        {{0x00909b538e84cc2c, 0x00bd712b25046d47, 0x00c67683bd31c216, 0x0081c6fab2f28f5f,
+          0x00ad678d52b89ebf, 0x00ed1d30ae0ec36e, 0x00009e3603b2a57f},
+         {0x00a05d307b459de5, 0x00b7237670ba7a33, 0x001bff9a090b55eb, 0x000f0c073d87c48b,
+          0x00d70408d19232ce, 0x00d734cfaacb7f04, 0x00009289edd9a704}},
+        {{0x0043676baa4f0d39, 0x00370fbff5afcd00, 0x00a3d64c2481584d, 0x00dd09f3eb262b9f,
+          0x007af966063279aa, 0x00e1ba77aa641ac7, 0x000044e00d1a42f0},
+         {0x0096c96d4d2b9b5d, 0x0040b71f782fdbaf, 0x00a8cf516c2697ec, 0x00745a3aebeb4a74,
+          0x002c73f22f80bd97, 0x00748bd15f17646d, 0x0000ced88b2cdf5e}},
+        {{0x00337bcb1db16089, 0x00e2394ba826bd23, 0x00a52381b66e7fe0, 0x00b158bd34c17985,
+          0x0049e090165882d9, 0x0088212da9f4bf47, 0x0000ae6f08712bb6},
+         {0x004e4ca4d5fe9b94, 0x0086aaa922d6236f, 0x0095ae1519885fc6, 0x00d6497300217a36,
+          0x007de1f5b83db405, 0x005afc205b64c14a, 0x0000345c4e0f3e61}},
+        {{0x0014e39fd90395a9, 0x0076fb26f64f4ad8, 0x00018cf347c06ccb, 0x0092eef44f89b238,
+          0x007c8b7bcd3d09f2, 0x00a967d4c9d99acb, 0x00004179c53bca1d},
+         {0x00e9b044f2915e04, 0x00692c182f18c4ae, 0x000f5dcbeb123191, 0x0032ea8553dd1541,
+          0x00b11238fa81e873, 0x0069d324491a8c60, 0x000066beed36f91d}},
+        {{0x00dcf5fa36fb8af1, 0x0048372304067b10, 0x0007f0e4f22b7bb9, 0x00dc9db691e17f16,
+          0x00af64f872546335, 0x00ed0ec4abc711b4, 0x0000b3c9578f9d66},
+         {0x00b6dc4ca7488a83, 0x007a3ea2d1877920, 0x0060d37bddcc51d7, 0x00653a29f4eddcbb,
+          0x00a11d7af4ae371e, 0x00cbcfa7b2a20837, 0x0000b8c480cb575f}},
+        {{0x007677d4e7ce0616, 0x00110ea8c885da26, 0x00e345538a1f314c, 0x0007ef5198d425c1,
+          0x00308c46120e44b8, 0x008a5aa695475124, 0x000033d418d5b1fc},
+         {0x00b2e1fcd68cf56f, 0x000a4dc55950169d, 0x002e1932df8c3d92, 0x009439d2c9644164,
+          0x0046a2e6d8e98d7b, 0x005aa0ec5c3110bb, 0x0000d53dc19c4239}},
+        {{0x00db6605ca810d3b, 0x006932bac7b1543c, 0x00edbcb50da1276c, 0x0052d2a74558c992,
+          0x00e7f1fe6b622e5d, 0x0081f97d66d0d084, 0x0000161eb5117709},
+         {0x009629542416a5c8, 0x00c5889d5907222e, 0x00f792c490b9d1c8, 0x002c092884f6752a,
+          0x00eb60afe38e4eaf, 0x00870320010d4105, 0x0000d76509be9f68}},
+        {{0x00355628eb24760e, 0x008493fe1f47219f, 0x00e8afc75fd479af, 0x00afa671bb0765c9,
+          0x00ef262bdc2c46ec, 0x001dbac52ab1b0a7, 0x0000a83f70f64771},
+         {0x00680f1b7ae29e7a, 0x0015964d1aaf32df, 0x00b330d0eeeaada1, 0x00f40ce771a6cfa9,
+          0x00ac7119cf473cb1, 0x0057b000ca0c484b, 0x0000c2cd688c0530}},
+        {{0x00fd490558ba397c, 0x005869a09c39e73c, 0x00d532254edc10fd, 0x00655a97a794d038,
+          0x005b642e4e2510dc, 0x0088df9d0cf0e4c7, 0x000028ae1132a8d2},
+         {0x005f2f8b5a2ce2e3, 0x0037a3c8c9162909, 0x006002faffb9a696, 0x0077e0ed645f9d4d,
+          0x00250b09ce75126b, 0x00469c26304cc256, 0x0000b6a719b273cd}},
+        {{0x002abaa2015f747d, 0x001e74cd4dfd1e5f, 0x00f7b27bbd9ad0c9, 0x00b05a935b1324ad,
+          0x0010d02f4772dd4e, 0x002b975d155f4cf2, 0x00003be56433bc84},
+         {0x000a97f4b8fd7ac8, 0x0011953eed7c5c88, 0x0051d6d06c6f2e32, 0x000df48009fa919e,
+          0x0070c574d11a7f33, 0x00add6bd79e58bd7, 0x0000bea9e6cac3d2}},
+        {{0x00c11e6e04a068c4, 0x0055bfcf794260e7, 0x00018a3cd01bd439, 0x0086fab6e11701c2,
+          0x00669c565de021ef, 0x00294d3e1cf4ae59, 0x0000da623d612839},
+         {0x00326f7bed75aa2b, 0x00cd9cc2dedd3ade, 0x00b0bac0b5ad6625, 0x007a30d52b29eeae,
+          0x005e3192ece8d411, 0x00c5d9a8a9119b92, 0x0000e3016497db69}}
+    },
+    {
+        {{0x007010de915046c3, 0x0070e95fbc35de23, 0x00a6e52df0f78db6, 0x0030df22e0441337,
+          0x00c41d955079b974, 0x004621fb2a8deae7, 0x00000ed6ca229768},
+         {0x0090b59410613a68, 0x00b4ce6afb7d08a6, 0x002130942442cc43, 0x004197f7bd7d0e2f,
+          0x007b4dfcc476287c, 0x00a8915b0ba4175e, 0x00004705dc6612e2}},
+        {{0x0012fe425ca8fad8, 0x00f6b9d10970f68d, 0x00dac7d54f8e0fbd, 0x00081d42013efac0,
+          0x00724ac078d97625, 0x0055e6adbe354fd3, 0x0000c7706509a1c8},
+         {0x00610d70ddee3fa8, 0x005954828a967f3e, 0x00f6b53a955ebf57, 0x007b90d88c2ae095,
+          0x00c0a40a56033472, 0x0067d33c1123818d, 0x00004cfec7ced5c0}},
+        {{0x00cd14cbe882e417, 0x00d6903b45f9aeef, 0x006c3cce0d4f6e0f, 0x00c22ce6e86612d3,
+          0x0027726f957231d5, 0x00f0ec1361b4f1d2, 0x0000af77322f39e0},
+         {0x00daf016e345a473, 0x007cdb8c5620215a, 0x00d6b73c95a1cb8c, 0x00bd0086b0b7284c,
+          0x00a9a3a50d2ed2cf, 0x00af6597a887e7af, 0x0000b4339bad20ad}},
+        {{0x00f246f15d80df16, 0x003a338e87308b61, 0x000e089c502c282c, 0x008c6372920df0a0,
+          0x0078bda49f92bc77, 0x00fe25b92542956c, 0x0000d4fb4faf93aa},
+         {0x004f49077dbf2133, 0x0073960d783e126d, 0x009eb6c179c24964, 0x00d9f6fcdc30ee09,
+          0x006724d3aeed6fab, 0x008fb9269eacb563, 0x0000b6224913af10}},
+        {{0x00d20f1b2ff2b2f2, 0x0089f54963de4e44, 0x00758b44afc88266, 0x00d9628b2f625eab,
+          0x0075bd8621904d47, 0x001bf04d295cb9e6, 0x00004c3db47fe47f},
+         {0x0046d6b783a68485, 0x00b0202a55beb904, 0x0089be21bae59ea6, 0x00657fc69f9801af,
+          0x0012b8fd695d3f96, 0x00d929d5daec4b03, 0x0000da97c08dc67f}},
+        {{0x004109be9d7f512d, 0x0062c3d1b173e77f, 0x001e214bc4edfca5, 0x00f4e86ceec067b6,
+          0x0075b7b39db493c9, 0x000ff9e191f3bff5, 0x0000b7509b4bd45e},
+         {0x009ec8a1497f2236, 0x0091f4da22c3e728, 0x0088aefaa657596f, 0x003ac76c0c781236,
+          0x001b4ba3ce9474de, 0x00a9ce5c127c3fda, 0x000032533216de0d}},
+        {{0x00c421e1a3c3edab, 0x00acd8beb12e42ac, 0x000b643ef05bf7a3, 0x008c58738482066c,
+          0x0019aa1d3bf49ef8, 0x00de16d83487c0cd, 0x0000a0b72c3f9f47},
+         {0x0048820bc28a0138, 0x00555f4b7cf09e17, 0x004d5b52d10efdb6, 0x0041e5caed591a77,
+          0x0053c498e26bb96a, 0x005b266374deb4be, 0x000065f00b877578}},
+        {{0x0025832376613a21, 0x00bb13470234a1c0, 0x00c98418abaacd1d, 0x00609ce622f1a6fd,
+          0x00d1e0c9ffb76317, 0x0085b81c2bc1a83c, 0x0000346e353728d9},
+         {0x008c082a6cf4ba90, 0x00b6c751335d2cb9, 0x00b3bffe1d455fbb, 0x00e41bb818b60e0b,
+          0x004444bdf51c5841, 0x006f79a3dc918c24, 0x0000b5536534d145}},
+        {{0x00ba811629acc75d, 0x0000c2ee22eb1a40, 0x0011e12de3725001, 0x005234de975e3a31,
+          0x004766eb5b5bc775, 0x007d6c0e36d23ca3, 0x0000637538bf8dc4},
+         {0x00607a50932b0f07, 0x006a020fd744ba77, 0x00091febeae21bb6, 0x005e0233cb6395da,
+          0x008470d4fa21a7ca, 0x00ff4fb07308fe7b, 0x000073e814265e80}},
+        {{0x00d472b92da214ea, 0x00ebc5c8310c2467, 0x00fae0e9bff1906b, 0x00b010519e8de497,
+          0x004b4309c055108d, 0x00879d6c0a6a7531, 0x0000c72f48497427},
+         {0x00a16112a9d7130f, 0x0093f6a84da301d2, 0x0030368cfe372441, 0x0024ce656da4c133,
+          0x00b1a37c5496c5e4, 0x00846191f6b86a81, 0x0000a6dd4a6126f7}},
+        {{0x00ec6b48840e5c4e, 0x00e9e0eac6fadb72, 0x003e190a3a69ab68, 0x00e73ced0aa3d187,
+          0x0032c0d718bed9e9, 0x00a2ee3338fdeb88, 0x00008dbb2006f579},
+         {0x00a5621725e1b236, 0x0077a4e9a3a15c3b, 0x0093f84f4d6c51b2, 0x0083d10c8659a986,
+          0x0030f88be7adb4d9, 0x00e9b6bbcd0c416c, 0x00007107a84fbfd8}},
+        {{0x00def08ed4fa394e, 0x005a9fc6b2659c54, 0x0026f365d873b39a, 0x00ee5aca9ef5f5cc,
+          0x003c2b547417487d, 0x0015221e33a6f99c, 0x000003ea7ee9aabd},
+         {0x00460e5b076a75e7, 0x002c526799d3de27, 0x00cf13dfb9ae063d, 0x006e83d27eb8eeba,
+          0x008f0ad9330723a8, 0x00d2934f0e3942a1, 0x000006731f5554e8}},
+        {{0x001decc057430a26, 0x00e0bec97046f929, 0x00a59d44e94c05ec, 0x007652776ee72d6f,
+          0x0004124d1e086b6e, 0x004de75f1a1a537b, 0x000038e45f9a55b8},
+         {0x0018d9275490b3a0, 0x00d419ab03f8afdf, 0x006fcccd3e9fd8bb, 0x00807a6b3ad1bc09,
+          0x00184b63badf22eb, 0x00eb52e6517c7eeb, 0x0000c3d23d4287cd}},
+        {{0x00909cba7f764113, 0x00847fd1c3f2477d, 0x0023bf744af45e8a, 0x00f6f96f76fc720e,
+          0x00e5d97cdd556617, 0x00860a0abd37f847, 0x0000362c722ece52},
+         {0x00d63c0fe1885c2b, 0x0068e8d63e7ad147, 0x00acec148eef33f6, 0x00f8b8dc788b8cfa,
+          0x0076ad988079e2d3, 0x0027bb352eab779c, 0x00009d1dc12fffb7}},
+        {{0x00a70f7292dc7a14, 0x0084fb505ecbef86, 0x006cb8f850148899, 0x00994c24fbd02117,
+          0x00f251ba340da187, 0x00d018e6997851e0, 0x00007d044d4c25e5},
+         {0x005758ed272995dc, 0x0055f0513fc0bf5c, 0x0037ad6eb5775643, 0x001fb9fdcb3eefcd,
+          0x00e68b3828b06270, 0x003fba5bb9ffa704, 0x00006df49dd9e835}},
+        {{0x00d1113d073804a4, 0x0094e2879a2b620f, 0x006c7ae897276bcd, 0x0032dc2d0ff068f9,
+          0x00c057ed29acf01e, 0x00a28b07842c5408, 0x00004996a15fe4c3},
+         {0x002c0d75b2ee34da, 0x0014cc308bbbe73b, 0x00182d13d768d816, 0x0052ccc678ee280d,
+          0x0064c8636571b00a, 0x00179e1a83da3280, 0x00009a09ca9d2964}}
+    },
+    {
+        {{0x00f057aeeb02d061, 0x007f0b2f3bc02ea4, 0x0032f86e089a05b6, 0x003031e72056aead,
+          0x00b8e23736ee2eea, 0x00b5395b51b855b1, 0x0000873893319b8b},
+         {0x0041ee49205e62e9, 0x00905ac40ea26258, 0x00b6506a5c3696ed, 0x00a4aef7d82c97da,
+          0x002c8acc0f317f1b, 0x001b20aec182bc95, 0x0000509e270d600a}},
+        {{0x00a172790038b3b1, 0x0025855184c30102, 0x00cd276b00ed8a52, 0x008ffb9b855ffb1f,
+          0x005b51f02e62f48b, 0x008f0f73b0570389, 0x0000b1af541b95c8},
+         {0x002a6621c7de8e5b, 0x0045943d4423c608, 0x002585c6e9bb9e34, 0x003975da38b940c8,
+          0x008f60b511f639a1, 0x00113b5c98ff50db, 0x0000ce20f9cd28c2}},
+        {{0x00827ac2235c5081, 0x0053d375308eb999, 0x0005154e075f7fb2, 0x009cbed9bd342ee5,
+          0x00a099f6d038f55b, 0x00f7d2140232fd05, 0x00002003a3c8a763},
+         {0x00d8653c5c50ae9b, 0x0055591b6f0972cd, 0x00696872aca58e81, 0x0000c7bd3af0bfb8,
+          0x00c4a1ecd7351f08, 0x001114918d4676a8, 0x0000d9d73dc03e69}},
+        {{0x00f1fd865454fe22, 0x007ceded96ae7586, 0x000dee85669016a1, 0x00c19917a9626a13,
+          0x00beeab451755490, 0x00b90549cf03b77c, 0x00007610bb500e93},
+         {0x001f453de97c17cc, 0x00840ad58150c3c3, 0x00cf4279281b2762, 0x000aeaa43fab3641,
+          0x008d40edb88da802, 0x009d6cbfc2cd8c5f, 0x000084e427caca32}},
+        {{0x00d08a60e2b7d161, 0x00f13d7e8ba1eeee, 0x001a8bf20b0e70a4, 0x00d5ad8c5f8a7437,
+          0x00de1de11cc082a9, 0x00e613debf6864dd, 0x00008ed46e9c6018},
+         {0x00e6acf47daf30ff, 0x000be624f7f26b67, 0x007d89aae477e504, 0x00e0d43d2037ab56,
+          0x00b13b65ed60a124, 0x00887428d7d7f91c, 0x00005a79d9cc5f07}},
+        {{0x00e191746a069ee5, 0x0002625ab02f1f2b, 0x00a38251d6674066, 0x0037264fd33ae551,
+          0x0018aaa40db2f6c9, 0x00841f7e06f383e7, 0x00009b3168f75e6a},
+         {0x0035d9d6bf5b21ba, 0x0058d89f7a92df74, 0x00e7495a313af525, 0x00bc5da22e4dbe7f,
+          0x00af40da471ba40f, 0x007fe8327700a3c4, 0x000009e92c7922de}},
+        {{0x0010920016b2a15f, 0x000ba5d3fc578914, 0x00b8a6fd20f114e6, 0x00c2762a8e856cff,
+          0x0008a687eaddbe77, 0x009771642ace347e, 0x0000c88e9b531f63},
+         {0x001dceb0c816d1b9, 0x0079463e23b8dde3, 0x00467fe5c93e8b5c, 0x009703a586f5d64e,
+          0x00c2e4420476e6c3, 0x0055a3209a451d22, 0x0000c63328e8cd8c}},
+        {{0x00ef0288c00ea431, 0x00b7afc66ddad317, 0x00aee9ce4617e739, 0x00395542c19212c4,
+          0x005cf0604cef534f, 0x00582957cc340b8b, 0x0000a068909f7c3f},
+         {0x00bfaedd5cbf427a, 0x002e87331ef7616f, 0x004658d2ea8f0c41, 0x009f9bf24f9a10b6,
+          0x006f1fd6015d6d9b, 0x00fcef6f1bdec1e5, 0x0000bea3c1351abd}},
+        {{0x0045638533fa6a23, 0x00bf20d9bfc83615, 0x0068c54e05ddaf5f, 0x009a8a78992e9325,
+          0x005b07cf07e1dfc4, 0x0072f4bec2f18b06, 0x000028051e714e3a},
+         {0x00544673709b3da6, 0x006e672425241b01, 0x00ce559637266ac0, 0x006068fea47a13ee,
+          0x0057ca5529a38b17, 0x00e0a5949fe26040, 0x0000e47728aa5644}},
+        {{0x00b3929bb00cba1a, 0x00ee5ee328539a86, 0x0002f105303f2fb6, 0x002b162ab664b129,
+          0x000a5950f22ae42d, 0x00a18585e88bc7b4, 0x00009c44179a8bd0},
+         {0x00af6a5314d4139f, 0x0018e6d7db0bd03a, 0x00a2c84131465b01, 0x008d3e90a0f3da0d,
+          0x0019137a4c9c69ce, 0x002d8e530574c425, 0x0000deef8007c9e1}},
+        {{0x00f56737d6c94a24, 0x00fd097e0dc76a36, 0x008ad9a3478d318a, 0x00d990c549e38119,
+          0x003ea6d5d456b8c0, 0x007d9f354dc04afd, 0x00007db006b6cce4},
+         {0x00e7eccaef47c2ca, 0x009d41eeb15264a1, 0x004d6cd379c6c133, 0x0093e780fdd01075,
+          0x0026cad8db035818, 0x00b461685c729c02, 0x00009aad616831c1}},
+        {{0x00dc000d227f03db, 0x005cfd17fa50f66a, 0x00e1e01f5e8cda63, 0x000d3800c6c0edab,
+          0x005c06d1edf08133, 0x002779f433e9dbd8, 0x0000ea2d0da5dd3d},
+         {0x0006ed8e82f6f091, 0x00f50398918c4a60, 0x001b221c7aa67c7c, 0x00bf3e4003f04e3f,
+          0x0089e508bc8a9fdf, 0x00d8503e07da7d8f, 0x000087f1c8b1038c}},
+        {{0x007a4d032c343acf, 0x00e005c2eb6096ba, 0x0032970c8e2afa05, 0x0010930c952aea23,
+          0x0013888413e84b7b, 0x0051f4feb423c84d, 0x000066f09cf5ebff},
+         {0x00dbc0a5ca7a06db, 0x007f31026fd619ab, 0x00a157120c29fb47, 0x00bded56157ef6c8,
+          0x008d1a1e07860a96, 0x00b6ac25b3ec9f40, 0x00007f093c11b2b8}},
+        {{0x00489f0c4b47e563, 0x0008c722cf1ce1e5, 0x0095e5e50b3f2007, 0x003d6fb63969b23a,
+          0x00aadb59bddaa92d, 0x00734acf4ad492ac, 0x00000757e3a808f0},
+         {0x0009daa53a0bb189, 0x000ef8031db823e9, 0x00de5f3c69047d6f, 0x00d1acc71e68def1,
+          0x00b5e3ddf8942add, 0x00a7b7cd4a419167, 0x00009c7713d7aeb7}},
+        {{0x0046514af1a956bc, 0x0078e31851ec8d43, 0x00bee7fac8b6e20b, 0x00cff5b4282f0a95,
+          0x00aa5c5528bf4539, 0x008c3e6b2aa5c71c, 0x0000a1a272dfa57e},
+         {0x00343722cb7a7f7e, 0x007b9f31bf33bfb6, 0x000cf4310192d212, 0x00d66ce2dbf27474,
+          0x0049ee97c0c6f74d, 0x00e38f7c315e35bd, 0x0000f8bf71697508}},
+        {{0x0005f3220d71d442, 0x00fd9b71076f0025, 0x000f553e946b7164, 0x0060518230c05782,
+          0x004ea967f2ecc083, 0x00b07dd0bdcca9bf, 0x0000d4e59198608d},
+         {0x00b80367f5b834cf, 0x0079a5fcd18ce5e4, 0x007b214592a96183, 0x00ede301efbd1060,
+          0x008e4b41c1e82061, 0x0050f198c302a204, 0x000096c4edbd1477}}
+    },
+    {
+        {{0x00b3b85844aecdb0, 0x002da0f117801ba2, 0x00c379972959abc7, 0x00ea04c0ee30d700,
+          0x00623bcf840526f8, 0x00e753d8437dc3d3, 0x0000e18673956b23},
+         {0x00330e3f3c9061fa, 0x00d5739d23df03b4, 0x00683a634b892446, 0x005a83569d0e3db5,
+          0x00042846bf210d59, 0x00be2b89dcd81630, 0x00002af917ebac27}},
+        {{0x0032546cf8de14fd, 0x00f47f7ec4400bcc, 0x001e022aa89b5432, 0x00022894d755266c,
+          0x0060b37b3b3c490b, 0x00c493eda3420796, 0x0000a30a45760014},
+         {0x0033dd66f5833839, 0x006c3aa31e8acc09, 0x00f116900016526a, 0x005aa918bfc8ae5f,
+          0x00cfe7e8115c844d, 0x009fc74fdf44b571, 0x00009edb22c1c8ff}},
+        {{0x00196b84e532a52c, 0x00dd42b7feab524b, 0x007d97e6c4b1c425, 0x007ddd616f3f5a79,
+          0x003f018fb94f95b0, 0x00a6c5735f17ad40, 0x00004157400c8b50},
+         {0x004254a75aa6d751, 0x000f57b9b288d87e, 0x006bf0118aa9d885, 0x00920f9396b7d3d1,
+          0x0025c6a0fc8a02ef, 0x00ae58c330d55364, 0x000011e0a1a4b728}},
+        {{0x00297e9d46a38d64, 0x007c613cdbdfc21d, 0x00345d8a3fe6d856, 0x00d0843c3c78f549,
+          0x00715f3dcba965ff, 0x00b7729ef2facba9, 0x000004cff10cad19},
+         {0x00bb8086499baabf, 0x002de93611540a9d, 0x00b96df97cf810d5, 0x008f17cccad25b5a,
+          0x005227d40b5f1e42, 0x008a374c0fa39af9, 0x0000a1daa4dc7866}},
+        {{0x00bbb78af61fb88b, 0x00ed6812c16e5c9a, 0x00b61c69a8b7acc4, 0x00d34efaca94fcf2,
+          0x001ef45d8be7d467, 0x00e1639397c1c7bb, 0x00001a3b765628fc},
+         {0x00d8c011d40dc97c, 0x00784be8bc8ee0d0, 0x00f0746c6be5c8f8, 0x009cff0a76055d43,
+          0x007ebd004083cea2, 0x006c43d4d2c7ce42, 0x00008fdac7349f5d}},
+        {{0x0016f2f41db74d06, 0x008fbc0e43eaa05c, 0x007de1abaa6a11dd, 0x00b4e08699c63a52,
+          0x00571297fb6dc538, 0x0044a8ffb235a36a, 0x0000a3aa7add01e0},
+         {0x0029437a28605e83, 0x00193eaa2982b4cc, 0x00ddfc240abb97b1, 0x00d1917474af6b59,
+          0x0084628e1050478b, 0x000e0f20d826b67f, 0x0000894be71df234}},
+        {{0x00e70565d10e82e6, 0x00f54306eb61ac48, 0x002b3b766fa6c484, 0x00ac456705c84a95,
+          0x00d8d13bcd2bb57c, 0x00d8b3cade0243f9, 0x00007256ac3d863b},
+         {0x008024bbc5e5c327, 0x003a985ad6dcf1f5, 0x009c9946cc4a32c8, 0x00043508f5655b4d,
+          0x003aa94d8c6a39fb, 0x006a17ac887b10a2, 0x0000f56ce2268ace}},
+        {{0x00a2ae350020362e, 0x001df419bf5f4984, 0x0018287c9b53ea2b, 0x002b7b03e92bb64e,
+          0x00d5a52411c2df65, 0x00506e23a42ea485, 0x0000e10cb36d11cd},
+         {0x00f50bfe2adaefc2, 0x006b5536adb53ee5, 0x007fe90ed2a46466, 0x0006cc84c07768fb,
+          0x00d6ab0b425d7817, 0x00d36352ec806a31, 0x0000d7e679724697}},
+        {{0x006625ff0d48b4b9, 0x00fc1312f6ad9c46, 0x003df7d6dd64eb8c, 0x00bed849cbe3f9dc,
+          0x00974c3c311f8b7e, 0x00534b7f2aba0378, 0x0000cbc9e51b9acf},
+         {0x00984c2677bd743a, 0x0025f8272e102c23, 0x00ec8687c08f6d01, 0x009110bf3bdb8516,
+          0x00fc2433ed8257c1, 0x008982ca4739fe90, 0x0000b386146abc14}},
+        {{0x0002634ecd3268cc, 0x0026081d5e79c759, 0x0068596e3768c2d2, 0x00fcd1d01c9337dc,
+          0x00ccb2d10a7214df, 0x0054462be1a0120d, 0x0000f4250cf97875},
+         {0x00b56e79d660a632, 0x00b95d0691c176d1, 0x00abf60b2b335621, 0x0094c5d90015a02a,
+          0x0009675a7d400779, 0x00fb05ab35f431f3, 0x00002850acab268b}},
+        {{0x001b624d937abab1, 0x00ee4cb1a35ea5e2, 0x00ef07d6920a9f88, 0x0035b3452c1ffeaa,
+          0x00894ffc527df614, 0x0015c46ec0d4e7f3, 0x0000e0027c109297},
+         {0x0059fa695469779f, 0x007c273870686bf2, 0x00dc1c11638fa77a, 0x0070d64edb96ff2f,
+          0x009f466883308119, 0x0005a54cd4198c79, 0x0000c8506a711b6b}},
+        {{0x0088a861736e3d5c, 0x00250f8bd63b2d13, 0x008e4aabe81a4847, 0x00f4a2bc00976d71,
+          0x005ea6a8227b9afa, 0x00a63d73380cd21d, 0x00000e1956051ab7},
+         {0x00827bbfff3b601a, 0x0029c23cefc6b5d5, 0x00a92aec9fb76d99, 0x0078c66aa800281e,
+          0x0015adc8ebf8f06f, 0x00939e460e341409, 0x00004851df183c84}},
+        {{0x000760fefd865afd, 0x009b92f63dfa92dd, 0x000348a67716577d, 0x00f733739bb579d1,
+          0x001acd74c55ee373, 0x005ee15130e76233, 0x00007d2b51e27e31},
+         {0x0045ec495f2b8fe9, 0x00b8f119c9b6bacc, 0x001e313071e3d9b1, 0x00a860e7cc529336,
+          0x00aebe8f861090da, 0x0075107095892ee2, 0x0000a307b3706c58}},
+        {{0x00488be28690d024, 0x009434a9756408f0, 0x00c38c101a9625fa, 0x003d56effc3fb0de,
+          0x00866678c07b07cf, 0x003bc3d65f21bdb1, 0x000022c1456c33bc},
+         {0x00a0301e968ee6c2, 0x007dd45efe56de9b, 0x00fefc79be139437, 0x0050e10c51a2bf4c,
+          0x00b5846970c1a2ab, 0x001570ef131e1a63, 0x0000313cb9733afb}},
+        {{0x00a4577f2149461f, 0x002594031e089683, 0x00ff8637469386a7, 0x000aca23275cd7db,
+          0x000e1960ecb1a372, 0x00ef6808e5ef80df, 0x000030ec2a2311d5},
+         {0x00c539430518545a, 0x006e7876d791a18c, 0x00eaec8e7dc8bd3c, 0x00aca88978f528db,
+          0x0097cca9c74fabdc, 0x002aaa7b3d0e69ce, 0x0000614faed851da}},
+        {{0x007b2e13e2b3d371, 0x00a1af71d9bee158, 0x0046af7a3e330065, 0x00c129f201e67b6a,
+          0x0034c52eed8d941d, 0x0016af0bb35a2b7c, 0x0000f0cb9e354737},
+         {0x00b062cf34eb3b8b, 0x00de7f9c66e98d0c, 0x00bc1e6e6cac7192, 0x002265e29f22c87e,
+          0x00fac3a543ce5083, 0x00c04a45b6a37d2d, 0x0000b727daf89515}}
+    },
+    {
+        {{0x00b71d742808e9d1, 0x003fd27e125f0ef8, 0x00a400a9db2a694d, 0x004b4e69d07ae918,
+          0x006dbf08b3967e77, 0x00e6cf3cde541f7b, 0x00009e9ba344be18},
+         {0x005d182e14817498, 0x0017408b222209d9, 0x006640f72a8db358, 0x0034a90efbe1edee,
+          0x0040671787420260, 0x00ca90dbb27c39ae, 0x0000f4f15bd5ef27}},
+        {{0x00511cf10a9291dd, 0x000b2841e742020d, 0x001e095b50ea0760, 0x0035c086e9eb4ad3,
+          0x00ebf3a286d52e53, 0x0025fe44a7534802, 0x0000728b39afe590},
+         {0x002b588a5e0aa4a5, 0x00b817083eac3f0b, 0x008d3dd71326ab08, 0x003cc80e0a17838c,
+          0x00e87ae4688545f0, 0x00647db78c55fd19, 0x0000c8cacc04541e}},
+        {{0x0006cd2effcb804f, 0x00bbd2a7cb17b7d5, 0x00d822d4f1530285, 0x00c8ea05f088a9c0,
+          0x00271222a296b88d, 0x00d40aa155d18844, 0x00002da4957272bd},
+         {0x006145beee9a1bca, 0x009b399d158c51cc, 0x00e3191554472176, 0x0013370bb73173a5,
+          0x0037c24901fafad5, 0x00b3df4f553fb4ab, 0x00009e3432de57cb}},
+        {{0x000642f837c3ccaa, 0x0046cd7bc1a00d6a, 0x0001efc36d768f8d, 0x005677cfe55f3af2,
+          0x00d268aace059f5b, 0x002e0cd71ed2a695, 0x00001a60ec14eeb9},
+         {0x0097f04340111ed6, 0x005625962a83fb90, 0x0033130860daba95, 0x00752a51f0561813,
+          0x00f4b8e09614a3ec, 0x006fd59d89fa3427, 0x00008859ef7eddb9}},
+        {{0x00e98ad092a18681, 0x003088d9bae13453, 0x0061baacdce5f3c2, 0x0016abe971c39561,
+          0x005f00f95142853d, 0x00e1cbff3fe6ab55, 0x000002448c4d8de6},
+         {0x002c997623fc5a0a, 0x008e7c1b41ea36ae, 0x00641378e5ebcca3, 0x00329a1312d8c1a8,
+          0x00894807a3e51b29, 0x00353ca554dcc81d, 0x0000b606fe85527c}},
+        {{0x00b9ae60f4e78779, 0x002e514f1770ee50, 0x00806aa4b7d74189, 0x000eaf1c55daf22e,
+          0x00ef3d1d1f3c6fc3, 0x00706b6aaddc2dd7, 0x000057941dcd1de2},
+         {0x003e14035e54c4cb, 0x00964dbbee525589, 0x00ca2576da1197e5, 0x009a57befb9422e5,
+          0x00ab21f06c9e478a, 0x00ea0af57e93e16d, 0x0000dc6b582b16dc}},
+        {{0x0074931722dc4a4f, 0x00e4d3c14e98ca79, 0x00d5f02bdcffcf03, 0x007058f0131799fd,
+          0x00316f47279ddf1e, 0x00340f2856afe8d3, 0x0000122ef2ab708a},
+         {0x0000c9dbeacc912d, 0x004254d71af61b42, 0x00ec7eb04eec22c4, 0x00cfd6f9252131f1,
+          0x00ab6a0236dfefba, 0x003c24732d8707c4, 0x00006b4824fc321c}},
+        {{0x0014ff5ec910ca1a, 0x00bf046231183083, 0x006ec40cda175bf5, 0x005c38b0b0bf6bdf,
+          0x008a0270cd1467ab, 0x00a65626692878b4, 0x000091ac9bf0dfbb},
+         {0x001e6d55d0ffbdba, 0x0080c490056fe9cb, 0x000738fca75958ec, 0x006c17ecda4720c8,
+          0x005c52a15bd0200e, 0x00a60fb689d675e3, 0x0000ab87ccd7595a}},
+        {{0x005479da3ddabb54, 0x0015386c3550daa8, 0x0067e7d222263a3b, 0x0043cbb6bd9b6526,
+          0x007536e5177afb9b, 0x00c527f7b5e21117, 0x0000aaf1877c694b},
+         {0x00b73ed8731c1058, 0x001b6893da38ef63, 0x00645975556110c8, 0x0034548d48ac98e3,
+          0x00d86fbe24154012, 0x00fd0ddace5ee4d1, 0x00006c17d27a984b}},
+        {{0x003b394bc829b105, 0x001c2c72472a1738, 0x00cba93897aa82ce, 0x00e57cd5f7e6e07c,
+          0x00ac3899cc05d2d5, 0x009b2d04fa300563, 0x0000755029d2572d},
+         {0x00d3ec32f262393a, 0x00fea69289a20abd, 0x0019ba8eeb521468, 0x004b5a59aec7609e,
+          0x0069b2c3b1c6cf54, 0x00aad37872bc7e7a, 0x0000704be6d45e00}},
+        {{0x0040ee2c984278ea, 0x00e4adf2d50aae03, 0x0051f591a1128529, 0x00f27e367fae1129,
+          0x00f61add468cb8d7, 0x0008eaf93038b4a3, 0x0000726e2945a0a1},
+         {0x00b57940ee605e2e, 0x00c0138cfe13cb7f, 0x00ca122920f05074, 0x00b52ae35ee5efab,
+          0x00bf53106ff689ac, 0x005fa56e9f7408eb, 0x0000274e94f6f0f2}},
+        {{0x0052e818625caf5c, 0x0027f73c04ad5577, 0x0097199e3b6acc8c, 0x00811313aad774e5,
+          0x00787b60493ebab6, 0x00b375338b575e99, 0x000035ff5dc5a821},
+         {0x00d101ac95ec4b5d, 0x002364c1560215f9, 0x003765e7423786f7, 0x0092d8959bb0f0b6,
+          0x001101e35679fae2, 0x00938a6ec26c641c, 0x00004428a2aa6e2a}},
+        {{0x00ca1b5b2a9dbbf8, 0x00eb3361686d1d4e, 0x0072746fcf74650e, 0x006de520f5b32ce2,
+          0x002555e1afa4f489, 0x00aca10d7b9fd498, 0x000006da79c5e20c},
+         {0x00f0ecc011f026b6, 0x0038802c0bf4b14a, 0x007d6ede8cdf1ac7, 0x00ae95dd369e642b,
+          0x009d255877da74e7, 0x003aa73c91e9169d, 0x0000cec557be78d7}},
+        {{0x00054bab62f0eeda, 0x002126124f2150b4, 0x0011b6e09a083ca0, 0x0061830d6a653a5e,
+          0x00c60012a9f0c17e, 0x003debd0fb6a94e6, 0x0000247ad565b1a0},
+         {0x005b153e9b31b2c0, 0x006f6774787263d2, 0x005c063eb60c6144, 0x00f2fdda9f940f75,
+          0x00087c38fce9cfa0, 0x003d9d7800cc7749, 0x000041b814adb2c5}},
+        {{0x0042c046b257691d, 0x00717c5a380683fa, 0x007e00460d10841d, 0x0085883e5f44810f,
+          0x0053224a64c9497b, 0x007dc13b4a0c9bca, 0x00002cdf587c1125},
+         {0x00d61dbcbe3d8f04, 0x00a7a65e7cb8e4a4, 0x00e360b536309a45, 0x0012a345f814d307,
+          0x00d247e93aa6312f, 0x00860deaefef2d23, 0x00009634f049d62a}},
+        {{0x002676c4e07c2449, 0x00205f27ff204180, 0x00ab5d933587aa28, 0x00c0b205177a299c,
+          0x00ac1c0ceff6ab98, 0x00e6bc9da2425a21, 0x0000f07d5ca532f0},
+         {0x00d303693f98652e, 0x00fc80ea413e12a8, 0x002ed5d421041901, 0x00f9971ba97b70cf,
+          0x00c73a3e4557ee8c, 0x000df138cb110c1e, 0x00002288a43cb47a}}
+    },
+    {
+        {{0x008ed71ef01c5653, 0x007b276588ce43cf, 0x0066e5863058d944, 0x002a337185abfc6e,
+          0x00f1db01909315b3, 0x00e335500258969e, 0x00002a28753805b2},
+         {0x000ef385182b1d36, 0x001f12c62b41886c, 0x00fe0d79face86e8, 0x0088b66b31483bcd,
+          0x00fd7aa991708e9f, 0x00aa0133b810a399, 0x0000d6fbf9dd4b8d}},
+        {{0x0066e749256eb547, 0x007dd3d20bc008c0, 0x004191b8b552cb20, 0x0016c504757dacd8,
+          0x009d064b00088cc1, 0x0018635fe835db36, 0x000003650873927b},
+         {0x00948b386ee6c982, 0x00322e7b9e974e53, 0x00556bb2d5d8a578, 0x0066527a63386101,
+          0x0091a1903ed290b7, 0x00e3b0388b7a9f7e, 0x0000811e25b1226c}},
+        {{0x006c3c2de9f3f41f, 0x000a6a8be0bb0f30, 0x00579b980bd2637b, 0x007050cc385fe8f4,
+          0x0052ae0d329b51ad, 0x00cb90f5d3c71dd8, 0x000042511597bae4},
+         {0x0027f6fa5f836cd3, 0x005bd5ec90dd3a51, 0x00b3e0064e16d492, 0x00ca62de75255599,
+          0x00809861391c23f9, 0x00d15b7b04a08609, 0x0000b0a2a5cd4f1c}},
+        {{0x00a7d47dc3d602ce, 0x00edf2df0ff407c5, 0x00c392cafafe7248, 0x00be714244916cc4,
+          0x00edb4f9558a4ac2, 0x004de45ed1f12e23, 0x00009d08b6ddb8a8},
+         {0x001bff2a9e9da7cf, 0x00dfd254b2a8e717, 0x0069f9ef46ece6d3, 0x00ff74f165103998,
+          0x004fd2d6a4d7479e, 0x00e720f0dd41bd16, 0x000018ba98d20df0}},
+        {{0x0095d32e1f4043bb, 0x00ac03e87e8efb7c, 0x00e22efb2783e315, 0x00125cb199ed2cee,
+          0x00a020ac3be3e956, 0x00706a3b201c8dad, 0x000019d44e64648b},
+         {0x00bf5842d9f934cd, 0x00f72b0c7a771aeb, 0x004c9388afcc1cc9, 0x0092c8cd38041c62,
+          0x00e17e1e5f655b96, 0x0072f2fbfa55d1f8, 0x00009431f6eeb0f3}},
+        {{0x00e2d1bb6c9e9744, 0x0049e6ced807923a, 0x00a43d67ca5f670e, 0x00f9af1b8476b597,
+          0x001e69b30bd0f129, 0x00a23c5546293806, 0x00003ed69b4330f8},
+         {0x007d57861e4877cb, 0x009871a728c69d99, 0x00ab88fb7ea607c4, 0x00b0d5441acabb83,
+          0x00b9450dbf12f90f, 0x001020dbb1fdadd5, 0x0000125ce73e9b4f}},
+        {{0x00aee51f53531678, 0x008e26ac9928c282, 0x0080587109ec3864, 0x0043cbd033519f73,
+          0x00b7a9798d940476, 0x001b9dfc99404aca, 0x0000a87ccf3e6a82},
+         {0x00cdac6228830c23, 0x0011b7036751bad9, 0x003ac4066c33c21f, 0x003ff4e231387973,
+          0x00ed307352d61b11, 0x004412e0382d45bd, 0x00007187b8ec4b64}},
+        {{0x0004e031b839ad99, 0x0078820265b684bc, 0x00a9ce7246e9f98f, 0x00823717f82eec1a,
+          0x00fa9e3a80670864, 0x00d9111f97e2a310, 0x000083dcc3e1c4b4},
+         {0x00a7604c5595d9e9, 0x00f7dea720a52c53, 0x00e1b68776ba30c6, 0x00c8bc7c3b2203f9,
+          0x002262da7fea2093, 0x00b7c358b72b3c3a, 0x0000f54f7fd271bf}},
+        {{0x00a57b8ab67abc7c, 0x0037cede05f28632, 0x0074ddd914baae74, 0x00d007f7610537b2,
+          0x002509c7c990e182, 0x00f5791e282d8c71, 0x00003ccfac899069},
+         {0x00d2fc6c18425747, 0x00efbcba19380ac3, 0x007cb19cd567cc65, 0x00ee407933c29999,
+          0x0089c5e7eafccb0e, 0x00bdffeefe317d92, 0x0000f4cb37803570}},
+        {{0x00179681213a6e54, 0x00597159fa670413, 0x00314c101f3c392a, 0x00c507964a86d9c1,
+          0x00782ec66bc5f2a5, 0x00326f55eb59f7d9, 0x00006a2cb15bd2c8},
+         {0x0048dc4f53553c1c, 0x004ffaa9992da742, 0x00e1521c51c56b64, 0x00b77cc0e96a6885,
+          0x0043053b0aad44aa, 0x00efaf03a667997c, 0x0000c6b622f3b2bf}},
+        {{0x005aaee99ac1af03, 0x00adaca2ac9b1760, 0x0059c6b16de8d78d, 0x00391cbebf656361,
+          0x000d46ed94539192, 0x006d8f07b9b6eebb, 0x0000881ccdc0581e},
+         {0x00aa7f059a6495e8, 0x0061f1951b46dba0, 0x00a43c22098be516, 0x00a4840f783e2337,
+          0x0058cfa394691129, 0x008db02155956369, 0x00001608dd864840}},
+        {{0x00ee3b110b626e1a, 0x0057434490120d8e, 0x001d7893302e9409, 0x00ffb707be1cc85f,
+          0x0076930e8eabf14e, 0x007d959cb6201069, 0x0000199bd0e60552},
+         {0x007c81b98cc5a87b, 0x009bf5be5ec0d2d6, 0x0051b036d8ca9cc9, 0x001d311e927a55d3,
+          0x00e99e305863a17c, 0x0089a93914185c1d, 0x00003a0501fad25f}},
+        {{0x00fcaa7207907ecc, 0x00010b0870528775, 0x00280e8ec981b1bd, 0x00d341690dfd234f,
+          0x006df352e9b7c65d, 0x0095af188e4ce117, 0x00003221e83e3265},
+         {0x00ec70ea9f7d036c, 0x002977e9fa1ea8da, 0x007255b0f9977cfd, 0x0094d0da33b42379,
+          0x00ea21888a92feef, 0x00421001b6feaffe, 0x0000bb214793de16}},
+        {{0x00cbba0c3df306f7, 0x00f691120599f1cc, 0x003b9151590840b2, 0x00324645c0cb0cf1,
+          0x001f2542c440359d, 0x006c75c09dfe830d, 0x000005067d67fabd},
+         {0x00fd04dfd5c30780, 0x005e6c731614b784, 0x001482c08528d45b, 0x00758267117e37e7,
+          0x00bf6462a3711867, 0x0054d902131d55b3, 0x00003c4368aa78d4}},
+        {{0x00f89050a4c8f287, 0x0061fa39f208ec00, 0x00075f4931599652, 0x00c6fbdabca3a305,
+          0x003aa1923728ae0d, 0x00d487da57ca8d13, 0x0000b4f81e592b39},
+         {0x00b5d9f6e3f6c9b8, 0x00f7e2f3eac0c392, 0x00ae26791b0d0e4b, 0x0095c8ccb98dfd4e,
+          0x005bdf1216277de2, 0x00e374d8c0c596f0, 0x0000770cd2a117fe}},
+        {{0x009c42a6bc903eef, 0x004822c665a9647a, 0x00025be5289303fe, 0x00e578dacdf059cd,
+          0x003102b09ab20872, 0x00550c8eefe53796, 0x000067c3d49d83d3},
+         {0x00bfd069125aa06e, 0x00c4fdf8366ea6fe, 0x000eac36692ad23e, 0x009339dd73f77a0c,
+          0x0028202e84780a07, 0x00bb1f727f1ccd2d, 0x00007ebae722cac3}}
+    },
+    {
+        {{0x00b863bb1f336928, 0x008f28dae4edccdf, 0x0014f1095811a467, 0x008ba4a18e4460b5,
+          0x00f458ff220d6528, 0x00e572eb5c750215, 0x00007d1b47339420},
+         {0x00b340446f39d742, 0x00938da0f2b51956, 0x008f77f540929e2e, 0x0004211c4e732bf9,
+          0x007a6b850f6b57f6, 0x00b5c6106561e983, 0x0000f75eff066402}},
+        {{0x00a85c559b9a745d, 0x0025df37461e099b, 0x008e644ee4dc6f3b, 0x0098ad8bb25b3d97,
+          0x00fd63e520130342, 0x00d070a1e36e3e70, 0x00009fcb3db89b2b},
+         {0x004a2c419d7a2a95, 0x00917f6dbbacc161, 0x00872ca7f2b79b4a, 0x00e11c18ef90740b,
+          0x002169ee329f31c2, 0x00e46ca1cc97f877, 0x000005650e354aaf}},
+        {{0x007b2d372113db2e, 0x009701ddf07ba78e, 0x00a4db57e2e56393, 0x004e2751150b165a,
+          0x0074495279c6e816, 0x00cf032353d6852c, 0x0000b2e0301e32e9},
+         {0x0058e75e3edbb7c6, 0x006a03002405c103, 0x0067f72d2c8d4054, 0x00b796080253f417,
+          0x00c355e26f1c9c2b, 0x00caa18e933d342e, 0x0000eaa716a10b24}},
+        {{0x00c6620bdf08fb51, 0x008e4eaf2dff0a7b, 0x00cf919d29dd6018, 0x00dbe8d567d1be27,
+          0x000d241d8f5731b6, 0x003069a04de80ec6, 0x0000b7de6523f582},
+         {0x00c727dbc3f7c54e, 0x004fa724922ff1d1, 0x000acdabcf7d37dd, 0x00cd3d0048e90572,
+          0x006bbddf1d2b5767, 0x000a3b6d155ebd6e, 0x00009d1c06077b33}},
+        {{0x00fb96f782492ca8, 0x008ba8e791a2a487, 0x00dc33e505691d22, 0x001d46a895057c81,
+          0x00e8ea38e950d786, 0x0019be27bffc97f9, 0x00009754de31a8ef},
+         {0x0033ab08159ea2ed, 0x009f140195140928, 0x00cff6e28d6ae70d, 0x00650db1f7be42ed,
+          0x008d70feb40e0f05, 0x00e8dd07c94cd348, 0x0000196581eefddf}},
+        {{0x008fb25cffd7d0e9, 0x00b31e0d4be26ba9, 0x00cdb72435a3d65a, 0x003dfc36e5deee0f,
+          0x004fb12cd4484ea2, 0x00582004f6ddc250, 0x0000d9692b6aaa7d},
+         {0x00ffc72d10f304ab, 0x00e9848dd1ea6daa, 0x0006c630061eb179, 0x00adbe1d754b4147,
+          0x008ff454528193a0, 0x00c1f338752446df, 0x0000fae87c2e34f4}},
+        {{0x001233b77f828406, 0x00492f8a05d8b366, 0x001ef66fcf6f6c82, 0x00eb3493cdc3a4d2,
+          0x005b24efd4e8aa0c, 0x00353f7ac8cdaa0e, 0x000030c648873ddc},
+         {0x00cff5559fd7e6ed, 0x00b7de3302027d1d, 0x008bcbdcc7d4dd46, 0x008dc920aad897d7,
+          0x00cf4a8f1f6aac13, 0x0093f598fa181e18, 0x00008b4785f2ea7c}},
+        {{0x006b32b0a020cfaa, 0x0086e1086fbd7b39, 0x00438482debef3a9, 0x00e8f1df42845d33,
+          0x0006a669233ee413, 0x003925f8447c9ffd, 0x0000d862f30483d1},
+         {0x0098bb9f950d5d50, 0x0067c073e65f7ff1, 0x00aa446c1f26bdf6, 0x00abab017a454005,
+          0x0099f670dbd225ee, 0x00c6e8464973fc1a, 0x0000b40a1c1025a3}},
+        {{0x00a26c2362b4a5d8, 0x004ea621c257135e, 0x00ea1e732fd21f31, 0x0012ac2b8a3f98f1,
+          0x00d73c85bf65736d, 0x0009b932c1909962, 0x00006ca5e17d701c},
+         {0x008f0121fa02d7a3, 0x00934f4f718f9538, 0x007e83bb5da163e1, 0x00e11fbb7376333a,
+          0x007517f26b9cdd48, 0x003f878e9f9bd067, 0x0000cc8bdeb07f9e}},
+        {{0x002ff7e444a848b4, 0x006a3b66dd9b5d3f, 0x00d5c5c21018467d, 0x0068ff251b7a24d9,
+          0x00da00b76ef90ca0, 0x00cb1d93438a2540, 0x00009a66626f9152},
+         {0x00cc00af4670f1da, 0x00ea1eae1e90c865, 0x00faa3fb5813f2ed, 0x0047057b0b602016,
+          0x0062ca556598d125, 0x00d8bbbd65b108db, 0x00000f50556a34f9}},
+        {{0x0040315a0144aa2a, 0x00a2ed2694663f79, 0x000f83c890f59330, 0x003edac25c884a4c,
+          0x0054e4b019a3e4b1, 0x00e06ec9f8ecb057, 0x0000312e96e23f98},
+         {0x0053b1c875acec9c, 0x00327caffde24829, 0x00d4725da6e51d10, 0x002aa33b24827c27,
+          0x0089b318f524a7c9, 0x00fd717c0d466362, 0x00001440cfa1acef}},
+        {{0x00fe75827163a7da, 0x003afda38becccd5, 0x00dee95658078bc6, 0x00407869948c9802,
+          0x0098a7c0cdce193e, 0x00453be2ca1ec47e, 0x000013b9fea10fd7},
+         {0x00ef6f18b78f4d78, 0x00986100034db16e, 0x00bbfdc36765db1d, 0x009392a6dc13e50b,
+          0x00e93c970a16d4e0, 0x00e0a765a59c7d46, 0x000003a2d99021fb}},
+        {{0x0027df845e780b24, 0x002180465b1dd290, 0x0057db8b47b8f9ea, 0x00eb7f7e34f01231,
+          0x00710ed3dc95b9c6, 0x00037aa2e99558a4, 0x000011e42ec780cc},
+         {0x009cbbb15fa5a9a4, 0x00635dcfdb4490a8, 0x00dc1fbdc1cf686e, 0x0065bb35a14a3b9b,
+          0x00b43831e93bd4c1, 0x005711a4184a4d83, 0x0000f4a0ef75daee}},
+        {{0x00746b7853a85e8f, 0x002582b1118ba1d9, 0x008f4eceede7de8f, 0x00ae2c161de61c3c,
+          0x00ae1066ee49064c, 0x00c0d86e24eeff9e, 0x0000be83060fccd8},
+         {0x001bffb901214320, 0x002788e146d6d1fe, 0x003a26746ef0c1de, 0x002c46feeca43b22,
+          0x00bb8f18180cf94e, 0x00de85d117f608db, 0x00004f0836891e25}},
+        {{0x00906cbfc17a9509, 0x00f4c88aefc77000, 0x005c642e09947ee6, 0x001bc9b6bb6dd4ec,
+          0x003a3fe6b7dc4e10, 0x00e14979f9dc8159, 0x0000229e396cb05f},
+         {0x007eb4c0188c58df, 0x005cdd914188c997, 0x009699f5027e64a4, 0x001ca3edc32347cc,
+          0x004c6f06e4600e04, 0x007858a23266adb5, 0x0000f0b6d5c8746a}},
+        {{0x005e0f5d2805e596, 0x00a01d262810506f, 0x0053ee0d124b89bb, 0x00badc49fb712e12,
+          0x00f0c000d214b583, 0x00c3ef049f9294aa, 0x00004e5a9dfe6ac2},
+         {0x005622c691013e25, 0x00321bced6e71496, 0x003d0051e0574b8f, 0x007a5e5a25b5a060,
+          0x006b571281a2b658, 0x00f1717bdd7fa630, 0x0000526f1b07f6ac}}
+    },
+    {
+        {{0x000ccefc54a20f0f, 0x00d3e52d7a2bf58d, 0x00863d5128c3b74d, 0x00841447a2b84d53,
+          0x00f843b4b1c2a5bb, 0x009c018ac9a1edbc, 0x00006a985fe8c9e9},
+         {0x00f6bac890d636a3, 0x0037bd42fc437cbc, 0x00efc4212524e33f, 0x007fa12003bd3632,
+          0x003f23fe6aab161e, 0x00aefe2c4c094080, 0x0000d096128b418a}},
+        {{0x0021e632dd33f658, 0x00a642d079f1b893, 0x00799d544c01a355, 0x00f141b6aed40d2f,
+          0x00a2c0e1eeeca14a, 0x0046d11ece663e0a, 0x0000f5b63054672d},
+         {0x00856428492dab78, 0x0078f33e214c241a, 0x00c3e043f4d1b14f, 0x0054b820ba1ceb2c,
+          0x006847e7c0b478e1, 0x002ad9d31c047395, 0x0000d09b496715ad}},
+        {{0x00e8e84b3d59b9f8, 0x00e629948adcc211, 0x00d01e2e5fdef73d, 0x00f5a67c0ee8d665,
+          0x00e32c7d062f970d, 0x00d6e9597a4a520e, 0x00002188ee80b5ec},
+         {0x00e11252fdf8e7fc, 0x000451bdf94a5402, 0x0008b277862d7e6c, 0x0036b43cd8f701fe,
+          0x0094f7a53cd0325e, 0x00282735255057d2, 0x0000fca0578fdf27}},
+        {{0x00b76ad9aec56242, 0x000b07456a57ff54, 0x002aabcae1f2e903, 0x00ea31e4eef76b6b,
+          0x00936522f07b82b0, 0x007bf0b3adf2871d, 0x0000c34fdec3c9dd},
+         {0x001aecf94087efc9, 0x00048fb97aba7d4f, 0x00f8d9d0c760140d, 0x00bc24411fccb5fe,
+          0x009f346206a250a5, 0x009aff7ab935cb11, 0x0000cec34ed80803}},
+        {{0x0049437ecbd8de9e, 0x00778b2333de4412, 0x0097ca379fe4f566, 0x006d21d63383966a,
+          0x00f6bfb4890c6429, 0x00f98f5833153d35, 0x0000aa0e5a489caf},
+         {0x0035f735e66cca1a, 0x0058ce541f56cd75, 0x00eb6c0f3afb88ef, 0x0068e3c0516096dd,
+          0x006fce549b54716d, 0x006ab9590636c180, 0x00003985391f337e}},
+        {{0x0069332ae071e86b, 0x004150f2a8bdc91d, 0x00c38ae0bc59efd0, 0x005dfc6eae1994bb,
+          0x00dbab2aa0c8d885, 0x00a8a13b8efb8cb0, 0x0000199b9a370cd0},
+         {0x00dbe90d6216e20d, 0x001d0d4a840fd6dc, 0x003408a054bdf893, 0x00acd34d05f7e780,
+          0x00f512b6f17dfaef, 0x000b68044b105d11, 0x00008bffc03e3627}},
+        {{0x001c2eedfe0b214b, 0x0085a6e04dc13fad, 0x003361fbbb9800f6, 0x0071bc05343f0543,
+          0x00aa0bb83cfabd0d, 0x00a1061e548359a9, 0x00001bd6995c8ee5},
+         {0x00c616170ed1175a, 0x00cebcdb6e2d02ab, 0x00489a2e24aeccc4, 0x00d59a13af52397f,
+          0x005c5f89588f2a05, 0x00989151f28caef9, 0x0000469794d0678b}},
+        {{0x0006311837d6c1b7, 0x00a0eff99591e826, 0x00b96ada20646176, 0x003eba33088c6750,
+          0x001335edf5035e9a, 0x008f4522046f0492, 0x00004f769c490650},
+         {0x00de2f072c18581e, 0x00a41344b0f2e19b, 0x00a6ca599ce5a8a4, 0x008c756857efbec9,
+          0x00e2eda5994d283d, 0x0088cb4193702968, 0x00007e35d1028499}},
+        {{0x0041b75daf14e3d0, 0x00a92f199c05273e, 0x001f1fa549b8f9c7, 0x00d036161768090d,
+          0x002c27ee93502d42, 0x0095309a9c067023, 0x0000db2ef833b017},
+         {0x00a31d737a914b15, 0x00427f231d9f617b, 0x00e2f6e79cd60e78, 0x00acf2c07fdee2ff,
+          0x003e319f57b4dcb2, 0x003f66b9314e0bc6, 0x0000d3f217b10e64}},
+        {{0x0071b756a52968c5, 0x005902817f0dd1f0, 0x00bcbcf31f215117, 0x006c64689db69fff,
+          0x00d9122ae7f868e1, 0x004f6662fb6fbd1e, 0x000004366b61f858},
+         {0x00457e8c921647b4, 0x00acb3f9011722b9, 0x0036ae88690daadd, 0x0076088e1c18ddf5,
+          0x001f69986c84db5c, 0x00a59ff95c8ea705, 0x0000916c70ecaaee}},
+        {{0x00be33a015d04ed4, 0x007206cf2bacbb01, 0x001d8f649da512e3, 0x00f741e3fc1f5b11,
+          0x0080e1ddfb1940e7, 0x001e06bbfec7f782, 0x0000ac11472d59f8},
+         {0x00794bdc45dead3a, 0x0088be1ea66c45d4, 0x00d9e7e0aee8e906, 0x00edc6d9d0fe96ee,
+          0x0028e9f655d7aa60, 0x00567ba27a8ff8bf, 0x0000668c08602c2f}},
+        {{0x002b928caab937d6, 0x00c73e3f156e428f, 0x00e38dc4e7637b86, 0x002c1615be5aac61,
+          0x0061f0266d3ae687, 0x00577243d8636b0a, 0x000094357c1136bc},
+         {0x00c1a3e37622db97, 0x00567a0051a5e9fe, 0x002117bf0f2d2f9f, 0x005983b7cc2acc24,
+          0x002ebd23cb0eee72, 0x008182b351142eff, 0x00001419eae2b6e1}},
+        {{0x00b4016cf248b4ff, 0x0053e60ebd218dec, 0x008a0caa4e93fe04, 0x00922194ee65282b,
+          0x00d3a74e6bca59e7, 0x00dcd9a2d9c9d90c, 0x0000213dba608436},
+         {0x00297abfad436e24, 0x0067b51d8d4f0edc, 0x0030dff88271b3ed, 0x001d642eb43a93a6,
+          0x00bda8d79353920b, 0x0082688f835714d4, 0x00005e0940851180}},
+        {{0x00411397f49bc7aa, 0x0035c42b58388225, 0x0032c3e8299a2e37, 0x004680688ab1155a,
+          0x0035a917914d5680, 0x009373e7f421d3e3, 0x000029bcca6e42db},
+         {0x00d81cb99751cbcf, 0x0089eb0fc4517a5d, 0x00babe958bed7e11, 0x00c14ca38aa34f3f,
+          0x00d1c8d1aecf9342, 0x00a87ac4a035ee95, 0x00009b89915c763f}},
+        {{0x005e705c22bf04a8, 0x00c175facfbe3e09, 0x000ae938e3d381f0, 0x00dac69efb434be4,
+          0x008413e38f5e4b01, 0x00ee41861544ac14, 0x000011b90495271e},
+         {0x0024891c6ea56050, 0x00661b406b23b704, 0x005357aba93a6683, 0x00f9e1524fbafbc3,
+          0x00b62de20c558829, 0x0072d16dde12f5e0, 0x0000d4a7862dd575}},
+        {{0x00ac844143734351, 0x00c391cae56ff006, 0x003a911efea2d61f, 0x0006ff3cdc91a0ed,
+          0x0068b90d1d696dd7, 0x007e33c614c051df, 0x0000a9fb189da2cf},
+         {0x0088260d077e997f, 0x00a6fa391d082b27, 0x003d2fa7c0ed7c46, 0x003dc853bd1f1106,
+          0x001c7981a6ae0f6e, 0x003e84db567865b1, 0x0000b40137680eae}}
+    },
+    {
+        {{0x00cf38d35eb41c96, 0x005f37a2c2db95e5, 0x00da887de31994dd, 0x00ad5347e5446ebd,
+          0x00086dbf6c0b16d6, 0x005408a2e399bfb2, 0x0000b43c75ac4a2a},
+         {0x0077f19c5193ba70, 0x00aa20cba4a00224, 0x00fbc104d7ed977e, 0x00d5880cc0709394,
+          0x00336d32de6d2955, 0x0050a2d6f7111fb9, 0x0000f5c20bfbf799}},
+        {{0x0067dc19d95bb177, 0x00de6d64902f762a, 0x008959ce059dd723, 0x00e93b5ac1baad7a,
+          0x002a750f5d6adc50, 0x0035e04db7768b23, 0x00008d9d22cf70dc},
+         {0x00f78c1fd7d44f0a, 0x00a13bf7a7865e44, 0x004c9f5b607cbf31, 0x00367df9bd90632d,
+          0x00d4651973212db3, 0x00aeceb0dbe352c9, 0x00004c25e003d207}},
+        {{0x00accd8d168d726e, 0x0002f2e9dbbc4486, 0x0060ffc57869142c, 0x00875b0281245fd0,
+          0x002bbd39e1ca172c, 0x006278ddb3bb5141, 0x0000eeee3992c8ee},
+         {0x008fb896036d10a0, 0x00f88eff7fb2e188, 0x00f5fcdb8ebb12de, 0x00c762c948a0b545,
+          0x00d1ee75a3bb64c5, 0x00fb3c091d0b880e, 0x0000ae2247a66493}},
+        {{0x006fba639a0b4196, 0x00a582b4a737ec68, 0x009b25efe64307b4, 0x005e188d49653067,
+          0x0036e3794df54bca, 0x0042508c78145d09, 0x00008b31d35358d4},
+         {0x00830d04dbf1b2b6, 0x00b87afe9f287758, 0x00d92da9ca1e257c, 0x00663ee951c37b19,
+          0x0022ee03c0414185, 0x00fe251c8c3fcf7f, 0x0000bc3a4e5b6e84}},
+        {{0x0046bc4724117d51, 0x0046770506d1391b, 0x00f7f3a32eafc544, 0x001664bcb4d83c9f,
+          0x0063b1b9541d330e, 0x00256c59d0c5adc4, 0x00009a0a39309cce},
+         {0x0001f584153a7daf, 0x00e898e47ccea2ea, 0x0075fbae020ee3d9, 0x00e41078c4859d98,
+          0x005be6e5c87b0520, 0x0061ccc6afda8596, 0x00004555601060b4}},
+        {{0x003d825a10e59613, 0x00fb1c643c25f9df, 0x007f575ba0b74726, 0x0095ab3ac9af215a,
+          0x005b34ad0059e645, 0x00056834303c157e, 0x00000a89755ba6d6},
+         {0x00f5535d4ed73ee7, 0x006f0bd6253bd18e, 0x0057e3543e5ba777, 0x0001911b8cbfe11d,
+          0x0089c725f160ffe6, 0x005fa42b76ccb13f, 0x0000d176d1e91002}},
+        {{0x0001ad81e32c0534, 0x00a80a952d9a6f6b, 0x004542b52018f8ed, 0x00b6e608e8f2485d,
+          0x00ee9d478dea8789, 0x007b3a0f4fe98d81, 0x00003c81a556f9a5},
+         {0x00d646e5acd6d3cb, 0x00cafdfe3507ead8, 0x00ac0d67174a15d9, 0x00fbc37b1eb24343,
+          0x00581eb76dc863c2, 0x000c5b415a051ee3, 0x0000ad10e4f84260}},
+        {{0x0035e2c3eb25d058, 0x0040014bacc6d2cc, 0x003e995a805a440e, 0x00282aeea3dedb82,
+          0x007e5b1b81eca3f4, 0x001693f6b18346d0, 0x0000510537a023b4},
+         {0x00cd50e6d01ee86f, 0x002ee35604c7573b, 0x0018b9d48bbf355d, 0x00ebf3c2f239701d,
+          0x009ce9d436b5da58, 0x005fcf171d582ca4, 0x00003a724ff26a01}},
+        {{0x00e08d448485cd74, 0x007563e5aa6e3803, 0x00da80a9d8260259, 0x0047efad892997d0,
+          0x00a45c858918e88f, 0x0087f87dc129f6a0, 0x0000e7a67866bf07},
+         {0x00108c108b3beca7, 0x00bee39895805354, 0x00bcf50bb00812db, 0x00077940f9fe09b2,
+          0x00f4f7b7d0d36a3d, 0x00877a9462e89b67, 0x00001c595cdd8688}},
+        {{0x00eed924f991540c, 0x00a3017d85841a32, 0x0010af23f0ae2e87, 0x00ca8ac9fc56ab1c,
+          0x00297b17244ef5af, 0x0095d7e28e4d9ef9, 0x00003ab85608b07f},
+         {0x00afa5fb01a1ae71, 0x00a892a9f58f31d9, 0x008e0e05a45b28e4, 0x00efd2f2dbfa00bd,
+          0x00013bd001663528, 0x000e6629e7439404, 0x0000e1f7ea007576}},
+        {{0x001815059b313b65, 0x007edf755f1308c9, 0x0040b3f2a1cb84e0, 0x00ffec3ecec15da6,
+          0x00030205722272c8, 0x0098ed52b79fc994, 0x00008d79cb749063},
+         {0x0085533e25c13ced, 0x00cd06b0e05b4e6c, 0x00761bb53da8f175, 0x000369761bb2d91d,
+          0x005519e8b0b4bf9d, 0x0051dfbc0eeb73a2, 0x00008bee6c1e72a5}},
+        {{0x005acd17d3f2b701, 0x00f61d6283d86993, 0x009ad09b261ca882, 0x00322997e0e85c9b,
+          0x002130064dfa5539, 0x0024562a757ca18b, 0x0000f9d54df22a5b},
+         {0x00dc316c363173e0, 0x000bde20166b444e, 0x006f627b7137d640, 0x008ef453ab2cccb0,
+          0x001eace2f801ab6b, 0x00beabff4c8c9afb, 0x00004d0db837f936}},
+        {{0x008d67904efef27d, 0x00eb2bf512142551, 0x0061d83a703e782b, 0x000ebd8e3af27042,
+          0x00d424a6f5f57988, 0x0097527fcbd6747a, 0x000045bae64cb2f8},
+         {0x0099601a9bb67ace, 0x00bf8bafacbad513, 0x00e85194db086b07, 0x004fe5725090993e,
+          0x0045c3b4d48650b3, 0x00c3abbc70169e76, 0x000086d27d970fa8}},
+        {{0x00482269c51b750a, 0x005f88b428e0097c, 0x00b9d89696b4df81, 0x00ca8635f0faca2d,
+          0x00aca829c376fd60, 0x00a3c962aa8877a2, 0x00007fc6ae84778a},
+         {0x000fa88bfed8ee38, 0x0074271779287f95, 0x00a1ec24d8aaea63, 0x000cce47dfc76736,
+          0x00201924eb10a78c, 0x006f3bb1570e9f93, 0x000065137a824a7a}},
+        {{0x007dd2608356a7c0, 0x00449c33d5b3e6a4, 0x00d4495982361c97, 0x00952c6412524b8b,
+          0x007e49bb656078a4, 0x004ee4068ef19833, 0x0000015a57852f3e},
+         {0x00a06d786e4f4d27, 0x007984f6d6ed64f2, 0x003982aae7c82cec, 0x001d929c9050ba69,
+          0x00c8f3eee233cf59, 0x00fd768054300841, 0x00003517716c79c0}},
+        {{0x0090b021e0bde8c2, 0x008a6cca52b096d4, 0x00fdc30bd6596cc2, 0x0050feaf12cf1df4,
+          0x0052c6e50e63f460, 0x008fa1cd958f857f, 0x00002913d4eb34cb},
+         {0x00f987e9b083dcb0, 0x00863ab1a874d8cb, 0x002eb3bb7da7b47f, 0x007603fd5f2d4872,
+          0x0065a13227855d53, 0x00ffb1a5cce5a077, 0x0000047b885f5a14}}
+    },
+    {
+        {{0x009bbe27e8ff36f4, 0x0095c57bb0f92df7, 0x00df2b512ea5c209, 0x008d5195a33a6c52,
+          0x00b914c458112846, 0x00468cb55e14b747, 0x00002d4c684184e4},
+         {0x0048ce283cb77354, 0x00ee22c2b2ab26cd, 0x009d65ef7ef29561, 0x002e34bf6e9757e8,
+          0x00d6995cec47485c, 0x001e7397d2172bc1, 0x0000300fc5196046}},
+        {{0x00163d1791f22d45, 0x00b796c56e955898, 0x00756d0f4d11db56, 0x00d2000d9184d529,
+          0x00e160280e7c0d8f, 0x00825fdd83eadfe0, 0x0000d15fdfb4eccf},
+         {0x003b44e192b01ea6, 0x00770c01ae050c18, 0x003dd705d8807414, 0x00faa8f031f339b5,
+          0x00ab7f33ab2344eb, 0x005c3404ae4be665, 0x00001bbea6c38ab9}},
+        {{0x00e5efbb18bf6233, 0x0057b5e71915a3a5, 0x00fca5f13aa26367, 0x006cfb6930812340,
+          0x004d75d59dff65ea, 0x00c585aa47d2b5f8, 0x0000f1aa52d15a45},
+         {0x00ed5ce451d5ac03, 0x003c23f174074ab8, 0x00a8c28cb81718a6, 0x0022b252c1ed9297,
+          0x00f555b8b8c2ac7e, 0x00bb72c6de9b43c7, 0x00001414d02d00c5}},
+        {{0x00b769081ff4ed6a, 0x00c68a600c30c14e, 0x00b58114ac3ed5da, 0x000f0d85ffcab4de,
+          0x0035f7fe2728cd9e, 0x00a23064b758895b, 0x00009180059b49c3},
+         {0x0029d6f31a8b4fdc, 0x006083d6ea74b743, 0x00b25719762a36d5, 0x00138a1bbb690622,
+          0x001795c4f9f8a1dd, 0x003fc58563021d61, 0x000064c8f91cb420}},
+        {{0x0049801f3052a95e, 0x00ccdadb7bc43a32, 0x00dbec17fed42be6, 0x00359f5cf74c7cc7,
+          0x00bb56658fb57bf1, 0x00c621eafe13b145, 0x000097af413a6030},
+         {0x00d9101dab5bd6bb, 0x00b8fe7f99549299, 0x00cbfc52d0be1b00, 0x00c523d5f1b1f351,
+          0x001075de95229094, 0x00266c81bbbb1f8d, 0x00001227012b60a3}},
+        {{0x00e807ab780ed78b, 0x00dd5b128781334d, 0x00b45cd8dc93d414, 0x00772dde6271b4e2,
+          0x007f84e81f495235, 0x0075f2a1ae293b9f, 0x00007b57cb810a55},
+         {0x001f55d20f3b69d2, 0x00bf9ac0586cfb49, 0x0029d6b5edb481b9, 0x006f1493e632104a,
+          0x00818fc2815e4871, 0x005d82d252d39957, 0x0000a925aaa7cdca}},
+        {{0x00d93f9483a9d3c4, 0x002cba21edb54dcd, 0x00cdb40e1f5380a1, 0x006c4c8436c0626c,
+          0x00482472b9cb970c, 0x00467831dc937d8d, 0x0000b45bf88bb329},
+         {0x00937ce384f76ddf, 0x00b0ed905586ed13, 0x002b8cfb06e2eed7, 0x00dc5316123c092e,
+          0x00535a8e384b965e, 0x0083243011d17746, 0x0000a139ce79c6cd}},
+        {{0x004679e12769e49e, 0x00b6983ab51d9aea, 0x00412735dbe9b0e2, 0x007db698342cef98,
+          0x002d880aca809014, 0x00e29caebcdffe19, 0x0000d258b387dcfe},
+         {0x00f299951441ea63, 0x00c62b41c30fbe6a, 0x00f41b4d0513577c, 0x008eac39b6d6fb23,
+          0x00ce916e2cbc7c93, 0x008ada3132ba57e2, 0x0000c1b6f8ca0935}},
+        {{0x0099878587a49761, 0x0022f903cdd2b7ca, 0x008d31e1fa8027b6, 0x00c8cd6b95ef934e,
+          0x00996b4b5af70558, 0x00d2d9982820e6d8, 0x0000e6d4ee1eaf0c},
+         {0x00fd6b04686984e7, 0x00bc3c30abb317a9, 0x004d0403cd3ea550, 0x00f4d10d6cddad81,
+          0x004958aa901fef30, 0x008ccfae382a5231, 0x000044ac9a0c44f5}},
+        {{0x007f3c75d0a580e6, 0x009f4c2efd045353, 0x00fc7a8b4da075bd, 0x00b8e7d43dcb9275,
+          0x0017991a19c43099, 0x003b73051fdea02b, 0x00002050e090b0c0},
+         {0x0008b093585eb6a7, 0x003f55f55e25de91, 0x001c0dc5907730be, 0x0046f07e5819e1d7,
+          0x0048365577180b50, 0x001652e700ae2376, 0x000059daa1c44156}},
+        {{0x003abfd3e9a97c94, 0x0029d41c80899d93, 0x0036d7e79f6ae496, 0x00659b28c1fc69db,
+          0x00ea886ea7d44d1c, 0x00178959c36a1a62, 0x0000a98f3bc7fb90},
+         {0x0082277aeaf3ceae, 0x00e22b4fb3a08410, 0x00b7bce3b09c67d7, 0x007fb61588b0e8ef,
+          0x00fdb72610d4aa07, 0x0041845e07fb9901, 0x0000ca112374fbba}},
+        {{0x002be8ccf8365946, 0x001260e295a1e523, 0x004a406491065fbd, 0x006bdf29fc27a70d,
+          0x007d540cb9e7ab88, 0x00f489b465780d14, 0x0000603a625826d7},
+         {0x00a2ee00c7977a95, 0x001290aa815a1e4f, 0x00555e3ae885c527, 0x00d08df19cd2c951,
+          0x008fcd886aa3fb33, 0x003aeac2f6544c9f, 0x00009a39b455220b}},
+        {{0x00e1c02edaad79c4, 0x0063d5bc851c9238, 0x0078d139159f79c3, 0x00a5bb13ad99be05,
+          0x00ebebf8d095249e, 0x00d4b257a68e2579, 0x0000923492485105},
+         {0x0082cc2ce4b61113, 0x002395489efefb1d, 0x00cad1ba73f21af1, 0x0003591cbffcd1db,
+          0x00a385b09a3de00f, 0x0042f0dc2c1ae7af, 0x00002ff86b7521da}},
+        {{0x005067992320c34f, 0x0042073582ca0807, 0x00921a8ff087bb0f, 0x00886a9c450df143,
+          0x00db52c35814c758, 0x004518d7aa5a423f, 0x0000b541328c7ce8},
+         {0x008596b2a242e8c3, 0x008c95fb92e2eba3, 0x00ec6c922f94551b, 0x00c24e6f510b6021,
+          0x00ea2ab33ecf5b0b, 0x00d4c6aee4ab8715, 0x00002fe7c7f4b390}},
+        {{0x0008df910d9e233a, 0x0079189b2146d1b5, 0x00787bf6930cf509, 0x00e47fe13cbb2ed4,
+          0x00c9ff4630594027, 0x0017bab2f3fd5720, 0x0000239e2f082e31},
+         {0x00cbf71f2988ff97, 0x00a71234bbb5be2b, 0x009e85ec92a464c2, 0x0049389483fdfbe9,
+          0x0067096987fbc70f, 0x0069c52adba3357a, 0x0000ab5653e2b37c}},
+        {{0x00111e4db8c212b5, 0x00a469784b52db8e, 0x0016eb31546cb8aa, 0x0075036d689d3414,
+          0x00a271ff6c254c18, 0x00899398859b5818, 0x00000a5f6ed9ca33},
+         {0x0098b2d4a9787a22, 0x00cede6430001e38, 0x008e7ec773388306, 0x007aee362fceeeb2,
+          0x000fd7e361337ebb, 0x006ae1794b8bbc73, 0x000034be3813bfc9}}
+    },
+    {
+        {{0x0068960c8456b4da, 0x00f0d367fec6ab85, 0x009b9caf93b8511a, 0x0077d8d02f054cd7,
+          0x006e6f593d84e21e, 0x008ddd5f9507f084, 0x0000778bfe301d79},
+         {0x0097a16b1b8935ff, 0x00c5befa735802fe, 0x0002f76431b9fca8, 0x0072f26ec8f7f6ea,
+          0x00c658a737869c2f, 0x009e76150686bf1e, 0x0000be41e479a3ae}},
+        {{0x001d749ab35d9cb0, 0x003434a4d2d912e1, 0x00d0bb2c1dd2bd4e, 0x004f885d0a68f09d,
+          0x00b8935f0de09509, 0x00e34847ab3fcb86, 0x00001a6c7b487d6c},
+         {0x0046f0db7c8b9563, 0x005c5fbdf0bb5bc7, 0x0087733018a124f7, 0x00f7ff304e243d3e,
+          0x007bf6c0965c63b9, 0x008a6d1e18efb283, 0x0000c9819b4102ee}},
+        {{0x002b090e377434d0, 0x00c163f1bd60f013, 0x00bf08dd6be22f07, 0x00d9ac5119dff3a5,
+          0x00a86e5f2e21f4b5, 0x007f67696350f3d4, 0x00000dd522a7e9d3},
+         {0x0052021152e2b852, 0x0019122ce2a87f36, 0x00e9445c677c56e9, 0x0095742d5907e96d,
+          0x0093bab1d34cd591, 0x0063d5ffeebd3e6d, 0x0000917bf9c81637}},
+        {{0x002f0e767c870844, 0x002e62719e667a1b, 0x0053357d89ded478, 0x0009dd7f4e49f9bc,
+          0x00afc6ef639eb2df, 0x008f0ce47fa2f83d, 0x00008130cb0670c3},
+         {0x0077ce1dce216187, 0x00ea30386d4a29ee, 0x00f42ad2c0da3427, 0x00c700734b9dd758,
+          0x00cede3ceed95e0d, 0x004a4709308d74a8, 0x0000dfeab4b877ae}},
+        {{0x0066eda1a8701430, 0x0005b5e696f6396a, 0x00c36e9dce47ee42, 0x004ce0880c8b5895,
+          0x0053f347a206fba3, 0x00bd15607d942bc6, 0x000042dff0f76f44},
+         {0x0064be28dec93846, 0x008b4c86e36b3ebf, 0x00436a7c173175fd, 0x00dd8efd68019324,
+          0x005f203788c40fe3, 0x00be5d2ab7692e7f, 0x00003ac4d3d03758}},
+        {{0x00165ffe3987fbe1, 0x00bb96fe4007905f, 0x004ba7a22d0bc270, 0x00e9cad8390d64b8,
+          0x00a4c985eab938ac, 0x006e61bbe46e1437, 0x000034ee5d81e45b},
+         {0x008bd8853cd62690, 0x004fe68c6201e530, 0x003ab638a3025ddc, 0x004a8b85d75d103d,
+          0x006591eee9546467, 0x0075aa388d76b5b1, 0x0000ca4744208c91}},
+        {{0x005665ce1814feed, 0x00c4a25e43c9bfd1, 0x000eb757cff921e9, 0x00785d00082f4df0,
+          0x007b5428f81509ee, 0x0054c6fe819ce282, 0x0000d283ab71366e},
+         {0x00ecd5a16df187db, 0x00b2b2038d954288, 0x00f5dcfa71ea1fe6, 0x00c37928204324bb,
+          0x0039bedb23bf513b, 0x0073f42a739543a3, 0x00000b3ef0f6f9c1}},
+        {{0x006676061945d3a3, 0x00e648ccafec1242, 0x00379ee18a52bc41, 0x006180671ae4a78e,
+          0x00e5d7fe2c21fa2f, 0x00b7010778cd4ba3, 0x00007883978dbcc5},
+         {0x00b636aaeb860245, 0x00b2bcf048e8f19e, 0x00b0f90bd433eb92, 0x0076f5dac1dfcb26,
+          0x00b87b311c80050a, 0x00e6c0e1a439508a, 0x0000d980153eac47}},
+        {{0x007cc5849b0ab534, 0x002d57ba3ad38d09, 0x005860a65383584a, 0x0070b5d1b278499a,
+          0x00d81ddefd26a814, 0x0058a0aae59d1c63, 0x00002eca959b836c},
+         {0x009b972c146428a4, 0x00d5430fd856d79d, 0x00c34fcf13422e4b, 0x007b31cba4dec879,
+          0x008f1dea903c56fe, 0x007d56bce18cf7fe, 0x000019eecce24064}},
+        {{0x009bfb64a60c3444, 0x00e795fd01aeeffa, 0x00faa61a58334e67, 0x00ed770c63a72acc,
+          0x0078da139c5dfcb6, 0x000b950723882e5b, 0x00008e6a0f3c06b7},
+         {0x0023358c0060b60c, 0x001a38edd8c67cbd, 0x00f48ba559193cb8, 0x001bc1cccf9fa30b,
+          0x006d2f1161a4d34b, 0x0067cbb04f79b908, 0x000068d1d8abc00c}},
+        {{0x00bbd655e9a33bbf, 0x00ec2ec67ca8217f, 0x00dafcbd168397af, 0x0050cb5844da632b,
+          0x00d6569a3816832a, 0x009051bd9e48cec5, 0x00007f4ce0d5b15d},
+         {0x00fa726d3ba26de3, 0x00ead2069b6d3a6a, 0x00f610d9429a041f, 0x00eb6774392995f8,
+          0x0084201824d30c1a, 0x000f4c41b507e6a4, 0x0000dd7be5b640f1}},
+        {{0x00709d549d272336, 0x00c968912e90ff28, 0x008bdf450cb67e1d, 0x009f2587b350f520,
+          0x008dbbd58f7aaf46, 0x00028acaebfb8374, 0x0000ac7246504b9d},
+         {0x00354b34b88f5181, 0x0064a4b99cd1fa42, 0x00ec72b36f017865, 0x003550a8848791a1,
+          0x00aebca0317ce247, 0x00345dffcae6a1ed, 0x000042bfefe88e95}},
+        {{0x00a3daa2f20142e2, 0x003f963f7155b14f, 0x00de335c814d31ea, 0x00184df78d48d792,
+          0x0012c205084a014b, 0x00604de45e91637a, 0x0000381cef2de42b},
+         {0x00f3e606d3e193d2, 0x00e1ecd6f30973c7, 0x0073adedfafd95cd, 0x0040f75dcdc401ad,
+          0x00d11127a7ee8ff2, 0x00326db9bb1209db, 0x000000ce7a04df49}},
+        {{0x00df5a605f518047, 0x00f1fc93cc57de45, 0x00c6cb2216ce3001, 0x003980b05fd5b39d,
+          0x0013bcffa1765fa1, 0x007fe999ab012b64, 0x0000773383f22fe7},
+         {0x006d7c1ac876efa1, 0x00596c4e839929ed, 0x00dd9389ed06aacb, 0x005dc7864feb1b2a,
+          0x00d16e238ca0b039, 0x004421ca0ce6164b, 0x000011c01edf01ab}},
+        {{0x00ce89b6f590ffc9, 0x0054bb3d3c786086, 0x00e067b9b394db62, 0x00088bcdfc03ec20,
+          0x005f7059db1d3d5c, 0x0099bf86f8a8bf89, 0x000029873215eab0},
+         {0x004c7c11720cbb17, 0x0014f90f09bca9ef, 0x002fd302aa818ced, 0x00b8bb9ce519cb63,
+          0x00885a8dbf2c67d4, 0x006e990ace40b24e, 0x0000185109e5e8af}},
+        {{0x00a293664ec91657, 0x00aa8709dd1ca27a, 0x00138172145c59bb, 0x00f2ddd3e9a02d41,
+          0x0007fdddb56aa4a4, 0x00a1b0356556fe9d, 0x0000137d087286fe},
+         {0x00e9a2862f711ecf, 0x00df0ec2472c1542, 0x000d41df85f80db3, 0x006e41c686128311,
+          0x00041a11b603544f, 0x00e29e732f05a054, 0x00009586a28c7820}}
+    },
+    {
+        {{0x00f28c58b94a0f6d, 0x002c69de2b078130, 0x00a51a59cee5200f, 0x004193edc885d944,
+          0x007902be19d55ab1, 0x00514e360df99eac, 0x000034bcf4a54976},
+         {0x00ed1ee12816db1c, 0x00f5aaabe870eb23, 0x003cb212bc08eac6, 0x004e46457358e25e,
+          0x001928fd08ef486d, 0x00d90759ed7d6d0f, 0x0000dfb3611a728a}},
+        {{0x008591e28b8dc355, 0x0077eb604e898253, 0x007d44adce518cf8, 0x00a2da6c4eb71902,
+          0x0095f801b237ffef, 0x009acfdf18833315, 0x0000cbbbea79c10d},
+         {0x0065af04f162e2e1, 0x00cff574ded5d731, 0x00d1d40cb68a9e94, 0x00cc47a6073a358f,
+          0x00f6b5cc65a666e8, 0x00c05d39a90d6ca0, 0x000075ae8b340719}},
+        {{0x0085cf8548974c42, 0x004f56a3bc83ac02, 0x00889af2654beed7, 0x001a79ae06f3b135,
+          0x0054754d10f174af, 0x00494599428c4c95, 0x000022f30f9a760d},
+         {0x00d479483b61a280, 0x003ef8266d5a0a0d, 0x005d7fb097046922, 0x00c62849fffbe787,
+          0x0082fa3eb730ed5b, 0x00bace5630593f29, 0x0000dbe912389c48}},
+        {{0x006e50fb5f6be87c, 0x00538a270a79dc8d, 0x00a8a0ca4ea953f1, 0x003a22af64c9a148,
+          0x00a612df6641b769, 0x008b3f7edac629c4, 0x000093412af8d3f8},
+         {0x0041c63225fc216b, 0x000eda4a35dcadec, 0x0050391b1f9f4ca4, 0x0039fc6fb93f79d2,
+          0x005d435dd2cc1d4e, 0x005d01a34f79729b, 0x0000a5ad027d4e75}},
+        {{0x0091fa6f334995aa, 0x000fb1bb8060095a, 0x008632ee884bbe77, 0x00c0a04af217ea61,
+          0x00ceaf48697358c5, 0x0082783336f42305, 0x00002be81d4376a6},
+         {0x002d45cb2c2f0130, 0x0079528b89a35373, 0x00dfc50a48a3ae30, 0x00d93bf500b28188,
+          0x00abea26344880bc, 0x00f88c21604927d9, 0x00001906e6d5901a}},
+        {{0x009199ee3cb92137, 0x000547dc9c054750, 0x005268d28e899c2d, 0x005bb499271db849,
+          0x00acc6ae0a153c28, 0x0057d9d3fe393823, 0x00006804d6af8690},
+         {0x00f75ec35ec45eb6, 0x00b4a8df9275859e, 0x0091a435ac1261d2, 0x003cec15232c56f6,
+          0x0056cbd3e60f0348, 0x002120fe0bf11f5e, 0x00002ee8ef5a3e97}},
+        {{0x00a693e2e196e97b, 0x00a291277477ba71, 0x005e50447378543f, 0x0084a3a1c39b360d,
+          0x0078e54539ff261c, 0x00668a4eeee811d5, 0x000017eb2e17d384},
+         {0x005684272dff0072, 0x00aab5fb5a4ea3ba, 0x002ef91aaa00eef8, 0x009c2355fa49960e,
+          0x00ab59be81598620, 0x0080ebeb90a09885, 0x00004876e541e25a}},
+        {{0x0022f743057a5682, 0x00cf2c51f721aedb, 0x004cc951c5d9212d, 0x00182a49cc66b627,
+          0x00d6582cc05cfe04, 0x005f3cb031da3eff, 0x0000b3d99da97ebd},
+         {0x007e446d7a3d1084, 0x00cb72c720a95e4d, 0x00ca96fb58228d37, 0x006301c209f411e7,
+          0x00203595f5bee88d, 0x00d1d35337672bf5, 0x000075b71e1bd554}},
+        {{0x00978e0a27005f0b, 0x00af30c20ed75e94, 0x00edf08c4d4a9f13, 0x006835e5553050a1,
+          0x0033e36adb63334c, 0x00acc1925bbd9f1b, 0x000094baa8e2d1a5},
+         {0x0055c0744cf26980, 0x00cae40ac06da751, 0x00d0682e413df029, 0x00818d5c4d4cc9b7,
+          0x004565f81ae1e9fc, 0x00fcb90176140204, 0x0000d96c786478a6}},
+        {{0x0089b96e18c214f8, 0x005d41b2accd3692, 0x009dcd9f405023e5, 0x003f00963db11fb1,
+          0x001073ae23c6bb98, 0x007892449194b9a5, 0x00005e96bd2ba058},
+         {0x00bfcaeb6ea9b9f0, 0x00a3de2cc054fd0c, 0x00bb32237a504bbb, 0x00abe3cf6db659f6,
+          0x0078ea76c21d5395, 0x006b1ab26942902c, 0x00005935c77fbd6e}},
+        {{0x00c91b23fa138490, 0x004c6c22f9b50412, 0x0048e84c4b5f0092, 0x0020ae4d717b7722,
+          0x00cfa95b340c4e8f, 0x003134531d4bf4fc, 0x0000879169e00103},
+         {0x002516526a13503d, 0x00caf0b56c6ae561, 0x00af8247d6d5c066, 0x00f12d328490c3f7,
+          0x00c5ede862c563d5, 0x00728860f571af96, 0x000055435f776a1c}},
+        {{0x006b8be12dfc29b4, 0x00ef4fe4e8b7d2f7, 0x001c64dd8c251677, 0x0059080974ae403a,
+          0x00b1f2a82015d7b9, 0x002da13b5b3e3faf, 0x00007ea8ff819f4c},
+         {0x00c3aed43673f12a, 0x0033a25e8d2e4dd9, 0x00f1ac0d0f8fd71a, 0x004923d058ba6349,
+          0x00beda3b18b71588, 0x0035553e03155884, 0x0000890d818e9a65}},
+        {{0x00efbd2d533d29b6, 0x009177d7f0013847, 0x00e40a3c887f557a, 0x00218658eb01daab,
+          0x003cb5e0c2a8fb04, 0x00c6a7e8bb749a5e, 0x000056466726b5e2},
+         {0x00aa801e536161af, 0x0015e0790e0f7b80, 0x00ab0a3ddcb42556, 0x001a5cb72cba6a37,
+          0x00ae51f4820f89ac, 0x005003f2f7731e2c, 0x000053ec9f4c1324}},
+        {{0x00db18532df16db4, 0x00612d597dfc2860, 0x00cdacf8b9e1819d, 0x00b39e7256490016,
+          0x003bb5c8e9acd6bf, 0x00c34a4a48acfb45, 0x000056b6d5956622},
+         {0x00530de1e75df5ff, 0x0031e5cd2eacd02c, 0x007dd0461a3715c7, 0x008d7c9cdd500afb,
+          0x00ca28eba0807722, 0x001694016ddfea57, 0x00002c26989fb415}},
+        {{0x00c19d4e64a50c11, 0x00578d778310c861, 0x00bc338ca2129a05, 0x007d8385d3c0217e,
+          0x005ce9379da0edfe, 0x007bfe6260198bb0, 0x00003f1909b777db},
+         {0x0073666903721cf1, 0x000a7ded5efb88d4, 0x00645b4f32509558, 0x0060f3cddc6da905,
+          0x0021562a767ac5c6, 0x00f6191e0a5b2dd3, 0x00000e7c654980a2}},
+        {{0x00397b2034f92fc0, 0x002a2539040d16cc, 0x000974dfdc53abc5, 0x0099314aad0f92bf,
+          0x009c69943a476f74, 0x0043669d49c40454, 0x0000a179ad8f81da},
+         {0x00140e0f957475df, 0x001d15c8f488c3a8, 0x00c0caae1356dcee, 0x00572f118155b29d,
+          0x00d11aaf360a1b9e, 0x00a8d6933a145e84, 0x0000da9fd8068543}}
+    },
+    {
+        {{0x00df313fe9bb1adc, 0x0093498166e01da3, 0x0038cb2ecd2019a4, 0x00e335ddb917cd53,
+          0x008d0bc2ade3a46a, 0x007f3121a9650475, 0x00007396064945ec},
+         {0x0074d2b7db79c2d9, 0x00afd6d8694ad841, 0x007421ad1350adde, 0x007f3f739d06b253,
+          0x00ab941f8a0b3df6, 0x00460b43124f15f7, 0x0000a4b29da0d8fe}},
+        {{0x000eb2b4b2a122aa, 0x007574ef0a4a00ef, 0x00e4c7b0c2547209, 0x002229fe396a0442,
+          0x00171a3444d4a379, 0x007374280a1d9bd4, 0x0000de1b58d5a659},
+         {0x00ab773866677a12, 0x00d41abbf1a588d3, 0x008925aa1d281c34, 0x00605b2b861452b3,
+          0x00afb38b5e2f1ad0, 0x00a2844b6316b05f, 0x0000c2b76ed80ea8}},
+        {{0x00e3c62990e33539, 0x00e7939061eea025, 0x0004f885616ba269, 0x0012a5f4d2d3b6c6,
+          0x005ce76e38a8a117, 0x00a95d65130e77d1, 0x000083b850e5d41a},
+         {0x002b6d7c71f75404, 0x00a9e42ca1f29a6b, 0x0099fec25b792dd1, 0x00b86fe3e8ae865c,
+          0x004344a2fe30beb9, 0x000b0cd37c745ec9, 0x0000b906adbae9d5}},
+        {{0x00e6c882dcf5b44d, 0x0097a736c2daf9f5, 0x00fec4cc9ae90ad3, 0x0097f2913e1f1652,
+          0x006de182e60fda50, 0x005436b735f7b4b3, 0x00005916fdca401f},
+         {0x00453099cf414a55, 0x006e9fb6a87be380, 0x00eae55b3b1caea8, 0x00f3197f7fed647c,
+          0x003aa34032927302, 0x00273d501d12e842, 0x0000c00c4d4ec9c9}},
+        {{0x0084f6a9feb519c0, 0x00bcfbf12a068046, 0x00e136b9928f7a1a, 0x00f673d1beaa994e,
+          0x004bbad821ab8375, 0x00d5626ede0a9893, 0x0000c977ec83761c},
+         {0x008d95fcfbb16728, 0x009b154026250215, 0x009a0633a2b7e435, 0x000f663595063fcf,
+          0x000fb066ff5a3223, 0x00b856821aa29162, 0x0000e12ad3e448cf}},
+        {{0x00953d84ed31e21e, 0x00e6f21165498447, 0x00791e9b862abb75, 0x00a5b74574dc8a28,
+          0x007fa7a891f11b7c, 0x00aff7a9ba110c06, 0x0000a00823e784cc},
+         {0x00ee335c67174039, 0x00e4aa0ff3d43af0, 0x0090451f7a7e4171, 0x00ce06fda355de25,
+          0x0000726ceb652215, 0x00c932fef28b8dfc, 0x0000ecc15379cdcd}},
+        {{0x00cfb780067bcfe2, 0x00d486f6708f3b15, 0x009a02654b85d7ff, 0x0085b668cc75cb7b,
+          0x005422f752f7a722, 0x00e0983f484fd3fa, 0x0000feecbdea4e92},
+         {0x00f913c32d9a40c2, 0x00d786954436695b, 0x000dfa30938ae230, 0x000d20f688397dbb,
+          0x00d6b77750d8e589, 0x006c3714266c8f55, 0x0000998e1e0fdd06}},
+        {{0x00d64ba6c094c2d1, 0x00d4d5638078fc3a, 0x0052b9775c41eca1, 0x0095eee5d472dc8d,
+          0x0079c2960817b499, 0x0074530171f5f349, 0x0000c6c64174d806},
+         {0x001248c30584d8f6, 0x00cd7d947d4b0b4e, 0x00b4bddba9661f5e, 0x005e9263b649af98,
+          0x00b22cc77c04c912, 0x00a273b6eec090a6, 0x0000efd7d25d4161}},
+        {{0x0077eb4c0f8308b5, 0x006b7b3e63771515, 0x00a57582dd0d79c4, 0x00a552c73c82a9c3,
+          0x0069fd8e53f857c3, 0x00e7056d7df8b389, 0x00007fc5e94e1822},
+         {0x00ec55c4b9958200, 0x00f0320ea62ac802, 0x00d2c285195ad471, 0x00373749c3cd5c06,
+          0x0063f217bf431795, 0x009cc59a17743870, 0x0000a00ce7a969ad}},
+        {{0x00e92a4f1b5890fc, 0x00331f5767543ffe, 0x00f169b84e49176b, 0x0086f9259eceef0c,
+          0x00d310c09fde6fab, 0x0041d7dd7c03ff20, 0x00000faf03f04ec5},
+         {0x00c132fdc840d161, 0x00b9a622aa2f3232, 0x00e5ea474c1bba3c, 0x00f635dd475f2b8e,
+          0x0056c727080cd026, 0x0009cf728474d7a1, 0x000065c7f31e107f}},
+        {{0x00b1bdf217058cc1, 0x004520c47457ab31, 0x00e7e05587266820, 0x007fe775fb2abad7,
+          0x00194938f06970e5, 0x0095927eb7008e10, 0x00001df8faacdeba},
+         {0x005ad3c6c2529cd8, 0x009ea05a23e3390e, 0x0044273ef4e66428, 0x00b5867c316c2ea7,
+          0x008536302b3a72be, 0x009498b8acf46caa, 0x0000a3e4e378214b}},
+        {{0x0065dc8d6a85812e, 0x0029cb81169f5c9e, 0x00043e1591b10a11, 0x002446bc92bf12ac,
+          0x0074a28d65f52e69, 0x00fb2e30675a676a, 0x000075218cabf6e7},
+         {0x0068480a5ff11aac, 0x00b09fd4ffa13c7e, 0x0008487150314036, 0x009a85b1b778e32d,
+          0x00cdf79b4e2b24fa, 0x00eb8d6c48cf4b0b, 0x0000dd6f387ad670}},
+        {{0x0047804d3f38690d, 0x000931554f30fc5a, 0x006b064a51311475, 0x004d64dcf1b8c71d,
+          0x0072eed228c0c870, 0x00511aa11747ead0, 0x000032befe7b2dda},
+         {0x00405d19122f6f2a, 0x00ddd79c245e8c3c, 0x006e9cc92de3ac07, 0x0057187f554e27fe,
+          0x000910ba319194fe, 0x002e27cadfd025d8, 0x00000dc4a145737f}},
+        {{0x00fd5e14374ff71b, 0x00bb0dfa43605981, 0x0055d8415ee9f63b, 0x00e81a7dcdb38e71,
+          0x00a799a1191ccbc4, 0x0001731d80914a9d, 0x0000189ef9bc6cc2},
+         {0x00987a27b99f712d, 0x00044b9a82449690, 0x000ca00661630f7a, 0x00cad55edb4d98b8,
+          0x0058163aedde02cc, 0x0014a6a4d4c1a6ef, 0x0000de237caaaf35}},
+        {{0x0011aa9cb4767ada, 0x00a845fc77c2f5e3, 0x00023036cfd7a5e5, 0x0096c8224e4f032c,
+          0x00730fae45243fee, 0x003a6b920b656e58, 0x00008419e63f954a},
+         {0x00a787f67969e642, 0x00aa9f3ef8f70510, 0x00fa326338fbd35f, 0x00fb728f2b01eaf2,
+          0x006e2782c7f0ebe1, 0x000531099a6699c8, 0x0000b362c7b116a8}},
+        {{0x008013b775b102e9, 0x000dbd6b60eaed4a, 0x0054831d86eeebd7, 0x004dd13ec16113f9,
+          0x009cf83f21c5132d, 0x00fe1adc4d3bb700, 0x000065e03b5f1e0f},
+         {0x008984399626e70d, 0x00b5cce017e21266, 0x002fcc13e08501dc, 0x00a585310955abf9,
+          0x009c0b8f57e781a8, 0x00931dc888711a57, 0x0000eaeb179ebaa4}}
+    },
+    {
+        {{0x00aba70a48453eec, 0x0013a2b6b01a9707, 0x0097ed4c028bd5f9, 0x00336e4635de1676,
+          0x00474d7156fe29e5, 0x007afb044d45af1f, 0x00005370c73c66ba},
+         {0x00e4169d66f451b3, 0x0062f69ec6231921, 0x008a7e3e7e132288, 0x00981320f522c8f0,
+          0x000927fdf881eb89, 0x00e3ec17061b747b, 0x00002cab1aa75325}},
+        {{0x00416ddf839484bc, 0x0073e64917a76e63, 0x009f687bb208f8e6, 0x002a8a454a369216,
+          0x0091a2b7262fd932, 0x0046b5d91c12c579, 0x0000ad0cad662b90},
+         {0x00e4584d4ce184ac, 0x00ab4f95de57dcb9, 0x0020f5a0cf25d36a, 0x00abfc71c799c487,
+          0x00bf2d1cf8ad16ef, 0x001ad3603bb39f4e, 0x0000806fbd102b8e}},
+        {{0x00a659e17039ba1b, 0x006a6e8fc7fb1944, 0x0094c41ae57541c4, 0x00dc18ceac8efdac,
+          0x0010d35b816fe508, 0x00100bbcc5231339, 0x00005cdc5351945e},
+         {0x00314b79de930706, 0x0060383e4c3f5bdf, 0x00ac001e54842462, 0x001c533a3e9ad2a5,
+          0x0042cfdf977a370d, 0x00ac1e2cf56cc68d, 0x0000b608280f1105}},
+        {{0x0095fdb85bbc9ac9, 0x00ef903f7ea0bc31, 0x00961eadf12e745d, 0x00a82414ab9ba19c,
+          0x0080ead28637fb14, 0x00185971070e1f0f, 0x000073b32aa391b5},
+         {0x000c82b9ee819191, 0x00aa77ad2ac5c898, 0x00f84e474cb8d630, 0x00440186691649d4,
+          0x00f236ae83a90266, 0x0067f2d25513dc5f, 0x0000b25277d8fe21}},
+        {{0x00d2b47839c19668, 0x00870b4027424cbb, 0x003d15ab31df822f, 0x003952558ddf278d,
+          0x004ab0bdfaead971, 0x00e95cbc0992ff7b, 0x0000884cc30d8d15},
+         {0x00cef1200a8a3a59, 0x00f01c29feda9f0e, 0x00353ef6c3e3e923, 0x00cc6e64c0bbcdc6,
+          0x00d1cc0674b083ed, 0x00f49cb4a2dffd4d, 0x0000a7b6d16c8267}},
+        {{0x00c86deb53996eef, 0x00861ecd5fab3c87, 0x00b648aa759808be, 0x00b27a037a3ef8f4,
+          0x007432799d84cb2d, 0x00ac88e69274b933, 0x00007e9e19c265f4},
+         {0x00a691b39d3e74bc, 0x008f66827d37c894, 0x00b1e97736b0237e, 0x00568566216902bc,
+          0x00ef4af844cf300e, 0x00be9f238dd5486c, 0x0000da3251379b46}},
+        {{0x00325cef668b72b2, 0x007fe542369e6c36, 0x009bc4d6864d3e42, 0x0064d402e927dbb1,
+          0x0098a81d0c421e97, 0x00bbafba1bcc22ff, 0x000006593c733377},
+         {0x00d25c5db0b86c51, 0x007f2a0530aceb62, 0x00c2fa8ee333ecaa, 0x00921e809c703102,
+          0x00a757390f19b29a, 0x00de97e9bae24ac5, 0x000031e96227ae5b}},
+        {{0x00a101e7785b6f97, 0x007dca091b137999, 0x00f527fb3a9f022c, 0x0034f6d1295cd7e6,
+          0x004dea9ce8c50da0, 0x00abc9747e82bb2b, 0x00002c628772682f},
+         {0x003719a8b6e95303, 0x00087b9c565b8db5, 0x0093b811029718cc, 0x0005d1cfb4b1ddee,
+          0x005e714a0350b6a2, 0x0096d36e59833c7b, 0x0000fb825ae7ece8}},
+        {{0x00397e01340bc4f0, 0x00ea6e3b5a00aa6f, 0x001e6a6625c5d92a, 0x006c2ae66af97631,
+          0x0031bfc5b18a8763, 0x00556909fe276bb4, 0x000043ddd79ef235},
+         {0x00e4631fe74e25ec, 0x0013faa19b58ba68, 0x007cc808b5fa4e58, 0x00c983822477964d,
+          0x00f46bc7e784d947, 0x005d8f7df2721fb3, 0x0000c7ed870a3b08}},
+        {{0x007fc08d2068acbb, 0x009c1c59a9f44ba9, 0x003d0c455ce2621c, 0x00a17ff81e78c837,
+          0x00b1400efc126226, 0x000b3ef86e779276, 0x0000d2ed3e08cb11},
+         {0x00f5279f3f3f1e4d, 0x00ba2338763be8a3, 0x0008ff0962b8f0e7, 0x00a07efa7eac650c,
+          0x007f82666263a1ff, 0x00e6c367d4a07e17, 0x000029217dbbed12}},
+        {{0x000b7e193ba0ace8, 0x0047dffa974be89a, 0x00d5351f0bbeebee, 0x005a83686ea40512,
+          0x006d5abfa33ad561, 0x009bcad3e8149b90, 0x0000c69d86fb3b93},
+         {0x00d2dee0f892044c, 0x0026aa7ba494fb3a, 0x00576a77ffb529c6, 0x008773f8c6357b5e,
+          0x00866a08ca019053, 0x005ad9f1f08719ac, 0x0000b518030b3641}},
+        {{0x00852c813fe2fc6f, 0x008e45b9149fbfbf, 0x00d92d277ad46626, 0x00481da2613f84d2,
+          0x00a1cf869173379d, 0x005f2a1b47804316, 0x0000118e885be773},
+         {0x009b2bb0c0ddc1a5, 0x0099ed8f7c8fae0a, 0x00e47052b26aa4a7, 0x00a92eb8ada68aa2,
+          0x00d2cb7ad406e3b5, 0x00539056937e7ed6, 0x0000b23861286b27}},
+        {{0x0058d7368f9c966f, 0x0059579add7b3844, 0x005d65e8bb4eb764, 0x000e90b3e4bb905d,
+          0x00626e3b02afadb1, 0x00c17ebe6c853a7e, 0x00003d68da92fef4},
+         {0x005002daa520ec35, 0x00eaf823ff3258c8, 0x00ba991d54f57321, 0x002973be7d425840,
+          0x00d56b025c520943, 0x005295e7b4676d0b, 0x0000b4bab2afc7f3}},
+        {{0x00700a144a01a916, 0x0037c1b890868031, 0x00b7e4403f357c84, 0x006e23d0cb4e7a93,
+          0x00d39a44b2b3ed14, 0x0090ab96108bc3c0, 0x000091a77affa1ab},
+         {0x001168eb7bc6f273, 0x00c91318f566fff3, 0x005ed6b141db5cf4, 0x00202de51e3e7139,
+          0x004b5300f8f1f54f, 0x001de941fab2f87e, 0x0000668acac59f0c}},
+        {{0x00b25c2568b2bf60, 0x000c1224191d0b1a, 0x0082e5b9ffe60418, 0x00488a3db8b75081,
+          0x00e261a8668b7d20, 0x00bfb1e96ebb204d, 0x000019fb30f13023},
+         {0x00147b36c0223b8b, 0x0064c7dfb3e7c93a, 0x00792bc7ec2d64cf, 0x005955efae46eb6e,
+          0x005e6c84dc0f69b8, 0x00ebe453c2d36620, 0x000031e26b0260e1}},
+        {{0x00252e5a1d8af374, 0x00a97a6ef5335401, 0x00926322d330a0f0, 0x00b749ab155d8caf,
+          0x00f9d89d86bcd55d, 0x00af817b1441dfef, 0x000076f6e90bd832},
+         {0x0034a2faf7021abe, 0x000d3243ba86b21a, 0x004d3a72a5c48c81, 0x0050972de317add9,
+          0x005bc40b240840c2, 0x00750d350f524de1, 0x000083f3475b9dc2}}
+    },
+    {
+        {{0x004b0f77ad3ab043, 0x00ff5a5742664b06, 0x00b0087fecfde002, 0x008b1122c6f83f8c,
+          0x00d30feee1cb78ca, 0x00bdd48d7d76002f, 0x0000dd22a800f3cd},
+         {0x005ff455287ec7aa, 0x00dad9fc7e03ed8b, 0x003e8e765f15517a, 0x002759b7ac25e725,
+          0x00275f2724758758, 0x0042f986d0cea210, 0x00009926862dee18}},
+        {{0x00466437c2a0e5c7, 0x004a16984a801aff, 0x0087969a572e5d7c, 0x00c2e0168d3045e6,
+          0x002289b792b9798a, 0x00137517651c7508, 0x0000dd805ab702f6},
+         {0x003d5670ed8fe3fe, 0x00d7069dde24db27, 0x0069d5b65096db23, 0x00f632e698da79e1,
+          0x002b3a2cd752cd12, 0x005fd608e240f08a, 0x0000065b2f90d1b2}},
+        {{0x008488eafd7b4296, 0x00167fc13b17168b, 0x00ccdf6b24987aac, 0x0062c273e8dcb887,
+          0x001f72a8c258c402, 0x00f386cacfc3a75e, 0x0000de2f8ced76cb},
+         {0x00ce34078d865d53, 0x00e80e1b45884f4e, 0x006c49ab821cde26, 0x00ecc7d27114ccac,
+          0x009176060cad3ee7, 0x006cf7dbbde7e781, 0x00002b0e25c6ae08}},
+        {{0x00756ca8787d7f2f, 0x007620bfaa5797b1, 0x00f8f63363944044, 0x00896828ad36513c,
+          0x002f18df8aa24362, 0x00caf6f359c22f6c, 0x00008786cf16bc08},
+         {0x007123b1194072ef, 0x00a57d34cd800744, 0x00c6f387217512de, 0x0015a3e948a73f09,
+          0x00c4683a151dfdb1, 0x00f693d2dd863e56, 0x00009b80d141056d}},
+        {{0x0080cd098fa2be0c, 0x00fc623d185b9223, 0x000e051a2aaeb22d, 0x007ed1857e85227e,
+          0x00ebc688b2295a3b, 0x002a56244fe215c8, 0x0000dfefcadcd3d8},
+         {0x00ca352678809378, 0x00c77dba2e965680, 0x0028547a9495378a, 0x00ab8a72e277b2c5,
+          0x00c934c939d0beeb, 0x008e031bdd5fe680, 0x00002bf3f69f1400}},
+        {{0x00a80a6c67093df6, 0x00fb2e2743c46544, 0x0060e49387de63f9, 0x0009c704e6502942,
+          0x00ef71b9fe990fb1, 0x00573ab2620c7303, 0x0000123740a7b903},
+         {0x0077482330b5ece8, 0x001948b6ec2f39a8, 0x007a249e952654d3, 0x007556836e553594,
+          0x005341300ffc8dc0, 0x00a24263a49640aa, 0x0000679794fc7697}},
+        {{0x00991d646171d68e, 0x00adafbd084d964d, 0x00a537f53377eafb, 0x00755444f516346e,
+          0x0012b2329f178834, 0x001a4e7b79a14c10, 0x00000fa56e298592},
+         {0x00731af289d66d27, 0x0079a58fa74d2934, 0x00336af63266ff74, 0x0016589f196180a8,
+          0x00ec02116e37b858, 0x00c1a0de0a1a3dc5, 0x00003513f5228215}},
+        {{0x002e8c202644dc98, 0x007e244324af38a5, 0x00193b6406d1887c, 0x00066651cfaad69e,
+          0x00b254ca499d6124, 0x0063eeaa617c8c0f, 0x000076c9cbd1e7a5},
+         {0x0010904115e251f0, 0x0069299be827d262, 0x00a3d10163faebc4, 0x00a38c0769b0ad0b,
+          0x00caecf40c49b061, 0x004d28f64190aa72, 0x0000d2cb2d0919f5}},
+        {{0x0073d1d70ac36209, 0x0092d392e8e2c3b9, 0x00e8feea49f9fbb7, 0x00405e1b7848f72c,
+          0x00cf29924c184e3c, 0x00574d760cfc254a, 0x00000a66781899ea},
+         {0x00eb986da71aff59, 0x00adff8a47b82900, 0x00753f467610d258, 0x00138a19e1df03f3,
+          0x005ecf017f62dcce, 0x007321466cd78c0e, 0x000014c4b718c9b1}},
+        {{0x004ca2bc44477771, 0x00ccf6c0be2a4547, 0x009bf40556ab5c9a, 0x00dd00f3e864822d,
+          0x00b3a7afbf364800, 0x00a9ae9dc15f56f8, 0x0000ddb9f8360579},
+         {0x00c2e24cd8591917, 0x00a0e58601ba7a21, 0x0082b4bd5db4a31c, 0x00119bfa527fbb8a,
+          0x0069ecb9d73b0dd1, 0x00ba270b46a1bcdf, 0x00005ef2b27fe60a}},
+        {{0x00832849b3342021, 0x009ff073adb3a4f0, 0x008f250139bce91a, 0x00e67c194c434903,
+          0x00e4315f05450107, 0x00886d90866f0103, 0x0000ae3d1a0d8b34},
+         {0x00e9351c29dcbaa5, 0x007fe848011de7d8, 0x004234ec5ac015fc, 0x00e58640554772b5,
+          0x006508c202f13449, 0x0031fe9d645e12d9, 0x000031de67ae3d7c}},
+        {{0x00b0657a1bb86c5f, 0x0011bb23c3c7a59c, 0x00fa9ee0992d496d, 0x00d15b8756f58020,
+          0x00ed31b5c097946f, 0x0027365e22ef7d2d, 0x0000a4585b171aa3},
+         {0x003590334d85942b, 0x0063a01ac0023bb0, 0x006f963b5c7c8542, 0x0047d63194fda20b,
+          0x00d76eaef7f8d6b6, 0x0081e2da52b7a15c, 0x0000a04134717083}},
+        {{0x009b6d91d3291270, 0x005d717b05b62a50, 0x00f37fa6f4ea6409, 0x009b966ec9d37351,
+          0x0072ce3f553f2c55, 0x0042d81134ab74f7, 0x000012577d34bac7},
+         {0x007efe963fb4c386, 0x00cfba711c879c6e, 0x005bcacc919df94e, 0x002ee99ab277029a,
+          0x0093f8910f970896, 0x008150b50a6881ec, 0x00003a69796a3f7b}},
+        {{0x00855e1783d71326, 0x008c1ec3a4a244af, 0x00b5610c04451f53, 0x00d3a68165175492,
+          0x009862f985d08c73, 0x000cdeb0ecb6ff27, 0x000063e7ca8f3b45},
+         {0x008bd44b097ae835, 0x006a6375350f9a7e, 0x004ae98ffdc0c951, 0x00166f1192242fad,
+          0x00eb8a4331145cbb, 0x0049ee8d12d693b6, 0x00000a106f0243d5}},
+        {{0x009c0b7f9e96e5aa, 0x00728464e47e675d, 0x00a9edaea6d9b4fd, 0x0002c15f6f6fd246,
+          0x0036eb5ebf8b96e7, 0x00820ba9d56d48fa, 0x0000f33f4e2c747d},
+         {0x00c142215fab268f, 0x009845879575507d, 0x00e6f43b16878615, 0x00e7e6430c2a754e,
+          0x004b40323e4dc93c, 0x0063058444199ec1, 0x0000e7081b92fed6}},
+        {{0x00809cc77c84ad05, 0x00e2d9fa12106d64, 0x0004370da1ba98ad, 0x0035be0e7c2dc252,
+          0x00f710deca3aa1c9, 0x005c077bd4d1121d, 0x00004fa9b82487db},
+         {0x00a62b469c821b7d, 0x00b3ca27d1e9ff5b, 0x000528aa18e7d0af, 0x00b6296d2ce2765b,
+          0x00a3589ded1fec99, 0x007a292013139e16, 0x0000333edd5cc273}}
+    },
+    {
+        {{0x007eadf4fc99e1c8, 0x0054f89ac9935d50, 0x0046b110fef8cbb4, 0x00e7147ee627bec8,
+          0x005a8e79b1205e7c, 0x00a9f60e9cf4e12f, 0x00007e6af6405baa},
+         {0x00ad44778442cc69, 0x00f0eb212f29d037, 0x00ed58f8ee5e8222, 0x004a2f2a556020b2,
+          0x00f087881a46db65, 0x001f27f8db1988f6, 0x0000a34b2620955b}},
+        {{0x006794db1626a3ab, 0x00743e90cb228947, 0x0006fd1de2be1a2e, 0x00cfa0b91141e9a0,
+          0x0028ebcc18a4523b, 0x00aebf3b50e79680, 0x0000d628049e35d0},
+         {0x00a2a6719beccc48, 0x00c447944b6918ba, 0x00975bccd23d879c, 0x00efc267374ed0a5,
+          0x00caf5a3f99f424a, 0x007d2bae309f2bac, 0x000021322b00b178}},
+        {{0x00537ff28380e272, 0x00ab96191a370e5a, 0x004773e3859a35e8, 0x00dedae814bcdb07,
+          0x008e54ee9dc33d12, 0x0037211b9361c5d2, 0x0000f9821c37fd19},
+         {0x00af9f92b108a2bf, 0x006b3a24978120d5, 0x009de87340fd797e, 0x0017265d2ddecd22,
+          0x005656225c70b8b2, 0x0044a9480dc79591, 0x000044e8da1cb492}},
+        {{0x00e018cc3bafa793, 0x009bd58462a9e14a, 0x00e8702b845162dc, 0x00813baedc881004,
+          0x00732beeeeb6b6c2, 0x0075badb59c5b14d, 0x0000dadda600d2cf},
+         {0x004bd3758695642e, 0x00e3196020fe54db, 0x005a04915a0efc16, 0x00c00e4fda63c2af,
+          0x0054f941d2599e54, 0x00dbf5e349ac89c9, 0x0000cad99799d023}},
+        {{0x0056df1486331776, 0x0049df318dd35f29, 0x00b11303e4684ea6, 0x001b79a5af6cd61b,
+          0x007df7a9fcc8b6b4, 0x0018f43eda13e1be, 0x00008415df415bd0},
+         {0x001b6bc2d5620ef6, 0x00f8f491dc2ca4d4, 0x008f03e00d8e4fbb, 0x00f87cf30a80eb48,
+          0x0076644099b2bf37, 0x004babc4815adba2, 0x0000b0598ba68f6b}},
+        {{0x003751b368a092f1, 0x00766495a00b72da, 0x00569286b0a435ef, 0x00e8442ff5f9f0ee,
+          0x00bf76e7bab7128f, 0x004a759289e810b1, 0x0000146cfb9f6f71},
+         {0x00d738c444840e63, 0x0026b937abf3f47d, 0x00cd4ed45a601018, 0x00566286a9b32316,
+          0x003328cdf20a25d8, 0x00fe72df8318ef72, 0x0000acee7663b4cf}},
+        {{0x00406c9a0c6b56aa, 0x000171f1671fd640, 0x00df02381a5d7833, 0x004abf416e1a3dca,
+          0x002091079acaf25d, 0x006efd9c98f38ecb, 0x0000906cf3fa5f1d},
+         {0x00d09a12efc603e4, 0x00e178e975745b8e, 0x00a4fb958156de01, 0x00f03dc425af0761,
+          0x00a4ee5f917317d7, 0x006a9daddcfed420, 0x000054c52687c373}},
+        {{0x00fac04cf055ffea, 0x00b93a1bfefcc464, 0x00eeb4ba5e68205f, 0x00f8f9b6df8dbefa,
+          0x005d2139933a8bea, 0x00c73235ff277c57, 0x0000851ea5d61d5d},
+         {0x00c32ab62f5fe954, 0x00012d885ea15fa6, 0x00b661b9d6267c46, 0x0030b8384ff5307f,
+          0x0016a17f32f82b92, 0x00ecce785c7b8705, 0x00005dc6ee8f821a}},
+        {{0x0020aa0d2f51bafc, 0x005057b9edd777dc, 0x002cb1db2d814b7b, 0x00e2e4641d73cd51,
+          0x00ba30278e67b2af, 0x00ed29cee54daa7b, 0x0000e445ef8a2c6a},
+         {0x0021a63c38c23c9a, 0x009cf2be878932f5, 0x0028c331259d603b, 0x0062b50206889cd3,
+          0x0013b0477ad7301e, 0x00d3bd32d7ffbefb, 0x0000606ab19a5454}},
+        {{0x00a48ab2a47fe1ba, 0x0027239847407d13, 0x00674f08044ba976, 0x00e29002a792f599,
+          0x004e81ce08c98204, 0x002cecb0c8289abb, 0x0000a8f21b54fd47},
+         {0x0071dc0ddb0ad2c4, 0x0005a1ca4eb5e7e4, 0x00f9d1f99b5f6e2b, 0x0097082b6954e971,
+          0x00e34fd39e050613, 0x00f46a6b8f1620e9, 0x0000cbc5dc34b1b1}},
+        {{0x007740fd1dcad329, 0x00c6799067e8ec6b, 0x00cbc29244b6c3d2, 0x00b406d9aa7a3a50,
+          0x00caa175c89ed1d2, 0x0007bc0e9fe6f754, 0x000047f723cc3c80},
+         {0x00e55acdd67e6770, 0x00840c461cc6eedd, 0x00e576ca2cfaaca6, 0x007575f967891d21,
+          0x00464671b71f3e91, 0x00c64d9f5f0bd483, 0x000013e3287dceba}},
+        {{0x004545240f1037c7, 0x001f44a2e60d316d, 0x006d02c5d04898f8, 0x000465ceaea48a30,
+          0x003bbcfafbaff2a6, 0x000cf15a6c9c7f87, 0x0000f2c006886cf1},
+         {0x00221d77ddd02b98, 0x008998edb598e3fd, 0x003d696dc00ba067, 0x00f8c84768bba850,
+          0x007781c29cf3e80b, 0x0066bb25ecbb6a4c, 0x00009e5e592c3342}},
+        {{0x00cbca2ca1e30a2e, 0x0043f6c70845fbea, 0x0054bf9f6f10acc4, 0x005bf6a9b9c1e6f3,
+          0x007ca27ecae7c10a, 0x002bb0f53021fa13, 0x0000210208df5fd9},
+         {0x004187198ec7894c, 0x00c47e2d0d9f0efb, 0x00eefc8e4b9917d0, 0x009c22095802e777,
+          0x0071c25fb34a7763, 0x000e768c77666f22, 0x0000e6b00830c602}},
+        {{0x00f6f73a89e79077, 0x003dac62d6da4b89, 0x000a8f44355a4652, 0x00b66df0da647095,
+          0x0079df7b616b7f7e, 0x00f49d2cd5dbfd6c, 0x00003e233dd14dd7},
+         {0x00f1187f2f47074e, 0x006664cb147c32ef, 0x003715d692752ced, 0x00f2dd91d0a1ff22,
+          0x003b53f0b188cc4b, 0x00c6b197db737b62, 0x0000d70d4deebdbe}},
+        {{0x0029c3c87da43c56, 0x00557cb5803352bc, 0x0041cfe24a9ed8ba, 0x00e0026bfcca5662,
+          0x004aabcc89fbca26, 0x008f575baeee0679, 0x0000264dd7b754ef},
+         {0x002ad7be39e06a57, 0x000edbcbfc6ea965, 0x0043dbe50894353c, 0x0089493c526c96e5,
+          0x004deff1e38550c0, 0x000691bcf228924e, 0x00006ec373e9e2ad}},
+        {{0x009d1afe97c715da, 0x00e81a24bf944c8a, 0x005550297edb02fe, 0x00818cdb1cabce75,
+          0x00d786f43611fd38, 0x00436baf2e30df72, 0x0000fa0607771042},
+         {0x005fc44bf870aa38, 0x003336ae5635fc97, 0x007850667529c2f2, 0x00d5f165326ddb06,
+          0x005ca7c431908465, 0x00dfbb7d8ad66e00, 0x0000c31ed2b3ffe1}}
+    },
+    {
+        {{0x0075300e34fd163b, 0x0092e9db4e8d0ad3, 0x00254be9f625f760, 0x00512c518c72ae68,
+          0x009bfcf162bede5a, 0x00bf9341566ce311, 0x0000cd6175bd41cf},
+         {0x007dfe52af4ac70f, 0x0002159d2d5c4880, 0x00b504d16f0af8d0, 0x0014585e11f5e64c,
+          0x0089c6388e030967, 0x00ffb270cbfa5f71, 0x00009a15d92c3947}},
+        {{0x00df1a56b3752d25, 0x0083eb44d7ef8e61, 0x0089a20f10576b69, 0x0088bba8685333a5,
+          0x00bcf208d2ae7c65, 0x00f41638378792ae, 0x0000826345c9f1e9},
+         {0x0002c0a983662976, 0x00e88f3c6845a7b3, 0x0093f707afb161f0, 0x006f232845d7031f,
+          0x006474b4c35d6183, 0x001fa2e137f089b2, 0x000061a636a12878}},
+        {{0x00ce4043bc0af197, 0x008447ce5788aaf3, 0x00ebe5067eeeef8c, 0x00e7417b5f654765,
+          0x00f81bfdc79095f9, 0x0077e27c96d2abc7, 0x0000d6751cbbc7ef},
+         {0x002e17ef5e8b5c03, 0x00b603d53c3b0897, 0x00dca1bce93c6ce5, 0x00aa230793e948aa,
+          0x00471e89e256f40b, 0x009f57608359afaf, 0x000051b665342589}},
+        {{0x0028b09aaa03bd53, 0x005458a4f52d78a6, 0x00894d10ddeaba06, 0x008a3e297ddb2987,
+          0x00421279b42a31af, 0x0019c440f7f9e706, 0x0000c19e0b4c8001},
+         {0x002d0fc5e6c88c41, 0x00aa6de639d85882, 0x00d135f6ebf2af68, 0x00e3567af9c1c7ca,
+          0x005b77f6577a30ea, 0x00b301e5a0191d1f, 0x000016f3fdbf0356}},
+        {{0x0027006b997defd1, 0x00b2830828360487, 0x00b579c5119a11a1, 0x0055cca3fe8a7018,
+          0x00aaa4938693b646, 0x00229ba6942e76fb, 0x00008a01c7172d69},
+         {0x00138e1083a2190e, 0x00e054e0b157420f, 0x00ae2c27d7daeba7, 0x003e35b593c8bc1b,
+          0x00f41ac010580db4, 0x009a5645da847aad, 0x0000889fafaa1671}},
+        {{0x0086fe5f808eabeb, 0x00421681dabdaf93, 0x00c20dc19aab0531, 0x00c645ad295b9516,
+          0x005ef43429e2e894, 0x00895366732467ae, 0x0000bde079585a72},
+         {0x007452f3271fcd6b, 0x00b5feb392942346, 0x0063d191860ca7ea, 0x00d1edec95dff7c3,
+          0x00bc814f2a2f2dcb, 0x00a6ae95cbab87d4, 0x0000d1298a281823}},
+        {{0x007c50cf3cee4973, 0x00b3b5567d4c61ee, 0x00394fa01d70e383, 0x00ae55fd39e78ff7,
+          0x00c99a7725bd6243, 0x00601a696ddc7c37, 0x0000ab48463622de},
+         {0x00f44184ff6b55a1, 0x00518963b0742f37, 0x0050683283c74e91, 0x00b0c8803107eb38,
+          0x00ffd375881ab246, 0x00c62eb212e44863, 0x00002c069165f702}},
+        {{0x0088a5e242167978, 0x002406047cb67724, 0x00d64b5339132160, 0x000b6e7624bfd5aa,
+          0x0035967221511ec7, 0x00bde3b38e9816ac, 0x00009b793af458a9},
+         {0x00448af044999a6d, 0x002e821f1061fca8, 0x0033de5f9256efd0, 0x007a770f812f04dd,
+          0x00ed11ef822a5c68, 0x002eb8b24c6dea5d, 0x0000b4744f7dc0f0}},
+        {{0x00f41073139bd89e, 0x00aff41a3dc18869, 0x0007fd1b62ec1567, 0x005824829af7676b,
+          0x005cbd25a40f8ba5, 0x0031a5ce67f3eaab, 0x0000257ff0273cf0},
+         {0x00152f16cee2c72e, 0x00e7b49a98025c16, 0x005982a110cfd08c, 0x007f617db86093ed,
+          0x009647e181c79a0e, 0x00bff61ddb85399a, 0x0000326e35bfac55}},
+        {{0x00ae7ba76a251f5a, 0x00dac96540252648, 0x008085d5440e8494, 0x00fc955d32057f43,
+          0x0069728766bf6aa4, 0x0093f57967db87ca, 0x00004c1c85f87e5a},
+         {0x00864d35e5f5edc4, 0x002dcf9f982f9af8, 0x00cc0e8771b31db8, 0x003f20e9a30fd0e3,
+          0x002403709e2cd3f8, 0x00fa8ad7f9849d67, 0x0000e16737fb0129}},
+        {{0x00a592287d10b30c, 0x00604debdb80a844, 0x008c2044e88d9410, 0x00ec3a70213e4d77,
+          0x00d8e05b04c8d9ac, 0x00930a64cb050888, 0x00007a8eddc9e57f},
+         {0x0037469d66e62ba5, 0x0081d5b0062b33ed, 0x00c6168772297c9a, 0x00107942bc16a5e8,
+          0x001efda9b21ada5e, 0x0018a848db74ff4f, 0x0000aafc9773681a}},
+        {{0x00d13d9055de60e2, 0x005311345523a8c6, 0x00de72320efe8852, 0x001e0922c4412788,
+          0x00df382a623be109, 0x00c337f820ca874c, 0x00001a509ee26fab},
+         {0x0023b6403da53b9d, 0x00d6ea7c7fa6fb21, 0x00b11f77605fadde, 0x00581798b747cfb5,
+          0x000efa1caf3d0a9e, 0x00a1dcb9484b480e, 0x00009a8d3d400bcc}},
+        {{0x00e4f436449a24fb, 0x00a16348a9a77031, 0x00a49cfefefd8755, 0x009a5e129121d05a,
+          0x0096c4ff9f094b31, 0x0005819c89f5485e, 0x000074d44308153c},
+         {0x00eea6739aefe49f, 0x00771e78e2ed2bd7, 0x00bcd6ba873fd90f, 0x00ae8b991b5b3d9d,
+          0x00ac3d940301cb0d, 0x00f8077b72aa8c2e, 0x0000b459f8549b67}},
+        {{0x0060a0418ceed077, 0x00ed964e64d38a1a, 0x00d76c880dd17351, 0x00a9313c5ec98a30,
+          0x005263d223040fcb, 0x00dc0873e419e50d, 0x00005d85a53b1a3c},
+         {0x006843c93bd44a63, 0x00d3126922571172, 0x00ce184a67b3162b, 0x00b389fc99093a3c,
+          0x00a25d6cbec25f49, 0x0054b98821844c26, 0x0000f27853f9541c}},
+        {{0x00adbb83150f9c1b, 0x009535bcaeb56cac, 0x0069df7e5183802a, 0x00a7b15e11ac71ce,
+          0x007db6b4964f30cc, 0x00cb6f9f18576cc9, 0x0000d2e813e2d8b7},
+         {0x00bdedeadae85ac9, 0x005c098c4b0846d2, 0x002b2393b3d5d957, 0x00bca32b2f742645,
+          0x009fcac508e33685, 0x00884d95e17d3faa, 0x00008dccd086619a}},
+        {{0x00b39da6d89f1162, 0x0091a6354c7e1a0e, 0x000bf08596406998, 0x00d631d06bef12df,
+          0x007c24c0d6d99d1e, 0x009679ecf4863794, 0x0000085bca8c6c8a},
+         {0x00501ec08e8305e9, 0x00c1f32a29f6183d, 0x000df1ebd1799072, 0x00b065d78ce64a44,
+          0x004ecc40aaa5efe7, 0x001cc52ed806f872, 0x000023fce909a8cb}}
+    },
+    {
+        {{0x00fea69f3d36263b, 0x009abb9fef7208ae, 0x007f84bd843400ed, 0x009374df94329175,
+          0x0093f34c2a8f6998, 0x00ad3f1d2f03cf2e, 0x00009c9368184ead},
+         {0x006baaff916cde09, 0x00497dd62df5b091, 0x00423a0958b08317, 0x007f1317eaf5d41e,
+          0x0048973d8d7d6d6a, 0x0086050a41b8aa3d, 0x0000953b87430284}},
+        {{0x00794d81bc7c0795, 0x000872bb66b55dcc, 0x004004ff152b3ef7, 0x0087164fe9d7b9e3,
+          0x001a332f16543ced, 0x00006296880dfc87, 0x000096b2eecba9e6},
+         {0x0080a433d3eb1cca, 0x00e3fd0bbac0918f, 0x00eea8ec664e27a8, 0x00b2cb7d0e738590,
+          0x00ea27c4aa3dd92d, 0x0031ed76c846cf37, 0x0000b9fb524a87b4}},
+        {{0x00efe74c5f35558b, 0x00103a23724de587, 0x00989b5e91ce6d48, 0x00e3d64a15a5bad5,
+          0x0005ca0e4264b7c0, 0x0073df18a39f6c76, 0x000088bfe8d90f8c},
+         {0x005bd614476337ef, 0x00ebd67a15fd0be4, 0x008bd2e4b5c80659, 0x00d1926727c50a14,
+          0x00abf0c7a5dd2edb, 0x00fe1bbe953f28b0, 0x0000bfe1f4379bf0}},
+        {{0x00221d68bee8ccb1, 0x00499d1f6b9b0d9b, 0x00f876d13a03848b, 0x0043fa794a9d7342,
+          0x0057e42a18e4a403, 0x00d6b4e1a231283d, 0x00000f832d2a55b7},
+         {0x00160dfdf3412ece, 0x001bda31132bd6fe, 0x0089d5ba5f749c3e, 0x0052b90cacf8b5b5,
+          0x006c945916298253, 0x00e0d416fa4cd4e4, 0x00002874145b88d6}},
+        {{0x00b791bcdc4ec9e2, 0x003c118121699952, 0x000ca162e705613d, 0x00ffcaad3026d965,
+          0x000c3551e0799dd6, 0x009f1aff2454aa9a, 0x0000f72aea8ed49e},
+         {0x008d917e9225474f, 0x005c979de5b980e6, 0x000c55560a665c5e, 0x002cf6280a204077,
+          0x004651753fcf9453, 0x005062ab567808c3, 0x000032e6b66c1737}},
+        {{0x009861e57564ba48, 0x00220ee94ce8d533, 0x0033720c83c577fd, 0x00b0727f8af842c1,
+          0x004fdf05e30c6064, 0x0067cc3c3e347860, 0x00003a21b95a97b7},
+         {0x004c861417c40543, 0x0066d1afe419d731, 0x00e133b893c71d5a, 0x00323a2a0e467ee9,
+          0x0015dbdecb7c1ada, 0x00e6aebadd6515ed, 0x0000a851ea6f24d1}},
+        {{0x009c2148c445b804, 0x001033ecd229feab, 0x00a9d47a981b3422, 0x00514ca3ae8f97aa,
+          0x00e72d0fa5f34a7e, 0x001d8a5cfe14280d, 0x0000449c1d3aac1d},
+         {0x00066741020b0fc3, 0x00af0e4dfc50672d, 0x00ebcf7911d75280, 0x0095eac5801ef940,
+          0x00322c1fa617a391, 0x0046ed50b9a82648, 0x0000e796c7641fde}},
+        {{0x00e0f165327974c6, 0x007c477c5545a6c4, 0x00e8f53119096ce3, 0x00ec25d181ec8d45,
+          0x00437b7e3713e5ff, 0x009e4487e7f0ad13, 0x000021c214699ee3},
+         {0x00db4ea1cf4b697f, 0x00e51728350cfcfd, 0x00ff7e13eea6df21, 0x009e9b2e1e1d78cf,
+          0x00108c9293763965, 0x00d39801169a58c3, 0x0000086b02ff068b}},
+        {{0x005fff8ea2c178c5, 0x005e29debca66530, 0x00ef0a7b5fb79c34, 0x00796eba865bad7e,
+          0x0074b28da7831b38, 0x00fb1371f7d520a2, 0x00009370ea5fe0c2},
+         {0x0076b5148ad870d1, 0x00b3210c3405df8b, 0x009a15ded032549d, 0x00629680c944d30f,
+          0x0028703138eb6eff, 0x00c374872aff4ccc, 0x0000b3dc1bb39659}},
+        {{0x00556bdf9c93ade0, 0x0020810f97aeb53e, 0x009b329dc851f809, 0x00fd979888cadaf5,
+          0x00d6f0e98f2c675a, 0x00e0df9f76c6f4f7, 0x0000047d48bf6ea2},
+         {0x003e8a56813eac91, 0x000ab4a455f355a6, 0x0072f7294b667347, 0x004ddda7f0e1910d,
+          0x0043c333e89fe34a, 0x00e4376641ff1edb, 0x0000000147ac8061}},
+        {{0x00256d05c51e32fc, 0x00261f7fd8c54d12, 0x0056e41cddc97ed0, 0x00d9f46cd33400df,
+          0x00fba9c259f3d650, 0x0011497019761f58, 0x000015281375024f},
+         {0x0093a432ffc31d88, 0x00a18041c904a46b, 0x0018a2705d253b4f, 0x007f330a54187596,
+          0x00b49e46ab6666c8, 0x0021af0da077906c, 0x0000def0fc8e2fce}},
+        {{0x0020193a4e83a0f8, 0x00b4a0f3fe02eb44, 0x008841fddb8b1527, 0x00c15f0a5c81c279,
+          0x006182c6917f6f72, 0x00bd76e8a8eee8ad, 0x00001f8e739b799a},
+         {0x0022a5575a88914f, 0x00784e7290f3ea1c, 0x007abf925076b5a4, 0x006d57153685dacb,
+          0x00fef97981b0ee9b, 0x00cb33ea7340dc6c, 0x0000b9aebc15fac9}},
+        {{0x0026cdc940d7eb47, 0x00b5e73abdb4417a, 0x005491e63b44a1e5, 0x00003452b7a0ee6e,
+          0x003d4210fbccec6e, 0x0013e0b33a0c7a89, 0x000026fc96123453},
+         {0x007e375ec30e291f, 0x00128ddfadc9089e, 0x002fe848726d7392, 0x0079aef37ad08248,
+          0x0052dfe3bb022ea7, 0x00e2e3401eb8f9ff, 0x000085361723d653}},
+        {{0x00d3f22156048cd6, 0x00f32d76988a0f1d, 0x0082b20a073fe5f8, 0x00359639d6176d31,
+          0x00561620d4cbaade, 0x0089402f75709a67, 0x00004e9d52ecbb1e},
+         {0x008dc806050b91a5, 0x006f2d8055159580, 0x003a36668222c398, 0x00c984961ee8a6de,
+          0x00d44d6d9eea0baa, 0x00d6fe8ac56ccbf6, 0x0000f81ab8032702}},
+        {{0x005dc7d42deb4eca, 0x006f44bcb6739229, 0x0051376f36916a0b, 0x009a0502f24b4a06,
+          0x004fcb00d7ae31c9, 0x0000c6f3467a3788, 0x0000d74d55f7f2a9},
+         {0x00d8374c03499a6b, 0x001c70f78e94ffb2, 0x00c814e9467cf486, 0x00af6d0b2d0b8251,
+          0x003162901ea9c715, 0x00e3da611ec5ff20, 0x00009e34b13df5d1}},
+        {{0x00f0dc986e9b7750, 0x0022a69f4bd60b42, 0x00e5658f242d100d, 0x00dabde87f0882a7,
+          0x009b715dd7d34b0f, 0x0073afeead3b9b60, 0x0000769303ca5230},
+         {0x00e7491e51f56b64, 0x0084dd726eedf516, 0x00d1ffa92d220752, 0x006c84682c2ba690,
+          0x00af63c84adabad0, 0x00bee9892d237589, 0x0000502de02c6dcf}}
+    },
+    {
+        {{0x004a459a6c91ad26, 0x008ca2371da83379, 0x00283933f3e96b25, 0x000df0fafe9ef815,
+          0x00f2318d49baf296, 0x008c4ff9bc786c01, 0x00003dc56a32127f},
+         {0x009b33e950c23814, 0x009dde468e6a0532, 0x002cd1b32a37a42f, 0x00c8acaf2428c3a3,
+          0x00b2cbdc2103c6a0, 0x002f759a7eaf3243, 0x0000ea9ec23dcfc8}},
+        {{0x009ebfaa9c3fa9a3, 0x00227fa7fbd3b53a, 0x0074cca16eb81333, 0x002163ff3dd5a30f,
+          0x00ec501806f82e2e, 0x0084351a403c5de5, 0x0000797fb73b7511},
+         {0x002c3035c71ecf44, 0x007323e139916fb7, 0x00dd143620e73f99, 0x005af00c250551fa,
+          0x00df0396c50df58c, 0x006ef7597d30ae28, 0x0000114ab08f4f49}},
+        {{0x004416cb26aef425, 0x0070d319c5a0c4b0, 0x00eda552ca6d122a, 0x00a776d0db3fcbaa,
+          0x008ff2c2fe5f0b3f, 0x00c5de04dedcb67d, 0x00005431fa786b1a},
+         {0x002161bc084a5248, 0x00f99e18e9e4f933, 0x000467923ccf495b, 0x00d18032f1705d53,
+          0x00b49b07b70495b7, 0x0095824d5d931c43, 0x0000f0313e1ccb02}},
+        {{0x009d76b04005df08, 0x005f4488b021c3ba, 0x0051379648368f3b, 0x0004e8babda60b1e,
+          0x00433ff4176bddc2, 0x00d129817641e518, 0x0000bd525d30f236},
+         {0x001b5526b4a549dd, 0x0098ce867f776188, 0x00174e3f0f62ed79, 0x0025107b5352b986,
+          0x00830e25a32cf131, 0x0088e9362e9daeab, 0x0000c94fcc281aca}},
+        {{0x00e2f31049f7893f, 0x00fe7f316b307a2a, 0x001df823a1575a67, 0x004c7bc0b97f9f7f,
+          0x00c3c4231b744ae5, 0x00ca01caa45a8669, 0x0000b403f894c9ca},
+         {0x00a101955d3a32f8, 0x00f0306490ac027c, 0x00e7a265cd63864d, 0x00ab817f676c7cd2,
+          0x0002a2ee09367c96, 0x00249fddf9488587, 0x0000e42b16f1f880}},
+        {{0x00a4ca5f954be6a8, 0x00ba35d611b2cecb, 0x00d7d90e259c7ceb, 0x005d40439b656503,
+          0x00168febde8633ed, 0x00614ba76d6a4fd5, 0x0000d3d49ea8607c},
+         {0x0042eec828269279, 0x007ddc8b37c9ea40, 0x00b3b0ae7507e826, 0x00352c274845c0ac,
+          0x0034ba160dbb4b8a, 0x005d52d3902d5ff3, 0x0000bd88a0c1feec}},
+        {{0x006c5f9bab8b5b1e, 0x00f018ca9da950eb, 0x007eb92f9feb8fef, 0x005911192c5c95fc,
+          0x0001cbcedb98adb3, 0x00ab7d7b46cd2c61, 0x000024334c46f618},
+         {0x00ef7d4df4cd6fef, 0x00ee5db355c4db7b, 0x00372af979d87b8d, 0x00c4f23846a0a64e,
+          0x0094077844a955dd, 0x00f722e18a295038, 0x000076d458a5955e}},
+        {{0x002d567c285278af, 0x00d286cc463b49c5, 0x0021071e6d411c79, 0x00d81a406db6ccc6,
+          0x00bb390935700204, 0x005ab5dbaad9771e, 0x00004843250b787b},
+         {0x004ddacdfb0f1b8c, 0x00d51b5e99634615, 0x00ae373a76b45680, 0x000c49eb7c2d6066,
+          0x007aaa33295be142, 0x003c6bec6d6c24f5, 0x000005347f74762d}},
+        {{0x006a64c04b0a79f3, 0x00d6db86681c3ad4, 0x00de3428f01e8b2c, 0x00ba37b2392433d5,
+          0x00cd75e6750b279c, 0x003a3f95b7d4ccc1, 0x0000f478e65377f3},
+         {0x00e3db02f7374ab1, 0x001e9dd9182e642d, 0x008db614a07611d4, 0x0024a4dec3278d64,
+          0x0057afe4af2cfdea, 0x003704cee7dbd4ed, 0x0000ae1569c95ec4}},
+        {{0x004cb67784983052, 0x00dadba92ed92078, 0x00074624bf34f15f, 0x009cea6ac8e22acd,
+          0x00fe4edc2ae1892e, 0x0060ea8e90b0cb57, 0x0000d8237a49706e},
+         {0x00c5236fa3858830, 0x006b50552e2bdfe3, 0x00911d1289dd74a4, 0x00e30b9c2818f56b,
+          0x009c21b1160d9f4c, 0x00201678af86d493, 0x000001134ba43dfd}},
+        {{0x00b41eeadb07a28a, 0x00f56cf9ea371599, 0x005673a7cb0aca1f, 0x006481e45e0aed5b,
+          0x006e144fc72ff629, 0x009ed1a79b2407ab, 0x000023e884cf9baf},
+         {0x00399b7a8a2de0af, 0x0089ebb45a7527a4, 0x007f54d6720ef6fc, 0x0061fb94f2efcaf9,
+          0x00f2c80b305814fa, 0x005cfc6931a9bbb1, 0x000042a01723b379}},
+        {{0x003f39579825529e, 0x00456e7c4ec08d40, 0x00ae5974d5136f69, 0x0008e3de185aa1c7,
+          0x0022a5a99801dcf9, 0x00f247c51c61c837, 0x0000e3c24012bbcc},
+         {0x008378a7bd2c240d, 0x00d98c8084f2254d, 0x001d91a97f212771, 0x002e33f9c568340b,
+          0x00630aa9dc1ce03a, 0x007f6b10e8fabbda, 0x0000f62afb2905c9}},
+        {{0x00b0f241911aa294, 0x005078b7f12b72cd, 0x004eac66e7844272, 0x007fb6624ea384d1,
+          0x00d6f35904227dd8, 0x0051fd0818db0f00, 0x0000af4d4f4a3858},
+         {0x0093b16835a166d8, 0x00de948ff16a67a8, 0x00eb41447fbb400c, 0x00a31b0abecb96b2,
+          0x002bfb9249845025, 0x0074e8100f5a86b3, 0x0000691682244b08}},
+        {{0x0088b6dde659edef, 0x009ce34ffbcf4aa0, 0x00fa08f89d1e5586, 0x00ec68a8355fece2,
+          0x00c6485abd4297d7, 0x007a1de6af1971b7, 0x0000a30f3010d0cd},
+         {0x00e73bb476b35742, 0x008ef92cc7fb412a, 0x0046ca25c2c94b55, 0x00bc3f33ecbf557b,
+          0x001a1b7f210d0f0e, 0x00ec9ccec3a16fc0, 0x00003e22ee543531}},
+        {{0x00d82a4b6aa42db2, 0x00c2d696662b67f9, 0x002ecc6b4d31aad8, 0x000e152e0b01dae3,
+          0x00b83f76e362e546, 0x00cbe9df322c97f7, 0x000010c78d33c4f1},
+         {0x0090a6bd2232293c, 0x007ea7f2ef25463b, 0x009007e5eb8fd959, 0x003bafabcf4414c7,
+          0x005faf8fceb27f7a, 0x003a815e59358965, 0x00002d37f1ea8f95}},
+        {{0x008a33e61b635020, 0x009e7b1c6e73daf6, 0x00e02d8d837866e3, 0x00d51abd7c18b1c2,
+          0x000435fa14b81ed8, 0x0009a01940113c40, 0x0000c57f71954621},
+         {0x00c34da2279cac7c, 0x00a7851b8ec4007e, 0x00b4eeeeba471abe, 0x00d21eda2a25f6a9,
+          0x00f2e50d7379eac9, 0x00abd908402d5a9a, 0x0000d1137ea3c0b5}}
+    },
+    {
+        {{0x009adac418ae2aa1, 0x00c221f5e4f83693, 0x000f99eef87dbc7d, 0x00550d64219055df,
+          0x00cea1db1632adfa, 0x00b3cd3fb65042ec, 0x0000522aa0f6a47a},
+         {0x00fa6cbce073d866, 0x00d9f414ef8a1b44, 0x00e66498df674078, 0x00ffc3ac60e320ed,
+          0x00c2f85b466c77a3, 0x00dac956b4d70c88, 0x000061b26784b039}},
+        {{0x004f66efa821c05e, 0x002a4c288e371dc8, 0x0086ded4b1cecf2b, 0x00268824e51871f0,
+          0x004ad9dd71a66cf0, 0x00d12d545bad751c, 0x000056a70fdeb2e2},
+         {0x001f83d5946bf3ad, 0x00d97fb9d43975b5, 0x00ea7738045ef89a, 0x0010a77f41909320,
+          0x00a3bb44cbff1882, 0x0091297a0752d185, 0x0000c0847b358672}},
+        {{0x00908842b7bd7efb, 0x00db62cc05321259, 0x00bd11e013ff9231, 0x009d5d69cdc9a708,
+          0x00215c8ae565584b, 0x00c267e7734600a3, 0x0000ff0e658ec6c3},
+         {0x000fc1bf2b27e18f, 0x007ab0e0c7992604, 0x00326fdf166c9e06, 0x00b80836fc19476a,
+          0x00f8740c37430b7d, 0x005e6a9a7d11c5d3, 0x00003e340317352d}},
+        {{0x00f591a2a54b9dc0, 0x008a4ffa7a9c9b30, 0x0003f4606cc05951, 0x0001e5aab3a82c5a,
+          0x006c6dec168eafc7, 0x008a8e711460cba3, 0x000019241a40d65d},
+         {0x00c2365ddd9bf33f, 0x00d1bf1ab47c3045, 0x00d3cf6c6b0f19dc, 0x00c4ecaf7f0fb8b8,
+          0x0059e6ad55b9a83a, 0x002b131ef01867ac, 0x0000db6e3a5e2faf}},
+        {{0x0042a2f1f6a518ee, 0x004d492b2211a3b3, 0x00884baa225d1c39, 0x00f7de5c0f8965bc,
+          0x000956983ad6fc3a, 0x0051a1834ccbcb52, 0x0000e034a04747a3},
+         {0x000093f711518bf4, 0x008657733e6c8293, 0x009d41fe89e0a2b5, 0x00409e4c70e2b792,
+          0x009bef9da47336c6, 0x00060bc3376a7e08, 0x0000e738f72ac4a1}},
+        {{0x0010a1a6b8182142, 0x005361f8e586998c, 0x00183bbb2783f907, 0x0018ce08f5ad91e0,
+          0x006398be73aa5e48, 0x008a26af831a49f1, 0x00008326ad9acb96},
+         {0x00762c4deb8ed330, 0x00ea859112bec4cf, 0x0074abbc7f7c4a9e, 0x009a3b6f3aac357f,
+          0x000385e0ad7df2dd, 0x00d6e81a7c8f8357, 0x000045f0648cf131}},
+        {{0x00dec75ad81edee6, 0x0073a7ac72f95a3e, 0x000576a0aacc8557, 0x007ebb2a4908976b,
+          0x00e2e8a812642ddc, 0x00e87276bfefec5b, 0x0000272e2556226f},
+         {0x00e5bfbed378aaa7, 0x0044f419b49723c4, 0x006cafd7cb4b102a, 0x00543dc0f4e6a126,
+          0x00ea3712a8c04cac, 0x00a41c1e2dafb272, 0x00007622a26db238}},
+        {{0x003d9554b6ca9da5, 0x0012ab3b066f6217, 0x000126a92fefa2be, 0x00eb642cb12746e1,
+          0x0050ac0df85098a6, 0x00d69407951ffeec, 0x0000821c76bb40e8},
+         {0x0029388e11836d15, 0x00074c756b176c95, 0x00f80984ca6d316e, 0x00e78c0cf12ba847,
+          0x004e10dbb1e2d2ce, 0x00a86c51d039963a, 0x00004dbf6d739e40}},
+        {{0x00b0723e95b273ec, 0x000e2a78d76f51d4, 0x0062e238105d243e, 0x00ec4ee559179c16,
+          0x00fee7575da75b4d, 0x00821424c05faa98, 0x0000f76ec97b9d58},
+         {0x00446684a7d85cf1, 0x005ae0f1215e9f4a, 0x009f075590c81e20, 0x00622f6b7c885f56,
+          0x0052f7d510b2f620, 0x001cc14d3b407589, 0x000006ba01444e84}},
+        {{0x0099b81576f784bf, 0x00fb4b57e4b131db, 0x002383eef8046866, 0x00f76f8abbf7703a,
+          0x00ea4d8f93ae5f07, 0x00a6f6381142c8d7, 0x00006ef44987c71f},
+         {0x00c51b425c31b984, 0x00eecf6d7a5e97f4, 0x00b0438d668950a9, 0x004979c1b426d080,
+          0x005ac340e483845a, 0x00bc75d71e5adc19, 0x0000511f6f41eff2}},
+        {{0x007d4d90b2670c8f, 0x00323eceaf605155, 0x005bfaf65cb2d71d, 0x0067d9a75f626a88,
+          0x007bf09e9f3ecd86, 0x00999b90986f1567, 0x0000b610bf5eb7ea},
+         {0x00d15bafa95b6643, 0x00741eed9619b3c5, 0x00867e66881bed24, 0x0055623e923a3e5f,
+          0x0029b770484babe2, 0x00abcbc3da0de65d, 0x0000214bc496d1d6}},
+        {{0x00d44db13dbaa7a7, 0x00edab5ac53c6d4d, 0x0070e7de876729dd, 0x0035e67699c3627c,
+          0x005c07ea8f07dfcb, 0x00e375e1695ac55b, 0x0000e4b8c36b8356},
+         {0x00c312904b335c30, 0x00d0310fc138de29, 0x00869fa4860030f3, 0x00faa5a19c8d665d,
+          0x00ae814094c24fed, 0x00ccd9212a8bc542, 0x00008b795f2d8566}},
+        {{0x00b89ef80c779752, 0x00f638c86c44c93c, 0x00c3197a076ddcc9, 0x00df5e9880644376,
+          0x004565a84d34891b, 0x00f366a0b5845036, 0x00001ee34675706c},
+         {0x00b84aeb821f1119, 0x000197d1ed603f82, 0x002fbb57bb3f1e80, 0x00396dda1a9961e1,
+          0x00097744fdd36bc3, 0x009ada795a339e32, 0x00009380f5f4c378}},
+        {{0x00093301c83a8917, 0x0056d08dc2f681fa, 0x007e945b0be05df4, 0x006af992688440d5,
+          0x00b66b4226dec237, 0x00c09496e3fcf401, 0x0000fab259d7b24a},
+         {0x00e233299cbec688, 0x00f9b989ebd9d2e0, 0x00889118b6138037, 0x001cfe6dedd09e00,
+          0x0031be35388748a6, 0x00cbde11f3f50233, 0x00006fa93a747793}},
+        {{0x00c5105b878f951b, 0x006ebbbd87844d08, 0x0088bac016e33c92, 0x00116effa7ddda17,
+          0x0015f10e8895caf4, 0x00752dd8c2574b35, 0x000089d188f64567},
+         {0x006b27ab8f31c20c, 0x000d97846cf9317c, 0x0038db3fdecf87e7, 0x00d9b8a35bcba35b,
+          0x0094b9a2c6ca4733, 0x00742a4826bc08c4, 0x0000a57ef0c51237}},
+        {{0x00792c327a7bb8a3, 0x00ce8de3e686d99e, 0x009afd24b48aaa90, 0x0080fcd26886af08,
+          0x00716db9504ecdbc, 0x00d1cef99a4e1c53, 0x0000a0ff480d0a5c},
+         {0x00bb9491d8e08f86, 0x005d369725b87891, 0x00c8040ee8afb45e, 0x00887d9ceafdb42f,
+          0x00ea28877abe4798, 0x00680e762efe4b3e, 0x000028b1026d7de9}}
+    },
+    {
+        {{0x000d705650f68e44, 0x009ad0f42da48b76, 0x00668c57cca16a7f, 0x00d957bf5bd71db6,
+          0x0003288782cff2ac, 0x0015f2c8180ee16b, 0x0000b090a525abf0},
+         {0x00e162690b0f97fd, 0x000e33248e0ff80c, 0x009ee921e5270b56, 0x00b09ae690e51492,
+          0x00d9feece4fbeb47, 0x0085a19b109f6fea, 0x00001afdb422efd9}},
+        {{0x009484ce5f16fbd3, 0x00b6bccc6f8e39b3, 0x0051245976ea3f42, 0x005699850a29faa2,
+          0x00359c26de1f39cb, 0x00d3dd1c5a634fd3, 0x00001fa0bff7f99c},
+         {0x002a0c9e0e248cf8, 0x00e0260c7ac8acb5, 0x000bbc847fc03316, 0x00ea678115dcb885,
+          0x0067321857bc5ca8, 0x009f358371caa050, 0x0000f08cd218167f}},
+        {{0x00e416b295e02f5a, 0x00f2c7339663a791, 0x0094f12a9ca32ee1, 0x0010e11bdab06a7f,
+          0x006383958d3d7cde, 0x0043ab3805ec48c4, 0x0000338687e4171a},
+         {0x00ec239d60aadf43, 0x008eea352e1f0971, 0x00bc2f3837d6c8d8, 0x00944b62898f264d,
+          0x003b0abb09ccc3cd, 0x000c9a3352e2c3d0, 0x000009fc0b2b4b80}},
+        {{0x00e2798da22fd201, 0x003a5f496a4e520e, 0x000e01887409cf4e, 0x0090f1c750cb7836,
+          0x0001b123d72e7d27, 0x007dc66d9135fafc, 0x0000d7a0aafa0472},
+         {0x00af4dc328997d31, 0x00fca7b212cd3a3e, 0x00d2a1f86b495d3b, 0x0098ed293fa41158,
+          0x00808db69aa1ad64, 0x00075276940e40f1, 0x0000e3bfdebaa1dd}},
+        {{0x00a03ff52d404c95, 0x0046d23f9dfae433, 0x0077a47c6681512f, 0x00658b6fb3aa52e4,
+          0x000f4ad7aa91678a, 0x00d274ee6aa42dc2, 0x00008402a764e88b},
+         {0x003dfd5e547995aa, 0x00fdbb8b7848ff3d, 0x00a1ba133b8c963f, 0x00be42815f52c2ed,
+          0x004dfb7d9dd2f10f, 0x0052391058226e37, 0x00005ae18cfb8dad}},
+        {{0x00728e425c013fa1, 0x004044814db46925, 0x0074f0d231ddc02e, 0x003302b88dbc0262,
+          0x009374dc048f81d3, 0x00e1b13b590fad17, 0x000019b9bfac16a3},
+         {0x004234b4215aeb50, 0x003385ef42bdb351, 0x00374e21d428816d, 0x00f1ca853ce6eaf4,
+          0x00da84520ca9a6f2, 0x003345a8087162f5, 0x0000945e49007d82}},
+        {{0x00011ccdcf8d5c55, 0x004250c6346cbd9d, 0x00f68407129b3b62, 0x00f6a6ca9eeb1082,
+          0x00d4e2e4687b53cc, 0x0065a8187c0a9293, 0x000093c940e47a9d},
+         {0x00b3782d1a745e09, 0x00020beea2945846, 0x00bbb314fbba4d8d, 0x009142be4c2bc5da,
+          0x00f89ee0bdaddf5e, 0x006a3aef1d31a0f0, 0x00007f9c50ff6536}},
+        {{0x003f191c17ea438f, 0x00dba6c23228fa4e, 0x00328fb219326ec8, 0x00c623f9acdf7d82,
+          0x006a2fbbb26d29ee, 0x00a18441b236a9a0, 0x00002a164f19edb4},
+         {0x0046e89bdefe745f, 0x00c3d3772114221d, 0x00cc315d4ff51602, 0x0019fd17d85e5510,
+          0x0065b29a8001d9a1, 0x000c83faffc22d65, 0x000034da388c66d5}},
+        {{0x00ae5ddb8df2179d, 0x004984bed46b14dc, 0x00ef9e29068a2dbf, 0x003ee18f955db8a8,
+          0x00a75f354f6f6234, 0x000095c286566b29, 0x00000526c1ce843b},
+         {0x004e702724794754, 0x003614134e6fafff, 0x0060b17e3befb9ee, 0x00e754d8ef40e814,
+          0x0033d912cb884816, 0x00db67caed1ab5ea, 0x0000fedbd1ee66ae}},
+        {{0x002b726f49838852, 0x00767864f96de636, 0x00ee5039c3cdaeb2, 0x0089654991362b8b,
+          0x00f08a2438860b39, 0x00b6197146674102, 0x000056a417464b41},
+         {0x00f3969575fbfc2e, 0x002c233b53549e1b, 0x0065466146a2dcd1, 0x00065052a53547f6,
+          0x00a8e7ead01a8f51, 0x0097a37ce5a41e3f, 0x00008388838811b1}},
+        {{0x0064ce411199cd4c, 0x00e0cd3487879c24, 0x0029b983886168e3, 0x0026b81f31ca2d96,
+          0x00afcca8b4c00011, 0x00e80bddc4fc1362, 0x00006d04c469ace7},
+         {0x0069359ffbd677c7, 0x008ac31ee9fcb967, 0x00f4b6b90312c6c5, 0x0094f8aed6a4c948,
+          0x009aa88f3f02a302, 0x003a2c40356e17f3, 0x0000968876ecd2c0}},
+        {{0x003e92558232343e, 0x002bd98f4c4d3952, 0x000483e94a44edee, 0x00d7c6b2ecdd2de7,
+          0x004170f764c8e33b, 0x002ffa1f48641136, 0x00007c93116cce87},
+         {0x007ef239618557c9, 0x00912c65bfe6e017, 0x0080996ea2031909, 0x00fe63aed2318e5c,
+          0x000a7ca26f58963b, 0x005ee50b92997cfe, 0x0000da2498721106}},
+        {{0x00c75fdae1309e6f, 0x008a75acb7b06847, 0x007d4274ae03deeb, 0x00f0194c618ab213,
+          0x00347ef7e75a10f7, 0x0035c19a37779262, 0x0000777ad2a7ff7b},
+         {0x00e65ad8404c9796, 0x004c641b32133bdb, 0x00e569d493c27b82, 0x006d935e92c54701,
+          0x00bf30093f2fa4a6, 0x007aefb8544493db, 0x0000d4d9e49618fc}},
+        {{0x00b9b9566dcc917a, 0x000d285f413c45a3, 0x00a54f5aae59f410, 0x0015248aa89ea992,
+          0x00e134ba3fee242f, 0x00272f13b0e85fe3, 0x000051ec49cf0152},
+         {0x00f1af8cbc12821a, 0x004deb0d88756c1b, 0x009d38aee77cab18, 0x005f90d187cd4ee6,
+          0x00063efb829d1df4, 0x006e2cf5301fcd97, 0x00009c4c4f92c8a7}},
+        {{0x00d7fd686afec6a3, 0x006b1660cb1f072b, 0x0008d9f51e6ee4fb, 0x00d19e8664c0f7b4,
+          0x0087a29e74fe9245, 0x00aee7667fe8aa42, 0x000021ccd8fff5bc},
+         {0x00c878a5a1f21c47, 0x00e2127fb32813a8, 0x00cd7cf337738cb3, 0x00b49869a2d362bf,
+          0x00bde7a14a15a06b, 0x00e51661b466f388, 0x000033d161aa129e}},
+        {{0x0061fcf48ebfed31, 0x005a5bd17743a378, 0x00411149084eb9e2, 0x001f432c27c6d72a,
+          0x0007f912d2cc43af, 0x00fe91f1d51efb66, 0x0000dbd1ac0a1949},
+         {0x0070d0c4217ffc8a, 0x00bf880f55ad8c9e, 0x0088a72e66337a03, 0x00d514af4988139c,
+          0x005ec5476936ccbd, 0x000db65e64f13766, 0x0000ddb2b35e30d5}}
+    },
+    {
+        {{0x00ee03dde74607b3, 0x00fadf8dac9e8ffd, 0x00adde1a4155b196, 0x00659ad67a81e564,
+          0x0055a250db6842a8, 0x00cdcbecc10c04fb, 0x00008aab822f8d15},
+         {0x002e9d80e6ce9569, 0x00e6a1a0feb7433d, 0x0067e957234273fb, 0x00274e87a22d76ab,
+          0x00c3ae4c4f74c9da, 0x005a1507bea4732d, 0x00002a001cd383b9}},
+        {{0x0039babfea22e778, 0x0084acdf3cf2e101, 0x00d804c9e381ec62, 0x009e1e75ca802e7e,
+          0x00470675efb3591a, 0x00b5b5d2f9c128cd, 0x0000f59328c85bc0},
+         {0x00d17b7a18aac609, 0x006b59050839cf70, 0x000c7438e95ee4c1, 0x008dcdf8e3d51d3e,
+          0x0092ab4e682cd98a, 0x0013aaca1499c825, 0x0000850a3c8a8256}},
+        {{0x008e88aa7555b977, 0x0014f286745cbb5e, 0x004bf6e85a40030e, 0x0020a7d2449e14a1,
+          0x00ca4885461e1b14, 0x0056325962c192e1, 0x000063e99e636f4f},
+         {0x00cfe4356a639e48, 0x0098872c85b74f28, 0x008ad8c60ce786f7, 0x00e1e35a98703f61,
+          0x002597711e07a2d3, 0x00b914a2bb6d0a3f, 0x00003849a8540729}},
+        {{0x00ec9a0b36e88e43, 0x001f6a9c21fc9fdf, 0x00dff737724c43f9, 0x00101f9d5977160b,
+          0x00b7ee8659e4ba18, 0x0025c8afc2eb489d, 0x0000102752389ebb},
+         {0x00890252a9fab8e2, 0x0054257425764616, 0x00721f0ecd4c2c90, 0x00cce3aab9b0e226,
+          0x00453430314fd820, 0x003ca3ba5f44f377, 0x0000fe95f108744f}},
+        {{0x0052a0eb1a7a939c, 0x00b24b751227df06, 0x00f95e52baa8238e, 0x005e222229af04c8,
+          0x00065e34aef4c94b, 0x000b3df4b1da1777, 0x00001ffb59ef55a2},
+         {0x004cbef15892a4af, 0x00220d503a59afbb, 0x007d00a38c249f45, 0x00364b234fa8209b,
+          0x0050fffb41cc7df1, 0x00e4bc477243fc94, 0x0000370b41ba8eea}},
+        {{0x005bec53c82a5064, 0x00f0bb47d7de0de9, 0x00651f092a1aa1a0, 0x00fe229351af46a9,
+          0x00bbce991511fcce, 0x009f7e696f7b54f9, 0x00001f93132c9e92},
+         {0x00a2a30409da9b11, 0x00fe129f045216ae, 0x0003f4fd49ab0b85, 0x0011ad43c204cd29,
+          0x00f2ae29ab4c6b26, 0x00593a2c4da27ee6, 0x0000fe450ad5692b}},
+        {{0x0057c955228f1baf, 0x0076efb0927dbf23, 0x005babd71c750fb7, 0x002284fcf98f5211,
+          0x0021fcce7a6165c1, 0x0057d1155e212ce0, 0x0000ddf85658d974},
+         {0x00da566dbaf97106, 0x00b0fec7064701aa, 0x0037ca9c6b7da048, 0x009023920134adb4,
+          0x007d145f7c3e1305, 0x009d64b54fcd5930, 0x0000df2797667d87}},
+        {{0x00ce030ecea1822c, 0x004f4dc763059496, 0x00d6009ccccd0127, 0x006cf597817d0481,
+          0x00ca9f4649ecc4dd, 0x0007bf19c08e60a7, 0x0000ccbf70ae81c5},
+         {0x001c81d16a34f444, 0x004f539b33ff075d, 0x00f2fb9df0845ca5, 0x00af691fd850d85d,
+          0x007eaa60b354125c, 0x00e7bbd00ed3662c, 0x00008828e730fe1d}},
+        {{0x009ab17e7a3f3daf, 0x00d6963d1b784030, 0x004aef5e6a2dbef7, 0x0031f9dd8c2b77e7,
+          0x00fcc0ad43ce53e6, 0x005d9855f6242307, 0x0000848ea1eb0c4f},
+         {0x001fcf026e472d6e, 0x00b737216c25e282, 0x00a6ba4ef1bbaf26, 0x00dc5336cec80c56,
+          0x00dca8fdc753e6dd, 0x00245c1ac943a377, 0x0000ff62b9280b70}},
+        {{0x005b3004d1cfd954, 0x00e3a3d4ac337109, 0x0041b6172d1c852c, 0x0014de64d432e3d5,
+          0x008629f791858fe2, 0x00074fbea80480b9, 0x0000a801024fa504},
+         {0x007768e47276ff83, 0x00ae33e635893fc0, 0x00941f82ea28cc76, 0x002df3a8e9238194,
+          0x0024dc7e9d795caa, 0x00be83e3b47bf9e0, 0x000007488c4d0c8c}},
+        {{0x006c05f7085bdfda, 0x00e0c9ab976d95c0, 0x00229e2e43abe727, 0x005507e784ee218a,
+          0x008463447472bcab, 0x004592f3736e2ef0, 0x0000d3eca459eff0},
+         {0x002e925fe846f521, 0x00d247091bf924a8, 0x00e159e2847c671b, 0x006408619606e6fc,
+          0x00a989fcf4670309, 0x00e761ac2c66565f, 0x000023c42a4caf2f}},
+        {{0x00230cadbc038fb2, 0x0075dbb5c362ef84, 0x00468803eae60959, 0x007d38afcff157e5,
+          0x0089ca5091b5ea77, 0x00fac99f28fc77dd, 0x0000cb08920c1f4f},
+         {0x00522ea90cc00748, 0x00bb152f43723063, 0x00ecfa582574a6dc, 0x001afb8426e1fd12,
+          0x00055ee10f92cfdc, 0x0015db1cb62635b8, 0x0000daf56934c923}},
+        {{0x005fa7512f7d20ab, 0x00fd9f5c9a2e7c05, 0x008f1a8a275a42af, 0x00a8fe5e5c3b976e,
+          0x009c8c1e3390695b, 0x00691eab87a1144d, 0x00000e739696d13f},
+         {0x00b7f7d29eee6d78, 0x00c6bcc3df44d57e, 0x00c1cdc3845b83f3, 0x009136adc591f095,
+          0x0043722ea35147bd, 0x00a1828a35525a30, 0x000090cbbd22c65e}},
+        {{0x00f42330658aaab9, 0x00615dfaaf6291b3, 0x008e29f2b69ccc2a, 0x008690b03e889923,
+          0x00a5922a6e5053a8, 0x009bccde421a6b90, 0x0000e628b5904705},
+         {0x00a2df22f032ae22, 0x007d623a14327c4a, 0x0037ad09cd1c7051, 0x0044953e052ad11f,
+          0x00b9e4f406fcd087, 0x007cb57b9ed85b23, 0x0000a00cfa260bbc}},
+        {{0x0056532f44823f0e, 0x0081e47df838b37f, 0x001cb95a6b5c1447, 0x0022e7be06320b36,
+          0x008bb52d1f64c84b, 0x004e3b8d28edd66c, 0x00007d13557cd1bf},
+         {0x00e9a2417ceafaed, 0x007c7bc1e8864793, 0x0069334e3ffadf2b, 0x003f3a29afec392d,
+          0x0036701481aa8d6b, 0x00e43766a3102536, 0x00007a6ff40ddcfd}},
+        {{0x0027c5fa6ce25a04, 0x000fb49e54cca212, 0x00e2879c8bcf9876, 0x00290a08174dd8e5,
+          0x0062cbcf859bb4b0, 0x00b8f8720490904a, 0x0000d50da40edc72},
+         {0x0027b78fb42ffc5d, 0x00506e391022aec5, 0x006d6b58da78f37f, 0x00a1f41c42356d14,
+          0x00922f723f04b48b, 0x00ded114ef066a17, 0x000011ccf402afc9}}
+    },
+    {
+        {{0x008229a8d81e43b0, 0x008abd558bd4313f, 0x00dfa1ea026af9c5, 0x00425e7020318c2b,
+          0x00ca4ce0058ea1e6, 0x006b9dc6e7b862d4, 0x000095b1fa9e16e3},
+         {0x005115e0e2cbfa44, 0x00efaa5914f4c24b, 0x00f494c0cfde11d4, 0x0097015da22be2ac,
+          0x00bccb66f8032336, 0x00fd363d0bcb890a, 0x00002a25788975d1}},
+        {{0x006e31fca7e14301, 0x00e8b7fb9ee706a3, 0x00c45452c30275c6, 0x00852835d4e0fa96,
+          0x00fec1005125d96b, 0x005b5cb2014237a8, 0x0000ee1baf9eb0bf},
+         {0x00d1e1ea291f8587, 0x00ef7bc9e3d23537, 0x0052df2befcf48a2, 0x00db3c9c2fd7aac5,
+          0x00f581d9ce2328f6, 0x00a93c87fcc0c301, 0x00004cb6408ff5e8}},
+        {{0x0053d7ce8b5324df, 0x0018b1b4d4361a57, 0x006c3cecc6add31f, 0x008ce2f356c761bf,
+          0x00a01e76de049136, 0x00884d8d3d035833, 0x00000b83810542bd},
+         {0x00d3a5d85e5a3f9c, 0x00dce9bb7e546af9, 0x00750ec9829ac189, 0x009adcfe256b6d47,
+          0x003ad1dd93cfeaab, 0x00872726169b0566, 0x0000906780643e35}},
+        {{0x008b6b2aea22d48a, 0x00b361fb459fbc13, 0x004ed0ed4f86d2de, 0x0020b20885ea139c,
+          0x0008a41ea4c0483d, 0x00cdbd95b711981e, 0x0000712e80dd26cf},
+         {0x0072cd930ea38399, 0x0073c7b79c462178, 0x00ab345ba72c6855, 0x0035af610f843add,
+          0x009c428c173544d0, 0x00dbd36c5401e772, 0x00006733362086c2}},
+        {{0x000a33a1c8d698c7, 0x0043d41cbbb9c62d, 0x00037db11b7e0eea, 0x00afb6e42e29fcef,
+          0x006831ff27bde1cb, 0x0084706927300c5d, 0x0000eb4ee9b397fb},
+         {0x00b7318a5a2ce6c8, 0x008ca16ac7bdd7d8, 0x009527de0a0fe122, 0x006ef2a2cb08a1f7,
+          0x00aede4772f308e7, 0x008684250ff4e5aa, 0x0000ff92eec7c916}},
+        {{0x007fd6b427a01175, 0x00b1db5e5036aa06, 0x00cdc9df98dc40d7, 0x004f1d6f396ae69a,
+          0x00f44703ea13586a, 0x00ebb0a95e298665, 0x0000703723a0a0c1},
+         {0x00c522f6f3d4fa1b, 0x00af44a94e26045f, 0x003748d4cb3cb3d9, 0x00c2014a9e2f6860,
+          0x00d94ae3c7dc1afd, 0x006b75e419dc319e, 0x00008d1c793322a9}},
+        {{0x00349bbdbc59fe30, 0x0009ba53df3e30f5, 0x00fac319c6369700, 0x00d3d5d20ddf3f55,
+          0x00a6c91029f821d0, 0x007a73be87350cd4, 0x0000ce04c64567d5},
+         {0x008a6522a143aa6a, 0x0015e807dff96e66, 0x007d8d171e9213c5, 0x0053b10bede452f3,
+          0x0014fb1befecbc97, 0x0072623432bb992f, 0x0000adc06c98253e}},
+        {{0x00736441ea9ff07c, 0x00a8f39dea944f87, 0x00f840b46f3fc9ef, 0x00baf2c5959fbe77,
+          0x00f256d92d570974, 0x0033d22751e02032, 0x0000318cd7713db9},
+         {0x00030347ce223dc4, 0x001ab0ae24bb1aca, 0x00b3898e945bb3f3, 0x00c970df81bdd01a,
+          0x0033e16e5ab45bc3, 0x00195aaeb0f2414a, 0x00009aa28f62d605}},
+        {{0x00806b62b80e6cce, 0x009f621351d329e4, 0x001c7c16ad6fab75, 0x0017014896a42da2,
+          0x00fa3969d732238b, 0x00ff6f6224ea6ea0, 0x000025e7478c8f0b},
+         {0x00bc2520ec96a15e, 0x00452d9be005b0e5, 0x005aee94d389646f, 0x00887bb88c6a6544,
+          0x00c206f46c2af981, 0x00860af62a9ba4c3, 0x0000916c1d714df7}},
+        {{0x00da0d583175ee3f, 0x0078ebb81c30b908, 0x00c5866683d564f0, 0x00d02a2c013f3169,
+          0x003fb1f04efb1a8c, 0x003bf770d6a24f1a, 0x00000d8e6c9d281d},
+         {0x00e014ed2f57ccc5, 0x00cb563b59ca4c27, 0x00f006ad59acb074, 0x001f5e8967f90adc,
+          0x001d38bd641e5830, 0x008a2fb42aefd6d7, 0x00004aaf97894406}},
+        {{0x000d90cf71cdc8da, 0x00d97339bb3042cf, 0x005f9d4ef4f36d92, 0x00d0bcd8ab53499f,
+          0x007b9f5890d04ca9, 0x003d1a865221299f, 0x00005f8054fa440d},
+         {0x009a5c246969ad8e, 0x003b02c1b84c0ae7, 0x00a98c6b5adaec0f, 0x00610eefc3954851,
+          0x0010252a63718946, 0x00aee111e5e094c0, 0x0000e5a961336aaa}},
+        {{0x00f012c3d15d5454, 0x001faf95a48e6ba8, 0x00f0ebb41fc73b41, 0x00769c737c6d7fe9,
+          0x006def3515720e31, 0x00370c4139cc5190, 0x000013005794e4a0},
+         {0x00dfe4ea4e05acf2, 0x0063ead98633b7e7, 0x009ab1ad7d8ea70d, 0x00cbf02b95411212,
+          0x008358672c6fe38c, 0x008190816bee896b, 0x0000e0198e958e2d}},
+        {{0x00df9833faa91151, 0x009bf3dce117c816, 0x0051b37efaa33860, 0x000a6f39ab12a1d6,
+          0x006b50e61a9b8031, 0x003931298bf050b6, 0x00001215054c6cb5},
+         {0x00ba5cb9f13b7f76, 0x0006e9eb08031ca8, 0x004cc13e1a414e6d, 0x000f7e956ff191a9,
+          0x003762e90dceb47b, 0x0064c2664fecad59, 0x0000aa5143f68824}},
+        {{0x008e233e6af4f349, 0x002938a31617493a, 0x002409e086e32650, 0x000116467db86eb1,
+          0x00f1a2b91397be43, 0x0052c9df95bae891, 0x0000985f48e460d6},
+         {0x00f6a155b60c17e9, 0x00c00c967624809b, 0x00facacbff550b79, 0x00c6ae658d9c3ddf,
+          0x00990e9c5608e73f, 0x00e453b8328941a0, 0x000007504e3e0cbb}},
+        {{0x0053a753af6a129e, 0x00895278faca8de3, 0x0098ed6999f74e70, 0x00a74823e5c28be1,
+          0x0022ab16cab8c24f, 0x00161b0be92dbd68, 0x0000b6e50115dd93},
+         {0x001a3446a7137f30, 0x002ba703f094517d, 0x005ba40ce2ade443, 0x002a87718db81493,
+          0x00f2a88b57494891, 0x002e91404e17030d, 0x000055e072c2a12a}},
+        {{0x00f040bec690ccc6, 0x00cd7b51f9e5b661, 0x00de81156ecfaa51, 0x008c3782b829242b,
+          0x0089ff8b31e3d90a, 0x008e4e2f1f10d1e5, 0x000064247c77848b},
+         {0x0004d2f287e2519f, 0x00eaa6331a0e1340, 0x00996e22db4bb1cd, 0x00bf73456805dfc1,
+          0x00c4cd34e05e0653, 0x00a68093664f3bfb, 0x0000c3b58cdee179}}
+    },
+    {
+        {{0x00ef44603ad8ac6b, 0x00fe2c42003b8f50, 0x00511ec1753d42b7, 0x00c8c6d264584187,
+          0x00f1f8f8045ac01f, 0x0077f0324336bd7f, 0x00009007700b51b8},
+         {0x00e9b08108d032e1, 0x009abab45f754fe6, 0x00371e5fcfd2e5ef, 0x007bcfd9b06c5dcd,
+          0x00f80052ff4e186e, 0x003347e8d003435c, 0x000067d88f761474}},
+        {{0x00776717a6c4416f, 0x00e99d309837d52c, 0x00232538d15fd917, 0x0013b5365e37152f,
+          0x00980f28f5136576, 0x00298a8470b9940c, 0x00007df99b9b029e},
+         {0x00ae5a0232292cab, 0x0090ccdde9a3960a, 0x007119926452a639, 0x007ecec2e7e33357,
+          0x00341e339713b2c4, 0x008d5455cb829ebf, 0x0000c00054f6e33a}},
+        {{0x004be5ba8a334ad8, 0x0045d1f0aad0045a, 0x002c9cbd691c29ee, 0x00ad151feabc2882,
+          0x008b0203c7a9a502, 0x001dc09bdbec42fd, 0x000059103d7122d1},
+         {0x00a2691d6d280ed7, 0x00262825ab6007cb, 0x00dcdf2e1971410d, 0x00a6ebb0626e68a4,
+          0x00edfc77dcc2f1eb, 0x002010746aeb3d7e, 0x000024851696128b}},
+        {{0x00d32702e0da80d5, 0x00cb9b6babc04265, 0x00a0e641ca4bbd24, 0x0047a9653d96d366,
+          0x00cad4631bccfb9f, 0x008f833cbf552bbb, 0x000050877ca1ae34},
+         {0x00ac5cd5981f7cb3, 0x009d28b66fb4c3e6, 0x00596d1d937b9ad2, 0x0003390aabc838d7,
+          0x0034f332d6efa0b8, 0x00fa0730d80c1003, 0x0000ed1cc8e7a870}},
+        {{0x00e190494ad74353, 0x0045979f82d9d11b, 0x00e23bd078f07a0f, 0x00c0b5d5e6d05985,
+          0x00eed0b71621006c, 0x00b058a52a01962e, 0x00005397e17ddf32},
+         {0x009c977851ad100e, 0x00044f0b2959a903, 0x0071d53ddc7766b9, 0x001722b3a53a2363,
+          0x007516a965f130df, 0x00bce1be50a38aa4, 0x0000f20f5d16ed64}},
+        {{0x006f4c80422fac5b, 0x004e398d6dc8b4bf, 0x00b330e58dc968ed, 0x00c0956e6fcd2c81,
+          0x0032d706ab19bc16, 0x00a3ca3359be0873, 0x000061ae179f694b},
+         {0x00c0e22425d1ec8c, 0x00ccd653f91e05cc, 0x0056fdedade97dc5, 0x00deed6004fd23ce,
+          0x0004e56b877aedb3, 0x002bb0bb8eec610e, 0x0000a971820d11ab}},
+        {{0x001930c19f8342e5, 0x0036ac7b5ee54126, 0x002fb65a2b596b48, 0x000e189815d27c7f,
+          0x0073b1be8e0bb5a3, 0x0091c7217f2c562f, 0x0000c6e4f93bbe45},
+         {0x0099115c71ee49f7, 0x00eda7a502c75326, 0x00df5f4b9c8ee550, 0x00ee829b01be71d0,
+          0x00a9da8aa6217cfa, 0x00bd0b75e062ae8c, 0x0000fbf088054130}},
+        {{0x00dc8ff8ae10aa6c, 0x008fe46390eb18fc, 0x00590a65d44fb208, 0x004c430cedcd2a14,
+          0x00958a59cc04e2b4, 0x0066c594133abed2, 0x00003c23dad9262a},
+         {0x004b93eba56600f5, 0x00e4e3e48ef3d4f2, 0x00b700a42cd6d26f, 0x000b708b291da58e,
+          0x00cfc593bc181fa7, 0x004b362f2510e846, 0x0000acac36952348}},
+        {{0x00d89577b1729175, 0x00168111b5d6dc64, 0x00e18df0b212da23, 0x00f2e4fbac8d3718,
+          0x00bef960605499fc, 0x00775c5ed0da9e16, 0x00007ac85d47b153},
+         {0x00294659305eecdd, 0x000e873aabffbc14, 0x00903680f0eb6063, 0x00ccecdccb9b3c24,
+          0x0048b9722a487d53, 0x005bfeacf7bb7236, 0x00008ae4d60fcc56}},
+        {{0x00652b62d57a627c, 0x004c01cd209b184d, 0x00d25b5f318a0c7a, 0x00c1daba8eca0f67,
+          0x005f9d5de00657d1, 0x00b4e6ab3597f6b9, 0x000069df9ada929b},
+         {0x006b71fa490ca73e, 0x0061061e71a21c16, 0x004a1e406e7217d9, 0x0067e472fcb68aed,
+          0x0048c7b20b28c47d, 0x00cb5dbc5d23d810, 0x000062969b910a15}},
+        {{0x0028d045e0f2938c, 0x00ddf4bb903e7386, 0x0056aded0198f4f0, 0x002e3370e4d8cdbc,
+          0x0086dc4a4a879257, 0x00eda95d46b176a6, 0x0000a00b7664cac2},
+         {0x00d356bf98392ba1, 0x00aaa5db773c3b1c, 0x0021a9066e2d0388, 0x00513121797eef96,
+          0x00340b3d53f9b49d, 0x00d1f8ff948b5e6f, 0x000051a146da3721}},
+        {{0x0000cf93a3c938c8, 0x00737749801e1b2c, 0x00301ca41cf4e41d, 0x004c8c8f02d4bc75,
+          0x00a0bb15d1754d69, 0x00c875458e6dddee, 0x000026003516219c},
+         {0x00edd1e1db03af28, 0x007cecce6de23972, 0x0083ac0173f86833, 0x006888da9cf0ac51,
+          0x008a9909751423da, 0x00be98e980c6ea71, 0x0000998578e1500e}},
+        {{0x00bf7b514310ce8b, 0x00aa62136b24931a, 0x00d39c5e08c8c5bc, 0x00de6b325054b7e7,
+          0x00ba43d6b8e21c84, 0x0064be52375037a7, 0x00005611fcd45359},
+         {0x00cec3ed7be6e763, 0x00008572f37cbf09, 0x00e5a911aefe5e43, 0x0006bad460fd26b8,
+          0x00f9dc88308a2552, 0x007c6eaf3a6b13b3, 0x00000b116d7ccea7}},
+        {{0x001a77fa964f913d, 0x00972812539a0193, 0x00d54f9ff49ab349, 0x00a99c7f887dd46b,
+          0x009dac6b71565232, 0x00ec960b8c673279, 0x00009819ca3d7cb8},
+         {0x00b0e671d6e0f29f, 0x00992e38eaba87cc, 0x0094c7666f3e8a68, 0x00dbeae63fdbd491,
+          0x00369e33b7cdef34, 0x006bc05ad4fa6a44, 0x000010482c66f7c3}},
+        {{0x005f128e4ebe6552, 0x00158811431084ef, 0x00b4261fe4588e6c, 0x006aa4b6a93420d1,
+          0x00d3cb9221ec8b2f, 0x004511211d6ee612, 0x0000c9e5759e26c0},
+         {0x00aa95395318723e, 0x005df7a2da07b771, 0x00462feb636b890f, 0x0036aa9085c68bb7,
+          0x008209e83c6a7d3b, 0x00210e11d84fe9ec, 0x000031d407ae19e4}},
+        {{0x0091d012f6f29dce, 0x0023f802299c9612, 0x00a5155c1229af34, 0x00ab917ec2317a4a,
+          0x004a2d57f273ddbe, 0x00722a1419406e1a, 0x000071c0dde01f7e},
+         {0x0013392df5fed19f, 0x00093da306b8ebb4, 0x00269cc22a763765, 0x0096bde70682349c,
+          0x001abe30b2d86057, 0x003f02ec3a00c04f, 0x0000bfe13556bba8}}
+    },
+    {
+        {{0x002c6e10af582361, 0x0043e67d0246d68f, 0x007de9f2445f222a, 0x00edb5f7818548f1,
+          0x002b93992b48bfaf, 0x007be1c86e2e45e8, 0x00009bd834966ff1},
+         {0x004dd596b8775b72, 0x00e0244761cea1ee, 0x0093fa11a81fad89, 0x00d1d90746a6090a,
+          0x0054e87e0e7082aa, 0x000432e494c1b4a1, 0x00005bc9392dea78}},
+        {{0x00610182a93c10a7, 0x0059c9036afb3bcb, 0x0003faac375abd50, 0x00ac1b02f4cb5383,
+          0x00e7d58bc35a94e6, 0x0041bd8b5d42098a, 0x0000a8eb21140042},
+         {0x003c554a262fac2c, 0x00bcdf31306b48aa, 0x00a9fab6be4dc6d2, 0x000ea77d120adae8,
+          0x00675d2489b18aed, 0x0029ba2c4382ffa2, 0x0000abb60ce61055}},
+        {{0x0070f327d93e08b7, 0x0086a7a71ae137d7, 0x00c7be9587ddf0d9, 0x00230d6a8ecf16b3,
+          0x00a771b62de7cd05, 0x00f30deeccbf82ab, 0x0000747a1c389f3c},
+         {0x00c7ad301d243331, 0x00c833f7ea540f48, 0x0070c0909489f93a, 0x00a32428b0e3d123,
+          0x000f10320dc1d8b9, 0x0011cfda11343489, 0x0000886d74734d19}},
+        {{0x00117b3cce6020d3, 0x00d73e4a2defc3e2, 0x008a0fb7e1355ea3, 0x00353d962803ab6c,
+          0x009e2e370ad21bb2, 0x0089ef53ae49c0c1, 0x0000347aaead9912},
+         {0x00d7d0bdd090e5aa, 0x0089f9a27598a037, 0x0085512e854e377b, 0x00341befdcf9015e,
+          0x005dec264f2f1054, 0x00d9cc6e0a008409, 0x000082f3242ff22d}},
+        {{0x006bd1e26e113ca4, 0x008df0ab4d9dd7a2, 0x0037780e3decf12d, 0x00e84151cbf04e53,
+          0x00ea5eee289fa4eb, 0x00373226e22f19c9, 0x0000ff6f2c085abd},
+         {0x0013a8d9789818c8, 0x0053e6e6b44fbb63, 0x0086c61fb6f4dc28, 0x000ab4ef791ed299,
+          0x007c20c61b242a61, 0x0060a0c4040ad745, 0x00002be19f36c0e1}},
+        {{0x006ba818cfddb7be, 0x00b3f510203b0ad8, 0x004e647b51a883de, 0x00aa0b29fabe16f2,
+          0x0057d91457ff00da, 0x00a2206c193691cd, 0x00000207f5efd830},
+         {0x0026b3574691e327, 0x00f28165006dbe4d, 0x0061905c8c33db87, 0x009b6ff206b28631,
+          0x00e5257f995a1a8b, 0x00c5f7cb40300edb, 0x0000c4b6d8507c0d}},
+        {{0x005dff5e80329642, 0x0078f34bdc6da4ec, 0x002e97991da80b30, 0x005952bbc9be2cec,
+          0x001266cda7e071ea, 0x00ef3dc092ea8fdf, 0x00000f2e595d6ec9},
+         {0x00688769df2bfa70, 0x0034ad303a127b84, 0x00448b3279138d70, 0x0036433ec3f1e7e8,
+          0x000a78ae1ff4f175, 0x000525efcf4a3168, 0x000012672eb0e092}},
+        {{0x0017fe21dcaadfaa, 0x00703beb3e24a8e1, 0x001d58a0c9ae589f, 0x00263f6e1e53c9b2,
+          0x00dcd256954f5220, 0x00fc6422c38bf32b, 0x0000438b010f2dd6},
+         {0x00858cf00ab44350, 0x00071443ce348fbf, 0x0006c4a826262bf0, 0x00fc8f2f2e96ba41,
+          0x00e4f9cf164aed20, 0x0054fcaf36420950, 0x0000f92174d3304d}},
+        {{0x00b9b54cb5184cdc, 0x0005b84658aff964, 0x0098a1b18940dda4, 0x00d7d3e13c000786,
+          0x0004dd1fd51dd9d8, 0x007411f1e266c8b1, 0x0000b3d7b828b689},
+         {0x002a8dcb8af0e3e4, 0x00f4f2537f521d91, 0x00f046a093b17a90, 0x00e11856d9fe2cc7,
+          0x000b1e9a8e948f03, 0x00874d983e4c9ed8, 0x00006191b63a4a52}},
+        {{0x009959cf2c573859, 0x00d5836882866a31, 0x00ddd176ad98f7d0, 0x000cd7a43dcbdaaa,
+          0x00f9ec010d16f870, 0x00b89afc4db71183, 0x000035456b4f78e5},
+         {0x0065cf0067438457, 0x00dab94278afd099, 0x0001f28abc005309, 0x00d0b52c2b568be6,
+          0x00cd90ec5ec3c6b3, 0x00c1214dc22838f9, 0x000082e9fd41cfc3}},
+        {{0x001388d30bcfc955, 0x0056078351389db5, 0x006adb13d18915d8, 0x004be9228c7175e3,
+          0x008967d4a93bd576, 0x008f13f5968bcbe9, 0x000093029995ee67},
+         {0x00d4472c1be2204d, 0x0056b1f3e4c6188a, 0x006f40aeecbc5f4c, 0x00d5d0a3507c45ee,
+          0x00c605709150bb1a, 0x0010f47dd7bca8d8, 0x00002eea9ba49a2a}},
+        {{0x0069573985bae667, 0x00c4c726db667548, 0x003089eb6adf0811, 0x0013022c0f13d2ce,
+          0x00ff0e89b2dc686e, 0x009b0761844fca68, 0x000055f06f598fe9},
+         {0x009be937ba118378, 0x00fb2e4e9c8fce06, 0x00c64a9afbc41365, 0x00b251d5d2dd29d1,
+          0x006c840bf0dbc007, 0x00dcd6af6b563f30, 0x00003afa23a59478}},
+        {{0x0087b6c82b7b8b08, 0x00a8c4fdbe2f3b80, 0x00fdcc1dd5a308d2, 0x00a73b9f08c1c3aa,
+          0x00f911db4b8bef47, 0x0009b60cefc50123, 0x0000c5d3d923548e},
+         {0x00dbf1d78b45435d, 0x00e51b766b17b9e3, 0x008822e41ced301d, 0x00aa3e76ad98902a,
+          0x003f712d2b3286cb, 0x00eb850c9c299dcb, 0x00006006751698e2}},
+        {{0x00345984e73c3c73, 0x00037e569152a41c, 0x0030f6dd6cf2d35b, 0x0096d102bd394b3f,
+          0x00ad9caae9d6bde3, 0x0037c7021e9ffca8, 0x00008e35ba4eff92},
+         {0x001e54d9d15e97ff, 0x0067425d7ce862b8, 0x0078668bc5d5833b, 0x006a123ecdddf692,
+          0x00a17d65c27da546, 0x00a6eb74cd369c5f, 0x0000c55175f59e6c}},
+        {{0x0033d2762b6b6086, 0x00290a95b9635c92, 0x00f5ce818c3ca3fc, 0x004be0432f93f1c5,
+          0x003d39f454ba47b0, 0x00c7817fbb8198ce, 0x00002f2bb92ac8b3},
+         {0x00c8804302eef65a, 0x0058dd50fde06f4a, 0x0090e1791c8ffc8f, 0x0050c015876e36c6,
+          0x00a07da9529712e9, 0x00b18f645b8973dd, 0x00000ab5790ae74f}},
+        {{0x003fa50130d96b56, 0x00458247497265ec, 0x008ae250b41c7cbf, 0x0085a752cbd759a8,
+          0x00b7732ae40eb4d8, 0x00d73b599e5b75cc, 0x0000a2e41ceb2dd3},
+         {0x0029d7a82247d827, 0x00b2f29cb90c443c, 0x003dd1cdc8b2038a, 0x0004ec09914ebecc,
+          0x00a8808ba5bb57aa, 0x004fc9e5fc6441d0, 0x000025fa5fe3c6ed}}
+    },
+    {
+        {{0x00df2c72e5d8daf3, 0x00c4331c1dd036d4, 0x00b8a10984c577e0, 0x008e5f417d641e4d,
+          0x004b462b96162fe2, 0x00c61317e806bb72, 0x0000ebad00f66e3c},
+         {0x00e075162261b781, 0x00d2eb7c91153fea, 0x001a301f8eda06ed, 0x00135a012f10bf15,
+          0x0024281fead0986a, 0x0056fa41ee512aac, 0x000098b892883cf0}},
+        {{0x0016e48c2e2cc4ab, 0x00576709d866e4e8, 0x008f66dfa43edea3, 0x00167d467dcd0390,
+          0x0016b1c5a05c151a, 0x003ee6e29eca3654, 0x0000e9a70d3a6a89},
+         {0x00983ebab620e1e6, 0x0067711e5f9b5345, 0x00733fbb588fba62, 0x007f32556bc38d34,
+          0x00c5d5ba8256b5b4, 0x00441108ea4e874f, 0x0000fd6d07b05f3c}},
+        {{0x0013bf1ec2f9984b, 0x00f4f4726125cd76, 0x00ce37e0c426dcce, 0x00e5863357622406,
+          0x0011675eaf789ef2, 0x003a133376384d88, 0x00009d55e99320e0},
+         {0x003f5cb871d0afcf, 0x00fd57ae473124cd, 0x00e647694dff269d, 0x00a79ea2205954d6,
+          0x002103906e9bc413, 0x005cec8d26d11452, 0x0000a4ff4a108613}},
+        {{0x00fd6d1e250e06c5, 0x007882e62cd2f80f, 0x005e4273b01ccb30, 0x001f1b4a50fdc294,
+          0x008ef2a952ce4560, 0x00515474f80eb960, 0x0000bad3bda2cb8c},
+         {0x006359abbea45692, 0x000bfbe7e570441b, 0x002ec9250bc594b4, 0x00dc2e7bb0ae6a73,
+          0x00ca35c47bfbd7ed, 0x00a202e94426842d, 0x0000b7c7691f9f41}},
+        {{0x00ce6e60a97bb398, 0x001513029bd64195, 0x00d91d29f1bcc578, 0x00336471a968e40d,
+          0x006b3784fb7ec7b8, 0x00f9b3a87cc207ae, 0x0000be350a655947},
+         {0x004d72640efe44ad, 0x00d5e40aafbc77bf, 0x0086bdc52cfd8465, 0x00db858b877e0e59,
+          0x0021a5867c5aeba8, 0x0048d30f9f8c22bc, 0x0000c584517c9d14}},
+        {{0x007205749c3804ac, 0x0057d3f38347d3fd, 0x006b1076b6bdf6f1, 0x00b86bc88dd5a82b,
+          0x00d922ba816d4925, 0x00fac307a9ff721d, 0x0000a953d78f9a24},
+         {0x0035ad1e1b8f261f, 0x0000508b45092694, 0x008f1ba8501d332a, 0x00bd898ad5a35275,
+          0x00a5091ae021ea4a, 0x009b8653b91a8aac, 0x000095508b059486}},
+        {{0x000bde48ab1671a7, 0x00e6d3ca57790a1a, 0x00b0a680e6b8b073, 0x00c494645b69aa4d,
+          0x00a8ad08e50a98a5, 0x00f32e16de534304, 0x0000f360bb11156e},
+         {0x009c9e66a2a76e29, 0x00511b87ffafb1d0, 0x009a675f51fadf70, 0x00349e78136007be,
+          0x00ceb67bce445afa, 0x002e0ccb94ab8c00, 0x000022f02ecf68f0}},
+        {{0x007e33e51a13b422, 0x00f8f949938dbd87, 0x007ed6f9161c58b5, 0x00fdd95ae432f9c7,
+          0x00a04a12800e99f8, 0x00af6fa6feafd679, 0x0000691e60f01b47},
+         {0x005ec51a7abadba2, 0x00a4f6da464cbdb1, 0x0077fc66c12b0c10, 0x00d4bc910339f551,
+          0x001afe8942e1e3f1, 0x0070cf04d5ffd17e, 0x0000ae2af79fe7f2}},
+        {{0x00216f171b072449, 0x00ccf32db6482d16, 0x00cd568907c00953, 0x00906bedb60a9637,
+          0x00b7198faa9962d8, 0x00b67fc90a19ce13, 0x0000b6dbc66b3ff8},
+         {0x0079009e0080a3c3, 0x00c275af5236625b, 0x00074fff18efe4d1, 0x004e73909e24eca5,
+          0x00365d356fc60821, 0x00b6ca3d39da73f6, 0x00005ce55f2ba67b}},
+        {{0x00581c3fcf81f372, 0x003205b4424be978, 0x00429462cad906c9, 0x0092d61a6840fcee,
+          0x004b2d84aa6ee59f, 0x0037ea275431754d, 0x00004644b28ee8c6},
+         {0x0061a54224c118e4, 0x003c6540146dddca, 0x00d0fc86dae92aab, 0x00f15ab694ec1176,
+          0x00b771c0e149721b, 0x0011f226889364d2, 0x00009d5e33427339}},
+        {{0x00032e8098c0d0db, 0x00ebb011981a78e4, 0x00b9832dbd5305bf, 0x007c215d11626464,
+          0x004f6572517494d5, 0x009e7f06d121d708, 0x00003fba21c702f4},
+         {0x0058b75871e15736, 0x00163413289b799d, 0x003056435eb35d0f, 0x0000987ee7aedc17,
+          0x00774128690f0057, 0x00355a1986e4994c, 0x0000e80be7b51fdd}},
+        {{0x0019213c5d952e95, 0x00c982f022b781ba, 0x0069c5a02b6d1711, 0x00be957c8dcf92df,
+          0x00c43579312fe8e8, 0x008371ec221b0258, 0x0000c9c03b254038},
+         {0x00c93cc731ad68ba, 0x005a9f85ea267ccc, 0x00363b5a36607efa, 0x00f2cf07bbb74264,
+          0x00e4a94bf0a9808b, 0x0098b7cf91c6e784, 0x000028dd48f81bf4}},
+        {{0x00c0c26db33cb7d0, 0x00d7668a2550cd38, 0x0078c1ffc6edb431, 0x00b4e8466d4c5c52,
+          0x0051ca067fd931ca, 0x000221a510a3822a, 0x000003744ff62b23},
+         {0x004f03bf76e7b253, 0x001fdcaf59e939a1, 0x00b39baeda922ec3, 0x00405647b41259b3,
+          0x00db3e3949adc09b, 0x00e15b39628f7f3e, 0x00006bbc595d9d90}},
+        {{0x00c0e9c2d5b6b070, 0x002ed7305c496e82, 0x0059a868469c1bae, 0x00aaa934443028d6,
+          0x001bcd4adf923d5c, 0x00cc7c10369c666b, 0x00000f598e18af31},
+         {0x00056b1f6b3480bf, 0x00c590e489e357ff, 0x00ad980166aa14fc, 0x0026584cc8953a32,
+          0x0049837e524264b4, 0x00f89fddf757cf2b, 0x00007b4902b4ae8a}},
+        {{0x00ee52f836cd6b9d, 0x00f22d5b81e48c0e, 0x009e8d170cae7158, 0x0013ee18ecac9392,
+          0x00b59a7d632333af, 0x006fa80d9c8905d1, 0x0000fe653b301681},
+         {0x004683eda7c9107c, 0x0035f65a9255a907, 0x00129d376604aa89, 0x00e9653f25975873,
+          0x001065ebaa59a516, 0x00339bf23ced1d07, 0x00003b94966e4d9e}},
+        {{0x00c21b74339856fa, 0x00fd97bd3e2ac596, 0x00d84d21721e035b, 0x005f32717350bcd1,
+          0x0054ffe22cfd9c00, 0x00d74654de51354a, 0x0000794fd7033873},
+         {0x00057753cda371c0, 0x00941e559d2ff2f6, 0x005ac3bdd06e236a, 0x00038696a4c78e9d,
+          0x0079064185f2759b, 0x001915dc9cbaa7fd, 0x000036c7cce24153}}
+    },
+    {
+        {{0x00de52c7a213e83b, 0x0092d055db2392b3, 0x007fa76f70c9464a, 0x00455c1c820f5490,
+          0x001bfebcf03811a5, 0x00fa7fdbc082aba7, 0x0000c6b405288edf},
+         {0x007bb07de3636016, 0x009e9a4c00333ac0, 0x000753eec12112b2, 0x00640707c9888e19,
+          0x00519fa164acc0d1, 0x00eafbb78ca0ff03, 0x00005c88fb72c6c4}},
+        {{0x004101d64188663c, 0x009b2827faa8797f, 0x00273e5af35f6a00, 0x006720890f020467,
+          0x00bb9dd77ae4db88, 0x00b08c1f23d0d69a, 0x000018c75c58934d},
+         {0x00eb36e70faf9e97, 0x00a86668c8b6b617, 0x000f457ad7765948, 0x00818dc44015f39a,
+          0x00b0a6f8ebc4f11a, 0x00da04a607e6a70b, 0x0000fa590875c653}},
+        {{0x00d4b2038bf77bb6, 0x00abebb37c91fabd, 0x00b7067d6b1c436a, 0x00b1bbdcc6c7a859,
+          0x00e3fd004a6820fe, 0x002d8d8451baa5fe, 0x0000701d14f86390},
+         {0x007c0f3bc68211fd, 0x001e920670431cf4, 0x00f154119890c144, 0x000ed785cb55b2ba,
+          0x006c642969bb3a8b, 0x0049d24600c6c21c, 0x0000cb7b67b559b5}},
+        {{0x0047ed31e3f96728, 0x00314c57fab67ebb, 0x00b6bd58b9ad90aa, 0x0031747810e0f5d7,
+          0x0019279797bb90f7, 0x00a6df4c04945521, 0x00008ca96ac03066},
+         {0x00aeaf7bcb3caa40, 0x0012ef77d5a0a16a, 0x0069905d2d97c38c, 0x00152ad93f27e352,
+          0x000239d1a7f49c92, 0x00ac62900e9da24e, 0x00004e9bf508b14c}},
+        {{0x003d31d679d31448, 0x00506b3c4d95bb1a, 0x00ed4dd52a912b83, 0x00cfe79e95b8d037,
+          0x00f1dd9461eec524, 0x00710ddade55aeed, 0x0000d3fb154965ff},
+         {0x00701e420f26d7b2, 0x00cc3a0506bff478, 0x00f9d8921a1b4b00, 0x00ea792a9500f1da,
+          0x004f6477fef4ffe3, 0x00259915b0132fb8, 0x0000768ae80c5a0d}},
+        {{0x00a619c781a7603d, 0x008a1917f4f16830, 0x0064da1c9551f835, 0x0095bdff8b21abe2,
+          0x00728804e73dacff, 0x006491fe912f2be0, 0x0000cd99ff425763},
+         {0x005c396e1a684eb2, 0x00d8126d14c75891, 0x001f645fe534976b, 0x0065d61a5d21110f,
+          0x00e3c2e36c8e7444, 0x004a901903f9fcc0, 0x00001faf8d94a090}},
+        {{0x00527222e898cbcc, 0x00ecbe4e98e6af20, 0x00c498ffaba52cd9, 0x008f9298496325b6,
+          0x005d2945515cfcfe, 0x001a6784149035b1, 0x00007e31368290f3},
+         {0x008c8386713398bb, 0x00bb57d0d5a05914, 0x00fa842dd57399a0, 0x00d4b854634ed79a,
+          0x0084875ca48c501f, 0x0081918b4d6bc6c2, 0x0000ef81bc42db24}},
+        {{0x00ad1f37f9bfcb4b, 0x0051f661431bfce1, 0x001c083e42168485, 0x00dd887855360880,
+          0x001f1bddba005bb7, 0x009b9382d0ef7cc5, 0x0000ca5085364eb3},
+         {0x00703ee66a98be1f, 0x007be90549a52753, 0x00d85cf633bbff27, 0x00c1ee3b09a65c35,
+          0x002923f9db13eb2e, 0x004d4d3232f91af6, 0x000045a5e9e6719b}},
+        {{0x008ccb8c02beec15, 0x00781133fd82750f, 0x009a017a78b3eeb4, 0x0034e738cd54774f,
+          0x0018b9deb0f27357, 0x00b0b8008cf2c246, 0x000097b0175fcbc8},
+         {0x00beb8faea989a65, 0x001f03b7b32eac8b, 0x0022922ad7345d3b, 0x0005b91be8866e73,
+          0x00d9f0b93bff97b8, 0x0023f32816e1512d, 0x000096b15a2615b2}},
+        {{0x005b8eef584666af, 0x00e2a039b22b5cf0, 0x004e132589071622, 0x00e6d4277d47aafc,
+          0x009c3d8f089d6b47, 0x008d222df0b0ed3e, 0x000013a70979a86d},
+         {0x0040b55f67931f9c, 0x00f3e0e4f6bee179, 0x008acab1d8c1f877, 0x00466b56719981f1,
+          0x0069fb83e3cca55f, 0x006a502d7d6449d7, 0x00002de137c97c15}},
+        {{0x00acaf3ba9ebd965, 0x003e697e6610605a, 0x00e3d49844a9ddd3, 0x003478a8ed878ddd,
+          0x00d925e615895e31, 0x00b790763d4fbb35, 0x0000c441be752438},
+         {0x00141ca0a03c20cb, 0x00c6f1bcef63dbd8, 0x00321aab6ffb03e7, 0x0082966305ac79e6,
+          0x00a8bd9558b35958, 0x001bd16e1baa825e, 0x000042c294de3f39}},
+        {{0x004a22abba2eca25, 0x00408b8883e39777, 0x007977242e20b174, 0x006e0f6d1a68c6ca,
+          0x005fdcc5341dd893, 0x005fa22c4335bda2, 0x0000add2c4a13852},
+         {0x0047f7d03e522edc, 0x0060a25d762970ad, 0x004401bd83b66e47, 0x00b1aa9b051bb2e8,
+          0x00788961ae3e6e96, 0x002c502be16e3ef0, 0x00005f9ac52c69f5}},
+        {{0x004cbb202d0f89d0, 0x003c50675f5c1499, 0x00d133add13f248e, 0x00b7110f8864ed6c,
+          0x00b16ba41f5b7bac, 0x00886e7a42f5c426, 0x00009c49d432ecbc},
+         {0x0089fac08142cdd2, 0x000db2a7cd9570a3, 0x000b14a1f7435ab9, 0x008ec78f656af7f1,
+          0x00e74c3e54fb1dbb, 0x00a4534fa0053dbf, 0x0000dbae4f2a5666}},
+        {{0x00b5e119e1b5495e, 0x00f550d43c2e106e, 0x00d1b78e5aa359ec, 0x0089a47a908b0559,
+          0x00b2a96f1bb5eaa1, 0x000956ef1c209676, 0x0000b95ad1bdcff2},
+         {0x00f2d25a58d2d17e, 0x009132b6f680469e, 0x002cacaa050637f7, 0x00e5caf43c056b97,
+          0x00de9afc40656fc8, 0x001661da65ac1e4c, 0x000008526f852b3f}},
+        {{0x00878504f5538bd2, 0x00d1276f815dcab4, 0x00909fdd9dfb8ebd, 0x006b1268cacf9db9,
+          0x0089df3787765cee, 0x00311ec06dca7ab1, 0x000006fbc73a3a78},
+         {0x005508e671cfba00, 0x00a1a287e2a7c7e1, 0x00a49991830416a9, 0x00299e2629352d8b,
+          0x003b21e179f99441, 0x00e50743f454d315, 0x0000d8a3bcbdde9a}},
+        {{0x00a8984aa8492b0e, 0x007ab93281b1ab0a, 0x005aa774654ea8d5, 0x00978aea8a088053,
+          0x00f4eed1cb15d86f, 0x009e4f926e0999da, 0x000088a2cd73c68c},
+         {0x00e0ac0bfcf69d9e, 0x007ddad99a80f517, 0x006c2bd8bcd4f8fb, 0x009732c2213cbc11,
+          0x00e929e340c015d9, 0x0008382e0ebe2e27, 0x000093cf558322a2}}
+    },
+    {
+        {{0x006741e5521c2216, 0x00847fa6a02712e9, 0x0088da76e9b08a7f, 0x001dc140c4359323,
+          0x0088624a46d368fb, 0x003c01569e915bca, 0x0000ffca1caf9b38},
+         {0x00b857aab68b56e7, 0x004e0db1cc2c4fbe, 0x002412e50feb667b, 0x0039a3b7d5b842f4,
+          0x0013bf44cfdb5878, 0x0033a10d7762de8b, 0x0000eec95880ddcd}},
+        {{0x00e9d4e4dc0bd11c, 0x00e71c092a356642, 0x00ac0f4d33601189, 0x003e05d22d7c888f,
+          0x001050ff30ae9748, 0x00d74237a8466887, 0x0000b3c3ae918c5d},
+         {0x001c626a7097a773, 0x00bd7c744cc26ee3, 0x00a865610c6ac00e, 0x00f95c081f65f5ca,
+          0x0086ee6d690bcac2, 0x0090b481ff2a3088, 0x0000704472088599}},
+        {{0x00e8adbd267331ea, 0x00bd79cfcf65c447, 0x0078a0e7ee70220a, 0x0053024e6ebb8925,
+          0x00cc7b8fa351234d, 0x00c6bb3431867471, 0x000008741308801e},
+         {0x001aca50e4d2c1cc, 0x00da7c9368a7415f, 0x00eb1e491a33b1eb, 0x00c9f827a6bb0752,
+          0x00816ab046837f39, 0x0036e527b1784317, 0x00005ef75ab37376}},
+        {{0x00317249135af53c, 0x00b7e05bf1658ded, 0x003ebf785b21f71b, 0x00cca29cbf983540,
+          0x0087b655fcc399c0, 0x008b42bb7f2abfdf, 0x0000750c5526c70c},
+         {0x0044764b146ea18c, 0x00ee32a10df1d197, 0x005dcd1d3011af61, 0x0066ce49b209c1da,
+          0x00513cfcdc90e5be, 0x00db52ccc122bfcc, 0x000082f2023548c7}},
+        {{0x003eaab0798a230b, 0x00fcad9f022ec74f, 0x00eea868b8aa803f, 0x00849948214f9cac,
+          0x00a0575ebe8cbd1b, 0x005ad9d1aaf554bc, 0x0000948a20fb6009},
+         {0x00c676487932e92f, 0x003decb844d1f8bf, 0x004895599e5c9a14, 0x009e35b2adcb84d6,
+          0x0089af0aae99a884, 0x0008795f3bcbe3b7, 0x0000ede013496a4b}},
+        {{0x001e1d3c5121d938, 0x004bd50251cb72bb, 0x00c360173a9ff664, 0x0084ccf69cdd3ebb,
+          0x00f3d0b3c065965f, 0x00f518256885caf7, 0x0000bf59b36de71e},
+         {0x006b8e379929ff5c, 0x00cb5bb363e69d04, 0x00bb343a41c3ccba, 0x00cceaa494a3ae82,
+          0x00dbadd308b15ae5, 0x000feae7fbb3c912, 0x0000ef1b4ec4051f}},
+        {{0x0024ee723ed5ca35, 0x002f20cdc8025e74, 0x005d5022af11de25, 0x0066c6b7eee12dcc,
+          0x00ab5f93eb41eb50, 0x001e0db5a8a93456, 0x00002493e8d20a42},
+         {0x0047e4114bc4c258, 0x00d9bfd8382b2314, 0x00e5dbde45182362, 0x00ab905b92157f74,
+          0x00e4fbf414a7e28a, 0x002ad8c394a50730, 0x0000d6a892b42c38}},
+        {{0x0056d73bde68b4d8, 0x0021bff933e2638c, 0x0077c419b34e2ae4, 0x00fede4d58448c5f,
+          0x00b6451097b15d0e, 0x00722611a125ac78, 0x0000b2e694d4030b},
+         {0x00d6e47db25b8465, 0x004b9d3ea4a11a56, 0x00663dbb7eb64af7, 0x00001f8107a898f0,
+          0x003b018906cb5dd7, 0x0028e6933664fc60, 0x00001bd1a4573372}},
+        {{0x008d43d61d123ec7, 0x0079166101c4cd22, 0x00ff3e23a131d4ad, 0x0090d84bbef8ae10,
+          0x002db1ce12863426, 0x00a2e190d0f5e8c1, 0x00000eb40b8f5f5c},
+         {0x00d8d48704acd2bc, 0x00fc2375eeddb21c, 0x00db9c55e4289ac5, 0x000aaf666ca8a5fd,
+          0x002a4083b20aba33, 0x00d9d1e10a7eafd2, 0x0000badabfa97f29}},
+        {{0x00cad6ab6e25ff5c, 0x00ddb40cbe95ccc2, 0x001723644b29b4e7, 0x00b9c67a812fa1d0,
+          0x00932bcfcc782aef, 0x002f213799812f3b, 0x00006d07cb15bdf0},
+         {0x008c9fde09725ba1, 0x00e91431983619ca, 0x0090f7d20377f3fc, 0x00e1b69c7e75e53d,
+          0x0002512c66ca0da8, 0x00e5430a743d418c, 0x00005eb1cadc1cce}},
+        {{0x0055f42e4733527e, 0x00131ada04c8de35, 0x0086240f90ad1a91, 0x001829ce5ca53c8f,
+          0x00dbf21681198ce8, 0x00d821ac5bfcbe65, 0x0000dffe5f89a672},
+         {0x00997522f19f4671, 0x00f973012ec320c7, 0x0090e60125dad769, 0x0032e2bf05e1c045,
+          0x0078e9bcca555924, 0x00b79c1233ac106f, 0x00004ce87fee1541}},
+        {{0x00391a5fdaf84d00, 0x003a582a246a1c6b, 0x00ffc1b1de271ac8, 0x0096a7df1a0de8ea,
+          0x00e2d454c0e6d93f, 0x008511ea69a8dd0e, 0x000055e405eae6ad},
+         {0x00dbff2cfbfcc30b, 0x0084924b81940faa, 0x00efdfd5bb51953b, 0x000ce645e562e908,
+          0x00cbec0d43a682af, 0x00d5949a71795361, 0x0000ae62a6e9193c}},
+        {{0x00cac5a9f5e41553, 0x001f03fbbf9422fb, 0x00e869b9e7bf0d05, 0x001ab9869b69a8f1,
+          0x0099275fe5020870, 0x00d377908acaf161, 0x0000084e91983878},
+         {0x007f8882a1fa1c35, 0x00fb98ee728fbea4, 0x00871bf98082f554, 0x001936b87886b1ec,
+          0x00f5e83d90694536, 0x0016ca1f2b68e1a3, 0x0000006cc55a7521}},
+        {{0x00e1f0f7d6a1a963, 0x0090254665aa5228, 0x0024e332631e57e1, 0x0069e84c8d0428b9,
+          0x00e36f383de29949, 0x00f4d0adc459170d, 0x000085cd8cd1a84f},
+         {0x00c74cca592cb9f3, 0x0010403655950540, 0x00f22e62c8ec18a1, 0x00b9644244caf219,
+          0x007cc445855c5d37, 0x00a5d25ac380773d, 0x000089e983aa41eb}},
+        {{0x00094e31fc098c0d, 0x0006009eacae6e9d, 0x009a47daacecfdce, 0x00f6abf13c23f394,
+          0x00a13e203b100f31, 0x00dbd155563470b7, 0x0000ecdc2e294078},
+         {0x000aa82f26de9e22, 0x0016f45d0d7b83a8, 0x0075af004be23f0f, 0x007051cbfe6f4e37,
+          0x00a608f2323e4743, 0x00fefb52bd16ccda, 0x0000b62f605dbb64}},
+        {{0x00ef9c6cfa8cb59e, 0x00fbf3c560cb1a88, 0x000f0f28256ddc5b, 0x000e835a2a1478f4,
+          0x00120dd8821ef0a6, 0x00176a72cafd7340, 0x000068539d9fc334},
+         {0x00d4e662e5bdd9dc, 0x00f2c013285453a3, 0x00bff6bf487f91bd, 0x0041d0e521c923c5,
+          0x00424a07d11344de, 0x0004b6bc109ec032, 0x00007d3b5f2fdc73}}
+    },
+    {
+        {{0x0054600daecd03ff, 0x009fba5807747134, 0x0085626b13d86109, 0x0017fcce977b8037,
+          0x007db339ae4aac65, 0x00c264d158bb40e0, 0x0000457c6ce0d3bf},
+         {0x00cbe4fcda9182ce, 0x007df2124c56ac2a, 0x0058f76bdebae26b, 0x003bef8bdaf7e577,
+          0x002b8ed7050dcf55, 0x0004159c56e2701e, 0x0000a7be3010e627}},
+        {{0x008e0fa6fb45e5c1, 0x0062e56993a49fdd, 0x00db365872280dec, 0x006d7cc343d3f892,
+          0x00696da3d4c227f3, 0x00b9bdf6fc148894, 0x0000bda053f88157},
+         {0x00e3b627de69cc92, 0x00405f5a4d160411, 0x00a83d2186bd9516, 0x001286789402ae38,
+          0x00fd9d082bfc501b, 0x00be8497cc5b2084, 0x0000324c9c53674a}},
+        {{0x00ed4f351f2b4561, 0x00d0299ca7ad6e29, 0x00386605e676be02, 0x00aa10dc1d77cee2,
+          0x00c16a4b69259ec7, 0x0023732b722133eb, 0x0000ad2050ae6174},
+         {0x00c88f3e7e300d07, 0x001fee763015f34d, 0x007e531d52d4b5b1, 0x00ca3b1c61db8244,
+          0x00bee010a714566d, 0x00ecea0dc8368bde, 0x00002f91058ce3cb}},
+        {{0x003890cc9d1fe745, 0x00284aa65c0ae639, 0x004a1eedd379e803, 0x0024557409283240,
+          0x0028733fa5aa0a42, 0x009bb0748e658984, 0x0000471548184639},
+         {0x00bed33d90374e84, 0x00a3ef3ca2df4e5f, 0x00e37fdfab4d0b51, 0x000024108cb990a3,
+          0x0047fc14c1bcfaa8, 0x00dde8678fd28586, 0x00000a9254622b13}},
+        {{0x0041f7c0cafbf454, 0x002515a0ba1915d1, 0x00c1fd9e776edee1, 0x00f358005fed0f35,
+          0x00de3d7515c26021, 0x00ad781b341f26be, 0x00001f26b4c93686},
+         {0x002f3cae8a9bb529, 0x00cd29d3be192a68, 0x00495be4902a84c8, 0x007010484675e22d,
+          0x00c2bd7bd8bdc2e4, 0x00447150f7edf4f2, 0x0000344c8f653910}},
+        {{0x003631dd997228c3, 0x007474620646fc6b, 0x003df582fd31217a, 0x00fd0c1a9418f276,
+          0x0042e6c92fac36cc, 0x0004e4134255fe38, 0x0000d1993b5a4c9d},
+         {0x004f1ae669ea115b, 0x001c54b6519b2c69, 0x00def0ebe2ce6c86, 0x007832af61e16037,
+          0x00865f3e3c9fd2a6, 0x00356a6d8f14ba84, 0x00001c3ac794ef8e}},
+        {{0x003d868f1596ebfe, 0x00c76bdc8b8bfe1c, 0x00de09202fd1743e, 0x005a2949cefa7ce3,
+          0x005a51937d449018, 0x00a3c3981e6d2e5b, 0x00003a24bbe8b3cb},
+         {0x00de04ea5afa01d3, 0x004b55bd9d63b2d4, 0x0068ad587156d259, 0x00bd4423925cf3fb,
+          0x0056aee90b94d3a8, 0x005eabfdbdbbdd9b, 0x0000913a98cecc7a}},
+        {{0x00b952fd98b8dd8f, 0x0067c8e2e22484d1, 0x005ae189b44c3111, 0x00cc595681a9a44d,
+          0x0094523e194ab7c1, 0x002f0819b03ff378, 0x00001311dd5bd3b6},
+         {0x001f31c012532154, 0x00ddab401e733d66, 0x00d7a9a8d44f4726, 0x0039e656fa8c676c,
+          0x0061d84bebd0b70b, 0x00f9e57628e4d020, 0x00006dc06731dc2c}},
+        {{0x005396828aa9b3ea, 0x00cea4a9db27b371, 0x005268bfca5571e5, 0x00ddbbf72dc1a68e,
+          0x003363197651c230, 0x00312d646e922618, 0x00007dd1a3851d4b},
+         {0x0037cf911dad8821, 0x008caf1b9cffe15e, 0x00aaec8540742a5a, 0x0059b66cac651d0e,
+          0x00a89f75fa19ef90, 0x0078f31a7a888240, 0x00009ed76c8365b7}},
+        {{0x004f2c2ba50e360a, 0x00cbd503f2f96005, 0x00470d63256ee49a, 0x00939460a23e7ccb,
+          0x00b4fe3081e9911d, 0x009c637954eff41a, 0x0000e07b71fb599f},
+         {0x00fd473d4d40d7dc, 0x008c96efcea2c239, 0x00bcbe890a5346fe, 0x00edc91cd370ebc7,
+          0x00f33743a7bcfc2d, 0x00fa31c378bef582, 0x000015f26d5dd477}},
+        {{0x00784aaf8d6d128c, 0x004b9204ee8c7ba6, 0x009a801db75a455f, 0x00fc9f734e5b75a3,
+          0x008bb2ce479041e3, 0x008cb3ff0304022d, 0x00004d2bbbd3a1b4},
+         {0x005144f0fbfb9575, 0x00c40643ad4d418c, 0x0090d7ecc2381738, 0x00ae9f67dbf28e67,
+          0x0016b9b733c0b7c7, 0x00e87ef97e097c4e, 0x0000861b471b1809}},
+        {{0x002b743419b8c564, 0x001844b8048774f8, 0x00dd4deb98ec8f8b, 0x0096e4b084ba299b,
+          0x00a6c62aced5bec0, 0x00fd41e790ca3bd7, 0x0000c63fb678285c},
+         {0x0049b612e62ce5f7, 0x000ed8c7b7ee9433, 0x00b5109c2a0dfe30, 0x008e9d86d7b70e0a,
+          0x006bc0b0a7d4c764, 0x002e391bd3ec2cd1, 0x0000bdb06b56b3fb}},
+        {{0x00ae1dec0db2d37b, 0x00e153b9e3191235, 0x00381cb2264375e0, 0x003fe64a5726344a,
+          0x0012bba5f6f823cc, 0x005993aaee71ba41, 0x000004f80fb7f19f},
+         {0x003735e3db934895, 0x0070dd87e1e8c6c1, 0x00e1f5f26ff38813, 0x00456839cd61ee5f,
+          0x0046a247bb8a62d8, 0x005b699e10b49a59, 0x0000150e9eb228c5}},
+        {{0x00a45112a469ba59, 0x00244696f841cbaa, 0x002c260fec855114, 0x00971f0ec0e5d772,
+          0x0011d624a6d0d128, 0x0045da3d66567e92, 0x00007a1d1c0418df},
+         {0x00cc59729200c43b, 0x0091ada8c1cd7226, 0x0032122e9b919b5a, 0x006d1d01de3539f4,
+          0x000a0bfb6af2f561, 0x0045ef53b1d1f08f, 0x0000b6f0eb9e7725}},
+        {{0x004683db473ddb93, 0x0064934cda5f759c, 0x008257fc36c3dae7, 0x00aba9c0c8258af7,
+          0x00092a1b9682dc35, 0x00cec467b3286705, 0x000055ad2ac4136c},
+         {0x000d4ff5776827c9, 0x00bfb4cd79fc6a20, 0x0037194447227f25, 0x004ca9239d0b347b,
+          0x0005e78ba79d096f, 0x00407dd83d8efdc2, 0x0000fd51390660c7}},
+        {{0x000081f2e8de8603, 0x006b5602cf470f22, 0x00495da8efe7e58f, 0x0084ee5da15bbb33,
+          0x00455f2b78c40173, 0x000654c45e8c1555, 0x00000e843d026f70},
+         {0x00b52b5912122afb, 0x0076d8b88371be0e, 0x000f26fd7c2e47e4, 0x009278b51e8c6d05,
+          0x008675e84ec2877e, 0x003a121223967530, 0x000084004cae5ee2}}
+    },
+    {
+        {{0x00c280b1f2a56e3a, 0x004e79d47af14e86, 0x0073265f525527dc, 0x00eb24869d7c0f7d,
+          0x00597a787d9db7f6, 0x00ffbb5829b0d561, 0x00008c525924a063},
+         {0x0041346b180556d9, 0x00e098f64e5edabc, 0x00f1403b8b3af972, 0x0032c2255c706c54,
+          0x0035c53e862bdecc, 0x00eabe7b6eb7f263, 0x00004574b4e16ed0}},
+        {{0x00efc1321a9bb0aa, 0x00bdf2bb0f6ca731, 0x00f8cd3d0497da74, 0x002aaa34511af000,
+          0x00fb898d39acb8f2, 0x00d10923eaf4cded, 0x0000e7b3f42dcad3},
+         {0x00ca61b55e695394, 0x0011020e70a63398, 0x00c7216b71d56f59, 0x00c463e3b880a93e,
+          0x0015e7a5bbb25c8f, 0x002920b18e3fba86, 0x00005a5d5c5ffc21}},
+        {{0x00158a73b6255a58, 0x009ab3aafa2b98ec, 0x003e6ee3e93346cf, 0x00c9fc24e3cdec68,
+          0x00cc46f1c9c0cd49, 0x009c8cf5daaebebb, 0x0000b57002bef99b},
+         {0x00be1b6e62b66bb6, 0x00ed752c3a7b9d3a, 0x009441be2308a493, 0x00493d412cd01b06,
+          0x00b4e5bf4437c603, 0x00d6175f6aa4999c, 0x00004326efa6ec69}},
+        {{0x007c8996b71265bf, 0x00570f01536b62b5, 0x00aa5cdd894c1ef1, 0x003dc8b8cfc6c59d,
+          0x000959d8ecea653e, 0x006ed51ddb3975a7, 0x0000ec5690b4acba},
+         {0x0098d57ae0c59d46, 0x002f562658c0332f, 0x00ea0c4f41905135, 0x0075cfa87260759d,
+          0x00bb5ce5bca67bea, 0x00bbcaec9e9ab103, 0x0000a7a36f395083}},
+        {{0x00d20f091f72fb7c, 0x0071710f9ad50c50, 0x00f9360211e00cd1, 0x0074f669390023b7,
+          0x008a6ec2bce40168, 0x00fc1335c2d1d2e9, 0x0000d620f8230dc1},
+         {0x00c35984339e849c, 0x0044fb2621852d85, 0x00ab05f319342406, 0x00f1d78d69bd5a3f,
+          0x00e1ec3cb676164c, 0x00cde95b760c835f, 0x00006b1978dd498a}},
+        {{0x008bd3db511b69f8, 0x0071ca0f9c63cd89, 0x0011a0ffbb782e16, 0x00b3baa9392686be,
+          0x00a76a4d93ae6bd0, 0x00aaa98aaf79222c, 0x000066f3f75b5b66},
+         {0x0016a86b57f6ec88, 0x002859ccd953cf16, 0x006fa263bc467132, 0x006a91cb26465359,
+          0x001f9232424e7e02, 0x00091df15f4b571c, 0x0000bc173b81175e}},
+        {{0x0025501ad4abc6b8, 0x006779d81e888064, 0x00b73450f0b4e160, 0x0005877d309f9f28,
+          0x003b650653f6c5fa, 0x004b026e5c6f8fa9, 0x0000d5537dd3976b},
+         {0x0001a6069502104c, 0x0086dd6d192915a8, 0x00af0a4dfb30a288, 0x00a663201c48ddd1,
+          0x000acf8c8fe31c3f, 0x00ba5b68c38fd5e7, 0x0000659ac7bf432d}},
+        {{0x00e8a16d9143f6a1, 0x00387e330fca7850, 0x009c31f213a65b00, 0x00c33ae5c399da90,
+          0x007f3d73e6d8bc2e, 0x003957bcdaca6f6c, 0x000092fb6ee7b8a0},
+         {0x006c1f8fea11fb28, 0x00f30d555f448ee5, 0x001fe8177cc0d77a, 0x00f9f2f51377c7c0,
+          0x00185d4a5a67f33f, 0x000f4df726638fd2, 0x0000b533fa7e1135}},
+        {{0x00b77f52cf8c401f, 0x0008825255c15446, 0x00272a056d6b3f75, 0x00f0697ad6136b66,
+          0x00b8a4c07d4cc819, 0x00d00185bfc77edf, 0x0000fee6fe1270cd},
+         {0x0097e538ac8c7983, 0x00533faacfccb75d, 0x00adf0da9263200b, 0x002f8182e6bc3cb3,
+          0x00a073add3867557, 0x00f3299314189a0e, 0x000030d5135c6664}},
+        {{0x0064ef1bae89eb47, 0x00f57b3c23b51fe7, 0x00d4b29d8107cc8c, 0x001798c742de0077,
+          0x006b8fc24e344728, 0x00b9e361810663a2, 0x0000c2950bf1d4f7},
+         {0x00fbd84c7276264d, 0x006ded8fb1a4de67, 0x006c8011f8205307, 0x0080491f313df923,
+          0x00aa256ff5775dd1, 0x00e92d0de1332d19, 0x00003ef665c85dc0}},
+        {{0x00cb76bdb6528f8f, 0x00e8409caeb63fb6, 0x002c08c584c36fcf, 0x006eea5134c32927,
+          0x0014ad449d2e4326, 0x00eff3a12e669689, 0x000074f03f7c1e72},
+         {0x003b20f40019792b, 0x000a1db6d4739065, 0x0012b54cc1499f7c, 0x00185e979cb0d272,
+          0x0024d46b6af6c2d6, 0x00d4ed0e0924dd22, 0x000041f38ad4140a}},
+        {{0x00a55b026034bf98, 0x000213879b2aee83, 0x00c50d5bb574e675, 0x00c6d8bc295780cb,
+          0x004ecc177de0f83b, 0x005ecb7823e0b2eb, 0x0000e1af3883293a},
+         {0x00f2cdd8e25f13b2, 0x00d3be2815afb48f, 0x00a37103a0be763c, 0x009283f771b5f4be,
+          0x004f629cb2bbf456, 0x0086506478b88055, 0x00004384adfdaa7f}},
+        {{0x005327ad0bbdddd4, 0x00d05996587ab062, 0x0083aeed0b6be73c, 0x0035b7e67c085145,
+          0x00033d2c67ee2ec3, 0x008a4e49f518e441, 0x000050ba2b2082e5},
+         {0x006aaf4f28d7039e, 0x003e3751eb09b92b, 0x006eb0eb58708017, 0x00a4b18a1c796545,
+          0x002d4786d8b03b23, 0x006392cc2b053894, 0x0000c11d2459eefa}},
+        {{0x0095e70a8ac2a4fe, 0x00fa0aae1493f85b, 0x00d8b1ff9a4f50c3, 0x003892bc87cca507,
+          0x00e68332d595d170, 0x00166deb383866dc, 0x0000453096d7e612},
+         {0x0077c8e18c604cfd, 0x003a8922368b9a67, 0x004320e1a5328d3c, 0x00ca2188bd50ab2d,
+          0x00bb225a6d3ad09b, 0x00ece3d625658c1a, 0x00009adb343a2cce}},
+        {{0x008ecb7429562ed4, 0x00096f4e2aad61ad, 0x0092b6f398fc94c0, 0x00db451f3c63cdfa,
+          0x00e14d627edfb39a, 0x006573471e486db5, 0x0000c06b9980f5fe},
+         {0x000b07a5d6bf2f71, 0x006ae390e099b619, 0x008420b3c14120ef, 0x002b307d9b95fc0b,
+          0x00468ebee20d8864, 0x00f687b6188f5ebe, 0x0000aa7e3d25f239}},
+        {{0x00944d09f0bb2ecd, 0x00f4bf87390895fc, 0x00c6a08de05d7fd2, 0x00024a87c0c0219b,
+          0x000bb4840cbfb52a, 0x004f2dd16ef92fca, 0x000053a358c668ae},
+         {0x00cfb90473473e88, 0x00111f8197be913c, 0x0067c8bea84caefe, 0x008e260737c86df6,
+          0x00be1aa2ece52c8c, 0x004bb549e57d8bfc, 0x0000216162491d52}}
+    },
+    {
+        {{0x009a06f4aa827b07, 0x0082e47cd6596c7d, 0x00dc14cbf8b8cc3c, 0x00eb8257aa26d7ff,
+          0x008cb337b7b13317, 0x00fea38ea3df11b7, 0x0000131f3845e55f},
+         {0x0028f05189f3c69a, 0x003081dcf0208c12, 0x00928d0223a7d9e1, 0x00d759ce54951cb1,
+          0x00edbac6e53f2beb, 0x00179d7392cd0560, 0x0000a36e4c381e6f}},
+        {{0x00d8a17dc0814998, 0x005eb047b2f85e53, 0x00250e43191514dd, 0x00a3ee110db88fcd,
+          0x00f15d3d37551649, 0x0007fbc3a3514c50, 0x0000faf9ce76ea40},
+         {0x009d602a00ccee8a, 0x00609ef938b53ea4, 0x00ad9bccb62fbb97, 0x00d0ad6499b2c2db,
+          0x00f78b413bf5b486, 0x0031843f691e4cd7, 0x00001a4019cca151}},
+        {{0x00c022ecc351be09, 0x00e7ddffc9353799, 0x0072fba62351537c, 0x0083121a3aeee401,
+          0x00f5dbd464542269, 0x0014e57d8a4e313d, 0x0000e2b0aa79872b},
+         {0x0079448e5107087c, 0x00a3ff86fac3fe32, 0x008dea2ddc533e8e, 0x0022f8a1bc56e505,
+          0x005c1945e79e85b6, 0x00a9057043816055, 0x0000e6840fa44c17}},
+        {{0x00ee5356c9baf54f, 0x00dc7ad59d0ff7ae, 0x00a1bb21d6afe8f9, 0x00603fbe7976c7cd,
+          0x00016ca9fb3fa715, 0x00b01cf7b1f3b112, 0x00007e85198bb841},
+         {0x006f5d945890cd52, 0x004b4a9758f03645, 0x0088089db5c51a44, 0x006bdc587829020e,
+          0x003cb73da57dda9b, 0x008aba1e53541afe, 0x0000acec016adeb8}},
+        {{0x0056bbac614d3067, 0x00eb7c9dcdac3379, 0x00a6bd480d70e70a, 0x0064b3bcf062b607,
+          0x00c741f8d9ad8397, 0x001136745c6f7b3a, 0x0000339a10902f57},
+         {0x00d4f1bf4fd00b7d, 0x0010174eaa84523d, 0x00b50b27979dc50d, 0x003c31d4ab6e4890,
+          0x00b098102738525e, 0x009106c47e97d765, 0x000041203264cf69}},
+        {{0x00b74ba12f071604, 0x00c81506af413b3d, 0x007eac382eb14e54, 0x00c119c79a1f0710,
+          0x00159beb1d6301ab, 0x003f1d5bd8e9541e, 0x0000a652c95db3ca},
+         {0x00296b57586b7e03, 0x00aa9a92b60d87ac, 0x00fc01f32d76a3fa, 0x00f51777e26d4092,
+          0x00ce0d0656a2e9aa, 0x0030fd1e272589c0, 0x00001507e952146e}},
+        {{0x0013314835a34c44, 0x003536ce1b7f2fb8, 0x009709ff3f247649, 0x001ce4889077b537,
+          0x000d661a76cf9691, 0x00d620d87b5e014d, 0x000084366f5181dc},
+         {0x00768a79fe8fd580, 0x00a91a75dd31e6cd, 0x00618335e10c280e, 0x007f21e94b1a3f72,
+          0x00a3d1a1f02297e9, 0x0097e3e4a820eec6, 0x000064aad1ed5ef7}},
+        {{0x00e7dbedc7511872, 0x00d98367b55255a4, 0x00cde559a36ede4a, 0x00a664bf45ca1401,
+          0x00636473877f1e59, 0x002851a027c3a054, 0x0000262918085ab9},
+         {0x00406dc5a3cd29f0, 0x007bcd9fa799f178, 0x008e746f9ea10416, 0x008049c45d4e5319,
+          0x0079697f2b738c10, 0x00d5d05d51334ae4, 0x0000c5f96030cb62}},
+        {{0x00c70c991b2d5ce4, 0x00102a66e05fd16d, 0x00cfbb5b007aa428, 0x00c5924e5131fbe2,
+          0x0028d388f7e24565, 0x0094a1199b41aabb, 0x0000fce09f7807f2},
+         {0x004841710915f288, 0x00ac54baec6f41f9, 0x0081422cb4a9fdf5, 0x0089ec897687f32f,
+          0x006c6348f761db1a, 0x00512f4e063fcb51, 0x0000ae51399bd924}},
+        {{0x0082a35073a5547a, 0x00c8a3fc96094986, 0x007d9baa4a089e52, 0x00a02dd936c29020,
+          0x00674e07afeb78fd, 0x0084b7844c76b751, 0x0000a8d41e52cca9},
+         {0x006675c63554b645, 0x00ea410e99113b0b, 0x00bbaa5b6859fd68, 0x0000915354f2ac76,
+          0x0005f64ee0daa0ad, 0x00470353bc1ed19d, 0x000008ba92e89fcd}},
+        {{0x00929668cf21eb07, 0x00590852ad3b9c24, 0x00e65a0bc364d355, 0x00128d672b472c02,
+          0x0002b51c243e3feb, 0x00a2ce6960348ef7, 0x00009188e2883fe2},
+         {0x0046aecbb038a3ed, 0x00dcbc0c296a471e, 0x009f64e04ff0e42c, 0x0066f0f6ad5126ea,
+          0x0039413d84d2d3ef, 0x00df5b0b0ab896c2, 0x0000321d3d8ee8fd}},
+        {{0x00141c6424a23a14, 0x00cd39d32ac1e40d, 0x00d84411b927b2e5, 0x00aeaca97c8d8d1c,
+          0x00807e9d26b891bd, 0x00df864fbf57d3bb, 0x00003e9d59b85178},
+         {0x004066c18fb267e8, 0x008d7e259c018707, 0x00706cf78797c9ad, 0x0031a2bab2ba9024,
+          0x00a91f138f9c59a3, 0x005d18a1bff334bf, 0x0000093743e4ae5b}},
+        {{0x0049407be0968467, 0x003d5e77db8e0663, 0x0074467c1ea20623, 0x008d719af1005b70,
+          0x00b79742be82e959, 0x0082181ea5aaa344, 0x0000b0ac0d4356a3},
+         {0x00865f4d1bb0467b, 0x00d491908c1b958c, 0x009956889308eee5, 0x00f8da7fe615e851,
+          0x003ebe7f7932fa92, 0x009d78e8f7929dd5, 0x00007d088cdd515d}},
+        {{0x00508e31936b6811, 0x00c63f2305541e05, 0x0085abd8ef563908, 0x00f9155872ff5004,
+          0x0022f162c15d9f0d, 0x000fd815e4efae53, 0x0000cc6e6df1bf14},
+         {0x003326615b2b42a4, 0x003bc839292f81a3, 0x007cea4b39813268, 0x000b1e6a93ffcfbf,
+          0x00777936d29a3f4e, 0x00947d6881f4bbac, 0x000098725494ea79}},
+        {{0x00b8d3364536b1a4, 0x00e028be9b2803ce, 0x008591441eff71c9, 0x006d6eb3d537b3a8,
+          0x000c460ff807abdc, 0x00da61e185963172, 0x00007c1c0b21ac13},
+         {0x008588daee6a919f, 0x00536ccbdc75b951, 0x00ab90d957e033e1, 0x00a93cfb83dd366c,
+          0x005131c2813726e7, 0x00ea28d7261a579f, 0x000044b55dcbd5eb}},
+        {{0x0008a95b5992b108, 0x0018d62834f98207, 0x00bbdfae696e000a, 0x004351358e8b42b3,
+          0x0021adae630527b7, 0x00f5960f74aa5d37, 0x00005b96e58d3f5e},
+         {0x00cd5292aa644979, 0x008246bf5f18aca3, 0x00a779b30f096702, 0x006809871a855ff5,
+          0x00fc05b194468255, 0x00ced70816d773f0, 0x0000f5132490c424}}
+    },
+    {
+        {{0x00b29fa39308dbc7, 0x0015d77c0f20f5b9, 0x00e5b6a187d1ee67, 0x00229cec353a7999,
+          0x00e281b1aa75fe7a, 0x00589542d17f20ff, 0x0000273ffa039961},
+         {0x0075d0f73bc10c41, 0x001b296805efb54b, 0x000a2a0dfc0384da, 0x007e8cf4a4e24f16,
+          0x005a57a3322d9d64, 0x00f0d1234a0b65f9, 0x0000cde2a22f673a}},
+        {{0x005701c8bf55884a, 0x00304fa4c874a5a6, 0x00d6bb61d9c7d839, 0x00021e32bf22a7ee,
+          0x002900f01491122c, 0x004f814a89ce794a, 0x000080ac2a331072},
+         {0x0036728b70e314ad, 0x002defd054feb614, 0x000310f8d14a1512, 0x00c3c9fc484a36f1,
+          0x006fc166ad07c0d9, 0x00196f887865f7c7, 0x000002e9d0986a87}},
+        {{0x00243a6dac25ef2a, 0x00a6d612c6a337a7, 0x00004121c875da77, 0x001c7f1da24b2d47,
+          0x00c4b6ca5b13a7a7, 0x00b09341d4fb3856, 0x0000562669e3e23d},
+         {0x0023e6859c9bdbcd, 0x008aabda534189dd, 0x00e737313cd934c6, 0x004dcc5067cdec4e,
+          0x00ea036fc97890d5, 0x00cd88d09c54cc37, 0x000062b9dac3949b}},
+        {{0x003dec4f64ebde73, 0x00814148fa22c5ee, 0x009183773c6301f1, 0x008040351e598ef0,
+          0x00c4a604fea843d6, 0x00172f8325f682f0, 0x0000e5d2e59ec2cf},
+         {0x008fb88ed321ae6d, 0x00ad5b66dfa56a56, 0x00fc7c21a790c471, 0x0057c8de4a8402e2,
+          0x0075c57b9d28e6c0, 0x00156a62b00f97d9, 0x00002b7db7cf9db1}},
+        {{0x00ef13bf564d12aa, 0x009a752df268d86d, 0x00aace80d650cb0f, 0x005434cc16c730c5,
+          0x00812111aba1c9c4, 0x00d22e31cdd873f6, 0x0000e884f231d511},
+         {0x0054a5fd31730dd4, 0x005f870935b0bfa6, 0x007c9709edecd69b, 0x0062e409eea4df7d,
+          0x0072b8dad3663555, 0x007f94276f0ca003, 0x000063a2f8ece19a}},
+        {{0x00bbc7cd11e5d3f4, 0x00bd892ed1ab3221, 0x00c1bd372bcbcb9e, 0x00cc37114310c36b,
+          0x0008b7aa6fe06baf, 0x000f55345c5bf3fd, 0x00008898c6cc8a6b},
+         {0x001ae6fb0eb37404, 0x00d9d6b85b4fcf7c, 0x00611a384c47298e, 0x00a875897ef5024e,
+          0x006c93d477871ffa, 0x0064af888642c2d0, 0x0000272015347a8c}},
+        {{0x004775fbbbe738b5, 0x00a82c6173387dfc, 0x005a7d9b78b7b2bc, 0x000b7d823609d3c7,
+          0x00a2b8e502b2bc4b, 0x003028a8de7a372b, 0x0000a5737930af6b},
+         {0x0059ed8e182f2379, 0x00de032b5bf8bdf1, 0x0019ad4e808b968c, 0x009eea28067314ee,
+          0x005d77c5f8958211, 0x004d610b505bbb88, 0x00001760f575dba4}},
+        {{0x00ddce1a82291675, 0x002b6c1fbd66c39e, 0x0003cc9157fffde4, 0x00448572b6f78298,
+          0x006ba10f2f260b66, 0x0010dff477b7ca0f, 0x0000fab8664a6716},
+         {0x007d9a7274987483, 0x001137a03e1e9520, 0x0075c7f641e07a2c, 0x00d038d0f75439a6,
+          0x0067716e3ce1b3d4, 0x00be2f37514e5fd2, 0x0000f874bd319a01}},
+        {{0x0077221b20b7ae0b, 0x002e6ada49949316, 0x00a04d115ac9e414, 0x00bc7086f4ce0695,
+          0x00477d87b3898f77, 0x00c42460d472c318, 0x00005507192b3ddb},
+         {0x00bb1975e26f55ed, 0x003c99285aa1f934, 0x00208407a15f6aca, 0x004d294a6453cc66,
+          0x0041b95bca71cfea, 0x0075b8eb0778b2ed, 0x0000a9ea162cc4bd}},
+        {{0x004c4a66c599d8cb, 0x00acc1edbcac6aa6, 0x002ebe87b8ad6df9, 0x00b9f6899a2e7d8d,
+          0x006db919acd5d6d8, 0x002641536c38d1b1, 0x0000bb4654133b64},
+         {0x00c6bca9c3c52668, 0x005915a6ae63c106, 0x004e3dbaa4bbb6e2, 0x00d1114e77579d20,
+          0x0007a0570ba41404, 0x000a34f7b185ea69, 0x000062790813d352}},
+        {{0x003d28a6fe5588e1, 0x004025e1d2ec6c22, 0x003351a1074f80dd, 0x00e68ae779cd077f,
+          0x0016d56d38558144, 0x00797ef8b4e42ba2, 0x0000f899a51213a7},
+         {0x0076a97a620b4808, 0x00b5501de7f7e398, 0x00ae3706a32f2364, 0x001de52327dfe77c,
+          0x00bfd3901ad168a8, 0x000fc71b47fad926, 0x0000d951abeafd44}},
+        {{0x0067c4d3bd053072, 0x0070fc94390fe08d, 0x001298680a0e73ee, 0x00611bd6bd2adcaf,
+          0x00abf0fbf5159531, 0x0021e8bbeb2903b9, 0x000062c858ef906d},
+         {0x00fc8d87be0ff2a2, 0x00204418983e3f54, 0x00532d20a40e1b1f, 0x0049e592f5534bd4,
+          0x00ffea0095d87bb3, 0x005c5b40a631c19c, 0x00001f8ad7c7045a}},
+        {{0x000aee32fa88b9d2, 0x003de3605a5d4b5d, 0x00e1ae836737ac99, 0x0042cafff7d9e252,
+          0x00456e8a61c35dfa, 0x009a11cbed4ef514, 0x0000ef478ad5271a},
+         {0x005021c7cd7ccfb4, 0x0035517f0403e682, 0x00b02be7c1c5a202, 0x00b97ce6620e6397,
+          0x003cff27c63fc652, 0x008e441b5101a975, 0x000000f716989c77}},
+        {{0x00d157d9a772fd24, 0x0001bca5a31b0c1a, 0x004c28a28af51fc7, 0x00e921b1c4692880,
+          0x001b4467cc05448b, 0x00adf34fc9029bcf, 0x00003cb7456be93c},
+         {0x001780a1f4540709, 0x00bfa369c69eab77, 0x00502ba32c3227f4, 0x005311f68ea3360d,
+          0x004bca30b27ef78f, 0x00b3bf04098b654e, 0x0000afdd734ed0e1}},
+        {{0x007bdf1e50722a31, 0x00fab1086de3ae8d, 0x0087476056570876, 0x0061d2cc59a626ed,
+          0x00663b189e38d297, 0x004bc4a541621bb0, 0x00006ca87f8ec4f5},
+         {0x00e75a886d4da7d4, 0x00bee61487b28ed2, 0x00d5fd6bf0fb64c9, 0x0088b44ad0f141fb,
+          0x00fccd5ba6d381f5, 0x00b9e783c8c7e28b, 0x0000b055be682723}},
+        {{0x001728bf5a00c639, 0x008f9072e517945e, 0x00135c1e9ff1ae4c, 0x006208e07c948780,
+          0x00ed26ee580466d2, 0x00788c4ad3058f5d, 0x0000f8be41bbecc7},
+         {0x00556ad10bb2d1cb, 0x00aaa02969c5f588, 0x00c348088c67f28f, 0x00905746bdf90682,
+          0x00bf7a1165ac938d, 0x000a864d449a91b2, 0x0000998b7a6f6893}}
+    },
+    {
+        {{0x00dd9e8ba8ec4dcb, 0x00afbb3e9d2ca58f, 0x001f986233dc8c7f, 0x00495e953cd902eb,
+          0x00e9f30ed47d0fda, 0x001883000f2e0e32, 0x00000b5db75f226f},
+         {0x0028ce819f67269c, 0x00538a9c04582570, 0x002bec52d696c107, 0x0035ef4550526f58,
+          0x00b5affe99a7fe23, 0x006250d036d89e4b, 0x0000e17b50928bc2}},
+        {{0x0049a2373ef6f7ba, 0x005573738082cacb, 0x0078a9791226e44b, 0x004771f6ae55c402,
+          0x00285bfb4a23d9b1, 0x000be5af0d99d75c, 0x000029f13a243823},
+         {0x00a90dc07b0ae1a7, 0x00aa599aea090e00, 0x0077417b44892f52, 0x0098967481ab8c36,
+          0x00d25222bac4c7ba, 0x000fc178bdb8132b, 0x0000ce23dfc1080e}},
+        {{0x0045456e98dc663c, 0x009c242ff90d18b1, 0x004d1709a8bf4227, 0x002e2352ca066a91,
+          0x0035ba459f625746, 0x009a51c5c4845b25, 0x00003365c433e644},
+         {0x00eef858a3797b81, 0x0067cc18ccc549fd, 0x002593cb6188a87e, 0x009d0fb419dea39a,
+          0x00b640b7d2676e59, 0x004c58d6bbb45173, 0x000063b02fb55303}},
+        {{0x00ca4b6947f8e6e8, 0x00e2ef124c3655dd, 0x005dfd59d024cfae, 0x00bf716a7e63239e,
+          0x003f4d141272d9fd, 0x008c55e434bc3b5a, 0x0000e8b3261e8813},
+         {0x0051527c0454b468, 0x00ce6c1ae5a9193e, 0x004896e0b000e42f, 0x002a1d5efe87f045,
+          0x0045565de9c7ad4c, 0x004f20e83efae1c4, 0x0000bff631093d90}},
+        {{0x0069ad4c72032e9b, 0x00b11631d52d11c7, 0x003c959b78bf8ff1, 0x00977bfab32c95c6,
+          0x00363d5176140883, 0x004fbc98ee101def, 0x0000f9aa3ebe2f4a},
+         {0x00bdba84523e012f, 0x00e21b8e4d1689b5, 0x00aee2e3384a447f, 0x00a7f1b96741108f,
+          0x004bdee6f2a99ae2, 0x0063832b1f7762df, 0x000095f346db02a7}},
+        {{0x001333fd3081a886, 0x00ef1b3de2755ee0, 0x00d7371dbcfa559e, 0x00d5573e99c543ea,
+          0x008fcfa72349dfcb, 0x007bb1038cefddf1, 0x0000c349d2be0981},
+         {0x0051d6ea7eb3abeb, 0x00747b8a5a316efc, 0x00148490348e78ae, 0x007e8f6b44361689,
+          0x0075a285a5b2f8b9, 0x00e128cc2e221af6, 0x0000a7fab8132b18}},
+        {{0x0030ebe4f6cd1831, 0x00cad550e1965694, 0x007e713f01941019, 0x00684424d16974d2,
+          0x007d9ee9a0ec55f1, 0x00804e2d9c15b814, 0x000064da6f33d2ea},
+         {0x008c50ef9103e5ed, 0x0065f29814238086, 0x00d1879a7ffdc58a, 0x00979ac5578dd0f2,
+          0x0098c7054e508801, 0x00c58d16d2572462, 0x00008dedbe352728}},
+        {{0x003c3520b9f7f75e, 0x00c4ddeb0c25a46e, 0x00744d956605f9f6, 0x002ae22bf9c12836,
+          0x001e4f3b8164788c, 0x002f7af48a2ace28, 0x0000e5b0f9a33e95},
+         {0x00de88ef0327c326, 0x008ce12fbd403f64, 0x00c0caf49231f6c1, 0x00cd5a51f73e6c13,
+          0x00a30f18c4274920, 0x001ad38deb1878c0, 0x00005109da19cbe5}},
+        {{0x0080579e3ca3a224, 0x00b9a028c393fe8a, 0x00fbb2e48c0636a5, 0x00fd82f4116b39c3,
+          0x00a998922f74f2bd, 0x00a52e90c29cd9d1, 0x0000857851baea42},
+         {0x002de74723a58f1f, 0x001e99505f6c46cf, 0x001c8ef9e9a128ac, 0x001e77fc0ea8977c,
+          0x00d578d540b8d1dd, 0x00a9a7838f3bb20f, 0x0000db6ecaaab18c}},
+        {{0x00da94b4e95a5f7d, 0x002906011190c899, 0x00e7af13b2178bf8, 0x00f429b84fc8a229,
+          0x0027adbe4198e963, 0x00939cbc9515e2ad, 0x0000bb5657ec0c0e},
+         {0x008d69d950d9e2e9, 0x0061d28ae4181c13, 0x006b3021035faa91, 0x0017c3b8bf80e032,
+          0x00eb57e3e18cc586, 0x0034bd9fd25103f1, 0x00001335149d51a9}},
+        {{0x004560c957d387c9, 0x0068c0f537415d5d, 0x008df6f4f4d42ef4, 0x0022551a3c55b8dd,
+          0x00ddd3e9c399f550, 0x007c71dee1581bc9, 0x000032056fa704df},
+         {0x00dd469a2b1b2dee, 0x00ba0b5cfd2811b7, 0x00277cbcf97012a6, 0x0013aa57d642172c,
+          0x0014465d7de4530b, 0x00874d6176df938a, 0x0000a7d7d61a938f}},
+        {{0x00f11db629fd8e67, 0x00e3ca06c4788ae9, 0x00d0da321b13c16f, 0x009c62193b378970,
+          0x006f1076cabc145d, 0x00e8f1186995fd82, 0x0000e0f485f26b39},
+         {0x0013fc5b67d77c2b, 0x0021ee5bc7a502a3, 0x007b21fc6df5aa1b, 0x0029248f079a69f4,
+          0x00b98f6c0dd04260, 0x0076d211eecbaf7d, 0x000039397130831a}},
+        {{0x00e4435d07e9a1ce, 0x00cd0cae9eb3fa04, 0x0031de2735dfa8bb, 0x007c17d9f0716516,
+          0x006c09894410c1fa, 0x00e5686159bde046, 0x00000867103bf718},
+         {0x004cbdc6b96d1972, 0x00a88f8a0498f76e, 0x0041ff29b2a5e204, 0x002b643a0d49d293,
+          0x00c2490bbe57198b, 0x001b6259c320002d, 0x000025df7260b6d2}},
+        {{0x00bf41b753e27dd1, 0x00efc36dc2e114de, 0x004ecbe22d07371b, 0x0024e72c846a42ab,
+          0x00ab1b6db9f73abd, 0x003a3d0d26143c08, 0x0000badda302a626},
+         {0x0035b0481550e44d, 0x009cc4e2a4e145d0, 0x009dbaf5eaa369a6, 0x003dd130ff13cc41,
+          0x0096ad11ced319ce, 0x00fa75c98b6639fc, 0x00007e6baf1b80a6}},
+        {{0x009a626e4aa67fd9, 0x009e9c9269293594, 0x001b9075904be569, 0x0023be5ae8b7d779,
+          0x0003bccc43ef085f, 0x001e9a8fb89d7716, 0x0000e1a8f360d581},
+         {0x0071d6ad22ecf8bc, 0x00d39a37ac059136, 0x00d75d3915d2b5eb, 0x00291d13caf4eb95,
+          0x0073237f1fb592ac, 0x00e48cb8ca4ad7ac, 0x0000449062bc6659}},
+        {{0x0064051f36b4053b, 0x00d8207cd22cfe26, 0x0080bb68e522f3d9, 0x00ac89d8294d0c56,
+          0x00bb83a8e697a9a8, 0x001b61df3888a640, 0x000067f07fc6582b},
+         {0x00b7874d8ef0c5cb, 0x003b1f0de51f4c56, 0x008d1b45210c5b2f, 0x005dd86d1111b070,
+          0x00095d53fd9efce7, 0x00735086c6fd7c0f, 0x00006430dc553032}}
+    },
+    {
+        {{0x005cb823d32e00ed, 0x00416072f7a287e8, 0x0008b72cdc57f951, 0x003ec077053e1372,
+          0x007dd1814d0f9dc7, 0x00479105958cda7e, 0x000053cd1822b7b7},
+         {0x0098e3a276d07c10, 0x0016b71b6ec659f3, 0x009cc33d3cf29010, 0x007a2f5560484e91,
+          0x00692a277c49456a, 0x001b6713dd3040b2, 0x000084d4bafeb1d4}},
+        {{0x00f2906d9ed1436f, 0x00b0f9a02cce5b66, 0x00fa998709c1bd93, 0x001eb74c1c668531,
+          0x0051c7b894f85bda, 0x0027a879728904ae, 0x0000302e9b41de54},
+         {0x00a5eb758b8e632a, 0x00430a2a67bb209d, 0x0013337b7d7704f9, 0x008bc3c1dddbec67,
+          0x0098c3d39366b0c8, 0x0063e5bfe1079aff, 0x000017b3545e4e04}},
+        {{0x003785d852d185aa, 0x00ce88c62668f84c, 0x00d8871eccdde58c, 0x00d60286f35ed52a,
+          0x000963f81dc65039, 0x006eb2e6a2358f0f, 0x000070029867eef3},
+         {0x008b7fa075c18eb4, 0x003392418ada97ab, 0x00fbe3caac522a1e, 0x00342b4377f1d01d,
+          0x00c783ec4f30abe8, 0x003615bc0d4e5906, 0x00005d6eaf7367d6}},
+        {{0x004d4e7ea82996a8, 0x009279c32c190942, 0x00de63b7e97640f3, 0x004602ebc8b29c6e,
+          0x0049d2a66039bfbb, 0x00605693149abf20, 0x00000597566db933},
+         {0x008e6059fefd6a15, 0x00fc77c7b1d5cd56, 0x00c2df20295bac30, 0x000ff4b419654215,
+          0x00b56cea0e36d79c, 0x0022e6768c058665, 0x000026f8102275aa}},
+        {{0x002e8490b2546726, 0x00b952f7ac5ed16c, 0x0055cedadf1a084e, 0x00780e3f32060093,
+          0x00439a10014720d6, 0x004f0502aebf131d, 0x00009adae40a8365},
+         {0x007da3ced3e1490c, 0x005db394fd9b7f72, 0x00e47b0752e4eb6b, 0x007d3f91d293b4b7,
+          0x00dfd978ac4eacad, 0x006b05265018831c, 0x0000e3c14aee798c}},
+        {{0x00033fcc136d90d7, 0x008c65fd33e30f96, 0x00f8de5d6d444ec2, 0x005c5fe5930cd4da,
+          0x00ffaf87696b5263, 0x00ad2b3cb874fb93, 0x0000df49a4be88f6},
+         {0x001ee44aa5b86dfc, 0x00fb7c49a269cc4e, 0x005c1a98dd88b773, 0x00bdf6554171c920,
+          0x00d872396929c99a, 0x00ac844c829cc57f, 0x00000605ec6b4ac1}},
+        {{0x0078a83a7c945085, 0x001df63e1eb7e92b, 0x00b7978d33b9c4de, 0x002dad1607c4baf6,
+          0x0008387a468aabe0, 0x00bede316e617c17, 0x000021b87a8ea575},
+         {0x005c942d3bb035b3, 0x00a5f0a8db9112c1, 0x000cf93143d15f2b, 0x00703e80c898f5eb,
+          0x0052684472fcaf5a, 0x00abffc1201a5644, 0x00001a8281c2aa65}},
+        {{0x00edbcfd6dfcd775, 0x00bdf9a8f97724de, 0x00634d601cc18adf, 0x00adb3ebf44740e5,
+          0x002ddddf357b1d88, 0x00ce105ecfb2235e, 0x00006f15a99de4a0},
+         {0x00c426f9703a84c9, 0x00ac2ba5af8e1430, 0x00620310a449c428, 0x00b510615d79fa7c,
+          0x001eb2746e8e5e12, 0x00dde007931e2a9e, 0x00009f6470de1773}},
+        {{0x0075bf984edb48c8, 0x0028cb289cab16d2, 0x00eca757efc2204c, 0x0055959be272cd4a,
+          0x0060b8e95870b71a, 0x0021365f44f6ed0d, 0x00001f030eff6b86},
+         {0x005a34115947e0a4, 0x00ced3f89853634b, 0x00baf6b98aae20ce, 0x00fc84f41b74a6d4,
+          0x007b9ed2679489df, 0x00bd4d758ce86cce, 0x000063431b160042}},
+        {{0x00e15bcaea14ce52, 0x00ad8ebcd4579cb6, 0x0037eb268922c92c, 0x00280111d6e883d6,
+          0x00ca391c534c9707, 0x00312aba93f4d1c7, 0x0000686232350252},
+         {0x00714af6c725f8e9, 0x0077fd2d83ca6031, 0x00b34178dc7951e1, 0x00bde03f9f8e90cd,
+          0x004e4c62d127e41f, 0x00be298499ae837c, 0x000076ed0ea9ded8}},
+        {{0x00267e9dda242952, 0x00edeae1ce213403, 0x007de22cce1ed5ab, 0x0031b6b66e76103a,
+          0x000538cff2fd510d, 0x006ebf50500b35d4, 0x0000b3b29e563d5c},
+         {0x0042a63b43ef8c7c, 0x009ff4a2c2164fdd, 0x00f87bdc6d7e2a9d, 0x0068025197f212b8,
+          0x000aa961b73e2936, 0x00b9f4c1f83e75c5, 0x0000fd13b91973f6}},
+        {{0x003e1a43af764b67, 0x00844fd99579d096, 0x005df1358e8d4720, 0x0067104e9f91cf28,
+          0x001ff79ff8dfd1db, 0x00dafc2f629d70a2, 0x0000ddcf01c712ea},
+         {0x00a9d742f01475aa, 0x00b7ea04f87a3ee5, 0x00506fc87d705adf, 0x00ebf2208ca0c79e,
+          0x000cae345f7d3fbc, 0x0093802a9f8fbec0, 0x0000fb73bf3c6dec}},
+        {{0x00667ab5e372a025, 0x0070df100d428be2, 0x00dc5fba094350a8, 0x003c7c90d19ba7df,
+          0x005791d1612bc8cc, 0x00096322ff15dd4c, 0x0000c720e9d4dfb8},
+         {0x00412f22710c19e7, 0x005df37610e04df3, 0x0053f00dfec9e272, 0x00bb48018ea5251c,
+          0x005ebc1797c910a8, 0x00659bedd826a491, 0x00005c99a8666f46}},
+        {{0x0066fa48711cb6d6, 0x00787223eef16cd5, 0x00aa37b9b4d1ee5f, 0x006543b018744af9,
+          0x0091d94605bafa20, 0x00b1aceb3017a7f7, 0x0000866aa727261f},
+         {0x00ec55ab2d3380f6, 0x00acffb6a531db50, 0x0072f1301524387e, 0x004eafa2cfd19439,
+          0x00cca571f2b7b649, 0x00878c34cd21db72, 0x00006bf5946e52c6}},
+        {{0x003a97972eecc24a, 0x00d60990e92ccbb5, 0x00463b4dfd3f57df, 0x00da0eb08d19e01a,
+          0x009d5a574649bf8a, 0x006e8a4ecdaab34d, 0x000072d466687dcf},
+         {0x00dc93b527503625, 0x0002ca8ab054ad3e, 0x00c698a19967b0e9, 0x0037da18af0d9ca2,
+          0x00cfc9884e0e0b53, 0x0040f6ded9497b90, 0x00006a221b448669}},
+        {{0x00c58c91c634e3a8, 0x008c64ab72fdb0c4, 0x00684e0335c78537, 0x0099c830b80a4a45,
+          0x00940d7d25746dec, 0x008424012dde3534, 0x00004b69a24c3be6},
+         {0x00ce54e14a7aae17, 0x00927d1a4ca44bff, 0x0003ca422bc972f6, 0x0043f4df48faeaca,
+          0x00a171c08eb0c34d, 0x0024f9c31f902f04, 0x00008bf25e681d02}}
+    },
+    {
+        {{0x00cd7e307742bff0, 0x00e3fef1f19fd83f, 0x00657722f9a6d81b, 0x00810cbef350708b,
+          0x0013c6828d509a8d, 0x001c0cff08f667c4, 0x00001e12df497c11},
+         {0x00a8b1d6ba51b083, 0x00ede3b41a3fe427, 0x000ca0a03c29e0b4, 0x00bc442f4293edb6,
+          0x00e05f20e95d089d, 0x00f7b0dce08baf36, 0x0000016c3f70a652}},
+        {{0x00f6e866941a2d98, 0x00cbe1a70ca5fd80, 0x00a417577d0440ce, 0x00283568e1c22e78,
+          0x00ffbb47d1ac1cfe, 0x005a02ae83e67bcc, 0x000043143685d6a6},
+         {0x00a8c7e26647b845, 0x009fcd896d8dcc14, 0x00eb83d2b5fd4bd8, 0x00fa9e4511ffbd6d,
+          0x000b52cd22139d05, 0x0048526c7d8876d3, 0x0000a54fa1303bdd}},
+        {{0x00bba30e13ddadfc, 0x007816bd40009259, 0x0008c6315fb7e761, 0x00c1ba2876b965af,
+          0x00c62f0471804bc8, 0x0000bc1fdf855363, 0x00003e6f80cf2777},
+         {0x0038e871ed77f3fb, 0x00ed75683ad25943, 0x000e6b049b5a7cfa, 0x00bf012314c34764,
+          0x00248f7e86c60e59, 0x008a29fad74be964, 0x000037ec6b119261}},
+        {{0x0034c7afd1bf5a1d, 0x00a9f2e3041291d3, 0x00dead0396fe573d, 0x00f8acdb29c6ec66,
+          0x008c5ab968482234, 0x005c6a854d0f00f2, 0x0000a2500ae2b2b9},
+         {0x00014943ca8222bd, 0x0053338a1d528fe0, 0x000a183556d1d37f, 0x00d634943ae4885b,
+          0x007f1b330cd51bc2, 0x0010bd69f077f533, 0x000066da39aa4f21}},
+        {{0x00c619559a1d0ede, 0x004c1ad7b81ebd31, 0x00d1bd7476cfc0d7, 0x006fe96e078701d4,
+          0x0038214a7b82d1d5, 0x0012e67928fbc21a, 0x000057d49e82492a},
+         {0x009fbee911e6614a, 0x00611bd4c67502e3, 0x00e60565aba39780, 0x00d2121c149afcf7,
+          0x00ea7c4489676ba9, 0x007686641743bcfd, 0x0000891baa69ef3c}},
+        {{0x00b47394dd1c4dc6, 0x00e2e3c99c8d101e, 0x0020f6e7b17b342a, 0x007db2abdb20ae15,
+          0x00ecb854c62985fd, 0x0018c55aeb637677, 0x0000c5c8b9ded923},
+         {0x006e834e5c3d2780, 0x00e4f31ca634edb9, 0x006b8227155fbc49, 0x007ef27d234cb8f7,
+          0x00923da51efcc1f8, 0x00b7f391db33376b, 0x0000960ed83d635b}},
+        {{0x00a599eb316b684d, 0x00584f21e57851af, 0x008853be36979a5c, 0x0077b947471caa64,
+          0x0085af6437963f85, 0x0071f583043e8771, 0x0000b3533b6cb5b2},
+         {0x00eaae49b86edd4d, 0x00177f2714daf86c, 0x003e942f994527c4, 0x00784c785f81b416,
+          0x0094d05f56d7aa13, 0x005f84eb53b9bc39, 0x00002917d3430661}},
+        {{0x00adc86e91ed0819, 0x00ed32c1c6f55b99, 0x0055c0a1181a98b8, 0x0089ec3e2e99dda3,
+          0x00130e7049e7b75b, 0x005294ca7bd70a17, 0x0000660e0009d94f},
+         {0x0015e8a9a6b2eee8, 0x008c85b7cbdbf5e1, 0x00ab49376b6a7009, 0x006a8e8416949513,
+          0x00a978fb94ba2165, 0x0093d1e7ee548d9b, 0x0000cb55dcc1f89d}},
+        {{0x001305e3ba613c1f, 0x0076cb7587160be8, 0x000a29bc3d2c7707, 0x0041cd777ddcc487,
+          0x00ea06b2ca0f0000, 0x00319a5373be3a97, 0x00002d2e1ed84192},
+         {0x002786c658432407, 0x00ba51578a6e4cda, 0x00e008d457512608, 0x0071570e50b84980,
+          0x00ebaba4941b75fa, 0x006ea867ea548056, 0x00001aa04bc026d1}},
+        {{0x00c5b2d082315f2b, 0x00ce929517eb93c5, 0x00a49988a9bae6d0, 0x004d6359247f0599,
+          0x00e045707258404f, 0x006e686c70a2bcf9, 0x0000f7fb76ed2a51},
+         {0x00534d3faabf37d6, 0x00c1e6fccb8f6f2d, 0x004c39dbc88278ca, 0x006d1d9688fc7301,
+          0x000e1f9ed2a4d0ff, 0x00c6af10b735d299, 0x0000fa9115c7cd23}},
+        {{0x00feaed1e4ec9363, 0x00ce49629acb816f, 0x00d12a80d7b5a2c5, 0x009114a8e1f7c2e0,
+          0x006ea18722f92216, 0x00e44e791f3c54c5, 0x000017faedea3734},
+         {0x00bb32a6e0ccc012, 0x00e3fb2a2787c09c, 0x00c3d99e244a804a, 0x005319481cf56c3d,
+          0x00672d87d17749eb, 0x00fea6b43ed5ef9b, 0x000044035e0b91ab}},
+        {{0x00150bc1c959ccaf, 0x007465d6bf1358b1, 0x00d9a88af3816112, 0x004a01f52a4e2861,
+          0x005755742ce06c34, 0x0038c140d216017a, 0x00001fba05e7af0b},
+         {0x0070cf32e0892edf, 0x00f25531219347e0, 0x003b676dce4254fe, 0x007bff85e2fd5780,
+          0x007214151261fce4, 0x006a8923ed672545, 0x0000733a18a513ac}},
+        {{0x003665ebff890967, 0x00aad0152b31d5b4, 0x00c5b4827eeb9298, 0x00509342f7ffec30,
+          0x009fd9f428dca2ff, 0x00a678c2adf324ce, 0x0000565bc5ae69cd},
+         {0x00b34b3ba5880c3f, 0x002d7ffdf63268a7, 0x002b5ac3df3b54ca, 0x0034f977b939a386,
+          0x0060556fd95d3ee7, 0x00a08951ff4bc946, 0x00004058101a6dbd}},
+        {{0x005af16f12026691, 0x00d8a73ac7475d70, 0x0051148a09f20314, 0x005c3b71678d5e22,
+          0x00e48fa4ea0896fd, 0x006aa054abb76dbf, 0x0000a45b4c8c9174},
+         {0x0002af9e75fdaf34, 0x0075f1e887a788a9, 0x00c53d164b1c78fd, 0x00208e185096ee12,
+          0x00cf7b95e1016308, 0x005e8e54b89a9cfb, 0x00000c5ee5eafa11}},
+        {{0x001bb59577188ca9, 0x005780bf087c63c7, 0x00472e48e513c442, 0x00754806d0743b4b,
+          0x0017157375c53201, 0x00872f50a7e7735c, 0x000071c18faf7e9c},
+         {0x00d16eedd4e77f4d, 0x004e1e9908fb938b, 0x000e268a27e98a3e, 0x0088256dd1736742,
+          0x00cec76eb1644c71, 0x00cb671eb51079ae, 0x0000aeea4085eb4a}},
+        {{0x00ec0027526b2679, 0x0046851c91d6d023, 0x009e3f4783ffa421, 0x00eb51fab616c1df,
+          0x00ce11838ecfdc22, 0x006988deee0f971f, 0x0000f1d06b58035e},
+         {0x00e475d2aaeed382, 0x001818222a1acb13, 0x00a1181bfeaaa759, 0x00da76f82a69c8c2,
+          0x00c9bb60f1890009, 0x007103129162d3e9, 0x00008cb496fd6851}}
+    },
+    {
+        {{0x000e5cc25fc4b872, 0x005ebf10d31ef4e1, 0x0061e0ebd11e8256, 0x0076e026096f5a27,
+          0x0013e6fc44662e9a, 0x0042b00289d3597e, 0x000024f089170d88},
+         {0x001604d7e0effbe6, 0x0048d77cba64ec2c, 0x008166b16da19e36, 0x006b0d1a0f28c088,
+          0x000259fcd47754fd, 0x00cc643e4d725f9a, 0x00007b10f3c79c14}},
+        {{0x0098923ed3c7ba86, 0x00370d6b1407f4ca, 0x00c385262163e16a, 0x00532371748f3be4,
+          0x0043c67c5690bc7d, 0x00b0f0ced2fd6735, 0x0000d5afd62fe7e2},
+         {0x000e0b83bfe7d6ed, 0x00b531bf31b1ffd2, 0x0045c35e4107d96b, 0x0011f00cf1817efd,
+          0x007e14698e87ff36, 0x00e19096124ede21, 0x000043ac052beb69}},
+        {{0x0022c02f5ed85ee3, 0x00febdecad4dbd3d, 0x0033365ad848bedb, 0x002f31cde8cdcc61,
+          0x0028f10179c197d3, 0x005d39ce3693a7c0, 0x00004b84cb59ad5a},
+         {0x00fed7d87350b307, 0x007b3c6a3b09781d, 0x0047e199addb550e, 0x0018bfb693905321,
+          0x00f7a280175a3a78, 0x00c1e1402e52b173, 0x0000e5ca2467f726}},
+        {{0x0055da7c6f9e9275, 0x007b7d9f82d61a18, 0x00eb8b61b0f060aa, 0x00fe1edbbe98e4bd,
+          0x0092506b6c697751, 0x0008d9d28d47e535, 0x0000fdb21f05c0fc},
+         {0x00c11bbce5713d3e, 0x00cd220d9995c856, 0x00cc7df51ad44882, 0x0095686842d01ae8,
+          0x002d40d52dad6c17, 0x00f46a8fd4d490f2, 0x0000b91c9e3249dd}},
+        {{0x00bca075d316d2a6, 0x006a46ad04f8f728, 0x00e01bf0532b0f99, 0x006e470fbf877ff4,
+          0x0061fa88c5c482ff, 0x00a3e7e1a7821f8c, 0x00007302cdb1f485},
+         {0x007ee5f72e34b559, 0x00f0ccd8c5f70d7e, 0x000db6892e004534, 0x007c614d2955ff75,
+          0x000c792d88d562be, 0x00a7af4d89fbf10b, 0x0000f15282393d77}},
+        {{0x0028d276b76c28c8, 0x00cabdc2904dc872, 0x00e91b1123076f64, 0x0046fd1a30f03477,
+          0x00900ca3a622ce6e, 0x001ee40ff4cc9975, 0x00002f3605bb78f6},
+         {0x0021b06a0e983866, 0x0006a0e0e19d9050, 0x00536bd339f71e44, 0x009aafdbe1687f44,
+          0x0016fec27f9582e9, 0x00e400e009be0880, 0x0000f6da25147ed4}},
+        {{0x0000017857b6b625, 0x00dabe8eb09c18c7, 0x00c38f25a2c418cf, 0x008937fe899f0805,
+          0x004b91eaf7fbec63, 0x000d5e9d89dcff88, 0x0000729d1518ca9a},
+         {0x00208fe58bffd966, 0x00cde82941fd29ba, 0x00617224b7aa9001, 0x006d304f15986f9d,
+          0x00b3ed1635fa7355, 0x003ae4f3b75b042f, 0x00004503f9442f04}},
+        {{0x00bfc2c04905ca71, 0x00450ad156f761e4, 0x00dbd08848c2f33a, 0x00a23096863d8b29,
+          0x004972d7097da395, 0x00aa12211905035f, 0x0000b2d1055817cb},
+         {0x00cebb55753ee324, 0x00b07c6924666fdd, 0x00744ecf1a68e87a, 0x002e6236c09b475d,
+          0x00fd056bf82be8f5, 0x00cbd2237c0dba3c, 0x0000354cd872c3c6}},
+        {{0x00c5574fd005e24f, 0x00b8ac073d37c919, 0x003e9e96b36e1950, 0x00dc0f5e5d6f4719,
+          0x00978081af64385d, 0x008f851e40ac6e19, 0x000086d7714f2311},
+         {0x00488b11857777b9, 0x002b99445b242cf4, 0x00b64ae00d3419bb, 0x004f45c7089fe21b,
+          0x00642728f840719e, 0x0078bf442db9bb6b, 0x0000af1a94d11264}},
+        {{0x0066afde70800057, 0x00d179e2f53e1931, 0x00e8379ad4b0e4e0, 0x007d5e0b1d44d0db,
+          0x00c5d5204155b910, 0x00629c4d53379bfa, 0x00007760d4acc693},
+         {0x00235c0f6fd10f22, 0x0025ac83fa04b25e, 0x001d8555d5656e4a, 0x00d1afd9467f32ac,
+          0x004de8cdb31e26e2, 0x00b7becdab8f139b, 0x000053c41b333bfa}},
+        {{0x00a8c17c0c031248, 0x00410eebe67e2021, 0x00f4e65f7e7f5190, 0x00f2a4114708840c,
+          0x00ce07939ae408c8, 0x00dbd8f356c95cc5, 0x000008441497addf},
+         {0x0061b927f0e26c5f, 0x00b2bc0aaab97c85, 0x000c77a235807823, 0x00c206bb910b7f1c,
+          0x007a638ccfece639, 0x00d63c20d76ffc12, 0x0000c640103e9573}},
+        {{0x0058f8ef0e91dc0f, 0x00cce1f39c4341ee, 0x004956a1acc78820, 0x00021a41ecf7798d,
+          0x0058b36c26f27a7b, 0x00743a4ce5fb0b01, 0x0000e7ae962f1fb7},
+         {0x00e3e3c0e22b177e, 0x00c1c4552bb722b9, 0x00c4d619b1e03777, 0x004562254bec4d74,
+          0x00147f76564f1b41, 0x002baf1821a7497f, 0x0000be1bf528bf49}},
+        {{0x0025e95e49562002, 0x00055c049b10c346, 0x0081bf80a9f4f4bf, 0x00b64436cdd8f052,
+          0x00131a89f60f9928, 0x00ec09b12347045b, 0x00002168195b83a2},
+         {0x00b56940172a2ce3, 0x00d5c2f010f717ec, 0x00ebdb9bce620d45, 0x00bae39c8eb82976,
+          0x0094ba9fbb14bfde, 0x007a3c8d80529009, 0x000072c9948cbba1}},
+        {{0x0004e00d1744a5d0, 0x005411a456731856, 0x00942cf82e3490f9, 0x00ef48eaf748e7da,
+          0x008300b0b44639e5, 0x007af491aa9af133, 0x00007390b0cbf26c},
+         {0x00d4357effc2182d, 0x008b8fdd0b48085b, 0x000753e0b3aca520, 0x00af9db5243fee06,
+          0x003a1678e77ef599, 0x0090c2e965003e9a, 0x000042862b0b4eff}},
+        {{0x00de15528c2ce6c9, 0x00e756c2f5202068, 0x005eecdd1944b4fb, 0x009064ee9d5ba74a,
+          0x00ff1341c67b851a, 0x003e76b3ddd1f38e, 0x00003383c0ef73dd},
+         {0x0019e78cc2075b34, 0x00af15b07465534e, 0x00453037fe735eb5, 0x0061b5a107d8275c,
+          0x00da7ab9815bd52f, 0x00349df0c1afa179, 0x00007b86fa990e1f}},
+        {{0x0066c2663cfa034a, 0x0055589e2e7aebcb, 0x0050377c82a9d2d9, 0x00e8fd496d263175,
+          0x00624bf0bafe90ef, 0x000a44e9df1fcdfd, 0x00009a568abfe370},
+         {0x0064f9ea838be64f, 0x00e9e8d02797e1ff, 0x00dee8facc2b060e, 0x00b6ec8a84b7b3c8,
+          0x00cb37e84d208741, 0x0003b5b6349601b3, 0x000079569fb87d09}}
+    },
+    {
+        {{0x00d859b4b67bbf60, 0x00d820a5c002b680, 0x0033bfff181f1344, 0x008c95832081ff85,
+          0x005d4d6e8864f123, 0x0048c9f7f6110629, 0x0000a6cb192cb455},
+         {0x0047afebd63f2eea, 0x002cbebea379de83, 0x006b2c63c212018c, 0x0056483d81d38381,
+          0x00e6a4b397c4fc83, 0x004d87c43ea9d216, 0x0000cd4d4767e26e}},
+        {{0x0045f7e147904a7d, 0x00605e8f31f8563d, 0x0084a1a5125fbc2f, 0x00090e836b3d7f66,
+          0x0005fc4b1e72f659, 0x0081054f2919be67, 0x000007054c1d6082},
+         {0x006cb44ba4cfb68c, 0x001b290d2a2e0baf, 0x00804a6edca0ad23, 0x00c40f7bfa8f0d6d,
+          0x00f159733a45bf30, 0x000acd63a7ebe7af, 0x00003cbac0975616}},
+        {{0x0001552ca88e537c, 0x002a4f6d3901276c, 0x00a9e5b896736fe0, 0x00a0803ad56fe3d8,
+          0x0030879e949fb457, 0x002c633e082091e1, 0x000061b6e1bfffce},
+         {0x0089246ad9cff015, 0x00337573ea0ff74a, 0x00105f469a4c669e, 0x0039d795cb813e21,
+          0x00f5a2a443c19f38, 0x001219553ac492af, 0x0000a5bbd8992ee3}},
+        {{0x00f5d75b3f943745, 0x00035fc3f49b85f9, 0x005331f666fc4392, 0x00923b3473d4d06a,
+          0x00e2e50df8b09ef0, 0x000f0956978ebbec, 0x000083838b511ddd},
+         {0x0066a52d3944b6d6, 0x0051ef20f79db5ce, 0x0001d582bdfc9884, 0x00147bb6e84300b0,
+          0x00685251b22f9897, 0x000177f8b944ee10, 0x00004c34f592c5a2}},
+        {{0x002fb4ce1dea2ce7, 0x003e17471e8a1644, 0x001d32d12e08f008, 0x004918edb20e68fa,
+          0x00b43aa46bed5016, 0x00d096b304181416, 0x0000ef81be0b6982},
+         {0x00ca62d4ebaedc38, 0x009cf9f0e07d653a, 0x000aa91e031bf926, 0x00949d8cf974ebb2,
+          0x007c51831220ccd7, 0x0015fc8f7a433816, 0x000002b79b1e9b03}},
+        {{0x0085dfa62de27288, 0x00e53a5650b6c7bd, 0x00e49701cfb8716e, 0x00181e6c6788fce9,
+          0x001cf8dcef2297ba, 0x0071e437490a111a, 0x0000cbb55dbe3cab},
+         {0x0029b0f75000748b, 0x00b59b39049ecf69, 0x00266af5730372d2, 0x003349d796228012,
+          0x008ee46a63ce1c50, 0x008b91870da8f90e, 0x0000582f143a1234}},
+        {{0x00eeb23860e4e0f6, 0x000c5b3ea4028d16, 0x00c7b99e5e6c9308, 0x00054bef5ca94162,
+          0x00bdefdcec151eae, 0x007e79be4c96c525, 0x0000af8771a40b4d},
+         {0x00e7a9a24ab86b84, 0x00a7ab523494f2e3, 0x00edfb36c12b89c8, 0x004665b8227b411b,
+          0x0082abd5076bffa1, 0x003bfe40001f44d0, 0x0000890db142d3d2}},
+        {{0x004f3cdda81e3f6f, 0x00b5740d35520f30, 0x007af3a460d34e03, 0x007db885c46abe79,
+          0x00deb46e2f4e4e99, 0x00ac7aa5531d8d9c, 0x000022ba6ea3b87e},
+         {0x00969d6d9266b9f8, 0x00fc0e9714bc2cfa, 0x005246aa6239ccd3, 0x001ae6a2c08c6c82,
+          0x00b793a707614ae1, 0x005c34e40ea5b73a, 0x0000ccd9d3fd33eb}},
+        {{0x00bd7fe6ff0a8a51, 0x00ad7e945787b1ee, 0x008e15bae3cd2aa2, 0x006bf01c7458d57b,
+          0x00849120de6ee447, 0x005898e4c5bd03fb, 0x00009b92f3505b2f},
+         {0x0070346d0654c4a8, 0x0084456a00a8a305, 0x0032bdcc0786f47a, 0x007b4ea3840a73fc,
+          0x001a67869dfc9397, 0x0098cd428c464b1c, 0x0000045810e6f3dc}},
+        {{0x00bc8ee6299a6035, 0x00cf0cc34a371cbe, 0x00c5e0fe9cd5b0b1, 0x0051f163443f8ec9,
+          0x005b7357162a065a, 0x002e18d98ee1ce21, 0x0000478058bc7952},
+         {0x00c6d04f40944db7, 0x00b9c934004f372c, 0x00fbd1f59c6ef1a6, 0x000ae4a361094932,
+          0x009ad444022255b7, 0x0034e7f7f8825d25, 0x0000fc2408b8cce6}},
+        {{0x00d164c6a72b3ef1, 0x006167dc82355869, 0x00733ed4af0ed036, 0x003e99f4a23522ae,
+          0x00fc1022cf113e8a, 0x00c3ca4e4abf3511, 0x00006716e369b8a0},
+         {0x006999dd26f592ba, 0x00ed53c45dfe8e63, 0x0002e6f12f32782b, 0x0045e7aa6d6eef0d,
+          0x005b7b31ebfb26ec, 0x00268e4c833a2d76, 0x0000cb3976d51e30}},
+        {{0x00fbb9cb14ed1dfd, 0x00f939018796e4a6, 0x00daf59bddd98fe4, 0x0016360686971a14,
+          0x003bb158b384091c, 0x005f9aaa75c68631, 0x00000ef43c88db58},
+         {0x004251a9aa4e5db4, 0x001ab8bf655c3c8b, 0x002f360ef6c0f883, 0x00e3e7207b4bc9ae,
+          0x00bbb823613c3c54, 0x009ff61704326e3a, 0x0000970af005866e}},
+        {{0x003a39e153ffb9fb, 0x003e79c3843481a1, 0x00ce9c5fdfa7f9f4, 0x00e4accf1bf2f1e0,
+          0x00ba452180152eea, 0x0050a07026e2ef03, 0x00001b898fc98a9f},
+         {0x0039a3ca2d7461d8, 0x0003d32e4f485200, 0x007b2f0b4e1e0337, 0x00ee745237a56a02,
+          0x00365b5f935ec623, 0x007bf4e286887b02, 0x00008eb911e39c6b}},
+        {{0x00c577a97223d5dc, 0x00c8461960a0bfb8, 0x00d92ab61dce5a7e, 0x004ca6f6da5bc3d5,
+          0x007612b3bc1fc28b, 0x0057fe8f734dd3f5, 0x000016ddb123b0c7},
+         {0x006174a35bdac0c7, 0x0030d0a307cd2000, 0x004bc4259f6aab1c, 0x00bbdf34d43d3950,
+          0x002b22e70874971c, 0x007bfa60df5f392f, 0x0000f9dddaae60fe}},
+        {{0x00a75d91b1f3228b, 0x004d8c555071abec, 0x0009ac883b05c16f, 0x00bfdd01a290f813,
+          0x0067586799857cc0, 0x0030fd90dc7a3972, 0x0000eb2437175a85},
+         {0x00ff2531dd4c85db, 0x0074448af0fcb0d7, 0x00187696fa7bd07b, 0x0011d0bcd953f86a,
+          0x0008fe09060b63b6, 0x0053f25c7c11477d, 0x0000cfb26f0ee6e1}},
+        {{0x009231593ae61a86, 0x00665e9588f2c586, 0x00d72cc74863f890, 0x0045d27526e53cc8,
+          0x00fd1ec443c46fa3, 0x002c25c34f7e2aee, 0x0000877d67252015},
+         {0x00502f603a378f9d, 0x00460b36710e57ce, 0x007f6f23bbc0c3c6, 0x0080f38028202469,
+          0x00bb0fa6e76259b9, 0x008d0a115a6b754d, 0x0000be750dfc1edc}}
+    },
+    {
+        {{0x007a3e4c4e46126a, 0x009c6e06f21471ff, 0x0061dc73dbd853ab, 0x002ba3e1c05902ba,
+          0x005d816ab28f491e, 0x003fa441687d6dc7, 0x0000c899664775d0},
+         {0x00d1db8026cb30f8, 0x00f322721b2030ba, 0x007c91285a79ad9f, 0x00d251b666144fc9,
+          0x0070b723e5d10314, 0x002de5a07c4fb2a5, 0x0000bd233c9a76f7}},
+        {{0x00db566d2e0d7596, 0x00498084aa1e7291, 0x007a83f2e4d5bd5b, 0x007a172ca443c714,
+          0x0074258b57d9880c, 0x0037f6de7e71e6b9, 0x0000228c9e51fed3},
+         {0x00a9c51e267be621, 0x0069d36885406a06, 0x00ff35d530048508, 0x003a05a393787532,
+          0x0067cf9aef212ca1, 0x00c4edd692a2d8c9, 0x0000c24e75e6aa79}},
+        {{0x0095136c025763b7, 0x00933b094b0fff7a, 0x006b9238a0b49010, 0x0053d79a27a1e8aa,
+          0x005b5d490d0ede34, 0x001a433ad5c86c57, 0x0000c946e9a96945},
+         {0x008c169d34ec105c, 0x0058b06cae6f2c90, 0x002781e4f69fc618, 0x0092f7bc24ca8b3b,
+          0x0085647dd011575d, 0x00332355b5c0c7ca, 0x0000ad9b39021726}},
+        {{0x00f5fddc5077a516, 0x003af4623b060cb8, 0x00a19a4bca36a1ef, 0x006912414a5c5750,
+          0x002e0968de8c968c, 0x0028b33f40ec4944, 0x00007bc6fd8bf95d},
+         {0x00a4351b5acd1660, 0x00b9498a60166136, 0x0099b07eb8b8d592, 0x0089cc00fedbe3ea,
+          0x00fce50f378225fc, 0x009d5b597ab6db4e, 0x00000333568f0308}},
+        {{0x00cea39d5a9acc3e, 0x00b048f6b9d9a587, 0x00df06eeface6b39, 0x00c0a41d4f67dcd1,
+          0x007242fc62437010, 0x0007354638d7a130, 0x000017676b788f28},
+         {0x00ed81c6656b4743, 0x0013c73405f31000, 0x005ea3723b917451, 0x003df343885637b8,
+          0x00158835c4bb98cd, 0x00d5ba9496e8d921, 0x0000993ee062e614}},
+        {{0x0065c43948a8eb3f, 0x0045a79c2ed0374f, 0x009d24c02ff00278, 0x00c6d3ed74920e3d,
+          0x0049a156a0fb955d, 0x0053a4441a63c98f, 0x00000fb13320c25d},
+         {0x00ddc2d60f9112f0, 0x00a1c89b141066e7, 0x00f0d87d4127c693, 0x00c8964c176a3f66,
+          0x00f1a1bbddcc9f5d, 0x0086fd5ed9a4400b, 0x0000517e440e566a}},
+        {{0x00895548351831e8, 0x00d2c94e9acd1558, 0x000b70e55eff9e3f, 0x00472e3a7b9b8632,
+          0x00c62cfa18c5949b, 0x00ffddc6e9e8d55a, 0x0000275622546d44},
+         {0x00d729675dc57284, 0x0037faacea15d764, 0x008911d4ad4c5970, 0x0028f6a89e7d6dbc,
+          0x00ecea6373f2755e, 0x00a22f64d6f50e8f, 0x000079df66d85752}},
+        {{0x004b4a6c5d3b5c2c, 0x002b8c0ec18dd4de, 0x00deb162a67baca3, 0x00e69f2f7cc59fb5,
+          0x00fbb74fdb0e476f, 0x00023fe819ad9ad5, 0x0000258d11bcf37d},
+         {0x001b88e9381f5139, 0x002d88da0c24d2ba, 0x001f5bc8c4c2cb56, 0x0064b3949fbf7fa2,
+          0x00ff03a9d3e67324, 0x000d6cb075f78ee8, 0x00004bb840aba379}},
+        {{0x0052634048bf2f9d, 0x00e8853baa7ce4c9, 0x00ef782582f93f6a, 0x00620c56d75a1e90,
+          0x00476bb1c6b05d99, 0x00fec4cf2520ab3c, 0x0000cb5bbdc78d1d},
+         {0x00ddcdb5f6c1d654, 0x000a971a5513b88e, 0x0059bfb856264568, 0x00fda13016141d80,
+          0x002a8f56f4c8d311, 0x004f40a99164e414, 0x0000cebdb2c05ef9}},
+        {{0x001527f7d6e3a961, 0x00fcd69f5bc5b739, 0x004aebd66a30e2bc, 0x006485df1fdda337,
+          0x00c145a9d3abcdae, 0x000a15f64a26130a, 0x000044a835f8d4cc},
+         {0x00d35f34fdabee2a, 0x00987055f15ff272, 0x0091f3fe85922a6e, 0x007e3613b9b95762,
+          0x007fe77941fd98ae, 0x002ed05905e53430, 0x0000ee2744eccbb8}},
+        {{0x001a282b2b67f0b6, 0x0028a23cb621fc5d, 0x003163e19b59328d, 0x002bbf6a3bbc4a00,
+          0x00507a11b39193e2, 0x0090667362e8e4c0, 0x000021939403a06c},
+         {0x00fbd205ad69946d, 0x000e1ceeeea88792, 0x00800ca932085246, 0x0091697a4897409d,
+          0x0011b32f2eaaa539, 0x00c3acb155926804, 0x00006ab37bda00a4}},
+        {{0x0074576d1e5b0abe, 0x008bd06b5a969dcf, 0x007977dab4c0ca72, 0x004b31a41547e2e1,
+          0x00c462ab6c900288, 0x0019ae3f0be97e54, 0x000099390fdc144d},
+         {0x00fdc8877cc5cefc, 0x00ef60d427bf9191, 0x00beb00258bf28a6, 0x000f0a29ef5ce9c2,
+          0x007bb079a39e4c69, 0x0094541b515879e0, 0x000008b6271f3f39}},
+        {{0x00d34702491355cd, 0x00f8c5164750cc4b, 0x00660cf64227875e, 0x006ec6d66ac172ed,
+          0x006eea069cc9710c, 0x00b65fe351e08fd0, 0x000094f36b7c2e88},
+         {0x0031d9cd646841a7, 0x003305e4dcd7bf55, 0x009abe13e0447202, 0x00b6dfdb85164c2f,
+          0x0093910c3f6baab6, 0x0006f53dc9645814, 0x00000dbab1d15ea4}},
+        {{0x006ac049820d0703, 0x00509ca10539513e, 0x007b701067e26337, 0x00f1138eaf1ff3ac,
+          0x00aecd6047919d0d, 0x00c8333ce7e314e1, 0x00007db9585baf5d},
+         {0x0072dc18b781d530, 0x00a5ab8161b109b3, 0x005f5485c6dd44e4, 0x009510c263d99826,
+          0x00a3dfc2ea62275f, 0x0056a6c86e3ccd4e, 0x00008b5956a4577f}},
+        {{0x0050f3ae6c464922, 0x009c48ee21b1b306, 0x001bb9e1e8fffc5b, 0x008abe699a7beda2,
+          0x00d205d1322cf2a0, 0x0005fb8274f0710f, 0x0000f6969f0a5a15},
+         {0x00991331578562af, 0x00f5bed4d69c4e4d, 0x000c0289da5ae201, 0x00dfab858f3301b5,
+          0x007579add7f52598, 0x006e8e7ab120731e, 0x00000ea8371a662c}},
+        {{0x0035ec7ea7f3e7be, 0x001bf2d4cb4ac5ed, 0x0016512d5095b1b5, 0x00a3ef51d7d9771d,
+          0x00bd1c1f41060eaf, 0x00dd2d4dca2c0791, 0x0000abfa1b77f098},
+         {0x005b6216476f8c83, 0x00c63a9d9609eecf, 0x00d5cb5a56fa43f6, 0x0057f4ad98fd7db7,
+          0x00b381e4cd026f94, 0x0010cc9e14c16aba, 0x0000e7c028737ab5}}
+    },
+    {
+        {{0x00edb737f3cddf3f, 0x00411943c7549c3c, 0x006b29199be62a4b, 0x0029f24c098d3178,
+          0x00210950aaac218b, 0x003eda11fac541d9, 0x00001bfd76a030cc},
+         {0x00abd76200f30197, 0x00a04fd4e9c56307, 0x00a8d34fde05e364, 0x004def5a2f0a18d7,
+          0x00fb8100796343d6, 0x0027c98c49bb4acd, 0x00004bf2143e6fef}},
+        {{0x0009727869a2bb56, 0x00313fbcb37f0563, 0x00b4f534aedd0af8, 0x0081ae25f4ae7e1c,
+          0x0082aa1cd6c2fe4d, 0x00ace97e2ff959ac, 0x00006fe7983cbd4e},
+         {0x00b295809a84e277, 0x00a2a6812fda5fd7, 0x007b4fde7b5c850d, 0x00f9bcef590568a8,
+          0x00f717fee5c551c7, 0x005a27bbaeb974fa, 0x0000fa23e0b54a60}},
+        {{0x001d3093bb2229f9, 0x007ae072527fde50, 0x00216d3573b7d090, 0x00dd401c85e08f53,
+          0x00b992ff45abe907, 0x000900517df947e7, 0x00003ee68336eef5},
+         {0x008a91629419091c, 0x0080bd4ce6d5ba14, 0x0063f58a09d0fa4c, 0x004f0fcbf4f12344,
+          0x0005925619268b95, 0x00e6bc10d777d7fb, 0x000093d72dacd370}},
+        {{0x0037829a84dd3300, 0x00477cd836a67f3d, 0x0034b529d246e6f4, 0x00d123bbd6c0329f,
+          0x0031c37eed64d356, 0x00a73fe156a68c4a, 0x0000a26c61d7975d},
+         {0x00bdd42b46256d01, 0x007c17bbd38d76e6, 0x00fe32a9370e68a9, 0x00157c9e25d4ccc9,
+          0x00414924ca6b4c84, 0x0085b737c47e293f, 0x000035b90f848452}},
+        {{0x000cb374c0ed9f39, 0x002f5d46cdb4398c, 0x003869c00b0cbe6d, 0x0041effefb37f075,
+          0x00600bf744c39f4a, 0x00a98cdd2a758403, 0x0000852a261edb54},
+         {0x00a751bea1bb628e, 0x008ec1da40bb850e, 0x00d69768bdb72eac, 0x005c85da775a9973,
+          0x007f9d14433eeaeb, 0x007aa0ff49fe22d5, 0x000093d933e40976}},
+        {{0x00958faf51e8eff9, 0x00e8a61585f15eba, 0x006ee792f224aa40, 0x002ca93d44e9703b,
+          0x004d34595255f207, 0x00e407f869aa900b, 0x0000521b88721e52},
+         {0x005f1f6fa2cecf68, 0x0000e633b8dc14d8, 0x001fcf3be78a10e8, 0x009de59a4cb14187,
+          0x0093a52ba6556248, 0x00e3ff594beb8c95, 0x00009645e44b80c0}},
+        {{0x00ff407a8331fabe, 0x00cb7f5d078771d0, 0x00052df20c3cc606, 0x00951c9fa421e7ad,
+          0x00f1ad2d897f6a26, 0x00623fac8280228e, 0x0000c50099d0ef18},
+         {0x0071fcce0c1df5b9, 0x00204933aa8a6428, 0x00417807eab2112d, 0x00ed8a85a59539e1,
+          0x00c877bbc105357e, 0x00bf5309958e7bef, 0x0000c9610b4841ed}},
+        {{0x004e4d05081ac1a6, 0x003730a1fbcbbd27, 0x00381a04ccf47fc7, 0x00e411a10560515b,
+          0x000c71c7d9ddf253, 0x00afc08590d6144a, 0x00003fcfd59dddf5},
+         {0x00be4469a87ac7c8, 0x00c03aea68db3ded, 0x0066c4b75a17cfb9, 0x00f05a99e1a62e64,
+          0x00e41165dd99e65e, 0x00c5698dd4e1c16f, 0x00003b75e0e9e8b1}},
+        {{0x00f256616f1b6ecf, 0x00a7648a0611b5a6, 0x007f0d1455bd1583, 0x002ac7223a8197b5,
+          0x002ea377ebc830a9, 0x00f326e5b41b6383, 0x00004a72a0bd51e0},
+         {0x0071ee43fabdf519, 0x00520c1e32bb8dc5, 0x00e006926e7a4fb3, 0x005faf078fd8a1d8,
+          0x002e429f7c86a13a, 0x00e3415287f696be, 0x0000a37e39b809e1}},
+        {{0x003fd897a32d6d70, 0x0065a175c54fb902, 0x00edc96308c54d8c, 0x005080f0d58632d3,
+          0x0099b4e72f93c692, 0x00baed426eef8f08, 0x000008a195767a1a},
+         {0x00fc4aa86b660b8a, 0x0089b5318bbb369f, 0x003beb4ee4604eb1, 0x00c2862a93e16cd2,
+          0x00dbf2d2d1b79b16, 0x0066866e5c96e630, 0x0000c56107da87c7}},
+        {{0x004cb28589b45cfa, 0x00dca8ff39c45265, 0x00485ee9882ea428, 0x00f14871ee1a8b98,
+          0x006db1e16a4497c9, 0x00b5d9513be6c985, 0x00005b113d30d2e0},
+         {0x0002c3cc9dfdc36b, 0x00e80b61bf8b1672, 0x00ae0116a5ff1eaa, 0x00988b5cf241c8ce,
+          0x00f269754ee0b758, 0x001a5f7e5518fcfc, 0x00004835ebbe3b8e}},
+        {{0x001ca67475a8ee8b, 0x00956b43c10066a1, 0x00f70d91cfc6af36, 0x00282a24c4a657cd,
+          0x00753e188b1f68b2, 0x0067d7c1b8175a8e, 0x0000c23cd1e16b61},
+         {0x0058d5e3641e8280, 0x00161cfaeed936d9, 0x006946e239c72187, 0x0083ea503b1686fe,
+          0x00cc91adaca02378, 0x0016dcce970a68b0, 0x000032541b9e45ac}},
+        {{0x00bf12500663cb59, 0x001a4ccce9bb795a, 0x0011676735872473, 0x001dead97fcd7b6c,
+          0x008b07bcc893829c, 0x000cb57bdcda5bf2, 0x0000c39d5942ebb6},
+         {0x00f6ff0b2904589a, 0x002dbd1ddbb463a4, 0x0013220b2ee531e4, 0x00aa20661ac866de,
+          0x000498c704e72127, 0x00db4f58b94d9d42, 0x000024b080e494ef}},
+        {{0x009266f16e4fd664, 0x00cca1bf7d42be42, 0x0032f41729a99e6c, 0x007e6d2fa1b3524b,
+          0x00044d3d3dfd13a9, 0x005976441d071b0c, 0x0000dbcbb763fb04},
+         {0x006ac38fdfd057a7, 0x00a78d23064b4bca, 0x007ace80b0fd7b60, 0x00afa8d3c08d388c,
+          0x005a73371fe08514, 0x0059502570017c1e, 0x0000e87affff18d1}},
+        {{0x0027ba67c5ebb37e, 0x00c28023a8782090, 0x007c7e9432dc6527, 0x0000aba599726dd4,
+          0x00da248afa27901d, 0x00b51b8c198d9cb9, 0x0000c35006325ec9},
+         {0x0027fe88c6f770a0, 0x007ee2110e2dbb37, 0x002c7266a7386c5b, 0x0062131c842d5bbd,
+          0x00ee9b790868691b, 0x00fb1ec1a83f9c8b, 0x000052b23bae223a}},
+        {{0x00988641044acc65, 0x00be4d48ac42b2bc, 0x00a1d8be8b31b52d, 0x0002c00b31d23337,
+          0x004d57ac875a82b4, 0x00cb79b81682fa0e, 0x0000a79e73cdb31b},
+         {0x00e8af1914f02364, 0x0011f5915565341e, 0x00a1e5b5a54d3632, 0x00c1c64b5670b3c1,
+          0x0098448b213f21ac, 0x00ee82d53ff1b67c, 0x0000f968aa661801}}
+    },
+    {
+        {{0x0006a282ab439af4, 0x008e1f12420766d2, 0x00ef1679eb07647b, 0x00cccf75e5ad5f3e,
+          0x00d54e246abc78b0, 0x00c0e5357af9c567, 0x00007e82969438ad},
+         {0x008802d29d59b25e, 0x00bf581420186528, 0x0055b94b0e418c52, 0x00049123ac53f0ed,
+          0x000b631686d98037, 0x0055278e46031e44, 0x0000c21d858a08f4}},
+        {{0x00696af6d64d2952, 0x00eb66748f6ead4e, 0x00c7d1534823ef7d, 0x00dd288d7d9096bc,
+          0x005e717c2054f902, 0x00f967f85d74567d, 0x00005fa4b4c2bb71},
+         {0x00786eaf6b485567, 0x009c0bb44ad77f58, 0x0096e8aee002f986, 0x0062afda6a07e6c1,
+          0x0006506f8fc0fb5f, 0x0054eab18290fad7, 0x00001a00f5e4d88c}},
+        {{0x00a89cdef320d9de, 0x00220a0ed67e91e6, 0x004dee9e24efb1a0, 0x0001625918067082,
+          0x004481cd9c7299ae, 0x00139c79babe7bf8, 0x00001192874f2e4c},
+         {0x00d1cfff13652f20, 0x002f2d339a0fc94a, 0x00ccdd120d3f4e40, 0x00c94f71b27cae7b,
+          0x003dcb8ad6732675, 0x00e7b56970613226, 0x00007e12c1e03bde}},
+        {{0x0046384c627a9091, 0x004435c1372ed5a7, 0x002c1c694e854a2c, 0x000a95805b385112,
+          0x00b23fa68ab4dfb4, 0x0037e59f40ccdca5, 0x00003e95bd455a0f},
+         {0x003d78719332bc34, 0x00dc5d6e7ccd8dd7, 0x0091b6bb4ab9d68a, 0x002697a76b2ca70a,
+          0x0038c51562bd5ce0, 0x00bb78da78ef9a0f, 0x0000618505f6165c}},
+        {{0x00d06dc049f247aa, 0x00d0312fc03261e1, 0x00c93665bbb78acc, 0x00214b7089daaf86,
+          0x0055a40795043736, 0x00667bcd6ede2595, 0x000002b65f880cc2},
+         {0x009c51114e45ae5a, 0x00d56ca46fc77902, 0x0071cd9214119548, 0x00a1952cba16dd09,
+          0x0099ab36e6cdb511, 0x004c7e0612a52380, 0x00009dc68fd7f6b5}},
+        {{0x00d4b65020d5aefa, 0x00fc24860d0e1d47, 0x00c24cd36f953aa1, 0x002c91a20b0f575d,
+          0x00f7f538f7793e2a, 0x00f395ff2641afae, 0x00008c45eb14a668},
+         {0x0034bb3c4b25642f, 0x005ffc08ebd203f3, 0x004333bca4b91fc2, 0x00d4b9250a2cdc78,
+          0x0042dec1ee1fc6ff, 0x00f43e76a0fa4c2e, 0x0000c2bccfe37e0d}},
+        {{0x0098a97fe88ac617, 0x00100de54bcb6f37, 0x0006747df58fd04d, 0x00705b489d1f50c0,
+          0x00179a998195e5b9, 0x00d7fe1b04929aab, 0x00008841451d66bd},
+         {0x00fba9a0664e195a, 0x001c42570dcbc10e, 0x00acf8982e759c47, 0x00c792c14458bd7e,
+          0x003155bb97afd007, 0x00ecbea987fd2a2c, 0x0000bf4c6cfd9af5}},
+        {{0x0092d2a131e76220, 0x00a60bff7003c639, 0x00398f1546be7ad2, 0x00e8a1a2a3db6a4d,
+          0x003d3a02b13228b1, 0x00f4d91470159c99, 0x00005b4e8b1d9e9b},
+         {0x00cb85e90cd001d1, 0x001a9d3df1dfe26f, 0x005ac8a2265be078, 0x0037a9b579f65028,
+          0x00c746098727088a, 0x006d33bb844df222, 0x0000c3742094d547}},
+        {{0x008c89fb3be7984d, 0x007aa7c39ca25e40, 0x002e3fe21e0a58d8, 0x00b9fcf5637992d3,
+          0x0003c48dc07ded04, 0x0056e763ecda7133, 0x00008149356fd54c},
+         {0x0033277fc17877df, 0x0083925a1fc4193a, 0x00c90daf43550f90, 0x00c80874fae0555c,
+          0x000e35da163558aa, 0x007d1d6b1164ce47, 0x000018f5b71814a1}},
+        {{0x00dad47faaa713fe, 0x007a090f57e562bd, 0x00e29063452c8217, 0x00b99e8abbdcb108,
+          0x00fee4fe78d6b93b, 0x00446683a000752a, 0x0000b9294298a940},
+         {0x0083981f1eb9b53c, 0x0092f877da718a55, 0x000fac3da3d148e8, 0x00d1a0053bd2521f,
+          0x00db6408b7b3ece0, 0x00e676a1a56f63e4, 0x0000cb2ea5835be3}},
+        {{0x0011cf13dba72169, 0x0021a32840547c12, 0x00125a287f1a8778, 0x00fac48efa3e02ba,
+          0x009d181c929ab772, 0x0037d15c5935f450, 0x0000edfa25aa5ac1},
+         {0x0030327640e34d80, 0x001b5c5aa466b844, 0x00455aa75e1b61d8, 0x00129faef64280b7,
+          0x00787eab22cb8db2, 0x005717aac7fb1550, 0x0000a94b8ad5b917}},
+        {{0x0041b4579e1898bd, 0x00962da34d0c59a7, 0x00300dbcfd0eceaf, 0x00050fe57a181a20,
+          0x008082d42e4a6c70, 0x005c87efa726990a, 0x0000c5fbdcd86232},
+         {0x005b15430d5a2800, 0x00113739eae46693, 0x00903460ebdcc74d, 0x00889d3220b3b8cc,
+          0x00002d89d8f3e6bf, 0x003f5d439a1a855b, 0x0000258f35287744}},
+        {{0x00bb82fe5262e15e, 0x00397b504f7eddfa, 0x008bf16a355ad1cf, 0x007d23b4f2570409,
+          0x007d9cad2443749f, 0x007bb5a60856b0f6, 0x0000a5cb39135997},
+         {0x00f8ac2920bab521, 0x00fb15849456074d, 0x00cb59cc0a54caac, 0x000bfd4e374f08b9,
+          0x0082fa05848cd3dd, 0x004cb1f8cdc1ecc9, 0x00009f4af5faf1ea}},
+        {{0x000e0ca0bf56a6b1, 0x00bf417acf74e571, 0x00cb0be54da2f3fe, 0x004ac4548a2d409f,
+          0x00ded2921e78f297, 0x002d4ade2d377c51, 0x00004f43d5ad3ea4},
+         {0x00d26891ab481279, 0x00105e57c6866b40, 0x008751d43e62c588, 0x008475dd40a36674,
+          0x00bfbe6e9aa0c465, 0x0079204638780f30, 0x000095e50d4d93c8}},
+        {{0x004744ffcc698377, 0x00b12b07ec36d51f, 0x00fc861927e1e349, 0x0047d1aa5bb253e8,
+          0x00415309aee1a152, 0x00c7623b4a173b49, 0x00008d1f4021fd89},
+         {0x00f2ee3f660ec79e, 0x0022b2ef9c3c51e6, 0x00e0ee882a63a204, 0x00ec6709ba95ff14,
+          0x00877fadf6d89700, 0x0004e61d3af25ae0, 0x0000f628ac29fd16}},
+        {{0x007486f772d161f7, 0x00b78afd28106d74, 0x00a410c02ab79128, 0x0044846763960248,
+          0x005968dd4cf3b26f, 0x005f8fa8fd9bfeff, 0x000023182077d5a6},
+         {0x00998de43683a3d4, 0x001a42576de262f3, 0x004868f1c1a5e423, 0x00e2c0d68f7eaccf,
+          0x00f3e91d6fef814d, 0x000e7b98861fea9a, 0x000094c27ee7f50a}}
+    },
+    {
+        {{0x000b4bf40890acb3, 0x00ccff3fa4a98a0e, 0x00736773eb6a433d, 0x00de5d25aa0ae618,
+          0x00a8e452d5dc4ca5, 0x0054f3df8323ede4, 0x0000309b53bc5a19},
+         {0x00232f66a3c6d3ca, 0x00b40a835bc41180, 0x00ebb3768c1575e2, 0x0069beb5edd942db,
+          0x00008068123d1ad1, 0x00831a789a0f12ff, 0x0000169332d565e7}},
+        {{0x0098bbd02b09e878, 0x0007d81829aafe1f, 0x007782e9017952f3, 0x00093f59acb562af,
+          0x00a94bcc9f2ed456, 0x004bc3755ada68ab, 0x0000c2b20b954cc7},
+         {0x00b1aeb277d356f7, 0x009941afc29764b8, 0x004aa18b7e811150, 0x00c38dafd4bc1f35,
+          0x00565b4e1d4565dc, 0x0087e00c998ad9bf, 0x00008274d3e1cf05}},
+        {{0x0049ef6cc6552951, 0x0067b850e228dad8, 0x001754f13ba8947a, 0x00f59316f39fba5a,
+          0x0098c1c569c2cdd7, 0x00357342d20ec031, 0x00009f32ff958e43},
+         {0x00027b3b26f326b6, 0x00eadd987789d974, 0x00b55a105fe80509, 0x008707efc25e96b5,
+          0x0080589f5f00a173, 0x00c7d30f8035ac64, 0x000020b74355c979}},
+        {{0x00da59b0d9a0d716, 0x0022663ba5812809, 0x0085f30671a0e90f, 0x00aba22d8ce867df,
+          0x00406ee84bf10cfb, 0x000053017faf5418, 0x00004cbf6414b97c},
+         {0x006090d9b0228bd2, 0x00843f8074509551, 0x000728a501be2599, 0x00fea4fa162fe052,
+          0x003baebbbffe106a, 0x006837f83a3767e0, 0x000071b00e3d8ec6}},
+        {{0x00a2c11c9afbf9f5, 0x00a44a160cd93323, 0x00af026a55ba60df, 0x0066903d34858331,
+          0x0071791b65b1bbec, 0x00b13ba82cb65dca, 0x0000416d8f43a61d},
+         {0x00bb6b1f2725959f, 0x00ae3ac1bec182b0, 0x00d37b30a37c7e85, 0x00cb1f79de2f58a1,
+          0x0089edfa02bf09d7, 0x0000764c8e7cb425, 0x0000508a7a0f7928}},
+        {{0x009640b10a11c4e9, 0x00abcee82ba4dec8, 0x002789000518c28e, 0x0040d89f23d69033,
+          0x00b11a896a29f00b, 0x002a52128486ab0f, 0x00001ed35547182d},
+         {0x0071c9aeb5a2b378, 0x0070c7fe9a18dac2, 0x0002d934ef53d309, 0x0017b689181ab03e,
+          0x0048b89ed1b0475e, 0x006c29358c19b806, 0x000046a381d216f7}},
+        {{0x007ffc1b8bbca3fa, 0x0010daeb8fbfa3aa, 0x00041bc2281fd7e3, 0x004ae9396f7bf975,
+          0x00ebedfc03b31112, 0x00d54df0e1580df2, 0x0000e49853949fc0},
+         {0x001be140d7e82ca7, 0x005cbad4b581ed81, 0x00d1c2d858308ef8, 0x00811d859e806e3a,
+          0x000c98e0330d5da1, 0x00aca4ac4f0ed781, 0x000046623d752a2a}},
+        {{0x00e288587503e42c, 0x001684fc8cb717f0, 0x00bbd151dea33e40, 0x00b62503394713f3,
+          0x00ae904e064a173b, 0x001ea66e2759e65c, 0x00003c5de2b2ce4a},
+         {0x0078c2feeb52ba01, 0x00c788494c19dfd2, 0x000b7474a19ea221, 0x00af4234bada93c0,
+          0x00d976583b25a36a, 0x009231a7b77cd59d, 0x000048c7f4e4496c}},
+        {{0x00f766d64db646b9, 0x005fe892420a73be, 0x00c241bff9503bf4, 0x00bb88ab52af1487,
+          0x00ad5801ea218757, 0x00d48a98c7c2ad07, 0x00006d10691e299c},
+         {0x00f416040a864d03, 0x005a28b5c909fb9b, 0x009f149ed2e131a3, 0x007c2e5713dd2d5f,
+          0x00583bed1e8751a5, 0x0048fc36dac772f2, 0x0000bebdc735ed27}},
+        {{0x00cb25fbf65ec4c1, 0x00b134e4c3831162, 0x0012d2ce88d21958, 0x005bd6f2d36b12c1,
+          0x00657227e2946311, 0x00344374ddcae18e, 0x0000262a2a1a50c7},
+         {0x009066b15a2fa59e, 0x000309dc85dee158, 0x00cfb8f04a017129, 0x0023867d0a85f2e9,
+          0x00a4c5e3d8850869, 0x00eeed9a3f5486b1, 0x0000ba4fb6b74c24}},
+        {{0x00ce5e806b5f895b, 0x00163b52e7597c64, 0x004452832d487f58, 0x00bfc58a5d59ee68,
+          0x001e47e93ef8e9bb, 0x00ed577b75dddbf1, 0x000021101c3ec9b6},
+         {0x00537e2acb00737a, 0x00ccd212e3bcb56c, 0x004e423428e3720e, 0x006a6c04cffe349b,
+          0x00d79351561276c8, 0x00d84bf6b93246bc, 0x0000f1834a04c30d}},
+        {{0x00b925744c25596c, 0x0084092f6a490d4a, 0x0033fea2227425a0, 0x00b8ec1ae69ed3a6,
+          0x00f2c6a4ee083594, 0x0058f4f47609edf8, 0x0000fabdeca051c0},
+         {0x0060243843f8483b, 0x00041df90238d08d, 0x0076a2a80da378a0, 0x005c043308b7f388,
+          0x00aeb3db7fb8d3ce, 0x00cacec00be40628, 0x0000488601d76bd6}},
+        {{0x003891ce42f2661b, 0x005a4020885d7d28, 0x00aeaf7d3ac33f44, 0x008e08bff0687c0d,
+          0x00f1ad165b730af5, 0x00abf9a43e3e0598, 0x00001a6bcb1253bd},
+         {0x0018fa8522f1c747, 0x002464eb25ca52e0, 0x009e6d58bd71290d, 0x00c4676e3a349d9a,
+          0x00bf0413ae2a542e, 0x007de678fec28f29, 0x000077aafd5d251c}},
+        {{0x00bf5d121d3dfd0c, 0x00aa302c24b9aaba, 0x007a9ae97d56e2ff, 0x0039629c0bf87d24,
+          0x006a96f280d236c9, 0x00c4496d38693d75, 0x0000e27011c9495e},
+         {0x0035455a3be1334a, 0x00f576cc7c833fb9, 0x006c237696e0a8cf, 0x00e1eaf34173fcdc,
+          0x00284f88f1846b9d, 0x00a13496e700f2ab, 0x000069a997237c67}},
+        {{0x00879a3961cc88f7, 0x00ac024d00e1ff22, 0x00201f35107e11c2, 0x00626e895e311595,
+          0x00281f29d4ae64c3, 0x000a26607db8baf3, 0x0000220622216507},
+         {0x002f2a2cf5dd7f51, 0x0050568faf6349ac, 0x0051f8db0f329bc1, 0x00d19e341a40714e,
+          0x006210be89e6e2da, 0x00c913b738576572, 0x0000818d8712f547}},
+        {{0x00259bb755e88090, 0x00634c98f8dc8449, 0x005149cc02693f28, 0x004ee5b904b8708e,
+          0x00a24159749e1309, 0x004908fd349b000e, 0x00004ff62db51dc4},
+         {0x0020f7f7d2b2d177, 0x004bd36b23ba54ca, 0x00c52f4d160fd389, 0x00f7e3fa56cb11a4,
+          0x000afe38d0a568c9, 0x007777b2bdd94711, 0x00006a88b3b1682b}}
+    },
+    {
+        {{0x00a1d5a3a9cc302c, 0x00cbb47f1b473882, 0x0020caff7c212459, 0x0007dc8d2d6ba45d,
+          0x00bf275acb45c92e, 0x00ad634e21be5c75, 0x00003496fa5956f0},
+         {0x00b8429e1acbf606, 0x000e806d14096ca1, 0x0048489e45f275f6, 0x003dc9f8f4f18e18,
+          0x00fa9723700a3c77, 0x00b728109e263556, 0x0000c1b79b2546f7}},
+        {{0x00c5129722c317df, 0x009e8f93f78a5054, 0x00a048a8029b1b70, 0x009ca255afee5c4c,
+          0x00ce159bb55cfe22, 0x003dd76e9ff806fb, 0x0000c948a0020121},
+         {0x00c6ee578032ae22, 0x005370837263de79, 0x00016c9e06d934c9, 0x00edbbc83bf7c553,
+          0x001c6ded58f7d1d1, 0x00f0a0478a56ade8, 0x0000b1415ce2588c}},
+        {{0x005143afefb187ec, 0x0052228f78a0e96f, 0x00d465a4c1b339ff, 0x00d1fdbb4ffb0277,
+          0x0029ffa85ce113a1, 0x0069da7fdfc496df, 0x00001f4d0929ea8e},
+         {0x00df0dae40e45e60, 0x00fa3ec93e8bd8d5, 0x007dd49edeb237ec, 0x00067d7c03e0559e,
+          0x00047a8418a45cab, 0x00d261edbc18ed20, 0x0000f18d86f1df92}},
+        {{0x00c45ccb413a8a58, 0x00e29088cf9e18ae, 0x00eecf9f30812382, 0x0045734c83329181,
+          0x007c594fa8a67271, 0x00fbb3f27ced7510, 0x0000ae9adc82729f},
+         {0x007ae5d12cc6ec7c, 0x00ff54651bf9dc68, 0x00fe1fe3fcf4ee5d, 0x00fd7298e30e4def,
+          0x00e96d9393b957f7, 0x0055c22125bbc17b, 0x00008ee10e1971dc}},
+        {{0x009fe64ad3e97072, 0x0050cd2fbd7f790c, 0x00f19cbe6cf72845, 0x0094c3a578f8fc6b,
+          0x002462a052d74360, 0x00b7082a69ec3aaa, 0x0000e36502dc1193},
+         {0x004cb1c035d98a6c, 0x000b9b7ca465bbda, 0x00a79dba0be17d5c, 0x004ccdd34a9ca076,
+          0x007c564fc7a200e9, 0x00a799ae7ace110e, 0x0000397cb52b6e28}},
+        {{0x00dc7a1c9d4a1ab2, 0x006f734a3d5a1121, 0x0004c31f23a82d17, 0x000afafb505068eb,
+          0x0022a5564711a082, 0x005931df89a995ed, 0x00003293eb4819c9},
+         {0x0068f2b2dc82bba6, 0x00716206618e9ab4, 0x00343eafe092bd74, 0x006900ea494b8e2d,
+          0x00848a48e6349ad1, 0x00e8278e58405104, 0x0000efe040611468}},
+        {{0x003153dc2fe96368, 0x00041b872a3a8791, 0x00cfbea79c0c850f, 0x00833a1d9e91fd0b,
+          0x0054e57331d066cd, 0x0055067eb9ae7975, 0x000030b30157106f},
+         {0x002d6efeb204e6f4, 0x005d4a33a8185e56, 0x00b96551f93c299b, 0x008a6922176ab5d5,
+          0x00cb1237d620d152, 0x00fc0bca2597c5b2, 0x00001778b5f7806a}},
+        {{0x00d0f9e0b16c1139, 0x00a5a4d463658e46, 0x004b9c38421124c9, 0x00407fb720c22956,
+          0x00b1a7dba3292189, 0x00a72436a16db005, 0x0000a4830960657f},
+         {0x007f21b37959780d, 0x00c9b981b17693a6, 0x001ecd220ccb2d58, 0x002b296e0c7538bc,
+          0x006396365ea640ee, 0x00f2b60c0656d389, 0x0000873ef4e5bf6c}},
+        {{0x0075d447a77b3b63, 0x00937de4236d339e, 0x003b13883603df69, 0x005ca030a4747ea9,
+          0x0065f3652be9610b, 0x00e2536a62deb8b7, 0x00005369cbf7c81b},
+         {0x00b4c6ce6f1aa3f5, 0x002f375d143ce10f, 0x00392ded2e71fec7, 0x00eefc0c33c3276f,
+          0x00937fa8a22d46fc, 0x00c736a6368a14de, 0x00001fadc15612eb}},
+        {{0x006310d8dc0657e3, 0x0019646b48063efe, 0x0079dd445e26e8f5, 0x008f482594b2f9ae,
+          0x0031f0d6b18f187b, 0x00cc975da90d2b45, 0x00000eb1f1d70982},
+         {0x00e3a74511730be5, 0x00bd776218eda1d0, 0x00d1772ffad196da, 0x00f4f0ad07255927,
+          0x0008fbbdb11aef60, 0x00a4df0eab96e833, 0x0000b041a45a8fc9}},
+        {{0x0033ba5351f6bc46, 0x008a562b199c8a59, 0x003526efdeddd174, 0x00b2ff9181a53729,
+          0x0052e2e5678be45d, 0x0015a07a467b36b3, 0x000009ff898b8b9e},
+         {0x0023f6206c4a2a34, 0x0065756cda0441a3, 0x004fcb52814041d8, 0x002f6d7fec99cfbf,
+          0x005be57429ee0828, 0x003a5f3a1d25cf51, 0x0000381042ef9c88}},
+        {{0x00f445dd4292e87b, 0x0061b30dc250fe6b, 0x00c6293d535670e9, 0x0069b3656a059e33,
+          0x00375fe13ec92965, 0x003df02aeb8ac1fd, 0x00006d156042b8b2},
+         {0x003e00faafd610b4, 0x00e93e1361becc4a, 0x00e53e8dba59e39e, 0x007ec1deb50dcbbf,
+          0x0036688dc4b5c564, 0x00a37c7f0e0302b6, 0x000013707232dfe4}},
+        {{0x002e013daa826bee, 0x00c1b7fc2a917aa1, 0x00775c80bd8b8af0, 0x00225d8b5a73d58d,
+          0x009461b26360bfcc, 0x00197c2ccdd276ed, 0x00007d20012f111f},
+         {0x00b7840ca00d9f72, 0x00a531a182cd31a6, 0x00388aa2c1d3f5b5, 0x00c53e5f71086a56,
+          0x0054897f5b0c5fc7, 0x00cfa7265d89bf00, 0x0000b5bc6b54b413}},
+        {{0x00ca59b1d5e479de, 0x00c9c472c6b8c4b7, 0x00bd893380d8058b, 0x0087c7a0b4830956,
+          0x008aed3c09ab4a1b, 0x00d2ea06e670f0ed, 0x0000fa7caeadc5ca},
+         {0x0069d1a4f5e2f747, 0x00ac63df883caca0, 0x0026d1628697fad6, 0x00345ebb357cf7eb,
+          0x00e6b552edefb791, 0x0010647b23cd7588, 0x00003c63d9d310e1}},
+        {{0x00c1ff3b0ad08731, 0x00cf10d6c3364b9b, 0x005ef99d92465d1e, 0x0058fee6fe23022f,
+          0x002dbe6d0514b30f, 0x002398dc39f98e65, 0x0000c11480716fd2},
+         {0x00ee7b7dc61cf86f, 0x0009ec153e81d2a7, 0x00ea8c3450da2409, 0x00fb3a69bccf65ff,
+          0x00d13b94ced905b3, 0x0018b9733bb86eeb, 0x0000bdc0561a53b4}},
+        {{0x00515bb66f04b220, 0x002dc4859911cd9e, 0x00fd0d12acd79378, 0x005af3142e0d8528,
+          0x002e34333f9f930b, 0x003ed81f949fb7c5, 0x00004453057befd0},
+         {0x0090051e93bf6651, 0x0011b384a4749707, 0x00f6aaa5f5c8a572, 0x0073b415fb7fce87,
+          0x0080c122757c7080, 0x0051e6067887da15, 0x0000d54bd81a8f1b}}
+    },
+    {
+        {{0x000162f2968b4a5f, 0x00feffba0f8b3d11, 0x00c0b1666eaa1323, 0x003007a48289acc4,
+          0x007a9ba185dfb383, 0x00f21e5f5449e75c, 0x000038174a006bfc},
+         {0x007dc2544f0474fc, 0x0090d740cb718b9f, 0x00183a45ad1713f3, 0x001605976de6091c,
+          0x0055ee909b795d80, 0x007c2ee0bcd7af20, 0x0000d637fbf692ee}},
+        {{0x00ba6e36081e0413, 0x00d04739dfd202e5, 0x002901bfa966c023, 0x00d1b35b4c6b7387,
+          0x0021774d2cf020b2, 0x006b458ab2879a6d, 0x00007ba313360a64},
+         {0x0036f092ebb784ea, 0x005b897262060ef6, 0x008353689b12a3db, 0x00b3fe075a6f1567,
+          0x00bc0ac22bc75506, 0x0052636aa657567c, 0x00001e5459d8d416}},
+        {{0x00f1c0bf7fa31c8d, 0x0075153a8b9881bf, 0x0038a597c62afbdd, 0x00c1e2abca0c1429,
+          0x003ad2f1b71473f1, 0x00cfffa3803705b2, 0x0000fd80de9fe830},
+         {0x002e194b1f6f63df, 0x0098551540726073, 0x00f16fd2c4902500, 0x00f470ded8462759,
+          0x0094647ab856468f, 0x006e2f50ee8e604a, 0x0000eb5b38a8f340}},
+        {{0x008fa7e68d62b9ec, 0x00cf321eeaee8dc4, 0x00cfb60aa6367d7b, 0x0009d26ed68d8f85,
+          0x00981477c33f8e37, 0x006ba52370bd7f01, 0x000060ca55ec431b},
+         {0x00cf0bb818d1f469, 0x00dd7200bd1d1fd7, 0x00b379a10114a5ea, 0x0062e08101736735,
+          0x00adb568e7cb6f63, 0x005d340ac9e64d6b, 0x00000ba1290dff2c}},
+        {{0x00727de9c7e761a1, 0x0039a2002fddfd0b, 0x002378decb7263d6, 0x003e024b4c3d7062,
+          0x00fbec0bcbcdef5b, 0x0099293968f45f64, 0x00005db612a10c39},
+         {0x00c8f122ea12873c, 0x003f6919c92a9ddd, 0x0074d99f6e4ff590, 0x008cc2e576bb2376,
+          0x000c8eab9ff5ed20, 0x00e962f62f2c1b5e, 0x0000322ab1d768cb}},
+        {{0x00fa0f10c8d8d4a2, 0x0092fbbf890f33b5, 0x00cb89a5a32aea83, 0x000934c3875c64ad,
+          0x00fd4256df4300fe, 0x001ce34abaa7fa2e, 0x0000930041517f60},
+         {0x008e067529917cf4, 0x000f229e010ef42e, 0x00967aba7271acd1, 0x00c6e96d4a937f96,
+          0x00b55c0125a58c89, 0x009131d8c2214b30, 0x00005efc7c886437}},
+        {{0x0064ce3db9151a2c, 0x00a30d2de95c08f2, 0x00e42fe06e11209d, 0x00cfcc3b8edb3737,
+          0x000cad15963084e9, 0x008593b9807d7612, 0x0000e7f0de680899},
+         {0x00820666e91568f0, 0x00bf6b7857cebad9, 0x00f450b44d62a769, 0x006ce1ae053186cf,
+          0x004c9c0a8e430376, 0x0086093a45138203, 0x00007527e8c43d96}},
+        {{0x00eb8b81953efc9b, 0x0065ab7147e0f1f6, 0x00c640fc9ac99ab0, 0x00c7f3f9f4b93cc5,
+          0x00b49a5e3fe8abd7, 0x0073a0c30304ed65, 0x0000351ee7eb76e1},
+         {0x00f5a25ea2137d26, 0x00903b7b8fe66709, 0x002ca15352362d36, 0x00a78f713f9dbcc1,
+          0x009f159e91420b17, 0x00a289e6602f60ec, 0x0000f7dd96d0955d}},
+        {{0x005b70c343d99860, 0x00ba2c230e138e49, 0x000d959f5549eb4f, 0x00d2d010271ae6db,
+          0x00c839996e32cae9, 0x000e66933a001b6c, 0x000043e70927c6ba},
+         {0x00925f1c1dc5cb12, 0x00a9c1aa657c7198, 0x00c7c45e7a25983b, 0x007fb1933c22818b,
+          0x0033b718d762e6fb, 0x0049af70bac8af29, 0x00003fa457783a5c}},
+        {{0x00e6ceed8958832d, 0x0063a981d3d17e66, 0x00403adebf46c159, 0x001084238ccd2740,
+          0x00945fd98823b6b3, 0x00f4e3fde4053bcb, 0x00006ce66ee79f49},
+         {0x00e47370c91ef051, 0x0017b97176aebfeb, 0x003896efb3f2ee2e, 0x00f1a85e14c09f53,
+          0x007970e3c95fabe9, 0x00a49f5c2af3fad3, 0x00000fbb472b934e}},
+        {{0x006149a446dfb84d, 0x0090a0dbbe543372, 0x00ffb05fb60fcd68, 0x00b8a55606b846b0,
+          0x008b2bed0d14122f, 0x0020008582e45daf, 0x0000b062d850a7f5},
+         {0x008280bf90ebcc97, 0x00093f702367124d, 0x0049fbf714cc2b4e, 0x004274ad149168d9,
+          0x00471e7f51b6f976, 0x007ffba09a50f69a, 0x0000d8d5f464b76b}},
+        {{0x00f821578d2cff30, 0x00f32e83a8cbf428, 0x00d5f03b86386090, 0x001238e804cad7a2,
+          0x00248ba57d2fbf7b, 0x00e15c244586582d, 0x0000a901806f1975},
+         {0x006fc61241c9b1f8, 0x006cc1b2fb39827b, 0x004c587eacb133fe, 0x007c9bea84f3e689,
+          0x00804dcda54009fd, 0x00411aa0f8ea5be5, 0x000047738589cf62}},
+        {{0x00cbd19bc7f52c70, 0x007657cdf31a65e2, 0x001eeb38d23dbd2a, 0x00ffc658b3e2c5fe,
+          0x00dc597020954adb, 0x00be0ff895bafa66, 0x0000fd513066ada2},
+         {0x00f85e601f4d0c3d, 0x008b3ff26a9cccf3, 0x0040e8af14da9aa0, 0x0032c4f5f3975765,
+          0x00765c2cc3e7e858, 0x00d163652726c057, 0x0000f8952ddb280c}},
+        {{0x004a5db4c5b807c4, 0x00d36872c30887e1, 0x0007e5531bfeb71d, 0x00ff3ef16462ab1a,
+          0x009ee67122a6c77b, 0x002fb7e093a039ad, 0x0000d6a226b8954d},
+         {0x0008db41bfbe79c3, 0x00b814048cca143a, 0x00a7fcc064b5baa9, 0x004a5c0b401e67a0,
+          0x0037acd43f6505a6, 0x00bcef4f2107e469, 0x0000425b261e6457}},
+        {{0x00d14fa316ebeddb, 0x007b9d4f682384b9, 0x002cdb73dd602099, 0x0024e82f018991bc,
+          0x000f532f6952584c, 0x009aff9105fe5f9f, 0x00008c4591e428ca},
+         {0x008842116e6dfe89, 0x00e98c16591c3f17, 0x009137e023a65dfb, 0x006110253ad79743,
+          0x00ac562fe37783ed, 0x00fccd1abe78a9b8, 0x0000b9fc25b02a75}},
+        {{0x00ad0c67e3667565, 0x009115caeb77c58f, 0x00092244896fb680, 0x007726e5728f1ca0,
+          0x00216d7a760aca36, 0x00f24ca367d78805, 0x0000be0e98a044cf},
+         {0x008913588aef73c9, 0x00f9c88fdcf0e282, 0x00de736ba12c0278, 0x008a7187e0da5422,
+          0x00515f408eda5949, 0x0062be9b9c992356, 0x000059b93f2961f8}}
+    },
+    {
+        {{0x00638f1cebb0725f, 0x0018837d0cfba9ef, 0x0067e044fd22a66c, 0x002e52691e4eb514,
+          0x005bea9c327edeb4, 0x0053785bb712601c, 0x00004468d9524a6a},
+         {0x00f303f506dfbcdf, 0x00e610bf0c2af34b, 0x001072bbd3945c9b, 0x003f2562ff339967,
+          0x002c19981088d3c4, 0x002089507c13ef99, 0x00004fc0bfe0671c}},
+        {{0x0058dd024d6785f5, 0x0095589d24e4948d, 0x00f1541e0e409a27, 0x00516936d2312a7e,
+          0x00080144594cf12d, 0x00428012f250796b, 0x0000164bd7bd0339},
+         {0x00d4a8134daea8e0, 0x00b89edbdde05495, 0x001d912115f8c19b, 0x0037f5d76cae2a62,
+          0x002ca6defb995378, 0x002a031817ddf891, 0x0000653c512ee868}},
+        {{0x009ec5622607954c, 0x00ca3a9a7cef9441, 0x007984a4ff6d2bf2, 0x00ee9f2ff12117c3,
+          0x007bd21e2213f221, 0x00e485e0f4eb63eb, 0x000019e3c3382d99},
+         {0x005498b5c87b975d, 0x00a7c66b3e9a5dbb, 0x004c9a49d17a7e31, 0x00fdde0583140363,
+          0x0017ac467c08188d, 0x001ffe80c10c8700, 0x0000dee318d9b3b8}},
+        {{0x003b8036793fc6a9, 0x0012da0f44453d29, 0x00360322c8531c51, 0x002576aba67f2cd1,
+          0x0021350a150e9dd6, 0x0030b18438cbf3a5, 0x0000e8c0a0e548d1},
+         {0x0074834d61e660aa, 0x000e4d5f12638266, 0x00a0e1e84102b95e, 0x00ecc7c57fe20393,
+          0x0076fa3d3d81b83b, 0x00ddbcb40116f716, 0x0000e2adbb833c01}},
+        {{0x00b0448fba19cb43, 0x00d102e9cc0f2187, 0x00eb00634b39ae70, 0x005cf1308daa1b9c,
+          0x00e867aae154ece6, 0x0091a1f3ceb7065a, 0x0000ae89e64a5952},
+         {0x0073f217a6b6c7db, 0x00276117f3b52d92, 0x00fb9133053fc6a8, 0x002b760dd91a483d,
+          0x00e58ba7d87d649f, 0x00d005d2a5ddfef2, 0x0000b017ce94668a}},
+        {{0x00eeb6d19dc6c963, 0x009bdfa7430b52f9, 0x005d1a0576cb2385, 0x006c2a46b33e03a1,
+          0x009080e8cb7d5be4, 0x0069f932be396dea, 0x00005e28d19a9ed6},
+         {0x003595f1e2c0ba9c, 0x00543afb3573accc, 0x007ff3cec6477162, 0x00a7c863cfc1ef8e,
+          0x00dc252c56d9d591, 0x006a47db5c6a4b95, 0x0000b3e37ec5755d}},
+        {{0x00b4dafb4c08a82d, 0x00c34a9a5fc6c258, 0x00d7c08d8ada0b1c, 0x00613d3a2ccf8279,
+          0x000059b18c8078d4, 0x00443c79545741b9, 0x0000c48c9b30f11a},
+         {0x00fd23397b7227a0, 0x0085a0fd4476b5a7, 0x00cacce509dda4a1, 0x004a7c4d0082751a,
+          0x003cc95fa12734e9, 0x005a67932f6ddf4b, 0x0000cc1b5edbf56b}},
+        {{0x00dca6a695ddd724, 0x00b33b8e32f84653, 0x003133f0c368da3c, 0x00c12e5467eceef5,
+          0x0053d17d568c2f8b, 0x003d8f6feb14eb9e, 0x0000efc23d8bb640},
+         {0x00a92437589533ed, 0x003cf8afb7b2b737, 0x0005e1c86c06c8d0, 0x00bc4d1a9d5a09b4,
+          0x0001863252f38699, 0x000d133f5d0995bf, 0x000065e4ee35380a}},
+        {{0x00808adad61d10b2, 0x006bd8003eb0414b, 0x00855abd99db0a42, 0x00533e928d269092,
+          0x00d20f494022e08d, 0x001ee056d69942a2, 0x00003c8f0082e290},
+         {0x006f1b2dd4a82d93, 0x00e8de56b305a85b, 0x0048d745c59003d7, 0x004847f5e9907f69,
+          0x00c2b6c474cfdd88, 0x00111fb765a5ede7, 0x00009e77c8d17276}},
+        {{0x00ea78f9b2a1e49b, 0x006f24694b0e2e5d, 0x00d9be70596b496f, 0x00ec9a4e6c678c58,
+          0x00d35bbefc4a9cf6, 0x00fcf8a3780fb808, 0x000050067b7ffc4d},
+         {0x0029d58c01b3a16d, 0x00946ca460679878, 0x00711baa466cc115, 0x005f74d85e17184f,
+          0x002b60d6d63bd96e, 0x009b1f99148d40b1, 0x00007b033f7f3c8d}},
+        {{0x00b09053ec456a4e, 0x0031cfcdc4a27124, 0x0034de815b7b409e, 0x00a635a78e2634a6,
+          0x008a4d3658353a2f, 0x0018c9f51e70af0a, 0x000048833daef11f},
+         {0x00bb3be07fbf46d9, 0x0058e34ca0120e08, 0x00b7547b7c379337, 0x006a73a5fe6b5cb0,
+          0x0079c11c120ec2bf, 0x002c5859b7c83b69, 0x0000808884a4ca7e}},
+        {{0x00f981e24709c036, 0x0075c7c990648435, 0x003524187f2bdef5, 0x003b6b3eecd5e33a,
+          0x00f73f093df919a0, 0x00c383602fb4946d, 0x00008a3859f215e5},
+         {0x00ac46f9306d4d1e, 0x00b1f015e20a1527, 0x00bd04a028c8c5de, 0x00575a688d185dda,
+          0x00944852996e02f2, 0x00d155f0a65639d5, 0x0000cbae8ee2ffeb}},
+        {{0x00cee29069b3c427, 0x005a2ed6196609f4, 0x00bde4015b399f73, 0x00fa2d5c51dce56e,
+          0x00669de09e28c69a, 0x007e8bad2f969a05, 0x0000ccaed4a1cc83},
+         {0x0097494cada6aaf5, 0x008672048c6b66eb, 0x00ddfd869821e120, 0x008a332caa8326a5,
+          0x00bebbbe5c66b1e3, 0x00c6c73c5d21f001, 0x0000c02ad511796a}},
+        {{0x001f2f8a3f8aac7d, 0x0087174c0df9b79f, 0x00d0a0dc3356ed14, 0x004eb8d108fb9f50,
+          0x003bc981ca65b473, 0x00aebf4ede7da640, 0x0000def49acae5e4},
+         {0x00659235be238739, 0x00c5ef83046bf456, 0x00a51f3fc9ffe5af, 0x0056bf42774fb1a7,
+          0x00d6f1941cc44a50, 0x00212abab3d5fde6, 0x000066ba96038d31}},
+        {{0x00040917fe483a6f, 0x00a0071926fbe90e, 0x00860804127c20d5, 0x0050a94a0a5b3a8f,
+          0x007387e89d4d44eb, 0x009e852c9d6969fe, 0x00006feac5430775},
+         {0x0012da12f397386d, 0x0092255da2f7a028, 0x00e1ac7ce0d37dff, 0x0063690ff7220790,
+          0x005bdbbc592ce716, 0x003c3d9718276cc8, 0x000049873e1bd7f4}},
+        {{0x0041b89936344ecc, 0x006b90d27132b939, 0x005ea8ada5b429cd, 0x0089051ef9796313,
+          0x0085677c971cfd5a, 0x00a8542e65363348, 0x00001fc2e8dc6423},
+         {0x00271304c85940e2, 0x00a24505c0ac035f, 0x001b348e65bc635e, 0x008de39b2c7af8de,
+          0x0058be0674469de2, 0x007d03ca03493a21, 0x000055cd17c9ca2c}}
+    },
+    {
+        {{0x00781202b2d6eaec, 0x0062f965b982d059, 0x00ec944ba990942a, 0x009bdf875328dea2,
+          0x0025e8414d8797ac, 0x00fe86c4f92c529b, 0x000005e65813d3b8},
+         {0x00a8e98520352cdf, 0x00e42faa20b58506, 0x0009d7718a4055cc, 0x002af1a317841ac5,
+          0x0027421376f4bea2, 0x00862968056584d5, 0x0000d0345c845e45}},
+        {{0x005aa8c77f4e3830, 0x00bb76bb93d70e45, 0x0095dcd021e6c101, 0x00e34f249dd8f759,
+          0x00d076758e2f0fb1, 0x00aded77ea714ed1, 0x0000293e65bb6cbe},
+         {0x009a7a5503253e7e, 0x00ea409102a44a9e, 0x0052b308269dd21c, 0x008cd8349b303a08,
+          0x00f7e90b51679bef, 0x00fa9d73c0d21b74, 0x0000d15647dd3b8f}},
+        {{0x002b01baf20830cb, 0x0033869d7275d89e, 0x00e1982f75aed7a0, 0x00cd8a8169e8c8d4,
+          0x005b7b65fa7b0850, 0x00976817b9ff5e45, 0x0000dbd27cf39151},
+         {0x00a1bfa287ca16ad, 0x008567238b746bfe, 0x0085b07dfd47b0a6, 0x0061e0ebb59a41b9,
+          0x00a0b57c09ee1919, 0x007d0595fe4be142, 0x00009759d2c5b081}},
+        {{0x00b36f1e752660ab, 0x0088c1b5600f5f65, 0x00153ad0287fae65, 0x005d4bf0f8fdebb8,
+          0x001935f4d255a09c, 0x0092e4a447eced1c, 0x00006d76746dd68d},
+         {0x0095ecdf66ec7670, 0x00c76389c27dfd23, 0x00752e602e170f87, 0x009d6a90ae6ad8f5,
+          0x00781fe27652bc9a, 0x000e404ed54599f8, 0x0000c1179ca4eece}},
+        {{0x00ba67fede79ad0c, 0x00a754c0441e938e, 0x0012b048dbf67859, 0x00c7cb62b8674cb2,
+          0x002133391f0aaca3, 0x00d62b6c45989bc2, 0x0000f1fa8f0776f3},
+         {0x0084e9dbe0076548, 0x0041ae8abb4b8d2d, 0x00cea3f4193c8357, 0x0057dffcf4876e82,
+          0x004a69676adf3b21, 0x003574c05380ccea, 0x0000fe818ea0c676}},
+        {{0x00a75cdd3baf1345, 0x0048171f5acba60e, 0x00adb9a5238f9729, 0x00982585eda99982,
+          0x001cadafa85a7bdd, 0x00c48caf247d0318, 0x00005505c08d225d},
+         {0x0065cd634ec9e425, 0x007fcf73264af4c9, 0x0082b58b7262b570, 0x00ce008eb49c9051,
+          0x009699e3e5d7f9c0, 0x0032920e95a3df1a, 0x00005079348c5eb0}},
+        {{0x00298bc03581b379, 0x003fd71ec1e7c190, 0x00f73304bd285d6c, 0x00b618e88b267d65,
+          0x002d99870669d9aa, 0x00f553345a32e3ac, 0x00005a5e921d1282},
+         {0x0050f6df7cc6495f, 0x00f9be7491ce9ead, 0x001ed97d4091d965, 0x001ed7f87a79e636,
+          0x0064517a00633676, 0x00df0d88baab927f, 0x00003605913cd357}},
+        {{0x00154229df48b31d, 0x0045002eeac709d8, 0x0032bb56a2e3cd27, 0x00bba457392877cd,
+          0x0064bb3d28bf7f98, 0x0073f3c059febaa8, 0x0000beb158a95273},
+         {0x0016d475c7ed39e5, 0x0011e74e98634239, 0x004d329ef247b6e4, 0x007b341a567baea9,
+          0x004ffaa42cf2dc6c, 0x00e3bb0354ef339c, 0x000070a55c44815d}},
+        {{0x002fe08ed4d64307, 0x00b8c164e757376e, 0x0026940a063af69a, 0x004a8db740da0d06,
+          0x00fdf14af3d9994c, 0x00621dc117f618ff, 0x0000027c772b8d19},
+         {0x00b0ffa7ab191030, 0x00c537912f69efb7, 0x00eed8366f732148, 0x002b7b97ab14b342,
+          0x006e87ba76f811d5, 0x007d3499f21edc4e, 0x000028fa2b58bc3b}},
+        {{0x000b27a08ae1c2d4, 0x00c4daa4ed0bd7e8, 0x0006739d2ad10a09, 0x00d162ed0e7b1dca,
+          0x0082b36d9d45192a, 0x00eb50d5305c1ca1, 0x0000de57987af229},
+         {0x008ce1dd2bd8531b, 0x0051bf542564f241, 0x00d881b8208f7e9e, 0x00f8365353edc097,
+          0x00b2c3470fd904d5, 0x009c80150ae8b90c, 0x000077146853d2d7}},
+        {{0x009359b531de0784, 0x006639548079ee01, 0x00fdd3065dd876e4, 0x007e13d35ae8614b,
+          0x0049a6e8a2ed186b, 0x00ca2aa45950e0d3, 0x0000b138d7045860},
+         {0x001bf9102ec5a3a8, 0x00396dc6ce965f9d, 0x0037c320025b1b62, 0x008ef57152fcd69c,
+          0x00ce1081312e1cce, 0x007a68f0ce61af84, 0x0000e63d3cedb70b}},
+        {{0x003a14b90cab667d, 0x00facd7f46b59b63, 0x003c86f76be6d75f, 0x00f44385e0a83b4a,
+          0x008097a42d79f9ab, 0x002977d2ffff8a65, 0x0000f12ee3a79859},
+         {0x003270c624634a96, 0x005262f65f2bbe8a, 0x007eae1c91399a9f, 0x00f0a3395b200113,
+          0x0093efa8327c3d27, 0x00dc2c6d17dfb865, 0x0000d8b0222be4a2}},
+        {{0x00e147b980ce04c6, 0x0041c76957698485, 0x005e2688453be62c, 0x00046b0c61717ebc,
+          0x0035ef830d4d2ec7, 0x008ff8dcfa6804d1, 0x0000a13737e58009},
+         {0x00a1fcab1544192a, 0x00208a18b39b4221, 0x00e35c632b0ac67b, 0x0007c4b8815b52f3,
+          0x00c9374121090389, 0x00f9298ff4c3b9c2, 0x0000dddd9b27597e}},
+        {{0x005d1c37ab6a3094, 0x00200081914c32e3, 0x0023edaea4b7be5c, 0x00b7971b4dc43933,
+          0x00e3ad2550729264, 0x00a0c367e6db37a6, 0x0000a0fa0d35185e},
+         {0x00e1b7aa0ab5d6c8, 0x00ceaec7866a04b3, 0x00d37d3d990a1c0c, 0x00963a78db5c05d6,
+          0x00ae4bbebd06ad12, 0x0099ac5f908ec984, 0x0000e2a53abc999f}},
+        {{0x009913e59af25dc9, 0x00ac1ff0c4684a00, 0x00f030c666e6093b, 0x001cc0c7f789215b,
+          0x005e554a0f7c07bf, 0x0030fe82a324b354, 0x000095a9ba8810d5},
+         {0x00200f2aeaeac41a, 0x002ac549a46d9d3d, 0x005826b5541c0d68, 0x00c47816539317cd,
+          0x001007ba496f87df, 0x00a2ca93334bc9c0, 0x0000f74615c53fab}},
+        {{0x00347d1e157beccb, 0x00c69d50f6ae1eac, 0x002f808d6876eb72, 0x004e4a498afb2139,
+          0x00f24589436bc102, 0x00277c9afc5f6bb2, 0x000081d32de315e4},
+         {0x00fc923df4a50221, 0x0089cb3a4ddf8b96, 0x00891e20887c0847, 0x0026172c3f930019,
+          0x008392933338a98b, 0x00161f4dd8018bb2, 0x0000dedbe61341dd}}
+    },
+    {
+        {{0x00a9aff58242bc04, 0x003b4ee5f94feb36, 0x006f922f18d63bd9, 0x0095ea0c2b36a3c5,
+          0x005acae783f67a01, 0x004fcf8aa148bc77, 0x00008af783f112a4},
+         {0x00082f9371007a35, 0x005cfc9421ab1608, 0x00f5470418d36e68, 0x00c72944e76090bd,
+          0x00b7e55a7e5d65c0, 0x0088617f30d04dbf, 0x00000681e7a54600}},
+        {{0x00b2e4383f385d2b, 0x008ac4932b516d35, 0x00fe51a3599f6e66, 0x00d12c0f3a8a1646,
+          0x006da385aee309ab, 0x00e9430231423bc4, 0x0000f23c10b4637e},
+         {0x00bc215d22248e00, 0x0047e3d45f6553c0, 0x0071daad7d1d9ed4, 0x001f2d8179af0847,
+          0x007bb3fdee94bf70, 0x00ac781e8c72ad26, 0x0000c425de168de7}},
+        {{0x00e2d002fd3ee2c0, 0x003952935c1a7a9c, 0x00e6cba070d4b79e, 0x002461271c71a614,
+          0x00a17b5a9cef219d, 0x00808a0c40f59b60, 0x000087238b2ab7de},
+         {0x00a23243ddb91044, 0x00ceecb50b09d25d, 0x00ed439b65ed5956, 0x00739189e7998230,
+          0x0059c8621ca0980e, 0x00f458c5e07e6b46, 0x0000f8df255f83f2}},
+        {{0x00706a5fe4cf3516, 0x00ce38eb890170d4, 0x003b9a93f60ccaf7, 0x00c30838612857a9,
+          0x0082bd11b74274b3, 0x0038d144f74473cc, 0x000078930b41340b},
+         {0x003132d2005b8520, 0x0092a867b7c1af4d, 0x00566df4dc5f624d, 0x00567d8d9ba885d8,
+          0x00d42dbfb9e695bc, 0x009436aaa97f0667, 0x0000f2323519eddb}},
+        {{0x001b6775892cbeac, 0x00803766e025e21e, 0x00aea3103c89db6a, 0x00bbb035e4eb141d,
+          0x00f9873855020f5b, 0x00fc2160c88ed33a, 0x00003afa9d706af6},
+         {0x00b678c7f3abc283, 0x00ae5a0d0d549838, 0x00ce1a0d602d9d53, 0x009f506eda8e6819,
+          0x00d1432281f715d0, 0x00cd53c819594134, 0x00002daca2c6044e}},
+        {{0x00a4d006d20b2e50, 0x00c20eed232d4a42, 0x0089adcedda53c16, 0x00684c6514ec5d8b,
+          0x002a6fe4a3b2bd18, 0x005fbe4cac245524, 0x000092ba26a4d133},
+         {0x0061f71617100b52, 0x006efa8904240190, 0x00e8b5bfb62763dc, 0x0071a55c70acb2de,
+          0x006268ffec9b2219, 0x00725bdc239d81bc, 0x00006882255959b0}},
+        {{0x00278f06ba64be42, 0x00d25e4fc3b844d9, 0x00df5924db272ef0, 0x006db0944f61dfb1,
+          0x00a3a40f05c73f40, 0x0024fc193cdd2ab7, 0x0000499efd29c196},
+         {0x0071ca4acf37bd26, 0x0053c271023ccc9a, 0x00aec08e37d32eaf, 0x00d9bdd705b83679,
+          0x00b5e7d236f5b456, 0x0054e8ec952fa685, 0x0000fbe0eb86dc25}},
+        {{0x00afd672c8a9e3d9, 0x0085083e9e6a1348, 0x001133a30e90e5de, 0x0005ea7cf2ed554f,
+          0x00cc10dc9d2afd18, 0x008aa2dcdd9894a7, 0x00006d195d95cf13},
+         {0x00eae586bad8b45e, 0x003f82dd004870fd, 0x00efb2daaf5242e7, 0x007d0a0c2ba00691,
+          0x002febb28b615c3f, 0x00de322c7caa846b, 0x00003ba9215d84d1}},
+        {{0x00bef9277764d17b, 0x00ef4e08a882de1d, 0x00a119133b057f47, 0x002f542cc9b853fd,
+          0x00c3115e13f559b1, 0x008eefba5c1040db, 0x00007dff0992a743},
+         {0x00eb3ad976289339, 0x00337b8818e446d5, 0x00c65d398cd0152c, 0x002e281b61b7418c,
+          0x0019b92ce3fe027c, 0x0092472fb72317e4, 0x0000f99328e0c753}},
+        {{0x0052e57f00ad744d, 0x008528a789df53da, 0x002d4de1df0c8963, 0x00c37cb95bd23fba,
+          0x00c056b1656aa87d, 0x00a3e69a5d936633, 0x0000bf4af30bd1f0},
+         {0x00b012fef98152da, 0x00ff2568eb0b656a, 0x00af29469ab47ed2, 0x0028293c5367b886,
+          0x00745d7f2d07dbc7, 0x00eef3de88dbd7d3, 0x00006ceb6b5509d2}},
+        {{0x00655b853989ec18, 0x00d4eba0bafd2f6b, 0x007822badfd7ee62, 0x005b14d1f985421c,
+          0x00cd223d802956ca, 0x00de9039e18ce95e, 0x00005af299abedf5},
+         {0x00ebd0ba18e8f30b, 0x00b3e4c1629bd7cf, 0x004baa341d6260e7, 0x0045bf9d4672f9ed,
+          0x00a2a257beeb8c56, 0x007ec92343440aeb, 0x0000013abd6eb078}},
+        {{0x008f4c98437f4a86, 0x00e473656c4d027f, 0x00aed7d94aaaaf08, 0x00638f424595e8c3,
+          0x0093ebd0218418f4, 0x005e0dc271303d47, 0x0000681186267f6f},
+         {0x008b08a745439b36, 0x00dc8864178f7b5d, 0x001eee6198ada9c6, 0x00e680559436e18e,
+          0x0023a890eb19a427, 0x00b3ea031f88fade, 0x000087f9adbfba95}},
+        {{0x00824c3e23504658, 0x00e4775dd1e2f8a7, 0x00d27d01d1db0cfa, 0x0031eeb7b76b4e43,
+          0x00eeb04c46ab3265, 0x0003fad236bc9e7b, 0x00000b15d1cedc99},
+         {0x005b3e023573ce23, 0x00467ddd1ceb349f, 0x004b95347d8c2a1c, 0x00e838eb4527b2dc,
+          0x00a62e0d3e64ffcf, 0x0094d1f9e9a16eeb, 0x000053ac8a397a66}},
+        {{0x00a12cfebd0a33bf, 0x000f55f9b84c603e, 0x008a162352fd4f3a, 0x00ea00fae147e73c,
+          0x008c1a60c0983027, 0x008f0780d32ce645, 0x00005c8a0ab598eb},
+         {0x00bcb2b143e90d42, 0x006419c22fbbd7ab, 0x0036a35059f1e8cc, 0x0092664d7e81d8e1,
+          0x0032ec9233fdca28, 0x00067360f441db54, 0x00002047d9a33c8f}},
+        {{0x00dddd500c10f8a4, 0x00ddddc07b743cea, 0x00de961634c35f1a, 0x00672616759404b4,
+          0x003f4755e90b4bb9, 0x00cdfa7479e3dbaf, 0x000090c89273957e},
+         {0x00698c9a2cd47927, 0x00b6f1fdb1c34a09, 0x0060c6b055cd2a22, 0x00ec7fb89e0c0835,
+          0x002c9f5885f84aeb, 0x0065610ea6ee3e59, 0x0000da024aa85dbf}},
+        {{0x00d469071c013803, 0x00c291080e1ce512, 0x006a74e886b4cb54, 0x002b3099221ee199,
+          0x009893675dd16c46, 0x00c75efcbc54bfba, 0x0000f88a1c9e3e37},
+         {0x001e2341d9ef4532, 0x003c24f50af35ed3, 0x00866181d536c9fc, 0x00f4a8d25076bef1,
+          0x00b813ffc7d59efc, 0x00c9cf0c5c41de59, 0x0000057d053eb159}}
+    },
+    {
+        {{0x00e2488daa019503, 0x0008580b19a81610, 0x00129d12c29b080c, 0x00a0dc0cf8a9d444,
+          0x00628ecbf1fa6864, 0x007cd6e85aedf045, 0x000004ddb732abda},
+         {0x00bb6d5b9ef190ff, 0x006f7634e4a37609, 0x0077cd22a9805a18, 0x006670948896d535,
+          0x008e3f1e907a086a, 0x0076ea7e567e0a7d, 0x0000366533754860}},
+        {{0x006706a79fc1f787, 0x00aa90b88aa02cf8, 0x0054547bb152fdc1, 0x00cf75d168afadc3,
+          0x00534be871f0874f, 0x00a779f1eb170c82, 0x00004f1848138b2d},
+         {0x0082cda1aef04a82, 0x001319c1d0b247a7, 0x00e249aa9d565cd1, 0x0094c54ceee79cd1,
+          0x00e8d174b9809db1, 0x002576dda406bd58, 0x0000c039a1b79459}},
+        {{0x00a0b3db9d0d972f, 0x004ad5bf1d378ce1, 0x00485638d8279f1e, 0x00429229fe1c27c0,
+          0x00eaafddaf371189, 0x000f5158c538aba3, 0x0000845748f6c606},
+         {0x00c4ede57ef3ed06, 0x00e7f262db5e528b, 0x00f9476818e8a411, 0x00a78899eeb8c5af,
+          0x0066ab5523c4bdb8, 0x00e93ee0140093f9, 0x0000973f3ff90422}},
+        {{0x00b5f9d8521ed648, 0x00970720e07ae6d7, 0x0090a0d803d2770b, 0x00bd399ba83bfc19,
+          0x00ccb0985cbb4fa2, 0x00a517aeb26bfedc, 0x0000c710947f190c},
+         {0x0017fd321db95296, 0x00f7053cf16a454c, 0x00892335f5d62b82, 0x0026b3683e6fd8fc,
+          0x0063351a63634f1c, 0x00f682ab1a628539, 0x0000cfc015958ea4}},
+        {{0x004cb0d548630dfc, 0x0047794ee9c9ed58, 0x00b33cc20589bdc1, 0x0064bd22f8fa340b,
+          0x006c6f4fef0311cb, 0x0057a800aeff39ae, 0x000003363910f80a},
+         {0x0085045a364550cb, 0x0033bc04b86f384f, 0x006f9f465f141f6f, 0x00f5727bda98d4ae,
+          0x00416decde63dba6, 0x00aeacf2d0ebf02b, 0x00004a8f9aa3a4fc}},
+        {{0x00ce5e4ee9a2db3b, 0x007899319121b3c3, 0x002d4c222a1e0fac, 0x0083216e8c43bba2,
+          0x00e232a83cfb7a83, 0x0096f5063d45366e, 0x00002b0123c67a07},
+         {0x00ce11eaefc102d9, 0x001f2f9f63e4faa7, 0x00b57d4b6442e21c, 0x00de80672ae5c1f8,
+          0x00ffd09bdc4b144a, 0x000477c561b2c00b, 0x0000b0e08d422096}},
+        {{0x00d9ae47b728c8c2, 0x008ff91afa4e42ec, 0x0060879bcf56dc83, 0x0047733531fd2d82,
+          0x007391578650ae92, 0x00538498f36c916c, 0x0000bd3ce42b368a},
+         {0x00ef0edc25cffb64, 0x00f23d7bdc62e63d, 0x00dd57751aaf5bff, 0x00a1d600e0cb0936,
+          0x00244b4da44927ca, 0x00f424b4508b23bc, 0x000027573bbd9b6a}},
+        {{0x004a507de5160337, 0x007970bb1643c4e5, 0x001dccfe23fa2bee, 0x003939717098c9f7,
+          0x0068f2f3039fa2fc, 0x004a0c74512b967d, 0x00009ce282f74d0f},
+         {0x007faea9a26f704f, 0x004bd7252f9f9f30, 0x00c26c569c443c33, 0x008b57d44dc080a1,
+          0x0003e5a984294a73, 0x0072f1ea12f3e3cf, 0x0000ab02fee2eb9d}},
+        {{0x00ebcbd63a2fa7df, 0x00ab7735bb9511f6, 0x00e6ddd7a60a8ad8, 0x00fcbd1e332496d4,
+          0x004aeb988d731570, 0x0068c2d5cf01561c, 0x0000fdf46d68638e},
+         {0x0072ba2b2c54b831, 0x00f0ff6137bd1b54, 0x00a18a97f8aeebe7, 0x009fa9769ad89e00,
+          0x006fe29547c88143, 0x006f8da0bac0a963, 0x0000c9537ba547fc}},
+        {{0x00a6890961a8c558, 0x00b5219dd4f28f9b, 0x0077ef4fe0ff691d, 0x00663afa19de7b0b,
+          0x0090305b91ae1fc5, 0x002356d37f59acf4, 0x00009676ac8058c0},
+         {0x008e37b6c8ab20a4, 0x003b9e2ddc0804aa, 0x00f0ddeee9969feb, 0x00bf894f5513fd2e,
+          0x00bb18e5aa53600f, 0x009248028a50d017, 0x00002edb441902d1}},
+        {{0x0007ab95d69872aa, 0x00b22804b284d4fa, 0x00aed2df017583d6, 0x002e6359aee0e551,
+          0x00f343bf6e4d33eb, 0x00cd05bcf75ff11c, 0x00003b05b5244706},
+         {0x00ae06f80dc0cbc4, 0x00da413de9b47216, 0x000fa727ac433fd9, 0x00b97c2d91f31e8c,
+          0x002a41da2a812f4c, 0x006e209a41ea5c44, 0x0000ab7ed5c999de}},
+        {{0x00290b0032ad12b8, 0x00c0d2cd3203dfba, 0x004e9bbb70b34233, 0x0042fef8a18f344f,
+          0x0003c93706b68882, 0x004cd2107b09e269, 0x00002f4fc3bfd4aa},
+         {0x00187d0380618b0f, 0x0027d4bda9a14466, 0x009d4e9d9a0fdb9c, 0x0032cdae7e496856,
+          0x00b6c4f48d6ce4e3, 0x0095f827e028d159, 0x00002f70e66e27a0}},
+        {{0x00cce3a67d2f9c2d, 0x00fd54689a310293, 0x0016ed68d73712be, 0x00bb2e1869816850,
+          0x0072f5aaf7e41795, 0x00b7f9559baf444a, 0x00003eb7ea0906c7},
+         {0x003b911eeef11abe, 0x005f39275d3880a8, 0x0023cbea1eb1d4fd, 0x00df56b02d1cfc83,
+          0x00fd01c2fa75ccbf, 0x002ed092cab7a3f6, 0x00008345519cc37f}},
+        {{0x000ce9df3d192706, 0x00e8f08ce03978d3, 0x009a151b8ab2f291, 0x004739ecd4940bb2,
+          0x00d039467d883362, 0x0063ef0ef69c0401, 0x000012ad6922846f},
+         {0x00054ad9aa084c9a, 0x004cf0fa87b8e5ce, 0x009f6dd00866341a, 0x008c1d65b7f8ce9d,
+          0x00c0f4443a0420ee, 0x0017cc56b1b4fd96, 0x0000cf586859e0cd}},
+        {{0x0050aa72134f36b2, 0x00c13e4bdfb12935, 0x005cbcda8ad83379, 0x007756452a9e44d6,
+          0x007fe6790a7b31d5, 0x003452afe14344ea, 0x0000a98758f5c011},
+         {0x00723daac4810f4e, 0x00db18685ef2efc4, 0x005aea344952308d, 0x0051dcf349ac65d1,
+          0x0005981fecf8f13f, 0x0064e362493f2661, 0x00001f47493cd02c}},
+        {{0x00defb1fcc3e621c, 0x001eaab291f8c660, 0x0045b50530543c55, 0x002d7b0a906aa4e4,
+          0x003b4ea9dd36b95e, 0x0063f2f8e1378416, 0x0000e1724c60bb8f},
+         {0x00abffb535b12e30, 0x0026225ef6e7fb50, 0x00ce62b950aa310c, 0x00ef7126c1769b07,
+          0x00b4d5221e0f686c, 0x0017ddc4601e6b36, 0x0000cf4d4f4dc896}}
+    },
+    {
+        {{0x00ba907bb6a38251, 0x00d51912f9e429fe, 0x0085bba96392d5c4, 0x0084df597d93eb68,
+          0x004eef9e0421c725, 0x009f7d0d1bfaaec1, 0x0000c4d61429ff45},
+         {0x002d45dc16ffe418, 0x00c451ad73a6943a, 0x00e576d54115170b, 0x005630c8b3ee79cf,
+          0x007b197262d27416, 0x00e4b88f485826b0, 0x000030337eac0378}},
+        {{0x0055b7990ceb3453, 0x00a64cdc6a0c7eda, 0x006480babd1ac291, 0x00ff1ade4bb40b6a,
+          0x004c779d50a62974, 0x009875f312c07dad, 0x0000c04a502aca7a},
+         {0x00a7966684d30e87, 0x00ad497e3d186022, 0x001df18dad28a8a3, 0x00ff7b9861f48474,
+          0x009070103ca55f7a, 0x0034e400a4c97907, 0x00000216b29bc57a}},
+        {{0x003518cfbca96c53, 0x0054d785215f15cb, 0x00224a24a707eb37, 0x00d671f48303479a,
+          0x00c12c29d6aefe36, 0x005c9e2ea939c0bf, 0x0000902e4b9b7cac},
+         {0x0060a412276a0516, 0x00a2ac9a9e3f2d68, 0x0038c9edb942f00e, 0x00d1943c3a706524,
+          0x0043b9b646a162a2, 0x00901708f048dd66, 0x0000e0e3d503e3d0}},
+        {{0x0056016e7de8fbc8, 0x00b01d109811e48c, 0x00ff2e8e978712f4, 0x00fd1a95915c1740,
+          0x006bd8b51ef71aac, 0x009c30bf0993f9d0, 0x00008f040e836455},
+         {0x00cff2fab19daafd, 0x00b7707a74f7b4f3, 0x00557c73fe426a2a, 0x00a1b176c459f8ed,
+          0x00904740c8ec72c9, 0x009971de4fba3858, 0x0000b4044b0cbf8f}},
+        {{0x00f42b1c882f25df, 0x00fc110d11ef17cd, 0x006677d53c419f6d, 0x00bc2aba01bba54f,
+          0x0070e68712bea9de, 0x00bc48fa80a2b523, 0x000087cc202b24f9},
+         {0x00064db1b1031547, 0x00cb9f542bc94d85, 0x007084147343d5cb, 0x001fb1048a3d887f,
+          0x008613f251f2dfaa, 0x000d2b482b6c276c, 0x0000e0e45426f20a}},
+        {{0x0096e2499e54fbb0, 0x0049c8778d5a1d01, 0x001ad8bbf8d1e98a, 0x00ca1c26f2083037,
+          0x00639c8364ab528c, 0x006f97f1510d50bc, 0x0000944a02e6314d},
+         {0x00a30da246502b82, 0x009e7628ae467e7f, 0x000c2721448a80d7, 0x00d5cf6c192b13bf,
+          0x0011e890336d025f, 0x006ca773207add21, 0x00003ae05a6e2915}},
+        {{0x003345c46844966d, 0x00928eb320ef02b8, 0x00b542d5560385bd, 0x0081ee5a8a7aa6ff,
+          0x00bf531d05ac5b1f, 0x002dae5163f95adb, 0x0000712ae70ff6ce},
+         {0x00a8498570ae9578, 0x0002956c6daad6e5, 0x00a55b84a0b3658f, 0x003a3b1672c1ca93,
+          0x0007be49a42812eb, 0x00b725f9c4deea18, 0x00000b8eb2e6e949}},
+        {{0x00aff4b2bc6510ad, 0x00870d7437575808, 0x004b8aae6004e061, 0x00ce9622d25b0273,
+          0x00430767e00b1374, 0x008cdfbae3cd2772, 0x0000ab468adbfab4},
+         {0x00874d65f681a609, 0x00c262283ff85a57, 0x009bbc42a3cdd8d8, 0x008ba86c86cf13ae,
+          0x00ae018e6063ecf7, 0x00f81a09bd4976d1, 0x000010b976f0dcea}},
+        {{0x003e4779fad00b15, 0x00d90d912d0ca507, 0x002996fad63c4338, 0x0089530b1b5d45dc,
+          0x00a45b9fa5e64cd6, 0x0022eb2822168731, 0x0000fed4469fce80},
+         {0x006042b5e17d2987, 0x006c6affe9a5457f, 0x00436a059770749a, 0x003f3e7ef39f762b,
+          0x00f40e3854632dab, 0x00ec3afce136952c, 0x00005f709d31f4a1}},
+        {{0x00c932170533a9dc, 0x0009f9375a74f7f2, 0x007b22c2be1e0e28, 0x00512ad875dbf7b5,
+          0x0084de5e00fff40e, 0x00870e786250e3ae, 0x00002e8f35dfc39b},
+         {0x00bb9e2c3d12d4c2, 0x00e0fa15c9823c0c, 0x00e01716f099455e, 0x0050e31a1dff7ff0,
+          0x00a8a7a4a136ce32, 0x00bae1c58385a832, 0x00006c951ab72a92}},
+        {{0x00433faeaa43ac75, 0x00aa33b3e3695de5, 0x00abbba1ff9a3338, 0x00553a1761492283,
+          0x007fee647b70eff9, 0x00fd5d73b4a5d526, 0x0000825b638fb74e},
+         {0x00785ad9bd1bcdb0, 0x0008956acbc7f7f1, 0x006a77f9145be648, 0x008d7e871d70e028,
+          0x00520cee39edfb4f, 0x0090bb3693202802, 0x0000d6d9ada87e3f}},
+        {{0x0045aad21c8f5d57, 0x0089117eb3c6ea52, 0x00ff814e6bca2247, 0x00d3953aa6c73c08,
+          0x006adc6e2378312e, 0x00764c14fbcb87b7, 0x00000666343ef663},
+         {0x00c11fac8e30141a, 0x0083bd94931e8c7d, 0x000e36a5d79b4e47, 0x001165d178740403,
+          0x00f3b89a4a5bd949, 0x0091f3eeefc5f564, 0x00005e263dac882c}},
+        {{0x0063a9fadcfef18d, 0x00a0538b482faaa7, 0x000a6f4b1ce7ad35, 0x00b0837a264a88f8,
+          0x000f67a5ead1b340, 0x00a47f74ccec20a3, 0x0000dbbf23883222},
+         {0x0045f6962a348aea, 0x00a7fab1ad8d452e, 0x000a2fc3464c6a9a, 0x005e87aa1e19cc9b,
+          0x00f3495418630f8a, 0x00e1a55d1d48cff9, 0x000064c2e8cbd201}},
+        {{0x001cfb5f7435ab28, 0x001bc608c2115ed6, 0x0072bd4249980325, 0x00c80f29412a696d,
+          0x00b721a72fe851b5, 0x000d1452a8c3d62e, 0x0000fb4339d3b328},
+         {0x00f7b6383592f449, 0x0090667432bcdc21, 0x002894525f964e0f, 0x003cf2df64a2aea1,
+          0x00859bc253ebbda2, 0x00abc7e867833b23, 0x0000bcde0a51d190}},
+        {{0x008a9ac0db032b63, 0x0034b01dd51fcc58, 0x00b34c4a10fe5aa1, 0x001f3c487c2209a9,
+          0x001a082deb717cb1, 0x00abbfcbb507d853, 0x00008782821c9ea3},
+         {0x00397b93fb4db3f2, 0x0098d6562a763017, 0x00f9225bf3711ca2, 0x0080b28f011f8014,
+          0x00169b7f851e443a, 0x0007692aed46bfe4, 0x0000951b398c1923}},
+        {{0x00f997a41875066c, 0x009ae6f5376c09af, 0x0027a5024843f5ff, 0x00dd79448bd15cd7,
+          0x008f1e2416f10c1e, 0x008a224952de6ab5, 0x000031614db5d615},
+         {0x001a1102a92d3cc5, 0x00bd9b0a65bb9cd3, 0x000da0e4afc1219a, 0x0018b5e08c03228b,
+          0x00525df297670024, 0x00546bab85d12d42, 0x0000de8e4a817cbd}}
+    },
+    {
+        {{0x005578c5dc9b3525, 0x00a81fd7efe097a0, 0x00018d6fb4125cbe, 0x0079fa98214984f1,
+          0x00c5e0a5ba8d24ea, 0x0000473bf7773998, 0x000080de8ed4f21a},
+         {0x00386450725bd2c4, 0x0010d8d6a1726487, 0x00bca6a692181c13, 0x00b8eb8480f7c873,
+          0x00e6bc035f707c6b, 0x00a83710d6e22516, 0x00008411acda714a}},
+        {{0x00e776310cbfc247, 0x00c0a007ac9315b2, 0x0021a8254adaed26, 0x0029ded690c33e21,
+          0x0070e87ea8c05c2e, 0x00930e9d65d4608e, 0x0000616104d52b20},
+         {0x00689f7905c44088, 0x00f5fc5c8786a6f7, 0x0040a2db534cfff1, 0x004e8fddc081261f,
+          0x002efcfd8193cd89, 0x0083823a837b7ac3, 0x000008413cc0c6d7}},
+        {{0x005b36390b77c5d6, 0x00990e6a2674c2ac, 0x00a81d7c537c3813, 0x00bcef45c6cf6595,
+          0x00346c982d4326ce, 0x002c369ea06a9a85, 0x00002a44500db6a8},
+         {0x0093399fc245394a, 0x00c6322eaf663bff, 0x00fcd87319a9c884, 0x004f3dacbfcb7cd8,
+          0x00bffa0e206eddbe, 0x00f8f704028d4be5, 0x00002e3f1489bf82}},
+        {{0x0055aeeec3965d6c, 0x00d8ff15754e8d76, 0x0020f98f3f6ba205, 0x0031fa2ac82c547f,
+          0x00e62f5980f7e381, 0x006ca2e1a0ae1734, 0x0000121ddf8c9828},
+         {0x00ec2e880205f0d8, 0x00391c5329d56362, 0x00d2251ddb378e49, 0x00e9cee91371fcdb,
+          0x004aee9092a91a35, 0x00935899c6e5cbd8, 0x00005459524ff1a7}},
+        {{0x00c900092cb73468, 0x00b8d639cb749b2e, 0x003d5207689b664a, 0x00e2a976060936aa,
+          0x006dcdf33f93174e, 0x00a670fab6d961e9, 0x000088ebe80a0bcb},
+         {0x001f54085c3cf25c, 0x009949e57263b517, 0x00f6bc9b1b1f1b66, 0x00f8372499410973,
+          0x00f63b3c4ccadfbc, 0x009752df2f85d5d1, 0x0000f192eaf9be13}},
+        {{0x00d789c81131b631, 0x001a55487168be26, 0x00c97ddfe9e00e25, 0x00830f9997612c6e,
+          0x00d763faada5fa96, 0x00641cf40107909f, 0x0000199b8d599874},
+         {0x0020664b4eaabdb7, 0x00d599b716975830, 0x007a44335f0de1a8, 0x00bc6b0357c6f71c,
+          0x0029e33b04ec6619, 0x007c040b2b2d5e3f, 0x0000493d3d52294e}},
+        {{0x000384d5e8cbfee2, 0x007c9723b32dac5d, 0x008693b869e2efc0, 0x0013e36b66cd082f,
+          0x00b34f1abc3c307a, 0x0029aacac89f3f62, 0x0000383ff726b61c},
+         {0x0055d6ef0e80361a, 0x00f869d024f8ee0d, 0x0029ab32f3e0b4b2, 0x00e9b1f3010c3567,
+          0x00ac13c32434e62d, 0x0010da7497bd9b09, 0x00007ee80f879aae}},
+        {{0x0078cab127d56ae7, 0x005ee4e7d8c43a22, 0x0078b29d252956d6, 0x00bd5f5934fa5885,
+          0x00e1926f5bbdc49b, 0x0011e647f7a77f17, 0x00005e525723352a},
+         {0x0081b3940cc6af3e, 0x008ad17aae763953, 0x002e5d75ca2adb0f, 0x003a873c9118beea,
+          0x0082fcf423328929, 0x00764f5b0138dd90, 0x000063c48c717b93}},
+        {{0x00d4a7a5972a5045, 0x00fb718ac6b9dc7b, 0x00b5dc4e4c2614ad, 0x003faccafad0dad4,
+          0x003ece0d3598c3be, 0x00ae8934ae240971, 0x0000cc7fc45b641f},
+         {0x00753746ee9052fc, 0x00cecf553358faf3, 0x00e1de407e6b34ac, 0x001a7201e12d3321,
+          0x0042be984fb50e4a, 0x008c1ffff443e426, 0x0000cc285f08082d}},
+        {{0x00903327711f2664, 0x00a89fe403f3e837, 0x0000d6a2c137cac8, 0x00e820aabd4efc7d,
+          0x0094f9d755775032, 0x006319f568414f50, 0x0000043bfaa7a907},
+         {0x00b9805bba3b09c0, 0x0088a44939067687, 0x0028c877f6e2a838, 0x00c36359cfc4a355,
+          0x00f457f56233596c, 0x00e9434531b8b609, 0x0000a4b065bb2940}},
+        {{0x002a61d0049e273b, 0x0070f4f6dd3cd43b, 0x00057da17272aefc, 0x00eed70a111e7d16,
+          0x0021c74936cee84a, 0x005602e47cf1c058, 0x0000ad486ff29e23},
+         {0x00adde8d109e8f5b, 0x00db865798cfa2b9, 0x0094eab02ad66483, 0x00bd8bd8cd607e9a,
+          0x002cf89bf747959b, 0x00d82042470749c0, 0x000029ce8d561c16}},
+        {{0x000045f25469119e, 0x0082f2648b036e8f, 0x0010e8975a6a5b8b, 0x00d8de2cdfc290b1,
+          0x00a335cb0cba9800, 0x00dbe15591d449ae, 0x00001d79343c22ea},
+         {0x00c1e44deb23b82f, 0x00d9dc067f13c629, 0x00716ba13eb842e7, 0x009492044f8fd752,
+          0x00239701534d28ab, 0x008aafa4b8f7f3a8, 0x0000b1a768b90db8}},
+        {{0x0078804f1f9c829a, 0x00408fab390a5250, 0x00899acb9dcd7a52, 0x003bebd39196b45c,
+          0x00e68067b2685827, 0x0048efe9ada02023, 0x00000a277f46379c},
+         {0x007d341f7df34b9c, 0x0088c319a580395e, 0x0065b45ff6c550fe, 0x006fa259587ad828,
+          0x0049de7c9a71c105, 0x00b5656b1ecfd803, 0x00000be7ec402714}},
+        {{0x000944a40ef2f0e9, 0x00b846eec1f83356, 0x0022502215ceb886, 0x00dd5c767e79b870,
+          0x00f497875669608a, 0x00f1cb7ccaa63f13, 0x00001bd2751c029a},
+         {0x000c6e52b64ab42f, 0x00b46fad9668d274, 0x00a58378f9ec2fe6, 0x00a425a6f47843d3,
+          0x00abd31ac4b61093, 0x00009f3b85175374, 0x0000eacb19cef93c}},
+        {{0x004fb9830ee4e813, 0x00a29a0680749c80, 0x0017aa7878bb2bd8, 0x00b27d9c5cd3e456,
+          0x00f64951643d36d4, 0x00d9f82cbef78994, 0x000008b6764e07ba},
+         {0x009a38bad87279f9, 0x00f0c433234a1844, 0x00470de0f2e7bd0f, 0x008e267f5a22191e,
+          0x001f1b13928de417, 0x0040cc748edf5bba, 0x00007f1e4fc3ca36}},
+        {{0x0009bf3425125475, 0x008aa450f19fe56b, 0x002654c560f9be72, 0x002108d675966f8f,
+          0x004ccc6a32b17586, 0x00c6a234655ab78a, 0x0000fb2192a76a1f},
+         {0x00b44b78d377a887, 0x002a577571691c02, 0x003342b9a553e82d, 0x00880d5bfc78b48d,
+          0x001dfafca2ad1ced, 0x000a51e4bb724e74, 0x0000d1942826da5e}}
+    },
+    {
+        {{0x0031d8182a0745d8, 0x00d2e1b23da65651, 0x003db3fc52d95109, 0x005555676c3fbe82,
+          0x0016c86bd4a282e4, 0x008efd34eda59bbf, 0x00005538f464158e},
+         {0x00db8dd668716fb0, 0x005bcc15278cc325, 0x007b3c9c55bd0558, 0x00dbd3ff6b68fdb7,
+          0x00e5ab33220b29dd, 0x0000c75698999d0f, 0x0000cc421b4d5faa}},
+        {{0x00c0c09da19b7f44, 0x0010eb44b4759349, 0x001f21b7abd121cf, 0x002c8e0b36eead58,
+          0x00455f17221fc0f6, 0x00a8ef97e3d3b449, 0x000030b1817a3112},
+         {0x006e05b6df5745ca, 0x00dbbe9f304afaee, 0x0094432202c88373, 0x006707a413ab7bf4,
+          0x00c7c5c0575dfbd0, 0x00e8eb6fbb50d92a, 0x00008042b7d4c042}},
+        {{0x00a3a4cc3bf12c18, 0x0065d05e7626202f, 0x0048ed1b8b35e210, 0x00911e955d3c2399,
+          0x00697e08df66ec7d, 0x00643126a8d63ae1, 0x00007e5de05b27bb},
+         {0x00b423eda8cf648a, 0x003e2fdc5c1673ab, 0x0076c79d2ae96824, 0x003d127dbb0d69e6,
+          0x004bd07b3ae855cc, 0x00f7ceb806d2a127, 0x000006f407b14038}},
+        {{0x00108d441d6267f5, 0x00628c600c5780ae, 0x0084ad4220ab0abb, 0x00d0021c39131821,
+          0x000c09cc7f2a6ec0, 0x002f352855060251, 0x0000dab56ec0abc6},
+         {0x00652848bce3180f, 0x005c76160c69dc4f, 0x0013f01780d2e66c, 0x003303c2e19950aa,
+          0x007b70663c5abb2e, 0x00d3736377c91015, 0x00004eff9e28691a}},
+        {{0x004284c93fa29e5d, 0x009a7945c5c1a58c, 0x00f0570395736b47, 0x00a6a33ec5c5d86b,
+          0x00b27132ff4b986d, 0x0050cf985939666d, 0x0000d08ee20093a2},
+         {0x00db2ce1e905fb89, 0x000153f0cde2b701, 0x0065ced2e0fb9042, 0x00699868fcd93f8f,
+          0x00e0b9b236f04932, 0x00c441f874f55681, 0x00003e456eac2e4b}},
+        {{0x00f32a711ccf3230, 0x00a62c6e79cbb72a, 0x0070c3d96e52aff0, 0x00def54d4ae47035,
+          0x0001b8f33f11c8a1, 0x0000603f0fcc464d, 0x000033de558cfe23},
+         {0x00e7dc088ebce09e, 0x00021dfc32a9a91c, 0x004b67a46d746f13, 0x0043dc1095343b6d,
+          0x005ca8cabf2a4c5d, 0x0075640ff6820e27, 0x00004d922bfd11c5}},
+        {{0x00b949f446994345, 0x0020cb014dad2cc6, 0x0000f1bf50bb02bf, 0x00407f2bb0f2781d,
+          0x00a95f0e5a6721c8, 0x00f26ea5156a437e, 0x00006f8694a9a497},
+         {0x00366abcaff31d2a, 0x00ec15e17d63ac65, 0x009f17f0b173a449, 0x001dacdb46e7aa9a,
+          0x0009ab2a385adddb, 0x00b9e582713f595f, 0x00001c390c53b309}},
+        {{0x00ac0181fcd958ac, 0x008131ade89415de, 0x0023717cac3881b5, 0x003758422c12058f,
+          0x0029a97586567e8e, 0x007c48f2337b2ac9, 0x0000aeb74b1dfdf2},
+         {0x00698223e2b8cd24, 0x0086b54afa66dee5, 0x00a31efa5e2d6af1, 0x00f6a7a90ea49bb5,
+          0x009b674498835755, 0x00b7cfa73c5ccd4a, 0x0000df945a115943}},
+        {{0x00fdd1c543eeb119, 0x00bd5b3574e59643, 0x002167c7f5556b87, 0x0091674143fa0fba,
+          0x0012ced7bdcdf76a, 0x001cae1dbda447f0, 0x000081fe4700bdd6},
+         {0x002721fec3c25bca, 0x00b1ccf565d7a9f2, 0x007449c3b6e887f4, 0x0055ab69eb09fe57,
+          0x0098c58f8ab9ed37, 0x00ca31768cb60472, 0x0000950a2965d8c1}},
+        {{0x001bd224d44d9420, 0x004e88e028e23f59, 0x00e936152bf2c26f, 0x00cd3563e6e745e3,
+          0x00d4abb57604a757, 0x0094208307a168d9, 0x000086855466d370},
+         {0x00f04325a46627c8, 0x00850947932ab33d, 0x007f880c95904fbd, 0x00d80179757d403c,
+          0x001900a2f74f1028, 0x008a8a648139511b, 0x0000b1bf5e44d76f}},
+        {{0x00bed746c2d627a6, 0x002bfa47d2694158, 0x00a36cc41093b1cd, 0x004d8874f0316fe5,
+          0x00d623e88a2e3f73, 0x0059f3db138545b5, 0x00008eaa1604e669},
+         {0x00a6dba3cc769326, 0x00e2f46908a1b53c, 0x00d7d1311905cd88, 0x003540f2e64d7142,
+          0x0057c07b638ee088, 0x00132afebd4fe9a3, 0x000012c8d25bc1cf}},
+        {{0x00e08f9e7d4e8d0e, 0x0097dafeb6889682, 0x0089c14a983c68f6, 0x003f9f8df709d350,
+          0x006cd4b12cb1f38e, 0x00601c8763bbeae8, 0x0000c0fe2542bb26},
+         {0x00211531e4328b4c, 0x00013c3255b7912a, 0x00406b4bbda83f98, 0x004eeb8ad5868b9c,
+          0x005e7fdd57796ae5, 0x00825ca6ce539b9b, 0x00008aa22561b5b6}},
+        {{0x008fc30c9a832004, 0x00fa6153e7de5ed1, 0x003b9f52233370ee, 0x00bc579f9d748358,
+          0x00e32e100a4f689e, 0x0092a28ba8aad0bb, 0x00005635d15b70ae},
+         {0x00e3f9ae90162784, 0x001f53914a26cc8c, 0x0055b85da93b195d, 0x00e07ccbe8597247,
+          0x00cb97b4e1f14f87, 0x00d0f07f328aeba1, 0x0000eb59ad195907}},
+        {{0x0086bef68a822557, 0x00121987e6916360, 0x001c0ad683cb5c53, 0x00d211cd06575eae,
+          0x0045d75cca177bd3, 0x00e9f092f9471eda, 0x00003e0438d762c2},
+         {0x0084db9281a8dcbc, 0x00326f7b6a5053b6, 0x001249209d24a93b, 0x00ac2e3d540092ee,
+          0x00b17c20f6116817, 0x00268053f2f3e348, 0x000082ea0c67b8f0}},
+        {{0x00bebdbc5c1e5cee, 0x0038ff459f4ee332, 0x00702025d4b1e411, 0x00bdc28b13087170,
+          0x0048b947d1e18a96, 0x003fe1b25d24db15, 0x0000551b7badf258},
+         {0x00e3c2cad0e4045a, 0x006bf1c54ded5d1e, 0x00d4d4e8a22c96c9, 0x008065f6b5aec5c2,
+          0x008e16f0cb93ca7e, 0x002622c2c96cbfdc, 0x0000a6ea2834df92}},
+        {{0x0097245def0101b2, 0x007771484816b128, 0x00147ff4600547ab, 0x009edc1111b03afc,
+          0x0028056b8028c709, 0x0078b0c0eb608e9d, 0x0000a1ce28062ef8},
+         {0x0072bba8e9a8b829, 0x00f74681674f774d, 0x00b7a302da18f129, 0x006ace277067da73,
+          0x001705e1c6018bfe, 0x0047071a4a3f7d3c, 0x0000016ecc7c1e5f}}
+    },
+    {
+        {{0x009eb4f3550e2f47, 0x00dc9d712138f712, 0x007f13e54a9c6337, 0x00fd9784aa3e2a1f,
+          0x00743f41ddcc51e7, 0x007ae28c33d591ea, 0x0000eea16f9d0169},
+         {0x009e13c5a97eeec2, 0x0003b234631a1b77, 0x00f9375f64064c8c, 0x00243c87bf6dc880,
+          0x00fe48a55deb5178, 0x00a99f8ba028f01f, 0x00007990c82eb253}},
+        {{0x001eda70a7cf3c75, 0x0093fe4f999b9fd6, 0x0013bed71910055d, 0x004e6753db837077,
+          0x00ff79e80d8c2981, 0x005a69f083903a3a, 0x00000486b52759c9},
+         {0x000b345044d6b247, 0x0052a59b8d5fc942, 0x00814afe550352da, 0x000e7f7b20baeec5,
+          0x00a53cf9f70f8ebc, 0x00f21b1d0d52bb7a, 0x0000dcf481def274}},
+        {{0x0092c59687971b25, 0x0009d6f55196ceaa, 0x00b2c8ca140f89ea, 0x00b5368f71f43b31,
+          0x00c85916118f63fe, 0x00e4bd6dbe0fbc5c, 0x00006fe2ff8532e7},
+         {0x0007d4bfed933a45, 0x001bfa8e5f36d919, 0x008fd7c4820816a5, 0x008e9c8ad560a738,
+          0x00e99ed497313ec0, 0x005fc1763ef1770d, 0x0000283f0d370914}},
+        {{0x002482f2d4507be0, 0x001bc9f4f7cd952d, 0x002ba7448917af40, 0x0066b83664dfac14,
+          0x00d726850c8f75bd, 0x0043222b90c4feb8, 0x000097ac361fdff3},
+         {0x003efcac8f432051, 0x00f937fef16f144e, 0x0071741e06a50f1f, 0x00c6f811314a8138,
+          0x00319499993a97e2, 0x000d327bb5c42b15, 0x0000be2767cd9f56}},
+        {{0x00626ee4a5132afd, 0x001aa25ae64e4080, 0x00d50f1d6309be7e, 0x00f9c966cad13a7b,
+          0x00a4a75a25bf8f88, 0x00cbbe3efd20ad26, 0x0000b8d7d75bd038},
+         {0x0025924f9dd4e042, 0x001817861d60495f, 0x0088996eed407118, 0x0081cc5aeabc54ee,
+          0x004154161d474a04, 0x002a418cf72038e0, 0x0000314c80cf97ed}},
+        {{0x00cad459f706f7b9, 0x00e39c38c24e084b, 0x005462212e36ceab, 0x00b5e927546adb79,
+          0x001ed112da6aeee8, 0x003f596318a4d16f, 0x00009bb2a02fdf46},
+         {0x00ab98d0522fbc9f, 0x00a68e2c5de82aa8, 0x006f5b17b28af82a, 0x00ffb8655bf1f9d8,
+          0x0087e6097fc0a3ca, 0x0095095427bd15ac, 0x0000e6271e903a75}},
+        {{0x008369edbfba87c9, 0x00fa9cb52c55fd98, 0x00a4c06a1f63aed8, 0x006c2f8e669485dd,
+          0x002248587bc0fbc5, 0x0085444296aa3a7a, 0x00001f051b132a8d},
+         {0x0063b74732c38ae5, 0x005f38e3aebd58e1, 0x00ad52e822e4f774, 0x0079fa55f49aad08,
+          0x000fd592169d1f2d, 0x00b35e838e3d35eb, 0x0000c52ecdac9e34}},
+        {{0x0098b294ac4f42cf, 0x00969e75308ed1a4, 0x0022ab4831f51a0c, 0x00796ad4e349a0c4,
+          0x00ee36ca82b681d6, 0x00f049afb8680393, 0x0000e0b5f0705c2d},
+         {0x002c171c4da5aac7, 0x00ef8dba839ab156, 0x00209d7c3ca134da, 0x00c759352db81508,
+          0x00bc3470aba1cae3, 0x006782c8f4575947, 0x00005677134bebe9}},
+        {{0x00949a7391b2d315, 0x004d09cd82ed1131, 0x0075c874aaf41198, 0x00ec215b42513791,
+          0x0062f3fd4a693043, 0x00e815575ba5ff2e, 0x000013b2c4200cfb},
+         {0x00782a24c7ad608d, 0x003373aa6f114330, 0x009aab0ce28483e7, 0x003b987bad5882ef,
+          0x008ff126549d7590, 0x00cb9cb1a0946c88, 0x00003ecc6772e116}},
+        {{0x00642265dabee2dd, 0x0004d83b4e86acaa, 0x005a7cdf138fbfd9, 0x004d9fd0ce09b1c8,
+          0x00154a251c8098ba, 0x0089f62f7f5a8bf6, 0x0000a09bc1e682ef},
+         {0x006b5078cf82b83a, 0x00cdbb7eff93f9d6, 0x00b7b68dad2d971e, 0x00bc04384ad54b70,
+          0x00d8ed7957c354bd, 0x002d834d57524240, 0x0000d3f229b23fc4}},
+        {{0x0068c8f8579cd0be, 0x002a19abae50151d, 0x002af4f283d50d93, 0x006948c7eb342a63,
+          0x009ffaf561806561, 0x00d68d8ca33c3e1e, 0x00005fa200d67d06},
+         {0x0064262dab9af93b, 0x008df7f0cb22ae32, 0x0077646a92d8b882, 0x00bb534a715b68da,
+          0x00cd556294b9ea33, 0x000933ce5e5d0e71, 0x00004168e70f4149}},
+        {{0x000d5a1e835892b0, 0x0000a2063698de8c, 0x00969a689332ffbb, 0x002115de7a4f361e,
+          0x00800f938c3f8469, 0x008a47dac009f1ea, 0x000028923c8686ef},
+         {0x00f85d5565a8548c, 0x009da807921fa5e9, 0x0040b510a114faad, 0x00a2e35c6497a434,
+          0x002a3748f2bca7ca, 0x0074749b30f94839, 0x0000a5b6627b8f12}},
+        {{0x0019f6b9572b8632, 0x0040c89f29cef943, 0x009c3ba017337853, 0x0073d3a2b1dc2bd1,
+          0x001f369e893c9cd8, 0x0015c27f71402d78, 0x000088867fcb5948},
+         {0x0009de2e5cf622fe, 0x00424293b63a119d, 0x00b6259db3078a07, 0x00617bd26d947f15,
+          0x002313c6b418bdc9, 0x0010cb9d9ea4d18d, 0x0000797d6bb18dbc}},
+        {{0x00450240fbe6d210, 0x00c3e6606d93868a, 0x00b0ac4bfa5374e9, 0x0013b5e37a8de766,
+          0x000e33941393d777, 0x007d4b7e7f66c803, 0x00008fd171dd278d},
+         {0x00f7e955604ed804, 0x003c07bcdd1dde0b, 0x002275c26842a4b2, 0x003f82ac44581e5c,
+          0x00df651f0a6ffc71, 0x00292a1a5bd949b5, 0x000067809a73aead}},
+        {{0x008c6c42acdbcb41, 0x002bcccbf4ddcccb, 0x00af296ac7ad536c, 0x00c79cbd0c50955d,
+          0x0032c5422b02d9b8, 0x003fd9b2798a98dd, 0x000004e3ca26fbf7},
+         {0x002ab665204cd344, 0x00249ee976c8c764, 0x002d4deef82dfdc5, 0x0062fdf4ac2f66b0,
+          0x0091c67c3dda2b88, 0x0053579dd49083e2, 0x0000da2075b4a86e}},
+        {{0x001adecc4cca56ab, 0x007afea3122b0ef2, 0x00e7e5deb68a5977, 0x00b01753e07e0d55,
+          0x006649542fb272e9, 0x002393921cb62a8b, 0x0000d42a4bd204b9},
+         {0x00239833da194383, 0x00bd31ad55b1fdc6, 0x00a0fa999a4eb4d2, 0x001a7db127b05888,
+          0x003734bc5c4e46be, 0x00ca68a970057aea, 0x00006b51ba9b1b34}}
+    },
+    {
+        {{0x004507eb52891723, 0x003277aa7053040c, 0x006891a091073925, 0x003592893edd81cc,
+          0x00657250860c69ac, 0x004f1a97e2c512dd, 0x0000632b661d48b3},
+         {0x00f3be1254e9b62f, 0x00cde2a788dd7378, 0x005f6d217eb4f9ce, 0x0032f058ec793b03,
+          0x000e6821629df5db, 0x006f2c3484888b91, 0x000048909218e4e6}},
+        {{0x005750fc2d1aeb2c, 0x00e317e74135d50e, 0x00fe993bec7a6e32, 0x00cc19c85d04902d,
+          0x00a1a929bc6f50a0, 0x0013571f4f1164ca, 0x000087c61952ed10},
+         {0x009a43c696c411c3, 0x001ef5f1ef7b465c, 0x0002bb3ce003ec33, 0x00c73fe41f8da9cf,
+          0x005b463e1933b352, 0x0067929cfcf1e757, 0x00000c97490d894c}},
+        {{0x0047aa967dca36fd, 0x00cc5a89cceb39b7, 0x001c5d835ce3a693, 0x00f67718688a04dd,
+          0x002f95b871f5ff4f, 0x008579334008268a, 0x000052c5d5ccd710},
+         {0x00303ae7fffe0464, 0x0069bdcbc64bc191, 0x00150e368842958b, 0x00f3718bf767c7c2,
+          0x0084beefa07c18b6, 0x00b92555fe8122d1, 0x00009f5e7ae0ff09}},
+        {{0x00d17438f08e50c0, 0x003538fb591f8ee6, 0x004b57fbb2788ee8, 0x000d0ed82b6dd80c,
+          0x00dbc8ef4ca1e28e, 0x0092d1bf4d61cda1, 0x0000c90a68cb9a46},
+         {0x004daa27d590c2d2, 0x0079436ff79fb43e, 0x006f3c5ef7cb3598, 0x00eac656adcb4f18,
+          0x000b36e5598e03c5, 0x0099f58c7025b58e, 0x0000d1abc795d7ea}},
+        {{0x0087f1affb5abbb4, 0x008fd7107e9e7b01, 0x005f520e64416846, 0x00fa1d774ee2fb06,
+          0x004a6360904d6f43, 0x0024a522f3ec6175, 0x0000c2fb47aebe4c},
+         {0x001a079ea33b7c63, 0x00688ae5abe539f8, 0x00e82928cfa2f645, 0x00dda9fe695c1079,
+          0x00f30e3013bcf68c, 0x0093e93df155fdb0, 0x0000ba3c66b6219d}},
+        {{0x00579ca2e5b0df1f, 0x00bb9e4d32aceaa3, 0x00cfafa9e161f0e7, 0x00f2f499eafc9bda,
+          0x0098a74855a8d45e, 0x002a5e0ab4220660, 0x0000f6e2eb95d2b9},
+         {0x00081881aa265ad1, 0x0006a78b511c2564, 0x00f0f409744082be, 0x007caea7e9656c33,
+          0x007de6cdd0437a56, 0x003402b0cf4ba428, 0x00003bb34dd1f021}},
+        {{0x0031c6a7f73d1418, 0x004ee373fe26acf8, 0x00a8d417558285e9, 0x00e8e82cc3d7a42b,
+          0x00ff0aabe119b173, 0x009bb635b61a1d95, 0x00004bf78c3bfe77},
+         {0x0032bde309a78ae1, 0x0093bd8b1069298e, 0x007845ad29e5bc4b, 0x00553b08d9a0cf71,
+          0x0005e0ef9c3ea8c4, 0x00661a11b605258b, 0x000081549855f939}},
+        {{0x005bb9a832a41354, 0x0025f25929c1da30, 0x009cc1ad2df7b50d, 0x00d3ad25210526e2,
+          0x00f9c584e75ec303, 0x00402137e078f45a, 0x000075bd359357fb},
+         {0x0000a5296eafd08a, 0x00ad272f0f7c4594, 0x00fd5abaee009d2d, 0x002b34e6f6a8f595,
+          0x001939a03fcbab7a, 0x00a7794454ccf435, 0x0000d4fafd9c3b90}},
+        {{0x0090fa210afacfa0, 0x00e326aa0fa3d219, 0x00dfd39024631fba, 0x00cb371a7db5ec87,
+          0x00ec51ba8ef19527, 0x003fe71f14534c34, 0x000094b5a7d7914b},
+         {0x00a69cfc7e696398, 0x00806fd2a6da9a38, 0x001916f80e8e8dda, 0x00b51e1a01d8a3fe,
+          0x0077f95372c035c7, 0x00098f241366ef04, 0x0000543f495c534a}},
+        {{0x000eeee3260d8ec5, 0x00e5aadf45bdb248, 0x007dece8c8d23060, 0x00765153d9e13098,
+          0x003bc48d283669f0, 0x001a1f9748a4e639, 0x00005a8500e634fb},
+         {0x0058d8ba2d37dd60, 0x00e6505c81876112, 0x006e9f6ef74553e8, 0x005aedcf14017467,
+          0x001728ae9f39fff9, 0x00c10094f393330f, 0x0000be3c8a33b02f}},
+        {{0x008b3729aeb850ba, 0x0027005a443bad0c, 0x0032f4b09cc4d4a0, 0x008e1970b8d6a6f8,
+          0x003d833b8f2fd78c, 0x00f0dc3b42069dff, 0x0000d50a513f3223},
+         {0x006efe8740573164, 0x0030f405841759e0, 0x0093f47f15ea5650, 0x00cbe497464e3189,
+          0x008ad5e24505a85b, 0x000055881eaaa5e7, 0x000014d748a5865b}},
+        {{0x006d850b9b0b302a, 0x00a923cd42812e34, 0x0000dfe40e122365, 0x00b926fa81b42a95,
+          0x00933fc4026eff1a, 0x0042344dd1abf815, 0x000093f75501243a},
+         {0x0070341d9317d163, 0x00f37d47d942de9a, 0x004f774ee81fac67, 0x002417964af328f4,
+          0x0059746303b56851, 0x008095a4ab20724d, 0x00003ac28379d033}},
+        {{0x005cb1369257a2e6, 0x0010004adcf6d758, 0x00c38c0f44e5434f, 0x00b86aed1c6ce93f,
+          0x0077129ab16c1c9a, 0x00547815254ef9ef, 0x00008d0013bc6933},
+         {0x00746a5b98d01c05, 0x00af75a7b60bc53b, 0x003535a8165760c6, 0x00ce25d226296e9e,
+          0x00b6c4f43e6a120e, 0x00320087eae9e096, 0x0000b4c75e5f8a54}},
+        {{0x00374baa7bc60029, 0x00dd798e9c41861b, 0x009f76b740081264, 0x006bb2e4300fda1b,
+          0x00df0713d52da274, 0x001cd6fb3409fcfe, 0x0000930ab131a23b},
+         {0x0001798f90a6b445, 0x00e76caef61e3cdd, 0x0062645bee13f520, 0x003fb5c1ddb9c08e,
+          0x007db78742ed231c, 0x00598d5c05090fac, 0x0000ffc9ce625eec}},
+        {{0x00ef6d41c9c4686c, 0x00de880fc57787f9, 0x006f3ef02ef666ff, 0x004828d942ad7aff,
+          0x007742367eeadb9f, 0x0047e1e5504b0d50, 0x0000058e148964a2},
+         {0x00b5d63c31052c00, 0x00459d7bbdd92d69, 0x005a26e8a8f2dfc1, 0x00f86b602bd9d8e6,
+          0x00b44b897d436e8e, 0x0092d642891f3600, 0x000026ead0055ed2}},
+        {{0x00ec16309b66c0f0, 0x00f7b2a9c1310a49, 0x002729c51b9db081, 0x0087c530cb3fec23,
+          0x009ea8474210cc10, 0x0029679b48f465dc, 0x000056269f223129},
+         {0x000a5f8089238b5f, 0x00379afac9b7aa37, 0x00f811fbbe9c027b, 0x00c3fe72ec7a38da,
+          0x005301ccdb9499b7, 0x0064361f6456d2e1, 0x0000d6ddcfc975bc}}
+    },
+    {
+        {{0x0057ae4aa32c2c74, 0x00c930ed00cb15a5, 0x00a024e0ef2841ed, 0x00d1f8de60ffce97,
+          0x00450b70aae9c473, 0x00586ef7062b09c6, 0x0000cc5e1a0bd6c6},
+         {0x0076e482199c1e66, 0x0083d4fbf739ee7c, 0x00d5e3759dd06bdd, 0x0097a2fafd3e6555,
+          0x008829dab7bb34d9, 0x002c38e1dc99d780, 0x0000a0456c3a628d}},
+        {{0x004330ef98324be4, 0x007529928c60b1ec, 0x0000e3ea40210ab5, 0x00c41f0cfd9e425d,
+          0x00c2d2a686d1e630, 0x009c8874c9581188, 0x0000de951db0f2c5},
+         {0x00a39535a7edfbf0, 0x002e10ee8f0d1ba7, 0x0032df5e8b90ca22, 0x00cb5f3246831468,
+          0x0061da8acef6f9ca, 0x00130cfcb427c06e, 0x0000ec247977ca9e}},
+        {{0x00929f7069abdf3f, 0x00d604c2ad9d1e82, 0x00dbcc080655a512, 0x009d479ad06938c2,
+          0x00f3f8d22c7d1e61, 0x009debbe9f071d56, 0x00007325190909d0},
+         {0x0071af8ed4e8abee, 0x005c402c7c2cdde2, 0x00a1aef9193f645a, 0x00499c075a985b96,
+          0x00705aea177a830f, 0x009d9f27f21d9b5f, 0x0000a36dd028025a}},
+        {{0x00662bf665fccf36, 0x002a9ea828e18d84, 0x0076addb7d44c53f, 0x00204bf00b342a21,
+          0x00c5ffcdb8fec0e2, 0x00401cc6bd5e9d6c, 0x000047acf18f8026},
+         {0x00f12b4490c532ef, 0x00b4c83f7911436b, 0x00e6d9ec40fa8644, 0x0010c6ba12a3eb5e,
+          0x000feb7b30d8c204, 0x005b1f0c23f41feb, 0x00001cd46eb61f6d}},
+        {{0x00f7e9a2a730fc88, 0x009886777d0608fa, 0x00e7df0fe331dca7, 0x00a80b7139cc88ad,
+          0x006ea79dc2d6d7a5, 0x007e546a6f6c4756, 0x0000eeaa028c5065},
+         {0x004f628312156ba4, 0x00bfc17828abd7b2, 0x001bc76fb6e090cd, 0x00d83d376b00c0d8,
+          0x00d7ac0cd5d8e01b, 0x00ebda612fe00b35, 0x00007b97049408f1}},
+        {{0x007089a6fceff0cb, 0x007cc86aa406d8a0, 0x005721492805ce8c, 0x007c0d14da356f97,
+          0x008e9c37bd0fce95, 0x007b358bcf864ee6, 0x00006d61ff1fe121},
+         {0x00e172566bba71fe, 0x00cea2e9d305935c, 0x00feb3e03ce235e5, 0x00079a8b618489dc,
+          0x00f6c31fe34585a7, 0x00353f577a1945f7, 0x00007ea9a22f8fb6}},
+        {{0x009c6e02030eb921, 0x00526de4064d3c05, 0x00fc87fd2e706c97, 0x006048535e27a671,
+          0x0015d7583ed3b0a7, 0x0063c4d202715784, 0x000087217b347d6e},
+         {0x00578f309c75c8a2, 0x00a0b3ba4a1e82e3, 0x00bd5ef392a14dd8, 0x00dd6a7589ea5bb0,
+          0x0000a2ad1893eba8, 0x00594f81d9661139, 0x000056216b91e9da}},
+        {{0x009b511548596617, 0x003216dd2ebfc36b, 0x0075acd16d6f4ced, 0x001428020f0a1930,
+          0x005194b76b1afad7, 0x00a55dc305c07cdd, 0x0000a27638fa1e1c},
+         {0x00cc15dddf848788, 0x007a8e6061bf23db, 0x00b1985288a3097b, 0x00fadc5e8e62a9ea,
+          0x001ff2cd9d79cd99, 0x004aed7af9f0cb48, 0x0000f4d8ce6911a8}},
+        {{0x00fb72e3ece4c737, 0x00eafeb7b0666802, 0x008fdb1d61243d8f, 0x0043ac8915183424,
+          0x003c842afcce2c0f, 0x00aa77307045c3ad, 0x0000363fbd035172},
+         {0x00ace5484b439228, 0x00d580b9fd417982, 0x00f329b62dc839b0, 0x00b29761a72e46f0,
+          0x0096269ce27bdba9, 0x00f5c8832f5d5f71, 0x0000ffc5819c6bb5}},
+        {{0x00beaed1d8b018f5, 0x00af90549344fb3c, 0x00b5a5f025fb58c9, 0x00852abd3f60e467,
+          0x0037fdf7cd156388, 0x000e07da77fd8586, 0x00005bd47e2e9c1c},
+         {0x007ea48329ad2535, 0x00c82091a3f0c135, 0x00ddec5da60ea9e7, 0x008f7d80b98ea431,
+          0x001ab2afd9971f31, 0x004a87e957fd0c19, 0x0000f765ac0eb368}},
+        {{0x00636a2979f1d70e, 0x00e13cab80e09b1f, 0x007f14a4e1ddd5df, 0x00c5fce3c1c8b51c,
+          0x0001cc9914956817, 0x00c8f699ce049f3f, 0x00009796b24b2bc0},
+         {0x00f2e1b0cd0f42bf, 0x00825f8b548ea13c, 0x00e30dddca462010, 0x0001fa6d51ff89f8,
+          0x00590403c315b8df, 0x007b4adf7bac761a, 0x00002cf2485a928f}},
+        {{0x0097a7857423debc, 0x007ddcb3970a2718, 0x0070b70db3f04507, 0x006d3ad5c26ef209,
+          0x00049756cb233d44, 0x0062670684205f34, 0x000056849845c982},
+         {0x00ca330820566922, 0x009f1e1de5d3daa7, 0x008912e7e3e0f559, 0x00505683ab7661eb,
+          0x00195ae1d8d35c80, 0x0006214581005e90, 0x000089e8f844ec55}},
+        {{0x0009c3eaea4019b5, 0x005fa905011df17a, 0x00fc2e0ee88c852f, 0x009e10e3875729ed,
+          0x0036211562bd5428, 0x0043d33ddec0952a, 0x00002f41c2da6713},
+         {0x00d9cb9ff6d2968b, 0x00dd051d039ace62, 0x0000cb7fe8583da2, 0x00309ee0524f7ae6,
+          0x00a286bffa747e1c, 0x005bd696aae6b578, 0x000044c81f8fa266}},
+        {{0x00429143c7dd4bf9, 0x006ad3a7932da131, 0x008083b9fa465e6d, 0x00ec426e99fcea80,
+          0x0088ad087d9ade41, 0x0083d632482d07fe, 0x0000b5e87e1b7237},
+         {0x00b67f10965d5c9b, 0x00310fe3232b9abf, 0x004ca76e1b91e878, 0x00d4870145461ce9,
+          0x008b9562a36f1a9d, 0x004578ff53088320, 0x00008749b9986b92}},
+        {{0x0088ffa6a5234577, 0x00f45139627ad425, 0x00017f28d5ba48fc, 0x00d70a7b80dc595b,
+          0x0038873429b98190, 0x002d30301eb9bed3, 0x000033f8b938ae64},
+         {0x007f8bf5c30cdcbd, 0x00e629c1c2b1fd22, 0x001576b95f0152ef, 0x00856138d7265c1c,
+          0x003e51ef84fff7cd, 0x009aeead6044ec91, 0x000093ea6dbbfe99}},
+        {{0x0097197d6764a6d1, 0x0081b7d9fb6a9b12, 0x00e66194023aa829, 0x00faeeab9bbef199,
+          0x00b1e257abc2acde, 0x002bbd59e77c1de1, 0x0000b50fefa14940},
+         {0x00495c28f2b4c11d, 0x00c2082a4a7d81e2, 0x00fd9bf4cb616278, 0x000a5b472dd60d24,
+          0x0033e7f8b98a7047, 0x0025292c8ebe917d, 0x0000ad4a99457442}}
+    },
+    {
+        {{0x00cd56945e730f57, 0x0095a0709f1dbd27, 0x00248b20b5e7887f, 0x00dd677191aff142,
+          0x000e4cde2b5c99e9, 0x00e9a459781f80b3, 0x000016ca2d252850},
+         {0x008aac5c8ed32035, 0x006e98ace2cb1388, 0x006648acb496190d, 0x00e5a02906d2602e,
+          0x009d61866940d5a1, 0x0042e590221ae86e, 0x0000d4cee02f3a7e}},
+        {{0x0015eb3db41f372e, 0x00acce5413894a4d, 0x00ca75665b49a8a8, 0x00fd23529ef1f33f,
+          0x007a4a75f0711a2f, 0x003d3757ffcacad8, 0x00002841b4daff11},
+         {0x00181590c9fab249, 0x002db4db3e1b77c2, 0x00909cfc4d7ec258, 0x0015550e581c2d38,
+          0x009fa3ef96ad8a95, 0x0018d17184f9ff52, 0x00007c4525e91a53}},
+        {{0x00e1af69e7b412a3, 0x004678f09868fe6c, 0x0097a08b7ff63f0e, 0x0061747e1f39d65d,
+          0x00f869d7ab18b661, 0x007b1ec0d6cfc9a7, 0x0000dadee9d3b479},
+         {0x0037b3a046725469, 0x00c25076a594b8e1, 0x008068206c2b6133, 0x001fcf33c4f55c69,
+          0x00296e730fa4c05e, 0x0040a28ce4b7da2e, 0x000078b869977f30}},
+        {{0x00b5bfcdf833cf51, 0x008037fa2f89e1cc, 0x0071d28efac97df6, 0x006dac22189e4251,
+          0x00066b743a8ac365, 0x007ba547974cd548, 0x0000841390c4b7c0},
+         {0x0025e610e922439b, 0x0023a12820235bed, 0x00b9c7d434d36379, 0x0026f57057c5c6c2,
+          0x000b050174798f00, 0x0033013b0c3ece62, 0x0000437e1cd72d03}},
+        {{0x006d6ce4c834eab7, 0x00954dc145cd3105, 0x003bbf98f50613cf, 0x00a4681f1befa2a1,
+          0x004cc14c915d5303, 0x007c11f99b528eca, 0x0000a7c7babd7f97},
+         {0x0068dfe6d616dda8, 0x0068c62d8809abfc, 0x0041e101c4642eb9, 0x006a1e30474a3340,
+          0x00ab4a6ca13ee7fa, 0x00c41100779eb9cc, 0x000012f4bbcbd457}},
+        {{0x006f666f0f9e1744, 0x00e54959d72a878b, 0x008ac392b5d1d8e3, 0x004815d2d4c7f54d,
+          0x0028fff06affe164, 0x003c260e0c1440e5, 0x000047284ada6fd7},
+         {0x00843f5c1535180d, 0x002702ce6b1e2197, 0x003a407429f13946, 0x00a79eccbdab5f1e,
+          0x00e932bc8eccf405, 0x009a2de55e5b93d0, 0x0000ef7d458fe2de}},
+        {{0x009cbf2354d1dc2b, 0x00f8420004ad4412, 0x00eba9926a570eb6, 0x001da2fd7bbfefc9,
+          0x00a453ccfea24b54, 0x004eb384540b3608, 0x000059163eb326f9},
+         {0x00c454da6b4bb1d8, 0x00218057df93cbcf, 0x00af446b6ed3fffd, 0x00eb4cb3b25bf41c,
+          0x002b2a758fba9637, 0x000d786f361e3576, 0x0000ba9ebe5ba591}},
+        {{0x00bf73263b9f3deb, 0x009944356f6eb634, 0x00da1423d3db53c0, 0x00352ee51886d586,
+          0x0049790d442c8f05, 0x0003e6ed1ed05d8c, 0x0000bea9a660d46c},
+         {0x004f88dbe41fa0f1, 0x0057edcab21b7dc1, 0x00f07a367a6c96e6, 0x00468f4a0eb79e80,
+          0x002d242f795338b5, 0x004ae54ab23c94fa, 0x0000858942ff77d9}},
+        {{0x000e99025baa000b, 0x00177ec3d42307f0, 0x00c3160734517847, 0x0081491a1787f426,
+          0x005fd1d3a5d18eed, 0x0048cf5b66c6b6ff, 0x0000ca347e981aa0},
+         {0x00fb1c490f271cb5, 0x00a7dda7d5db91ed, 0x00fab9cc5193bb83, 0x00514b3768271b1f,
+          0x005eefdcc5997c88, 0x0064b5982b81fb0e, 0x0000f6daf3d74fcc}},
+        {{0x00d4775d3df27f29, 0x00212976dc118669, 0x00d32146c1c91d9f, 0x00322b33f75c731a,
+          0x00c1b942c46bd484, 0x00ac2e1c16c7737c, 0x00000c1d5d76b633},
+         {0x00e2247930f84b4d, 0x00d92fa5317a4a24, 0x00b526aa95129f1f, 0x00de6f8fb4443a45,
+          0x0078cc741899d6a7, 0x0053bd6bcde7f59a, 0x0000801eab68fb07}},
+        {{0x0079edddc62c6118, 0x00d5cd79a307149a, 0x0087ea3aae0e03cb, 0x00b9636110416bb6,
+          0x00cd87970cf1c21f, 0x00d507dd95903069, 0x0000098d63744353},
+         {0x00ade7475a98828e, 0x0073e2b0128bf3db, 0x00a7c073c85f37a6, 0x00770bc4b451811c,
+          0x00c2abcce2d6d11c, 0x00c21a6967365302, 0x0000be3d7f5e1d07}},
+        {{0x004882a9605e0cdc, 0x005d68de0195d136, 0x00ef24c8e41d759f, 0x00bba48d92793070,
+          0x0021c924f462a2fb, 0x00109269b6d3c151, 0x0000b2f25311c828},
+         {0x003935389392e816, 0x009748029742c0c1, 0x0018c50507e045cf, 0x007e76c7f2086ba0,
+          0x0058c56263fa0d3b, 0x005ae1fcf627a104, 0x000068d094a579cb}},
+        {{0x00981d7beab63dae, 0x0027a9c4bd0eb729, 0x002a478031c5045d, 0x00c2bcb834737478,
+          0x004debaf56e08061, 0x00c2f9348c65d04a, 0x00000c078efdea17},
+         {0x004626aea9803b88, 0x00ad848e4dfc927c, 0x002a92d20889612c, 0x00c3f9c685ecd426,
+          0x00d224c6d1223d31, 0x00dca41cca423bad, 0x0000d9541c54d737}},
+        {{0x00aeb2e68c06c000, 0x00f26e1a92f3433a, 0x002e21c705089afa, 0x007f337c5b95022f,
+          0x003857322b5d265c, 0x001dfab7f039924b, 0x00009e643d54b336},
+         {0x0053ed7857a0859a, 0x006c0c41847626ea, 0x003036571376f336, 0x007b0eaddfd51aee,
+          0x0053e3f662c189b2, 0x00f84226547fcc32, 0x00007ed0eaa90735}},
+        {{0x002311afa5d04382, 0x0095763362737f8d, 0x00f4904a3eecf5c4, 0x008ddb79470042ff,
+          0x009180dbed5afda8, 0x00e3d6894bb5fd10, 0x0000ead5d3ac5cce},
+         {0x009502183aed6669, 0x0086154925ed47f4, 0x00fcd961e003065f, 0x00c540d2cb9b4bc5,
+          0x00c7d05c7bc08ad7, 0x0034c66c5f63b190, 0x0000eac440240902}},
+        {{0x00604727497ba4b8, 0x001b457c0f635a08, 0x00c55f9422623e4d, 0x004258ad8c39a1eb,
+          0x0005ee0c821e7af5, 0x0077d86c7ed30fe2, 0x00001bcb753ec28f},
+         {0x00549b8dc2387e2c, 0x00f4e09424115ed5, 0x001fa7e986770ee7, 0x009a850cf5844a4e,
+          0x00e0b7ffce96607d, 0x004e6f27909e57a8, 0x00009d70ff15b7dc}}
+    },
+    {
+        {{0x002ae60efdb89d39, 0x003c5023f83b5171, 0x00221e1c78293abf, 0x00b24cadd3c59869,
+          0x00aa05fe35d95b85, 0x00d8f7f5a82b3740, 0x000013beee45e7f5},
+         {0x00aa9ec1df741a6a, 0x001c377eecd684a6, 0x00ef91c00276514d, 0x0013214ea1147d8a,
+          0x008a0868bddd1aaa, 0x00f33115bad99aba, 0x0000434837ea4f01}},
+        {{0x00b3992ed549c0f2, 0x00e5f8a89147807e, 0x006c707bda7d5d45, 0x005a9cefb1ce339b,
+          0x003cbf201d1c3277, 0x00463fd5cae63f36, 0x00008f6c87f39408},
+         {0x0000d65d494e250f, 0x00028efd7ba36c1e, 0x00a130aa342b1685, 0x003612297f8e1ef3,
+          0x009099015c9f380d, 0x0031a608062b5659, 0x00007cef3c75844a}},
+        {{0x007062186c58cdd2, 0x00a0919be0d9837d, 0x00e111e1793f4e96, 0x005f7ba629071249,
+          0x003bc618a3082d06, 0x00431a4f9e07cd23, 0x00002a5615b74148},
+         {0x0061282805650c43, 0x009da75282f503b1, 0x002099835fa6e887, 0x003fe4ffa2087b61,
+          0x00242e886ad59ff8, 0x00a1a66c8c74a4fc, 0x00004fddfc035bfc}},
+        {{0x00547949fa2e32e4, 0x00ed8b77ca9454ff, 0x007af4b269ef85c2, 0x002bc5fbfc70c385,
+          0x00392e63e1d7dca4, 0x0069311aa2266352, 0x0000e9e76cf59e29},
+         {0x00fed677884fdf04, 0x00051c25110c5dc0, 0x00da5c714b4c36d6, 0x000e5758c72c9630,
+          0x00da422527644d20, 0x0085dec5604ba22c, 0x0000442f54140f3b}},
+        {{0x005f77af600bbb94, 0x00905966aebbe4e1, 0x0056f193c1d274d0, 0x00b486a1f5c483e2,
+          0x00da9ff8ef8574b8, 0x00c42887d5947b7a, 0x000051a45d4f02c1},
+         {0x00c13923d4d93f13, 0x00fc22611475c735, 0x00d5bc031ae19a71, 0x00a699423d2c9f07,
+          0x007d1fd2d4791c58, 0x00ca4d163b3f087d, 0x00009afd2b0d2078}},
+        {{0x00a7b88d17baf6b5, 0x00106d2cf6c593b9, 0x00599995c2b521c9, 0x009be45e9fad19d1,
+          0x00a23a08b0eebe0d, 0x00f3bdc69eed0b5d, 0x0000f0c4c3faaf3e},
+         {0x00535d6825736fdc, 0x00bb9b09013b1fd5, 0x00fcc142d76d76db, 0x00c41bd57685d3d9,
+          0x00692ff92e3198ed, 0x00daf3d440e1a5dc, 0x0000b88b52e0014b}},
+        {{0x00a209fee610f88a, 0x004791c1df10379e, 0x00b22eb4e0132afc, 0x002ad5ed49c18e5a,
+          0x003ff02965e53633, 0x0076dfe67b7c2567, 0x0000eaaf99470a2f},
+         {0x00c6f48837656b5a, 0x004cbc9f3643ebae, 0x009b61f5dc25b981, 0x0095321b9a3ebd22,
+          0x0046374c3780f531, 0x00c56aadd733274e, 0x00006be0d35cf2ca}},
+        {{0x00ee504d4b161ab7, 0x001b78ad80afe664, 0x001429196e667316, 0x00c3f97f515a405d,
+          0x002bf586bba14f72, 0x0008b6474e2b34d7, 0x0000e3e25cdb1602},
+         {0x00403859ac337acc, 0x00caf8dd9109115f, 0x00c1cc509e3f9120, 0x0032031df6213049,
+          0x00b3a7cafcba079d, 0x00695959fb89da7e, 0x00003770b64d5442}},
+        {{0x00f7421d51da70c9, 0x0019273821da349e, 0x00a678b82e9b8d07, 0x00de5c17c9273a17,
+          0x00e5f2e50f9281cc, 0x0011646f29be723e, 0x0000ebc61e50000a},
+         {0x00d28d592caebebb, 0x006a7fbda35adbf4, 0x00bbbf7b2dd0d317, 0x007b3d9ba0edda6d,
+          0x00cfeb98a93d867b, 0x003ba112990f4161, 0x0000cde556c3a596}},
+        {{0x0042cf2e2ed42db6, 0x00d2bd634587d5e7, 0x00ed1880ee18a778, 0x0088732e566c01dd,
+          0x007b5ca7ea4126f6, 0x00c7fd00f3c04b7e, 0x00007d9f9d08be38},
+         {0x00a9de0fd17fc390, 0x00dd1e2226738732, 0x00258b3078380ef8, 0x00f13027a28130c9,
+          0x00e9abba3b7d5bb3, 0x009e989327f5da4c, 0x00007081dce3a410}},
+        {{0x007115fbb499d126, 0x000567f3c0aa1396, 0x004d813515c262cf, 0x0044a903801420f7,
+          0x00f8bcec26d21ccd, 0x00313074207afdf5, 0x0000ba2e0bcfe523},
+         {0x00f2d92f7f0b1453, 0x00a7aaa529ffbdab, 0x00ee622b29bca980, 0x00a834f38b415699,
+          0x00f99cd024bca161, 0x00d132781b303dcd, 0x0000a00b595e3352}},
+        {{0x005de741069d95d7, 0x0004b22a094d6421, 0x006b787cd2013279, 0x008a5d496b552526,
+          0x007b0fcaf3881360, 0x00a7d383c4f10c35, 0x000053ce61a57a84},
+         {0x006fde09d7af0a16, 0x00f9b1f663ea5a13, 0x005e01fc444741ec, 0x008f12a0e8b91093,
+          0x00ebd6b3b4b79243, 0x002ba19289a0cd39, 0x0000833cd5cc6caf}},
+        {{0x001dbb68f34f7ebc, 0x00d3e2f7e38637b5, 0x00a3e66b47e96d57, 0x0029dcb8af1a5a9c,
+          0x00e491d26600469c, 0x001a351b3e05f05a, 0x0000c4952695b6a4},
+         {0x007543cd07372f4d, 0x006eea070067a3e9, 0x0019f98565e1bac5, 0x007c42b13fe2a24f,
+          0x004b8e3d83ea38a1, 0x006c92af55003335, 0x00009a05342fc0e0}},
+        {{0x00d9af063b5014ed, 0x0042b618f16488e1, 0x00e84aab06c5665b, 0x00bf3f646a21c562,
+          0x001f6a88d77e897a, 0x00911d09d9c219ba, 0x0000a902cf384515},
+         {0x0077fd95f1a42078, 0x00c68b38c8d85df7, 0x00c23e7926ff37b8, 0x00b17dfea6f8e6e6,
+          0x00a2861c9a5fa370, 0x002d02b0ed7ae782, 0x00008de1d248ba13}},
+        {{0x00b3d4b1d98a9228, 0x0028640ef513764a, 0x00e64e1d477dd78d, 0x00f1b35933d601c8,
+          0x00a7dfc041aa3770, 0x006680a1ed2f87ec, 0x00004b7b47828bfd},
+         {0x00d832d3eb156373, 0x00194341c65eed5d, 0x00e30b9fdf1f6575, 0x001c970f8715927d,
+          0x006fa3dbd28030aa, 0x00db8995f75f2a88, 0x0000c65744b0a771}},
+        {{0x00ed2ff2a7dc885c, 0x00e34b12f8e1fad8, 0x003937d205ceb499, 0x00a5127bf67eb2ff,
+          0x00c96f1b9f1383e8, 0x00dae509e7ad61d6, 0x00007fbbe67cf514},
+         {0x00fe7d204fbc853f, 0x00078a216293457b, 0x00419011a1ce20ad, 0x002cc20642371038,
+          0x000b5e4a2a6509a5, 0x0064622aebe5a278, 0x00000c75541a0a35}}
+    }
+};
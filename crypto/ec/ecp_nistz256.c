@@ -1,5 +1,5 @@
 /*
- * Copyright 2014-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2014-2025 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright (c) 2014, Intel Corporation. All Rights Reserved.
  * Copyright (c) 2015, CloudFlare, Inc.
  *
@@ -40,6 +40,13 @@
 #define ALIGNPTR(p,N)   ((unsigned char *)p+N-(size_t)p%N)
 #define P256_LIMBS      (256/BN_BITS2)
 
+/*
+ * With the assembly point arithmetic the bucket method is already faster than
+ * ecp_nistz256_windowed_mul() from about 64 points, rather than from the
+ * EC_PIPPENGER_MIN_POINTS of the generic code.
+ */
+#define P256_PIPPENGER_MIN_POINTS 64
+
 typedef unsigned short u16;
 
 typedef struct {
@@ -775,6 +782,111 @@ __owur static int ecp_nistz256_windowed_mul(const EC_GROUP *group,
     return ret;
 }
 
+/*
+ * r = sum(scalar[i]*point[i]) with the bucket method of
+ * ossl_ec_pippenger_mul(), on the point arithmetic above. Unlike
+ * ecp_nistz256_windowed_mul(), this is not constant time, so it is only used
+ * with many points, which only happens with public scalars.
+ */
+__owur static int ecp_nistz256_pippenger_mul(const EC_GROUP *group,
+                                             P256_POINT *r,
+                                             const BIGNUM **scalar,
+                                             const EC_POINT **point,
+                                             size_t num, BN_CTX *ctx)
+{
+    const size_t w = ossl_ec_pippenger_window_bits(num, 256);
+    const size_t numdigits = 256 / w + 1;
+    const size_t numbuckets = (size_t)1 << (w - 1);
+    size_t i, j, k, b;
+    int d, ret = 0;
+    int *digits = NULL;
+    P256_POINT *val = NULL, *buckets = NULL;
+    unsigned char *used = NULL;
+    P256_POINT t, sum, acc;
+    const BIGNUM *k_i;
+
+    if (num > OPENSSL_MALLOC_MAX_NELEMS(P256_POINT)
+        || num > OPENSSL_MALLOC_MAX_NELEMS(int) / numdigits
+        || (val = OPENSSL_malloc(num * sizeof(P256_POINT))) == NULL
+        || (digits = OPENSSL_malloc(num * numdigits * sizeof(int))) == NULL
+        || (buckets = OPENSSL_malloc(numbuckets * sizeof(P256_POINT))) == NULL
+        || (used = OPENSSL_malloc(numbuckets)) == NULL)
+        goto err;
+
+    for (i = 0; i < num; i++) {
+        k_i = scalar[i];
+        if ((BN_num_bits(k_i) > 256) || BN_is_negative(k_i)) {
+            BIGNUM *mod;
+
+            if ((mod = BN_CTX_get(ctx)) == NULL)
+                goto err;
+            if (!BN_nnmod(mod, k_i, group->order, ctx)) {
+                ERR_raise(ERR_LIB_EC, ERR_R_BN_LIB);
+                goto err;
+            }
+            k_i = mod;
+        }
+        if (!ossl_ec_pippenger_recode(digits + i * numdigits, numdigits, w,
+                                      k_i)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+
+        if (!ecp_nistz256_bignum_to_field_elem(val[i].X, point[i]->X)
+            || !ecp_nistz256_bignum_to_field_elem(val[i].Y, point[i]->Y)
+            || !ecp_nistz256_bignum_to_field_elem(val[i].Z, point[i]->Z)) {
+            ERR_raise(ERR_LIB_EC, EC_R_COORDINATES_OUT_OF_RANGE);
+            goto err;
+        }
+    }
+
+    /* Infinity is encoded as (,,0) */
+    memset(r, 0, sizeof(*r));
+
+    for (j = numdigits; j-- > 0;) {
+        if (j != numdigits - 1)
+            for (k = 0; k < w; k++)
+                ecp_nistz256_point_double(r, r);
+
+        memset(used, 0, numbuckets);
+        for (i = 0; i < num; i++) {
+            d = digits[i * numdigits + j];
+            if (d == 0)
+                continue;
+            memcpy(&t, &val[i], sizeof(t));
+            if (d < 0) {
+                ecp_nistz256_neg(t.Y, val[i].Y);
+                d = -d;
+            }
+            b = (size_t)d - 1;
+            if (!used[b]) {
+                memcpy(&buckets[b], &t, sizeof(t));
+                used[b] = 1;
+            } else {
+                ecp_nistz256_point_add(&buckets[b], &buckets[b], &t);
+            }
+        }
+
+        /* acc = sum((b + 1) * buckets[b]) */
+        memset(&sum, 0, sizeof(sum));
+        memset(&acc, 0, sizeof(acc));
+        for (b = numbuckets; b-- > 0;) {
+            if (used[b])
+                ecp_nistz256_point_add(&sum, &sum, &buckets[b]);
+            ecp_nistz256_point_add(&acc, &acc, &sum);
+        }
+        ecp_nistz256_point_add(r, r, &acc);
+    }
+
+    ret = 1;
+ err:
+    OPENSSL_free(val);
+    OPENSSL_free(digits);
+    OPENSSL_free(buckets);
+    OPENSSL_free(used);
+    return ret;
+}
+
 /* Coordinates of G, for which we have precomputed tables */
 static const BN_ULONG def_xG[P256_LIMBS] = {
     TOBN(0x79e730d4, 0x18a9143c), TOBN(0x75ba95fc, 0x5fedb601),
@@ -1132,8 +1244,14 @@ __owur static int ecp_nistz256_points_mul(const EC_GROUP *group,
         if (p_is_infinity)
             out = &p.p;
 
-        if (!ecp_nistz256_windowed_mul(group, out, scalars, points, num, ctx))
+        if (num >= P256_PIPPENGER_MIN_POINTS) {
+            if (!ecp_nistz256_pippenger_mul(group, out, scalars, points, num,
+                                            ctx))
+                goto err;
+        } else if (!ecp_nistz256_windowed_mul(group, out, scalars, points,
+                                              num, ctx)) {
             goto err;
+        }
 
         if (!p_is_infinity)
             ecp_nistz256_point_add(&p.p, &p.p, out);
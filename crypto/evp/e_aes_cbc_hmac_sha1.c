@@ -25,6 +25,7 @@
 #include "internal/cryptlib.h"
 #include "crypto/modes.h"
 #include "crypto/evp.h"
+#include "crypto/sha.h"
 #include "internal/constant_time.h"
 #include "evp_local.h"
 
@@ -139,16 +140,6 @@ static void sha1_update(SHA_CTX *c, const void *data, size_t len)
 
 # if !defined(OPENSSL_NO_MULTIBLOCK)
 
-typedef struct {
-    unsigned int A[8], B[8], C[8], D[8], E[8];
-} SHA1_MB_CTX;
-typedef struct {
-    const unsigned char *ptr;
-    int blocks;
-} HASH_DESC;
-
-void sha1_multi_block(SHA1_MB_CTX *, const HASH_DESC *, int);
-
 typedef struct {
     const unsigned char *inp;
     unsigned char *out;
@@ -26,6 +26,7 @@
 #include "crypto/modes.h"
 #include "internal/constant_time.h"
 #include "crypto/evp.h"
+#include "crypto/sha.h"
 #include "evp_local.h"
 
 typedef struct {
@@ -133,16 +134,6 @@ static void sha256_update(SHA256_CTX *c, const void *data, size_t len)
 
 # if !defined(OPENSSL_NO_MULTIBLOCK)
 
-typedef struct {
-    unsigned int A[8], B[8], C[8], D[8], E[8], F[8], G[8], H[8];
-} SHA256_MB_CTX;
-typedef struct {
-    const unsigned char *ptr;
-    int blocks;
-} HASH_DESC;
-
-void sha256_multi_block(SHA256_MB_CTX *, const HASH_DESC *, int);
-
 typedef struct {
     const unsigned char *inp;
     unsigned char *out;
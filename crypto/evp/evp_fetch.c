@@ -18,6 +18,8 @@
 #include "internal/provider.h"
 #include "internal/namemap.h"
 #include "crypto/decoder.h"
+#include "crypto/cryptlib.h"
+#include "crypto/context.h"
 #include "crypto/evp.h"    /* evp_local.h needs it */
 #include "evp_local.h"
 
@@ -237,6 +239,259 @@ static void destruct_evp_method(void *method, void *data)
     methdata->destruct_method(method);
 }
 
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_FETCH_CACHE)
+/*
+ * Per-thread fetch cache
+ * ======================
+ *
+ * Implicit fetches (those that don't name a provider) first look in a small
+ * direct-mapped cache that is private to the calling thread, so that the
+ * fast path doesn't touch any shared data apart from the reference count of
+ * the method itself.  The cache remembers the generation of the EVP method
+ * store that its entries were derived from, and is emptied as soon as that
+ * changes, i.e. when providers are loaded or unloaded or when the default
+ * properties change.  The caches of all threads are also kept in a list, so
+ * that they can be emptied in one go when providers are deactivated and
+ * freed with the library context.
+ */
+# define FETCH_CACHE_SIZE           64      /* Must be a power of 2 */
+# define FETCH_CACHE_PROPQ_LEN      32      /* Longer queries aren't cached */
+
+typedef struct {
+    uint32_t meth_id;                   /* 0 if the entry is unused */
+    void *method;
+    void (*free_method)(void *);
+    char propq[FETCH_CACHE_PROPQ_LEN];
+} FETCH_CACHE_ENTRY;
+
+typedef struct fetch_thread_cache_st FETCH_THREAD_CACHE;
+
+struct fetch_thread_cache_st {
+    /*
+     * Only ever contended when another thread flushes all caches, see
+     * evp_fetch_cache_flush_all()
+     */
+    CRYPTO_RWLOCK *lock;
+    unsigned int generation;
+    FETCH_CACHE_ENTRY entries[FETCH_CACHE_SIZE];
+    /* All caches of a library context, protected by the FETCH_CACHE lock */
+    FETCH_THREAD_CACHE *prev, *next;
+};
+
+typedef struct {
+    CRYPTO_THREAD_LOCAL key;
+    CRYPTO_RWLOCK *lock;
+    FETCH_THREAD_CACHE *threads;
+} FETCH_CACHE;
+
+static void fetch_thread_cache_flush(FETCH_THREAD_CACHE *tc)
+{
+    size_t i;
+
+    for (i = 0; i < FETCH_CACHE_SIZE; i++) {
+        FETCH_CACHE_ENTRY *e = &tc->entries[i];
+
+        if (e->meth_id != 0) {
+            e->free_method(e->method);
+            e->meth_id = 0;
+            e->method = NULL;
+        }
+    }
+}
+
+static void fetch_thread_cache_free(FETCH_THREAD_CACHE *tc)
+{
+    fetch_thread_cache_flush(tc);
+    CRYPTO_THREAD_lock_free(tc->lock);
+    OPENSSL_free(tc);
+}
+
+void *ossl_evp_fetch_cache_new(OSSL_LIB_CTX *libctx)
+{
+    FETCH_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+    if ((cache->lock = CRYPTO_THREAD_lock_new()) == NULL
+        || !CRYPTO_THREAD_init_local(&cache->key, NULL)) {
+        CRYPTO_THREAD_lock_free(cache->lock);
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void ossl_evp_fetch_cache_free(void *vcache)
+{
+    FETCH_CACHE *cache = vcache;
+    FETCH_THREAD_CACHE *tc;
+
+    /*
+     * The caches of threads that are still running, if any, go away along
+     * with the library context, and so do their thread stop handlers.
+     */
+    ossl_init_thread_deregister(cache);
+    while ((tc = cache->threads) != NULL) {
+        cache->threads = tc->next;
+        fetch_thread_cache_free(tc);
+    }
+    CRYPTO_THREAD_cleanup_local(&cache->key);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+static void fetch_thread_cache_delete(void *arg)
+{
+    OSSL_LIB_CTX *libctx = arg;
+    FETCH_CACHE *cache
+        = ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_EVP_FETCH_CACHE_INDEX);
+    FETCH_THREAD_CACHE *tc;
+
+    if (cache == NULL || (tc = CRYPTO_THREAD_get_local(&cache->key)) == NULL)
+        return;
+    CRYPTO_THREAD_set_local(&cache->key, NULL);
+    if (!CRYPTO_THREAD_write_lock(cache->lock))
+        return;
+    if (tc->prev != NULL)
+        tc->prev->next = tc->next;
+    else
+        cache->threads = tc->next;
+    if (tc->next != NULL)
+        tc->next->prev = tc->prev;
+    CRYPTO_THREAD_unlock(cache->lock);
+    fetch_thread_cache_free(tc);
+}
+
+static FETCH_THREAD_CACHE *get_fetch_thread_cache(OSSL_LIB_CTX *libctx,
+                                                  int create)
+{
+    FETCH_CACHE *cache
+        = ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_EVP_FETCH_CACHE_INDEX);
+    FETCH_THREAD_CACHE *tc;
+
+    if (cache == NULL)
+        return NULL;
+    tc = CRYPTO_THREAD_get_local(&cache->key);
+    if (tc == NULL && create) {
+        libctx = ossl_lib_ctx_get_concrete(libctx);
+        if ((tc = OPENSSL_zalloc(sizeof(*tc))) == NULL)
+            return NULL;
+        if ((tc->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+            OPENSSL_free(tc);
+            return NULL;
+        }
+        /*
+         * The thread stop handler may take the global thread event lock,
+         * which is held while handlers run, so register it first.
+         */
+        if (!ossl_init_thread_start(cache, libctx, fetch_thread_cache_delete)
+            || !CRYPTO_THREAD_write_lock(cache->lock)) {
+            fetch_thread_cache_free(tc);
+            return NULL;
+        }
+        if (!CRYPTO_THREAD_set_local(&cache->key, tc)) {
+            CRYPTO_THREAD_unlock(cache->lock);
+            fetch_thread_cache_free(tc);
+            return NULL;
+        }
+        if ((tc->next = cache->threads) != NULL)
+            tc->next->prev = tc;
+        cache->threads = tc;
+        CRYPTO_THREAD_unlock(cache->lock);
+    }
+    return tc;
+}
+
+/*
+ * Empty the caches of all threads, so that they don't keep methods, and the
+ * providers behind them, alive after those were removed from the store.
+ */
+static void evp_fetch_cache_flush_all(OSSL_LIB_CTX *libctx)
+{
+    FETCH_CACHE *cache
+        = ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_EVP_FETCH_CACHE_INDEX);
+    FETCH_THREAD_CACHE *tc;
+
+    if (cache == NULL || !CRYPTO_THREAD_read_lock(cache->lock))
+        return;
+    for (tc = cache->threads; tc != NULL; tc = tc->next) {
+        if (!CRYPTO_THREAD_write_lock(tc->lock))
+            continue;
+        fetch_thread_cache_flush(tc);
+        CRYPTO_THREAD_unlock(tc->lock);
+    }
+    CRYPTO_THREAD_unlock(cache->lock);
+}
+
+static FETCH_CACHE_ENTRY *fetch_cache_entry(FETCH_THREAD_CACHE *tc,
+                                            uint32_t meth_id,
+                                            const char *propq)
+{
+    uint32_t h = meth_id ^ (meth_id >> 8);
+
+    if (*propq != '\0')
+        h ^= (uint32_t)OPENSSL_LH_strhash(propq);
+    return &tc->entries[h & (FETCH_CACHE_SIZE - 1)];
+}
+
+static int evp_fetch_cache_get(OSSL_LIB_CTX *libctx, unsigned int generation,
+                               uint32_t meth_id, const char *propq,
+                               int (*up_ref_method)(void *), void **method)
+{
+    FETCH_THREAD_CACHE *tc = get_fetch_thread_cache(libctx, 0);
+    FETCH_CACHE_ENTRY *e;
+
+    int ret = 0;
+
+    if (tc == NULL || !CRYPTO_THREAD_write_lock(tc->lock))
+        return 0;
+    if (tc->generation != generation) {
+        fetch_thread_cache_flush(tc);
+        tc->generation = generation;
+        goto end;
+    }
+    e = fetch_cache_entry(tc, meth_id, propq);
+    if (e->meth_id != meth_id
+        || strcmp(e->propq, propq) != 0
+        || !up_ref_method(e->method))
+        goto end;
+    *method = e->method;
+    ret = 1;
+ end:
+    CRYPTO_THREAD_unlock(tc->lock);
+    return ret;
+}
+
+static void evp_fetch_cache_set(OSSL_LIB_CTX *libctx, unsigned int generation,
+                                uint32_t meth_id, const char *propq,
+                                void *method, int (*up_ref_method)(void *),
+                                void (*free_method)(void *))
+{
+    FETCH_THREAD_CACHE *tc;
+    FETCH_CACHE_ENTRY *e;
+    size_t len = strlen(propq);
+
+    if (len >= FETCH_CACHE_PROPQ_LEN
+        || (tc = get_fetch_thread_cache(libctx, 1)) == NULL
+        || !CRYPTO_THREAD_write_lock(tc->lock))
+        return;
+    if (tc->generation != generation) {
+        fetch_thread_cache_flush(tc);
+        tc->generation = generation;
+    }
+    if (up_ref_method(method)) {
+        e = fetch_cache_entry(tc, meth_id, propq);
+        if (e->meth_id != 0)
+            e->free_method(e->method);
+        e->meth_id = meth_id;
+        e->method = method;
+        e->free_method = free_method;
+        memcpy(e->propq, propq, len + 1);
+    }
+    CRYPTO_THREAD_unlock(tc->lock);
+}
+#endif
+
 static void *
 inner_evp_generic_fetch(struct evp_method_data_st *methdata,
                         OSSL_PROVIDER *prov, int operation_id,
@@ -253,6 +508,10 @@ inner_evp_generic_fetch(struct evp_method_data_st *methdata,
     uint32_t meth_id = 0;
     void *method = NULL;
     int unsupported, name_id;
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_FETCH_CACHE)
+    int use_thread_cache = prov == NULL;
+    unsigned int generation = 0;
+#endif
 
     if (store == NULL || namemap == NULL) {
         ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_INVALID_ARGUMENT);
@@ -290,6 +549,21 @@ inner_evp_generic_fetch(struct evp_method_data_st *methdata,
      */
     unsupported = name_id == 0;
 
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_FETCH_CACHE)
+    /*
+     * The generation is sampled before anything is looked up, so that a
+     * result computed from a store that changes meanwhile is never cached
+     * as current.
+     */
+    if (use_thread_cache) {
+        generation = ossl_method_store_generation(store);
+        if (meth_id != 0
+            && evp_fetch_cache_get(methdata->libctx, generation, meth_id,
+                                   propq, up_ref_method, &method))
+            return method;
+    }
+#endif
+
     if (meth_id == 0
         || !ossl_method_store_cache_get(store, prov, meth_id, propq, &method)) {
         OSSL_METHOD_CONSTRUCT_METHOD mcm = {
@@ -347,6 +621,12 @@ inner_evp_generic_fetch(struct evp_method_data_st *methdata,
         unsupported = !methdata->flag_construct_error_occurred;
     }
 
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_FETCH_CACHE)
+    if (use_thread_cache && method != NULL && meth_id != 0)
+        evp_fetch_cache_set(methdata->libctx, generation, meth_id, propq,
+                            method, up_ref_method, free_method);
+#endif
+
     if ((name_id != 0 || name != NULL) && method == NULL) {
         int code = unsupported ? ERR_R_UNSUPPORTED : ERR_R_FETCH_FAILED;
 
@@ -412,6 +692,9 @@ int evp_method_store_cache_flush(OSSL_LIB_CTX *libctx)
 {
     OSSL_METHOD_STORE *store = get_evp_method_store(libctx);
 
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_FETCH_CACHE)
+    evp_fetch_cache_flush_all(libctx);
+#endif
     if (store != NULL)
         return ossl_method_store_cache_flush_all(store);
     return 1;
@@ -422,6 +705,9 @@ int evp_method_store_remove_all_provided(const OSSL_PROVIDER *prov)
     OSSL_LIB_CTX *libctx = ossl_provider_libctx(prov);
     OSSL_METHOD_STORE *store = get_evp_method_store(libctx);
 
+#if !defined(FIPS_MODULE) && !defined(OPENSSL_NO_THREAD_FETCH_CACHE)
+    evp_fetch_cache_flush_all(libctx);
+#endif
     if (store != NULL)
         return ossl_method_store_remove_all_provided(store, prov);
     return 1;
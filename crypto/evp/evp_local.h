@@ -1,5 +1,5 @@
 /*
- * Copyright 2000-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2000-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -167,11 +167,13 @@ struct evp_signature_st {
     OSSL_FUNC_signature_newctx_fn *newctx;
     OSSL_FUNC_signature_sign_init_fn *sign_init;
     OSSL_FUNC_signature_sign_fn *sign;
+    OSSL_FUNC_signature_sign_batch_fn *sign_batch;
     OSSL_FUNC_signature_sign_message_init_fn *sign_message_init;
     OSSL_FUNC_signature_sign_message_update_fn *sign_message_update;
     OSSL_FUNC_signature_sign_message_final_fn *sign_message_final;
     OSSL_FUNC_signature_verify_init_fn *verify_init;
     OSSL_FUNC_signature_verify_fn *verify;
+    OSSL_FUNC_signature_verify_batch_fn *verify_batch;
     OSSL_FUNC_signature_verify_message_init_fn *verify_message_init;
     OSSL_FUNC_signature_verify_message_update_fn *verify_message_update;
     OSSL_FUNC_signature_verify_message_final_fn *verify_message_final;
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2006-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -81,6 +81,11 @@ static void *evp_signature_from_algorithm(int name_id,
                 break;
             signature->sign = OSSL_FUNC_signature_sign(fns);
             break;
+        case OSSL_FUNC_SIGNATURE_SIGN_BATCH:
+            if (signature->sign_batch != NULL)
+                break;
+            signature->sign_batch = OSSL_FUNC_signature_sign_batch(fns);
+            break;
         case OSSL_FUNC_SIGNATURE_SIGN_MESSAGE_INIT:
             if (signature->sign_message_init != NULL)
                 break;
@@ -111,6 +116,11 @@ static void *evp_signature_from_algorithm(int name_id,
                 break;
             signature->verify = OSSL_FUNC_signature_verify(fns);
             break;
+        case OSSL_FUNC_SIGNATURE_VERIFY_BATCH:
+            if (signature->verify_batch != NULL)
+                break;
+            signature->verify_batch = OSSL_FUNC_signature_verify_batch(fns);
+            break;
         case OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_INIT:
             if (signature->verify_message_init != NULL)
                 break;
@@ -920,6 +930,42 @@ int EVP_PKEY_sign(EVP_PKEY_CTX *ctx,
         return ctx->pmeth->sign(ctx, sig, siglen, tbs, tbslen);
 }
 
+int EVP_PKEY_sign_batch(EVP_PKEY_CTX *ctx, size_t num,
+                        unsigned char *const *sig, size_t *siglen,
+                        size_t sigsize, const unsigned char *const *tbs,
+                        const size_t *tbslen)
+{
+    size_t i;
+    int ret;
+
+    if (ctx == NULL
+        || (num > 0
+            && (sig == NULL || siglen == NULL || tbs == NULL
+                || tbslen == NULL))) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return -1;
+    }
+
+    if (ctx->operation != EVP_PKEY_OP_SIGN) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_INITIALIZED);
+        return -1;
+    }
+
+    if (ctx->op.sig.algctx != NULL
+        && ctx->op.sig.signature->sign_batch != NULL)
+        return ctx->op.sig.signature->sign_batch(ctx->op.sig.algctx, num,
+                                                 sig, siglen, sigsize,
+                                                 tbs, tbslen);
+
+    for (i = 0; i < num; i++) {
+        siglen[i] = sigsize;
+        ret = EVP_PKEY_sign(ctx, sig[i], &siglen[i], tbs[i], tbslen[i]);
+        if (ret <= 0)
+            return ret;
+    }
+    return 1;
+}
+
 int EVP_PKEY_verify_init(EVP_PKEY_CTX *ctx)
 {
     return evp_pkey_signature_init(ctx, NULL, EVP_PKEY_OP_VERIFY, NULL);
@@ -1044,6 +1090,59 @@ int EVP_PKEY_verify(EVP_PKEY_CTX *ctx,
     return ctx->pmeth->verify(ctx, sig, siglen, tbs, tbslen);
 }
 
+int EVP_PKEY_verify_batch(EVP_PKEY_CTX *ctx, size_t num,
+                          const unsigned char *const *sig,
+                          const size_t *siglen,
+                          const unsigned char *const *tbs,
+                          const size_t *tbslen, int *results)
+{
+    size_t i;
+    int ret, all_valid = 1;
+
+    if (ctx == NULL
+        || (num > 0
+            && (sig == NULL || siglen == NULL || tbs == NULL
+                || tbslen == NULL))) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return -1;
+    }
+
+    if (ctx->operation != EVP_PKEY_OP_VERIFY
+        && ctx->operation != EVP_PKEY_OP_VERIFYMSG) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_INITIALIZED);
+        return -1;
+    }
+
+    if (ctx->op.sig.algctx != NULL
+        && ctx->op.sig.signature->verify_batch != NULL)
+        return ctx->op.sig.signature->verify_batch(ctx->op.sig.algctx, num,
+                                                   sig, siglen, tbs, tbslen,
+                                                   results);
+
+    /*
+     * After EVP_PKEY_verify_message_init() the one-shot EVP_PKEY_verify()
+     * may only be usable once.
+     */
+    if (ctx->operation != EVP_PKEY_OP_VERIFY) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return -2;
+    }
+
+    for (i = 0; i < num; i++) {
+        ret = EVP_PKEY_verify(ctx, sig[i], siglen[i], tbs[i], tbslen[i]);
+        if (ret < 0)
+            return ret;
+        if (results != NULL)
+            results[i] = ret;
+        if (ret == 0) {
+            if (results == NULL)
+                return 0;
+            all_valid = 0;
+        }
+    }
+    return all_valid;
+}
+
 int EVP_PKEY_verify_recover_init(EVP_PKEY_CTX *ctx)
 {
     return evp_pkey_signature_init(ctx, NULL, EVP_PKEY_OP_VERIFYRECOVER, NULL);
@@ -20,6 +20,7 @@
 #include <openssl/lhash.h>
 #include <openssl/rand.h>
 #include "internal/thread_once.h"
+#include "internal/hashtable.h"
 #include "crypto/lhash.h"
 #include "crypto/sparse_array.h"
 #include "property_local.h"
@@ -27,10 +28,15 @@
 
 /*
  * The number of elements in the query cache before we initiate a flush.
+ * Each cached query occupies two elements, one keyed by its provider and
+ * one for lookups that don't specify a provider.
  * If reducing this, also ensure the stochastic test in test/property_test.c
  * isn't likely to fail.
  */
-#define IMPL_CACHE_FLUSH_THRESHOLD  500
+#define IMPL_CACHE_FLUSH_THRESHOLD  1000
+
+/* The initial number of neighborhoods in the query cache hash table */
+#define IMPL_CACHE_BUCKETS          64
 
 typedef struct {
     void *method;
@@ -50,15 +56,29 @@ typedef struct {
     const OSSL_PROVIDER *provider;
     const char *query;
     METHOD method;
+    int nid;
+    /* Flag: 1 if this is the entry for lookups without a provider */
+    unsigned int any_provider:1;
     char body[1];
 } QUERY;
 
-DEFINE_LHASH_OF_EX(QUERY);
+/*
+ * The query cache key.  The query string itself is represented by its hash
+ * and the full string is compared after a successful lookup.
+ */
+HT_START_KEY_DEFN(query_key)
+HT_DEF_KEY_FIELD(nid, int)
+HT_DEF_KEY_FIELD(provider, const OSSL_PROVIDER *)
+HT_DEF_KEY_FIELD(query_hash, unsigned long)
+HT_END_KEY_DEFN(QUERY_KEY)
+
+IMPLEMENT_HT_VALUE_TYPE_FNS(QUERY, cache, static)
 
 typedef struct {
     int nid;
     STACK_OF(IMPLEMENTATION) *impls;
-    LHASH_OF(QUERY) *cache;
+    /* Flag: 1 if the query cache entries for this nid are to be flushed */
+    unsigned int flush_pending:1;
 } ALGORITHM;
 
 struct ossl_method_store_st {
@@ -78,18 +98,30 @@ struct ossl_method_store_st {
      */
     CRYPTO_RWLOCK *biglock;
 
-    /* query cache specific values */
+    /*
+     * The query cache for all algs.  Lookups are done under the RCU read
+     * lock of the hash table only, so that a cache hit never contends with
+     * other readers.  Modifications take the hash table write lock, and
+     * are additionally done while holding |lock| for reading (insertions)
+     * or writing (flushes on store updates).
+     */
+    HT *cache;
 
-    /* Count of the query cache entries for all algs */
-    size_t cache_nelem;
+    /* Incremented on every flush, see ossl_method_store_generation() */
+    TSAN_QUALIFIER unsigned int generation;
 
-    /* Flag: 1 if query cache entries for all algs need flushing */
-    int cache_need_flush;
+    /*
+     * While a thread holds |biglock|, the cache flushes its additions cause
+     * are collected and done in one pass when the store is unlocked, rather
+     * than walking the whole cache once per algorithm.  These are protected
+     * by |lock|.
+     */
+    size_t flush_pending;
+    CRYPTO_THREAD_ID biglock_owner;
+    unsigned int biglock_held:1;
 };
 
 typedef struct {
-    LHASH_OF(QUERY) *cache;
-    size_t nelem;
     uint32_t seed;
     unsigned char using_global_seed;
 } IMPL_CACHE_FLUSH;
@@ -105,9 +137,8 @@ typedef struct ossl_global_properties_st {
 #endif
 } OSSL_GLOBAL_PROPERTIES;
 
-static void ossl_method_cache_flush_alg(OSSL_METHOD_STORE *store,
-                                        ALGORITHM *alg);
 static void ossl_method_cache_flush(OSSL_METHOD_STORE *store, int nid);
+static void ossl_method_cache_flush_pending(OSSL_METHOD_STORE *store);
 
 /* Global properties are stored per library context */
 void ossl_ctx_global_properties_free(void *vglobp)
@@ -183,20 +214,19 @@ static int ossl_property_unlock(OSSL_METHOD_STORE *p)
     return p != 0 ? CRYPTO_THREAD_unlock(p->lock) : 0;
 }
 
-static unsigned long query_hash(const QUERY *a)
+static void query_key_init(QUERY_KEY *key, int nid,
+                           const OSSL_PROVIDER *prov, const char *query)
 {
-    return OPENSSL_LH_strhash(a->query);
+    HT_INIT_KEY(key);
+    HT_SET_KEY_FIELD(key, nid, nid);
+    HT_SET_KEY_FIELD(key, provider, prov);
+    HT_SET_KEY_FIELD(key, query_hash, OPENSSL_LH_strhash(query));
 }
 
-static int query_cmp(const QUERY *a, const QUERY *b)
+static void query_key_from_elem(QUERY_KEY *key, const QUERY *elem)
 {
-    int res = strcmp(a->query, b->query);
-
-    if (res == 0 && a->provider != NULL && b->provider != NULL)
-        res = b->provider > a->provider ? 1
-            : b->provider < a->provider ? -1
-            : 0;
-    return res;
+    query_key_init(key, elem->nid,
+                   elem->any_provider ? NULL : elem->provider, elem->query);
 }
 
 static void impl_free(IMPLEMENTATION *impl)
@@ -215,10 +245,10 @@ static void impl_cache_free(QUERY *elem)
     }
 }
 
-static void impl_cache_flush_alg(ossl_uintmax_t idx, ALGORITHM *alg)
+/* Called by the hash table once no reader can reference the entry any more */
+static void impl_cache_ht_free(HT_VALUE *v)
 {
-    lh_QUERY_doall(alg->cache, &impl_cache_free);
-    lh_QUERY_flush(alg->cache);
+    impl_cache_free(ossl_ht_cache_QUERY_from_value(v));
 }
 
 static void alg_cleanup(ossl_uintmax_t idx, ALGORITHM *a, void *arg)
@@ -227,8 +257,6 @@ static void alg_cleanup(ossl_uintmax_t idx, ALGORITHM *a, void *arg)
 
     if (a != NULL) {
         sk_IMPLEMENTATION_pop_free(a->impls, &impl_free);
-        lh_QUERY_doall(a->cache, &impl_cache_free);
-        lh_QUERY_free(a->cache);
         OPENSSL_free(a);
     }
     if (store != NULL)
@@ -242,13 +270,17 @@ static void alg_cleanup(ossl_uintmax_t idx, ALGORITHM *a, void *arg)
 OSSL_METHOD_STORE *ossl_method_store_new(OSSL_LIB_CTX *ctx)
 {
     OSSL_METHOD_STORE *res;
+    HT_CONFIG htconf = { NULL, impl_cache_ht_free, NULL,
+                         IMPL_CACHE_BUCKETS, 1, 0 };
 
+    htconf.ctx = ctx;
     res = OPENSSL_zalloc(sizeof(*res));
     if (res != NULL) {
         res->ctx = ctx;
         if ((res->algs = ossl_sa_ALGORITHM_new()) == NULL
             || (res->lock = CRYPTO_THREAD_lock_new()) == NULL
-            || (res->biglock = CRYPTO_THREAD_lock_new()) == NULL) {
+            || (res->biglock = CRYPTO_THREAD_lock_new()) == NULL
+            || (res->cache = ossl_ht_new(&htconf)) == NULL) {
             ossl_method_store_free(res);
             return NULL;
         }
@@ -259,6 +291,7 @@ OSSL_METHOD_STORE *ossl_method_store_new(OSSL_LIB_CTX *ctx)
 void ossl_method_store_free(OSSL_METHOD_STORE *store)
 {
     if (store != NULL) {
+        ossl_ht_free(store->cache);
         if (store->algs != NULL)
             ossl_sa_ALGORITHM_doall_arg(store->algs, &alg_cleanup, store);
         ossl_sa_ALGORITHM_free(store->algs);
@@ -270,12 +303,29 @@ void ossl_method_store_free(OSSL_METHOD_STORE *store)
 
 int ossl_method_lock_store(OSSL_METHOD_STORE *store)
 {
-    return store != NULL ? CRYPTO_THREAD_write_lock(store->biglock) : 0;
+    if (store == NULL || !CRYPTO_THREAD_write_lock(store->biglock))
+        return 0;
+    if (!ossl_property_write_lock(store)) {
+        CRYPTO_THREAD_unlock(store->biglock);
+        return 0;
+    }
+    store->biglock_owner = CRYPTO_THREAD_get_current_id();
+    store->biglock_held = 1;
+    ossl_property_unlock(store);
+    return 1;
 }
 
 int ossl_method_unlock_store(OSSL_METHOD_STORE *store)
 {
-    return store != NULL ? CRYPTO_THREAD_unlock(store->biglock) : 0;
+    if (store == NULL)
+        return 0;
+    /* Do the cache flushes deferred while the store was reserved */
+    if (ossl_property_write_lock(store)) {
+        ossl_method_cache_flush_pending(store);
+        store->biglock_held = 0;
+        ossl_property_unlock(store);
+    }
+    return CRYPTO_THREAD_unlock(store->biglock);
 }
 
 static ALGORITHM *ossl_method_store_retrieve(OSSL_METHOD_STORE *store, int nid)
@@ -324,7 +374,6 @@ int ossl_method_store_add(OSSL_METHOD_STORE *store, const OSSL_PROVIDER *prov,
         OPENSSL_free(impl);
         return 0;
     }
-    ossl_method_cache_flush(store, nid);
     if ((impl->properties = ossl_prop_defn_get(store->ctx, properties)) == NULL) {
         impl->properties = ossl_parse_property(store->ctx, properties);
         if (impl->properties == NULL)
@@ -339,12 +388,21 @@ int ossl_method_store_add(OSSL_METHOD_STORE *store, const OSSL_PROVIDER *prov,
     alg = ossl_method_store_retrieve(store, nid);
     if (alg == NULL) {
         if ((alg = OPENSSL_zalloc(sizeof(*alg))) == NULL
-                || (alg->impls = sk_IMPLEMENTATION_new_null()) == NULL
-                || (alg->cache = lh_QUERY_new(&query_hash, &query_cmp)) == NULL)
+                || (alg->impls = sk_IMPLEMENTATION_new_null()) == NULL)
             goto err;
         alg->nid = nid;
         if (!ossl_method_store_insert(store, alg))
             goto err;
+    } else if (store->biglock_held
+               && CRYPTO_THREAD_compare_id(store->biglock_owner,
+                                           CRYPTO_THREAD_get_current_id())) {
+        /* Flushed by ossl_method_unlock_store(), along with the others */
+        if (!alg->flush_pending) {
+            alg->flush_pending = 1;
+            store->flush_pending++;
+        }
+    } else {
+        ossl_method_cache_flush(store, nid);
     }
 
     /* Push onto stack if there isn't one there already */
@@ -436,10 +494,13 @@ alg_cleanup_by_provider(ossl_uintmax_t idx, ALGORITHM *alg, void *arg)
      * If we removed any implementation, we also clear the whole associated
      * cache, 'cause that's the sensible thing to do.
      * There's no point flushing the cache entries where we didn't remove
-     * any implementation, though.
+     * any implementation, though.  The flushes are all done together by
+     * ossl_method_store_remove_all_provided() once the walk is complete.
      */
-    if (count > 0)
-        ossl_method_cache_flush_alg(data->store, alg);
+    if (count > 0 && !alg->flush_pending) {
+        alg->flush_pending = 1;
+        data->store->flush_pending++;
+    }
 }
 
 int ossl_method_store_remove_all_provided(OSSL_METHOD_STORE *store,
@@ -452,6 +513,7 @@ int ossl_method_store_remove_all_provided(OSSL_METHOD_STORE *store,
     data.prov = prov;
     data.store = store;
     ossl_sa_ALGORITHM_doall_arg(store->algs, &alg_cleanup_by_provider, &data);
+    ossl_method_cache_flush_pending(store);
     ossl_property_unlock(store);
     return 1;
 }
@@ -587,32 +649,94 @@ fin:
     return ret;
 }
 
-static void ossl_method_cache_flush_alg(OSSL_METHOD_STORE *store,
-                                        ALGORITHM *alg)
+/*
+ * Remove the query cache entries selected by |filter|.
+ * Must be called with the query cache write lock held.
+ */
+static void impl_cache_delete_matching(HT *cache,
+                                       int (*filter)(HT_VALUE *obj, void *arg),
+                                       void *arg)
+{
+    HT_VALUE_LIST *list;
+    QUERY_KEY key;
+    size_t i, n = ossl_ht_count(cache);
+
+    if (n == 0)
+        return;
+    if ((list = ossl_ht_filter(cache, n, filter, arg)) == NULL)
+        return;
+    for (i = 0; i < list->list_len; i++) {
+        query_key_from_elem(&key,
+                            ossl_ht_cache_QUERY_from_value(list->list[i]));
+        (void)ossl_ht_delete(cache, TO_HT_KEY(&key));
+    }
+    ossl_ht_value_list_free(list);
+}
+
+static int impl_cache_match_nid(HT_VALUE *v, void *arg)
 {
-    store->cache_nelem -= lh_QUERY_num_items(alg->cache);
-    impl_cache_flush_alg(0, alg);
+    QUERY *elem = ossl_ht_cache_QUERY_from_value(v);
+
+    return elem != NULL && elem->nid == *(int *)arg;
 }
 
 static void ossl_method_cache_flush(OSSL_METHOD_STORE *store, int nid)
 {
-    ALGORITHM *alg = ossl_method_store_retrieve(store, nid);
+    tsan_add(&store->generation, 1);
+    ossl_ht_write_lock(store->cache);
+    impl_cache_delete_matching(store->cache, &impl_cache_match_nid, &nid);
+    ossl_ht_write_unlock(store->cache);
+}
 
-    if (alg != NULL)
-        ossl_method_cache_flush_alg(store, alg);
+static int impl_cache_match_pending(HT_VALUE *v, void *arg)
+{
+    QUERY *elem = ossl_ht_cache_QUERY_from_value(v);
+    ALGORITHM *alg;
+
+    if (elem == NULL)
+        return 0;
+    alg = ossl_method_store_retrieve(arg, elem->nid);
+    return alg != NULL && alg->flush_pending;
+}
+
+static void alg_clear_flush_pending(ossl_uintmax_t idx, ALGORITHM *alg)
+{
+    alg->flush_pending = 0;
+}
+
+/*
+ * Flush the cache entries of all algorithms marked |flush_pending| in a
+ * single pass over the cache.
+ * Must be called with the store write lock held.
+ */
+static void ossl_method_cache_flush_pending(OSSL_METHOD_STORE *store)
+{
+    if (store->flush_pending == 0)
+        return;
+    tsan_add(&store->generation, 1);
+    ossl_ht_write_lock(store->cache);
+    impl_cache_delete_matching(store->cache, &impl_cache_match_pending, store);
+    ossl_ht_write_unlock(store->cache);
+    ossl_sa_ALGORITHM_doall(store->algs, &alg_clear_flush_pending);
+    store->flush_pending = 0;
 }
 
 int ossl_method_store_cache_flush_all(OSSL_METHOD_STORE *store)
 {
     if (!ossl_property_write_lock(store))
         return 0;
-    ossl_sa_ALGORITHM_doall(store->algs, &impl_cache_flush_alg);
-    store->cache_nelem = 0;
+    tsan_add(&store->generation, 1);
+    ossl_ht_write_lock(store->cache);
+    ossl_ht_flush(store->cache);
+    ossl_ht_write_unlock(store->cache);
     ossl_property_unlock(store);
     return 1;
 }
 
-IMPLEMENT_LHASH_DOALL_ARG(QUERY, IMPL_CACHE_FLUSH);
+unsigned int ossl_method_store_generation(OSSL_METHOD_STORE *store)
+{
+    return tsan_load(&store->generation);
+}
 
 /*
  * Flush an element from the query cache (perhaps).
@@ -630,8 +754,9 @@ IMPLEMENT_LHASH_DOALL_ARG(QUERY, IMPL_CACHE_FLUSH);
  * preferable to a more refined approach that imposes a performance
  * impact.
  */
-static void impl_cache_flush_cache(QUERY *c, IMPL_CACHE_FLUSH *state)
+static int impl_cache_flush_cache(HT_VALUE *v, void *arg)
 {
+    IMPL_CACHE_FLUSH *state = arg;
     uint32_t n;
 
     /*
@@ -647,40 +772,22 @@ static void impl_cache_flush_cache(QUERY *c, IMPL_CACHE_FLUSH *state)
     n ^= n << 5;
     state->seed = n;
 
-    if ((n & 1) != 0)
-        impl_cache_free(lh_QUERY_delete(state->cache, c));
-    else
-        state->nelem++;
-}
-
-static void impl_cache_flush_one_alg(ossl_uintmax_t idx, ALGORITHM *alg,
-                                     void *v)
-{
-    IMPL_CACHE_FLUSH *state = (IMPL_CACHE_FLUSH *)v;
-    unsigned long orig_down_load = lh_QUERY_get_down_load(alg->cache);
-
-    state->cache = alg->cache;
-    lh_QUERY_set_down_load(alg->cache, 0);
-    lh_QUERY_doall_IMPL_CACHE_FLUSH(state->cache, &impl_cache_flush_cache,
-                                    state);
-    lh_QUERY_set_down_load(alg->cache, orig_down_load);
+    return (n & 1) != 0;
 }
 
+/* Must be called with the query cache write lock held */
 static void ossl_method_cache_flush_some(OSSL_METHOD_STORE *store)
 {
     IMPL_CACHE_FLUSH state;
     static TSAN_QUALIFIER uint32_t global_seed = 1;
 
-    state.nelem = 0;
     state.using_global_seed = 0;
     if ((state.seed = OPENSSL_rdtsc()) == 0) {
         /* If there is no timer available, seed another way */
         state.using_global_seed = 1;
         state.seed = tsan_load(&global_seed);
     }
-    store->cache_need_flush = 0;
-    ossl_sa_ALGORITHM_doall_arg(store->algs, &impl_cache_flush_one_alg, &state);
-    store->cache_nelem = state.nelem;
+    impl_cache_delete_matching(store->cache, &impl_cache_flush_cache, &state);
     /* Without a timer, update the global seed */
     if (state.using_global_seed)
         tsan_add(&global_seed, state.seed);
@@ -689,42 +796,67 @@ static void ossl_method_cache_flush_some(OSSL_METHOD_STORE *store)
 int ossl_method_store_cache_get(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
                                 int nid, const char *prop_query, void **method)
 {
-    ALGORITHM *alg;
-    QUERY elem, *r;
+    QUERY_KEY key;
+    HT_VALUE *v;
+    QUERY *r;
     int res = 0;
 
     if (nid <= 0 || store == NULL || prop_query == NULL)
         return 0;
 
-    if (!ossl_property_read_lock(store))
-        return 0;
-    alg = ossl_method_store_retrieve(store, nid);
-    if (alg == NULL)
-        goto err;
+    query_key_init(&key, nid, prov, prop_query);
 
-    elem.query = prop_query;
-    elem.provider = prov;
-    r = lh_QUERY_retrieve(alg->cache, &elem);
-    if (r == NULL)
-        goto err;
-    if (ossl_method_up_ref(&r->method)) {
+    /*
+     * Only the RCU read lock of the cache is taken here, the store lock
+     * isn't needed because any cache entry for an algorithm is removed
+     * before the update that changes that algorithm is complete.
+     */
+    ossl_ht_read_lock(store->cache);
+    r = ossl_ht_cache_QUERY_get(store->cache, TO_HT_KEY(&key), &v);
+    if (r != NULL
+        && strcmp(r->query, prop_query) == 0
+        && ossl_method_up_ref(&r->method)) {
         *method = r->method.method;
         res = 1;
     }
-err:
-    ossl_property_unlock(store);
+    ossl_ht_read_unlock(store->cache);
     return res;
 }
 
+static QUERY *impl_cache_new(const OSSL_PROVIDER *prov, int nid,
+                             const char *prop_query, int any_provider,
+                             void *method, int (*method_up_ref)(void *),
+                             void (*method_destruct)(void *))
+{
+    size_t len = strlen(prop_query);
+    QUERY *p = OPENSSL_malloc(sizeof(*p) + len);
+
+    if (p == NULL)
+        return NULL;
+    p->query = p->body;
+    p->provider = prov;
+    p->nid = nid;
+    p->any_provider = any_provider;
+    p->method.method = method;
+    p->method.up_ref = method_up_ref;
+    p->method.free = method_destruct;
+    if (!ossl_method_up_ref(&p->method)) {
+        OPENSSL_free(p);
+        return NULL;
+    }
+    memcpy((char *)p->query, prop_query, len + 1);
+    return p;
+}
+
 int ossl_method_store_cache_set(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
                                 int nid, const char *prop_query, void *method,
                                 int (*method_up_ref)(void *),
                                 void (*method_destruct)(void *))
 {
-    QUERY elem, *old, *p = NULL;
-    ALGORITHM *alg;
-    size_t len;
-    int res = 1;
+    QUERY_KEY key;
+    HT_VALUE *v;
+    QUERY *elem[2] = { NULL, NULL }, *old[2] = { NULL, NULL }, *r;
+    int i, res = 0;
 
     if (nid <= 0 || store == NULL || prop_query == NULL)
         return 0;
@@ -732,48 +864,56 @@ int ossl_method_store_cache_set(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
     if (!ossl_assert(prov != NULL))
         return 0;
 
-    if (!ossl_property_write_lock(store))
+    /*
+     * The store read lock keeps the algorithm from changing (and flushing
+     * its cache entries) while we insert.
+     */
+    if (!ossl_property_read_lock(store))
         return 0;
-    if (store->cache_need_flush)
-        ossl_method_cache_flush_some(store);
-    alg = ossl_method_store_retrieve(store, nid);
-    if (alg == NULL)
+    if (ossl_method_store_retrieve(store, nid) == NULL)
         goto err;
 
-    if (method == NULL) {
-        elem.query = prop_query;
-        elem.provider = prov;
-        if ((old = lh_QUERY_delete(alg->cache, &elem)) != NULL) {
-            impl_cache_free(old);
-            store->cache_nelem--;
-        }
-        goto end;
+    if (method != NULL) {
+        /*
+         * Each query gets two entries, one keyed by provider and one for
+         * lookups that don't care about the provider.
+         */
+        for (i = 0; i < 2; i++)
+            if ((elem[i] = impl_cache_new(prov, nid, prop_query, i, method,
+                                          method_up_ref,
+                                          method_destruct)) == NULL)
+                goto err;
     }
-    p = OPENSSL_malloc(sizeof(*p) + (len = strlen(prop_query)));
-    if (p != NULL) {
-        p->query = p->body;
-        p->provider = prov;
-        p->method.method = method;
-        p->method.up_ref = method_up_ref;
-        p->method.free = method_destruct;
-        if (!ossl_method_up_ref(&p->method))
-            goto err;
-        memcpy((char *)p->query, prop_query, len + 1);
-        if ((old = lh_QUERY_insert(alg->cache, p)) != NULL) {
-            impl_cache_free(old);
-            goto end;
-        }
-        if (!lh_QUERY_error(alg->cache)) {
-            if (++store->cache_nelem >= IMPL_CACHE_FLUSH_THRESHOLD)
-                store->cache_need_flush = 1;
-            goto end;
+
+    ossl_ht_write_lock(store->cache);
+    if (method == NULL) {
+        query_key_init(&key, nid, prov, prop_query);
+        (void)ossl_ht_delete(store->cache, TO_HT_KEY(&key));
+        query_key_init(&key, nid, NULL, prop_query);
+        r = ossl_ht_cache_QUERY_get(store->cache, TO_HT_KEY(&key), &v);
+        if (r != NULL && r->provider == prov)
+            (void)ossl_ht_delete(store->cache, TO_HT_KEY(&key));
+        res = 1;
+    } else {
+        if (ossl_ht_count(store->cache) >= IMPL_CACHE_FLUSH_THRESHOLD)
+            ossl_method_cache_flush_some(store);
+        for (i = 0; i < 2; i++) {
+            query_key_from_elem(&key, elem[i]);
+            if (ossl_ht_cache_QUERY_insert(store->cache, TO_HT_KEY(&key),
+                                           elem[i], &old[i]) <= 0)
+                break;
+            elem[i] = NULL;
         }
-        ossl_method_free(&p->method);
+        res = i == 2;
     }
+    /* This waits for the readers if anything was deleted or replaced */
+    ossl_ht_write_unlock(store->cache);
+
 err:
-    res = 0;
-    OPENSSL_free(p);
-end:
     ossl_property_unlock(store);
+    for (i = 0; i < 2; i++) {
+        impl_cache_free(old[i]);
+        impl_cache_free(elem[i]);
+    }
     return res;
 }
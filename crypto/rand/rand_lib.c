@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -35,6 +35,7 @@
 # include "prov/seeding.h"
 # include "internal/e_os.h"
 # include "internal/property.h"
+# include "internal/tsan_assist.h"
 
 # ifndef OPENSSL_NO_ENGINE
 /* non-NULL if default_RAND_meth is ENGINE-provided */
@@ -49,6 +50,23 @@ static CRYPTO_ONCE rand_init = CRYPTO_ONCE_STATIC_INIT;
 
 static int rand_inited = 0;
 
+/*
+ * Incremented whenever the random bytes buffered for RAND_bytes() by any
+ * thread must no longer be used, see RAND_set_public_buffer_size().
+ */
+static TSAN_QUALIFIER int rand_buffer_generation;
+
+/* The largest request served from a buffer, as a fraction of its size */
+# define RAND_BUFFER_MAX_REQUEST_DIV    4
+/* The largest buffer size which can be set */
+# define RAND_BUFFER_MAX_SIZE           (1 << 20)
+
+static int rand_buffer_get(OSSL_LIB_CTX *ctx, unsigned char *out, size_t num,
+                           unsigned int strength, int generation);
+static int rand_buffer_refill(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand,
+                              size_t num, unsigned int strength,
+                              int generation);
+
 DEFINE_RUN_ONCE_STATIC(do_rand_init)
 {
 # ifndef OPENSSL_NO_ENGINE
@@ -179,6 +197,7 @@ static int rand_set_rand_method_internal(const RAND_METHOD *meth,
 #  endif
     default_RAND_meth = meth;
     CRYPTO_THREAD_unlock(rand_meth_lock);
+    tsan_counter(&rand_buffer_generation);
     return 1;
 }
 
@@ -263,6 +282,7 @@ void RAND_seed(const void *buf, int num)
 
     if (meth != NULL && meth->seed != NULL) {
         meth->seed(buf, num);
+        tsan_counter(&rand_buffer_generation);
         return;
     }
 # endif
@@ -270,6 +290,7 @@ void RAND_seed(const void *buf, int num)
     drbg = RAND_get0_primary(NULL);
     if (drbg != NULL && num > 0)
         EVP_RAND_reseed(drbg, 0, NULL, 0, buf, num);
+    tsan_counter(&rand_buffer_generation);
 }
 
 void RAND_add(const void *buf, int num, double randomness)
@@ -280,6 +301,7 @@ void RAND_add(const void *buf, int num, double randomness)
 
     if (meth != NULL && meth->add != NULL) {
         meth->add(buf, num, randomness);
+        tsan_counter(&rand_buffer_generation);
         return;
     }
 # endif
@@ -292,6 +314,7 @@ void RAND_add(const void *buf, int num, double randomness)
         /* With an entropy source, we downgrade this to additional input */
         EVP_RAND_reseed(drbg, 0, NULL, 0, buf, num);
 # endif
+    tsan_counter(&rand_buffer_generation);
 }
 
 # if !defined(OPENSSL_NO_DEPRECATED_1_1_0)
@@ -368,22 +391,39 @@ int RAND_bytes_ex(OSSL_LIB_CTX *ctx, unsigned char *buf, size_t num,
                   unsigned int strength)
 {
     EVP_RAND_CTX *rand;
-#if !defined(OPENSSL_NO_DEPRECATED_3_0) && !defined(FIPS_MODULE)
-    const RAND_METHOD *meth = RAND_get_rand_method();
+#ifndef FIPS_MODULE
+    int generation;
+# ifndef OPENSSL_NO_DEPRECATED_3_0
+    const RAND_METHOD *meth;
+# endif
 
+    /* Read before anything which could make buffered bytes unusable */
+    generation = tsan_ld_acq(&rand_buffer_generation);
+
+    /* Serve small requests from the buffer of this thread if possible */
+    if (rand_buffer_get(ctx, buf, num, strength, generation))
+        return 1;
+
+# ifndef OPENSSL_NO_DEPRECATED_3_0
+    meth = RAND_get_rand_method();
     if (meth != NULL && meth != RAND_OpenSSL()) {
         if (meth->bytes != NULL)
             return meth->bytes(buf, num);
         ERR_raise(ERR_LIB_RAND, RAND_R_FUNC_NOT_IMPLEMENTED);
         return -1;
     }
+# endif
 #endif
 
     rand = RAND_get0_public(ctx);
-    if (rand != NULL)
-        return EVP_RAND_generate(rand, buf, num, strength, 0, NULL, 0);
-
-    return 0;
+    if (rand == NULL)
+        return 0;
+#ifndef FIPS_MODULE
+    if (rand_buffer_refill(ctx, rand, num, strength, generation)
+        && rand_buffer_get(ctx, buf, num, strength, generation))
+        return 1;
+#endif
+    return EVP_RAND_generate(rand, buf, num, strength, 0, NULL, 0);
 }
 
 int RAND_bytes(unsigned char *buf, int num)
@@ -439,6 +479,18 @@ typedef struct rand_global_st {
      */
     CRYPTO_THREAD_LOCAL private;
 
+#ifndef FIPS_MODULE
+    /*
+     * The output of the <public> DRBG buffered for RAND_bytes()
+     *
+     * If |public_buffer_size| is not zero, each thread generates that many
+     * bytes from its <public> DRBG at once and serves small requests from
+     * them without going through the DRBG.
+     */
+    CRYPTO_THREAD_LOCAL public_buffer;
+    TSAN_QUALIFIER size_t public_buffer_size;
+#endif
+
     /* Which RNG is being used by default and it's configuration settings */
     char *rng_name;
     char *rng_cipher;
@@ -479,8 +531,17 @@ void *ossl_rand_ctx_new(OSSL_LIB_CTX *libctx)
     if (!CRYPTO_THREAD_init_local(&dgbl->public, NULL))
         goto err2;
 
+#ifndef FIPS_MODULE
+    if (!CRYPTO_THREAD_init_local(&dgbl->public_buffer, NULL))
+        goto err3;
+#endif
+
     return dgbl;
 
+#ifndef FIPS_MODULE
+ err3:
+    CRYPTO_THREAD_cleanup_local(&dgbl->public);
+#endif
  err2:
     CRYPTO_THREAD_cleanup_local(&dgbl->private);
  err1:
@@ -499,6 +560,9 @@ void ossl_rand_ctx_free(void *vdgbl)
     CRYPTO_THREAD_lock_free(dgbl->lock);
     CRYPTO_THREAD_cleanup_local(&dgbl->private);
     CRYPTO_THREAD_cleanup_local(&dgbl->public);
+#ifndef FIPS_MODULE
+    CRYPTO_THREAD_cleanup_local(&dgbl->public_buffer);
+#endif
     EVP_RAND_CTX_free(dgbl->primary);
     EVP_RAND_CTX_free(dgbl->seed);
     OPENSSL_free(dgbl->rng_name);
@@ -516,11 +580,42 @@ static RAND_GLOBAL *rand_get_global(OSSL_LIB_CTX *libctx)
     return ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_DRBG_INDEX);
 }
 
+#ifndef FIPS_MODULE
+/* The output of the <public> DRBG of a thread buffered for RAND_bytes() */
+typedef struct rand_buffer_st {
+    unsigned char *data;
+    size_t size;
+    size_t pos;                 /* Of the first byte not handed out yet */
+    unsigned int strength;      /* Of the DRBG which generated the bytes */
+    int generation;             /* Of rand_buffer_generation when generated */
+    int fork_id;                /* Of the process which generated the bytes */
+} RAND_BUFFER;
+
+static void rand_buffer_discard(RAND_BUFFER *buffer)
+{
+    if (buffer == NULL)
+        return;
+    OPENSSL_cleanse(buffer->data + buffer->pos, buffer->size - buffer->pos);
+    buffer->pos = buffer->size;
+}
+
+static void rand_buffer_free(RAND_BUFFER *buffer)
+{
+    if (buffer == NULL)
+        return;
+    OPENSSL_clear_free(buffer->data, buffer->size);
+    OPENSSL_free(buffer);
+}
+#endif
+
 static void rand_delete_thread_state(void *arg)
 {
     OSSL_LIB_CTX *ctx = arg;
     RAND_GLOBAL *dgbl = rand_get_global(ctx);
     EVP_RAND_CTX *rand;
+#ifndef FIPS_MODULE
+    RAND_BUFFER *buffer;
+#endif
 
     if (dgbl == NULL)
         return;
@@ -532,6 +627,12 @@ static void rand_delete_thread_state(void *arg)
     rand = CRYPTO_THREAD_get_local(&dgbl->private);
     CRYPTO_THREAD_set_local(&dgbl->private, NULL);
     EVP_RAND_CTX_free(rand);
+
+#ifndef FIPS_MODULE
+    buffer = CRYPTO_THREAD_get_local(&dgbl->public_buffer);
+    CRYPTO_THREAD_set_local(&dgbl->public_buffer, NULL);
+    rand_buffer_free(buffer);
+#endif
 }
 
 #ifndef FIPS_MODULE
@@ -869,8 +970,13 @@ int RAND_set0_public(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand)
     if (dgbl == NULL)
         return 0;
     old = CRYPTO_THREAD_get_local(&dgbl->public);
-    if ((r = CRYPTO_THREAD_set_local(&dgbl->public, rand)) > 0)
+    if ((r = CRYPTO_THREAD_set_local(&dgbl->public, rand)) > 0) {
         EVP_RAND_CTX_free(old);
+#ifndef FIPS_MODULE
+        /* Bytes generated by the old DRBG must not be handed out anymore */
+        rand_buffer_discard(CRYPTO_THREAD_get_local(&dgbl->public_buffer));
+#endif
+    }
     return r;
 }
 
@@ -1000,4 +1106,107 @@ int RAND_set_seed_source_type(OSSL_LIB_CTX *ctx, const char *seed,
         && random_set_string(&dgbl->seed_propq, propq);
 }
 
+int RAND_set_public_buffer_size(OSSL_LIB_CTX *ctx, size_t size)
+{
+    RAND_GLOBAL *dgbl = rand_get_global(ctx);
+
+    if (dgbl == NULL)
+        return 0;
+    if (size > RAND_BUFFER_MAX_SIZE) {
+        ERR_raise(ERR_LIB_RAND, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+    tsan_store(&dgbl->public_buffer_size, size);
+    /* Have the buffers of all threads replaced by ones of the new size */
+    tsan_counter(&rand_buffer_generation);
+    return 1;
+}
+
+size_t RAND_get_public_buffer_size(OSSL_LIB_CTX *ctx)
+{
+    RAND_GLOBAL *dgbl = rand_get_global(ctx);
+
+    return dgbl == NULL ? 0 : tsan_load(&dgbl->public_buffer_size);
+}
+
+/*
+ * Copies |num| bytes to |out| from the buffer of the calling thread if it
+ * holds enough bytes which are still usable, without any locking. The bytes
+ * handed out are erased from the buffer, so that they cannot be recovered
+ * later any more than the output of the DRBG itself could.
+ */
+static int rand_buffer_get(OSSL_LIB_CTX *ctx, unsigned char *out, size_t num,
+                           unsigned int strength, int generation)
+{
+    RAND_GLOBAL *dgbl = rand_get_global(ctx);
+    RAND_BUFFER *buffer;
+
+    if (dgbl == NULL
+        || num > tsan_load(&dgbl->public_buffer_size)
+                 / RAND_BUFFER_MAX_REQUEST_DIV
+        || (buffer = CRYPTO_THREAD_get_local(&dgbl->public_buffer)) == NULL
+        || num > buffer->size - buffer->pos)
+        return 0;
+
+    if (buffer->generation != generation
+        || buffer->fork_id != openssl_get_fork_id()) {
+        rand_buffer_discard(buffer);
+        return 0;
+    }
+    if (strength > buffer->strength)
+        return 0;
+
+    memcpy(out, buffer->data + buffer->pos, num);
+    OPENSSL_cleanse(buffer->data + buffer->pos, num);
+    buffer->pos += num;
+    return 1;
+}
+
+/*
+ * Refills the buffer of the calling thread from its <public> DRBG |rand|, if
+ * buffering is enabled and a request of |num| bytes is small enough to be
+ * served from it.
+ */
+static int rand_buffer_refill(OSSL_LIB_CTX *ctx, EVP_RAND_CTX *rand,
+                              size_t num, unsigned int strength,
+                              int generation)
+{
+    RAND_GLOBAL *dgbl = rand_get_global(ctx);
+    RAND_BUFFER *buffer;
+    size_t size;
+
+    if (dgbl == NULL
+        || num > (size = tsan_load(&dgbl->public_buffer_size))
+                 / RAND_BUFFER_MAX_REQUEST_DIV)
+        return 0;
+
+    buffer = CRYPTO_THREAD_get_local(&dgbl->public_buffer);
+    if (buffer != NULL && buffer->size != size) {
+        CRYPTO_THREAD_set_local(&dgbl->public_buffer, NULL);
+        rand_buffer_free(buffer);
+        buffer = NULL;
+    }
+    if (buffer == NULL) {
+        if ((buffer = OPENSSL_zalloc(sizeof(*buffer))) == NULL)
+            return 0;
+        if ((buffer->data = OPENSSL_malloc(size)) == NULL
+            || !CRYPTO_THREAD_set_local(&dgbl->public_buffer, buffer)) {
+            OPENSSL_free(buffer->data);
+            OPENSSL_free(buffer);
+            return 0;
+        }
+        buffer->size = buffer->pos = size;
+    }
+
+    rand_buffer_discard(buffer);
+    buffer->strength = EVP_RAND_get_strength(rand);
+    if (strength > buffer->strength
+        || !EVP_RAND_generate(rand, buffer->data, size, 0, 0, NULL, 0))
+        return 0;
+    buffer->pos = 0;
+    buffer->generation = generation;
+    buffer->fork_id = openssl_get_fork_id();
+    return 1;
+}
+
 #endif
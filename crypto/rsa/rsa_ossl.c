@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -31,6 +31,10 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
                                    unsigned char *to, RSA *rsa, int padding);
 static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *i, RSA *rsa,
                            BN_CTX *ctx);
+static int rsa_ossl_mod_exp_int(BIGNUM *r0, const BIGNUM *i, RSA *rsa,
+                                BN_CTX *ctx, int verify);
+static int rsa_ossl_mod_exp_check_n(BIGNUM *const *r0, BIGNUM *const *i,
+                                    size_t count, RSA *rsa, BN_CTX *ctx);
 static int rsa_ossl_init(RSA *rsa);
 static int rsa_ossl_finish(RSA *rsa);
 #ifdef S390X_MOD_EXP
@@ -300,57 +304,75 @@ static int rsa_blinding_invert(BN_BLINDING *b, BIGNUM *f, BIGNUM *unblind,
     return BN_BLINDING_invert_ex(f, unblind, b, ctx);
 }
 
-/* signing */
-static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
-                                   unsigned char *to, RSA *rsa, int padding)
+/*
+ * Signs |count| inputs |from| of lengths |flen| with the private key into
+ * |to|, each of which must have room for RSA_size(rsa) bytes.
+ *
+ * All inputs are blinded before any of them is exponentiated, so that a
+ * shared blinding is locked only once. Each CRT result is normally checked
+ * against its input by applying the public key to it, see
+ * rsa_ossl_mod_exp_check(); for more than one input all results are checked
+ * at once instead, see rsa_ossl_mod_exp_check_n().
+ */
+static int rsa_ossl_private_encrypt_n(RSA *rsa, size_t count,
+                                      const unsigned char *const *from,
+                                      const int *flen,
+                                      unsigned char *const *to, int padding)
 {
-    BIGNUM *f, *ret, *res;
-    int i, num = 0, r = -1;
+    BIGNUM *bnbuf[3], **bns = bnbuf, **f, **ret, **unblind = NULL, *res;
+    int i, num = 0, r = 0, crt, deferred = 0;
+    int local_blinding = 0;
+    size_t k;
     unsigned char *buf = NULL;
     BN_CTX *ctx = NULL;
-    int local_blinding = 0;
-    /*
-     * Used only if the blinding structure is shared. A non-NULL unblind
-     * instructs rsa_blinding_convert() and rsa_blinding_invert() to store
-     * the unblinding factor outside the blinding structure.
-     */
-    BIGNUM *unblind = NULL;
     BN_BLINDING *blinding = NULL;
 
+    if (count > 1) {
+        bns = OPENSSL_malloc(sizeof(*bns) * 3 * count);
+        if (bns == NULL)
+            return 0;
+    }
+    f = bns;
+    ret = bns + count;
+
     if ((ctx = BN_CTX_new_ex(rsa->libctx)) == NULL)
         goto err;
     BN_CTX_start(ctx);
-    f = BN_CTX_get(ctx);
-    ret = BN_CTX_get(ctx);
     num = BN_num_bytes(rsa->n);
     buf = OPENSSL_malloc(num);
-    if (ret == NULL || buf == NULL)
+    if (buf == NULL)
         goto err;
+    for (k = 0; k < count; k++)
+        if ((f[k] = BN_CTX_get(ctx)) == NULL
+            || (ret[k] = BN_CTX_get(ctx)) == NULL)
+            goto err;
 
-    switch (padding) {
-    case RSA_PKCS1_PADDING:
-        i = RSA_padding_add_PKCS1_type_1(buf, num, from, flen);
-        break;
-    case RSA_X931_PADDING:
-        i = RSA_padding_add_X931(buf, num, from, flen);
-        break;
-    case RSA_NO_PADDING:
-        i = RSA_padding_add_none(buf, num, from, flen);
-        break;
-    default:
-        ERR_raise(ERR_LIB_RSA, RSA_R_UNKNOWN_PADDING_TYPE);
-        goto err;
-    }
-    if (i <= 0)
-        goto err;
+    for (k = 0; k < count; k++) {
+        switch (padding) {
+        case RSA_PKCS1_PADDING:
+            i = RSA_padding_add_PKCS1_type_1(buf, num, from[k], flen[k]);
+            break;
+        case RSA_X931_PADDING:
+            i = RSA_padding_add_X931(buf, num, from[k], flen[k]);
+            break;
+        case RSA_NO_PADDING:
+            i = RSA_padding_add_none(buf, num, from[k], flen[k]);
+            break;
+        default:
+            ERR_raise(ERR_LIB_RSA, RSA_R_UNKNOWN_PADDING_TYPE);
+            goto err;
+        }
+        if (i <= 0)
+            goto err;
 
-    if (BN_bin2bn(buf, num, f) == NULL)
-        goto err;
+        if (BN_bin2bn(buf, num, f[k]) == NULL)
+            goto err;
 
-    if (BN_ucmp(f, rsa->n) >= 0) {
-        /* usually the padding functions would catch this */
-        ERR_raise(ERR_LIB_RSA, RSA_R_DATA_TOO_LARGE_FOR_MODULUS);
-        goto err;
+        if (BN_ucmp(f[k], rsa->n) >= 0) {
+            /* usually the padding functions would catch this */
+            ERR_raise(ERR_LIB_RSA, RSA_R_DATA_TOO_LARGE_FOR_MODULUS);
+            goto err;
+        }
     }
 
     if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
@@ -367,70 +389,127 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
     }
 
     if (blinding != NULL) {
-        if (!local_blinding && ((unblind = BN_CTX_get(ctx)) == NULL)) {
-            ERR_raise(ERR_LIB_RSA, ERR_R_BN_LIB);
+        /*
+         * The unblinding factors are kept outside the BN_BLINDING, as a
+         * local one only holds that of the last input.
+         */
+        unblind = bns + 2 * count;
+        for (k = 0; k < count; k++)
+            if ((unblind[k] = BN_CTX_get(ctx)) == NULL) {
+                ERR_raise(ERR_LIB_RSA, ERR_R_BN_LIB);
+                goto err;
+            }
+        if (!local_blinding && !BN_BLINDING_lock(blinding))
             goto err;
-        }
-        if (!rsa_blinding_convert(blinding, f, unblind, ctx))
+        for (k = 0; k < count; k++)
+            if (!BN_BLINDING_convert_ex(f[k], unblind[k], blinding, ctx))
+                break;
+        if (!local_blinding)
+            BN_BLINDING_unlock(blinding);
+        if (k < count)
             goto err;
     }
 
-    if ((rsa->flags & RSA_FLAG_EXT_PKEY) ||
+    crt = (rsa->flags & RSA_FLAG_EXT_PKEY) ||
         (rsa->version == RSA_ASN1_VERSION_MULTI) ||
         ((rsa->p != NULL) &&
          (rsa->q != NULL) &&
-         (rsa->dmp1 != NULL) && (rsa->dmq1 != NULL) && (rsa->iqmp != NULL))) {
-        if (!rsa->meth->rsa_mod_exp(ret, f, rsa, ctx))
-            goto err;
-    } else {
-        BIGNUM *d = BN_new();
-        if (d == NULL) {
-            ERR_raise(ERR_LIB_RSA, ERR_R_BN_LIB);
-            goto err;
-        }
-        if (rsa->d == NULL) {
-            ERR_raise(ERR_LIB_RSA, RSA_R_MISSING_PRIVATE_KEY);
-            BN_free(d);
-            goto err;
-        }
-        BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
+         (rsa->dmp1 != NULL) && (rsa->dmq1 != NULL) && (rsa->iqmp != NULL));
+    if (crt && rsa->meth->rsa_mod_exp == rsa_ossl_mod_exp)
+        deferred = 1;
 
-        if (!rsa->meth->bn_mod_exp(ret, f, d, rsa->n, ctx,
-                                   rsa->_method_mod_n)) {
+    for (k = 0; k < count; k++) {
+        if (deferred) {
+            if (!rsa_ossl_mod_exp_int(ret[k], f[k], rsa, ctx, 0))
+                goto err;
+        } else if (crt) {
+            if (!rsa->meth->rsa_mod_exp(ret[k], f[k], rsa, ctx))
+                goto err;
+        } else {
+            BIGNUM *d = BN_new();
+            if (d == NULL) {
+                ERR_raise(ERR_LIB_RSA, ERR_R_BN_LIB);
+                goto err;
+            }
+            if (rsa->d == NULL) {
+                ERR_raise(ERR_LIB_RSA, RSA_R_MISSING_PRIVATE_KEY);
+                BN_free(d);
+                goto err;
+            }
+            BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
+
+            if (!rsa->meth->bn_mod_exp(ret[k], f[k], d, rsa->n, ctx,
+                                       rsa->_method_mod_n)) {
+                BN_free(d);
+                goto err;
+            }
+            /* We MUST free d before any further use of rsa->d */
             BN_free(d);
-            goto err;
         }
-        /* We MUST free d before any further use of rsa->d */
-        BN_free(d);
     }
 
-    if (blinding)
-        if (!rsa_blinding_invert(blinding, ret, unblind, ctx))
-            goto err;
+    if (deferred && !rsa_ossl_mod_exp_check_n(ret, f, count, rsa, ctx))
+        goto err;
 
-    if (padding == RSA_X931_PADDING) {
-        if (!BN_sub(f, rsa->n, ret))
+    for (k = 0; k < count; k++) {
+        if (blinding)
+            if (!rsa_blinding_invert(blinding, ret[k], unblind[k], ctx))
+                goto err;
+
+        if (padding == RSA_X931_PADDING) {
+            if (!BN_sub(f[k], rsa->n, ret[k]))
+                goto err;
+            if (BN_cmp(ret[k], f[k]) > 0)
+                res = f[k];
+            else
+                res = ret[k];
+        } else {
+            res = ret[k];
+        }
+
+        /*
+         * BN_bn2binpad puts in leading 0 bytes if the number is less than
+         * the length of the modulus.
+         */
+        if (BN_bn2binpad(res, to[k], num) < 0)
             goto err;
-        if (BN_cmp(ret, f) > 0)
-            res = f;
-        else
-            res = ret;
-    } else {
-        res = ret;
     }
-
-    /*
-     * BN_bn2binpad puts in leading 0 bytes if the number is less than
-     * the length of the modulus.
-     */
-    r = BN_bn2binpad(res, to, num);
+    r = 1;
  err:
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
     OPENSSL_clear_free(buf, num);
+    if (bns != bnbuf)
+        OPENSSL_free(bns);
     return r;
 }
 
+/* signing */
+static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
+                                   unsigned char *to, RSA *rsa, int padding)
+{
+    if (!rsa_ossl_private_encrypt_n(rsa, 1, &from, &flen, &to, padding))
+        return -1;
+    return BN_num_bytes(rsa->n);
+}
+
+int ossl_rsa_private_encrypt_batch(RSA *rsa, size_t count,
+                                   const unsigned char *const *from,
+                                   const int *flen,
+                                   unsigned char *const *to, int padding)
+{
+    size_t k;
+
+    if (rsa->meth->rsa_priv_enc == rsa_ossl_private_encrypt)
+        return rsa_ossl_private_encrypt_n(rsa, count, from, flen, to, padding);
+
+    for (k = 0; k < count; k++)
+        if (rsa->meth->rsa_priv_enc(flen[k], from[k], to[k], rsa,
+                                    padding) <= 0)
+            return 0;
+    return 1;
+}
+
 static int derive_kdk(int flen, const unsigned char *from, RSA *rsa,
                       unsigned char *buf, int num, unsigned char *kdk)
 {
@@ -802,9 +881,148 @@ static int rsa_ossl_public_decrypt(int flen, const unsigned char *from,
     return r;
 }
 
+/*
+ * Checks the result |r0| of a CRT private key operation on |I| by applying
+ * the public key to it. A fault during the computation would make them
+ * differ, and the faulty result would leak the factors of the modulus: in
+ * that case |r0| is recomputed without the CRT instead.
+ */
+static int rsa_ossl_mod_exp_check(BIGNUM *r0, const BIGNUM *I, RSA *rsa,
+                                  BN_CTX *ctx)
+{
+    BIGNUM *vrfy;
+    int ret = 0;
+
+    if (rsa->e == NULL || rsa->n == NULL)
+        return 1;
+
+    BN_CTX_start(ctx);
+    if ((vrfy = BN_CTX_get(ctx)) == NULL)
+        goto err;
+
+    if (rsa->meth->bn_mod_exp == BN_mod_exp_mont) {
+        if (!BN_mod_exp_mont(vrfy, r0, rsa->e, rsa->n, ctx,
+                             rsa->_method_mod_n))
+            goto err;
+    } else {
+        bn_correct_top(r0);
+        if (!rsa->meth->bn_mod_exp(vrfy, r0, rsa->e, rsa->n, ctx,
+                                   rsa->_method_mod_n))
+            goto err;
+    }
+    /*
+     * If 'I' was greater than (or equal to) rsa->n, the operation will
+     * be equivalent to using 'I mod n'. However, the result of the
+     * verify will *always* be less than 'n' so we don't check for
+     * absolute equality, just congruency.
+     */
+    if (!BN_sub(vrfy, vrfy, I))
+        goto err;
+    if (BN_is_zero(vrfy)) {
+        ret = 1;
+        goto err;   /* not actually error */
+    }
+    if (!BN_mod(vrfy, vrfy, rsa->n, ctx))
+        goto err;
+    if (BN_is_negative(vrfy))
+        if (!BN_add(vrfy, vrfy, rsa->n))
+            goto err;
+    if (!BN_is_zero(vrfy)) {
+        /*
+         * 'I' and 'vrfy' aren't congruent mod n. Don't leak
+         * miscalculated CRT output, just do a raw (slower) mod_exp and
+         * return that instead.
+         */
+
+        BIGNUM *d = BN_new();
+        if (d == NULL)
+            goto err;
+        BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
+
+        if (!rsa->meth->bn_mod_exp(r0, I, d, rsa->n, ctx,
+                                   rsa->_method_mod_n)) {
+            BN_free(d);
+            goto err;
+        }
+        /* We MUST free d before any further use of rsa->d */
+        BN_free(d);
+        bn_correct_top(r0);
+    }
+    ret = 1;
+ err:
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+/*
+ * Checks the results |r0| of |count| CRT private key operations on |I| as
+ * rsa_ossl_mod_exp_check() does. The public key operation is multiplicative,
+ * so the product of the results is checked against the product of the
+ * inputs with a single exponentiation. Only if that fails are the results
+ * checked, and recomputed where necessary, one by one.
+ */
+static int rsa_ossl_mod_exp_check_n(BIGNUM *const *r0, BIGNUM *const *I,
+                                    size_t count, RSA *rsa, BN_CTX *ctx)
+{
+    BN_MONT_CTX *mont = rsa->_method_mod_n;
+    BIGNUM *pr, *pi, *t;
+    size_t k;
+    int match;
+
+    if (rsa->e == NULL || rsa->n == NULL)
+        return 1;
+
+    if (count > 1 && mont != NULL) {
+        BN_CTX_start(ctx);
+        pr = BN_CTX_get(ctx);
+        pi = BN_CTX_get(ctx);
+        t = BN_CTX_get(ctx);
+        if (t == NULL
+            || !BN_to_montgomery(pr, r0[0], mont, ctx)
+            || !BN_to_montgomery(pi, I[0], mont, ctx)) {
+            BN_CTX_end(ctx);
+            return 0;
+        }
+        for (k = 1; k < count; k++)
+            if (!BN_to_montgomery(t, r0[k], mont, ctx)
+                || !BN_mod_mul_montgomery(pr, pr, t, mont, ctx)
+                || !BN_to_montgomery(t, I[k], mont, ctx)
+                || !BN_mod_mul_montgomery(pi, pi, t, mont, ctx)) {
+                BN_CTX_end(ctx);
+                return 0;
+            }
+        if (!BN_from_montgomery(pr, pr, mont, ctx)
+            || !BN_from_montgomery(pi, pi, mont, ctx)
+            || !rsa->meth->bn_mod_exp(pr, pr, rsa->e, rsa->n, ctx, mont)) {
+            BN_CTX_end(ctx);
+            return 0;
+        }
+        match = BN_cmp(pr, pi) == 0;
+        BN_CTX_end(ctx);
+        if (match)
+            return 1;
+    }
+
+    for (k = 0; k < count; k++)
+        if (!rsa_ossl_mod_exp_check(r0[k], I[k], rsa, ctx))
+            return 0;
+    return 1;
+}
+
 static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 {
-    BIGNUM *r1, *m1, *vrfy;
+    return rsa_ossl_mod_exp_int(r0, I, rsa, ctx, 1);
+}
+
+/*
+ * The CRT private key operation. Unless |verify| is set, the result is not
+ * checked and the caller must do so with rsa_ossl_mod_exp_check() or
+ * rsa_ossl_mod_exp_check_n().
+ */
+static int rsa_ossl_mod_exp_int(BIGNUM *r0, const BIGNUM *I, RSA *rsa,
+                                BN_CTX *ctx, int verify)
+{
+    BIGNUM *r1, *m1;
     int ret = 0, smooth = 0;
 #ifndef FIPS_MODULE
     BIGNUM *r2, *m[RSA_MAX_PRIME_NUM - 2];
@@ -819,8 +1037,7 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
     r2 = BN_CTX_get(ctx);
 #endif
     m1 = BN_CTX_get(ctx);
-    vrfy = BN_CTX_get(ctx);
-    if (vrfy == NULL)
+    if (m1 == NULL)
         goto err;
 
 #ifndef FIPS_MODULE
@@ -1108,56 +1325,8 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 #endif
 
  tail:
-    if (rsa->e && rsa->n) {
-        if (rsa->meth->bn_mod_exp == BN_mod_exp_mont) {
-            if (!BN_mod_exp_mont(vrfy, r0, rsa->e, rsa->n, ctx,
-                                 rsa->_method_mod_n))
-                goto err;
-        } else {
-            bn_correct_top(r0);
-            if (!rsa->meth->bn_mod_exp(vrfy, r0, rsa->e, rsa->n, ctx,
-                                       rsa->_method_mod_n))
-                goto err;
-        }
-        /*
-         * If 'I' was greater than (or equal to) rsa->n, the operation will
-         * be equivalent to using 'I mod n'. However, the result of the
-         * verify will *always* be less than 'n' so we don't check for
-         * absolute equality, just congruency.
-         */
-        if (!BN_sub(vrfy, vrfy, I))
-            goto err;
-        if (BN_is_zero(vrfy)) {
-            bn_correct_top(r0);
-            ret = 1;
-            goto err;   /* not actually error */
-        }
-        if (!BN_mod(vrfy, vrfy, rsa->n, ctx))
-            goto err;
-        if (BN_is_negative(vrfy))
-            if (!BN_add(vrfy, vrfy, rsa->n))
-                goto err;
-        if (!BN_is_zero(vrfy)) {
-            /*
-             * 'I' and 'vrfy' aren't congruent mod n. Don't leak
-             * miscalculated CRT output, just do a raw (slower) mod_exp and
-             * return that instead.
-             */
-
-            BIGNUM *d = BN_new();
-            if (d == NULL)
-                goto err;
-            BN_with_flags(d, rsa->d, BN_FLG_CONSTTIME);
-
-            if (!rsa->meth->bn_mod_exp(r0, I, d, rsa->n, ctx,
-                                       rsa->_method_mod_n)) {
-                BN_free(d);
-                goto err;
-            }
-            /* We MUST free d before any further use of rsa->d */
-            BN_free(d);
-        }
-    }
+    if (verify && !rsa_ossl_mod_exp_check(r0, I, rsa, ctx))
+        goto err;
     /*
      * It's unfortunate that we have to bn_correct_top(r0). What hopefully
      * saves the day is that correction is highly unlike, and private key
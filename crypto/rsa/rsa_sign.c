@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -333,6 +333,92 @@ err:
     return ret;
 }
 
+/*
+ * Signs |count| digests |m| of hash |type| as RSA_sign() does, into |sigret|,
+ * each of which must have room for RSA_size(rsa) bytes. The private key
+ * operations are done together, see ossl_rsa_private_encrypt_batch().
+ */
+int ossl_rsa_sign_batch(int type, size_t count,
+                        const unsigned char *const *m, const size_t *m_len,
+                        unsigned char *const *sigret, RSA *rsa)
+{
+    int ret = 0, *flen = NULL;
+    size_t i, rsasize = RSA_size(rsa), di_prefix_len = 0;
+    const unsigned char *di_prefix = NULL;
+    const unsigned char **from = NULL;
+    unsigned char *encoded = NULL;
+
+#ifndef FIPS_MODULE
+    if (rsa->meth->rsa_sign != NULL) {
+        unsigned int siglen;
+
+        for (i = 0; i < count; i++)
+            if (m_len[i] > UINT_MAX
+                || rsa->meth->rsa_sign(type, m[i], (unsigned int)m_len[i],
+                                       sigret[i], &siglen, rsa) <= 0)
+                return 0;
+        return 1;
+    }
+#endif /* FIPS_MODULE */
+
+    if (count == 0)
+        return 1;
+
+    /* See RSA_sign() and encode_pkcs1() */
+    if (type == NID_undef) {
+        ERR_raise(ERR_LIB_RSA, RSA_R_UNKNOWN_ALGORITHM_TYPE);
+        return 0;
+    }
+    if (type != NID_md5_sha1) {
+        di_prefix = ossl_rsa_digestinfo_encoding(type, &di_prefix_len);
+        if (di_prefix == NULL) {
+            ERR_raise(ERR_LIB_RSA,
+                      RSA_R_THE_ASN1_OBJECT_IDENTIFIER_IS_NOT_KNOWN_FOR_THIS_MD);
+            return 0;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        if (type == NID_md5_sha1 && m_len[i] != SSL_SIG_LENGTH) {
+            ERR_raise(ERR_LIB_RSA, RSA_R_INVALID_MESSAGE_LENGTH);
+            return 0;
+        }
+        if (m_len[i] > rsasize
+            || di_prefix_len + m_len[i] + RSA_PKCS1_PADDING_SIZE > rsasize) {
+            ERR_raise(ERR_LIB_RSA, RSA_R_DIGEST_TOO_BIG_FOR_RSA_KEY);
+            return 0;
+        }
+    }
+
+    if (count > SIZE_MAX / rsasize) {
+        ERR_raise(ERR_LIB_RSA, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+    encoded = OPENSSL_malloc(count * rsasize);
+    from = OPENSSL_malloc(count * sizeof(*from));
+    flen = OPENSSL_malloc(count * sizeof(*flen));
+    if (encoded == NULL || from == NULL || flen == NULL)
+        goto err;
+
+    for (i = 0; i < count; i++) {
+        unsigned char *p = encoded + i * rsasize;
+
+        if (di_prefix_len > 0)
+            memcpy(p, di_prefix, di_prefix_len);
+        memcpy(p + di_prefix_len, m[i], m_len[i]);
+        from[i] = p;
+        flen[i] = (int)(di_prefix_len + m_len[i]);
+    }
+
+    ret = ossl_rsa_private_encrypt_batch(rsa, count, from, flen, sigret,
+                                         RSA_PKCS1_PADDING);
+
+ err:
+    OPENSSL_clear_free(encoded, count * rsasize);
+    OPENSSL_free(from);
+    OPENSSL_free(flen);
+    return ret;
+}
+
 /*
  * Verify an RSA signature in |sigbuf| using |rsa|.
  * |type| is the NID of the digest algorithm to use.
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -25,23 +25,63 @@
 
 #ifndef OPENSSL_NO_POSIX_IO
 # include <sys/stat.h>
+# ifdef _WIN32
+#  define stat _stat
+# endif
 #endif
 
 #include <openssl/x509.h>
+#include "crypto/ctype.h"
 #include "crypto/x509.h"
+#include "internal/o_dir.h"
+#include "internal/thread.h"
 #include "x509_local.h"
 
+/* Preloaded directories are checked for changes at most this often */
+#define BY_DIR_CHECK_INTERVAL   1
+/* Upper limit on the number of threads used to preload a directory */
+#define BY_DIR_MAX_THREADS      32
+
+#if !defined(OPENSSL_THREADS) \
+    || (defined(OPENSSL_NO_DEFAULT_THREAD_POOL) && defined(OPENSSL_NO_THREAD_POOL))
+# define BY_DIR_NO_THREADS
+#endif
+
 struct lookup_dir_hashes_st {
     unsigned long hash;
     int suffix;
 };
 
+struct lookup_dir_file_st {
+    char *name;
+    time_t mtime;
+};
+
 struct lookup_dir_entry_st {
     char *dir;
     int dir_type;
     STACK_OF(BY_DIR_HASH) *hashes;
+    /*
+     * The files of a preloaded directory which have been loaded, sorted by
+     * name, or NULL if the directory has not been preloaded. Once it has been
+     * preloaded, a directory is only read again when its modification time
+     * changes, and then only new and changed files are loaded.
+     */
+    STACK_OF(BY_DIR_FILE) *files;
+    time_t mtime;               /* Of the directory when it was last read */
+    time_t checked;             /* When |mtime| was last compared */
 };
 
+/* The share of the files of a directory which one thread preloads */
+typedef struct lookup_dir_load_st {
+    X509_LOOKUP *xl;
+    const BY_DIR_ENTRY *ent;
+    STACK_OF(BY_DIR_FILE) *files;
+    int first, step;
+    OSSL_LIB_CTX *libctx;
+    const char *propq;
+} BY_DIR_LOAD;
+
 typedef struct lookup_dir_st {
     BUF_MEM *buffer;
     STACK_OF(BY_DIR_ENTRY) *dirs;
@@ -50,10 +90,14 @@ typedef struct lookup_dir_st {
 
 static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
                     char **retp);
+static int dir_ctrl_ex(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
+                       char **retp, OSSL_LIB_CTX *libctx, const char *propq);
 
 static int new_dir(X509_LOOKUP *lu);
 static void free_dir(X509_LOOKUP *lu);
 static int add_cert_dir(BY_DIR *ctx, const char *dir, int type);
+static int preload_cert_dirs(X509_LOOKUP *xl, OSSL_LIB_CTX *libctx,
+                             const char *propq);
 static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                                const X509_NAME *name, X509_OBJECT *ret);
 static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
@@ -71,7 +115,7 @@ static X509_LOOKUP_METHOD x509_dir_lookup = {
     NULL,                            /* get_by_fingerprint */
     NULL,                            /* get_by_alias */
     get_cert_by_subject_ex,          /* get_by_subject_ex */
-    NULL,                            /* ctrl_ex */
+    dir_ctrl_ex,                     /* ctrl_ex */
 };
 
 X509_LOOKUP_METHOD *X509_LOOKUP_hash_dir(void)
@@ -81,6 +125,12 @@ X509_LOOKUP_METHOD *X509_LOOKUP_hash_dir(void)
 
 static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
                     char **retp)
+{
+    return dir_ctrl_ex(ctx, cmd, argp, argl, retp, NULL, NULL);
+}
+
+static int dir_ctrl_ex(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
+                       char **retp, OSSL_LIB_CTX *libctx, const char *propq)
 {
     int ret = 0;
     BY_DIR *ld = (BY_DIR *)ctx->method_data;
@@ -101,6 +151,9 @@ static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
         } else
             ret = add_cert_dir(ld, argp, (int)argl);
         break;
+    case X509_L_PRELOAD_DIR:
+        ret = preload_cert_dirs(ctx, libctx, propq);
+        break;
     }
     return ret;
 }
@@ -146,10 +199,23 @@ static int by_dir_hash_cmp(const BY_DIR_HASH *const *a,
     return 0;
 }
 
+static void by_dir_file_free(BY_DIR_FILE *file)
+{
+    OPENSSL_free(file->name);
+    OPENSSL_free(file);
+}
+
+static int by_dir_file_cmp(const BY_DIR_FILE *const *a,
+                           const BY_DIR_FILE *const *b)
+{
+    return strcmp((*a)->name, (*b)->name);
+}
+
 static void by_dir_entry_free(BY_DIR_ENTRY *ent)
 {
     OPENSSL_free(ent->dir);
     sk_BY_DIR_HASH_pop_free(ent->hashes, by_dir_hash_free);
+    sk_BY_DIR_FILE_pop_free(ent->files, by_dir_file_free);
     OPENSSL_free(ent);
 }
 
@@ -203,6 +269,8 @@ static int add_cert_dir(BY_DIR *ctx, const char *dir, int type)
             if (ent == NULL)
                 return 0;
             ent->dir_type = type;
+            ent->files = NULL;
+            ent->mtime = ent->checked = 0;
             ent->hashes = sk_BY_DIR_HASH_new(by_dir_hash_cmp);
             ent->dir = OPENSSL_strndup(ss, len);
             if (ent->dir == NULL || ent->hashes == NULL) {
@@ -219,34 +287,334 @@ static int add_cert_dir(BY_DIR *ctx, const char *dir, int type)
     return 1;
 }
 
+/* Sets |b| to the path of the file |name| in the directory of |ent| */
+static int by_dir_path(BUF_MEM *b, const BY_DIR_ENTRY *ent, const char *name)
+{
+    char c = '/';
+
+    if (!BUF_MEM_grow(b, strlen(ent->dir) + 1 + strlen(name) + 1)) {
+        ERR_raise(ERR_LIB_X509, ERR_R_BUF_LIB);
+        return 0;
+    }
+
+#ifdef OPENSSL_SYS_VMS
+    c = ent->dir[strlen(ent->dir) - 1];
+    if (c != ':' && c != '>' && c != ']') {
+        /*
+         * If no separator is present, we assume the directory
+         * specifier is a logical name, and add a colon.  We really
+         * should use better VMS routines for merging things like
+         * this, but this will do for now... -- Richard Levitte
+         */
+        c = ':';
+    } else {
+        c = '\0';
+    }
+
+    if (c == '\0') {
+        /*
+         * This is special.  When c == '\0', no directory separator
+         * should be added.
+         */
+        BIO_snprintf(b->data, b->max, "%s%s", ent->dir, name);
+        return 1;
+    }
+#endif
+    BIO_snprintf(b->data, b->max, "%s%c%s", ent->dir, c, name);
+    return 1;
+}
+
+#ifndef OPENSSL_NO_POSIX_IO
+
+/*
+ * Checks whether |name| has the form of the names of the files which
+ * get_cert_by_subject_ex() looks for, and if so whether it holds CRLs.
+ */
+static int by_dir_hashed_name(const char *name, int *crl)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        if (!ossl_isdigit(name[i]) && (name[i] < 'a' || name[i] > 'f'))
+            return 0;
+    if (name[i++] != '.')
+        return 0;
+    if ((*crl = name[i] == 'r'))
+        i++;
+    if (!ossl_isdigit(name[i]))
+        return 0;
+    while (ossl_isdigit(name[i]))
+        i++;
+    return name[i] == '\0';
+}
+
+static int by_dir_load_file(X509_LOOKUP *xl, const BY_DIR_ENTRY *ent,
+                            BUF_MEM *b, const BY_DIR_FILE *file,
+                            OSSL_LIB_CTX *libctx, const char *propq)
+{
+    int crl;
+
+    if (!by_dir_hashed_name(file->name, &crl)
+        || !by_dir_path(b, ent, file->name))
+        return 0;
+    if (crl)
+        return X509_load_crl_file(xl, b->data, ent->dir_type);
+    return X509_load_cert_file_ex(xl, b->data, ent->dir_type, libctx, propq);
+}
+
+static CRYPTO_THREAD_RETVAL by_dir_load_thread(void *arg)
+{
+    BY_DIR_LOAD *ld = arg;
+    BUF_MEM *b = BUF_MEM_new();
+    int i;
+
+    if (b == NULL)
+        return 0;
+    /*
+     * Malformed files are skipped, as they are on lookup, without disturbing
+     * the errors the calling thread had queued already
+     */
+    ERR_set_mark();
+    for (i = ld->first; i < sk_BY_DIR_FILE_num(ld->files); i += ld->step)
+        by_dir_load_file(ld->xl, ld->ent, b, sk_BY_DIR_FILE_value(ld->files, i),
+                         ld->libctx, ld->propq);
+    ERR_pop_to_mark();
+    BUF_MEM_free(b);
+    return 1;
+}
+
+/*
+ * Loads |files| of the directory of |ent|, sharing the work with as many
+ * threads of the thread pool of |libctx| as are available.
+ */
+static void by_dir_load_files(X509_LOOKUP *xl, const BY_DIR_ENTRY *ent,
+                              STACK_OF(BY_DIR_FILE) *files,
+                              OSSL_LIB_CTX *libctx, const char *propq)
+{
+    BY_DIR_LOAD ld[BY_DIR_MAX_THREADS];
+    int i, n = 1;
+# ifndef BY_DIR_NO_THREADS
+    void *threads[BY_DIR_MAX_THREADS];
+    uint64_t avail = ossl_get_avail_threads(libctx);
+
+    /* The calling thread does its share too */
+    n = avail < BY_DIR_MAX_THREADS ? (int)avail + 1 : BY_DIR_MAX_THREADS;
+# endif
+    if (n > sk_BY_DIR_FILE_num(files))
+        n = sk_BY_DIR_FILE_num(files);
+
+    for (i = 0; i < n; i++) {
+        ld[i].xl = xl;
+        ld[i].ent = ent;
+        ld[i].files = files;
+        ld[i].first = i;
+        ld[i].step = n;
+        ld[i].libctx = libctx;
+        ld[i].propq = propq;
+    }
+
+# ifndef BY_DIR_NO_THREADS
+    for (i = 1; i < n; i++)
+        if ((threads[i] = ossl_crypto_thread_start(libctx, by_dir_load_thread,
+                                                   &ld[i])) == NULL)
+            by_dir_load_thread(&ld[i]);
+    if (n > 0)
+        by_dir_load_thread(&ld[0]);
+    for (i = 1; i < n; i++) {
+        if (threads[i] == NULL)
+            continue;
+        ossl_crypto_thread_join(threads[i], NULL);
+        ossl_crypto_thread_clean(threads[i]);
+    }
+# else
+    if (n > 0)
+        by_dir_load_thread(&ld[0]);
+# endif
+}
+
+/*
+ * Reads the names and modification times of the files of the directory of
+ * |ent| with names as looked for by get_cert_by_subject_ex(), sorted by name.
+ * A missing directory has no files.
+ */
+static STACK_OF(BY_DIR_FILE) *by_dir_read(const BY_DIR_ENTRY *ent, BUF_MEM *b)
+{
+    STACK_OF(BY_DIR_FILE) *files = sk_BY_DIR_FILE_new(by_dir_file_cmp);
+    OPENSSL_DIR_CTX *d = NULL;
+    BY_DIR_FILE *file;
+    const char *name;
+    struct stat st;
+    int crl;
+
+    if (files == NULL)
+        return NULL;
+    while ((name = OPENSSL_DIR_read(&d, ent->dir)) != NULL) {
+        if (!by_dir_hashed_name(name, &crl))
+            continue;
+        if (!by_dir_path(b, ent, name))
+            goto err;
+        if (stat(b->data, &st) < 0)
+            continue;
+        if ((file = OPENSSL_malloc(sizeof(*file))) == NULL)
+            goto err;
+        file->mtime = st.st_mtime;
+        if ((file->name = OPENSSL_strdup(name)) == NULL
+            || !sk_BY_DIR_FILE_push(files, file)) {
+            by_dir_file_free(file);
+            goto err;
+        }
+    }
+    if (d != NULL)
+        OPENSSL_DIR_end(&d);
+    sk_BY_DIR_FILE_sort(files);
+    return files;
+
+ err:
+    if (d != NULL)
+        OPENSSL_DIR_end(&d);
+    sk_BY_DIR_FILE_pop_free(files, by_dir_file_free);
+    return NULL;
+}
+
+/*
+ * Reads the directory of |ent| and loads the files which are not in
+ * |ent->files| yet, or which have changed since. Must be called with the
+ * write lock held. Returns the number of files loaded, or -1 on error.
+ */
+static int by_dir_reload(X509_LOOKUP *xl, BY_DIR_ENTRY *ent, time_t now,
+                         OSSL_LIB_CTX *libctx, const char *propq)
+{
+    STACK_OF(BY_DIR_FILE) *files, *load = NULL;
+    BY_DIR_FILE *file, *old;
+    BUF_MEM *b = BUF_MEM_new();
+    struct stat st;
+    time_t mtime = 0;
+    int i, idx, ret = -1;
+
+    if (b == NULL)
+        return -1;
+    /* The time is taken first so that changes made while reading are seen */
+    if (stat(ent->dir, &st) == 0)
+        mtime = st.st_mtime;
+    if ((files = by_dir_read(ent, b)) == NULL
+        || (load = sk_BY_DIR_FILE_new_null()) == NULL)
+        goto end;
+
+    for (i = 0; i < sk_BY_DIR_FILE_num(files); i++) {
+        file = sk_BY_DIR_FILE_value(files, i);
+        idx = ent->files == NULL ? -1 : sk_BY_DIR_FILE_find(ent->files, file);
+        old = sk_BY_DIR_FILE_value(ent->files, idx);
+        if ((old == NULL || old->mtime != file->mtime)
+            && !sk_BY_DIR_FILE_push(load, file))
+            goto end;
+    }
+    by_dir_load_files(xl, ent, load, libctx, propq);
+
+    sk_BY_DIR_FILE_pop_free(ent->files, by_dir_file_free);
+    ent->files = files;
+    files = NULL;
+    /*
+     * Modification times have a resolution of a second at best, so changes
+     * made within the second the directory was read in might not show.
+     */
+    ent->mtime = mtime < now ? mtime : (time_t)-1;
+    ent->checked = now;
+    ret = sk_BY_DIR_FILE_num(load);
+
+ end:
+    sk_BY_DIR_FILE_free(load);
+    sk_BY_DIR_FILE_pop_free(files, by_dir_file_free);
+    BUF_MEM_free(b);
+    return ret;
+}
+
+static int preload_cert_dirs(X509_LOOKUP *xl, OSSL_LIB_CTX *libctx,
+                             const char *propq)
+{
+    BY_DIR *ctx = (BY_DIR *)xl->method_data;
+    time_t now = time(NULL);
+    int i, ret = 1;
+
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        return 0;
+    for (i = 0; ret && i < sk_BY_DIR_ENTRY_num(ctx->dirs); i++)
+        ret = by_dir_reload(xl, sk_BY_DIR_ENTRY_value(ctx->dirs, i), now,
+                            libctx, propq) >= 0;
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return ret;
+}
+
+/*
+ * If the directory of |ent| has been preloaded, loads what has changed in it
+ * if it is time to check. Returns 0 if the directory has not been preloaded,
+ * otherwise 1 plus the number of files loaded, or -1 on error.
+ */
+static int by_dir_revalidate(X509_LOOKUP *xl, BY_DIR *ctx, BY_DIR_ENTRY *ent,
+                             OSSL_LIB_CTX *libctx, const char *propq)
+{
+    time_t now = time(NULL);
+    struct stat st;
+    int ret;
+
+    if (!CRYPTO_THREAD_read_lock(ctx->lock))
+        return -1;
+    ret = ent->files == NULL ? 0
+        : now - ent->checked < BY_DIR_CHECK_INTERVAL ? 1 : -1;
+    CRYPTO_THREAD_unlock(ctx->lock);
+    if (ret >= 0)
+        return ret;
+
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        return -1;
+    /* Another thread may have got here first */
+    if (now - ent->checked < BY_DIR_CHECK_INTERVAL) {
+        ret = 1;
+    } else if (stat(ent->dir, &st) == 0 ? st.st_mtime == ent->mtime
+                                         : ent->mtime == 0) {
+        ent->checked = now;
+        ret = 1;
+    } else if ((ret = by_dir_reload(xl, ent, now, libctx, propq)) >= 0) {
+        ret++;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return ret;
+}
+
+#else
+
+static int preload_cert_dirs(X509_LOOKUP *xl, OSSL_LIB_CTX *libctx,
+                             const char *propq)
+{
+    ERR_raise(ERR_LIB_X509, ERR_R_UNSUPPORTED);
+    return 0;
+}
+
+static int by_dir_revalidate(X509_LOOKUP *xl, BY_DIR *ctx, BY_DIR_ENTRY *ent,
+                             OSSL_LIB_CTX *libctx, const char *propq)
+{
+    return 0;
+}
+
+#endif
+
 static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                                   const X509_NAME *name, X509_OBJECT *ret,
                                   OSSL_LIB_CTX *libctx, const char *propq)
 {
     BY_DIR *ctx;
-    union {
-        X509 st_x509;
-        X509_CRL crl;
-    } data;
     int ok = 0;
-    int i, j, k;
+    int i, k, preloaded;
     unsigned long h;
     BUF_MEM *b = NULL;
-    X509_OBJECT stmp, *tmp;
+    X509_OBJECT found, *tmp;
     const char *postfix = "";
 
     if (name == NULL)
         return 0;
 
-    stmp.type = type;
-    if (type == X509_LU_X509) {
-        data.st_x509.cert_info.subject = (X509_NAME *)name; /* won't modify it */
-        stmp.data.x509 = &data.st_x509;
-    } else if (type == X509_LU_CRL) {
-        data.crl.crl.issuer = (X509_NAME *)name; /* won't modify it */
-        stmp.data.crl = &data.crl;
+    if (type == X509_LU_CRL) {
         postfix = "r";
-    } else {
+    } else if (type != X509_LU_X509) {
         ERR_raise(ERR_LIB_X509, X509_R_WRONG_LOOKUP_TYPE);
         goto finish;
     }
@@ -266,12 +634,17 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         BY_DIR_HASH htmp, *hent;
 
         ent = sk_BY_DIR_ENTRY_value(ctx->dirs, i);
-        j = strlen(ent->dir) + 1 + 8 + 6 + 1 + 1;
-        if (!BUF_MEM_grow(b, j)) {
-            ERR_raise(ERR_LIB_X509, ERR_R_BUF_LIB);
+
+        /*
+         * All files of a preloaded directory are in the store already, unless
+         * it has changed since.
+         */
+        if ((preloaded = by_dir_revalidate(xl, ctx, ent, libctx, propq)) < 0)
             goto finish;
-        }
-        if (type == X509_LU_CRL && ent->hashes) {
+        if (preloaded) {
+            k = preloaded - 1;
+            hent = NULL;
+        } else if (type == X509_LU_CRL && ent->hashes) {
             htmp.hash = h;
             if (!CRYPTO_THREAD_read_lock(ctx->lock))
                 goto finish;
@@ -288,40 +661,13 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
             k = 0;
             hent = NULL;
         }
-        for (;;) {
-            char c = '/';
-
-#ifdef OPENSSL_SYS_VMS
-            c = ent->dir[strlen(ent->dir) - 1];
-            if (c != ':' && c != '>' && c != ']') {
-                /*
-                 * If no separator is present, we assume the directory
-                 * specifier is a logical name, and add a colon.  We really
-                 * should use better VMS routines for merging things like
-                 * this, but this will do for now... -- Richard Levitte
-                 */
-                c = ':';
-            } else {
-                c = '\0';
-            }
+        while (!preloaded) {
+            char fname[32];
 
-            if (c == '\0') {
-                /*
-                 * This is special.  When c == '\0', no directory separator
-                 * should be added.
-                 */
-                BIO_snprintf(b->data, b->max,
-                             "%s%08lx.%s%d", ent->dir, h, postfix, k);
-            } else
-#endif
-            {
-                BIO_snprintf(b->data, b->max,
-                             "%s%c%08lx.%s%d", ent->dir, c, h, postfix, k);
-            }
+            BIO_snprintf(fname, sizeof(fname), "%08lx.%s%d", h, postfix, k);
+            if (!by_dir_path(b, ent, fname))
+                goto finish;
 #ifndef OPENSSL_NO_POSIX_IO
-# ifdef _WIN32
-#  define stat _stat
-# endif
             {
                 struct stat st;
                 if (stat(b->data, &st) < 0)
@@ -342,27 +688,22 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         }
 
         /*
-         * we have added it to the cache so now pull it out again
-         *
-         * Note: quadratic time find here since the objects won't generally be
-         *       sorted and sorting the would result in O(n^2 log n) complexity.
+         * we have added it to the cache so now pull it out again, through the
+         * index of the store rather than by sorting its objects
          */
-        if (k > 0) {
-            if (!X509_STORE_lock(xl->store_ctx))
-                goto finish;
-            j = sk_X509_OBJECT_find(xl->store_ctx->objs, &stmp);
-            tmp = sk_X509_OBJECT_value(xl->store_ctx->objs, j);
-            X509_STORE_unlock(xl->store_ctx);
-        } else {
+        if (k > 0
+            && ossl_x509_store_get0_by_subject(xl->store_ctx, type, name,
+                                               &found) > 0)
+            tmp = &found;
+        else
             tmp = NULL;
-        }
         /*
          * If a CRL, update the last file suffix added for this.
          * We don't need to add an entry if k is 0 as this is the initial value.
          * This avoids the need for a write lock and sort operation in the
          * simple case where no CRL is present for a hash.
          */
-        if (type == X509_LU_CRL && k > 0) {
+        if (type == X509_LU_CRL && k > 0 && !preloaded) {
             if (!CRYPTO_THREAD_write_lock(ctx->lock))
                 goto finish;
             /*
@@ -419,14 +760,6 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         }
     }
  finish:
-    /* If we changed anything, resort the objects for faster lookup */
-    if (X509_STORE_lock(xl->store_ctx)) {
-        if (!sk_X509_OBJECT_is_sorted(xl->store_ctx->objs)) {
-            sk_X509_OBJECT_sort(xl->store_ctx->objs);
-        }
-        X509_STORE_unlock(xl->store_ctx);
-    }
-
     BUF_MEM_free(b);
     return ok;
 }
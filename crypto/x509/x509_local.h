@@ -1,5 +1,5 @@
 /*
- * Copyright 2014-2021 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2014-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -8,10 +8,13 @@
  */
 
 #include "internal/refcount.h"
+#include "internal/hashtable.h"
 
 #define X509V3_conf_add_error_name_value(val) \
     ERR_add_error_data(4, "name=", (val)->name, ", value=", (val)->value)
 
+typedef struct x509_chain_cache_st X509_CHAIN_CACHE;
+
 /*
  * This structure holds all parameters associated with a verify operation by
  * including an X509_VERIFY_PARAM structure in related structures the
@@ -115,6 +118,25 @@ struct x509_store_st {
     /* The following is a cache of trusted certs */
     int cache;                  /* if true, stash any hits */
     STACK_OF(X509_OBJECT) *objs; /* Cache of all objects */
+    /*
+     * Index of |objs| by type and subject name (issuer name for CRLs), which
+     * is looked up under its RCU read lock only. Modified with |lock| held.
+     */
+    HT *objs_ht;
+    /* The number of entries of |objs| that |objs_ht| is known to cover */
+    int objs_indexed;
+    /*
+     * Set once |objs| has been handed out by X509_STORE_get0_objects(), read
+     * atomically. From then on lookups check that |objs_ht| is up to date.
+     */
+    uint64_t objs_exposed;
+    /*
+     * Cache of verified chains, NULL unless it was ever enabled.  Set once
+     * under |lock| and kept until the store is freed, read atomically.
+     */
+    X509_CHAIN_CACHE *chain_cache;
+    /* Incremented when objects are added, which invalidates |chain_cache| */
+    uint64_t generation;
     /* These are external lookup methods */
     STACK_OF(X509_LOOKUP) *get_cert_methods;
     X509_VERIFY_PARAM *param;
@@ -150,10 +172,23 @@ struct x509_store_st {
 
 typedef struct lookup_dir_hashes_st BY_DIR_HASH;
 typedef struct lookup_dir_entry_st BY_DIR_ENTRY;
+typedef struct lookup_dir_file_st BY_DIR_FILE;
 DEFINE_STACK_OF(BY_DIR_HASH)
 DEFINE_STACK_OF(BY_DIR_ENTRY)
+DEFINE_STACK_OF(BY_DIR_FILE)
 typedef STACK_OF(X509_NAME_ENTRY) STACK_OF_X509_NAME_ENTRY;
 DEFINE_STACK_OF(STACK_OF_X509_NAME_ENTRY)
 
 int ossl_x509_likely_issued(X509 *issuer, X509 *subject);
+
+int ossl_x509_store_get0_by_subject(X509_STORE *store, X509_LOOKUP_TYPE type,
+                                    const X509_NAME *name, X509_OBJECT *ret);
+
+X509_CHAIN_CACHE *ossl_x509_chain_cache_new(size_t max);
+void ossl_x509_chain_cache_free(X509_CHAIN_CACHE *cache);
+X509_CHAIN_CACHE *ossl_x509_chain_cache_get0(X509_STORE *xs);
+int ossl_x509_chain_cache_get1(X509_CHAIN_CACHE *cache, X509_STORE_CTX *ctx,
+                               uint64_t *generation);
+void ossl_x509_chain_cache_add(X509_CHAIN_CACHE *cache, X509_STORE_CTX *ctx,
+                               uint64_t generation);
 int ossl_x509_signing_allowed(const X509 *issuer, const X509 *subject);
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -179,8 +179,347 @@ static int x509_object_cmp(const X509_OBJECT *const *a,
     return ret;
 }
 
+/*
+ * The objects of a store are indexed in a hash table by their type and by a
+ * hash of their subject name, or issuer name for CRLs. Each entry of the
+ * table holds all objects with that key, which normally means all objects
+ * with that name. Entries are never modified once they have been published:
+ * adding an object replaces the entry with a new one, so that lookups only
+ * need the RCU read lock of the table and never contend with each other.
+ */
+HT_START_KEY_DEFN(x509_obj_key)
+HT_DEF_KEY_FIELD(name_hash, uint64_t)
+HT_DEF_KEY_FIELD(type, int)
+HT_END_KEY_DEFN(X509_OBJ_KEY)
+
+typedef struct x509_obj_bucket_st {
+    int num;
+    X509_OBJECT *objs;          /* Each holds its own reference */
+} X509_OBJ_BUCKET;
+
+IMPLEMENT_HT_VALUE_TYPE_FNS(X509_OBJ_BUCKET, store, static)
+
+static void x509_object_free_internal(X509_OBJECT *a);
+
+static const X509_NAME *x509_object_get0_name(const X509_OBJECT *obj)
+{
+    switch (obj->type) {
+    case X509_LU_X509:
+        return X509_get_subject_name(obj->data.x509);
+    case X509_LU_CRL:
+        return X509_CRL_get_issuer(obj->data.crl);
+    default:
+        return NULL;
+    }
+}
+
+static int x509_obj_key_init(X509_OBJ_KEY *key, X509_LOOKUP_TYPE type,
+                             const X509_NAME *name)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    int i;
+
+    if (name == NULL)
+        return 0;
+
+    /* Ensure canonical encoding is present and up to date */
+    if ((name->canon_enc == NULL || name->modified)
+        && i2d_X509_NAME((X509_NAME *)name, NULL) < 0)
+        return 0;
+
+    /* FNV-1a over the canonical encoding, as X509_NAME_cmp() compares it */
+    for (i = 0; i < name->canon_enclen; i++) {
+        hash ^= name->canon_enc[i];
+        hash *= 0x00000100000001B3ULL;
+    }
+
+    HT_INIT_KEY(key);
+    HT_SET_KEY_FIELD(key, name_hash, hash);
+    HT_SET_KEY_FIELD(key, type, type);
+    return 1;
+}
+
+static X509_OBJ_BUCKET *x509_obj_bucket_new(int num)
+{
+    X509_OBJ_BUCKET *b = OPENSSL_malloc(sizeof(*b) + num * sizeof(X509_OBJECT));
+
+    if (b == NULL)
+        return NULL;
+    b->num = num;
+    b->objs = (X509_OBJECT *)(b + 1);
+    return b;
+}
+
+static void x509_obj_bucket_ht_free(HT_VALUE *v)
+{
+    X509_OBJ_BUCKET *b = ossl_ht_store_X509_OBJ_BUCKET_from_value(v);
+    int i;
+
+    if (b == NULL)
+        return;
+    for (i = 0; i < b->num; i++)
+        x509_object_free_internal(&b->objs[i]);
+    OPENSSL_free(b);
+}
+
+/*
+ * Returns the index entry which holds the objects of the given type and name,
+ * or NULL if there is none. It can also hold objects with other names which
+ * happen to have the same key. Must be called with the RCU read lock or the
+ * store lock held.
+ */
+static X509_OBJ_BUCKET *x509_store_index_get0(X509_STORE *store,
+                                              X509_LOOKUP_TYPE type,
+                                              const X509_NAME *name)
+{
+    X509_OBJ_KEY key;
+    HT_VALUE *v;
+
+    if (!x509_obj_key_init(&key, type, name))
+        return NULL;
+    return ossl_ht_store_X509_OBJ_BUCKET_get(store->objs_ht, TO_HT_KEY(&key),
+                                             &v);
+}
+
+static int x509_object_has_name(const X509_OBJECT *obj, X509_LOOKUP_TYPE type,
+                                const X509_NAME *name)
+{
+    return obj->type == type
+        && X509_NAME_cmp(x509_object_get0_name(obj), name) == 0;
+}
+
+/*
+ * Adds |obj| to the index of |store|, taking a new reference to it, unless the
+ * same object is indexed already. Must be called with the store lock held.
+ * Returns 1 if the object was added, 0 if it was present already, -1 on error.
+ */
+static int x509_store_index_add(X509_STORE *store, const X509_OBJECT *obj)
+{
+    X509_OBJ_KEY key;
+    X509_OBJ_BUCKET *old, *new = NULL, *replaced = NULL;
+    HT_VALUE *v;
+    int i, num = 0, ret = -1;
+
+    if (!x509_obj_key_init(&key, obj->type, x509_object_get0_name(obj)))
+        return -1;
+
+    ossl_ht_write_lock(store->objs_ht);
+    old = ossl_ht_store_X509_OBJ_BUCKET_get(store->objs_ht, TO_HT_KEY(&key),
+                                            &v);
+    if (old != NULL) {
+        for (i = 0; i < old->num; i++) {
+            if (old->objs[i].type != obj->type)
+                continue;
+            if (obj->type == X509_LU_X509
+                ? X509_cmp(old->objs[i].data.x509, obj->data.x509) == 0
+                : X509_CRL_match(old->objs[i].data.crl, obj->data.crl) == 0) {
+                ret = 0;
+                goto end;
+            }
+        }
+        num = old->num;
+    }
+
+    if ((new = x509_obj_bucket_new(num + 1)) == NULL)
+        goto end;
+    if (num > 0)
+        memcpy(new->objs, old->objs, num * sizeof(*new->objs));
+    new->objs[num] = *obj;
+    if (!X509_OBJECT_up_ref_count(&new->objs[num])) {
+        OPENSSL_free(new);
+        goto end;
+    }
+
+    /* The references held by |old| are transferred to |new| */
+    if (!ossl_ht_store_X509_OBJ_BUCKET_insert(store->objs_ht, TO_HT_KEY(&key),
+                                              new, &replaced)) {
+        x509_object_free_internal(&new->objs[num]);
+        OPENSSL_free(new);
+        goto end;
+    }
+    ret = 1;
+
+ end:
+    /* This waits for readers which may still be using |replaced| */
+    ossl_ht_write_unlock(store->objs_ht);
+    OPENSSL_free(replaced);
+    return ret;
+}
+
+/*
+ * Objects can be pushed onto the stack returned by X509_STORE_get0_objects()
+ * directly, which bypasses the index. Once the stack has been handed out,
+ * lookups compare its size with the number of objects that are known to be
+ * indexed, and add whatever is missing to the index if they differ.
+ * Returns 1 if the index is up to date, 0 on error.
+ */
+static int x509_store_index_sync(X509_STORE *store)
+{
+    uint64_t exposed = 0, generation;
+    int i, n, ret = 1, changed = 0;
+
+    if (!CRYPTO_atomic_load(&store->objs_exposed, &exposed, store->lock)
+        || exposed == 0)
+        return 1;
+
+    if (!x509_store_read_lock(store))
+        return 0;
+    n = sk_X509_OBJECT_num(store->objs);
+    changed = n != store->objs_indexed;
+    X509_STORE_unlock(store);
+    if (!changed)
+        return 1;
+
+    if (!X509_STORE_lock(store))
+        return 0;
+    n = sk_X509_OBJECT_num(store->objs);
+    changed = n != store->objs_indexed;
+    /* Objects which are indexed already are skipped */
+    for (i = 0; changed && i < n; i++) {
+        if (x509_store_index_add(store, sk_X509_OBJECT_value(store->objs,
+                                                             i)) < 0) {
+            ret = 0;
+            break;
+        }
+    }
+    if (ret)
+        store->objs_indexed = n;
+    X509_STORE_unlock(store);
+
+    /* Whatever was added also invalidates the verified chain cache */
+    if (changed)
+        (void)CRYPTO_atomic_add64(&store->generation, 1, &generation,
+                                  store->lock);
+    return ret;
+}
+
+/*
+ * Retrieves the first object of the given type and name in the index of
+ * |store| into |ret|, taking a new reference to it.
+ * Returns 1 if successful, 0 if not found, -1 on error.
+ */
+static int x509_store_index_get1(X509_STORE *store, X509_LOOKUP_TYPE type,
+                                 const X509_NAME *name, X509_OBJECT *ret)
+{
+    X509_OBJ_BUCKET *b;
+    int i, found = 0;
+
+    if (!x509_store_index_sync(store))
+        return -1;
+
+    ossl_ht_read_lock(store->objs_ht);
+    b = x509_store_index_get0(store, type, name);
+    for (i = 0; b != NULL && i < b->num; i++) {
+        if (x509_object_has_name(&b->objs[i], type, name)) {
+            found = X509_OBJECT_up_ref_count(&b->objs[i]) ? 1 : -1;
+            if (found > 0)
+                *ret = b->objs[i];
+            break;
+        }
+    }
+    ossl_ht_read_unlock(store->objs_ht);
+    return found;
+}
+
+/*
+ * Retrieves the first object of the given type and name in |store| into
+ * |ret| without taking a reference, which is safe as a store keeps all of its
+ * objects until it is freed. This is what a lookup method that has just added
+ * objects uses to hand one of them back, without sorting the object stack.
+ * Returns 1 if successful, 0 if not found, -1 on error.
+ */
+int ossl_x509_store_get0_by_subject(X509_STORE *store, X509_LOOKUP_TYPE type,
+                                    const X509_NAME *name, X509_OBJECT *ret)
+{
+    X509_OBJ_BUCKET *b;
+    int i, found = 0;
+
+    if (!x509_store_index_sync(store))
+        return -1;
+
+    ossl_ht_read_lock(store->objs_ht);
+    b = x509_store_index_get0(store, type, name);
+    for (i = 0; b != NULL && i < b->num; i++) {
+        if (x509_object_has_name(&b->objs[i], type, name)) {
+            *ret = b->objs[i];
+            found = 1;
+            break;
+        }
+    }
+    ossl_ht_read_unlock(store->objs_ht);
+    return found;
+}
+
+/* Returns all certs with subject name |name| in the index of |store| */
+static STACK_OF(X509) *x509_store_index_get1_certs(X509_STORE *store,
+                                                   const X509_NAME *name)
+{
+    STACK_OF(X509) *sk = sk_X509_new_null();
+    X509_OBJ_BUCKET *b;
+    int i;
+
+    if (sk == NULL)
+        return NULL;
+    if (!x509_store_index_sync(store)) {
+        sk_X509_free(sk);
+        return NULL;
+    }
+
+    ossl_ht_read_lock(store->objs_ht);
+    b = x509_store_index_get0(store, X509_LU_X509, name);
+    for (i = 0; b != NULL && i < b->num; i++) {
+        if (x509_object_has_name(&b->objs[i], X509_LU_X509, name)
+            && !X509_add_cert(sk, b->objs[i].data.x509, X509_ADD_FLAG_UP_REF)) {
+            ossl_ht_read_unlock(store->objs_ht);
+            OSSL_STACK_OF_X509_free(sk);
+            return NULL;
+        }
+    }
+    ossl_ht_read_unlock(store->objs_ht);
+    return sk;
+}
+
+/* Returns all CRLs with issuer name |name| in the index of |store| */
+static STACK_OF(X509_CRL) *x509_store_index_get1_crls(X509_STORE *store,
+                                                      const X509_NAME *name)
+{
+    STACK_OF(X509_CRL) *sk = sk_X509_CRL_new_null();
+    X509_OBJ_BUCKET *b;
+    X509_CRL *x;
+    int i;
+
+    if (sk == NULL)
+        return NULL;
+    if (!x509_store_index_sync(store)) {
+        sk_X509_CRL_free(sk);
+        return NULL;
+    }
+
+    ossl_ht_read_lock(store->objs_ht);
+    b = x509_store_index_get0(store, X509_LU_CRL, name);
+    for (i = 0; b != NULL && i < b->num; i++) {
+        if (!x509_object_has_name(&b->objs[i], X509_LU_CRL, name))
+            continue;
+        x = b->objs[i].data.crl;
+        if (!X509_CRL_up_ref(x))
+            goto err;
+        if (!sk_X509_CRL_push(sk, x)) {
+            X509_CRL_free(x);
+            goto err;
+        }
+    }
+    ossl_ht_read_unlock(store->objs_ht);
+    return sk;
+
+ err:
+    ossl_ht_read_unlock(store->objs_ht);
+    sk_X509_CRL_pop_free(sk, X509_CRL_free);
+    return NULL;
+}
+
 X509_STORE *X509_STORE_new(void)
 {
+    HT_CONFIG htconf = { NULL, x509_obj_bucket_ht_free, NULL, 0, 1, 0 };
     X509_STORE *ret = OPENSSL_zalloc(sizeof(*ret));
 
     if (ret == NULL)
@@ -189,6 +528,10 @@ X509_STORE *X509_STORE_new(void)
         ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
         goto err;
     }
+    if ((ret->objs_ht = ossl_ht_new(&htconf)) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
     ret->cache = 1;
     if ((ret->get_cert_methods = sk_X509_LOOKUP_new_null()) == NULL) {
         ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
@@ -216,6 +559,7 @@ X509_STORE *X509_STORE_new(void)
 
 err:
     X509_VERIFY_PARAM_free(ret->param);
+    ossl_ht_free(ret->objs_ht);
     sk_X509_OBJECT_free(ret->objs);
     sk_X509_LOOKUP_free(ret->get_cert_methods);
     CRYPTO_THREAD_lock_free(ret->lock);
@@ -244,6 +588,8 @@ void X509_STORE_free(X509_STORE *xs)
         X509_LOOKUP_free(lu);
     }
     sk_X509_LOOKUP_free(sk);
+    ossl_x509_chain_cache_free(xs->chain_cache);
+    ossl_ht_free(xs->objs_ht);
     sk_X509_OBJECT_pop_free(xs->objs, X509_OBJECT_free);
 
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_X509_STORE, xs, &xs->ex_data);
@@ -324,39 +670,30 @@ static int ossl_x509_store_ctx_get_by_subject(const X509_STORE_CTX *ctx,
 {
     X509_STORE *store = ctx->store;
     X509_LOOKUP *lu;
-    X509_OBJECT stmp, *tmp;
-    int i, j;
+    X509_OBJECT stmp, cached, *tmp = NULL;
+    int i, j, found;
 
     if (store == NULL)
         return 0;
 
     stmp.type = X509_LU_NONE;
     stmp.data.ptr = NULL;
+    cached.type = X509_LU_NONE;
+    cached.data.ptr = NULL;
 
-    if (!x509_store_read_lock(store))
-        return 0;
-    /* Should already be sorted...but just in case */
-    if (!sk_X509_OBJECT_is_sorted(store->objs)) {
-        X509_STORE_unlock(store);
-        /* Take a write lock instead of a read lock */
-        if (!X509_STORE_lock(store))
-            return 0;
-        /*
-         * Another thread might have sorted it in the meantime. But if so,
-         * sk_X509_OBJECT_sort() exits early.
-         */
-        sk_X509_OBJECT_sort(store->objs);
-    }
-    tmp = X509_OBJECT_retrieve_by_subject(store->objs, type, name);
-    X509_STORE_unlock(store);
+    found = x509_store_index_get1(store, type, name, &cached);
+    if (found < 0)
+        return -1;
 
-    if (tmp == NULL || type == X509_LU_CRL) {
+    if (found == 0 || type == X509_LU_CRL) {
         for (i = 0; i < sk_X509_LOOKUP_num(store->get_cert_methods); i++) {
             lu = sk_X509_LOOKUP_value(store->get_cert_methods, i);
             if (lu->skip)
                 continue;
-            if (lu->method == NULL)
+            if (lu->method == NULL) {
+                x509_object_free_internal(&cached);
                 return -1;
+            }
             j = X509_LOOKUP_by_subject_ex(lu, type, name, &stmp,
                                           ctx->libctx, ctx->propq);
             if (j != 0) { /* non-zero value is considered success here */
@@ -364,14 +701,18 @@ static int ossl_x509_store_ctx_get_by_subject(const X509_STORE_CTX *ctx,
                 break;
             }
         }
-        if (tmp == NULL)
+        if (tmp == NULL && found == 0)
             return 0;
     }
-    if (!X509_OBJECT_up_ref_count(tmp))
-        return -1;
+    if (tmp != NULL) {
+        x509_object_free_internal(&cached);
+        if (!X509_OBJECT_up_ref_count(tmp))
+            return -1;
+        cached = *tmp;
+    }
 
-    ret->type = tmp->type;
-    ret->data.ptr = tmp->data.ptr;
+    ret->type = cached.type;
+    ret->data.ptr = cached.data.ptr;
     return 1;
 }
 
@@ -386,7 +727,7 @@ int X509_STORE_CTX_get_by_subject(const X509_STORE_CTX *ctx,
 static int x509_store_add(X509_STORE *store, void *x, int crl)
 {
     X509_OBJECT *obj;
-    int ret = 0, added = 0;
+    int ret = 0, added = 0, indexed;
 
     if (x == NULL)
         return 0;
@@ -413,16 +754,30 @@ static int x509_store_add(X509_STORE *store, void *x, int crl)
         return 0;
     }
 
-    if (X509_OBJECT_retrieve_match(store->objs, obj)) {
-        ret = 1;
-    } else {
-        added = sk_X509_OBJECT_push(store->objs, obj);
-        ret = added != 0;
+    /*
+     * The index is used to look for a duplicate, which avoids sorting the
+     * objects after every addition.
+     */
+    if (sk_X509_OBJECT_push(store->objs, obj) != 0) {
+        indexed = x509_store_index_add(store, obj);
+        if (indexed > 0) {
+            store->objs_indexed++;
+            added = 1;
+        } else
+            (void)sk_X509_OBJECT_pop(store->objs);
+        ret = indexed >= 0;
     }
     X509_STORE_unlock(store);
 
-    if (added == 0)             /* obj not pushed */
+    if (added == 0) {           /* obj not pushed */
         X509_OBJECT_free(obj);
+    } else {
+        uint64_t generation;
+
+        /* Not under the store lock, which is the fallback for the atomic */
+        (void)CRYPTO_atomic_add64(&store->generation, 1, &generation,
+                                  store->lock);
+    }
 
     return ret;
 }
@@ -580,6 +935,13 @@ X509_OBJECT *X509_OBJECT_retrieve_by_subject(STACK_OF(X509_OBJECT) *h,
 
 STACK_OF(X509_OBJECT) *X509_STORE_get0_objects(const X509_STORE *xs)
 {
+    X509_STORE *store = (X509_STORE *)xs;
+
+    /*
+     * The caller may change the stack behind the back of the index. It may
+     * also hold the store lock already, so that is not used as the fallback.
+     */
+    (void)CRYPTO_atomic_store(&store->objs_exposed, 1, NULL);
     return xs->objs;
 }
 
@@ -629,7 +991,7 @@ STACK_OF(X509) *X509_STORE_get1_all_certs(X509_STORE *store)
         goto out_free;
 
     sk_X509_OBJECT_sort(store->objs);
-    objs = X509_STORE_get0_objects(store);
+    objs = store->objs;
     for (i = 0; i < sk_X509_OBJECT_num(objs); i++) {
         X509 *cert = X509_OBJECT_get0_X509(sk_X509_OBJECT_value(objs, i));
 
@@ -651,113 +1013,50 @@ STACK_OF(X509) *X509_STORE_get1_all_certs(X509_STORE *store)
 STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
                                           const X509_NAME *nm)
 {
-    int i, idx, cnt;
-    STACK_OF(X509) *sk = NULL;
-    X509 *x;
-    X509_OBJECT *obj;
+    int i;
+    STACK_OF(X509) *sk;
+    X509_OBJECT *xobj;
     X509_STORE *store = ctx->store;
 
     if (store == NULL)
         return sk_X509_new_null();
 
-    if (!X509_STORE_lock(store))
-        return NULL;
+    sk = x509_store_index_get1_certs(store, nm);
+    if (sk == NULL || sk_X509_num(sk) > 0)
+        return sk;
 
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_X509, nm, &cnt);
-    if (idx < 0) {
-        /*
-         * Nothing found in cache: do lookup to possibly add new objects to
-         * cache
-         */
-        X509_OBJECT *xobj = X509_OBJECT_new();
-
-        X509_STORE_unlock(store);
-        if (xobj == NULL)
-            return NULL;
-        i = ossl_x509_store_ctx_get_by_subject(ctx, X509_LU_X509, nm, xobj);
-        if (i <= 0) {
-            X509_OBJECT_free(xobj);
-            return i < 0 ? NULL : sk_X509_new_null();
-        }
-        X509_OBJECT_free(xobj);
-        if (!X509_STORE_lock(store))
-            return NULL;
-        sk_X509_OBJECT_sort(store->objs);
-        idx = x509_object_idx_cnt(store->objs, X509_LU_X509, nm, &cnt);
-        if (idx < 0) {
-            sk = sk_X509_new_null();
-            goto end;
-        }
-    }
+    /* Nothing found in cache: do lookup to possibly add new objects to cache */
+    sk_X509_free(sk);
+    if ((xobj = X509_OBJECT_new()) == NULL)
+        return NULL;
+    i = ossl_x509_store_ctx_get_by_subject(ctx, X509_LU_X509, nm, xobj);
+    X509_OBJECT_free(xobj);
+    if (i <= 0)
+        return i < 0 ? NULL : sk_X509_new_null();
 
-    sk = sk_X509_new_null();
-    if (sk == NULL)
-        goto end;
-    for (i = 0; i < cnt; i++, idx++) {
-        obj = sk_X509_OBJECT_value(store->objs, idx);
-        x = obj->data.x509;
-        if (!X509_add_cert(sk, x, X509_ADD_FLAG_UP_REF)) {
-            X509_STORE_unlock(store);
-            OSSL_STACK_OF_X509_free(sk);
-            return NULL;
-        }
-    }
- end:
-    X509_STORE_unlock(store);
-    return sk;
+    return x509_store_index_get1_certs(store, nm);
 }
 
 /* Returns NULL on internal/fatal error, empty stack if not found */
 STACK_OF(X509_CRL) *X509_STORE_CTX_get1_crls(const X509_STORE_CTX *ctx,
                                              const X509_NAME *nm)
 {
-    int i = 1, idx, cnt;
-    STACK_OF(X509_CRL) *sk = sk_X509_CRL_new_null();
-    X509_CRL *x;
-    X509_OBJECT *obj, *xobj = X509_OBJECT_new();
+    int i;
+    X509_OBJECT *xobj = X509_OBJECT_new();
     X509_STORE *store = ctx->store;
 
     /* Always do lookup to possibly add new CRLs to cache */
-    if (sk == NULL
-        || xobj == NULL
+    if (xobj == NULL
         || (i = ossl_x509_store_ctx_get_by_subject(ctx, X509_LU_CRL,
                                                    nm, xobj)) < 0) {
         X509_OBJECT_free(xobj);
-        sk_X509_CRL_free(sk);
         return NULL;
     }
     X509_OBJECT_free(xobj);
     if (i == 0)
-        return sk;
-    if (!X509_STORE_lock(store)) {
-        sk_X509_CRL_free(sk);
-        return NULL;
-    }
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_CRL, nm, &cnt);
-    if (idx < 0) {
-        X509_STORE_unlock(store);
-        return sk;
-    }
+        return sk_X509_CRL_new_null();
 
-    for (i = 0; i < cnt; i++, idx++) {
-        obj = sk_X509_OBJECT_value(store->objs, idx);
-        x = obj->data.crl;
-        if (!X509_CRL_up_ref(x)) {
-            X509_STORE_unlock(store);
-            sk_X509_CRL_pop_free(sk, X509_CRL_free);
-            return NULL;
-        }
-        if (!sk_X509_CRL_push(sk, x)) {
-            X509_STORE_unlock(store);
-            X509_CRL_free(x);
-            sk_X509_CRL_pop_free(sk, X509_CRL_free);
-            return NULL;
-        }
-    }
-    X509_STORE_unlock(store);
-    return sk;
+    return x509_store_index_get1_crls(store, nm);
 }
 
 X509_OBJECT *X509_OBJECT_retrieve_match(STACK_OF(X509_OBJECT) *h,
@@ -801,9 +1100,11 @@ X509_OBJECT *X509_OBJECT_retrieve_match(STACK_OF(X509_OBJECT) *h,
 int X509_STORE_CTX_get1_issuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x)
 {
     const X509_NAME *xn;
-    X509_OBJECT *obj = X509_OBJECT_new(), *pobj = NULL;
+    X509_OBJECT *obj = X509_OBJECT_new();
     X509_STORE *store = ctx->store;
-    int i, ok, idx, ret, nmatch = 0;
+    STACK_OF(X509) *certs;
+    X509 *cert;
+    int i, ok, ret;
 
     if (obj == NULL)
         return -1;
@@ -834,43 +1135,35 @@ int X509_STORE_CTX_get1_issuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x)
     if (store == NULL)
         return 0;
 
-    /* Find index of first currently valid cert accepted by 'check_issued' */
-    ret = 0;
-    if (!X509_STORE_lock(store))
-        return 0;
+    if ((certs = x509_store_index_get1_certs(store, xn)) == NULL)
+        return -1;
 
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_X509, xn, &nmatch);
-    if (idx != -1) { /* should be true as we've had at least one match */
-        /* Look through all matching certs for suitable issuer */
-        for (i = idx; i < idx + nmatch; i++) {
-            pobj = sk_X509_OBJECT_value(store->objs, i);
-            /* See if we've run past the matches */
-            if (pobj->type != X509_LU_X509)
+    /* Find first currently valid cert accepted by 'check_issued' */
+    ret = 0;
+    for (i = 0; i < sk_X509_num(certs); i++) {
+        cert = sk_X509_value(certs, i);
+        if (ctx->check_issued(ctx, x, cert)) {
+            ret = 1;
+            /* If times check fine, exit with match, else keep looking. */
+            if (ossl_x509_check_cert_time(ctx, cert, -1)) {
+                *issuer = cert;
                 break;
-            if (ctx->check_issued(ctx, x, pobj->data.x509)) {
-                ret = 1;
-                /* If times check fine, exit with match, else keep looking. */
-                if (ossl_x509_check_cert_time(ctx, pobj->data.x509, -1)) {
-                    *issuer = pobj->data.x509;
-                    break;
-                }
-                /*
-                 * Leave the so far most recently expired match in *issuer
-                 * so we return nearest match if no certificate time is OK.
-                 */
-                if (*issuer == NULL
-                    || ASN1_TIME_compare(X509_get0_notAfter(pobj->data.x509),
-                                         X509_get0_notAfter(*issuer)) > 0)
-                    *issuer = pobj->data.x509;
             }
+            /*
+             * Leave the so far most recently expired match in *issuer
+             * so we return nearest match if no certificate time is OK.
+             */
+            if (*issuer == NULL
+                || ASN1_TIME_compare(X509_get0_notAfter(cert),
+                                     X509_get0_notAfter(*issuer)) > 0)
+                *issuer = cert;
         }
     }
     if (*issuer != NULL && !X509_up_ref(*issuer)) {
         *issuer = NULL;
         ret = -1;
     }
-    X509_STORE_unlock(store);
+    OSSL_STACK_OF_X509_free(certs);
     return ret;
 }
 
@@ -0,0 +1,528 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include <openssl/buffer.h>
+#include <openssl/err.h>
+#include "internal/cryptlib.h"
+#include "internal/packet.h"
+#include "internal/rcu.h"
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+/*
+ * Cache of successfully verified chains of an X509_STORE.
+ *
+ * An entry records that a leaf certificate, presented with a given set of
+ * untrusted certificates and verified with given parameters, was found to
+ * have a valid chain. It is only used while the store holds the same objects
+ * as when it was created, and while the current time lies within the
+ * validity periods of all certificates of the chain and, when CRLs are
+ * checked, before the next update of the CRLs of their issuers.
+ *
+ * Entries are looked up under the RCU read lock of the table only, and are
+ * never modified once they have been inserted.  The cache itself is never
+ * freed before the store, disabling it only empties it.
+ */
+
+HT_START_KEY_DEFN(chain_cache_key)
+HT_DEF_KEY_FIELD(hash, uint64_t)
+HT_END_KEY_DEFN(CHAIN_CACHE_KEY)
+
+typedef struct chain_cache_entry_st {
+    uint64_t hash;
+    uint64_t generation;        /* Of the store when verification started */
+    STACK_OF(X509) *certs;      /* The leaf followed by the untrusted certs */
+    unsigned char *params;      /* Serialised verification parameters */
+    size_t params_len;
+    /* The result */
+    STACK_OF(X509) *chain;
+    int num_untrusted;
+    int explicit_policy;
+    char *peername;
+    /* The entry is only valid between these times, if they are set */
+    ASN1_TIME *not_before;
+    ASN1_TIME *not_after;
+} CHAIN_CACHE_ENTRY;
+
+IMPLEMENT_HT_VALUE_TYPE_FNS(CHAIN_CACHE_ENTRY, chain, static)
+
+struct x509_chain_cache_st {
+    HT *ht;
+    uint64_t max;               /* Zero if the cache is disabled */
+    uint64_t hits;
+    uint64_t misses;
+    CRYPTO_RWLOCK *lock;        /* Only for atomics without native support */
+};
+
+typedef struct chain_cache_flush_st {
+    uint32_t seed;
+} CHAIN_CACHE_FLUSH;
+
+static void chain_cache_entry_free(CHAIN_CACHE_ENTRY *e)
+{
+    if (e == NULL)
+        return;
+    OSSL_STACK_OF_X509_free(e->certs);
+    OSSL_STACK_OF_X509_free(e->chain);
+    OPENSSL_free(e->params);
+    OPENSSL_free(e->peername);
+    ASN1_TIME_free(e->not_before);
+    ASN1_TIME_free(e->not_after);
+    OPENSSL_free(e);
+}
+
+static void chain_cache_entry_ht_free(HT_VALUE *v)
+{
+    chain_cache_entry_free(ossl_ht_chain_CHAIN_CACHE_ENTRY_from_value(v));
+}
+
+X509_CHAIN_CACHE *ossl_x509_chain_cache_new(size_t max)
+{
+    HT_CONFIG htconf = { NULL, chain_cache_entry_ht_free, NULL, 0, 1, 0 };
+    X509_CHAIN_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+    if ((cache->lock = CRYPTO_THREAD_lock_new()) == NULL
+        || (cache->ht = ossl_ht_new(&htconf)) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        ossl_x509_chain_cache_free(cache);
+        return NULL;
+    }
+    cache->max = max;
+    return cache;
+}
+
+void ossl_x509_chain_cache_free(X509_CHAIN_CACHE *cache)
+{
+    if (cache == NULL)
+        return;
+    ossl_ht_free(cache->ht);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+static int put_string(WPACKET *pkt, const void *s, size_t len)
+{
+    return WPACKET_sub_memcpy_u32(pkt, s == NULL ? "" : s, len);
+}
+
+/*
+ * Serialises everything other than the certificates which the outcome of the
+ * verification in |ctx| depends on.
+ */
+static unsigned char *chain_cache_params(const X509_STORE_CTX *ctx,
+                                         size_t *len)
+{
+    const X509_VERIFY_PARAM *vpm = ctx->param;
+    BUF_MEM *buf = BUF_MEM_new();
+    WPACKET pkt;
+    unsigned char *ret = NULL;
+    uint64_t check_time = 0;
+    int i, ok;
+
+    if (buf == NULL)
+        return NULL;
+    if (!WPACKET_init(&pkt, buf)) {
+        BUF_MEM_free(buf);
+        return NULL;
+    }
+
+    if ((vpm->flags & X509_V_FLAG_USE_CHECK_TIME) != 0)
+        check_time = (uint64_t)vpm->check_time;
+    ok = WPACKET_put_bytes_u64(&pkt, (uint64_t)vpm->flags)
+        && WPACKET_put_bytes_u64(&pkt, check_time)
+        && WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->purpose)
+        && WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->trust)
+        && WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->depth)
+        && WPACKET_put_bytes_u32(&pkt, (uint32_t)vpm->auth_level)
+        && WPACKET_put_bytes_u32(&pkt, vpm->hostflags)
+        && put_string(&pkt, vpm->email, vpm->emaillen)
+        && put_string(&pkt, vpm->ip, vpm->iplen)
+        && put_string(&pkt, ctx->propq,
+                      ctx->propq == NULL ? 0 : strlen(ctx->propq))
+        && WPACKET_memcpy(&pkt, &ctx->libctx, sizeof(ctx->libctx))
+        && WPACKET_start_sub_packet_u32(&pkt);
+    for (i = 0; ok && i < sk_ASN1_OBJECT_num(vpm->policies); i++) {
+        const ASN1_OBJECT *obj = sk_ASN1_OBJECT_value(vpm->policies, i);
+
+        ok = put_string(&pkt, OBJ_get0_data(obj), OBJ_length(obj));
+    }
+    ok = ok && WPACKET_close(&pkt) && WPACKET_start_sub_packet_u32(&pkt);
+    for (i = 0; ok && i < sk_OPENSSL_STRING_num(vpm->hosts); i++) {
+        const char *host = sk_OPENSSL_STRING_value(vpm->hosts, i);
+
+        ok = put_string(&pkt, host, strlen(host));
+    }
+
+    if (ok && WPACKET_close(&pkt) && WPACKET_finish(&pkt) && WPACKET_get_total_written(&pkt, len)) {
+        ret = (unsigned char *)buf->data;
+        buf->data = NULL;
+    } else {
+        WPACKET_cleanup(&pkt);
+    }
+    BUF_MEM_free(buf);
+    return ret;
+}
+
+static uint64_t fnv1a(uint64_t hash, const unsigned char *p, size_t len)
+{
+    while (len-- > 0) {
+        hash ^= *p++;
+        hash *= 0x00000100000001B3ULL;
+    }
+    return hash;
+}
+
+/*
+ * Hashes the fingerprints of the certificates presented for verification and
+ * the serialised parameters. Fails if any fingerprint is not available.
+ */
+static int chain_cache_key_init(CHAIN_CACHE_KEY *key, X509_STORE_CTX *ctx,
+                                const unsigned char *params, size_t params_len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    X509 *x = ctx->cert;
+    int i = 0;
+
+    do {
+        if (!ossl_x509v3_cache_extensions(x)
+            || (x->ex_flags & EXFLAG_NO_FINGERPRINT) != 0)
+            return 0;
+        hash = fnv1a(hash, x->sha1_hash, sizeof(x->sha1_hash));
+    } while ((x = sk_X509_value(ctx->untrusted, i++)) != NULL);
+    hash = fnv1a(hash, params, params_len);
+
+    HT_INIT_KEY(key);
+    HT_SET_KEY_FIELD(key, hash, hash);
+    return 1;
+}
+
+/* Checks whether |e| is for the same certificates and parameters as |ctx| */
+static int chain_cache_entry_match(const CHAIN_CACHE_ENTRY *e,
+                                   X509_STORE_CTX *ctx,
+                                   const unsigned char *params,
+                                   size_t params_len)
+{
+    int i, n = ctx->untrusted == NULL ? 0 : sk_X509_num(ctx->untrusted);
+
+    if (e->params_len != params_len
+        || memcmp(e->params, params, params_len) != 0
+        || sk_X509_num(e->certs) != n + 1
+        || X509_cmp(sk_X509_value(e->certs, 0), ctx->cert) != 0)
+        return 0;
+    for (i = 0; i < n; i++)
+        if (X509_cmp(sk_X509_value(e->certs, i + 1),
+                     sk_X509_value(ctx->untrusted, i)) != 0)
+            return 0;
+    return 1;
+}
+
+static int chain_cache_entry_current(const CHAIN_CACHE_ENTRY *e,
+                                     uint64_t generation)
+{
+    return e->generation == generation
+        && (e->not_before == NULL || X509_cmp_time(e->not_before, NULL) < 0)
+        && (e->not_after == NULL || X509_cmp_time(e->not_after, NULL) > 0);
+}
+
+static uint64_t chain_cache_generation(X509_STORE *store)
+{
+    uint64_t generation = 0;
+
+    (void)CRYPTO_atomic_load(&store->generation, &generation, store->lock);
+    return generation;
+}
+
+static uint64_t chain_cache_max(X509_CHAIN_CACHE *cache)
+{
+    uint64_t max = 0;
+
+    (void)CRYPTO_atomic_load(&cache->max, &max, cache->lock);
+    return max;
+}
+
+/* Returns the chain cache of |xs| if it is enabled, NULL otherwise */
+X509_CHAIN_CACHE *ossl_x509_chain_cache_get0(X509_STORE *xs)
+{
+    X509_CHAIN_CACHE *cache = ossl_rcu_deref(&xs->chain_cache);
+
+    return cache != NULL && chain_cache_max(cache) > 0 ? cache : NULL;
+}
+
+/*
+ * Looks up the verification in |ctx|, which must have been found eligible by
+ * the caller. On a hit the chain of |ctx| is set to the cached result and 1 is
+ * returned, otherwise 0 is returned and |*generation| is set to the one to
+ * pass to ossl_x509_chain_cache_add() after the verification.
+ */
+int ossl_x509_chain_cache_get1(X509_CHAIN_CACHE *cache, X509_STORE_CTX *ctx,
+                               uint64_t *generation)
+{
+    CHAIN_CACHE_KEY key;
+    CHAIN_CACHE_ENTRY *e;
+    HT_VALUE *v;
+    STACK_OF(X509) *chain = NULL;
+    char *peername = NULL;
+    int num_untrusted = 0, explicit_policy = 0, hit = 0;
+    unsigned char *params;
+    size_t params_len;
+    uint64_t tmp;
+
+    *generation = chain_cache_generation(ctx->store);
+    if ((params = chain_cache_params(ctx, &params_len)) == NULL)
+        goto end;
+    if (!chain_cache_key_init(&key, ctx, params, params_len))
+        goto end;
+
+    ossl_ht_read_lock(cache->ht);
+    e = ossl_ht_chain_CHAIN_CACHE_ENTRY_get(cache->ht, TO_HT_KEY(&key), &v);
+    if (e != NULL
+        && chain_cache_entry_current(e, *generation)
+        && chain_cache_entry_match(e, ctx, params, params_len)
+        && (chain = X509_chain_up_ref(e->chain)) != NULL) {
+        if (e->peername == NULL
+            || (peername = OPENSSL_strdup(e->peername)) != NULL) {
+            num_untrusted = e->num_untrusted;
+            explicit_policy = e->explicit_policy;
+            hit = 1;
+        }
+    }
+    ossl_ht_read_unlock(cache->ht);
+
+    if (hit) {
+        OSSL_STACK_OF_X509_free(ctx->chain);
+        ctx->chain = chain;
+        ctx->num_untrusted = num_untrusted;
+        ctx->explicit_policy = explicit_policy;
+        ctx->error = X509_V_OK;
+        ctx->error_depth = 0;
+        ctx->current_cert = NULL;
+        if (peername != NULL) {
+            OPENSSL_free(ctx->param->peername);
+            ctx->param->peername = peername;
+        }
+        chain = NULL;
+    }
+
+ end:
+    OSSL_STACK_OF_X509_free(chain);
+    OPENSSL_free(params);
+    (void)CRYPTO_atomic_add64(hit ? &cache->hits : &cache->misses, 1, &tmp,
+                              cache->lock);
+    return hit;
+}
+
+/* Sets |*pt| to |t| if it is earlier, or later, than the current value */
+static int chain_cache_narrow(ASN1_TIME **pt, const ASN1_TIME *t, int earlier)
+{
+    int cmp;
+
+    if (*pt != NULL) {
+        cmp = ASN1_TIME_compare(t, *pt);
+        if (cmp == -2)
+            return 0;
+        if (earlier ? cmp >= 0 : cmp <= 0)
+            return 1;
+        ASN1_TIME_free(*pt);
+    }
+    return (*pt = ASN1_STRING_dup(t)) != NULL;
+}
+
+/*
+ * Determines the period within which the verification result in |ctx| can be
+ * reused: the intersection of the validity periods of the certificates of
+ * the chain and, when checking CRLs, up to the next update of any CRL issued
+ * by the issuer of one of them.
+ */
+static int chain_cache_entry_set_times(CHAIN_CACHE_ENTRY *e,
+                                       X509_STORE_CTX *ctx)
+{
+    unsigned long flags = ctx->param->flags;
+    STACK_OF(X509_CRL) *crls;
+    const ASN1_TIME *next;
+    X509 *x;
+    int i, j, ok = 1;
+
+    /* A given time is part of the key and no time at all needs no limits */
+    if ((flags & (X509_V_FLAG_USE_CHECK_TIME | X509_V_FLAG_NO_CHECK_TIME)) != 0)
+        return 1;
+
+    for (i = 0; ok && i < sk_X509_num(ctx->chain); i++) {
+        x = sk_X509_value(ctx->chain, i);
+        ok = chain_cache_narrow(&e->not_before, X509_get0_notBefore(x), 0)
+            && chain_cache_narrow(&e->not_after, X509_get0_notAfter(x), 1);
+        if (!ok || (flags & X509_V_FLAG_CRL_CHECK) == 0)
+            continue;
+        if ((crls = ctx->lookup_crls(ctx, X509_get_issuer_name(x))) == NULL)
+            return 0;
+        for (j = 0; ok && j < sk_X509_CRL_num(crls); j++) {
+            next = X509_CRL_get0_nextUpdate(sk_X509_CRL_value(crls, j));
+            if (next != NULL)
+                ok = chain_cache_narrow(&e->not_after, next, 1);
+        }
+        sk_X509_CRL_pop_free(crls, X509_CRL_free);
+    }
+    return ok;
+}
+
+/*
+ * Remove about half of the entries, chosen at random. See the comment on
+ * impl_cache_flush_cache() in crypto/property/property.c for why this is
+ * preferred to keeping track of their use.
+ */
+static int chain_cache_flush_entry(HT_VALUE *v, void *arg)
+{
+    CHAIN_CACHE_FLUSH *state = arg;
+    uint32_t n;
+
+    /* 32 bit xorshift, see impl_cache_flush_cache() */
+    n = state->seed;
+    n ^= n << 13;
+    n ^= n >> 17;
+    n ^= n << 5;
+    state->seed = n;
+
+    return (n & 1) != 0;
+}
+
+/* Must be called with the write lock of the table held */
+static void chain_cache_flush_some(X509_CHAIN_CACHE *cache)
+{
+    CHAIN_CACHE_FLUSH state;
+    HT_VALUE_LIST *list;
+    CHAIN_CACHE_KEY key;
+    CHAIN_CACHE_ENTRY *e;
+    size_t i;
+
+    if ((state.seed = (uint32_t)OPENSSL_rdtsc()) == 0)
+        state.seed = (uint32_t)ossl_ht_count(cache->ht) | 1;
+    list = ossl_ht_filter(cache->ht, ossl_ht_count(cache->ht),
+                          &chain_cache_flush_entry, &state);
+    if (list == NULL)
+        return;
+    for (i = 0; i < list->list_len; i++) {
+        e = ossl_ht_chain_CHAIN_CACHE_ENTRY_from_value(list->list[i]);
+        HT_INIT_KEY(&key);
+        HT_SET_KEY_FIELD(&key, hash, e->hash);
+        (void)ossl_ht_delete(cache->ht, TO_HT_KEY(&key));
+    }
+    ossl_ht_value_list_free(list);
+}
+
+/*
+ * Records the successful verification in |ctx|, which was looked up with
+ * ossl_x509_chain_cache_get1() first. Failure to do so is not an error.
+ */
+void ossl_x509_chain_cache_add(X509_CHAIN_CACHE *cache, X509_STORE_CTX *ctx,
+                               uint64_t generation)
+{
+    CHAIN_CACHE_KEY key;
+    CHAIN_CACHE_ENTRY *e, *replaced = NULL;
+    uint64_t max;
+    int i = 0;
+
+    if ((e = OPENSSL_zalloc(sizeof(*e))) == NULL)
+        return;
+    e->generation = generation;
+    e->num_untrusted = ctx->num_untrusted;
+    e->explicit_policy = ctx->explicit_policy;
+    if ((e->params = chain_cache_params(ctx, &e->params_len)) == NULL
+        || !chain_cache_key_init(&key, ctx, e->params, e->params_len)
+        || (ctx->param->peername != NULL
+            && (e->peername = OPENSSL_strdup(ctx->param->peername)) == NULL)
+        || (e->chain = X509_chain_up_ref(ctx->chain)) == NULL
+        || (e->certs = sk_X509_new_null()) == NULL
+        || !X509_add_cert(e->certs, ctx->cert, X509_ADD_FLAG_UP_REF)
+        || !X509_add_certs(e->certs, ctx->untrusted, X509_ADD_FLAG_UP_REF)
+        || !chain_cache_entry_set_times(e, ctx))
+        goto err;
+    e->hash = key.keyfields.hash;
+
+    ossl_ht_write_lock(cache->ht);
+    /* The cache may have been disabled meanwhile */
+    if ((max = chain_cache_max(cache)) > 0) {
+        if (ossl_ht_count(cache->ht) >= max)
+            chain_cache_flush_some(cache);
+        i = ossl_ht_chain_CHAIN_CACHE_ENTRY_insert(cache->ht, TO_HT_KEY(&key),
+                                                   e, &replaced);
+    }
+    /* This waits for readers which may still be using |replaced| */
+    ossl_ht_write_unlock(cache->ht);
+    chain_cache_entry_free(replaced);
+    if (i > 0)
+        return;
+
+ err:
+    chain_cache_entry_free(e);
+}
+
+/*
+ * Verifiers may be using the cache concurrently, so it is never freed here.
+ * Disabling it empties the table, which waits for readers of the entries.
+ */
+int X509_STORE_set_chain_cache_size(X509_STORE *xs, size_t size)
+{
+    X509_CHAIN_CACHE *cache;
+    int ret = 0;
+
+    if (!X509_STORE_lock(xs))
+        return 0;
+    cache = xs->chain_cache;
+    if (cache == NULL) {
+        if (size == 0) {
+            ret = 1;
+        } else if ((cache = ossl_x509_chain_cache_new(size)) != NULL) {
+            ossl_rcu_assign_ptr(&xs->chain_cache, &cache);
+            ret = 1;
+        }
+    } else if (CRYPTO_atomic_store(&cache->max, size, cache->lock)) {
+        ret = 1;
+        if (size == 0) {
+            ossl_ht_write_lock(cache->ht);
+            ossl_ht_flush(cache->ht);
+            ossl_ht_write_unlock(cache->ht);
+            if (!CRYPTO_atomic_store(&cache->hits, 0, cache->lock)
+                || !CRYPTO_atomic_store(&cache->misses, 0, cache->lock))
+                ret = 0;
+        }
+    }
+    X509_STORE_unlock(xs);
+    return ret;
+}
+
+size_t X509_STORE_get_chain_cache_size(const X509_STORE *xs)
+{
+    X509_CHAIN_CACHE *cache = ossl_rcu_deref(&xs->chain_cache);
+
+    return cache == NULL ? 0 : (size_t)chain_cache_max(cache);
+}
+
+uint64_t X509_STORE_get_chain_cache_hits(const X509_STORE *xs)
+{
+    X509_CHAIN_CACHE *cache = ossl_rcu_deref(&xs->chain_cache);
+    uint64_t ret = 0;
+
+    if (cache != NULL)
+        (void)CRYPTO_atomic_load(&cache->hits, &ret, cache->lock);
+    return ret;
+}
+
+uint64_t X509_STORE_get_chain_cache_misses(const X509_STORE *xs)
+{
+    X509_CHAIN_CACHE *cache = ossl_rcu_deref(&xs->chain_cache);
+    uint64_t ret = 0;
+
+    if (cache != NULL)
+        (void)CRYPTO_atomic_load(&cache->misses, &ret, cache->lock);
+    return ret;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -56,6 +56,8 @@ static int check_name_constraints(X509_STORE_CTX *ctx);
 static int check_id(X509_STORE_CTX *ctx);
 static int check_trust(X509_STORE_CTX *ctx, int num_untrusted);
 static int check_revocation(X509_STORE_CTX *ctx);
+static int check_crl(X509_STORE_CTX *ctx, X509_CRL *crl);
+static int cert_crl(X509_STORE_CTX *ctx, X509_CRL *crl, X509 *x);
 static int check_cert(X509_STORE_CTX *ctx);
 static int check_policy(X509_STORE_CTX *ctx);
 static int get_issuer_sk(X509 **issuer, X509_STORE_CTX *ctx, X509 *x);
@@ -321,13 +323,41 @@ static int x509_verify_rpk(X509_STORE_CTX *ctx)
     return ret;
 }
 
+/*
+ * The verified chain cache is only used when the outcome of the verification
+ * depends on nothing but the certificates, the verification parameters and
+ * the contents of the store, and nothing else is expected to happen.  Policy
+ * checking is excluded, as the policy tree it leaves behind isn't cached.
+ */
+static int chain_cache_eligible(X509_STORE_CTX *ctx)
+{
+    return ctx->store != NULL
+        && ctx->parent == NULL && ctx->other_ctx == NULL
+        && ctx->crls == NULL && ctx->dane == NULL && ctx->rpk == NULL
+        && (ctx->param->flags & (X509_V_FLAG_EXTENDED_CRL_SUPPORT
+                                 | X509_V_FLAG_POLICY_CHECK)) == 0
+        && ctx->verify_cb == null_callback
+        && ctx->verify == internal_verify
+        && ctx->get_issuer == X509_STORE_CTX_get1_issuer
+        && ctx->check_issued == check_issued
+        && ctx->check_revocation == check_revocation
+        && ctx->get_crl == NULL
+        && ctx->check_crl == check_crl
+        && ctx->cert_crl == cert_crl
+        && ctx->check_policy == check_policy
+        && ctx->lookup_certs == X509_STORE_CTX_get1_certs
+        && ctx->lookup_crls == X509_STORE_CTX_get1_crls;
+}
+
 /*-
  * Returns -1 on internal error.
  * Sadly, returns 0 also on internal error in ctx->verify_cb().
  */
 static int x509_verify_x509(X509_STORE_CTX *ctx)
 {
+    X509_CHAIN_CACHE *cache = NULL;
     int ret;
+    uint64_t generation = 0;
 
     if (ctx->cert == NULL) {
         ERR_raise(ERR_LIB_X509, X509_R_NO_CERT_SET_FOR_US_TO_VERIFY);
@@ -355,8 +385,16 @@ static int x509_verify_x509(X509_STORE_CTX *ctx)
     CB_FAIL_IF(!check_cert_key_level(ctx, ctx->cert),
                ctx, ctx->cert, 0, X509_V_ERR_EE_KEY_TOO_SMALL);
 
+    if (chain_cache_eligible(ctx)
+        && (cache = ossl_x509_chain_cache_get0(ctx->store)) != NULL
+        && ossl_x509_chain_cache_get1(cache, ctx, &generation))
+        return 1;
+
     ret = DANETLS_ENABLED(ctx->dane) ? dane_verify(ctx) : verify_chain(ctx);
 
+    if (cache != NULL && ret > 0 && ctx->error == X509_V_OK)
+        ossl_x509_chain_cache_add(cache, ctx, generation);
+
     /*
      * Safety-net.  If we are returning an error, we must also set ctx->error,
      * so that the chain is not considered verified should the error be ignored
@@ -1,5 +1,5 @@
 /*
- * Copyright 2018-2021 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2018-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -102,5 +102,10 @@ int ossl_ecdsa_deterministic_sign(const unsigned char *dgst, int dlen,
                                   EC_KEY *eckey, unsigned int nonce_type,
                                   const char *digestname,
                                   OSSL_LIB_CTX *libctx, const char *propq);
+int ossl_ecdsa_verify_batch(size_t num, const unsigned char *const *dgst,
+                            const size_t *dgst_len,
+                            const unsigned char *const *sig,
+                            const size_t *sig_len, int *results,
+                            EC_KEY *eckey);
 # endif /* OPENSSL_NO_EC */
 #endif
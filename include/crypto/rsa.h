@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -113,6 +113,13 @@ int ossl_rsa_verify(int dtype, const unsigned char *m,
                     unsigned int m_len, unsigned char *rm,
                     size_t *prm_len, const unsigned char *sigbuf,
                     size_t siglen, RSA *rsa);
+int ossl_rsa_sign_batch(int type, size_t count,
+                        const unsigned char *const *m, const size_t *m_len,
+                        unsigned char *const *sigret, RSA *rsa);
+int ossl_rsa_private_encrypt_batch(RSA *rsa, size_t count,
+                                   const unsigned char *const *from,
+                                   const int *flen,
+                                   unsigned char *const *to, int padding);
 
 const unsigned char *ossl_rsa_digestinfo_encoding(int md_nid, size_t *len);
 
@@ -30,6 +30,7 @@
 #   include <sys/types.h>
 #   include <sys/socket.h>
 #   include <sys/ktls.h>
+#   include <unistd.h>
 #   include <netinet/in.h>
 #   include <netinet/tcp.h>
 #   include <openssl/ssl3.h>
@@ -208,6 +209,22 @@ static ossl_inline ossl_ssize_t ktls_sendfile(int s, int fd, off_t off,
     return sbytes;
 }
 
+/*
+ * FreeBSD has no splice system call, so decrypted data can only be received
+ * with recvmsg().
+ */
+static ossl_inline ossl_ssize_t ktls_splice(int s, int fd, size_t size,
+                                            int flags)
+{
+    errno = EOPNOTSUPP;
+    return -1;
+}
+
+static ossl_inline int ktls_splice_pipe_full(int fd)
+{
+    return 0;
+}
+
 #  endif                         /* __FreeBSD__ */
 
 #  if defined(OPENSSL_SYS_LINUX)
@@ -242,6 +259,9 @@ static ossl_inline ossl_ssize_t ktls_sendfile(int s, int fd, off_t off,
 #   endif
 
 #   include <sys/sendfile.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   include <poll.h>
 #   include <netinet/tcp.h>
 #   include <linux/socket.h>
 #   include <openssl/ssl3.h>
@@ -372,6 +392,18 @@ static ossl_inline int ktls_read_record(int fd, void *data, size_t length)
     return -1;
 }
 
+static ossl_inline ossl_ssize_t ktls_splice(int s, int fd, size_t size,
+                                            int flags)
+{
+    errno = EOPNOTSUPP;
+    return -1;
+}
+
+static ossl_inline int ktls_splice_pipe_full(int fd)
+{
+    return 0;
+}
+
 #   else /* !defined(OPENSSL_NO_KTLS_RX) */
 
 /*
@@ -427,6 +459,32 @@ static ossl_inline int ktls_read_record(int fd, void *data, size_t length)
     return ret;
 }
 
+/*
+ * Move up to |size| bytes of decrypted application data from the socket to
+ * the pipe |fd| without copying them to user space. Records of any other
+ * type cannot be spliced: the call fails with EINVAL when one is next in
+ * line, and it must then be read with ktls_read_record().
+ */
+static ossl_inline ossl_ssize_t ktls_splice(int s, int fd, size_t size,
+                                            int flags)
+{
+    return syscall(__NR_splice, s, NULL, fd, NULL, size, (unsigned int)flags);
+}
+
+/*
+ * ktls_splice() fails with EAGAIN both when no data is waiting on the socket
+ * and when the pipe |fd| is full. Returns 1 in the latter case.
+ */
+static ossl_inline int ktls_splice_pipe_full(int fd)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    return poll(&pfd, 1, 0) == 0;
+}
+
 #   endif /* OPENSSL_NO_KTLS_RX */
 
 #  endif /* OPENSSL_SYS_LINUX */
@@ -85,6 +85,12 @@ int ossl_method_store_cache_set(OSSL_METHOD_STORE *store, OSSL_PROVIDER *prov,
 
 __owur int ossl_method_store_cache_flush_all(OSSL_METHOD_STORE *store);
 
+/*
+ * The generation of a store changes whenever the result of a fetch from it
+ * might change, i.e. whenever its query cache is flushed.
+ */
+unsigned int ossl_method_store_generation(OSSL_METHOD_STORE *store);
+
 /* Merge two property queries together */
 OSSL_PROPERTY_LIST *ossl_property_merge(const OSSL_PROPERTY_LIST *a,
                                         const OSSL_PROPERTY_LIST *b);
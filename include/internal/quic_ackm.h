@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -54,6 +54,15 @@ void ossl_ackm_set_rx_max_ack_delay(OSSL_ACKM *ackm, OSSL_TIME rx_max_ack_delay)
  */
 void ossl_ackm_set_tx_max_ack_delay(OSSL_ACKM *ackm, OSSL_TIME tx_max_ack_delay);
 
+/*
+ * Replaces the congestion controller notified by the ACKM. This must only be
+ * done before any packet has been sent, as the new controller would otherwise
+ * not know about the packets in flight. The ACKM does not take ownership of
+ * cc_data.
+ */
+void ossl_ackm_set_cc_method(OSSL_ACKM *ackm, const OSSL_CC_METHOD *cc_method,
+                             OSSL_CC_DATA *cc_data);
+
 typedef struct ossl_ackm_tx_pkt_st OSSL_ACKM_TX_PKT;
 struct ossl_ackm_tx_pkt_st {
     /* The packet number of the transmitted packet. */
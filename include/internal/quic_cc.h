@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -54,6 +54,12 @@ typedef struct ossl_cc_ecn_info_st {
 /* Diagnostic (read-only): method-specific state value. */
 #define OSSL_CC_OPTION_CUR_STATE                    "cur_state"
 
+/*
+ * Diagnostic (read-only): rate in bytes per second at which transmissions
+ * should be paced, or 0 if they should not be paced. See quic_pacer.h.
+ */
+#define OSSL_CC_OPTION_CUR_PACING_RATE              "pacing_rate"
+
 /*
  * Congestion control abstract interface.
  *
@@ -212,6 +218,8 @@ struct ossl_cc_method_st {
 
 extern const OSSL_CC_METHOD ossl_cc_dummy_method;
 extern const OSSL_CC_METHOD ossl_cc_newreno_method;
+extern const OSSL_CC_METHOD ossl_cc_cubic_method;
+extern const OSSL_CC_METHOD ossl_cc_bbr2_method;
 
 # endif
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -445,6 +445,14 @@ uint64_t ossl_quic_channel_get_max_idle_timeout_peer_request(const QUIC_CHANNEL
 /* Get the idle timeout actually negotiated. */
 uint64_t ossl_quic_channel_get_max_idle_timeout_actual(const QUIC_CHANNEL *ch);
 
+/*
+ * Selects the congestion controller (SSL_QUIC_CC_*). This is only possible
+ * while the channel is idle.
+ */
+int ossl_quic_channel_set_cc_alg(QUIC_CHANNEL *ch, int alg);
+/* Get the congestion controller in use (SSL_QUIC_CC_*). */
+int ossl_quic_channel_get_cc_alg(const QUIC_CHANNEL *ch);
+
 # endif
 
 #endif
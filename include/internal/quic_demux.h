@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -217,6 +217,13 @@ void ossl_quic_demux_set_bio(QUIC_DEMUX *demux, BIO *net_bio);
  */
 int ossl_quic_demux_set_mtu(QUIC_DEMUX *demux, unsigned int mtu);
 
+/*
+ * Sets whether to receive datagrams coalesced by UDP GRO if the BIO supports
+ * it. They are split back into one URXE per datagram, at the cost of a copy
+ * and of a receive buffer large enough for a coalesced message.
+ */
+void ossl_quic_demux_set_gro(QUIC_DEMUX *demux, int enable);
+
 /*
  * Set the default packet handler. This is used for incoming packets which don't
  * match a registered DCID. This is only needed for servers. If a default packet
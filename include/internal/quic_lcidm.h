@@ -1,5 +1,5 @@
 /*
-* Copyright 2023 The OpenSSL Project Authors. All Rights Reserved.
+* Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
 *
 * Licensed under the Apache License 2.0 (the "License").  You may not use
 * this file except in compliance with the License.  You can obtain a copy
@@ -111,6 +111,35 @@ void ossl_quic_lcidm_free(QUIC_LCIDM *lcidm);
 /* Gets the local CID length this LCIDM was configured to use. */
 size_t ossl_quic_lcidm_get_lcid_len(const QUIC_LCIDM *lcidm);
 
+/*
+ * Configures a steering ID to be embedded in all LCIDs subsequently generated
+ * by this LCIDM. The steering ID occupies the top steer_bits bits of the first
+ * byte of each LCID, the remaining bits stay random. This allows several
+ * receivers sharing a UDP port (for example, one worker per core using
+ * SO_REUSEPORT sockets) to determine which of them owns a connection from the
+ * DCID of any packet addressed to it.
+ *
+ * steer_bits may be 0 to disable steering and must not exceed
+ * QUIC_LCIDM_MAX_STEER_BITS. steer_id must fit in steer_bits bits. Steering
+ * cannot be enabled if the LCID length is zero. Returns 1 on success and 0 on
+ * failure.
+ */
+#define QUIC_LCIDM_MAX_STEER_BITS   8
+
+int ossl_quic_lcidm_set_steering(QUIC_LCIDM *lcidm,
+                                 unsigned int steer_bits,
+                                 unsigned int steer_id);
+
+/*
+ * Decodes the steering ID embedded in a CID. Returns 1 and writes the steering
+ * ID to *steer_id if steering is enabled and the CID has the length of LCIDs
+ * generated by this LCIDM. Returns 0 otherwise. The CID need not be known to
+ * the LCIDM; a peer's Initial ODCID yields an arbitrary value.
+ */
+int ossl_quic_lcidm_get_steering_id(const QUIC_LCIDM *lcidm,
+                                    const QUIC_CONN_ID *lcid,
+                                    unsigned int *steer_id);
+
 /*
  * Determines the number of active LCIDs (i.e,. LCIDs which can be used for
  * reception) currently associated with the given opaque pointer.
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_QUIC_PACER_H
+# define OSSL_QUIC_PACER_H
+
+# include "internal/time.h"
+# include "internal/quic_predef.h"
+# include "internal/quic_cc.h"
+
+# ifndef OPENSSL_NO_QUIC
+
+/*
+ * QUIC Pacer
+ * ==========
+ *
+ * The pacer sits between a congestion controller and the TX packetiser and
+ * spreads the packets which the congestion window allows over time, rather
+ * than letting them leave in a single burst (RFC 9002 s. 7.7). The rate is
+ * chosen by the congestion controller, which publishes it through the
+ * OSSL_CC_OPTION_CUR_PACING_RATE diagnostic; the pacer binds that diagnostic
+ * and limits transmission with a token bucket filled at that rate.
+ *
+ * Congestion controllers which do not provide a pacing rate, or which have no
+ * estimate yet, leave the rate at zero, in which case no pacing is applied.
+ *
+ * The pacer has no timer of its own. When it holds back transmission it
+ * reports the time at which it will allow it again through
+ * ossl_quic_pacer_get_wakeup_deadline(), which the caller must fold into its
+ * tick deadline.
+ */
+struct quic_pacer_st {
+    /* Internal data; use the ossl_quic_pacer functions. */
+    const OSSL_CC_METHOD    *cc_method;
+    OSSL_CC_DATA            *cc_data;
+    OSSL_TIME               (*now)(void *arg);
+    void                    *now_arg;
+
+    /* Bound to OSSL_CC_OPTION_CUR_PACING_RATE; bytes per second. */
+    uint64_t                rate;
+
+    /* Bucket contents in bytes, negative after sending beyond the budget. */
+    int64_t                 tokens;
+    OSSL_TIME               last_refill;
+};
+
+/*
+ * Initialises the pacer for use with the given congestion controller and
+ * binds its pacing rate diagnostic. Returns 1 on success and 0 on failure.
+ */
+int ossl_quic_pacer_init(QUIC_PACER *pacer,
+                         const OSSL_CC_METHOD *cc_method,
+                         OSSL_CC_DATA *cc_data,
+                         OSSL_TIME (*now)(void *arg),
+                         void *now_arg);
+
+/* Unbinds the pacer from its congestion controller. */
+void ossl_quic_pacer_cleanup(QUIC_PACER *pacer);
+
+/*
+ * Switches the pacer to a different congestion controller. The old one is
+ * unbound and must still be valid. Returns 1 on success and 0 on failure.
+ */
+int ossl_quic_pacer_set_cc_method(QUIC_PACER *pacer,
+                                  const OSSL_CC_METHOD *cc_method,
+                                  OSSL_CC_DATA *cc_data);
+
+/* Returns the current pacing rate in bytes per second, or 0 if unpaced. */
+uint64_t ossl_quic_pacer_get_rate(const QUIC_PACER *pacer);
+
+/*
+ * Returns the number of bytes which can be sent now, as for the
+ * get_tx_allowance method of the congestion controller but also taking the
+ * pacing rate into account. Returns 0 if nothing can be sent at this time.
+ */
+uint64_t ossl_quic_pacer_get_tx_allowance(QUIC_PACER *pacer);
+
+/*
+ * Returns the time at which ossl_quic_pacer_get_tx_allowance() might return a
+ * higher value than it does now, as for the get_wakeup_deadline method of the
+ * congestion controller.
+ */
+OSSL_TIME ossl_quic_pacer_get_wakeup_deadline(QUIC_PACER *pacer);
+
+/*
+ * Informs the pacer that num_bytes counting towards the bytes in flight have
+ * been sent. The congestion controller must be informed separately.
+ */
+void ossl_quic_pacer_on_data_sent(QUIC_PACER *pacer, uint64_t num_bytes);
+
+# endif
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -9,6 +9,7 @@
 #ifndef OSSL_QUIC_PORT_H
 # define OSSL_QUIC_PORT_H
 
+# include <limits.h>
 # include <openssl/ssl.h>
 # include "internal/quic_types.h"
 # include "internal/quic_reactor.h"
@@ -54,6 +55,13 @@ typedef struct quic_port_args_st {
      * for a single connection, so a zero-length local CID can be used.
      */
     int             is_multi_conn;
+
+    /*
+     * If 1, datagrams are sent and received in batches using UDP segmentation
+     * offload (GSO and GRO) where the network BIOs support it. Only servers
+     * send with GSO.
+     */
+    int             use_seg_offload;
 } QUIC_PORT_ARGS;
 
 /* Only QUIC_ENGINE should use this function. */
@@ -76,6 +84,63 @@ QUIC_CHANNEL *ossl_quic_port_create_outgoing(QUIC_PORT *port, SSL *tls);
  */
 QUIC_CHANNEL *ossl_quic_port_create_incoming(QUIC_PORT *port, SSL *tls);
 
+/*
+ * Connection ID Steering
+ * ======================
+ *
+ * Several ports, each typically driven by its own engine on its own thread,
+ * may share a UDP port by means of SO_REUSEPORT sockets. The kernel spreads
+ * datagrams over the sockets by 4-tuple, so a packet may be received by a
+ * worker which does not own the connection, for example after the peer's
+ * address changed. To allow such packets to reach their connection, each
+ * worker is given a distinct steering ID which is embedded in all LCIDs it
+ * issues (see ossl_quic_lcidm_set_steering()).
+ *
+ * When a packet other than an Initial or 0-RTT packet is received whose DCID
+ * is not known locally but carries the steering ID of another worker, it is
+ * handed to the forward callback with the owning worker's ID as steer_id, and
+ * the owner should pass it to ossl_quic_port_inject_forwarded(). Likewise, a
+ * new connection attempt which this port has no capacity to accept is handed
+ * to the forward callback with a steer_id of QUIC_PORT_STEER_ANY, so that the
+ * application may pass it to any worker which can accept it. Since the Initial
+ * packets of a handshake all arrive on the same socket, the application should
+ * pass all such packets from a given peer to the same worker. In both cases
+ * the callback must copy the data if it needs to retain it; it is called with
+ * the engine mutex held and must not call back into this port.
+ *
+ * Forwarded packets are never forwarded again.
+ */
+#define QUIC_PORT_STEER_ANY     UINT_MAX
+
+typedef void (ossl_quic_port_forward_cb)(const unsigned char *data,
+                                         size_t data_len,
+                                         const BIO_ADDR *peer,
+                                         const BIO_ADDR *local,
+                                         unsigned int steer_id,
+                                         void *arg);
+
+/*
+ * Configures this port as the worker with the given steering ID among up to
+ * 2**steer_bits workers sharing a UDP port. Must be called before any
+ * connection is established on the port. Returns 1 on success and 0 on
+ * failure.
+ */
+int ossl_quic_port_set_steering(QUIC_PORT *port,
+                                unsigned int steer_bits,
+                                unsigned int steer_id,
+                                ossl_quic_port_forward_cb *cb,
+                                void *cb_arg);
+
+/*
+ * Processes a datagram forwarded by another worker as though it had been
+ * received on this port. Returns 1 on success and 0 on failure.
+ */
+int ossl_quic_port_inject_forwarded(QUIC_PORT *port,
+                                    const unsigned char *data,
+                                    size_t data_len,
+                                    const BIO_ADDR *peer,
+                                    const BIO_ADDR *local);
+
 /*
  * Queries and Accessors
  * =====================
@@ -1,5 +1,5 @@
 /*
- * Copyright 2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -17,6 +17,7 @@ typedef struct quic_channel_st QUIC_CHANNEL;
 typedef struct quic_tls_st QUIC_TLS;
 typedef struct quic_txpim_st QUIC_TXPIM;
 typedef struct quic_fifd_st QUIC_FIFD;
+typedef struct quic_pacer_st QUIC_PACER;
 typedef struct quic_cfq_st QUIC_CFQ;
 typedef struct ossl_quic_tx_packetiser_st OSSL_QUIC_TX_PACKETISER;
 typedef struct ossl_ackm_st OSSL_ACKM;
@@ -52,6 +52,12 @@ typedef struct ossl_qtx_args_st {
     /* Callback returning QLOG instance to use, or NULL. */
     QLOG           *(*get_qlog_cb)(void *arg);
     void           *get_qlog_cb_arg;
+
+    /*
+     * If 1, datagrams of the same size queued for the same destination are
+     * sent as a single buffer using UDP GSO when the BIO supports it.
+     */
+    int             use_gso;
 } OSSL_QTX_ARGS;
 
 /* Instantiates a new QTX. */
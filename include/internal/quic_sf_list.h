@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -49,6 +49,8 @@ typedef struct sframe_list_st {
     uint64_t offset;
     /* Is head locked ? */
     int head_locked;
+    /* Data before this offset is pinned, see ossl_sframe_list_pin(). */
+    uint64_t pinned_end;
     /* Cleanse data on release? */
     int cleanse;
 } SFRAME_LIST;
@@ -123,6 +125,22 @@ int ossl_sframe_list_lock_head(SFRAME_LIST *fl, UINT_RANGE *range,
  */
 int ossl_sframe_list_is_head_locked(SFRAME_LIST *fl);
 
+/*
+ * Pins the data from the current read offset up to the offset end
+ * (exclusive), so that pointers to it obtained by ossl_sframe_list_peek()
+ * remain valid until the next call to ossl_sframe_list_drop_frames(), which
+ * also unpins the data. While data is pinned, frames holding it are neither
+ * replaced by overlapping frames inserted later nor moved by
+ * ossl_sframe_list_move_data().
+ */
+void ossl_sframe_list_pin(SFRAME_LIST *fl, uint64_t end);
+
+/*
+ * Returns whether any data is pinned by a previous ossl_sframe_list_pin()
+ * call.
+ */
+int ossl_sframe_list_is_pinned(SFRAME_LIST *fl);
+
 /*
  * Callback function type to write stream frame data to some
  * side storage before the packet containing the frame data
@@ -1,5 +1,5 @@
 /*
-* Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+* Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
 *
 * Licensed under the Apache License 2.0 (the "License").  You may not use
 * this file except in compliance with the License.  You can obtain a copy
@@ -89,8 +89,10 @@ void ossl_quic_sstream_free(QUIC_SSTREAM *qss);
  * function returns successfully, it is updated to the number of iov entries
  * which have been written.
  *
- * The stream data may be split across up to two IOVs due to internal ring
- * buffer organisation. The sum of the lengths of the IOVs and the value written
+ * The stream data may be split across several IOVs due to internal ring
+ * buffer organisation, or because some of it was appended by reference using
+ * ossl_quic_sstream_append_ref(); if there are not enough IOVs for the whole
+ * range, hdr->len is reduced to the data which fits. The sum of the lengths of the IOVs and the value written
  * to hdr->len will always match. If the caller decides to send less than
  * hdr->len of stream data, it must adjust the IOVs accordingly. This may be
  * done by updating hdr->len and then calling the utility function
@@ -115,8 +117,8 @@ void ossl_quic_sstream_free(QUIC_SSTREAM *qss);
  * available stream frames and batch their calls to ossl_quic_sstream_mark_transmitted at
  * a later time.
  *
- * On success, this function will never write *num_iov with a value other than
- * 0, 1 or 2. A *num_iov value of 0 can only occurs when hdr->is_fin is set (for
+ * On success, this function will never write *num_iov with a value greater
+ * than its value at call time. A *num_iov value of 0 can only occurs when hdr->is_fin is set (for
  * example, when a stream is closed after all existing data has been sent, and
  * without sending any more data); otherwise the function returns 0 as there is
  * nothing useful to report.
@@ -241,6 +243,34 @@ int ossl_quic_sstream_append(QUIC_SSTREAM *qss,
                              size_t buf_len,
                              size_t *consumed);
 
+/*
+ * Callback used to give back a buffer appended with
+ * ossl_quic_sstream_append_ref(). buf, buf_len and arg are the values which
+ * were passed to that function.
+ */
+typedef void (ossl_quic_sstream_release_cb)(const void *buf, size_t buf_len,
+                                            void *arg);
+
+/*
+ * (Front end use.) Appends user data to the stream without copying it. Unlike
+ * ossl_quic_sstream_append(), the data is appended in full or not at all, and
+ * does not consume any space in the internal ring buffer. The buffer must
+ * remain valid and unchanged until release_cb is called, which happens once
+ * all of the data has been acknowledged by the peer, or when the QUIC_SSTREAM
+ * is freed, whichever comes first. release_cb is called from within whichever
+ * call processes the acknowledgement and may be NULL.
+ *
+ * If buf_len is 0, release_cb is called immediately.
+ *
+ * Returns 1 on success or 0 on failure, in which case release_cb is not
+ * called and the caller keeps ownership of buf.
+ */
+int ossl_quic_sstream_append_ref(QUIC_SSTREAM *qss,
+                                 const unsigned char *buf,
+                                 size_t buf_len,
+                                 ossl_quic_sstream_release_cb *release_cb,
+                                 void *release_arg);
+
 /*
  * Marks a stream as finished. ossl_quic_sstream_append() may not be called anymore
  * after calling this.
@@ -399,6 +429,34 @@ int ossl_quic_rstream_get_record(QUIC_RSTREAM *qrs,
  */
 int ossl_quic_rstream_release_record(QUIC_RSTREAM *qrs, size_t read_len);
 
+/*
+ * Fills up to `num_segs` entries of `segs` with pointers to the contiguous
+ * stream data which is ready to be read, in order, without copying it, and
+ * sets `segs_out` to the number of entries filled and `readbytes` to the total
+ * length of the data. `fin` is set to 1 if the data reaches the end of the
+ * stream and to 0 otherwise.
+ *
+ * The data is pinned: the pointers remain valid until
+ * ossl_quic_rstream_release_segments() is called, even if more data is
+ * received in the meantime. Calling this function again before then pins the
+ * data again, possibly with more data appended.
+ * Returns 1 on success, 0 on error.
+ */
+int ossl_quic_rstream_peek_segments(QUIC_RSTREAM *qrs, SSL_READ_SEGMENT *segs,
+                                    size_t num_segs, size_t *segs_out,
+                                    size_t *readbytes, int *fin);
+
+/*
+ * Marks the first `len` bytes of the data pinned by
+ * ossl_quic_rstream_peek_segments() as read and unpins all of it. `len` may
+ * be 0, in which case the data is only unpinned. `fin` is set to 1 if all of
+ * the data of the stream has now been read and to 0 otherwise.
+ * Returns 1 on success, 0 on error, including if `len` is larger than the
+ * amount of pinned data.
+ */
+int ossl_quic_rstream_release_segments(QUIC_RSTREAM *qrs, size_t len,
+                                       int *fin);
+
 /*
  * Moves received frame data from decrypted packets to ring buffer.
  * This should be called when there are too many decrypted packets allocated.
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -14,6 +14,7 @@
 # include <openssl/bio.h>
 # include "internal/quic_stream.h"
 # include "internal/quic_channel.h"
+# include "internal/quic_port.h"
 # include "internal/statem.h"
 # include "internal/time.h"
 
@@ -43,6 +44,8 @@ typedef struct quic_tserver_args_st {
     void *now_cb_arg;
     const unsigned char *alpn;
     size_t alpnlen;
+    /* If 1, use UDP GSO and GRO where the network BIOs support it */
+    int use_seg_offload;
 } QUIC_TSERVER_ARGS;
 
 QUIC_TSERVER *ossl_quic_tserver_new(const QUIC_TSERVER_ARGS *args,
@@ -195,6 +198,24 @@ void ossl_quic_tserver_set_msg_callback(QUIC_TSERVER *srv,
                                                   SSL *ssl, void *arg),
                                         void *arg);
 
+/*
+ * Configures the server as one of several workers sharing a UDP port. See
+ * ossl_quic_port_set_steering(). Must be called before a connection is
+ * accepted.
+ */
+int ossl_quic_tserver_set_steering(QUIC_TSERVER *srv,
+                                   unsigned int steer_bits,
+                                   unsigned int steer_id,
+                                   ossl_quic_port_forward_cb *cb,
+                                   void *cb_arg);
+
+/* Processes a datagram forwarded to this server by another worker. */
+int ossl_quic_tserver_inject_forwarded(QUIC_TSERVER *srv,
+                                       const unsigned char *data,
+                                       size_t data_len,
+                                       const BIO_ADDR *peer,
+                                       const BIO_ADDR *local);
+
 /*
  * This is similar to ossl_quic_conn_get_channel; it should be used for test
  * instrumentation only and not to bypass QUIC_TSERVER for 'normal' operations.
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -203,6 +203,15 @@ void ossl_quic_tx_packetiser_set_msg_callback_arg(OSSL_QUIC_TX_PACKETISER *txp,
 QUIC_PN ossl_quic_tx_packetiser_get_next_pn(OSSL_QUIC_TX_PACKETISER *txp,
                                             uint32_t pn_space);
 
+/*
+ * Replaces the congestion controller consulted by the TXP. As for the ACKM,
+ * this must only be done before any packet has been sent. Returns 1 on success
+ * and 0 on failure.
+ */
+int ossl_quic_tx_packetiser_set_cc_method(OSSL_QUIC_TX_PACKETISER *txp,
+                                          const OSSL_CC_METHOD *cc_method,
+                                          OSSL_CC_DATA *cc_data);
+
 /*
  * Sets a callback which is called whenever TXP sends an ACK frame. The callee
  * must not modify the ACK frame data. Can be used to snoop on PNs being ACKed.
@@ -60,13 +60,17 @@ typedef struct ossl_record_layer_st OSSL_RECORD_LAYER;
 /*
  * Template for creating a record. A record consists of the |type| of data it
  * will contain (e.g. alert, handshake, application data, etc) along with a
- * buffer of payload data in |buf| of length |buflen|.
+ * buffer of payload data in |buf| of length |buflen|. If |iov| is not NULL then
+ * |buf| is NULL and the payload instead starts |iovoff| bytes into the segment
+ * |iov| and continues through the following segments.
  */
 struct ossl_record_template_st {
     unsigned char type;
     unsigned int version;
     const unsigned char *buf;
     size_t buflen;
+    const SSL_IOVEC *iov;
+    size_t iovoff;
 };
 
 typedef struct ossl_record_template_st OSSL_RECORD_TEMPLATE;
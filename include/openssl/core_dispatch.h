@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -748,6 +748,8 @@ OSSL_CORE_MAKE_FUNC(const OSSL_PARAM *, keyexch_gettable_ctx_params,
 # define OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_INIT    30
 # define OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_UPDATE  31
 # define OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_FINAL   32
+# define OSSL_FUNC_SIGNATURE_SIGN_BATCH             33
+# define OSSL_FUNC_SIGNATURE_VERIFY_BATCH           34
 
 OSSL_CORE_MAKE_FUNC(void *, signature_newctx, (void *provctx,
                                                const char *propq))
@@ -757,6 +759,10 @@ OSSL_CORE_MAKE_FUNC(int, signature_sign, (void *ctx,  unsigned char *sig,
                                           size_t *siglen, size_t sigsize,
                                           const unsigned char *tbs,
                                           size_t tbslen))
+OSSL_CORE_MAKE_FUNC(int, signature_sign_batch,
+                    (void *ctx, size_t num, unsigned char *const *sig,
+                     size_t *siglen, size_t sigsize,
+                     const unsigned char *const *tbs, const size_t *tbslen))
 OSSL_CORE_MAKE_FUNC(int, signature_sign_message_init,
                     (void *ctx, void *provkey, const OSSL_PARAM params[]))
 OSSL_CORE_MAKE_FUNC(int, signature_sign_message_update,
@@ -771,6 +777,10 @@ OSSL_CORE_MAKE_FUNC(int, signature_verify, (void *ctx,
                                             size_t siglen,
                                             const unsigned char *tbs,
                                             size_t tbslen))
+OSSL_CORE_MAKE_FUNC(int, signature_verify_batch,
+                    (void *ctx, size_t num, const unsigned char *const *sig,
+                     const size_t *siglen, const unsigned char *const *tbs,
+                     const size_t *tbslen, int *results))
 OSSL_CORE_MAKE_FUNC(int, signature_verify_message_init,
                     (void *ctx, void *provkey, const OSSL_PARAM params[]))
 OSSL_CORE_MAKE_FUNC(int, signature_verify_message_update,
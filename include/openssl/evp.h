@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -1935,6 +1935,10 @@ int EVP_PKEY_sign_init_ex2(EVP_PKEY_CTX *ctx,
 int EVP_PKEY_sign(EVP_PKEY_CTX *ctx,
                   unsigned char *sig, size_t *siglen,
                   const unsigned char *tbs, size_t tbslen);
+int EVP_PKEY_sign_batch(EVP_PKEY_CTX *ctx, size_t num,
+                        unsigned char *const *sig, size_t *siglen,
+                        size_t sigsize, const unsigned char *const *tbs,
+                        const size_t *tbslen);
 int EVP_PKEY_sign_message_init(EVP_PKEY_CTX *ctx,
                                EVP_SIGNATURE *algo, const OSSL_PARAM params[]);
 int EVP_PKEY_sign_message_update(EVP_PKEY_CTX *ctx,
@@ -1948,6 +1952,11 @@ int EVP_PKEY_verify_init_ex2(EVP_PKEY_CTX *ctx,
 int EVP_PKEY_verify(EVP_PKEY_CTX *ctx,
                     const unsigned char *sig, size_t siglen,
                     const unsigned char *tbs, size_t tbslen);
+int EVP_PKEY_verify_batch(EVP_PKEY_CTX *ctx, size_t num,
+                          const unsigned char *const *sig,
+                          const size_t *siglen,
+                          const unsigned char *const *tbs,
+                          const size_t *tbslen, int *results);
 int EVP_PKEY_verify_message_init(EVP_PKEY_CTX *ctx,
                                  EVP_SIGNATURE *algo, const OSSL_PARAM params[]);
 int EVP_PKEY_verify_message_update(EVP_PKEY_CTX *ctx,
@@ -30,6 +30,7 @@ const PROV_CIPHER_HW_AES_HMAC_SHA *ossl_prov_cipher_hw_aes_cbc_hmac_sha1(void)
 
 # include <openssl/rand.h>
 # include "crypto/evp.h"
+# include "crypto/sha.h"
 # include "internal/constant_time.h"
 
 void sha1_block_data_order(void *c, const void *p, size_t len);
@@ -99,15 +100,6 @@ static void sha1_update(SHA_CTX *c, const void *data, size_t len)
 
 # if !defined(OPENSSL_NO_MULTIBLOCK)
 
-typedef struct {
-    unsigned int A[8], B[8], C[8], D[8], E[8];
-} SHA1_MB_CTX;
-
-typedef struct {
-    const unsigned char *ptr;
-    int blocks;
-} HASH_DESC;
-
 typedef struct {
     const unsigned char *inp;
     unsigned char *out;
@@ -115,7 +107,6 @@ typedef struct {
     u64 iv[2];
 } CIPH_DESC;
 
-void sha1_multi_block(SHA1_MB_CTX *, const HASH_DESC *, int);
 void aesni_multi_cbc_encrypt(CIPH_DESC *, void *, int);
 
 static size_t tls1_multi_block_encrypt(void *vctx,
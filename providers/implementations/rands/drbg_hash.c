@@ -1,5 +1,5 @@
 /*
- * Copyright 2011-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2011-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -16,13 +16,21 @@
 #include <openssl/rand.h>
 #include <openssl/core_dispatch.h>
 #include <openssl/proverr.h>
+#include <openssl/provider.h>
 #include "internal/thread_once.h"
+#include "crypto/sha.h"
 #include "prov/providercommon.h"
 #include "prov/provider_ctx.h"
 #include "prov/provider_util.h"
 #include "prov/implementations.h"
 #include "drbg_local.h"
 
+#if defined(SHA256_ASM) && !defined(OPENSSL_NO_MULTIBLOCK) \
+    && (defined(__x86_64) || defined(__x86_64__) \
+        || defined(_M_AMD64) || defined(_M_X64))
+# define HASH_GEN_SHA256_MB
+#endif
+
 static OSSL_FUNC_rand_newctx_fn drbg_hash_new_wrapper;
 static OSSL_FUNC_rand_freectx_fn drbg_hash_free;
 static OSSL_FUNC_rand_instantiate_fn drbg_hash_instantiate_wrapper;
@@ -55,6 +63,10 @@ typedef struct rand_drbg_hash_st {
     unsigned char C[HASH_PRNG_MAX_SEEDLEN];
     /* Temporary value storage: should always exceed max digest length */
     unsigned char vtmp[HASH_PRNG_MAX_SEEDLEN];
+#ifdef HASH_GEN_SHA256_MB
+    /* Set if the digest is the built in SHA2-256, see hash_gen_sha256_mb() */
+    int sha256_mb;
+#endif
 } PROV_DRBG_HASH;
 
 /*
@@ -188,6 +200,97 @@ static int add_hash_to_v(PROV_DRBG *drbg, unsigned char inbyte,
            && add_bytes(drbg, hash->V, hash->vtmp, hash->blocklen);
 }
 
+#ifdef HASH_GEN_SHA256_MB
+
+# define SHA256_MB_LANES 8
+
+/*
+ * With SHA2-256 the seedlen is 440 bits, so that each of the values of data
+ * hashed by Hashgen() fits a single padded 64 byte block. Up to eight of
+ * these blocks are hashed side by side with the multi-buffer SHA-256 code
+ * used for TLS multiblock, which processes them in parallel SIMD lanes (or
+ * interleaves them with the SHA extensions) and saves the per digest cost
+ * of going through EVP. Only requests of at least four digests are worth it,
+ * the remainder is left to the caller.
+ *
+ * Returns the number of bytes generated.
+ */
+static size_t hash_gen_sha256_mb(PROV_DRBG *drbg, unsigned char *out,
+                                 size_t outlen)
+{
+    PROV_DRBG_HASH *hash = (PROV_DRBG_HASH *)drbg->data;
+    unsigned char storage[sizeof(SHA256_MB_CTX) + 32];
+    unsigned char blocks[SHA256_MB_LANES][SHA256_CBLOCK];
+    HASH_DESC desc[SHA256_MB_LANES];
+    SHA256_MB_CTX *mctx;
+    unsigned int *h;
+    unsigned char one = 1;
+    size_t done = 0, lanes, i, j;
+
+    mctx = (SHA256_MB_CTX *)(storage + 32 - ((size_t)storage % 32));
+    while (outlen - done >= 4 * SHA256_DIGEST_LENGTH) {
+        lanes = (outlen - done) / SHA256_DIGEST_LENGTH;
+        if (lanes > SHA256_MB_LANES)
+            lanes = SHA256_MB_LANES;
+
+        for (i = 0; i < SHA256_MB_LANES; i++) {
+            desc[i].ptr = blocks[i];
+            desc[i].blocks = i < lanes;
+            if (i >= lanes)
+                continue;
+            memcpy(blocks[i], hash->vtmp, HASH_PRNG_SMALL_SEEDLEN);
+            blocks[i][HASH_PRNG_SMALL_SEEDLEN] = 0x80;
+            memset(blocks[i] + HASH_PRNG_SMALL_SEEDLEN + 1, 0,
+                   SHA256_CBLOCK - HASH_PRNG_SMALL_SEEDLEN - 1 - 2);
+            /* The length in bits, 440, big endian */
+            blocks[i][SHA256_CBLOCK - 2] = (HASH_PRNG_SMALL_SEEDLEN * 8) >> 8;
+            blocks[i][SHA256_CBLOCK - 1] = (HASH_PRNG_SMALL_SEEDLEN * 8) & 0xff;
+            add_bytes(drbg, hash->vtmp, &one, 1);
+
+            mctx->A[i] = 0x6a09e667UL;
+            mctx->B[i] = 0xbb67ae85UL;
+            mctx->C[i] = 0x3c6ef372UL;
+            mctx->D[i] = 0xa54ff53aUL;
+            mctx->E[i] = 0x510e527fUL;
+            mctx->F[i] = 0x9b05688cUL;
+            mctx->G[i] = 0x1f83d9abUL;
+            mctx->H[i] = 0x5be0cd19UL;
+        }
+
+        sha256_multi_block(mctx, desc, lanes > 4 ? 2 : 1);
+
+        for (i = 0; i < lanes; i++) {
+            for (j = 0, h = &mctx->A[i]; j < 8; j++, h += SHA256_MB_LANES) {
+                *out++ = (unsigned char)(*h >> 24);
+                *out++ = (unsigned char)(*h >> 16);
+                *out++ = (unsigned char)(*h >> 8);
+                *out++ = (unsigned char)*h;
+            }
+        }
+        done += lanes * SHA256_DIGEST_LENGTH;
+    }
+    OPENSSL_cleanse(blocks, sizeof(blocks));
+    OPENSSL_cleanse(storage, sizeof(storage));
+    return done;
+}
+
+/*
+ * The multi-buffer code computes SHA2-256 itself, which is only appropriate
+ * when the digest comes from one of our own providers.
+ */
+static int hash_gen_sha256_mb_usable(const EVP_MD *md)
+{
+# ifndef FIPS_MODULE
+    const char *name = OSSL_PROVIDER_get0_name(EVP_MD_get0_provider(md));
+
+    if (name == NULL
+        || (strcmp(name, "default") != 0 && strcmp(name, "fips") != 0))
+        return 0;
+# endif
+    return EVP_MD_is_a(md, "SHA2-256");
+}
+#endif
+
 /*
  * The Hashgen() as listed in SP800-90Ar1 10.1.1.4 Hash_DRBG_Generate_Process.
  *
@@ -214,6 +317,16 @@ static int hash_gen(PROV_DRBG *drbg, unsigned char *out, size_t outlen)
     if (outlen == 0)
         return 1;
     memcpy(hash->vtmp, hash->V, drbg->seedlen);
+#ifdef HASH_GEN_SHA256_MB
+    if (hash->sha256_mb) {
+        size_t done = hash_gen_sha256_mb(drbg, out, outlen);
+
+        out += done;
+        outlen -= done;
+        if (outlen == 0)
+            return 1;
+    }
+#endif
     for (;;) {
         if (!EVP_DigestInit_ex(hash->ctx, ossl_prov_digest_md(&hash->digest),
                                NULL)
@@ -537,6 +650,10 @@ static int drbg_hash_set_ctx_params_locked(void *vctx, const OSSL_PARAM params[]
             ctx->seedlen = HASH_PRNG_MAX_SEEDLEN;
         else
             ctx->seedlen = HASH_PRNG_SMALL_SEEDLEN;
+#ifdef HASH_GEN_SHA256_MB
+        hash->sha256_mb = ctx->seedlen == HASH_PRNG_SMALL_SEEDLEN
+                          && hash_gen_sha256_mb_usable(md);
+#endif
 
         ctx->min_entropylen = ctx->strength / 8;
         ctx->min_noncelen = ctx->min_entropylen / 2;
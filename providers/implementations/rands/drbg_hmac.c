@@ -207,6 +207,7 @@ int ossl_drbg_hmac_generate(PROV_DRBG_HMAC *hmac,
 {
     EVP_MAC_CTX *ctx = hmac->ctx;
     const unsigned char *temp = hmac->V;
+    const unsigned char *key = hmac->K;
 
     /* (Step 2) if adin != NULL then (K,V) = HMAC_DRBG_Update(adin, K, V) */
     if (adin != NULL
@@ -220,11 +221,16 @@ int ossl_drbg_hmac_generate(PROV_DRBG_HMAC *hmac,
      *                 V = HMAC(K, V)
      *                 temp = temp || V
      *             }
+     *
+     * K does not change within the loop, so the key is only set on the first
+     * iteration and later ones reinitialise the MAC from the saved key
+     * schedule instead of hashing the padded key again.
      */
     for (;;) {
-        if (!EVP_MAC_init(ctx, hmac->K, hmac->blocklen, NULL)
+        if (!EVP_MAC_init(ctx, key, hmac->blocklen, NULL)
             || !EVP_MAC_update(ctx, temp, hmac->blocklen))
             return 0;
+        key = NULL;
 
         if (outlen > hmac->blocklen) {
             if (!EVP_MAC_final(ctx, out, NULL, outlen))
@@ -1,5 +1,5 @@
 /*
- * Copyright 2020-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2020-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -40,6 +40,7 @@ static OSSL_FUNC_signature_sign_fn ecdsa_sign;
 static OSSL_FUNC_signature_sign_message_update_fn ecdsa_signverify_message_update;
 static OSSL_FUNC_signature_sign_message_final_fn ecdsa_sign_message_final;
 static OSSL_FUNC_signature_verify_fn ecdsa_verify;
+static OSSL_FUNC_signature_verify_batch_fn ecdsa_verify_batch;
 static OSSL_FUNC_signature_verify_message_update_fn ecdsa_signverify_message_update;
 static OSSL_FUNC_signature_verify_message_final_fn ecdsa_verify_message_final;
 static OSSL_FUNC_signature_digest_sign_init_fn ecdsa_digest_sign_init;
@@ -490,6 +491,68 @@ static int ecdsa_verify(void *vctx,
     return ecdsa_verify_directly(ctx, sig, siglen, tbs, tbslen);
 }
 
+/*
+ * Verify a batch of signatures.  When verifying messages, each tbs is
+ * digested first, and the digests are verified together.
+ */
+static int ecdsa_verify_batch(void *vctx, size_t num,
+                              const unsigned char *const *sig,
+                              const size_t *siglen,
+                              const unsigned char *const *tbs,
+                              const size_t *tbslen, int *results)
+{
+    PROV_ECDSA_CTX *ctx = (PROV_ECDSA_CTX *)vctx;
+    const unsigned char **dgst = NULL;
+    size_t *dgstlen = NULL;
+    unsigned char *digests = NULL;
+    size_t i;
+    unsigned int dlen;
+    int ret = -1;
+
+    if (!ossl_prov_is_running() || ctx == NULL)
+        return -1;
+
+    if (ctx->operation != EVP_PKEY_OP_VERIFYMSG) {
+        if (ctx->mdsize != 0 && results == NULL)
+            for (i = 0; i < num; i++)
+                if (tbslen[i] != ctx->mdsize)
+                    return 0;
+        ret = ossl_ecdsa_verify_batch(num, tbs, tbslen, sig, siglen, results,
+                                      ctx->ec);
+        if (ret >= 0 && ctx->mdsize != 0)
+            for (i = 0; i < num; i++)
+                if (tbslen[i] != ctx->mdsize) {
+                    results[i] = 0;
+                    ret = 0;
+                }
+        return ret;
+    }
+
+    if (ctx->md == NULL || num > SIZE_MAX / ctx->mdsize) {
+        ERR_raise(ERR_LIB_PROV, ERR_R_PASSED_INVALID_ARGUMENT);
+        return -1;
+    }
+    dgst = OPENSSL_malloc(num * sizeof(*dgst));
+    dgstlen = OPENSSL_malloc(num * sizeof(*dgstlen));
+    digests = OPENSSL_malloc(num * ctx->mdsize);
+    if (dgst == NULL || dgstlen == NULL || digests == NULL)
+        goto end;
+    for (i = 0; i < num; i++) {
+        dgst[i] = digests + i * ctx->mdsize;
+        if (!EVP_Digest(tbs[i], tbslen[i], digests + i * ctx->mdsize, &dlen,
+                        ctx->md, NULL))
+            goto end;
+        dgstlen[i] = dlen;
+    }
+    ret = ossl_ecdsa_verify_batch(num, dgst, dgstlen, sig, siglen, results,
+                                  ctx->ec);
+ end:
+    OPENSSL_free(dgst);
+    OPENSSL_free(dgstlen);
+    OPENSSL_free(digests);
+    return ret;
+}
+
 /* DigestSign/DigestVerify wrappers */
 
 static int ecdsa_digest_signverify_init(void *vctx, const char *mdname,
@@ -853,6 +916,7 @@ const OSSL_DISPATCH ossl_ecdsa_signature_functions[] = {
     { OSSL_FUNC_SIGNATURE_SIGN, (void (*)(void))ecdsa_sign },
     { OSSL_FUNC_SIGNATURE_VERIFY_INIT, (void (*)(void))ecdsa_verify_init },
     { OSSL_FUNC_SIGNATURE_VERIFY, (void (*)(void))ecdsa_verify },
+    { OSSL_FUNC_SIGNATURE_VERIFY_BATCH, (void (*)(void))ecdsa_verify_batch },
     { OSSL_FUNC_SIGNATURE_DIGEST_SIGN_INIT,
       (void (*)(void))ecdsa_digest_sign_init },
     { OSSL_FUNC_SIGNATURE_DIGEST_SIGN_UPDATE,
@@ -1060,6 +1124,8 @@ static int ecdsa_sigalg_set_ctx_params(void *vctx, const OSSL_PARAM params[])
           (void (*)(void))ecdsa_##md##_verify_init },                   \
         { OSSL_FUNC_SIGNATURE_VERIFY,                                   \
           (void (*)(void))ecdsa_verify },                               \
+        { OSSL_FUNC_SIGNATURE_VERIFY_BATCH,                             \
+          (void (*)(void))ecdsa_verify_batch },                         \
         { OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_INIT,                      \
           (void (*)(void))ecdsa_##md##_verify_message_init },           \
         { OSSL_FUNC_SIGNATURE_VERIFY_MESSAGE_UPDATE,                    \
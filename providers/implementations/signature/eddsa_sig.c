@@ -1,5 +1,5 @@
 /*
- * Copyright 2020-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2020-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -72,6 +72,8 @@ static OSSL_FUNC_signature_sign_fn ed25519_sign;
 static OSSL_FUNC_signature_sign_fn ed448_sign;
 static OSSL_FUNC_signature_verify_fn ed25519_verify;
 static OSSL_FUNC_signature_verify_fn ed448_verify;
+static OSSL_FUNC_signature_verify_batch_fn ed25519_verify_batch;
+static OSSL_FUNC_signature_verify_batch_fn ed448_verify_batch;
 static OSSL_FUNC_signature_digest_sign_init_fn ed25519_digest_signverify_init;
 static OSSL_FUNC_signature_digest_sign_init_fn ed448_digest_signverify_init;
 static OSSL_FUNC_signature_digest_sign_fn ed25519_digest_sign;
@@ -664,6 +666,54 @@ static int ed448_verify(void *vpeddsactx,
                              peddsactx->prehash_flag, edkey->propq);
 }
 
+/*
+ * Verifies num signatures one at a time with verify(), for
+ * OSSL_FUNC_SIGNATURE_VERIFY_BATCH.  A combined check of several Ed25519
+ * signatures would need the cofactored verification equation, which accepts
+ * signatures that the strict one used by verify() rejects, so there is nothing
+ * better to do.  This still allows batches after a message verify init.
+ */
+static int eddsa_verify_each(void *vpeddsactx,
+                             OSSL_FUNC_signature_verify_fn *verify, size_t num,
+                             const unsigned char *const *sig,
+                             const size_t *siglen,
+                             const unsigned char *const *tbs,
+                             const size_t *tbslen, int *results)
+{
+    size_t i;
+    int valid, ret = 1;
+
+    for (i = 0; i < num; i++) {
+        valid = verify(vpeddsactx, sig[i], siglen[i], tbs[i], tbslen[i]) == 1;
+        if (results == NULL && !valid)
+            return 0;
+        if (results != NULL)
+            results[i] = valid;
+        ret = ret && valid;
+    }
+    return ret;
+}
+
+static int ed25519_verify_batch(void *vpeddsactx, size_t num,
+                                const unsigned char *const *sig,
+                                const size_t *siglen,
+                                const unsigned char *const *tbs,
+                                const size_t *tbslen, int *results)
+{
+    return eddsa_verify_each(vpeddsactx, ed25519_verify, num, sig, siglen,
+                             tbs, tbslen, results);
+}
+
+static int ed448_verify_batch(void *vpeddsactx, size_t num,
+                              const unsigned char *const *sig,
+                              const size_t *siglen,
+                              const unsigned char *const *tbs,
+                              const size_t *tbslen, int *results)
+{
+    return eddsa_verify_each(vpeddsactx, ed448_verify, num, sig, siglen,
+                             tbs, tbslen, results);
+}
+
 /* All digest_{sign,verify} are simple wrappers around the functions above */
 
 static int ed25519_digest_signverify_init(void *vpeddsactx, const char *mdname,
@@ -1025,6 +1075,8 @@ eddsa_settable_variant_ctx_params(ossl_unused void *vpeddsactx,
           (void (*)(void))vn##_signverify_message_init },               \
         { OSSL_FUNC_SIGNATURE_VERIFY,                                   \
           (void (*)(void))bn##_verify },                                \
+        { OSSL_FUNC_SIGNATURE_VERIFY_BATCH,                             \
+          (void (*)(void))bn##_verify_batch },                          \
         { OSSL_FUNC_SIGNATURE_FREECTX, (void (*)(void))eddsa_freectx }, \
         { OSSL_FUNC_SIGNATURE_DUPCTX, (void (*)(void))eddsa_dupctx },   \
         { OSSL_FUNC_SIGNATURE_QUERY_KEY_TYPES,                          \
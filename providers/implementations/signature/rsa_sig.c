@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -40,6 +40,7 @@ static OSSL_FUNC_signature_sign_init_fn rsa_sign_init;
 static OSSL_FUNC_signature_verify_init_fn rsa_verify_init;
 static OSSL_FUNC_signature_verify_recover_init_fn rsa_verify_recover_init;
 static OSSL_FUNC_signature_sign_fn rsa_sign;
+static OSSL_FUNC_signature_sign_batch_fn rsa_sign_batch;
 static OSSL_FUNC_signature_sign_message_update_fn rsa_signverify_message_update;
 static OSSL_FUNC_signature_sign_message_final_fn rsa_sign_message_final;
 static OSSL_FUNC_signature_verify_fn rsa_verify;
@@ -668,6 +669,40 @@ static int rsa_sign_init(void *vprsactx, void *vrsa, const OSSL_PARAM params[])
                                EVP_PKEY_OP_SIGN, "RSA Sign Init");
 }
 
+/* Check PSS restrictions */
+static int rsa_pss_check_saltlen(PROV_RSA_CTX *prsactx)
+{
+    if (!rsa_pss_restricted(prsactx))
+        return 1;
+
+    switch (prsactx->saltlen) {
+    case RSA_PSS_SALTLEN_DIGEST:
+        if (prsactx->min_saltlen > EVP_MD_get_size(prsactx->md)) {
+            ERR_raise_data(ERR_LIB_PROV,
+                           PROV_R_PSS_SALTLEN_TOO_SMALL,
+                           "minimum salt length set to %d, "
+                           "but the digest only gives %d",
+                           prsactx->min_saltlen,
+                           EVP_MD_get_size(prsactx->md));
+            return 0;
+        }
+        /* FALLTHRU */
+    default:
+        if (prsactx->saltlen >= 0
+            && prsactx->saltlen < prsactx->min_saltlen) {
+            ERR_raise_data(ERR_LIB_PROV,
+                           PROV_R_PSS_SALTLEN_TOO_SMALL,
+                           "minimum salt length set to %d, but the"
+                           "actual salt length is only set to %d",
+                           prsactx->min_saltlen,
+                           prsactx->saltlen);
+            return 0;
+        }
+        break;
+    }
+    return 1;
+}
+
 /*
  * Sign tbs without digesting it first.  This is suitable for "primitive"
  * signing and signing the digest of a message, i.e. should be used with
@@ -757,34 +792,8 @@ static int rsa_sign_directly(PROV_RSA_CTX *prsactx,
             {
                 int saltlen;
 
-                /* Check PSS restrictions */
-                if (rsa_pss_restricted(prsactx)) {
-                    switch (prsactx->saltlen) {
-                    case RSA_PSS_SALTLEN_DIGEST:
-                        if (prsactx->min_saltlen > EVP_MD_get_size(prsactx->md)) {
-                            ERR_raise_data(ERR_LIB_PROV,
-                                           PROV_R_PSS_SALTLEN_TOO_SMALL,
-                                           "minimum salt length set to %d, "
-                                           "but the digest only gives %d",
-                                           prsactx->min_saltlen,
-                                           EVP_MD_get_size(prsactx->md));
-                            return 0;
-                        }
-                        /* FALLTHRU */
-                    default:
-                        if (prsactx->saltlen >= 0
-                            && prsactx->saltlen < prsactx->min_saltlen) {
-                            ERR_raise_data(ERR_LIB_PROV,
-                                           PROV_R_PSS_SALTLEN_TOO_SMALL,
-                                           "minimum salt length set to %d, but the"
-                                           "actual salt length is only set to %d",
-                                           prsactx->min_saltlen,
-                                           prsactx->saltlen);
-                            return 0;
-                        }
-                        break;
-                    }
-                }
+                if (!rsa_pss_check_saltlen(prsactx))
+                    return 0;
                 if (!setup_tbuf(prsactx))
                     return 0;
                 saltlen = prsactx->saltlen;
@@ -911,6 +920,133 @@ static int rsa_sign(void *vprsactx, unsigned char *sig, size_t *siglen,
     return rsa_sign_directly(prsactx, sig, siglen, sigsize, tbs, tbslen);
 }
 
+/*
+ * Signs independent inputs with the same key together. With PKCS#1 v1.5 or
+ * PSS padding, or none, the private key operations are batched so that they
+ * share their setup and their fault checks, see
+ * ossl_rsa_private_encrypt_batch(). Anything else is signed one by one.
+ */
+static int rsa_sign_batch(void *vprsactx, size_t num,
+                          unsigned char *const *sig, size_t *siglen,
+                          size_t sigsize, const unsigned char *const *tbs,
+                          const size_t *tbslen)
+{
+    PROV_RSA_CTX *prsactx = (PROV_RSA_CTX *)vprsactx;
+    size_t rsasize, mdsize, i;
+    unsigned char *em = NULL;
+    const unsigned char **from = NULL;
+    int *flen = NULL, saltlen, ret = 0;
+
+    if (!ossl_prov_is_running() || prsactx == NULL)
+        return 0;
+    if (!prsactx->flag_allow_oneshot) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_ONESHOT_CALL_OUT_OF_ORDER);
+        return 0;
+    }
+    if (prsactx->operation != EVP_PKEY_OP_SIGN) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return 0;
+    }
+    if (num == 0)
+        return 1;
+
+    rsasize = RSA_size(prsactx->rsa);
+    mdsize = rsa_get_md_size(prsactx);
+    if ((mdsize != 0
+         && prsactx->pad_mode != RSA_PKCS1_PADDING
+         && prsactx->pad_mode != RSA_PKCS1_PSS_PADDING)
+        || (mdsize == 0
+            && prsactx->pad_mode != RSA_PKCS1_PADDING
+            && prsactx->pad_mode != RSA_NO_PADDING)
+#ifndef FIPS_MODULE
+        || (mdsize != 0 && EVP_MD_is_a(prsactx->md, OSSL_DIGEST_NAME_MDC2))
+#endif
+        ) {
+        for (i = 0; i < num; i++)
+            if (!rsa_sign_directly(prsactx, sig[i], &siglen[i], sigsize,
+                                   tbs[i], tbslen[i]))
+                return 0;
+        return 1;
+    }
+
+    if (sigsize < rsasize) {
+        ERR_raise_data(ERR_LIB_PROV, PROV_R_INVALID_SIGNATURE_SIZE,
+                       "is %zu, should be at least %zu", sigsize, rsasize);
+        return 0;
+    }
+    for (i = 0; i < num; i++) {
+        if (sig[i] == NULL) {
+            ERR_raise(ERR_LIB_PROV, ERR_R_PASSED_NULL_PARAMETER);
+            return 0;
+        }
+        if (mdsize != 0 ? tbslen[i] != mdsize : tbslen[i] > rsasize) {
+            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_DIGEST_LENGTH);
+            return 0;
+        }
+    }
+
+    if (mdsize != 0 && prsactx->pad_mode == RSA_PKCS1_PADDING) {
+        ret = ossl_rsa_sign_batch(prsactx->mdnid, num, tbs, tbslen, sig,
+                                  prsactx->rsa);
+    } else {
+        if (num > SIZE_MAX / rsasize) {
+            ERR_raise(ERR_LIB_PROV, ERR_R_PASSED_INVALID_ARGUMENT);
+            return 0;
+        }
+        from = OPENSSL_malloc(num * sizeof(*from));
+        flen = OPENSSL_malloc(num * sizeof(*flen));
+        if (from == NULL || flen == NULL)
+            goto end;
+
+        if (mdsize == 0) {
+            for (i = 0; i < num; i++) {
+                from[i] = tbs[i];
+                flen[i] = (int)tbslen[i];
+            }
+            ret = ossl_rsa_private_encrypt_batch(prsactx->rsa, num, from,
+                                                 flen, sig, prsactx->pad_mode);
+        } else {
+            if (!rsa_pss_check_saltlen(prsactx))
+                goto end;
+            if ((em = OPENSSL_malloc(num * rsasize)) == NULL)
+                goto end;
+            for (i = 0; i < num; i++) {
+                saltlen = prsactx->saltlen;
+                if (!ossl_rsa_padding_add_PKCS1_PSS_mgf1(prsactx->rsa,
+                                                         em + i * rsasize,
+                                                         tbs[i], prsactx->md,
+                                                         prsactx->mgf1_md,
+                                                         &saltlen)) {
+                    ERR_raise(ERR_LIB_PROV, ERR_R_RSA_LIB);
+                    goto end;
+                }
+#ifdef FIPS_MODULE
+                if (!rsa_pss_saltlen_check_passed(prsactx, "RSA Sign",
+                                                  saltlen))
+                    goto end;
+#endif
+                from[i] = em + i * rsasize;
+                flen[i] = (int)rsasize;
+            }
+            ret = ossl_rsa_private_encrypt_batch(prsactx->rsa, num, from,
+                                                 flen, sig, RSA_NO_PADDING);
+        }
+    }
+
+    if (ret <= 0) {
+        ERR_raise(ERR_LIB_PROV, ERR_R_RSA_LIB);
+        ret = 0;
+    } else {
+        for (i = 0; i < num; i++)
+            siglen[i] = rsasize;
+    }
+ end:
+    OPENSSL_clear_free(em, em == NULL ? 0 : num * rsasize);
+    OPENSSL_free(from);
+    OPENSSL_free(flen);
+    return ret;
+}
+
 static int rsa_verify_recover_init(void *vprsactx, void *vrsa,
                                    const OSSL_PARAM params[])
 {
@@ -1862,6 +1998,7 @@ const OSSL_DISPATCH ossl_rsa_signature_functions[] = {
     { OSSL_FUNC_SIGNATURE_NEWCTX, (void (*)(void))rsa_newctx },
     { OSSL_FUNC_SIGNATURE_SIGN_INIT, (void (*)(void))rsa_sign_init },
     { OSSL_FUNC_SIGNATURE_SIGN, (void (*)(void))rsa_sign },
+    { OSSL_FUNC_SIGNATURE_SIGN_BATCH, (void (*)(void))rsa_sign_batch },
     { OSSL_FUNC_SIGNATURE_VERIFY_INIT, (void (*)(void))rsa_verify_init },
     { OSSL_FUNC_SIGNATURE_VERIFY, (void (*)(void))rsa_verify },
     { OSSL_FUNC_SIGNATURE_VERIFY_RECOVER_INIT,
@@ -2093,6 +2230,8 @@ static int rsa_sigalg_set_ctx_params(void *vprsactx, const OSSL_PARAM params[])
         { OSSL_FUNC_SIGNATURE_SIGN_INIT,                                \
           (void (*)(void))rsa_##md##_sign_init },                       \
         { OSSL_FUNC_SIGNATURE_SIGN, (void (*)(void))rsa_sign },         \
+        { OSSL_FUNC_SIGNATURE_SIGN_BATCH,                               \
+          (void (*)(void))rsa_sign_batch },                             \
         { OSSL_FUNC_SIGNATURE_SIGN_MESSAGE_INIT,                        \
           (void (*)(void))rsa_##md##_sign_message_init },               \
         { OSSL_FUNC_SIGNATURE_SIGN_MESSAGE_UPDATE,                      \
@@ -0,0 +1,815 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_types.h"
+#include "internal/safe_math.h"
+#include "cc_local.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+/*
+ * BBRv2 congestion control.
+ *
+ * Rather than reacting to loss, BBR builds a model of the path from the
+ * delivery rate and round-trip time it observes, and keeps the amount of data
+ * in flight close to the bandwidth-delay product (BDP) of the path. This keeps
+ * queues short while still filling the pipe. Following version 2 of the
+ * algorithm, loss in excess of 2% per round is also taken into account, by
+ * bounding the volume in flight with inflight_hi.
+ *
+ * The pacing gains of the various phases are applied to max_bw to give the
+ * pacing rate, which is published through the pacing rate diagnostic for the
+ * pacer to apply. As pacing is optional, the window is steered with the same
+ * gains too, so that the model is still followed when no pacer is in use.
+ *
+ * The CC interface only tells us about the send time and size of each
+ * acknowledged packet, so delivery rate samples are derived from a ring of
+ * records describing the connection state at regularly spaced send times.
+ */
+
+/* Maximum number of send records kept. */
+#define BBR_SEND_RECS               64
+/* Number of round trips over which max_bw is filtered. */
+#define BBR_BW_FILTER_ROUNDS        10
+/* Interval between PROBE_RTT phases, and their minimum duration. */
+#define BBR_PROBE_RTT_INTERVAL      ossl_ms2time(5000)
+#define BBR_PROBE_RTT_DURATION      ossl_ms2time(200)
+/* Base time between bandwidth probes, to which up to 1 s is added. */
+#define BBR_PROBE_BW_WAIT           ossl_ms2time(2000)
+/* Maximum number of rounds between bandwidth probes. */
+#define BBR_PROBE_BW_MAX_ROUNDS     63
+/* Maximum duration of the PROBE_UP phase in rounds. */
+#define BBR_PROBE_UP_MAX_ROUNDS     3
+/* Gains in percent. */
+#define BBR_DRAIN_GAIN              90
+#define BBR_PROBE_UP_GAIN           125
+#define BBR_STARTUP_PACING_GAIN     277 /* 2 / ln(2) */
+#define BBR_DRAIN_PACING_GAIN       35
+#define BBR_HEADROOM                85
+#define BBR_BETA                    70
+/* Loss rate (in percent) above which inflight_hi is lowered. */
+#define BBR_LOSS_THRESH             2
+/* Minimum bandwidth growth (in percent) per round to remain in STARTUP. */
+#define BBR_FULL_BW_GROWTH          125
+#define BBR_FULL_BW_ROUNDS          3
+/* Minimum number of loss events in a round for loss to end STARTUP. */
+#define BBR_FULL_LOSS_CNT           8
+/* Minimum window in datagrams. */
+#define BBR_MIN_WND_DGRAMS          4
+
+enum {
+    BBR_STATE_STARTUP,
+    BBR_STATE_DRAIN,
+    BBR_STATE_PROBE_BW,
+    BBR_STATE_PROBE_RTT
+};
+
+enum {
+    BBR_PHASE_DOWN,
+    BBR_PHASE_CRUISE,
+    BBR_PHASE_REFILL,
+    BBR_PHASE_UP
+};
+
+typedef struct bbr_send_rec_st {
+    OSSL_TIME   send_time;
+    OSSL_TIME   delivered_time;  /* Time of the last ack before send_time */
+    uint64_t    delivered;       /* Bytes delivered before send_time */
+    uint64_t    inflight;        /* Bytes in flight after the send */
+} BBR_SEND_REC;
+
+typedef struct ossl_cc_bbr_st {
+    /* Dependencies. */
+    OSSL_TIME   (*now_cb)(void *arg);
+    void        *now_cb_arg;
+
+    /* 'Constants' (which we allow to be configurable). */
+    uint64_t    k_init_wnd, k_min_wnd;
+
+    /* State. */
+    size_t      max_dgram_size;
+    uint64_t    bytes_in_flight, cong_wnd;
+    int         state, phase;
+
+    /* Delivery rate sampling. */
+    BBR_SEND_REC recs[BBR_SEND_RECS];
+    size_t      rec_head, rec_count;
+    uint64_t    delivered;
+    OSSL_TIME   delivered_time;
+
+    /* Round counting. */
+    uint64_t    round_count, next_round_delivered;
+    int         round_start;
+
+    /* Path model. */
+    uint64_t    bw_filter[BBR_BW_FILTER_ROUNDS]; /* Bytes per second */
+    uint64_t    max_bw;
+    OSSL_TIME   min_rtt, min_rtt_stamp;
+    int         min_rtt_expired;
+    uint64_t    inflight_hi;
+
+    /* STARTUP. */
+    uint64_t    full_bw;
+    int         full_bw_count, filled_pipe;
+
+    /* PROBE_BW. */
+    OSSL_TIME   cycle_start, probe_wait;
+    uint64_t    rounds_since_probe, probe_up_cnt, probe_up_acked;
+
+    /* PROBE_RTT. */
+    OSSL_TIME   probe_rtt_done;
+    int         probe_rtt_round_done;
+
+    /* Loss accounting for the current round. */
+    uint64_t    lost_in_round;
+    uint32_t    loss_events_in_round;
+
+    /* Loss recovery. */
+    int         in_recovery;
+    OSSL_TIME   recovery_start;
+    uint64_t    prior_cwnd;
+
+    /* Unflushed state during multiple on-loss calls. */
+    int         processing_loss;
+    uint64_t    inflight_at_loss;
+
+    /* Diagnostic output locations. */
+    OSSL_CC_DIAG diag;
+} OSSL_CC_BBR;
+
+static void bbr_set_max_dgram_size(OSSL_CC_BBR *b, size_t max_dgram_size);
+static void bbr_update_diag(OSSL_CC_BBR *b);
+
+static void bbr_reset(OSSL_CC_DATA *cc);
+
+static OSSL_CC_DATA *bbr_new(OSSL_TIME (*now_cb)(void *arg),
+                             void *now_cb_arg)
+{
+    OSSL_CC_BBR *b;
+
+    if ((b = OPENSSL_zalloc(sizeof(*b))) == NULL)
+        return NULL;
+
+    b->now_cb       = now_cb;
+    b->now_cb_arg   = now_cb_arg;
+
+    bbr_set_max_dgram_size(b, QUIC_MIN_INITIAL_DGRAM_LEN);
+    bbr_reset((OSSL_CC_DATA *)b);
+
+    return (OSSL_CC_DATA *)b;
+}
+
+static void bbr_free(OSSL_CC_DATA *cc)
+{
+    OPENSSL_free(cc);
+}
+
+static void bbr_set_max_dgram_size(OSSL_CC_BBR *b, size_t max_dgram_size)
+{
+    int is_reduced = (max_dgram_size < b->max_dgram_size);
+
+    b->max_dgram_size   = max_dgram_size;
+    b->k_init_wnd       = ossl_cc_init_wnd(max_dgram_size);
+    b->k_min_wnd        = BBR_MIN_WND_DGRAMS * max_dgram_size;
+
+    if (is_reduced)
+        b->cong_wnd = b->k_init_wnd;
+
+    bbr_update_diag(b);
+}
+
+static void bbr_reset(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+    OSSL_CC_DIAG diag = b->diag;
+    OSSL_TIME (*now_cb)(void *arg) = b->now_cb;
+    void *now_cb_arg = b->now_cb_arg;
+    size_t max_dgram_size = b->max_dgram_size;
+
+    memset(b, 0, sizeof(*b));
+    b->now_cb           = now_cb;
+    b->now_cb_arg       = now_cb_arg;
+    b->diag             = diag;
+    b->max_dgram_size   = max_dgram_size;
+    b->k_init_wnd       = ossl_cc_init_wnd(max_dgram_size);
+    b->k_min_wnd        = BBR_MIN_WND_DGRAMS * max_dgram_size;
+
+    b->cong_wnd         = b->k_init_wnd;
+    b->state            = BBR_STATE_STARTUP;
+    b->min_rtt          = ossl_time_infinite();
+    b->min_rtt_stamp    = b->now_cb(b->now_cb_arg);
+    b->delivered_time   = b->min_rtt_stamp;
+    b->inflight_hi      = UINT64_MAX;
+}
+
+static int bbr_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+    const OSSL_PARAM *p;
+    size_t value;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN);
+    if (p != NULL) {
+        if (!OSSL_PARAM_get_size_t(p, &value))
+            return 0;
+        if (value < QUIC_MIN_INITIAL_DGRAM_LEN)
+            return 0;
+
+        bbr_set_max_dgram_size(b, value);
+    }
+
+    return 1;
+}
+
+static int bbr_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+
+    if (!ossl_cc_diag_bind(&b->diag, params))
+        return 0;
+
+    bbr_update_diag(b);
+    return 1;
+}
+
+static int bbr_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+
+    ossl_cc_diag_unbind(&b->diag, params);
+    return 1;
+}
+
+/* The estimated bandwidth-delay product, or 0 if there is no estimate yet. */
+static uint64_t bbr_bdp(OSSL_CC_BBR *b)
+{
+    int err = 0;
+    uint64_t bdp;
+
+    if (b->max_bw == 0 || ossl_time_is_infinite(b->min_rtt))
+        return 0;
+
+    bdp = safe_muldiv_u64(b->max_bw, ossl_time2ticks(b->min_rtt),
+                          OSSL_TIME_SECOND, &err);
+    return err ? UINT64_MAX : bdp;
+}
+
+static uint64_t bbr_percent(uint64_t v, uint64_t gain)
+{
+    int err = 0;
+    uint64_t r = safe_muldiv_u64(v, gain, 100, &err);
+
+    return err ? UINT64_MAX : r;
+}
+
+/* The pacing rate in bytes per second, or 0 if there is no estimate yet. */
+static uint64_t bbr_pacing_rate(OSSL_CC_BBR *b)
+{
+    uint64_t gain, rate;
+    int err = 0;
+
+    switch (b->state) {
+    case BBR_STATE_STARTUP:
+        gain = BBR_STARTUP_PACING_GAIN;
+        break;
+    case BBR_STATE_DRAIN:
+        gain = BBR_DRAIN_PACING_GAIN;
+        break;
+    case BBR_STATE_PROBE_BW:
+        gain = b->phase == BBR_PHASE_DOWN ? BBR_DRAIN_GAIN
+            : b->phase == BBR_PHASE_UP ? BBR_PROBE_UP_GAIN : 100;
+        break;
+    default:
+        gain = 100;
+        break;
+    }
+
+    if (b->max_bw != 0)
+        return bbr_percent(b->max_bw, gain);
+
+    /* Until the first delivery rate sample, pace the window over min_rtt. */
+    if (ossl_time_is_infinite(b->min_rtt) || ossl_time_is_zero(b->min_rtt))
+        return 0;
+
+    rate = safe_muldiv_u64(b->cong_wnd, OSSL_TIME_SECOND,
+                           ossl_time2ticks(b->min_rtt), &err);
+    return err ? UINT64_MAX : bbr_percent(rate, gain);
+}
+
+static void bbr_update_diag(OSSL_CC_BBR *b)
+{
+    static const uint32_t state_chars[] = { 'S', 'D', 'B', 'T' };
+
+    ossl_cc_diag_update(&b->diag, b->max_dgram_size, b->cong_wnd,
+                        b->k_min_wnd, b->bytes_in_flight,
+                        state_chars[b->state], bbr_pacing_rate(b));
+}
+
+static void bbr_record_send(OSSL_CC_BBR *b, OSSL_TIME now)
+{
+    BBR_SEND_REC *rec;
+    OSSL_TIME spacing;
+
+    /*
+     * Space the records so that the ring covers a few round trips, even with
+     * a full queue; each record stands for everything sent until the next.
+     */
+    if (b->rec_count > 0) {
+        rec = &b->recs[(b->rec_head + b->rec_count - 1) % BBR_SEND_RECS];
+        spacing = ossl_time_is_infinite(b->min_rtt)
+            ? ossl_time_zero()
+            : ossl_time_divide(b->min_rtt, BBR_SEND_RECS / 4);
+        if (ossl_time_compare(ossl_time_subtract(now, rec->send_time),
+                              spacing) < 0) {
+            rec->inflight = b->bytes_in_flight;
+            return;
+        }
+    }
+
+    if (b->rec_count == BBR_SEND_RECS) {
+        b->rec_head = (b->rec_head + 1) % BBR_SEND_RECS;
+        --b->rec_count;
+    }
+
+    rec = &b->recs[(b->rec_head + b->rec_count) % BBR_SEND_RECS];
+    ++b->rec_count;
+    rec->send_time      = now;
+    rec->delivered_time = b->delivered_time;
+    rec->delivered      = b->delivered;
+    rec->inflight       = b->bytes_in_flight;
+}
+
+/* Finds the record covering a packet sent at tx_time, if any. */
+static BBR_SEND_REC *bbr_find_rec(OSSL_CC_BBR *b, OSSL_TIME tx_time)
+{
+    size_t i;
+    BBR_SEND_REC *rec;
+
+    for (i = b->rec_count; i > 0; --i) {
+        rec = &b->recs[(b->rec_head + i - 1) % BBR_SEND_RECS];
+        if (ossl_time_compare(rec->send_time, tx_time) <= 0)
+            return rec;
+    }
+
+    return NULL;
+}
+
+static void bbr_update_min_rtt(OSSL_CC_BBR *b, OSSL_TIME now, OSSL_TIME rtt)
+{
+    b->min_rtt_expired
+        = ossl_time_compare(ossl_time_subtract(now, b->min_rtt_stamp),
+                            BBR_PROBE_RTT_INTERVAL) > 0;
+
+    if (ossl_time_compare(rtt, b->min_rtt) <= 0 || b->min_rtt_expired) {
+        b->min_rtt          = rtt;
+        b->min_rtt_stamp    = now;
+    }
+}
+
+static void bbr_update_max_bw(OSSL_CC_BBR *b, uint64_t bw)
+{
+    size_t i, slot = b->round_count % BBR_BW_FILTER_ROUNDS;
+
+    if (b->round_start)
+        b->bw_filter[slot] = 0;
+
+    if (bw > b->bw_filter[slot])
+        b->bw_filter[slot] = bw;
+
+    b->max_bw = 0;
+    for (i = 0; i < BBR_BW_FILTER_ROUNDS; ++i)
+        if (b->bw_filter[i] > b->max_bw)
+            b->max_bw = b->bw_filter[i];
+}
+
+static void bbr_check_full_pipe(OSSL_CC_BBR *b)
+{
+    if (b->filled_pipe || !b->round_start)
+        return;
+
+    if (b->max_bw >= bbr_percent(b->full_bw, BBR_FULL_BW_GROWTH)) {
+        b->full_bw          = b->max_bw;
+        b->full_bw_count    = 0;
+        return;
+    }
+
+    if (++b->full_bw_count >= BBR_FULL_BW_ROUNDS)
+        b->filled_pipe = 1;
+}
+
+static void bbr_start_probe_bw(OSSL_CC_BBR *b, OSSL_TIME now, int phase)
+{
+    b->state                = BBR_STATE_PROBE_BW;
+    b->phase                = phase;
+    b->cycle_start          = now;
+    b->rounds_since_probe   = 0;
+
+    /* Desynchronise competing flows by waiting 2-3 s between probes. */
+    b->probe_wait = ossl_time_add(BBR_PROBE_BW_WAIT,
+                                  ossl_ms2time((ossl_time2ticks(now) >> 10)
+                                               % 1000));
+}
+
+static void bbr_start_probe_up(OSSL_CC_BBR *b)
+{
+    b->phase            = BBR_PHASE_UP;
+    b->probe_up_cnt     = 1;
+    b->probe_up_acked   = 0;
+}
+
+/* Whether it is time to probe for more bandwidth again. */
+static int bbr_is_time_to_probe(OSSL_CC_BBR *b, OSSL_TIME now)
+{
+    uint64_t bdp_dgrams = bbr_bdp(b) / b->max_dgram_size;
+
+    if (ossl_time_compare(ossl_time_subtract(now, b->cycle_start),
+                          b->probe_wait) >= 0)
+        return 1;
+
+    /* Probe at least as often as Reno would grow by a datagram. */
+    return b->rounds_since_probe
+        >= (bdp_dgrams < BBR_PROBE_BW_MAX_ROUNDS
+            ? bdp_dgrams : BBR_PROBE_BW_MAX_ROUNDS);
+}
+
+static void bbr_update_state(OSSL_CC_BBR *b, OSSL_TIME now)
+{
+    uint64_t bdp = bbr_bdp(b);
+
+    switch (b->state) {
+    case BBR_STATE_STARTUP:
+        if (b->filled_pipe)
+            b->state = BBR_STATE_DRAIN;
+        break;
+
+    case BBR_STATE_DRAIN:
+        if (b->bytes_in_flight <= bdp)
+            bbr_start_probe_bw(b, now, BBR_PHASE_DOWN);
+        break;
+
+    case BBR_STATE_PROBE_BW:
+        if (b->round_start)
+            ++b->rounds_since_probe;
+
+        switch (b->phase) {
+        case BBR_PHASE_DOWN:
+            if (b->bytes_in_flight <= bdp)
+                b->phase = BBR_PHASE_CRUISE;
+            break;
+
+        case BBR_PHASE_CRUISE:
+            if (bbr_is_time_to_probe(b, now)) {
+                b->phase                = BBR_PHASE_REFILL;
+                b->rounds_since_probe   = 0;
+            }
+            break;
+
+        case BBR_PHASE_REFILL:
+            /* Refill the pipe for one round before probing. */
+            if (b->round_start)
+                bbr_start_probe_up(b);
+            break;
+
+        case BBR_PHASE_UP:
+            if (b->round_start
+                && (b->bytes_in_flight >= bbr_percent(bdp, BBR_PROBE_UP_GAIN)
+                    || b->rounds_since_probe > BBR_PROBE_UP_MAX_ROUNDS))
+                bbr_start_probe_bw(b, now, BBR_PHASE_DOWN);
+            break;
+        }
+        break;
+
+    case BBR_STATE_PROBE_RTT:
+        if (ossl_time_is_zero(b->probe_rtt_done)) {
+            if (b->bytes_in_flight <= bbr_percent(bdp, 50) + b->k_min_wnd) {
+                b->probe_rtt_done = ossl_time_add(now, BBR_PROBE_RTT_DURATION);
+                b->probe_rtt_round_done = 0;
+                b->next_round_delivered = b->delivered;
+            }
+        } else {
+            if (b->round_start)
+                b->probe_rtt_round_done = 1;
+            if (b->probe_rtt_round_done
+                && ossl_time_compare(now, b->probe_rtt_done) >= 0) {
+                b->min_rtt_stamp = now;
+                if (b->filled_pipe)
+                    bbr_start_probe_bw(b, now, BBR_PHASE_CRUISE);
+                else
+                    b->state = BBR_STATE_STARTUP;
+            }
+        }
+        return;
+    }
+
+    /* Drain the queue from time to time to refresh min_rtt. */
+    if (b->min_rtt_expired) {
+        b->state            = BBR_STATE_PROBE_RTT;
+        b->probe_rtt_done   = ossl_time_zero();
+    }
+}
+
+/* Grows inflight_hi while probing up and the path keeps up. */
+static void bbr_probe_inflight_hi_upward(OSSL_CC_BBR *b, uint64_t acked)
+{
+    if (b->inflight_hi == UINT64_MAX || b->cong_wnd < b->inflight_hi)
+        return;
+
+    b->probe_up_acked += acked;
+    while (b->probe_up_acked >= b->probe_up_cnt * b->max_dgram_size
+           && b->probe_up_cnt > 0) {
+        b->probe_up_acked -= b->probe_up_cnt * b->max_dgram_size;
+        b->inflight_hi += b->max_dgram_size;
+    }
+
+    /* Double the growth rate every round. */
+    if (b->round_start && b->probe_up_cnt < UINT64_MAX / 2)
+        b->probe_up_cnt *= 2;
+}
+
+static int bbr_is_cong_limited(OSSL_CC_BBR *b)
+{
+    uint64_t wnd_rem;
+
+    if (b->bytes_in_flight >= b->cong_wnd)
+        return 1;
+
+    /* As for NewReno during slow start. */
+    wnd_rem = b->cong_wnd - b->bytes_in_flight;
+    return wnd_rem <= b->cong_wnd / 2 || wnd_rem <= 3 * b->max_dgram_size;
+}
+
+static void bbr_update_cwnd(OSSL_CC_BBR *b, uint64_t acked)
+{
+    uint64_t bdp = bbr_bdp(b), target, prev_cwnd = b->cong_wnd;
+
+    if (!b->filled_pipe || bdp == 0) {
+        /*
+         * Exponential growth until the pipe is full, as long as we use the
+         * window.
+         */
+        if (bbr_is_cong_limited(b))
+            b->cong_wnd += acked;
+        if (b->cong_wnd > b->inflight_hi)
+            b->cong_wnd = b->inflight_hi;
+    } else {
+        switch (b->state) {
+        case BBR_STATE_DRAIN:
+            target = bdp;
+            break;
+        case BBR_STATE_PROBE_RTT:
+            target = bbr_percent(bdp, 50);
+            break;
+        default:
+            switch (b->phase) {
+            case BBR_PHASE_DOWN:
+                target = bbr_percent(bdp, BBR_DRAIN_GAIN);
+                break;
+            case BBR_PHASE_UP:
+                bbr_probe_inflight_hi_upward(b, acked);
+                target = bbr_percent(bdp, BBR_PROBE_UP_GAIN);
+                break;
+            default:
+                /* Allow for ack aggregation. */
+                target = bdp + 4 * b->max_dgram_size;
+                break;
+            }
+            break;
+        }
+
+        /* Leave headroom for other flows except when probing. */
+        if (b->state == BBR_STATE_PROBE_BW && b->phase == BBR_PHASE_CRUISE) {
+            if (target > bbr_percent(b->inflight_hi, BBR_HEADROOM))
+                target = bbr_percent(b->inflight_hi, BBR_HEADROOM);
+        } else if (target > b->inflight_hi) {
+            target = b->inflight_hi;
+        }
+
+        b->cong_wnd = target;
+    }
+
+    /* Packet conservation: during recovery, send one for one acked. */
+    if (b->in_recovery) {
+        target = b->bytes_in_flight + acked;
+        if (target < prev_cwnd)
+            target = prev_cwnd;
+        if (b->cong_wnd > target)
+            b->cong_wnd = target;
+    }
+
+    if (b->cong_wnd < b->k_min_wnd)
+        b->cong_wnd = b->k_min_wnd;
+}
+
+static uint64_t bbr_get_tx_allowance(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+
+    if (b->bytes_in_flight >= b->cong_wnd)
+        return 0;
+
+    return b->cong_wnd - b->bytes_in_flight;
+}
+
+static OSSL_TIME bbr_get_wakeup_deadline(OSSL_CC_DATA *cc)
+{
+    if (bbr_get_tx_allowance(cc) > 0) {
+        /* We have TX allowance now so wakeup immediately */
+        return ossl_time_zero();
+    } else {
+        /* The window only changes in response to acknowledgements. */
+        return ossl_time_infinite();
+    }
+}
+
+static int bbr_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+
+    b->bytes_in_flight += num_bytes;
+    bbr_record_send(b, b->now_cb(b->now_cb_arg));
+    bbr_update_diag(b);
+    return 1;
+}
+
+static int bbr_on_data_acked(OSSL_CC_DATA *cc, const OSSL_CC_ACK_INFO *info)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+    OSSL_TIME now = b->now_cb(b->now_cb_arg), interval;
+    BBR_SEND_REC *rec;
+    uint64_t bw;
+    int err = 0;
+
+    b->bytes_in_flight  -= info->tx_size;
+    b->delivered        += info->tx_size;
+    b->delivered_time   = now;
+    b->round_start      = 0;
+
+    rec = bbr_find_rec(b, info->tx_time);
+    if (rec != NULL) {
+        /* A round ends when a packet sent after the previous one is acked. */
+        if (rec->delivered >= b->next_round_delivered) {
+            b->next_round_delivered = b->delivered;
+            b->round_start          = 1;
+            b->lost_in_round        = 0;
+            b->loss_events_in_round = 0;
+            ++b->round_count;
+        }
+
+        interval = ossl_time_subtract(now, rec->delivered_time);
+        if (!ossl_time_is_zero(interval)) {
+            bw = safe_muldiv_u64(b->delivered - rec->delivered,
+                                 OSSL_TIME_SECOND, ossl_time2ticks(interval),
+                                 &err);
+            if (!err)
+                bbr_update_max_bw(b, bw);
+        }
+    }
+
+    /* Recovery ends once a packet sent after it started is acknowledged. */
+    if (b->in_recovery
+        && ossl_time_compare(info->tx_time, b->recovery_start) > 0) {
+        b->in_recovery = 0;
+        if (b->cong_wnd < b->prior_cwnd)
+            b->cong_wnd = b->prior_cwnd;
+    }
+
+    bbr_update_min_rtt(b, now, ossl_time_subtract(now, info->tx_time));
+    bbr_check_full_pipe(b);
+    bbr_update_state(b, now);
+    bbr_update_cwnd(b, info->tx_size);
+    bbr_update_diag(b);
+    return 1;
+}
+
+static int bbr_on_data_lost(OSSL_CC_DATA *cc, const OSSL_CC_LOSS_INFO *info)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+    BBR_SEND_REC *rec;
+
+    if (info->tx_size > b->bytes_in_flight)
+        return 0;
+
+    b->bytes_in_flight  -= info->tx_size;
+    b->lost_in_round    += info->tx_size;
+
+    rec = bbr_find_rec(b, info->tx_time);
+    if (rec != NULL && rec->inflight > b->inflight_at_loss)
+        b->inflight_at_loss = rec->inflight;
+    b->processing_loss = 1;
+
+    bbr_update_diag(b);
+    return 1;
+}
+
+/* Reacts to the volume in flight having been too high for the path. */
+static void bbr_inflight_too_high(OSSL_CC_BBR *b, uint64_t inflight)
+{
+    uint64_t floor = bbr_percent(bbr_bdp(b), BBR_BETA);
+    OSSL_TIME now = b->now_cb(b->now_cb_arg);
+
+    if (!b->filled_pipe) {
+        /* Excessive loss ends STARTUP. */
+        b->filled_pipe = 1;
+        floor = bbr_percent(b->cong_wnd, BBR_BETA);
+    }
+
+    b->inflight_hi = inflight > floor ? inflight : floor;
+    if (b->inflight_hi < b->k_min_wnd)
+        b->inflight_hi = b->k_min_wnd;
+
+    if (b->state == BBR_STATE_PROBE_BW && b->phase == BBR_PHASE_UP)
+        bbr_start_probe_bw(b, now, BBR_PHASE_DOWN);
+    else if (b->state == BBR_STATE_STARTUP)
+        b->state = BBR_STATE_DRAIN;
+
+    if (b->cong_wnd > b->inflight_hi)
+        b->cong_wnd = b->inflight_hi;
+}
+
+static int bbr_on_data_lost_finished(OSSL_CC_DATA *cc, uint32_t flags)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+    uint64_t inflight;
+
+    if (!b->processing_loss)
+        return 1;
+
+    inflight = b->inflight_at_loss;
+    if (inflight == 0)
+        inflight = b->cong_wnd;
+
+    /*
+     * Only take loss as a sign that the pipe is full when it is both frequent
+     * and heavy, so that random loss does not end STARTUP early.
+     */
+    ++b->loss_events_in_round;
+    if (bbr_percent(inflight, BBR_LOSS_THRESH) < b->lost_in_round
+        && (b->filled_pipe || b->loss_events_in_round >= BBR_FULL_LOSS_CNT))
+        bbr_inflight_too_high(b, inflight);
+
+    if (!b->in_recovery) {
+        /* Start packet conservation, restoring the window afterwards. */
+        b->in_recovery      = 1;
+        b->recovery_start   = b->now_cb(b->now_cb_arg);
+        b->prior_cwnd       = b->cong_wnd;
+        b->cong_wnd         = b->bytes_in_flight;
+    }
+    if (b->prior_cwnd > b->inflight_hi)
+        b->prior_cwnd = b->inflight_hi;
+
+    if ((flags & OSSL_CC_LOST_FLAG_PERSISTENT_CONGESTION) != 0) {
+        b->cong_wnd     = b->k_min_wnd;
+        b->prior_cwnd   = b->k_min_wnd;
+    }
+
+    if (b->cong_wnd < b->k_min_wnd)
+        b->cong_wnd = b->k_min_wnd;
+
+    b->processing_loss  = 0;
+    b->inflight_at_loss = 0;
+    bbr_update_diag(b);
+    return 1;
+}
+
+static int bbr_on_data_invalidated(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+
+    b->bytes_in_flight -= num_bytes;
+    bbr_update_diag(b);
+    return 1;
+}
+
+static int bbr_on_ecn(OSSL_CC_DATA *cc, const OSSL_CC_ECN_INFO *info)
+{
+    OSSL_CC_BBR *b = (OSSL_CC_BBR *)cc;
+
+    /* Treat CE marks as a sign that the window is too large. */
+    bbr_inflight_too_high(b, b->bytes_in_flight > b->k_min_wnd
+                             ? b->bytes_in_flight : b->cong_wnd);
+    bbr_update_diag(b);
+    return 1;
+}
+
+const OSSL_CC_METHOD ossl_cc_bbr2_method = {
+    bbr_new,
+    bbr_free,
+    bbr_reset,
+    bbr_set_input_params,
+    bbr_bind_diagnostic,
+    bbr_unbind_diagnostic,
+    bbr_get_tx_allowance,
+    bbr_get_wakeup_deadline,
+    bbr_on_data_sent,
+    bbr_on_data_acked,
+    bbr_on_data_lost,
+    bbr_on_data_lost_finished,
+    bbr_on_data_invalidated,
+    bbr_on_ecn,
+};
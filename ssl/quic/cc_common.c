@@ -0,0 +1,171 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/safe_math.h"
+#include "cc_local.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+#define MIN_MAX_INIT_WND_SIZE    14720  /* RFC 9002 s. 7.2 */
+
+/*
+ * Pacing gains in percent. RFC 9002 suggests 1.25; during slow start the
+ * window doubles every round trip, so pace at twice the rate there.
+ */
+#define PACING_GAIN_SLOW_START  200
+#define PACING_GAIN             125
+
+static int bind_diag(OSSL_PARAM *params, const char *param_name, size_t len,
+                     void **pp)
+{
+    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
+
+    *pp = NULL;
+
+    if (p == NULL)
+        return 1;
+
+    if (p->data_type != OSSL_PARAM_UNSIGNED_INTEGER
+        || p->data_size != len)
+        return 0;
+
+    *pp = p->data;
+    return 1;
+}
+
+int ossl_cc_diag_bind(OSSL_CC_DIAG *diag, OSSL_PARAM *params)
+{
+    size_t *new_p_max_dgram_payload_len;
+    uint64_t *new_p_cur_cwnd_size;
+    uint64_t *new_p_min_cwnd_size;
+    uint64_t *new_p_cur_bytes_in_flight;
+    uint32_t *new_p_cur_state;
+    uint64_t *new_p_cur_pacing_rate;
+
+    if (!bind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
+                   sizeof(size_t), (void **)&new_p_max_dgram_payload_len)
+        || !bind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
+                      sizeof(uint64_t), (void **)&new_p_cur_cwnd_size)
+        || !bind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
+                      sizeof(uint64_t), (void **)&new_p_min_cwnd_size)
+        || !bind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
+                      sizeof(uint64_t), (void **)&new_p_cur_bytes_in_flight)
+        || !bind_diag(params, OSSL_CC_OPTION_CUR_STATE,
+                      sizeof(uint32_t), (void **)&new_p_cur_state)
+        || !bind_diag(params, OSSL_CC_OPTION_CUR_PACING_RATE,
+                      sizeof(uint64_t), (void **)&new_p_cur_pacing_rate))
+        return 0;
+
+    if (new_p_max_dgram_payload_len != NULL)
+        diag->p_max_dgram_payload_len = new_p_max_dgram_payload_len;
+
+    if (new_p_cur_cwnd_size != NULL)
+        diag->p_cur_cwnd_size = new_p_cur_cwnd_size;
+
+    if (new_p_min_cwnd_size != NULL)
+        diag->p_min_cwnd_size = new_p_min_cwnd_size;
+
+    if (new_p_cur_bytes_in_flight != NULL)
+        diag->p_cur_bytes_in_flight = new_p_cur_bytes_in_flight;
+
+    if (new_p_cur_state != NULL)
+        diag->p_cur_state = new_p_cur_state;
+
+    if (new_p_cur_pacing_rate != NULL)
+        diag->p_cur_pacing_rate = new_p_cur_pacing_rate;
+
+    return 1;
+}
+
+static void unbind_diag(OSSL_PARAM *params, const char *param_name,
+                        void **pp)
+{
+    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
+
+    if (p != NULL)
+        *pp = NULL;
+}
+
+void ossl_cc_diag_unbind(OSSL_CC_DIAG *diag, OSSL_PARAM *params)
+{
+    unbind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
+                (void **)&diag->p_max_dgram_payload_len);
+    unbind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
+                (void **)&diag->p_cur_cwnd_size);
+    unbind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
+                (void **)&diag->p_min_cwnd_size);
+    unbind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
+                (void **)&diag->p_cur_bytes_in_flight);
+    unbind_diag(params, OSSL_CC_OPTION_CUR_STATE,
+                (void **)&diag->p_cur_state);
+    unbind_diag(params, OSSL_CC_OPTION_CUR_PACING_RATE,
+                (void **)&diag->p_cur_pacing_rate);
+}
+
+void ossl_cc_diag_update(const OSSL_CC_DIAG *diag, size_t max_dgram_size,
+                         uint64_t cwnd, uint64_t min_cwnd,
+                         uint64_t bytes_in_flight, uint32_t state,
+                         uint64_t pacing_rate)
+{
+    if (diag->p_max_dgram_payload_len != NULL)
+        *diag->p_max_dgram_payload_len = max_dgram_size;
+
+    if (diag->p_cur_cwnd_size != NULL)
+        *diag->p_cur_cwnd_size = cwnd;
+
+    if (diag->p_min_cwnd_size != NULL)
+        *diag->p_min_cwnd_size = min_cwnd;
+
+    if (diag->p_cur_bytes_in_flight != NULL)
+        *diag->p_cur_bytes_in_flight = bytes_in_flight;
+
+    if (diag->p_cur_state != NULL)
+        *diag->p_cur_state = state;
+
+    if (diag->p_cur_pacing_rate != NULL)
+        *diag->p_cur_pacing_rate = pacing_rate;
+}
+
+uint64_t ossl_cc_init_wnd(size_t max_dgram_size)
+{
+    uint64_t max_init_wnd = 2 * (uint64_t)max_dgram_size;
+
+    if (max_init_wnd < MIN_MAX_INIT_WND_SIZE)
+        max_init_wnd = MIN_MAX_INIT_WND_SIZE;
+
+    if (10 * (uint64_t)max_dgram_size < max_init_wnd)
+        return 10 * (uint64_t)max_dgram_size;
+
+    return max_init_wnd;
+}
+
+void ossl_cc_update_srtt(OSSL_TIME *srtt, OSSL_TIME rtt)
+{
+    if (ossl_time_is_zero(*srtt))
+        *srtt = rtt;
+    else
+        *srtt = ossl_time_divide(ossl_time_add(ossl_time_multiply(*srtt, 7),
+                                               rtt), 8);
+}
+
+uint64_t ossl_cc_pacing_rate(uint64_t cwnd, OSSL_TIME srtt, int slow_start)
+{
+    int err = 0;
+    uint64_t rate;
+
+    if (ossl_time_is_zero(srtt))
+        return 0;
+
+    rate = safe_muldiv_u64(cwnd, OSSL_TIME_SECOND, ossl_time2ticks(srtt), &err);
+    if (!err)
+        rate = safe_muldiv_u64(rate, slow_start ? PACING_GAIN_SLOW_START
+                                                : PACING_GAIN, 100, &err);
+
+    return err ? UINT64_MAX : rate;
+}
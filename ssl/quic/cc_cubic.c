@@ -0,0 +1,503 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_types.h"
+#include "internal/safe_math.h"
+#include "cc_local.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+/*
+ * CUBIC congestion control (RFC 9438).
+ *
+ * Slow start, recovery periods and the batching of loss events work as for
+ * NewReno. In congestion avoidance the window follows a cubic function of the
+ * time elapsed since the last congestion event, which regains the previous
+ * window quickly and then probes beyond it, independently of the RTT. This
+ * makes much better use of links with a high bandwidth-delay product than the
+ * linear growth of NewReno. The Reno-friendly estimate W_est ensures we grow
+ * at least as fast as NewReno would.
+ *
+ * All window computations are done in bytes, and time in milliseconds.
+ */
+typedef struct ossl_cc_cubic_st {
+    /* Dependencies. */
+    OSSL_TIME   (*now_cb)(void *arg);
+    void        *now_cb_arg;
+
+    /* 'Constants' (which we allow to be configurable). */
+    uint64_t    k_init_wnd, k_min_wnd;
+
+    /* State. */
+    size_t      max_dgram_size;
+    uint64_t    bytes_in_flight, cong_wnd, slow_start_thresh;
+    OSSL_TIME   cong_recovery_start_time;
+
+    /* CUBIC state. */
+    OSSL_TIME   epoch_start;    /* Start of the current CA epoch, zero if none */
+    uint64_t    k_ms;           /* Time to regain w_max from epoch_start */
+    uint64_t    w_max;          /* Window before the last congestion event */
+    uint64_t    w_est;          /* Reno-friendly window estimate */
+    uint64_t    est_acked;      /* Pending growth of w_est */
+    uint64_t    cubic_acked;    /* Pending growth towards the cubic target */
+    OSSL_TIME   srtt;           /* Smoothed time from send to ack */
+
+    /* Unflushed state during multiple on-loss calls. */
+    int         processing_loss; /* 1 if not flushed */
+    OSSL_TIME   tx_time_of_last_loss;
+
+    /* Diagnostic state. */
+    int         in_congestion_recovery;
+
+    /* Diagnostic output locations. */
+    OSSL_CC_DIAG diag;
+} OSSL_CC_CUBIC;
+
+/* C = 0.4 */
+#define CUBIC_C_NUM         4
+#define CUBIC_C_DEN         10
+/* beta_cubic = 0.7 */
+#define CUBIC_BETA_NUM      7
+#define CUBIC_BETA_DEN      10
+/* alpha_cubic = 3 * (1 - beta_cubic) / (1 + beta_cubic) = 9 / 17 */
+#define CUBIC_ALPHA_NUM     9
+#define CUBIC_ALPHA_DEN     17
+
+/* Bound on |t - K| so that its cube in ms^3 cannot overflow. */
+#define CUBIC_MAX_OFFSET_MS ((int64_t)1 << 20)
+
+static void cubic_set_max_dgram_size(OSSL_CC_CUBIC *c, size_t max_dgram_size);
+static void cubic_update_diag(OSSL_CC_CUBIC *c);
+
+static void cubic_reset(OSSL_CC_DATA *cc);
+
+static OSSL_CC_DATA *cubic_new(OSSL_TIME (*now_cb)(void *arg),
+                               void *now_cb_arg)
+{
+    OSSL_CC_CUBIC *c;
+
+    if ((c = OPENSSL_zalloc(sizeof(*c))) == NULL)
+        return NULL;
+
+    c->now_cb       = now_cb;
+    c->now_cb_arg   = now_cb_arg;
+
+    cubic_set_max_dgram_size(c, QUIC_MIN_INITIAL_DGRAM_LEN);
+    cubic_reset((OSSL_CC_DATA *)c);
+
+    return (OSSL_CC_DATA *)c;
+}
+
+static void cubic_free(OSSL_CC_DATA *cc)
+{
+    OPENSSL_free(cc);
+}
+
+static void cubic_set_max_dgram_size(OSSL_CC_CUBIC *c, size_t max_dgram_size)
+{
+    int is_reduced = (max_dgram_size < c->max_dgram_size);
+
+    c->max_dgram_size   = max_dgram_size;
+    c->k_init_wnd       = ossl_cc_init_wnd(max_dgram_size);
+    c->k_min_wnd        = 2 * max_dgram_size;
+
+    if (is_reduced)
+        c->cong_wnd = c->k_init_wnd;
+
+    cubic_update_diag(c);
+}
+
+static void cubic_reset(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    c->cong_wnd                 = c->k_init_wnd;
+    c->bytes_in_flight          = 0;
+    c->slow_start_thresh        = UINT64_MAX;
+    c->cong_recovery_start_time = ossl_time_zero();
+
+    c->epoch_start  = ossl_time_zero();
+    c->k_ms         = 0;
+    c->w_max        = 0;
+    c->w_est        = 0;
+    c->est_acked    = 0;
+    c->cubic_acked  = 0;
+    c->srtt         = ossl_time_zero();
+
+    c->processing_loss          = 0;
+    c->tx_time_of_last_loss     = ossl_time_zero();
+    c->in_congestion_recovery   = 0;
+}
+
+static int cubic_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+    const OSSL_PARAM *p;
+    size_t value;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN);
+    if (p != NULL) {
+        if (!OSSL_PARAM_get_size_t(p, &value))
+            return 0;
+        if (value < QUIC_MIN_INITIAL_DGRAM_LEN)
+            return 0;
+
+        cubic_set_max_dgram_size(c, value);
+    }
+
+    return 1;
+}
+
+static int cubic_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    if (!ossl_cc_diag_bind(&c->diag, params))
+        return 0;
+
+    cubic_update_diag(c);
+    return 1;
+}
+
+static int cubic_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    ossl_cc_diag_unbind(&c->diag, params);
+    return 1;
+}
+
+static void cubic_update_diag(OSSL_CC_CUBIC *c)
+{
+    uint32_t state;
+
+    if (c->in_congestion_recovery)
+        state = 'R';
+    else if (c->cong_wnd < c->slow_start_thresh)
+        state = 'S';
+    else
+        state = 'A';
+
+    ossl_cc_diag_update(&c->diag, c->max_dgram_size, c->cong_wnd,
+                        c->k_min_wnd, c->bytes_in_flight, state,
+                        ossl_cc_pacing_rate(c->cong_wnd, c->srtt,
+                                            state == 'S'));
+}
+
+/* Integer cube root, rounded down. */
+static uint64_t icbrt(uint64_t x)
+{
+    uint64_t r = 0, b;
+    int s;
+
+    for (s = 63; s >= 0; s -= 3) {
+        r <<= 1;
+        b = 3 * r * (r + 1) + 1;
+        if ((x >> s) >= b) {
+            x -= b << s;
+            ++r;
+        }
+    }
+    return r;
+}
+
+/*
+ * Starts a new congestion avoidance epoch at the current time, computing
+ * K = cbrt((W_max - cwnd) / C), the time needed to regain W_max.
+ */
+static void cubic_start_epoch(OSSL_CC_CUBIC *c)
+{
+    int err = 0;
+    uint64_t x;
+
+    c->epoch_start  = c->now_cb(c->now_cb_arg);
+    c->w_est        = c->cong_wnd;
+    c->est_acked    = 0;
+    c->cubic_acked  = 0;
+
+    if (c->w_max <= c->cong_wnd) {
+        c->w_max    = c->cong_wnd;
+        c->k_ms     = 0;
+        return;
+    }
+
+    /* Segments / C in s^3, scaled to ms^3 */
+    x = safe_muldiv_u64(c->w_max - c->cong_wnd,
+                        UINT64_C(1000000000) * CUBIC_C_DEN,
+                        (uint64_t)c->max_dgram_size * CUBIC_C_NUM, &err);
+    c->k_ms = icbrt(err ? UINT64_MAX : x);
+}
+
+/* W_cubic(t) = C * (t - K)^3 + W_max, in bytes, for t in ms. */
+static uint64_t cubic_window(OSSL_CC_CUBIC *c, uint64_t t_ms)
+{
+    int64_t d = (int64_t)t_ms - (int64_t)c->k_ms;
+    int64_t off;
+
+    if (d > CUBIC_MAX_OFFSET_MS)
+        d = CUBIC_MAX_OFFSET_MS;
+    else if (d < -CUBIC_MAX_OFFSET_MS)
+        d = -CUBIC_MAX_OFFSET_MS;
+
+    /* d^3 ms^3 * C / 1e9 segments, with the scaling split to avoid overflow */
+    off = d * d * d / 1000000 * (int64_t)c->max_dgram_size * CUBIC_C_NUM
+          / (CUBIC_C_DEN * 1000);
+
+    if (off < 0 && (uint64_t)-off >= c->w_max)
+        return 0;
+
+    return c->w_max + off;
+}
+
+static int cubic_in_cong_recovery(OSSL_CC_CUBIC *c, OSSL_TIME tx_time)
+{
+    return ossl_time_compare(tx_time, c->cong_recovery_start_time) <= 0;
+}
+
+static void cubic_cong(OSSL_CC_CUBIC *c, OSSL_TIME tx_time)
+{
+    int err = 0;
+
+    /* No reaction if already in a recovery period. */
+    if (cubic_in_cong_recovery(c, tx_time))
+        return;
+
+    /* Start a new recovery period. */
+    c->in_congestion_recovery = 1;
+    c->cong_recovery_start_time = c->now_cb(c->now_cb_arg);
+
+    /*
+     * Fast convergence: if we did not regain the previous W_max, release
+     * some bandwidth to flows which joined since.
+     */
+    if (c->cong_wnd < c->w_max)
+        c->w_max = safe_muldiv_u64(c->cong_wnd,
+                                   CUBIC_BETA_DEN + CUBIC_BETA_NUM,
+                                   2 * CUBIC_BETA_DEN, &err);
+    else
+        c->w_max = c->cong_wnd;
+
+    c->slow_start_thresh = safe_muldiv_u64(c->cong_wnd,
+                                           CUBIC_BETA_NUM, CUBIC_BETA_DEN,
+                                           &err);
+    if (err)
+        c->w_max = c->slow_start_thresh = UINT64_MAX;
+
+    if (c->slow_start_thresh < c->k_min_wnd)
+        c->slow_start_thresh = c->k_min_wnd;
+
+    c->cong_wnd = c->slow_start_thresh;
+    cubic_start_epoch(c);
+}
+
+static void cubic_flush(OSSL_CC_CUBIC *c, uint32_t flags)
+{
+    if (!c->processing_loss)
+        return;
+
+    cubic_cong(c, c->tx_time_of_last_loss);
+
+    if ((flags & OSSL_CC_LOST_FLAG_PERSISTENT_CONGESTION) != 0) {
+        c->cong_wnd                 = c->k_min_wnd;
+        c->cong_recovery_start_time = ossl_time_zero();
+        c->epoch_start              = ossl_time_zero();
+    }
+
+    c->processing_loss = 0;
+    cubic_update_diag(c);
+}
+
+static uint64_t cubic_get_tx_allowance(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    if (c->bytes_in_flight >= c->cong_wnd)
+        return 0;
+
+    return c->cong_wnd - c->bytes_in_flight;
+}
+
+static OSSL_TIME cubic_get_wakeup_deadline(OSSL_CC_DATA *cc)
+{
+    if (cubic_get_tx_allowance(cc) > 0) {
+        /* We have TX allowance now so wakeup immediately */
+        return ossl_time_zero();
+    } else {
+        /*
+         * The CUBIC window only grows in response to acknowledgements, so
+         * there is nothing to wait for.
+         */
+        return ossl_time_infinite();
+    }
+}
+
+static int cubic_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    c->bytes_in_flight += num_bytes;
+    cubic_update_diag(c);
+    return 1;
+}
+
+static int cubic_is_cong_limited(OSSL_CC_CUBIC *c)
+{
+    uint64_t wnd_rem;
+
+    /* We are congestion-limited if we are already at the congestion window. */
+    if (c->bytes_in_flight >= c->cong_wnd)
+        return 1;
+
+    wnd_rem = c->cong_wnd - c->bytes_in_flight;
+
+    /* As for NewReno. */
+    return (c->cong_wnd < c->slow_start_thresh && wnd_rem <= c->cong_wnd / 2)
+           || wnd_rem <= 3 * c->max_dgram_size;
+}
+
+/* Congestion avoidance: grow towards the cubic (or Reno-friendly) target. */
+static void cubic_avoid(OSSL_CC_CUBIC *c, uint64_t acked)
+{
+    OSSL_TIME now = c->now_cb(c->now_cb_arg);
+    uint64_t t_ms, target, inc;
+    int err = 0;
+
+    if (ossl_time_is_zero(c->epoch_start))
+        cubic_start_epoch(c);
+
+    /* W_est grows by alpha_cubic segments per window acknowledged. */
+    c->est_acked += acked * CUBIC_ALPHA_NUM;
+    while (c->est_acked >= c->cong_wnd * CUBIC_ALPHA_DEN) {
+        c->est_acked -= c->cong_wnd * CUBIC_ALPHA_DEN;
+        c->w_est     += c->max_dgram_size;
+    }
+
+    /* Target the window one RTT from now. */
+    t_ms = ossl_time2ms(ossl_time_add(ossl_time_subtract(now, c->epoch_start),
+                                      c->srtt));
+    target = cubic_window(c, t_ms);
+
+    if (target < c->w_est) {
+        /* Reno-friendly region. */
+        if (c->cong_wnd < c->w_est)
+            c->cong_wnd = c->w_est;
+        return;
+    }
+
+    if (target <= c->cong_wnd)
+        return;
+    if (target > c->cong_wnd + c->cong_wnd / 2)
+        target = c->cong_wnd + c->cong_wnd / 2;
+
+    /* cwnd += (target - cwnd) / cwnd per byte acknowledged */
+    c->cubic_acked += safe_mul_u64(target - c->cong_wnd, acked, &err);
+    if (err)
+        c->cubic_acked = UINT64_MAX;
+    inc = c->cubic_acked / c->cong_wnd;
+    c->cubic_acked -= inc * c->cong_wnd;
+    c->cong_wnd += inc;
+}
+
+static int cubic_on_data_acked(OSSL_CC_DATA *cc, const OSSL_CC_ACK_INFO *info)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+    OSSL_TIME rtt = ossl_time_subtract(c->now_cb(c->now_cb_arg), info->tx_time);
+
+    c->bytes_in_flight -= info->tx_size;
+
+    ossl_cc_update_srtt(&c->srtt, rtt);
+
+    /* As for NewReno, only grow the window when we are using it. */
+    if (!cubic_is_cong_limited(c))
+        goto out;
+
+    if (cubic_in_cong_recovery(c, info->tx_time)) {
+        /* Congestion recovery, do nothing. */
+    } else if (c->cong_wnd < c->slow_start_thresh) {
+        /* Slow start. */
+        c->cong_wnd += info->tx_size;
+        c->in_congestion_recovery = 0;
+    } else {
+        cubic_avoid(c, info->tx_size);
+        c->in_congestion_recovery = 0;
+    }
+
+out:
+    cubic_update_diag(c);
+    return 1;
+}
+
+static int cubic_on_data_lost(OSSL_CC_DATA *cc, const OSSL_CC_LOSS_INFO *info)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    if (info->tx_size > c->bytes_in_flight)
+        return 0;
+
+    c->bytes_in_flight -= info->tx_size;
+
+    if (!c->processing_loss) {
+        /* As for NewReno, signal congestion once per loss incident. */
+        if (ossl_time_compare(info->tx_time, c->tx_time_of_last_loss) <= 0)
+            goto out;
+
+        c->processing_loss = 1;
+    }
+
+    c->tx_time_of_last_loss
+        = ossl_time_max(c->tx_time_of_last_loss, info->tx_time);
+
+out:
+    cubic_update_diag(c);
+    return 1;
+}
+
+static int cubic_on_data_lost_finished(OSSL_CC_DATA *cc, uint32_t flags)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    cubic_flush(c, flags);
+    return 1;
+}
+
+static int cubic_on_data_invalidated(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    c->bytes_in_flight -= num_bytes;
+    cubic_update_diag(c);
+    return 1;
+}
+
+static int cubic_on_ecn(OSSL_CC_DATA *cc, const OSSL_CC_ECN_INFO *info)
+{
+    OSSL_CC_CUBIC *c = (OSSL_CC_CUBIC *)cc;
+
+    c->processing_loss      = 1;
+    c->tx_time_of_last_loss = info->largest_acked_time;
+    cubic_flush(c, 0);
+    return 1;
+}
+
+const OSSL_CC_METHOD ossl_cc_cubic_method = {
+    cubic_new,
+    cubic_free,
+    cubic_reset,
+    cubic_set_input_params,
+    cubic_bind_diagnostic,
+    cubic_unbind_diagnostic,
+    cubic_get_tx_allowance,
+    cubic_get_wakeup_deadline,
+    cubic_on_data_sent,
+    cubic_on_data_acked,
+    cubic_on_data_lost,
+    cubic_on_data_lost_finished,
+    cubic_on_data_invalidated,
+    cubic_on_ecn,
+};
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_QUIC_CC_LOCAL_H
+# define OSSL_QUIC_CC_LOCAL_H
+
+# include "internal/quic_cc.h"
+
+# ifndef OPENSSL_NO_QUIC
+
+/*
+ * Congestion Controller Helpers
+ * =============================
+ *
+ * Functionality shared by the OSSL_CC_METHOD implementations. Other components
+ * should not include this header.
+ */
+
+/* Output locations bound by the bind_diagnostics() method. */
+typedef struct ossl_cc_diag_st {
+    size_t      *p_max_dgram_payload_len;
+    uint64_t    *p_cur_cwnd_size;
+    uint64_t    *p_min_cwnd_size;
+    uint64_t    *p_cur_bytes_in_flight;
+    uint32_t    *p_cur_state;
+    uint64_t    *p_cur_pacing_rate;
+} OSSL_CC_DIAG;
+
+/*
+ * Implement the bind_diagnostics() and unbind_diagnostics() methods for the
+ * diagnostics common to all congestion controllers.
+ */
+int ossl_cc_diag_bind(OSSL_CC_DIAG *diag, OSSL_PARAM *params);
+void ossl_cc_diag_unbind(OSSL_CC_DIAG *diag, OSSL_PARAM *params);
+
+/* Writes the current state to all bound diagnostic output locations. */
+void ossl_cc_diag_update(const OSSL_CC_DIAG *diag, size_t max_dgram_size,
+                         uint64_t cwnd, uint64_t min_cwnd,
+                         uint64_t bytes_in_flight, uint32_t state,
+                         uint64_t pacing_rate);
+
+/* Returns the initial congestion window for a datagram size (RFC 9002 7.2). */
+uint64_t ossl_cc_init_wnd(size_t max_dgram_size);
+
+/* Folds an RTT sample into a smoothed RTT, which is zero before the first. */
+void ossl_cc_update_srtt(OSSL_TIME *srtt, OSSL_TIME rtt);
+
+/*
+ * Returns the pacing rate in bytes per second for a window-based controller,
+ * which is the window divided by the smoothed RTT with some slack so as not to
+ * hold back window growth (RFC 9002 s. 7.7). Returns 0 (no pacing) if there is
+ * no RTT estimate yet.
+ */
+uint64_t ossl_cc_pacing_rate(uint64_t cwnd, OSSL_TIME srtt, int slow_start);
+
+# endif
+
+#endif
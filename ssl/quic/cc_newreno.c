@@ -1,6 +1,6 @@
-#include "internal/quic_cc.h"
 #include "internal/quic_types.h"
 #include "internal/safe_math.h"
+#include "cc_local.h"
 
 OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
 
@@ -18,6 +18,7 @@ typedef struct ossl_cc_newreno_st {
     size_t      max_dgram_size;
     uint64_t    bytes_in_flight, cong_wnd, slow_start_thresh, bytes_acked;
     OSSL_TIME   cong_recovery_start_time;
+    OSSL_TIME   srtt;           /* Smoothed time from send to ack */
 
     /* Unflushed state during multiple on-loss calls. */
     int         processing_loss; /* 1 if not flushed */
@@ -27,17 +28,9 @@ typedef struct ossl_cc_newreno_st {
     int         in_congestion_recovery;
 
     /* Diagnostic output locations. */
-    size_t      *p_diag_max_dgram_payload_len;
-    uint64_t    *p_diag_cur_cwnd_size;
-    uint64_t    *p_diag_min_cwnd_size;
-    uint64_t    *p_diag_cur_bytes_in_flight;
-    uint32_t    *p_diag_cur_state;
+    OSSL_CC_DIAG diag;
 } OSSL_CC_NEWRENO;
 
-#define MIN_MAX_INIT_WND_SIZE    14720  /* RFC 9002 s. 7.2 */
-
-/* TODO(QUIC FUTURE): Pacing support. */
-
 static void newreno_set_max_dgram_size(OSSL_CC_NEWRENO *nr,
                                        size_t max_dgram_size);
 static void newreno_update_diag(OSSL_CC_NEWRENO *nr);
@@ -69,20 +62,11 @@ static void newreno_free(OSSL_CC_DATA *cc)
 static void newreno_set_max_dgram_size(OSSL_CC_NEWRENO *nr,
                                        size_t max_dgram_size)
 {
-    size_t max_init_wnd;
     int is_reduced = (max_dgram_size < nr->max_dgram_size);
 
-    nr->max_dgram_size = max_dgram_size;
-
-    max_init_wnd = 2 * max_dgram_size;
-    if (max_init_wnd < MIN_MAX_INIT_WND_SIZE)
-        max_init_wnd = MIN_MAX_INIT_WND_SIZE;
-
-    nr->k_init_wnd = 10 * max_dgram_size;
-    if (nr->k_init_wnd > max_init_wnd)
-        nr->k_init_wnd = max_init_wnd;
-
-    nr->k_min_wnd = 2 * max_dgram_size;
+    nr->max_dgram_size  = max_dgram_size;
+    nr->k_init_wnd      = ossl_cc_init_wnd(max_dgram_size);
+    nr->k_min_wnd       = 2 * max_dgram_size;
 
     if (is_reduced)
         nr->cong_wnd = nr->k_init_wnd;
@@ -103,6 +87,7 @@ static void newreno_reset(OSSL_CC_DATA *cc)
     nr->bytes_acked                 = 0;
     nr->slow_start_thresh           = UINT64_MAX;
     nr->cong_recovery_start_time    = ossl_time_zero();
+    nr->srtt                        = ossl_time_zero();
 
     nr->processing_loss         = 0;
     nr->tx_time_of_last_loss    = ossl_time_zero();
@@ -128,112 +113,40 @@ static int newreno_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
     return 1;
 }
 
-static int bind_diag(OSSL_PARAM *params, const char *param_name, size_t len,
-                     void **pp)
-{
-    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
-
-    *pp = NULL;
-
-    if (p == NULL)
-        return 1;
-
-    if (p->data_type != OSSL_PARAM_UNSIGNED_INTEGER
-        || p->data_size != len)
-        return 0;
-
-    *pp = p->data;
-    return 1;
-}
-
 static int newreno_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
-    size_t *new_p_max_dgram_payload_len;
-    uint64_t *new_p_cur_cwnd_size;
-    uint64_t *new_p_min_cwnd_size;
-    uint64_t *new_p_cur_bytes_in_flight;
-    uint32_t *new_p_cur_state;
-
-    if (!bind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
-                   sizeof(size_t), (void **)&new_p_max_dgram_payload_len)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
-                      sizeof(uint64_t), (void **)&new_p_cur_cwnd_size)
-        || !bind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
-                      sizeof(uint64_t), (void **)&new_p_min_cwnd_size)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
-                      sizeof(uint64_t), (void **)&new_p_cur_bytes_in_flight)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_STATE,
-                      sizeof(uint32_t), (void **)&new_p_cur_state))
-        return 0;
 
-    if (new_p_max_dgram_payload_len != NULL)
-        nr->p_diag_max_dgram_payload_len = new_p_max_dgram_payload_len;
-
-    if (new_p_cur_cwnd_size != NULL)
-        nr->p_diag_cur_cwnd_size = new_p_cur_cwnd_size;
-
-    if (new_p_min_cwnd_size != NULL)
-        nr->p_diag_min_cwnd_size = new_p_min_cwnd_size;
-
-    if (new_p_cur_bytes_in_flight != NULL)
-        nr->p_diag_cur_bytes_in_flight = new_p_cur_bytes_in_flight;
-
-    if (new_p_cur_state != NULL)
-        nr->p_diag_cur_state = new_p_cur_state;
+    if (!ossl_cc_diag_bind(&nr->diag, params))
+        return 0;
 
     newreno_update_diag(nr);
     return 1;
 }
 
-static void unbind_diag(OSSL_PARAM *params, const char *param_name,
-                        void **pp)
-{
-    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
-
-    if (p != NULL)
-        *pp = NULL;
-}
-
 static int newreno_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
 
-    unbind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
-                (void **)&nr->p_diag_max_dgram_payload_len);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
-                (void **)&nr->p_diag_cur_cwnd_size);
-    unbind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
-                (void **)&nr->p_diag_min_cwnd_size);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
-                (void **)&nr->p_diag_cur_bytes_in_flight);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_STATE,
-                (void **)&nr->p_diag_cur_state);
+    ossl_cc_diag_unbind(&nr->diag, params);
     return 1;
 }
 
 static void newreno_update_diag(OSSL_CC_NEWRENO *nr)
 {
-    if (nr->p_diag_max_dgram_payload_len != NULL)
-        *nr->p_diag_max_dgram_payload_len = nr->max_dgram_size;
-
-    if (nr->p_diag_cur_cwnd_size != NULL)
-        *nr->p_diag_cur_cwnd_size = nr->cong_wnd;
-
-    if (nr->p_diag_min_cwnd_size != NULL)
-        *nr->p_diag_min_cwnd_size = nr->k_min_wnd;
-
-    if (nr->p_diag_cur_bytes_in_flight != NULL)
-        *nr->p_diag_cur_bytes_in_flight = nr->bytes_in_flight;
-
-    if (nr->p_diag_cur_state != NULL) {
-        if (nr->in_congestion_recovery)
-            *nr->p_diag_cur_state = 'R';
-        else if (nr->cong_wnd < nr->slow_start_thresh)
-            *nr->p_diag_cur_state = 'S';
-        else
-            *nr->p_diag_cur_state = 'A';
-    }
+    uint32_t state;
+
+    if (nr->in_congestion_recovery)
+        state = 'R';
+    else if (nr->cong_wnd < nr->slow_start_thresh)
+        state = 'S';
+    else
+        state = 'A';
+
+    ossl_cc_diag_update(&nr->diag, nr->max_dgram_size, nr->cong_wnd,
+                        nr->k_min_wnd, nr->bytes_in_flight, state,
+                        ossl_cc_pacing_rate(nr->cong_wnd, nr->srtt,
+                                            state == 'S'));
 }
 
 static int newreno_in_cong_recovery(OSSL_CC_NEWRENO *nr, OSSL_TIME tx_time)
@@ -347,6 +260,11 @@ static int newreno_on_data_acked(OSSL_CC_DATA *cc,
      */
     nr->bytes_in_flight -= info->tx_size;
 
+    /* The RTT is only used to derive the pacing rate. */
+    ossl_cc_update_srtt(&nr->srtt,
+                        ossl_time_subtract(nr->now_cb(nr->now_cb_arg),
+                                           info->tx_time));
+
     /*
      * We use acknowledgement of data as a signal that we are not at channel
      * capacity and that it may be reasonable to increase the congestion window.
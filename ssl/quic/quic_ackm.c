@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -1723,3 +1723,10 @@ void ossl_ackm_set_tx_max_ack_delay(OSSL_ACKM *ackm, OSSL_TIME tx_max_ack_delay)
 {
     ackm->tx_max_ack_delay = tx_max_ack_delay;
 }
+
+void ossl_ackm_set_cc_method(OSSL_ACKM *ackm, const OSSL_CC_METHOD *cc_method,
+                             OSSL_CC_DATA *cc_data)
+{
+    ackm->cc_method = cc_method;
+    ackm->cc_data   = cc_data;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -158,6 +158,21 @@ static QLOG *ch_get_qlog_cb(void *arg)
 
 #define DEFAULT_INIT_CONN_MAX_STREAMS           100
 
+/* Congestion controllers by SSL_QUIC_CC_* value. */
+static const OSSL_CC_METHOD *const cc_methods[] = {
+    &ossl_cc_newreno_method,
+    &ossl_cc_cubic_method,
+    &ossl_cc_bbr2_method
+};
+
+static const OSSL_CC_METHOD *ch_get_cc_method(int alg)
+{
+    if (alg < 0 || (size_t)alg >= OSSL_NELEM(cc_methods))
+        return NULL;
+
+    return cc_methods[alg];
+}
+
 static int ch_init(QUIC_CHANNEL *ch)
 {
     OSSL_QUIC_TX_PACKETISER_ARGS txp_args = {0};
@@ -185,6 +200,8 @@ static int ch_init(QUIC_CHANNEL *ch)
     qtx_args.get_qlog_cb        = ch_get_qlog_cb;
     qtx_args.get_qlog_cb_arg    = ch;
     qtx_args.mdpl               = QUIC_MIN_INITIAL_DGRAM_LEN;
+    /* Servers send the bulk of the data, batch it if the port asks for it */
+    qtx_args.use_gso            = ch->is_server && ch->port->use_seg_offload;
     ch->rx_max_udp_payload_size = qtx_args.mdpl;
 
     ch->ping_deadline = ossl_time_infinite();
@@ -239,7 +256,9 @@ static int ch_init(QUIC_CHANNEL *ch)
         goto err;
 
     ch->have_statm = 1;
-    ch->cc_method = &ossl_cc_newreno_method;
+    ch->cc_method = ch_get_cc_method(ch->port->channel_ctx->quic_cc_alg);
+    if (ch->cc_method == NULL)
+        goto err;
     if ((ch->cc_data = ch->cc_method->new(get_time, ch)) == NULL)
         goto err;
 
@@ -3702,3 +3721,40 @@ uint64_t ossl_quic_channel_get_max_idle_timeout_actual(const QUIC_CHANNEL *ch)
 {
     return ch->max_idle_timeout;
 }
+
+int ossl_quic_channel_set_cc_alg(QUIC_CHANNEL *ch, int alg)
+{
+    const OSSL_CC_METHOD *cc_method = ch_get_cc_method(alg);
+    OSSL_CC_DATA *cc_data;
+
+    if (cc_method == NULL || ch->state != QUIC_CHANNEL_STATE_IDLE)
+        return 0;
+
+    if (cc_method == ch->cc_method)
+        return 1;
+
+    if ((cc_data = cc_method->new(get_time, ch)) == NULL)
+        return 0;
+
+    /* Nothing has been sent yet, so nothing needs to be carried over. */
+    if (!ossl_quic_tx_packetiser_set_cc_method(ch->txp, cc_method, cc_data)) {
+        cc_method->free(cc_data);
+        return 0;
+    }
+    ossl_ackm_set_cc_method(ch->ackm, cc_method, cc_data);
+    ch->cc_method->free(ch->cc_data);
+    ch->cc_method   = cc_method;
+    ch->cc_data     = cc_data;
+    return 1;
+}
+
+int ossl_quic_channel_get_cc_alg(const QUIC_CHANNEL *ch)
+{
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(cc_methods); ++i)
+        if (cc_methods[i] == ch->cc_method)
+            return (int)i;
+
+    return -1;
+}
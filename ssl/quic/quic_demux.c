@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -21,6 +21,13 @@
 
 #define DEMUX_DEFAULT_MTU        1500
 
+/*
+ * With GRO, messages may carry up to 64 KiB of coalesced datagrams, so they
+ * are received into a separate buffer in fewer messages per call.
+ */
+#define DEMUX_GRO_MSGS_PER_CALL     4
+#define DEMUX_GRO_MSG_LEN           65535
+
 struct quic_demux_st {
     /* The underlying transport BIO with datagram semantics. */
     BIO                        *net_bio;
@@ -66,6 +73,12 @@ struct quic_demux_st {
 
     /* Whether to use local address support. */
     char                        use_local_addr;
+
+    /* Whether to receive GRO-coalesced datagrams, and whether the BIO can. */
+    char                        want_gro, use_gro;
+
+    /* Receive buffer for GRO, allocated on first use. */
+    unsigned char              *gro_buf;
 };
 
 QUIC_DEMUX *ossl_quic_demux_new(BIO *net_bio,
@@ -114,14 +127,23 @@ void ossl_quic_demux_free(QUIC_DEMUX *demux)
     demux_free_urxl(&demux->urx_free);
     demux_free_urxl(&demux->urx_pending);
 
+    OPENSSL_free(demux->gro_buf);
     OPENSSL_free(demux);
 }
 
+static void demux_update_gro(QUIC_DEMUX *demux)
+{
+    demux->use_gro = demux->want_gro && demux->net_bio != NULL
+        && BIO_dgram_get_gro_cap(demux->net_bio)
+        && BIO_dgram_set_gro_enable(demux->net_bio, 1);
+}
+
 void ossl_quic_demux_set_bio(QUIC_DEMUX *demux, BIO *net_bio)
 {
     unsigned int mtu;
 
     demux->net_bio = net_bio;
+    demux_update_gro(demux);
 
     if (net_bio != NULL) {
         /*
@@ -144,6 +166,12 @@ int ossl_quic_demux_set_mtu(QUIC_DEMUX *demux, unsigned int mtu)
     return 1;
 }
 
+void ossl_quic_demux_set_gro(QUIC_DEMUX *demux, int enable)
+{
+    demux->want_gro = enable != 0;
+    demux_update_gro(demux);
+}
+
 void ossl_quic_demux_set_default_handler(QUIC_DEMUX *demux,
                                          ossl_quic_demux_cb_fn *cb,
                                          void *cb_arg)
@@ -223,6 +251,98 @@ static int demux_ensure_free_urxe(QUIC_DEMUX *demux, size_t min_num_free)
     return 1;
 }
 
+/* Receive into the given messages, classifying any error. */
+static int demux_recvmmsg(QUIC_DEMUX *demux, BIO_MSG *msg, size_t num_msg,
+                          size_t *rd)
+{
+    ERR_set_mark();
+    if (!BIO_recvmmsg(demux->net_bio, msg, sizeof(BIO_MSG), num_msg, 0, rd)) {
+        if (BIO_err_is_non_fatal(ERR_peek_last_error())) {
+            /* Transient error, clear the error and stop. */
+            ERR_pop_to_mark();
+            return QUIC_DEMUX_PUMP_RES_TRANSIENT_FAIL;
+        } else {
+            /* Non-transient error, do not clear the error. */
+            ERR_clear_last_mark();
+            return QUIC_DEMUX_PUMP_RES_PERMANENT_FAIL;
+        }
+    }
+
+    ERR_clear_last_mark();
+    return QUIC_DEMUX_PUMP_RES_OK;
+}
+
+/*
+ * Receive messages coalesced by GRO from network, splitting each of them into
+ * one URXE per datagram.
+ *
+ * Returns one of the QUIC_DEMUX_PUMP_RES_* values.
+ */
+static int demux_recv_gro(QUIC_DEMUX *demux)
+{
+    BIO_MSG msg[DEMUX_GRO_MSGS_PER_CALL];
+    BIO_ADDR peer[DEMUX_GRO_MSGS_PER_CALL], local[DEMUX_GRO_MSGS_PER_CALL];
+    size_t rd, i, off, seg, len;
+    QUIC_URXE *urxe;
+    OSSL_TIME now;
+    int ret;
+
+    if (demux->gro_buf == NULL
+        && (demux->gro_buf = OPENSSL_malloc(DEMUX_GRO_MSGS_PER_CALL
+                                            * DEMUX_GRO_MSG_LEN)) == NULL)
+        return QUIC_DEMUX_PUMP_RES_PERMANENT_FAIL;
+
+    for (i = 0; i < OSSL_NELEM(msg); ++i) {
+        memset(&msg[i], 0, sizeof(BIO_MSG));
+        msg[i].data     = demux->gro_buf + i * DEMUX_GRO_MSG_LEN;
+        msg[i].data_len = DEMUX_GRO_MSG_LEN;
+        msg[i].peer     = &peer[i];
+        BIO_ADDR_clear(&peer[i]);
+        BIO_ADDR_clear(&local[i]);
+        if (demux->use_local_addr)
+            msg[i].local = &local[i];
+    }
+
+    if ((ret = demux_recvmmsg(demux, msg, i, &rd)) != QUIC_DEMUX_PUMP_RES_OK)
+        return ret;
+
+    now = demux->now != NULL ? demux->now(demux->now_arg) : ossl_time_zero();
+
+    for (i = 0; i < rd; ++i) {
+        seg = (size_t)(msg[i].flags & BIO_MSG_SEGMENT_SIZE_MASK);
+        if (seg == 0 || seg > msg[i].data_len)
+            seg = msg[i].data_len;
+
+        off = 0;
+        do {
+            len = msg[i].data_len - off < seg ? msg[i].data_len - off : seg;
+
+            if (demux_ensure_free_urxe(demux, 1) != 1
+                || (urxe = demux_reserve_urxe(demux,
+                                              ossl_list_urxe_head(&demux->urx_free),
+                                              len)) == NULL)
+                /* Allocation error, fail. */
+                return QUIC_DEMUX_PUMP_RES_PERMANENT_FAIL;
+
+            memcpy(ossl_quic_urxe_data(urxe),
+                   (unsigned char *)msg[i].data + off, len);
+            urxe->data_len      = len;
+            urxe->peer          = peer[i];
+            urxe->local         = local[i];
+            urxe->time          = now;
+            urxe->datagram_id   = demux->next_datagram_id++;
+            /* Move from free list to pending list. */
+            ossl_list_urxe_remove(&demux->urx_free, urxe);
+            ossl_list_urxe_insert_tail(&demux->urx_pending, urxe);
+            urxe->demux_state = URXE_DEMUX_STATE_PENDING;
+
+            off += len;
+        } while (off < msg[i].data_len);
+    }
+
+    return QUIC_DEMUX_PUMP_RES_OK;
+}
+
 /*
  * Receive datagrams from network, placing them into URXEs.
  *
@@ -237,6 +357,7 @@ static int demux_recv(QUIC_DEMUX *demux)
     size_t rd, i;
     QUIC_URXE *urxe = ossl_list_urxe_head(&demux->urx_free), *unext;
     OSSL_TIME now;
+    int ret;
 
     /* This should never be called when we have any pending URXE. */
     assert(ossl_list_urxe_head(&demux->urx_pending) == NULL);
@@ -248,6 +369,9 @@ static int demux_recv(QUIC_DEMUX *demux)
          */
         return QUIC_DEMUX_PUMP_RES_TRANSIENT_FAIL;
 
+    if (demux->use_gro)
+        return demux_recv_gro(demux);
+
     /*
      * Opportunistically receive as many messages as possible in a single
      * syscall, determined by how many free URXEs are available.
@@ -280,20 +404,9 @@ static int demux_recv(QUIC_DEMUX *demux)
             BIO_ADDR_clear(&urxe->local);
     }
 
-    ERR_set_mark();
-    if (!BIO_recvmmsg(demux->net_bio, msg, sizeof(BIO_MSG), i, 0, &rd)) {
-        if (BIO_err_is_non_fatal(ERR_peek_last_error())) {
-            /* Transient error, clear the error and stop. */
-            ERR_pop_to_mark();
-            return QUIC_DEMUX_PUMP_RES_TRANSIENT_FAIL;
-        } else {
-            /* Non-transient error, do not clear the error. */
-            ERR_clear_last_mark();
-            return QUIC_DEMUX_PUMP_RES_PERMANENT_FAIL;
-        }
-    }
+    if ((ret = demux_recvmmsg(demux, msg, i, &rd)) != QUIC_DEMUX_PUMP_RES_OK)
+        return ret;
 
-    ERR_clear_last_mark();
     now = demux->now != NULL ? demux->now(demux->now_arg) : ossl_time_zero();
 
     urxe = ossl_list_urxe_head(&demux->urx_free);
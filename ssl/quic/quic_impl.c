@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -1400,6 +1400,21 @@ long ossl_quic_ctrl(SSL *s, int cmd, long larg, void *parg)
         /* For legacy compatibility with DTLS calls. */
         return ossl_quic_handle_events(s) == 1 ? 1 : -1;
 
+    case SSL_CTRL_SET_QUIC_CC:
+        /* Cannot be changed after handshake started */
+        if (ctx.qc->started || ctx.is_stream)
+            return QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED,
+                                               NULL);
+
+        if (larg < 0 || larg > INT_MAX
+            || !ossl_quic_channel_set_cc_alg(ctx.qc->ch, (int)larg))
+            return QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+                                               NULL);
+
+        return 1;
+    case SSL_CTRL_GET_QUIC_CC:
+        return ossl_quic_channel_get_cc_alg(ctx.qc->ch);
+
         /* Mask ctrls we shouldn't support for QUIC. */
     case SSL_CTRL_GET_READ_AHEAD:
     case SSL_CTRL_SET_READ_AHEAD:
@@ -2092,6 +2107,9 @@ SSL *ossl_quic_conn_stream_new(SSL *s, uint64_t flags)
  *         SSL_want             => ossl_quic_want
  *   (BIO/)SSL_read             => ossl_quic_read
  *   (BIO/)SSL_write            => ossl_quic_write
+ *         SSL_write_donate     => ossl_quic_write_donate
+ *         SSL_read_peek_segments    => ossl_quic_read_peek_segments
+ *         SSL_read_release_segments => ossl_quic_read_release_segments
  *         SSL_pending          => ossl_quic_pending
  *         SSL_stream_conclude  => ossl_quic_conn_stream_conclude
  *         SSL_key_update       => ossl_quic_key_update
@@ -2524,9 +2542,41 @@ static int quic_validate_for_write(QUIC_XSO *xso, int *err)
     }
 }
 
+QUIC_NEEDS_LOCK
+static int quic_write_donate(QCTX *ctx, const void *buf, size_t len,
+                             uint64_t flags,
+                             SSL_write_release_cb_fn release_cb, void *arg,
+                             size_t *written)
+{
+    QUIC_XSO *xso = ctx->xso;
+
+    if (xso->aon_write_in_progress)
+        /* Donated data cannot be interleaved with an unfinished AON write. */
+        return QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_BAD_WRITE_RETRY, NULL);
+
+    /*
+     * The data is not copied, so it does not need space in the stream buffer
+     * and it is always accepted in full; stream flow control is applied when
+     * it is transmitted.
+     */
+    if (!ossl_quic_sstream_append_ref(xso->stream->sstream, buf, len,
+                                      release_cb, arg)) {
+        /* Stream already finished or allocation error. */
+        *written = 0;
+        return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
+    }
+
+    quic_post_write(xso, 1, 1, flags,
+                    xso_blocking_mode(xso) || qctx_should_autotick(ctx));
+
+    *written = len;
+    return 1;
+}
+
 QUIC_TAKES_LOCK
-int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
-                          uint64_t flags, size_t *written)
+static int quic_write(SSL *s, const void *buf, size_t len, uint64_t flags,
+                      SSL_write_release_cb_fn release_cb, void *arg,
+                      size_t *written)
 {
     int ret;
     QCTX ctx;
@@ -2578,11 +2628,17 @@ int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
             quic_post_write(ctx.xso, 0, 1, flags,
                             qctx_should_autotick(&ctx));
 
+        if (release_cb != NULL)
+            release_cb(buf, 0, arg);
+
         ret = 1;
         goto out;
     }
 
-    if (xso_blocking_mode(ctx.xso))
+    if (release_cb != NULL)
+        ret = quic_write_donate(&ctx, buf, len, flags, release_cb, arg,
+                                written);
+    else if (xso_blocking_mode(ctx.xso))
         ret = quic_write_blocking(&ctx, buf, len, flags, written);
     else if (partial_write)
         ret = quic_write_nonblocking_epw(&ctx, buf, len, flags, written);
@@ -2594,12 +2650,32 @@ out:
     return ret;
 }
 
+QUIC_TAKES_LOCK
+int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
+                          uint64_t flags, size_t *written)
+{
+    return quic_write(s, buf, len, flags, NULL, NULL, written);
+}
+
 QUIC_TAKES_LOCK
 int ossl_quic_write(SSL *s, const void *buf, size_t len, size_t *written)
 {
     return ossl_quic_write_flags(s, buf, len, 0, written);
 }
 
+QUIC_TAKES_LOCK
+int ossl_quic_write_donate(SSL *s, const void *buf, size_t len,
+                           uint64_t flags, SSL_write_release_cb_fn release_cb,
+                           void *arg, size_t *written)
+{
+    if (release_cb == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    return quic_write(s, buf, len, flags, release_cb, arg, written);
+}
+
 /*
  * SSL_read
  * --------
@@ -2609,6 +2685,7 @@ struct quic_read_again_args {
     QUIC_STREAM     *stream;
     void            *buf;
     size_t          len;
+    size_t          *segs_out;
     size_t          *bytes_read;
     int             peek;
 };
@@ -2651,15 +2728,60 @@ static int quic_validate_for_read(QUIC_XSO *xso, int *err, int *eos)
     }
 }
 
+/*
+ * Retires bytes_read bytes which the application has consumed from the stream,
+ * and notifies the stream map if the end of the stream has been reached.
+ */
+QUIC_NEEDS_LOCK
+static int quic_read_retire(QCTX *ctx, QUIC_STREAM *stream,
+                            size_t bytes_read, int is_fin)
+{
+    QUIC_CONNECTION *qc = ctx->qc;
+
+    if (bytes_read > 0) {
+        /*
+         * We have read at least one byte from the stream. Inform stream-level
+         * RXFC of the retirement of controlled bytes. Update the active stream
+         * status (the RXFC may now want to emit a frame granting more credit to
+         * the peer).
+         */
+        OSSL_RTT_INFO rtt_info;
+
+        ossl_statm_get_rtt_info(ossl_quic_channel_get_statm(qc->ch), &rtt_info);
+
+        if (!ossl_quic_rxfc_on_retire(&stream->rxfc, bytes_read,
+                                      rtt_info.smoothed_rtt))
+            return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
+    }
+
+    if (is_fin) {
+        QUIC_STREAM_MAP *qsm = ossl_quic_channel_get_qsm(qc->ch);
+
+        ossl_quic_stream_map_notify_totally_read(qsm, stream);
+    }
+
+    if (bytes_read > 0)
+        ossl_quic_stream_map_update_state(ossl_quic_channel_get_qsm(qc->ch),
+                                          stream);
+
+    return 1;
+}
+
+/*
+ * If segs_out is non-NULL, buf is an array of buf_len SSL_READ_SEGMENT
+ * structures which is filled with pointers to the received data instead of
+ * copying it, and the number of them filled is written to *segs_out. This is
+ * always a peek.
+ */
 QUIC_NEEDS_LOCK
 static int quic_read_actual(QCTX *ctx,
                             QUIC_STREAM *stream,
                             void *buf, size_t buf_len,
+                            size_t *segs_out,
                             size_t *bytes_read,
                             int peek)
 {
     int is_fin = 0, err, eos;
-    QUIC_CONNECTION *qc = ctx->qc;
 
     if (!quic_validate_for_read(ctx->xso, &err, &eos)) {
         if (eos) {
@@ -2670,7 +2792,12 @@ static int quic_read_actual(QCTX *ctx,
         }
     }
 
-    if (peek) {
+    if (segs_out != NULL) {
+        if (!ossl_quic_rstream_peek_segments(stream->rstream, buf, buf_len,
+                                             segs_out, bytes_read, &is_fin))
+            return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
+
+    } else if (peek) {
         if (!ossl_quic_rstream_peek(stream->rstream, buf, buf_len,
                                     bytes_read, &is_fin))
             return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2681,33 +2808,14 @@ static int quic_read_actual(QCTX *ctx,
             return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
     }
 
-    if (!peek) {
-        if (*bytes_read > 0) {
-            /*
-             * We have read at least one byte from the stream. Inform stream-level
-             * RXFC of the retirement of controlled bytes. Update the active stream
-             * status (the RXFC may now want to emit a frame granting more credit to
-             * the peer).
-             */
-            OSSL_RTT_INFO rtt_info;
-
-            ossl_statm_get_rtt_info(ossl_quic_channel_get_statm(qc->ch), &rtt_info);
-
-            if (!ossl_quic_rxfc_on_retire(&stream->rxfc, *bytes_read,
-                                          rtt_info.smoothed_rtt))
-                return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
-        }
-
-        if (is_fin && !peek) {
-            QUIC_STREAM_MAP *qsm = ossl_quic_channel_get_qsm(ctx->qc->ch);
-
-            ossl_quic_stream_map_notify_totally_read(qsm, ctx->xso->stream);
-        }
-
-        if (*bytes_read > 0)
-            ossl_quic_stream_map_update_state(ossl_quic_channel_get_qsm(qc->ch),
-                                              stream);
-    }
+    /*
+     * A peek of segments does not consume any data, but there is nothing for
+     * the application to release when only the end of the stream is left, so
+     * retire it now as a read would.
+     */
+    if ((!peek || (segs_out != NULL && *bytes_read == 0))
+        && !quic_read_retire(ctx, stream, *bytes_read, is_fin))
+        return 0; /* quic_read_retire raised error here */
 
     if (*bytes_read == 0 && is_fin) {
         ctx->xso->retired_fin = 1;
@@ -2729,8 +2837,8 @@ static int quic_read_again(void *arg)
     }
 
     if (!quic_read_actual(args->ctx, args->stream,
-                          args->buf, args->len, args->bytes_read,
-                          args->peek))
+                          args->buf, args->len, args->segs_out,
+                          args->bytes_read, args->peek))
         return -1;
 
     if (*args->bytes_read > 0)
@@ -2741,13 +2849,16 @@ static int quic_read_again(void *arg)
 }
 
 QUIC_TAKES_LOCK
-static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek)
+static int quic_read(SSL *s, void *buf, size_t len, size_t *segs_out,
+                     size_t *bytes_read, int peek)
 {
     int ret, res;
     QCTX ctx;
     struct quic_read_again_args args;
 
     *bytes_read = 0;
+    if (segs_out != NULL)
+        *segs_out = 0;
 
     if (!expect_quic(s, &ctx))
         return 0;
@@ -2780,7 +2891,8 @@ static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek
         ctx.xso = ctx.qc->default_xso;
     }
 
-    if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, bytes_read, peek)) {
+    if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, segs_out,
+                              bytes_read, peek)) {
         ret = 0; /* quic_read_actual raised error here */
         goto out;
     }
@@ -2802,6 +2914,7 @@ static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek
         args.stream     = ctx.xso->stream;
         args.buf        = buf;
         args.len        = len;
+        args.segs_out   = segs_out;
         args.bytes_read = bytes_read;
         args.peek       = peek;
 
@@ -2823,7 +2936,8 @@ static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek
         qctx_maybe_autotick(&ctx);
 
         /* Try the read again. */
-        if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, bytes_read, peek)) {
+        if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, segs_out,
+                              bytes_read, peek)) {
             ret = 0; /* quic_read_actual raised error here */
             goto out;
         }
@@ -2841,12 +2955,61 @@ out:
 
 int ossl_quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read)
 {
-    return quic_read(s, buf, len, bytes_read, 0);
+    return quic_read(s, buf, len, NULL, bytes_read, 0);
 }
 
 int ossl_quic_peek(SSL *s, void *buf, size_t len, size_t *bytes_read)
 {
-    return quic_read(s, buf, len, bytes_read, 1);
+    return quic_read(s, buf, len, NULL, bytes_read, 1);
+}
+
+/*
+ * SSL_read_peek_segments
+ * ----------------------
+ */
+int ossl_quic_read_peek_segments(SSL *s, SSL_READ_SEGMENT *segs,
+                                 size_t num_segs, size_t *segs_out,
+                                 size_t *bytes_read)
+{
+    if (segs == NULL || segs_out == NULL || bytes_read == NULL
+        || num_segs == 0) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    return quic_read(s, segs, num_segs, segs_out, bytes_read, 1);
+}
+
+/*
+ * SSL_read_release_segments
+ * -------------------------
+ */
+QUIC_TAKES_LOCK
+int ossl_quic_read_release_segments(SSL *s, size_t len)
+{
+    QCTX ctx;
+    int ret, is_fin = 0;
+    QUIC_STREAM *stream;
+
+    if (!expect_quic_with_stream_lock(s, /*remote_init=*/-1, /*io=*/0, &ctx))
+        return 0;
+
+    stream = ctx.xso->stream;
+    if (stream == NULL || stream->rstream == NULL
+        || !ossl_quic_rstream_release_segments(stream->rstream, len,
+                                               &is_fin)) {
+        ret = QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+                                          NULL);
+        goto out;
+    }
+
+    ret = quic_read_retire(&ctx, stream, len, is_fin);
+    if (ret && len > 0)
+        qctx_maybe_autotick(&ctx);
+
+out:
+    quic_unlock(ctx.qc);
+    return ret;
 }
 
 /*
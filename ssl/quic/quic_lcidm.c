@@ -1,5 +1,5 @@
 /*
- * Copyright 2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -58,6 +58,8 @@ struct quic_lcidm_st {
     LHASH_OF(QUIC_LCID)         *lcids; /* (QUIC_CONN_ID) -> (QUIC_LCID *)  */
     LHASH_OF(QUIC_LCIDM_CONN)   *conns; /* (void *opaque) -> (QUIC_LCIDM_CONN *) */
     size_t                      lcid_len; /* Length in bytes for all LCIDs */
+    unsigned char               steer_bits; /* Steering ID width, 0 if none */
+    unsigned char               steer_id;
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
     QUIC_CONN_ID                next_lcid;
 #endif
@@ -275,6 +277,31 @@ size_t ossl_quic_lcidm_get_lcid_len(const QUIC_LCIDM *lcidm)
     return lcidm->lcid_len;
 }
 
+int ossl_quic_lcidm_set_steering(QUIC_LCIDM *lcidm,
+                                 unsigned int steer_bits,
+                                 unsigned int steer_id)
+{
+    if (steer_bits > QUIC_LCIDM_MAX_STEER_BITS
+        || (steer_bits > 0 && lcidm->lcid_len == 0)
+        || (steer_id >> steer_bits) != 0)
+        return 0;
+
+    lcidm->steer_bits   = (unsigned char)steer_bits;
+    lcidm->steer_id     = (unsigned char)steer_id;
+    return 1;
+}
+
+int ossl_quic_lcidm_get_steering_id(const QUIC_LCIDM *lcidm,
+                                    const QUIC_CONN_ID *lcid,
+                                    unsigned int *steer_id)
+{
+    if (lcidm->steer_bits == 0 || lcid->id_len != lcidm->lcid_len)
+        return 0;
+
+    *steer_id = lcid->id[0] >> (8 - lcidm->steer_bits);
+    return 1;
+}
+
 size_t ossl_quic_lcidm_get_num_active_lcid(const QUIC_LCIDM *lcidm,
                                            void *opaque)
 {
@@ -299,11 +326,18 @@ static int lcidm_generate_cid(QUIC_LCIDM *lcidm,
     for (i = lcidm->lcid_len - 1; i >= 0; --i)
         if (++lcidm->next_lcid.id[i] != 0)
             break;
-
-    return 1;
 #else
-    return ossl_quic_gen_rand_conn_id(lcidm->libctx, lcidm->lcid_len, cid);
+    if (!ossl_quic_gen_rand_conn_id(lcidm->libctx, lcidm->lcid_len, cid))
+        return 0;
 #endif
+
+    /* Overwrite the top bits of the first byte with the steering ID. */
+    if (lcidm->steer_bits > 0)
+        cid->id[0] = (unsigned char)((cid->id[0] & (0xff >> lcidm->steer_bits))
+                                     | (lcidm->steer_id
+                                        << (8 - lcidm->steer_bits)));
+
+    return 1;
 }
 
 static int lcidm_generate(QUIC_LCIDM *lcidm,
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_pacer.h"
+#include "internal/quic_types.h"
+#include "internal/safe_math.h"
+
+#ifndef OPENSSL_NO_QUIC
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+/*
+ * The bucket holds at most this much time worth of transmission, so that a
+ * late wakeup does not leave the allowance unused, and so that at high rates
+ * we wake up about once per quantum rather than once per packet. The latter
+ * matters as the reactor sleeps with millisecond granularity.
+ */
+#define PACER_QUANTUM       OSSL_TIME_MS
+/* Minimum bucket size in bytes, so that at low rates packets can go in pairs. */
+#define PACER_MIN_BURST     (2 * QUIC_MIN_INITIAL_DGRAM_LEN)
+
+static int pacer_bind(QUIC_PACER *pacer)
+{
+    OSSL_PARAM params[2];
+
+    pacer->rate = 0;
+    params[0] = OSSL_PARAM_construct_uint64(OSSL_CC_OPTION_CUR_PACING_RATE,
+                                            &pacer->rate);
+    params[1] = OSSL_PARAM_construct_end();
+
+    return pacer->cc_method->bind_diagnostics(pacer->cc_data, params);
+}
+
+static void pacer_unbind(QUIC_PACER *pacer)
+{
+    OSSL_PARAM params[2];
+
+    params[0] = OSSL_PARAM_construct_uint64(OSSL_CC_OPTION_CUR_PACING_RATE,
+                                            &pacer->rate);
+    params[1] = OSSL_PARAM_construct_end();
+
+    pacer->cc_method->unbind_diagnostics(pacer->cc_data, params);
+    pacer->rate = 0;
+}
+
+int ossl_quic_pacer_init(QUIC_PACER *pacer,
+                         const OSSL_CC_METHOD *cc_method,
+                         OSSL_CC_DATA *cc_data,
+                         OSSL_TIME (*now)(void *arg),
+                         void *now_arg)
+{
+    pacer->cc_method    = cc_method;
+    pacer->cc_data      = cc_data;
+    pacer->now          = now;
+    pacer->now_arg      = now_arg;
+    pacer->tokens       = 0;
+    pacer->last_refill  = ossl_time_zero();
+
+    return pacer_bind(pacer);
+}
+
+void ossl_quic_pacer_cleanup(QUIC_PACER *pacer)
+{
+    pacer_unbind(pacer);
+}
+
+int ossl_quic_pacer_set_cc_method(QUIC_PACER *pacer,
+                                  const OSSL_CC_METHOD *cc_method,
+                                  OSSL_CC_DATA *cc_data)
+{
+    pacer_unbind(pacer);
+    pacer->cc_method    = cc_method;
+    pacer->cc_data      = cc_data;
+    return pacer_bind(pacer);
+}
+
+uint64_t ossl_quic_pacer_get_rate(const QUIC_PACER *pacer)
+{
+    return pacer->rate;
+}
+
+static int64_t pacer_get_burst(const QUIC_PACER *pacer)
+{
+    int err = 0;
+    uint64_t burst;
+
+    burst = safe_muldiv_u64(pacer->rate, PACER_QUANTUM, OSSL_TIME_SECOND, &err);
+    if (err || burst > INT64_MAX)
+        return INT64_MAX;
+
+    return burst < PACER_MIN_BURST ? PACER_MIN_BURST : (int64_t)burst;
+}
+
+static void pacer_refill(QUIC_PACER *pacer, OSSL_TIME now)
+{
+    int64_t burst = pacer_get_burst(pacer);
+    uint64_t add;
+    int err = 0;
+
+    if (ossl_time_compare(now, pacer->last_refill) <= 0)
+        return;
+
+    /* The rate may have dropped since the bucket was filled. */
+    if (pacer->tokens >= burst) {
+        pacer->tokens       = burst;
+        pacer->last_refill  = now;
+        return;
+    }
+
+    add = safe_muldiv_u64(pacer->rate,
+                          ossl_time2ticks(ossl_time_subtract(now,
+                                                             pacer->last_refill)),
+                          OSSL_TIME_SECOND, &err);
+
+    /*
+     * Keep the remainder for next time when less than a byte has been earned,
+     * which happens when we are called in quick succession.
+     */
+    if (add == 0 && !err)
+        return;
+
+    if (err || add >= (uint64_t)(burst - pacer->tokens))
+        pacer->tokens = burst;
+    else
+        pacer->tokens += (int64_t)add;
+
+    pacer->last_refill = now;
+}
+
+uint64_t ossl_quic_pacer_get_tx_allowance(QUIC_PACER *pacer)
+{
+    uint64_t cc_limit = pacer->cc_method->get_tx_allowance(pacer->cc_data);
+
+    if (pacer->rate == 0 || cc_limit == 0)
+        return cc_limit;
+
+    pacer_refill(pacer, pacer->now(pacer->now_arg));
+    if (pacer->tokens <= 0)
+        return 0;
+
+    return (uint64_t)pacer->tokens < cc_limit
+        ? (uint64_t)pacer->tokens : cc_limit;
+}
+
+OSSL_TIME ossl_quic_pacer_get_wakeup_deadline(QUIC_PACER *pacer)
+{
+    uint64_t need;
+    int err = 0;
+
+    if (pacer->rate == 0
+        || pacer->cc_method->get_tx_allowance(pacer->cc_data) == 0)
+        return pacer->cc_method->get_wakeup_deadline(pacer->cc_data);
+
+    pacer_refill(pacer, pacer->now(pacer->now_arg));
+    if (pacer->tokens > 0)
+        return ossl_time_zero();
+
+    /*
+     * Wait until a full burst has been earned, rather than until the next
+     * packet may go, to limit the number of wakeups.
+     */
+    need = (uint64_t)(pacer_get_burst(pacer) - pacer->tokens);
+    need = safe_muldiv_u64(need, OSSL_TIME_SECOND, pacer->rate, &err);
+    if (err)
+        return ossl_time_infinite();
+
+    return ossl_time_add(pacer->last_refill, ossl_ticks2time(need));
+}
+
+void ossl_quic_pacer_on_data_sent(QUIC_PACER *pacer, uint64_t num_bytes)
+{
+    if (pacer->rate == 0)
+        return;
+
+    pacer_refill(pacer, pacer->now(pacer->now_arg));
+
+    if (num_bytes > INT64_MAX / 2)
+        num_bytes = INT64_MAX / 2;
+    if (pacer->tokens < INT64_MIN / 2)
+        pacer->tokens = INT64_MIN / 2;
+
+    pacer->tokens -= (int64_t)num_bytes;
+}
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2023-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -42,6 +42,7 @@ QUIC_PORT *ossl_quic_port_new(const QUIC_PORT_ARGS *args)
     port->engine        = args->engine;
     port->channel_ctx   = args->channel_ctx;
     port->is_multi_conn = args->is_multi_conn;
+    port->use_seg_offload = args->use_seg_offload != 0;
 
     if (!port_init(port)) {
         OPENSSL_free(port);
@@ -79,6 +80,10 @@ static int port_init(QUIC_PORT *port)
                                         port_default_packet_handler,
                                         port);
 
+    /* Receive datagrams coalesced where asked to and the BIO allows */
+    if (port->use_seg_offload)
+        ossl_quic_demux_set_gro(port->demux, 1);
+
     if ((port->srtm = ossl_quic_srtm_new(port->engine->libctx,
                                          port->engine->propq)) == NULL)
         goto err;
@@ -280,6 +285,58 @@ int ossl_quic_port_set_net_wbio(QUIC_PORT *port, BIO *net_wbio)
     return 1;
 }
 
+/*
+ * QUIC Port: Connection ID Steering
+ * =================================
+ */
+
+int ossl_quic_port_set_steering(QUIC_PORT *port,
+                                unsigned int steer_bits,
+                                unsigned int steer_id,
+                                ossl_quic_port_forward_cb *cb,
+                                void *cb_arg)
+{
+    if (!ossl_quic_lcidm_set_steering(port->lcidm, steer_bits, steer_id))
+        return 0;
+
+    port->steer_id          = steer_id;
+    port->forward_cb        = steer_bits > 0 ? cb : NULL;
+    port->forward_cb_arg    = cb_arg;
+    return 1;
+}
+
+int ossl_quic_port_inject_forwarded(QUIC_PORT *port,
+                                    const unsigned char *data,
+                                    size_t data_len,
+                                    const BIO_ADDR *peer,
+                                    const BIO_ADDR *local)
+{
+    int ok;
+
+    port->in_forward_inject = 1;
+    ok = ossl_quic_demux_inject(port->demux, data, data_len, peer, local);
+    port->in_forward_inject = 0;
+    return ok;
+}
+
+/*
+ * Only Initial and 0-RTT packets can carry a DCID which was chosen by the peer
+ * rather than issued by us.
+ */
+static int port_dcid_may_be_peer_chosen(const QUIC_URXE *e)
+{
+    unsigned char b0 = ossl_quic_urxe_data(e)[0];
+
+    return (b0 & 0x80) != 0 && ((b0 >> 4) & 0x3) <= 1;
+}
+
+static void port_forward(QUIC_PORT *port, const QUIC_URXE *e,
+                         unsigned int steer_id)
+{
+    port->forward_cb(ossl_quic_urxe_data(e), e->data_len, &e->peer, &e->local,
+                     steer_id, port->forward_cb_arg);
+}
+
 /*
  * QUIC Port: Channel Lifecycle
  * ============================
@@ -499,6 +556,7 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
     PACKET pkt;
     QUIC_PKT_HDR hdr;
     QUIC_CHANNEL *ch = NULL, *new_ch = NULL;
+    unsigned int steer_id;
 
     /* Don't handle anything if we are no longer running. */
     if (!ossl_quic_port_is_running(port))
@@ -515,6 +573,20 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
         return;
     }
 
+    /*
+     * A DCID we don't know but which was issued by another worker sharing our
+     * UDP port belongs to that worker. Initial and 0-RTT packets are excluded
+     * as their DCID may have been chosen by the client, and so are handled as
+     * new connection attempts below.
+     */
+    if (port->forward_cb != NULL && !port->in_forward_inject && dcid != NULL
+        && !port_dcid_may_be_peer_chosen(e)
+        && ossl_quic_lcidm_get_steering_id(port->lcidm, dcid, &steer_id)
+        && steer_id != port->steer_id) {
+        port_forward(port, e, steer_id);
+        goto undesirable;
+    }
+
     /*
      * If we have an incoming packet which doesn't match any existing connection
      * we assume this is an attempt to make a new connection. Currently we
@@ -524,7 +596,7 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
      * TODO(QUIC SERVER): In the future we will construct channels dynamically
      * in this case.
      */
-    if (port->tserver_ch == NULL)
+    if (port->tserver_ch == NULL && port->forward_cb == NULL)
         goto undesirable;
 
     /*
@@ -563,6 +635,13 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
     if (hdr.type != QUIC_PKT_TYPE_INITIAL)
         goto undesirable;
 
+    /* Offer the connection attempt to another worker if we cannot accept it. */
+    if (port->tserver_ch == NULL) {
+        if (!port->in_forward_inject)
+            port_forward(port, e, QUIC_PORT_STEER_ANY);
+        goto undesirable;
+    }
+
     /*
      * Try to process this as a valid attempt to initiate a connection.
      *
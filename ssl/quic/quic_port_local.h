@@ -1,5 +1,5 @@
 /*
- * Copyright 2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -71,6 +71,16 @@ struct quic_port_st {
     /* SRTM used for incoming packet routing by SRT. */
     QUIC_SRTM                       *srtm;
 
+    /*
+     * Called for packets which belong to, or are offered to, another worker
+     * sharing our UDP port. NULL unless steering has been configured.
+     */
+    ossl_quic_port_forward_cb       *forward_cb;
+    void                            *forward_cb_arg;
+
+    /* Steering ID embedded in our LCIDs, if forward_cb is set. */
+    unsigned int                    steer_id;
+
     /* Port-level permanent errors (causing failure state) are stored here. */
     ERR_STATE                       *err_state;
 
@@ -85,6 +95,9 @@ struct quic_port_st {
     /* Is this port created to support multiple connections? */
     unsigned int                    is_multi_conn                   : 1;
 
+    /* Should UDP segmentation offload be used where available? */
+    unsigned int                    use_seg_offload                 : 1;
+
     /* Has this port sent any packet of any kind yet? */
     unsigned int                    have_sent_any_pkt               : 1;
 
@@ -93,6 +106,9 @@ struct quic_port_st {
 
     /* Are we on the QUIC_ENGINE linked list of ports? */
     unsigned int                    on_engine_list                  : 1;
+
+    /* Are we processing a datagram forwarded from another worker? */
+    unsigned int                    in_forward_inject               : 1;
 };
 
 # endif
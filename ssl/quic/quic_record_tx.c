@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -61,6 +61,12 @@ struct ossl_qtx_st {
     /* TX BIO. */
     BIO                        *bio;
 
+    /* Whether to coalesce datagrams using UDP GSO, and whether the BIO can. */
+    char                        want_gso, use_gso;
+
+    /* GSO super-buffer, allocated on first use. */
+    unsigned char              *gso_buf;
+
     /* QLOG instance retrieval callback if in use, or NULL. */
     QLOG                     *(*get_qlog_cb)(void *arg);
     void                       *get_qlog_cb_arg;
@@ -109,6 +115,13 @@ struct ossl_qtx_st {
     SSL *msg_callback_ssl;
 };
 
+static void qtx_update_gso(OSSL_QTX *qtx)
+{
+    qtx->use_gso = qtx->want_gso && qtx->bio != NULL
+        && BIO_dgram_get_gso_cap(qtx->bio)
+        && BIO_dgram_set_gso_enable(qtx->bio, 1);
+}
+
 /* Instantiates a new QTX. */
 OSSL_QTX *ossl_qtx_new(const OSSL_QTX_ARGS *args)
 {
@@ -127,6 +140,8 @@ OSSL_QTX *ossl_qtx_new(const OSSL_QTX_ARGS *args)
     qtx->mdpl               = args->mdpl;
     qtx->get_qlog_cb        = args->get_qlog_cb;
     qtx->get_qlog_cb_arg    = args->get_qlog_cb_arg;
+    qtx->want_gso           = args->use_gso != 0;
+    qtx_update_gso(qtx);
 
     return qtx;
 }
@@ -153,6 +168,7 @@ void ossl_qtx_free(OSSL_QTX *qtx)
     qtx_cleanup_txl(&qtx->pending);
     qtx_cleanup_txl(&qtx->free);
     OPENSSL_free(qtx->cons);
+    OPENSSL_free(qtx->gso_buf);
 
     /* Drop keying material and crypto resources. */
     for (i = 0; i < QUIC_ENC_LEVEL_NUM; ++i)
@@ -929,10 +945,47 @@ static void txe_to_msg(TXE *txe, BIO_MSG *msg)
 
 #define MAX_MSGS_PER_SEND   32
 
+/*
+ * Limits on a GSO super-buffer: the kernel refuses more than 64 segments, and
+ * the whole buffer must fit in a single UDP/IPv4 datagram.
+ */
+#define GSO_MAX_SEGS        64
+#define GSO_MAX_BYTES       (65535 - 20 - 8)
+
+/*
+ * Determines how many pending TXEs starting at txe can be sent as a single GSO
+ * super-buffer: they must have the same addresses and, except for the last
+ * one which may be shorter, the same length. Returns the number of TXEs and
+ * their total length in *plen.
+ */
+static size_t qtx_gso_count(TXE *txe, size_t *plen)
+{
+    size_t seg = txe->data_len, n = 1, len = txe->data_len;
+    TXE *next;
+
+    for (next = ossl_list_txe_next(txe);
+         next != NULL && n < GSO_MAX_SEGS
+             && next->data_len <= seg && len + next->data_len <= GSO_MAX_BYTES
+             && addr_eq(&next->peer, &txe->peer)
+             && addr_eq(&next->local, &txe->local);
+         next = ossl_list_txe_next(next)) {
+        len += next->data_len;
+        ++n;
+        if (next->data_len < seg)
+            break;
+    }
+
+    *plen = len;
+    return n;
+}
+
 int ossl_qtx_flush_net(OSSL_QTX *qtx)
 {
     BIO_MSG msg[MAX_MSGS_PER_SEND];
-    size_t wr, i, total_written = 0;
+    size_t num_txe[MAX_MSGS_PER_SEND];
+    size_t wr, i, j, n, len, total_written = 0;
+    unsigned char *p;
+    int gso_used, ret = QTX_FLUSH_NET_RES_TRANSIENT_FAIL;
     TXE *txe;
     int res;
 
@@ -943,10 +996,38 @@ int ossl_qtx_flush_net(OSSL_QTX *qtx)
         return QTX_FLUSH_NET_RES_PERMANENT_FAIL;
 
     for (;;) {
+        /*
+         * With GSO, the first run of datagrams which can be coalesced is
+         * copied into a super-buffer which the kernel splits again. Only one
+         * super-buffer is sent per call, further runs go into the next one.
+         */
+        gso_used = 0;
         for (txe = ossl_list_txe_head(&qtx->pending), i = 0;
-             txe != NULL && i < OSSL_NELEM(msg);
-             txe = ossl_list_txe_next(txe), ++i)
+             txe != NULL && i < OSSL_NELEM(msg); ++i) {
+            n = qtx->use_gso ? qtx_gso_count(txe, &len) : 1;
+            if (n > 1 && gso_used)
+                break;
+
+            if (n > 1 && qtx->gso_buf == NULL
+                && (qtx->gso_buf = OPENSSL_malloc(GSO_MAX_BYTES)) == NULL)
+                n = 1;
+
             txe_to_msg(txe, &msg[i]);
+            if (n > 1) {
+                msg[i].data     = qtx->gso_buf;
+                msg[i].data_len = len;
+                msg[i].flags    = txe->data_len;
+                for (j = 0, p = qtx->gso_buf; j < n;
+                     ++j, txe = ossl_list_txe_next(txe)) {
+                    memcpy(p, txe_data(txe), txe->data_len);
+                    p += txe->data_len;
+                }
+                gso_used = 1;
+            } else {
+                txe = ossl_list_txe_next(txe);
+            }
+            num_txe[i] = n;
+        }
 
         if (!i)
             /* Nothing to send. */
@@ -969,10 +1050,19 @@ int ossl_qtx_flush_net(OSSL_QTX *qtx)
                 /* Transient error, just stop for now, clearing the error. */
                 ERR_pop_to_mark();
                 break;
+            } else if (gso_used) {
+                /*
+                 * The path may not support segmentation offload after all
+                 * (e.g. no checksum offload), retry without it.
+                 */
+                ERR_pop_to_mark();
+                qtx->use_gso = 0;
+                continue;
             } else {
                 /* Non-transient error, fail and do not clear the error. */
                 ERR_clear_last_mark();
-                return QTX_FLUSH_NET_RES_PERMANENT_FAIL;
+                ret = QTX_FLUSH_NET_RES_PERMANENT_FAIL;
+                goto end;
             }
         }
 
@@ -981,21 +1071,25 @@ int ossl_qtx_flush_net(OSSL_QTX *qtx)
         /*
          * Remove everything which was successfully sent from the pending queue.
          */
-        for (i = 0; i < wr; ++i) {
-            if (qtx->msg_callback != NULL)
-                qtx->msg_callback(1, OSSL_QUIC1_VERSION, SSL3_RT_QUIC_DATAGRAM,
-                                msg[i].data, msg[i].data_len,
-                                qtx->msg_callback_ssl,
-                                qtx->msg_callback_arg);
-            qtx_pending_to_free(qtx);
-        }
+        for (i = 0; i < wr; ++i)
+            for (j = 0; j < num_txe[i]; ++j) {
+                txe = ossl_list_txe_head(&qtx->pending);
+                if (qtx->msg_callback != NULL)
+                    qtx->msg_callback(1, OSSL_QUIC1_VERSION,
+                                      SSL3_RT_QUIC_DATAGRAM,
+                                      txe_data(txe), txe->data_len,
+                                      qtx->msg_callback_ssl,
+                                      qtx->msg_callback_arg);
+                qtx_pending_to_free(qtx);
+            }
 
         total_written += wr;
     }
 
-    return total_written > 0
-        ? QTX_FLUSH_NET_RES_OK
-        : QTX_FLUSH_NET_RES_TRANSIENT_FAIL;
+    if (total_written > 0)
+        ret = QTX_FLUSH_NET_RES_OK;
+ end:
+    return ret;
 }
 
 int ossl_qtx_pop_net(OSSL_QTX *qtx, BIO_MSG *msg)
@@ -1013,6 +1107,7 @@ int ossl_qtx_pop_net(OSSL_QTX *qtx, BIO_MSG *msg)
 void ossl_qtx_set_bio(OSSL_QTX *qtx, BIO *bio)
 {
     qtx->bio = bio;
+    qtx_update_gso(qtx);
 }
 
 int ossl_qtx_set_mdpl(OSSL_QTX *qtx, size_t mdpl)
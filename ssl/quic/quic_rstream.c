@@ -1,5 +1,5 @@
 /*
-* Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+* Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
 *
 * Licensed under the Apache License 2.0 (the "License").  You may not use
 * this file except in compliance with the License.  You can obtain a copy
@@ -260,6 +260,101 @@ int ossl_quic_rstream_release_record(QUIC_RSTREAM *qrs, size_t read_len)
     return 1;
 }
 
+int ossl_quic_rstream_peek_segments(QUIC_RSTREAM *qrs, SSL_READ_SEGMENT *segs,
+                                    size_t num_segs, size_t *segs_out,
+                                    size_t *readbytes, int *fin)
+{
+    void *iter = NULL;
+    UINT_RANGE range;
+    const unsigned char *data;
+    size_t n = 0, readbytes_ = 0, l, max_len;
+    int fin_ = 0;
+
+    while (n < num_segs
+           && ossl_sframe_list_peek(&qrs->fl, &iter, &range, &data, &fin_)) {
+        l = (size_t)(range.end - range.start);
+        if (l == 0)
+            break;
+
+        if (l > SIZE_MAX - readbytes_) {
+            l = SIZE_MAX - readbytes_;
+            fin_ = 0;
+        }
+
+        if (data == NULL) {
+            /* The data may wrap around the end of the ring buffer. */
+            data = ring_buf_get_ptr(&qrs->rbuf, range.start, &max_len);
+            if (!ossl_assert(data != NULL))
+                return 0;
+
+            if (max_len < l) {
+                segs[n].data        = data;
+                segs[n].data_len    = max_len;
+                readbytes_          += max_len;
+                l                   -= max_len;
+                if (++n == num_segs) {
+                    fin_ = 0;
+                    break;
+                }
+
+                data = ring_buf_get_ptr(&qrs->rbuf, range.start + max_len,
+                                        &max_len);
+                if (!ossl_assert(data != NULL) || !ossl_assert(max_len >= l))
+                    return 0;
+            }
+        }
+
+        segs[n].data        = data;
+        segs[n].data_len    = l;
+        readbytes_          += l;
+        ++n;
+
+        if (readbytes_ == SIZE_MAX)
+            break;
+    }
+
+    /*
+     * If we filled all of the segments, there may be more data after them, in
+     * which case we have not reached the end of the stream.
+     */
+    if (fin_ && n == num_segs
+        && ossl_sframe_list_peek(&qrs->fl, &iter, &range, &data, &fin_))
+        fin_ = 0;
+
+    ossl_sframe_list_pin(&qrs->fl, qrs->fl.offset + readbytes_);
+
+    *segs_out   = n;
+    *readbytes  = readbytes_;
+    *fin        = fin_;
+    return 1;
+}
+
+int ossl_quic_rstream_release_segments(QUIC_RSTREAM *qrs, size_t len,
+                                       int *fin)
+{
+    uint64_t offset = qrs->fl.offset + len;
+    size_t avail;
+
+    if (len > 0) {
+        if (!ossl_sframe_list_is_pinned(&qrs->fl)
+            || offset > qrs->fl.pinned_end)
+            return 0;
+
+        if (!ossl_sframe_list_drop_frames(&qrs->fl, offset))
+            return 0;
+
+        ring_buf_cpop_range(&qrs->rbuf, 0, offset - 1, qrs->fl.cleanse);
+    } else {
+        ossl_sframe_list_pin(&qrs->fl, 0);
+    }
+
+    if (!ossl_quic_rstream_available(qrs, &avail, fin))
+        return 0;
+
+    *fin = *fin && avail == 0;
+    return 1;
+}
+
 static int write_at_ring_buf_cb(uint64_t logical_offset,
                                 const unsigned char *buf,
                                 size_t buf_len,
@@ -280,7 +375,8 @@ int ossl_quic_rstream_move_to_rbuf(QUIC_RSTREAM *qrs)
 
 int ossl_quic_rstream_resize_rbuf(QUIC_RSTREAM *qrs, size_t rbuf_size)
 {
-    if (ossl_sframe_list_is_head_locked(&qrs->fl))
+    if (ossl_sframe_list_is_head_locked(&qrs->fl)
+        || ossl_sframe_list_is_pinned(&qrs->fl))
         return 0;
 
     if (!ring_buf_resize(&qrs->rbuf, rbuf_size, qrs->fl.cleanse))
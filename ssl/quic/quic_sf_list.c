@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -81,6 +81,7 @@ int ossl_sframe_list_insert(SFRAME_LIST *fl, UINT_RANGE *range,
                             const unsigned char *data, int fin)
 {
     STREAM_FRAME *sf, *new_frame, *prev_frame, *next_frame;
+    UINT_RANGE clipped;
 #ifndef NDEBUG
     uint64_t curr_end = fl->tail != NULL ? fl->tail->range.end
                                          : fl->offset;
@@ -90,9 +91,22 @@ int ossl_sframe_list_insert(SFRAME_LIST *fl, UINT_RANGE *range,
            && (!fl->fin || curr_end >= range->end));
 #endif
 
-    if (fl->offset >= range->end)
+    if (fl->offset >= range->end || fl->pinned_end >= range->end)
         goto end;
 
+    /*
+     * Pinned data has been handed out and must stay where it is, so the
+     * new frame must not replace the frames holding it. We have all of the
+     * pinned data already, so we can just ignore that part of the new frame.
+     */
+    if (fl->pinned_end > range->start) {
+        if (data != NULL)
+            data += (size_t)(fl->pinned_end - range->start);
+        clipped.start   = fl->pinned_end;
+        clipped.end     = range->end;
+        range           = &clipped;
+    }
+
     /* nothing there yet */
     if (fl->tail == NULL) {
         fl->tail = fl->head = stream_frame_new(range, pkt, data);
@@ -244,6 +258,7 @@ int ossl_sframe_list_drop_frames(SFRAME_LIST *fl, uint64_t limit)
         fl->tail = NULL;
 
     fl->head_locked = 0;
+    fl->pinned_end  = 0;
 
     return 1;
 }
@@ -269,6 +284,16 @@ int ossl_sframe_list_is_head_locked(SFRAME_LIST *fl)
     return fl->head_locked;
 }
 
+void ossl_sframe_list_pin(SFRAME_LIST *fl, uint64_t end)
+{
+    fl->pinned_end = end > fl->offset ? end : 0;
+}
+
+int ossl_sframe_list_is_pinned(SFRAME_LIST *fl)
+{
+    return fl->pinned_end != 0;
+}
+
 int ossl_sframe_list_move_data(SFRAME_LIST *fl,
                                sframe_list_write_at_cb *write_at_cb,
                                void *cb_arg)
@@ -282,6 +307,10 @@ int ossl_sframe_list_move_data(SFRAME_LIST *fl,
     if (fl->head_locked)
         sf = sf->next;
 
+    /* Pinned data must not move, nor may it be merged with other frames. */
+    while (sf != NULL && sf->range.start < fl->pinned_end)
+        sf = sf->next;
+
     for (; sf != NULL; sf = sf->next) {
         size_t len;
         const unsigned char *data = sf->data;
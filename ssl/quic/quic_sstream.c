@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -16,8 +16,40 @@
  * ==================================================================
  * QUIC Send Stream
  */
+
+/*
+ * A range of the stream whose data is held in a buffer owned by the
+ * application rather than in our ring buffer.
+ */
+typedef struct qss_ref_st {
+    /* Logical offset of the first byte of the range in the stream. */
+    uint64_t                    start;
+    /* Total length of all referenced ranges before this one. */
+    uint64_t                    ref_before;
+    const unsigned char         *buf;
+    size_t                      len;
+    ossl_quic_sstream_release_cb *release_cb;
+    void                        *release_arg;
+    unsigned int                released : 1;
+} QSS_REF;
+
 struct quic_sstream_st {
+    /*
+     * Stream data which is copied in by ossl_quic_sstream_append() lives in the
+     * ring buffer. Stream data which is appended by reference using
+     * ossl_quic_sstream_append_ref() does not; such ranges are recorded in the
+     * refs array in ascending order, and the logical stream offset of a byte
+     * held in the ring buffer is its offset in the ring buffer plus the total
+     * length of all referenced ranges which precede it.
+     *
+     * refs[refs_first] to refs[refs_num - 1] are the referenced ranges which
+     * have not yet been retired; ranges are retired once they and everything
+     * before them have been acknowledged.
+     */
     struct ring_buf ring_buf;
+    QSS_REF         *refs;
+    size_t          refs_first, refs_num, refs_alloc;
+    uint64_t        refs_total;
 
     /*
      * Any logical byte in the stream is in one of these states:
@@ -46,7 +78,7 @@ struct quic_sstream_st {
     UINT_SET        new_set, acked_set;
 
     /*
-     * The current size of the stream is ring_buf.head_offset. If
+     * The current size of the stream is ring_buf.head_offset + refs_total. If
      * have_final_size is true, this is also the final size of the stream.
      */
     unsigned int    have_final_size     : 1;
@@ -57,6 +89,111 @@ struct quic_sstream_st {
 
 static void qss_cull(QUIC_SSTREAM *qss);
 
+static ossl_inline uint64_t qss_size(const QUIC_SSTREAM *qss)
+{
+    return qss->ring_buf.head_offset + qss->refs_total;
+}
+
+/*
+ * Returns the index of the first referenced range which starts after the
+ * logical offset off, or refs_num if there is none.
+ */
+static size_t qss_ref_upper(const QUIC_SSTREAM *qss, uint64_t off)
+{
+    size_t lo = qss->refs_first, hi = qss->refs_num, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (qss->refs[mid].start <= off)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/* Returns the number of bytes in [0, off) which are held in the ring buffer. */
+static uint64_t qss_ring_count(const QUIC_SSTREAM *qss, uint64_t off)
+{
+    size_t i;
+    const QSS_REF *ref;
+
+    if (off == 0)
+        return 0;
+
+    i = qss_ref_upper(qss, off - 1);
+    if (i > qss->refs_first) {
+        ref = &qss->refs[i - 1];
+        if (off - ref->start < ref->len)
+            return ref->start - ref->ref_before;
+
+        return off - ref->ref_before - ref->len;
+    }
+
+    return off - (i < qss->refs_num ? qss->refs[i].ref_before
+                                    : qss->refs_total);
+}
+
+/*
+ * Gets a pointer to the contiguous run of stream data which starts at logical
+ * offset off, in the same manner as ring_buf_get_buf_at().
+ */
+static int qss_get_buf_at(const QUIC_SSTREAM *qss, uint64_t off,
+                          const unsigned char **buf, size_t *buf_len)
+{
+    size_t i = qss_ref_upper(qss, off);
+    const QSS_REF *ref;
+    uint64_t ring_off;
+
+    if (i > qss->refs_first) {
+        ref = &qss->refs[i - 1];
+        if (off - ref->start < ref->len) {
+            /* Never hand out a buffer which has been given back. */
+            if (ref->released)
+                return 0;
+
+            *buf        = ref->buf + (off - ref->start);
+            *buf_len    = ref->len - (size_t)(off - ref->start);
+            return 1;
+        }
+    }
+
+    ring_off = qss_ring_count(qss, off);
+    if (!ring_buf_get_buf_at(&qss->ring_buf, ring_off, buf, buf_len))
+        return 0;
+
+    /* Stop at the next referenced range, if any. */
+    if (i < qss->refs_num && *buf_len > qss->refs[i].start - off)
+        *buf_len = (size_t)(qss->refs[i].start - off);
+
+    return 1;
+}
+
+static void qss_ref_release(QSS_REF *ref)
+{
+    if (ref->released)
+        return;
+
+    ref->released = 1;
+    if (ref->release_cb != NULL)
+        ref->release_cb(ref->buf, ref->len, ref->release_arg);
+}
+
+/* Returns 1 if every byte in [start, end] has been acknowledged. */
+static int qss_is_acked(const QUIC_SSTREAM *qss, uint64_t start, uint64_t end)
+{
+    const UINT_SET_ITEM *x;
+
+    for (x = ossl_list_uint_set_head(&qss->acked_set);
+         x != NULL && x->range.start <= start;
+         x = ossl_list_uint_set_next(x))
+        if (x->range.end >= end)
+            return 1;
+
+    return 0;
+}
+
 QUIC_SSTREAM *ossl_quic_sstream_new(size_t init_buf_size)
 {
     QUIC_SSTREAM *qss;
@@ -79,9 +216,15 @@ QUIC_SSTREAM *ossl_quic_sstream_new(size_t init_buf_size)
 
 void ossl_quic_sstream_free(QUIC_SSTREAM *qss)
 {
+    size_t i;
+
     if (qss == NULL)
         return;
 
+    for (i = qss->refs_first; i < qss->refs_num; ++i)
+        qss_ref_release(&qss->refs[i]);
+
+    OPENSSL_free(qss->refs);
     ossl_uint_set_destroy(&qss->new_set);
     ossl_uint_set_destroy(&qss->acked_set);
     ring_buf_destroy(&qss->ring_buf, qss->cleanse);
@@ -94,70 +237,84 @@ int ossl_quic_sstream_get_stream_frame(QUIC_SSTREAM *qss,
                                        OSSL_QTX_IOVEC *iov,
                                        size_t *num_iov)
 {
-    size_t num_iov_ = 0, src_len = 0, total_len = 0, i;
-    uint64_t max_len;
+    size_t num_iov_, src_len = 0, total_len, i;
+    uint64_t pos, max_len;
     const unsigned char *src = NULL;
     UINT_SET_ITEM *range = ossl_list_uint_set_head(&qss->new_set);
 
     if (*num_iov < 2)
         return 0;
 
-    for (i = 0; i < skip && range != NULL; ++i)
-        range = ossl_list_uint_set_next(range);
-
-    if (range == NULL) {
-        if (i < skip)
-            /* Don't return FIN for infinitely increasing skip */
-            return 0;
-
-        /* No new bytes to send, but we might have a FIN */
-        if (!qss->have_final_size || qss->sent_final_size)
-            return 0;
-
-        hdr->offset = qss->ring_buf.head_offset;
-        hdr->len    = 0;
-        hdr->is_fin = 1;
-        *num_iov    = 0;
-        return 1;
-    }
-
-    /*
-     * We can only send a contiguous range of logical bytes in a single
-     * stream frame, so limit ourselves to the range of the first set entry.
-     *
-     * Set entries never have 'adjacent' entries so we don't have to worry
-     * about them here.
-     */
-    max_len = range->range.end - range->range.start + 1;
+    pos = range != NULL ? range->range.start : 0;
 
     for (i = 0;; ++i) {
-        if (total_len >= max_len)
-            break;
+        if (range == NULL) {
+            if (i < skip)
+                /* Don't return FIN for infinitely increasing skip */
+                return 0;
+
+            /* No new bytes to send, but we might have a FIN */
+            if (!qss->have_final_size || qss->sent_final_size)
+                return 0;
+
+            hdr->offset = qss_size(qss);
+            hdr->len    = 0;
+            hdr->is_fin = 1;
+            *num_iov    = 0;
+            return 1;
+        }
+
+        /*
+         * We can only send a contiguous range of logical bytes in a single
+         * stream frame, so limit ourselves to the range of the current set
+         * entry.
+         *
+         * Set entries never have 'adjacent' entries so we don't have to worry
+         * about them here.
+         */
+        max_len     = range->range.end - pos + 1;
+        total_len   = 0;
+        num_iov_    = 0;
+
+        while (total_len < max_len && num_iov_ < *num_iov) {
+            if (!qss_get_buf_at(qss, pos + total_len, &src, &src_len))
+                return 0;
+
+            if (src_len == 0)
+                break;
+
+            if (total_len + src_len > max_len)
+                src_len = (size_t)(max_len - total_len);
+
+            iov[num_iov_].buf       = src;
+            iov[num_iov_].buf_len   = src_len;
+
+            total_len += src_len;
+            ++num_iov_;
+        }
 
-        if (!ring_buf_get_buf_at(&qss->ring_buf,
-                                 range->range.start + total_len,
-                                 &src, &src_len))
+        if (total_len == 0)
             return 0;
 
-        if (src_len == 0)
+        if (i == skip)
             break;
 
-        assert(i < 2);
-
-        if (total_len + src_len > max_len)
-            src_len = (size_t)(max_len - total_len);
-
-        iov[num_iov_].buf       = src;
-        iov[num_iov_].buf_len   = src_len;
-
-        total_len += src_len;
-        ++num_iov_;
+        /*
+         * The frame may not cover all of the set entry if we ran out of IOVs,
+         * in which case the next frame starts where this one ends.
+         */
+        pos += total_len;
+        if (pos > range->range.end) {
+            range = ossl_list_uint_set_next(range);
+            if (range != NULL)
+                pos = range->range.start;
+        }
     }
 
-    hdr->offset = range->range.start;
+    hdr->offset = pos;
     hdr->len    = total_len;
     hdr->is_fin = qss->have_final_size
-        && hdr->offset + hdr->len == qss->ring_buf.head_offset;
+        && hdr->offset + hdr->len == qss_size(qss);
 
     *num_iov    = num_iov_;
     return 1;
@@ -174,7 +331,7 @@ int ossl_quic_sstream_has_pending(QUIC_SSTREAM *qss)
 
 uint64_t ossl_quic_sstream_get_cur_size(QUIC_SSTREAM *qss)
 {
-    return qss->ring_buf.head_offset;
+    return qss_size(qss);
 }
 
 int ossl_quic_sstream_mark_transmitted(QUIC_SSTREAM *qss,
@@ -199,7 +356,7 @@ int ossl_quic_sstream_mark_transmitted_fin(QUIC_SSTREAM *qss,
      * We do not really need final_size since we already know the size of the
      * stream, but this serves as a sanity check.
      */
-    if (!qss->have_final_size || final_size != qss->ring_buf.head_offset)
+    if (!qss->have_final_size || final_size != qss_size(qss))
         return 0;
 
     qss->sent_final_size = 1;
@@ -240,12 +397,26 @@ int ossl_quic_sstream_mark_acked(QUIC_SSTREAM *qss,
                                  uint64_t end)
 {
     UINT_RANGE r;
+    size_t i;
+
     r.start = start;
     r.end   = end;
 
     if (!ossl_uint_set_insert(&qss->acked_set, &r))
         return 0;
 
+    /* Give back any referenced buffers which are now fully acknowledged. */
+    for (i = qss_ref_upper(qss, end); i > qss->refs_first; --i) {
+        QSS_REF *ref = &qss->refs[i - 1];
+
+        if (ref->start + ref->len <= start)
+            break;
+
+        if (!ref->released
+            && qss_is_acked(qss, ref->start, ref->start + ref->len - 1))
+            qss_ref_release(ref);
+    }
+
     qss_cull(qss);
     return 1;
 }
@@ -274,7 +445,7 @@ int ossl_quic_sstream_get_final_size(QUIC_SSTREAM *qss, uint64_t *final_size)
         return 0;
 
     if (final_size != NULL)
-        *final_size = qss->ring_buf.head_offset;
+        *final_size = qss_size(qss);
 
     return 1;
 }
@@ -299,10 +470,9 @@ int ossl_quic_sstream_append(QUIC_SSTREAM *qss,
      * such semantics. In particular, the buffer pointed to by buf is only
      * assumed to be valid for the duration of this call, therefore we must copy
      * the data here. We will later copy-and-encrypt the data during packet
-     * encryption, so this is a two-copy design. Supporting a one-copy design in
-     * the future will require applications to use a different kind of API.
-     * Supporting such changes in future will require corresponding enhancements
-     * to this code.
+     * encryption, so this is a two-copy design. Applications which can keep
+     * their buffers alive until the data is acknowledged can avoid the first
+     * copy; see ossl_quic_sstream_append_ref().
      */
     while (buf_len > 0) {
         l = ring_buf_push(&qss->ring_buf, buf, buf_len);
@@ -315,9 +485,9 @@ int ossl_quic_sstream_append(QUIC_SSTREAM *qss,
     }
 
     if (consumed_ > 0) {
-        r.start = old_ring_buf.head_offset;
+        r.start = old_ring_buf.head_offset + qss->refs_total;
         r.end   = r.start + consumed_ - 1;
-        assert(r.end + 1 == qss->ring_buf.head_offset);
+        assert(r.end + 1 == qss_size(qss));
         if (!ossl_uint_set_insert(&qss->new_set, &r)) {
             qss->ring_buf = old_ring_buf;
             *consumed = 0;
@@ -329,9 +499,66 @@ int ossl_quic_sstream_append(QUIC_SSTREAM *qss,
     return 1;
 }
 
+int ossl_quic_sstream_append_ref(QUIC_SSTREAM *qss,
+                                 const unsigned char *buf,
+                                 size_t buf_len,
+                                 ossl_quic_sstream_release_cb *release_cb,
+                                 void *release_arg)
+{
+    QSS_REF *ref;
+    UINT_RANGE r;
+    size_t new_alloc;
+
+    if (qss->have_final_size || buf_len > MAX_OFFSET - qss_size(qss))
+        return 0;
+
+    if (buf_len == 0) {
+        if (release_cb != NULL)
+            release_cb(buf, buf_len, release_arg);
+        return 1;
+    }
+
+    if (qss->refs_num == qss->refs_alloc) {
+        if (qss->refs_first > 0) {
+            /* Reclaim the space used by retired entries. */
+            memmove(qss->refs, qss->refs + qss->refs_first,
+                    (qss->refs_num - qss->refs_first) * sizeof(*qss->refs));
+            qss->refs_num   -= qss->refs_first;
+            qss->refs_first = 0;
+        } else {
+            new_alloc = qss->refs_alloc == 0 ? 8 : qss->refs_alloc * 2;
+            ref = OPENSSL_realloc(qss->refs, new_alloc * sizeof(*qss->refs));
+            if (ref == NULL)
+                return 0;
+
+            qss->refs       = ref;
+            qss->refs_alloc = new_alloc;
+        }
+    }
+
+    r.start = qss_size(qss);
+    r.end   = r.start + buf_len - 1;
+    if (!ossl_uint_set_insert(&qss->new_set, &r))
+        return 0;
+
+    ref = &qss->refs[qss->refs_num++];
+    ref->start          = r.start;
+    ref->ref_before     = qss->refs_total;
+    ref->buf            = buf;
+    ref->len            = buf_len;
+    ref->release_cb     = release_cb;
+    ref->release_arg    = release_arg;
+    ref->released       = 0;
+
+    qss->refs_total += buf_len;
+    return 1;
+}
+
 static void qss_cull(QUIC_SSTREAM *qss)
 {
     UINT_SET_ITEM *h = ossl_list_uint_set_head(&qss->acked_set);
+    uint64_t ring_start, ring_end;
+    QSS_REF *ref;
 
     /*
      * Potentially cull data from our ring buffer. This can happen once data has
@@ -349,9 +576,40 @@ static void qss_cull(QUIC_SSTREAM *qss)
      * We only need to check the first range entry in the integer set because we
      * can only cull contiguous areas at the start of the ring buffer anyway.
      */
-    if (h != NULL)
+    if (h == NULL)
+        return;
+
+    /*
+     * The range is in logical stream offsets, which we need to translate into
+     * ring buffer offsets. Referenced ranges which are no longer needed to
+     * perform this translation for data we might still transmit are retired.
+     */
+    if (qss->refs_total == 0) {
         ring_buf_cpop_range(&qss->ring_buf, h->range.start, h->range.end,
                             qss->cleanse);
+        return;
+    }
+
+    ring_start  = qss_ring_count(qss, h->range.start);
+    ring_end    = qss_ring_count(qss, h->range.end + 1);
+    if (ring_end > ring_start && ring_end > qss->ring_buf.ctail_offset)
+        ring_buf_cpop_range(&qss->ring_buf, ring_start, ring_end - 1,
+                            qss->cleanse);
+
+    if (h->range.start != 0)
+        return;
+
+    while (qss->refs_first < qss->refs_num) {
+        ref = &qss->refs[qss->refs_first];
+        if (ref->start + ref->len - 1 > h->range.end)
+            break;
+
+        qss_ref_release(ref);
+        ++qss->refs_first;
+    }
+
+    if (qss->refs_first == qss->refs_num)
+        qss->refs_first = qss->refs_num = 0;
 }
 
 int ossl_quic_sstream_set_buffer_size(QUIC_SSTREAM *qss, size_t num_bytes)
@@ -389,7 +647,7 @@ int ossl_quic_sstream_is_totally_acked(QUIC_SSTREAM *qss)
         return 0;
 
     r = ossl_list_uint_set_head(&qss->acked_set)->range;
-    cur_size = qss->ring_buf.head_offset;
+    cur_size = qss_size(qss);
 
     /*
      * The invariants of UINT_SET guarantee a single list element if we have a
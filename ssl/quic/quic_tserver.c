@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -130,6 +130,7 @@ QUIC_TSERVER *ossl_quic_tserver_new(const QUIC_TSERVER_ARGS *args,
 
     port_args.channel_ctx       = srv->ctx;
     port_args.is_multi_conn     = 1;
+    port_args.use_seg_offload   = srv->args.use_seg_offload;
 
     if ((srv->port = ossl_quic_engine_create_port(srv->engine, &port_args)) == NULL)
         goto err;
@@ -436,6 +437,26 @@ SSL_CTX *ossl_quic_tserver_get0_ssl_ctx(QUIC_TSERVER *srv)
     return srv->ctx;
 }
 
+int ossl_quic_tserver_set_steering(QUIC_TSERVER *srv,
+                                   unsigned int steer_bits,
+                                   unsigned int steer_id,
+                                   ossl_quic_port_forward_cb *cb,
+                                   void *cb_arg)
+{
+    return ossl_quic_port_set_steering(srv->port, steer_bits, steer_id,
+                                       cb, cb_arg);
+}
+
+int ossl_quic_tserver_inject_forwarded(QUIC_TSERVER *srv,
+                                       const unsigned char *data,
+                                       size_t data_len,
+                                       const BIO_ADDR *peer,
+                                       const BIO_ADDR *local)
+{
+    return ossl_quic_port_inject_forwarded(srv->port, data, data_len,
+                                           peer, local);
+}
+
 int ossl_quic_tserver_stream_has_peer_stop_sending(QUIC_TSERVER *srv,
                                                    uint64_t stream_id,
                                                    uint64_t *app_error_code)
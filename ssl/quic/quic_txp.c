@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -9,6 +9,7 @@
 
 #include "internal/quic_txp.h"
 #include "internal/quic_fifd.h"
+#include "internal/quic_pacer.h"
 #include "internal/quic_stream_map.h"
 #include "internal/quic_error.h"
 #include "internal/common.h"
@@ -62,6 +63,7 @@ struct ossl_quic_tx_packetiser_st {
 
     /* Subcomponents of the TXP that we own. */
     QUIC_FIFD       fifd;       /* QUIC Frame-in-Flight Dispatcher */
+    QUIC_PACER      pacer;      /* Paces packets allowed by the CC */
 
     /* Internal state. */
     uint64_t        next_pn[QUIC_PN_SPACE_NUM]; /* Next PN to use in given PN space. */
@@ -488,6 +490,14 @@ OSSL_QUIC_TX_PACKETISER *ossl_quic_tx_packetiser_new(const OSSL_QUIC_TX_PACKETIS
         return NULL;
     }
 
+    if (!ossl_quic_pacer_init(&txp->pacer, txp->args.cc_method,
+                              txp->args.cc_data, txp->args.now,
+                              txp->args.now_arg)) {
+        ossl_quic_fifd_cleanup(&txp->fifd);
+        OPENSSL_free(txp);
+        return NULL;
+    }
+
     return txp;
 }
 
@@ -499,6 +509,7 @@ void ossl_quic_tx_packetiser_free(OSSL_QUIC_TX_PACKETISER *txp)
         return;
 
     ossl_quic_tx_packetiser_set_initial_token(txp, NULL, 0, NULL, NULL);
+    ossl_quic_pacer_cleanup(&txp->pacer);
     ossl_quic_fifd_cleanup(&txp->fifd);
     OPENSSL_free(txp->conn_close_frame.reason);
 
@@ -617,6 +628,18 @@ int ossl_quic_tx_packetiser_set_peer(OSSL_QUIC_TX_PACKETISER *txp,
     return 1;
 }
 
+int ossl_quic_tx_packetiser_set_cc_method(OSSL_QUIC_TX_PACKETISER *txp,
+                                          const OSSL_CC_METHOD *cc_method,
+                                          OSSL_CC_DATA *cc_data)
+{
+    if (!ossl_quic_pacer_set_cc_method(&txp->pacer, cc_method, cc_data))
+        return 0;
+
+    txp->args.cc_method = cc_method;
+    txp->args.cc_data   = cc_data;
+    return 1;
+}
+
 void ossl_quic_tx_packetiser_set_ack_tx_cb(OSSL_QUIC_TX_PACKETISER *txp,
                                            void (*cb)(const OSSL_QUIC_FRAME_ACK *ack,
                                                       uint32_t pn_space,
@@ -769,7 +792,7 @@ int ossl_quic_tx_packetiser_generate(OSSL_QUIC_TX_PACKETISER *txp,
     uint32_t conn_close_enc_level = QUIC_ENC_LEVEL_NUM;
     struct txp_pkt pkt[QUIC_ENC_LEVEL_NUM];
     size_t pkts_done = 0;
-    uint64_t cc_limit = txp->args.cc_method->get_tx_allowance(txp->args.cc_data);
+    uint64_t cc_limit = ossl_quic_pacer_get_tx_allowance(&txp->pacer);
     int need_padding = 0, txpim_pkt_reffed;
 
     for (enc_level = QUIC_ENC_LEVEL_INITIAL;
@@ -2156,7 +2179,11 @@ static int txp_plan_stream_chunk(OSSL_QUIC_TX_PACKETISER *txp,
     fc_swm      = ossl_quic_txfc_get_swm(stream_txfc);
     fc_limit    = fc_swm + fc_credit;
 
-    if (chunk->shdr.len > 0 && chunk->shdr.offset + chunk->shdr.len > fc_limit) {
+    /*
+     * This also applies to a FIN without data, as the final size may lie
+     * beyond the limit if data was appended by reference.
+     */
+    if (chunk->shdr.offset + chunk->shdr.len > fc_limit) {
         chunk->shdr.len = (fc_limit <= chunk->shdr.offset)
             ? 0 : fc_limit - chunk->shdr.offset;
         chunk->shdr.is_fin = 0;
@@ -2932,6 +2959,9 @@ static int txp_pkt_commit(OSSL_QUIC_TX_PACKETISER *txp,
     if (!ossl_quic_fifd_pkt_commit(&txp->fifd, tpkt))
         return 0;
 
+    if (tpkt->ackm_pkt.is_inflight)
+        ossl_quic_pacer_on_data_sent(&txp->pacer, tpkt->ackm_pkt.num_bytes);
+
     /*
      * Transmission and Post-Packet Generation Bookkeeping
      * ===================================================
@@ -3146,10 +3176,10 @@ OSSL_TIME ossl_quic_tx_packetiser_get_deadline(OSSL_QUIC_TX_PACKETISER *txp)
                                      ossl_ackm_get_ack_deadline(txp->args.ackm, pn_space));
         }
 
-    /* When will CC let us send more? */
-    if (txp->args.cc_method->get_tx_allowance(txp->args.cc_data) == 0)
+    /* When will CC and pacing let us send more? */
+    if (ossl_quic_pacer_get_tx_allowance(&txp->pacer) == 0)
         deadline = ossl_time_min(deadline,
-                                 txp->args.cc_method->get_wakeup_deadline(txp->args.cc_data));
+                                 ossl_quic_pacer_get_wakeup_deadline(&txp->pacer));
 
     return deadline;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -67,6 +67,16 @@ typedef struct tls_rl_record_st {
     /* where the decode bytes are */
     /* rw */
     unsigned char *input;
+    /*
+     * When encrypting out of place, the first |ext_length| bytes of the
+     * plaintext are read from |ext_input| instead of |input|, or if that is
+     * NULL, from |ext_iovoff| bytes into the segment |ext_iov| onwards
+     */
+    /* w */
+    const unsigned char *ext_input;
+    const SSL_IOVEC *ext_iov;
+    size_t ext_iovoff;
+    size_t ext_length;
     /* only used with decompression - malloc()ed */
     /* r */
     unsigned char *comp;
@@ -338,6 +348,8 @@ struct ossl_record_layer_st {
     unsigned char *iv;     /* static IV */
     unsigned char *nonce;  /* part of static IV followed by sequence number */
     int allow_plain_alerts;
+    /* Whether application data can be encrypted from the caller's buffer */
+    int out_of_place_write;
 
     /* TLS "any" fields */
     /* Set to true if this is the first record in a connection */
@@ -365,6 +377,8 @@ struct ossl_record_layer_st {
     OSSL_FUNC_rlayer_msg_callback_fn *msg_callback;
     OSSL_FUNC_rlayer_security_fn *security;
     OSSL_FUNC_rlayer_padding_fn *padding;
+    OSSL_FUNC_rlayer_buffer_alloc_fn *buffer_alloc;
+    OSSL_FUNC_rlayer_buffer_free_fn *buffer_free;
 
     size_t max_pipelines;
 
@@ -536,4 +550,4 @@ int tls_write_records_default(OSSL_RECORD_LAYER *rl,
 #define TLS_BUFFER_set_app_buffer(b, l)    ((b)->app_buffer = (l))
 #define TLS_BUFFER_is_app_buffer(b)        ((b)->app_buffer)
 
-void ossl_tls_buffer_release(TLS_BUFFER *b);
+void ossl_tls_buffer_release(OSSL_RECORD_LAYER *rl, TLS_BUFFER *b);
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -78,6 +78,13 @@ static int tls13_set_crypto_state(OSSL_RECORD_LAYER *rl, int level,
         ERR_raise(ERR_LIB_SSL, ERR_R_INTERNAL_ERROR);
         return OSSL_RECORD_RETURN_FATAL;
     }
+
+    /*
+     * CCM needs all of the plaintext in a single update, so the record must
+     * be contiguous. The other AEADs can encrypt the application data from
+     * the caller's buffer followed by the inner content type and padding.
+     */
+    rl->out_of_place_write = enc && mode != EVP_CIPH_CCM_MODE;
  end:
     return OSSL_RECORD_RETURN_SUCCESS;
 }
@@ -93,7 +100,7 @@ static int tls13_cipher(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *recs,
     unsigned char *staticiv;
     unsigned char *nonce;
     unsigned char *seq = rl->sequence;
-    int lenu, lenf;
+    int lenu, lenu2 = 0, lenf;
     TLS_RL_RECORD *rec = &recs[0];
     WPACKET wpkt;
     const EVP_CIPHER *cipher;
@@ -228,10 +235,47 @@ static int tls13_cipher(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *recs,
                  && EVP_CipherUpdate(enc_ctx, NULL, &lenu, NULL,
                                      (unsigned int)rec->length) <= 0)
             || EVP_CipherUpdate(enc_ctx, NULL, &lenu, recheader,
-                                sizeof(recheader)) <= 0
-            || EVP_CipherUpdate(enc_ctx, rec->data, &lenu, rec->input,
-                                (unsigned int)rec->length) <= 0
-            || EVP_CipherFinal_ex(enc_ctx, rec->data + lenu, &lenf) <= 0
+                                sizeof(recheader)) <= 0)
+        return 0;
+
+    if (sending && (rec->ext_input != NULL || rec->ext_iov != NULL)) {
+        const SSL_IOVEC *iov = rec->ext_iov;
+        const unsigned char *in = rec->ext_input;
+        size_t left = rec->ext_length, off = rec->ext_iovoff, inl;
+
+        /*
+         * Encrypt the caller's data straight into the record, one segment at
+         * a time if it is spread over several, followed by the content type
+         * and padding which are already in place after it
+         */
+        lenu = 0;
+        while (left > 0) {
+            if (iov != NULL) {
+                in = (const unsigned char *)iov->base + off;
+                inl = iov->len - off < left ? iov->len - off : left;
+                iov++;
+                off = 0;
+            } else {
+                inl = left;
+            }
+            if (EVP_CipherUpdate(enc_ctx, rec->data + lenu, &lenu2, in,
+                                 (unsigned int)inl) <= 0)
+                return 0;
+            lenu += lenu2;
+            left -= inl;
+        }
+        if (EVP_CipherUpdate(enc_ctx, rec->data + lenu, &lenu2,
+                             rec->input + rec->ext_length,
+                             (unsigned int)(rec->length
+                                            - rec->ext_length)) <= 0)
+            return 0;
+        lenu += lenu2;
+    } else if (EVP_CipherUpdate(enc_ctx, rec->data, &lenu, rec->input,
+                                (unsigned int)rec->length) <= 0) {
+        return 0;
+    }
+
+    if (EVP_CipherFinal_ex(enc_ctx, rec->data + lenu, &lenf) <= 0
             || (size_t)(lenu + lenf) != rec->length) {
         return 0;
     }
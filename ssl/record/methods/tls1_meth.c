@@ -621,6 +621,8 @@ int tls1_initialise_write_packets(OSSL_RECORD_LAYER *rl,
         prefixtempl->buf = NULL;
         prefixtempl->version = templates[0].version;
         prefixtempl->buflen = 0;
+        prefixtempl->iov = NULL;
+        prefixtempl->iovoff = 0;
         prefixtempl->type = SSL3_RT_APPLICATION_DATA;
 
         wb = &bufs[0];
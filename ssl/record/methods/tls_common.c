@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -23,9 +23,30 @@
 
 static void tls_int_free(OSSL_RECORD_LAYER *rl);
 
-void ossl_tls_buffer_release(TLS_BUFFER *b)
+/*
+ * Read and write buffers are borrowed from the SSL_CTX buffer pool when
+ * libssl gave us one, and allocated with malloc otherwise.
+ */
+static unsigned char *tls_buffer_alloc(OSSL_RECORD_LAYER *rl, size_t len)
+{
+    if (rl->buffer_alloc != NULL)
+        return rl->buffer_alloc(rl->cbarg, len);
+    return OPENSSL_malloc(len);
+}
+
+static void tls_buffer_free(OSSL_RECORD_LAYER *rl, unsigned char *buf,
+                            size_t len)
+{
+    if (rl->buffer_free != NULL)
+        rl->buffer_free(rl->cbarg, buf, len);
+    else
+        OPENSSL_free(buf);
+}
+
+void ossl_tls_buffer_release(OSSL_RECORD_LAYER *rl, TLS_BUFFER *b)
 {
-    OPENSSL_free(b->buf);
+    if (b->buf != NULL)
+        tls_buffer_free(rl, b->buf, b->len);
     b->buf = NULL;
 }
 
@@ -130,11 +151,12 @@ static void tls_release_write_buffer_int(OSSL_RECORD_LAYER *rl, size_t start)
     while (pipes > start) {
         wb = &rl->wbuf[pipes - 1];
 
-        if (TLS_BUFFER_is_app_buffer(wb))
+        if (TLS_BUFFER_is_app_buffer(wb)) {
             TLS_BUFFER_set_app_buffer(wb, 0);
-        else
-            OPENSSL_free(wb->buf);
-        wb->buf = NULL;
+            wb->buf = NULL;
+        } else {
+            ossl_tls_buffer_release(rl, wb);
+        }
         pipes--;
     }
 }
@@ -186,14 +208,12 @@ int tls_setup_write_buffer(OSSL_RECORD_LAYER *rl, size_t numwpipes,
         if (len == 0)
             len = defltlen;
 
-        if (thiswb->len != len) {
-            OPENSSL_free(thiswb->buf);
-            thiswb->buf = NULL;         /* force reallocation */
-        }
+        if (thiswb->len != len)
+            ossl_tls_buffer_release(rl, thiswb); /* force reallocation */
 
         p = thiswb->buf;
         if (p == NULL) {
-            p = OPENSSL_malloc(len);
+            p = tls_buffer_alloc(rl, len);
             if (p == NULL) {
                 if (rl->numwpipes < currpipe)
                     rl->numwpipes = currpipe;
@@ -258,7 +278,7 @@ int tls_setup_read_buffer(OSSL_RECORD_LAYER *rl)
         if (b->default_len > len)
             len = b->default_len;
 
-        if ((p = OPENSSL_malloc(len)) == NULL) {
+        if ((p = tls_buffer_alloc(rl, len)) == NULL) {
             /*
              * We've got a malloc failure, and we're still initialising buffers.
              * We assume we're so doomed that we won't even be able to send an
@@ -281,8 +301,7 @@ static int tls_release_read_buffer(OSSL_RECORD_LAYER *rl)
     b = &rl->rbuf;
     if ((rl->options & SSL_OP_CLEANSE_PLAINTEXT) != 0)
         OPENSSL_cleanse(b->buf, b->len);
-    OPENSSL_free(b->buf);
-    b->buf = NULL;
+    ossl_tls_buffer_release(rl, b);
     rl->packet = NULL;
     rl->packet_length = 0;
     return 1;
@@ -1015,6 +1034,23 @@ int tls_default_validate_record_header(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *rec
     return 1;
 }
 
+/*
+ * Copies |len| bytes starting |off| bytes into the segment |iov|, and
+ * continuing through the following segments, to |out|
+ */
+static void tls_copy_from_iov(unsigned char *out, const SSL_IOVEC *iov,
+                              size_t off, size_t len)
+{
+    size_t n;
+
+    for (; len > 0; iov++, off = 0) {
+        n = iov->len - off < len ? iov->len - off : len;
+        memcpy(out, (const unsigned char *)iov->base + off, n);
+        out += n;
+        len -= n;
+    }
+}
+
 int tls_do_compress(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *wr)
 {
 #ifndef OPENSSL_NO_COMP
@@ -1352,6 +1388,13 @@ tls_int_new_record_layer(OSSL_LIB_CTX *libctx, const char *propq, int vers,
                 break;
             case OSSL_FUNC_RLAYER_PADDING:
                 rl->padding = OSSL_FUNC_rlayer_padding(fns);
+                break;
+            case OSSL_FUNC_RLAYER_BUFFER_ALLOC:
+                rl->buffer_alloc = OSSL_FUNC_rlayer_buffer_alloc(fns);
+                break;
+            case OSSL_FUNC_RLAYER_BUFFER_FREE:
+                rl->buffer_free = OSSL_FUNC_rlayer_buffer_free(fns);
+                break;
             default:
                 /* Just ignore anything we don't understand */
                 break;
@@ -1446,7 +1489,7 @@ static void tls_int_free(OSSL_RECORD_LAYER *rl)
     BIO_free(rl->prev);
     BIO_free(rl->bio);
     BIO_free(rl->next);
-    ossl_tls_buffer_release(&rl->rbuf);
+    ossl_tls_buffer_release(rl, &rl->rbuf);
 
     tls_release_write_buffer(rl);
 
@@ -1819,13 +1862,58 @@ int tls_write_records_default(OSSL_RECORD_LAYER *rl,
 
         /* first we compress */
         if (rl->compctx != NULL) {
-            if (!tls_do_compress(rl, thiswr)
+            unsigned char *gathered = NULL;
+            int compressed;
+
+            if (thistempl->iov != NULL) {
+                /* The compressor needs the data in one piece */
+                gathered = OPENSSL_malloc(thiswr->length);
+                if (gathered == NULL) {
+                    RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_CRYPTO_LIB);
+                    goto err;
+                }
+                tls_copy_from_iov(gathered, thistempl->iov, thistempl->iovoff,
+                                  thiswr->length);
+                TLS_RL_RECORD_set_input(thiswr, gathered);
+            }
+            compressed = tls_do_compress(rl, thiswr);
+            OPENSSL_free(gathered);
+            if (!compressed
                     || !WPACKET_allocate_bytes(thispkt, thiswr->length, NULL)) {
                 RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, SSL_R_COMPRESSION_FAILURE);
                 goto err;
             }
         } else if (compressdata != NULL) {
-            if (!WPACKET_memcpy(thispkt, thiswr->input, thiswr->length)) {
+            unsigned char *recdata;
+
+            if (rl->out_of_place_write
+                    && thistempl->type == SSL3_RT_APPLICATION_DATA
+                    && rectype == SSL3_RT_APPLICATION_DATA) {
+                /*
+                 * Leave the data where it is and only reserve room for it.
+                 * The cipher reads it from the caller's buffer and writes
+                 * the ciphertext here, which saves copying the plaintext.
+                 */
+                if (!WPACKET_allocate_bytes(thispkt, thiswr->length, NULL)) {
+                    RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR,
+                                ERR_R_INTERNAL_ERROR);
+                    goto err;
+                }
+                thiswr->ext_input = thiswr->input;
+                thiswr->ext_iov = thistempl->iov;
+                thiswr->ext_iovoff = thistempl->iovoff;
+                thiswr->ext_length = thiswr->length;
+            } else if (thistempl->iov != NULL) {
+                if (!WPACKET_allocate_bytes(thispkt, thiswr->length,
+                                            &recdata)) {
+                    RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR,
+                                ERR_R_INTERNAL_ERROR);
+                    goto err;
+                }
+                tls_copy_from_iov(recdata, thistempl->iov, thistempl->iovoff,
+                                  thiswr->length);
+            } else if (!WPACKET_memcpy(thispkt, thiswr->input,
+                                       thiswr->length)) {
                 RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
                 goto err;
             }
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <openssl/crypto.h>
+#include "internal/refcount.h"
+#include "../ssl_local.h"
+
+/*
+ * A pool of record layer buffers shared by the connections of an SSL_CTX.
+ *
+ * Connections that use SSL_MODE_RELEASE_BUFFERS give their read and write
+ * buffers back whenever they are drained, and borrow them again when the
+ * next record arrives or is written.  Rather than going back to malloc each
+ * time, idle buffers are kept here on free lists, one per size class.  The
+ * size classes are multiples of RECORD_BUFFER_POOL_GRANULE so that the
+ * slightly different lengths asked for by different protocol versions and
+ * options end up sharing a list.  Buffers larger than the biggest class are
+ * not pooled.
+ *
+ * While a buffer sits on a free list its first bytes hold the pointer to
+ * the next free buffer of that class, so the pool needs no memory of its
+ * own beyond this structure.
+ */
+#define RECORD_BUFFER_POOL_GRANULE      1024
+#define RECORD_BUFFER_POOL_CLASSES      64
+
+struct record_buffer_pool_st {
+    CRYPTO_REF_COUNT references;
+    CRYPTO_RWLOCK *lock;
+    /* Maximum number of bytes kept in idle buffers */
+    size_t max_idle;
+    /* Number of bytes currently kept in idle buffers */
+    size_t idle;
+    /* Number of buffers currently borrowed */
+    size_t in_use;
+    /* Borrows served from a free list, and borrows that needed malloc */
+    size_t hits;
+    size_t misses;
+    void *free_list[RECORD_BUFFER_POOL_CLASSES];
+};
+
+static ossl_inline size_t buffer_class(size_t len)
+{
+    return (len + RECORD_BUFFER_POOL_GRANULE - 1) / RECORD_BUFFER_POOL_GRANULE;
+}
+
+RECORD_BUFFER_POOL *ossl_record_buffer_pool_new(void)
+{
+    RECORD_BUFFER_POOL *pool = OPENSSL_zalloc(sizeof(*pool));
+
+    if (pool == NULL)
+        return NULL;
+
+    pool->lock = CRYPTO_THREAD_lock_new();
+    if (pool->lock == NULL || !CRYPTO_NEW_REF(&pool->references, 1)) {
+        CRYPTO_THREAD_lock_free(pool->lock);
+        OPENSSL_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+int ossl_record_buffer_pool_up_ref(RECORD_BUFFER_POOL *pool)
+{
+    int i;
+
+    if (CRYPTO_UP_REF(&pool->references, &i) <= 0)
+        return 0;
+    return i > 1 ? 1 : 0;
+}
+
+/* Free idle buffers until no more than |max| bytes are left. Needs the lock */
+static void record_buffer_pool_trim(RECORD_BUFFER_POOL *pool, size_t max)
+{
+    size_t cls = RECORD_BUFFER_POOL_CLASSES;
+    void *buf;
+
+    /* Give back the largest buffers first */
+    while (pool->idle > max && cls-- > 0) {
+        while (pool->idle > max && (buf = pool->free_list[cls]) != NULL) {
+            memcpy(&pool->free_list[cls], buf, sizeof(void *));
+            pool->idle -= (cls + 1) * RECORD_BUFFER_POOL_GRANULE;
+            OPENSSL_free(buf);
+        }
+    }
+}
+
+void ossl_record_buffer_pool_free(RECORD_BUFFER_POOL *pool)
+{
+    int i;
+
+    if (pool == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&pool->references, &i);
+    if (i > 0)
+        return;
+
+    record_buffer_pool_trim(pool, 0);
+    CRYPTO_THREAD_lock_free(pool->lock);
+    CRYPTO_FREE_REF(&pool->references);
+    OPENSSL_free(pool);
+}
+
+int ossl_record_buffer_pool_set_max_idle(RECORD_BUFFER_POOL *pool, size_t max)
+{
+    if (!CRYPTO_THREAD_write_lock(pool->lock))
+        return 0;
+    pool->max_idle = max;
+    record_buffer_pool_trim(pool, max);
+    CRYPTO_THREAD_unlock(pool->lock);
+    return 1;
+}
+
+unsigned char *ossl_record_buffer_pool_borrow(RECORD_BUFFER_POOL *pool,
+                                              size_t len)
+{
+    size_t cls = buffer_class(len);
+    void *buf = NULL;
+
+    if (cls == 0 || cls > RECORD_BUFFER_POOL_CLASSES)
+        return OPENSSL_malloc(len);
+
+    if (!CRYPTO_THREAD_write_lock(pool->lock))
+        return NULL;
+    if ((buf = pool->free_list[cls - 1]) != NULL) {
+        memcpy(&pool->free_list[cls - 1], buf, sizeof(void *));
+        pool->idle -= cls * RECORD_BUFFER_POOL_GRANULE;
+        pool->hits++;
+    } else {
+        pool->misses++;
+    }
+    pool->in_use++;
+    CRYPTO_THREAD_unlock(pool->lock);
+
+    if (buf == NULL) {
+        /* Allocate the whole class so that the buffer can be pooled later */
+        buf = OPENSSL_malloc(cls * RECORD_BUFFER_POOL_GRANULE);
+        if (buf == NULL && CRYPTO_THREAD_write_lock(pool->lock)) {
+            pool->in_use--;
+            CRYPTO_THREAD_unlock(pool->lock);
+        }
+    }
+    return buf;
+}
+
+void ossl_record_buffer_pool_return(RECORD_BUFFER_POOL *pool,
+                                    unsigned char *buf, size_t len)
+{
+    size_t cls = buffer_class(len), size;
+
+    if (buf == NULL)
+        return;
+
+    if (cls == 0 || cls > RECORD_BUFFER_POOL_CLASSES) {
+        OPENSSL_free(buf);
+        return;
+    }
+
+    size = cls * RECORD_BUFFER_POOL_GRANULE;
+    if (!CRYPTO_THREAD_write_lock(pool->lock)) {
+        OPENSSL_free(buf);
+        return;
+    }
+    pool->in_use--;
+    if (pool->idle + size <= pool->max_idle) {
+        memcpy(buf, &pool->free_list[cls - 1], sizeof(void *));
+        pool->free_list[cls - 1] = buf;
+        pool->idle += size;
+        buf = NULL;
+    }
+    CRYPTO_THREAD_unlock(pool->lock);
+
+    OPENSSL_free(buf);
+}
+
+long ossl_record_buffer_pool_get_stat(RECORD_BUFFER_POOL *pool, int cmd)
+{
+    long ret = 0;
+
+    if (pool == NULL || !CRYPTO_THREAD_read_lock(pool->lock))
+        return 0;
+
+    switch (cmd) {
+    case SSL_CTRL_GET_RECORD_BUFFER_POOL_SIZE:
+        ret = (long)pool->max_idle;
+        break;
+    case SSL_CTRL_RECORD_BUFFER_POOL_IDLE:
+        ret = (long)pool->idle;
+        break;
+    case SSL_CTRL_RECORD_BUFFER_POOL_IN_USE:
+        ret = (long)pool->in_use;
+        break;
+    case SSL_CTRL_RECORD_BUFFER_POOL_HITS:
+        ret = (long)pool->hits;
+        break;
+    case SSL_CTRL_RECORD_BUFFER_POOL_MISSES:
+        ret = (long)pool->misses;
+        break;
+    }
+    CRYPTO_THREAD_unlock(pool->lock);
+    return ret;
+}
@@ -623,6 +623,7 @@ int do_dtls1_write(SSL_CONNECTION *sc, uint8_t type, const unsigned char *buf,
 {
     int i;
     OSSL_RECORD_TEMPLATE tmpl;
+    unsigned int version;
     SSL *s = SSL_CONNECTION_GET_SSL(sc);
     int ret;
 
@@ -642,7 +643,6 @@ int do_dtls1_write(SSL_CONNECTION *sc, uint8_t type, const unsigned char *buf,
         return 0;
     }
 
-    tmpl.type = type;
     /*
      * Special case: for hello verify request, client version 1.0 and we
      * haven't decided which version to use yet send back using version 1.0
@@ -650,11 +650,13 @@ int do_dtls1_write(SSL_CONNECTION *sc, uint8_t type, const unsigned char *buf,
      */
     if (s->method->version == DTLS_ANY_VERSION
             && sc->max_proto_version != DTLS1_BAD_VER)
-        tmpl.version = DTLS1_VERSION;
+        version = DTLS1_VERSION;
     else
-        tmpl.version = sc->version;
-    tmpl.buf = buf;
-    tmpl.buflen = len;
+        version = sc->version;
+    if (!ssl_set_write_template(sc, &tmpl, type, version, buf, 0, len)) {
+        SSLfatal(sc, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
 
     ret = HANDLE_RLAYER_WRITE_RETURN(sc,
               sc->rlayer.wrlmethod->write_records(sc->rlayer.wrl, &tmpl, 1));
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -246,6 +246,52 @@ const char *SSL_rstate_string(const SSL *s)
     return shrt;
 }
 
+/*
+ * Fills in |tmpl| for a record of |len| bytes starting |off| bytes into the
+ * data passed to the write function in |buf|. Application data written by
+ * SSL_writev() is found in its segments instead: a record that lies within one
+ * segment still gets a plain buffer, while one that spans several refers to
+ * the segments so that the record layer gathers it as it encrypts it.
+ *
+ * Returns 1 on success or 0 on failure.
+ */
+int ssl_set_write_template(SSL_CONNECTION *s, OSSL_RECORD_TEMPLATE *tmpl,
+                           uint8_t type, unsigned int version,
+                           const unsigned char *buf, size_t off, size_t len)
+{
+    const SSL_IOVEC *iov = s->rlayer.wiov;
+
+    tmpl->type = type;
+    tmpl->version = version;
+    tmpl->buflen = len;
+    tmpl->iov = NULL;
+    tmpl->iovoff = 0;
+
+    if (iov == NULL || type != SSL3_RT_APPLICATION_DATA) {
+        tmpl->buf = buf + off;
+        return 1;
+    }
+    if (len == 0) {
+        tmpl->buf = buf;
+        return 1;
+    }
+
+    for (off += s->rlayer.wiovoff; off >= iov->len; iov++)
+        off -= iov->len;
+    if (len <= iov->len - off) {
+        tmpl->buf = (const unsigned char *)iov->base + off;
+        return 1;
+    }
+
+    /* With KTLS the kernel reads the record from a single buffer */
+    if (!ossl_assert(!BIO_get_ktls_send(s->wbio)))
+        return 0;
+    tmpl->buf = NULL;
+    tmpl->iov = iov;
+    tmpl->iovoff = off;
+    return 1;
+}
+
 static int tls_write_check_pending(SSL_CONNECTION *s, uint8_t type,
                                    const unsigned char *buf, size_t len)
 {
@@ -435,10 +481,12 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
              * pipelines
              */
             for (j = 0; j < maxpipes; j++) {
-                tmpls[j].type = type;
-                tmpls[j].version = recversion;
-                tmpls[j].buf = &(buf[tot]) + (j * split_send_fragment);
-                tmpls[j].buflen = split_send_fragment;
+                if (!ssl_set_write_template(s, &tmpls[j], type, recversion, buf,
+                                            tot + j * split_send_fragment,
+                                            split_send_fragment)) {
+                    SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+                    return -1;
+                }
             }
             /* Remember how much data we are going to be sending */
             s->rlayer.wpend_tot = maxpipes * split_send_fragment;
@@ -453,10 +501,11 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             if (remain > 0)
                 tmppipelen++;
             for (j = 0; j < maxpipes; j++) {
-                tmpls[j].type = type;
-                tmpls[j].version = recversion;
-                tmpls[j].buf = &(buf[tot]) + lensofar;
-                tmpls[j].buflen = tmppipelen;
+                if (!ssl_set_write_template(s, &tmpls[j], type, recversion, buf,
+                                            tot + lensofar, tmppipelen)) {
+                    SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+                    return -1;
+                }
                 lensofar += tmppipelen;
                 if (j + 1 == remain)
                     tmppipelen--;
@@ -1157,11 +1206,30 @@ static size_t rlayer_padding_wrapper(void *cbarg, int type, size_t len)
                                        s->rlayer.record_padding_arg);
 }
 
+static OSSL_FUNC_rlayer_buffer_alloc_fn rlayer_buffer_alloc_wrapper;
+static unsigned char *rlayer_buffer_alloc_wrapper(void *cbarg, size_t len)
+{
+    SSL_CONNECTION *s = cbarg;
+
+    return ossl_record_buffer_pool_borrow(s->rlayer.bufpool, len);
+}
+
+static OSSL_FUNC_rlayer_buffer_free_fn rlayer_buffer_free_wrapper;
+static void rlayer_buffer_free_wrapper(void *cbarg, unsigned char *buf,
+                                       size_t len)
+{
+    SSL_CONNECTION *s = cbarg;
+
+    ossl_record_buffer_pool_return(s->rlayer.bufpool, buf, len);
+}
+
 static const OSSL_DISPATCH rlayer_dispatch[] = {
     { OSSL_FUNC_RLAYER_SKIP_EARLY_DATA, (void (*)(void))ossl_statem_skip_early_data },
     { OSSL_FUNC_RLAYER_MSG_CALLBACK, (void (*)(void))rlayer_msg_callback_wrapper },
     { OSSL_FUNC_RLAYER_SECURITY, (void (*)(void))rlayer_security_wrapper },
     { OSSL_FUNC_RLAYER_PADDING, (void (*)(void))rlayer_padding_wrapper },
+    { OSSL_FUNC_RLAYER_BUFFER_ALLOC, (void (*)(void))rlayer_buffer_alloc_wrapper },
+    { OSSL_FUNC_RLAYER_BUFFER_FREE, (void (*)(void))rlayer_buffer_free_wrapper },
     OSSL_DISPATCH_END
 };
 
@@ -1405,6 +1473,11 @@ int ssl_set_new_record_layer(SSL_CONNECTION *s, int version,
                 if (s->rlayer.record_padding_cb == NULL)
                     continue;
                 break;
+            case OSSL_FUNC_RLAYER_BUFFER_ALLOC:
+            case OSSL_FUNC_RLAYER_BUFFER_FREE:
+                if (s->rlayer.bufpool == NULL)
+                    continue;
+                break;
             default:
                 break;
             }
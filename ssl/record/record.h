@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -19,6 +19,8 @@
 
 #define SEQ_NUM_SIZE                            8
 
+typedef struct record_buffer_pool_st RECORD_BUFFER_POOL;
+
 typedef struct tls_record_st {
     void *rechandle;
     int version;
@@ -88,6 +90,8 @@ typedef struct record_layer_st {
     BIO *rrlnext;
     /* Default read buffer length to be passed to the record layer */
     size_t default_read_buf_len;
+    /* Pool to borrow record layer buffers from, or NULL to use malloc */
+    RECORD_BUFFER_POOL *bufpool;
 
     /*
      * Read as many input bytes as possible (for
@@ -104,6 +108,13 @@ typedef struct record_layer_st {
     size_t wpend_tot;
     uint8_t wpend_type;
     const unsigned char *wpend_buf;
+    /*
+     * Set by SSL_writev() while it writes: the application data passed to the
+     * write functions then starts |wiovoff| bytes into the segment |wiov| and
+     * records are built from the segments rather than from the buffer
+     */
+    const SSL_IOVEC *wiov;
+    size_t wiovoff;
 
     /* Count of the number of consecutive warning alerts received */
     unsigned int alert_count;
@@ -161,6 +172,9 @@ int do_dtls1_write(SSL_CONNECTION *s, uint8_t type, const unsigned char *buf,
 void dtls1_increment_epoch(SSL_CONNECTION *s, int rw);
 uint16_t dtls1_get_epoch(SSL_CONNECTION *s, int rw);
 int ssl_release_record(SSL_CONNECTION *s, TLS_RECORD *rr, size_t length);
+int ssl_set_write_template(SSL_CONNECTION *s, OSSL_RECORD_TEMPLATE *tmpl,
+                           uint8_t type, unsigned int version,
+                           const unsigned char *buf, size_t off, size_t len);
 
 # define HANDLE_RLAYER_READ_RETURN(s, ret) \
     ossl_tls_handle_rlayer_return(s, 0, ret, OPENSSL_FILE, OPENSSL_LINE)
@@ -194,3 +208,21 @@ OSSL_CORE_MAKE_FUNC(int, rlayer_security, (void *cbarg, int op, int bits,
                                            int nid, void *other))
 # define OSSL_FUNC_RLAYER_PADDING                4
 OSSL_CORE_MAKE_FUNC(size_t, rlayer_padding, (void *cbarg, int type, size_t len))
+# define OSSL_FUNC_RLAYER_BUFFER_ALLOC           5
+OSSL_CORE_MAKE_FUNC(unsigned char *, rlayer_buffer_alloc, (void *cbarg,
+                                                           size_t len))
+# define OSSL_FUNC_RLAYER_BUFFER_FREE            6
+OSSL_CORE_MAKE_FUNC(void, rlayer_buffer_free, (void *cbarg, unsigned char *buf,
+                                               size_t len))
+
+/* Functions provided by the record buffer pool component */
+
+RECORD_BUFFER_POOL *ossl_record_buffer_pool_new(void);
+int ossl_record_buffer_pool_up_ref(RECORD_BUFFER_POOL *pool);
+void ossl_record_buffer_pool_free(RECORD_BUFFER_POOL *pool);
+int ossl_record_buffer_pool_set_max_idle(RECORD_BUFFER_POOL *pool, size_t max);
+unsigned char *ossl_record_buffer_pool_borrow(RECORD_BUFFER_POOL *pool,
+                                              size_t len);
+void ossl_record_buffer_pool_return(RECORD_BUFFER_POOL *pool,
+                                    unsigned char *buf, size_t len);
+long ossl_record_buffer_pool_get_stat(RECORD_BUFFER_POOL *pool, int cmd);
@@ -102,6 +102,8 @@ int ssl3_dispatch_alert(SSL *s)
     }
     templ.buf = &sc->s3.send_alert[0];
     templ.buflen = 2;
+    templ.iov = NULL;
+    templ.iovoff = 0;
 
     if (RECORD_LAYER_write_pending(&sc->rlayer)) {
         if (sc->s3.alert_dispatch != SSL_ALERT_DISPATCH_RETRY) {
@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright (c) 2002, Oracle and/or its affiliates. All rights reserved
  * Copyright 2005 Nokia. All rights reserved.
  *
@@ -809,6 +809,11 @@ SSL *ossl_ssl_connection_new_int(SSL_CTX *ctx, const SSL_METHOD *method)
     s->split_send_fragment = ctx->split_send_fragment;
     s->max_pipelines = ctx->max_pipelines;
     s->rlayer.default_read_buf_len = ctx->default_read_buf_len;
+    if (ctx->rbufpool != NULL) {
+        if (!ossl_record_buffer_pool_up_ref(ctx->rbufpool))
+            goto err;
+        s->rlayer.bufpool = ctx->rbufpool;
+    }
 
     s->ext.debug_cb = 0;
     s->ext.debug_arg = NULL;
@@ -1048,6 +1053,7 @@ int SSL_has_matching_session_id(const SSL *ssl, const unsigned char *id,
      * by this SSL.
      */
     SSL_SESSION r, *p;
+    SSL_SESS_SHARD *shard;
     const SSL_CONNECTION *sc = SSL_CONNECTION_FROM_CONST_SSL(ssl);
 
     if (sc == NULL || id_len > sizeof(r.session_id))
@@ -1057,10 +1063,11 @@ int SSL_has_matching_session_id(const SSL *ssl, const unsigned char *id,
     r.session_id_length = id_len;
     memcpy(r.session_id, id, id_len);
 
-    if (!CRYPTO_THREAD_read_lock(sc->session_ctx->lock))
+    shard = ssl_session_shard(sc->session_ctx, id, id_len);
+    if (!CRYPTO_THREAD_read_lock(shard->lock))
         return 0;
-    p = lh_SSL_SESSION_retrieve(sc->session_ctx->sessions, &r);
-    CRYPTO_THREAD_unlock(sc->session_ctx->lock);
+    p = lh_SSL_SESSION_retrieve(shard->sessions, &r);
+    CRYPTO_THREAD_unlock(shard->lock);
     return (p != NULL);
 }
 
@@ -1415,6 +1422,7 @@ void ossl_ssl_connection_free(SSL *ssl)
 
     /* Ignore return value */
     RECORD_LAYER_clear(&s->rlayer);
+    ossl_record_buffer_pool_free(s->rlayer.bufpool);
 
     BUF_MEM_free(s->init_buf);
 
@@ -2489,6 +2497,30 @@ int SSL_peek_ex(SSL *s, void *buf, size_t num, size_t *readbytes)
     return ret;
 }
 
+int SSL_read_peek_segments(SSL *s, SSL_READ_SEGMENT *segs, size_t num_segs,
+                           size_t *segs_out, size_t *readbytes)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC(s))
+        return ossl_quic_read_peek_segments(s, segs, num_segs, segs_out,
+                                            readbytes);
+#endif
+
+    ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+    return 0;
+}
+
+int SSL_read_release_segments(SSL *s, size_t num)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC(s))
+        return ossl_quic_read_release_segments(s, num);
+#endif
+
+    ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+    return 0;
+}
+
 int ssl_write_internal(SSL *s, const void *buf, size_t num,
                        uint64_t flags, size_t *written)
 {
@@ -2614,6 +2646,108 @@ ossl_ssize_t SSL_sendfile(SSL *s, int fd, off_t offset, size_t size, int flags)
 #endif
 }
 
+ossl_ssize_t SSL_splice(SSL *s, int fd, size_t size, int flags)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+#ifndef OPENSSL_NO_KTLS
+    ossl_ssize_t ret;
+    unsigned char buf[4096];
+    size_t total = 0, chunk, peeked, n;
+    int err;
+#endif
+
+    if (sc == NULL)
+        return -1;
+
+    if (sc->handshake_func == NULL) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_UNINITIALIZED);
+        return -1;
+    }
+
+    if (sc->shutdown & SSL_RECEIVED_SHUTDOWN) {
+        sc->rwstate = SSL_NOTHING;
+        return 0;
+    }
+
+    if (!BIO_get_ktls_recv(sc->rbio)) {
+        ERR_raise(ERR_LIB_SSL, SSL_R_UNINITIALIZED);
+        return -1;
+    }
+
+#ifdef OPENSSL_NO_KTLS
+    ERR_raise_data(ERR_LIB_SSL, ERR_R_INTERNAL_ERROR,
+                   "can't call ktls_splice(), ktls disabled");
+    return -1;
+#else
+    if (size == 0)
+        return 0;
+
+    if (SSL_pending(s) == 0) {
+        sc->rwstate = SSL_READING;
+        ret = ktls_splice(SSL_get_rfd(s), fd, size, flags);
+        if (ret > 0) {
+            sc->rwstate = SSL_NOTHING;
+            return ret;
+        }
+        if (ret == 0) {
+            sc->rwstate = SSL_NOTHING;
+            ERR_raise(ERR_LIB_SSL, SSL_R_UNEXPECTED_EOF_WHILE_READING);
+            return -1;
+        }
+        err = get_last_sys_error();
+        if (err != EINVAL) {
+# if defined(EAGAIN) && defined(EINTR)
+            if (err == EAGAIN && ktls_splice_pipe_full(fd)) {
+                /*
+                 * Waiting for the socket to become readable would not help,
+                 * the caller has to wait until the pipe can take more data.
+                 */
+                sc->rwstate = SSL_NOTHING;
+                set_sys_error(err);
+                return -1;
+            }
+            if (err == EAGAIN || err == EINTR) {
+                BIO_set_retry_read(sc->rbio);
+                return -1;
+            }
+# endif
+            sc->rwstate = SSL_NOTHING;
+            ERR_raise_data(ERR_LIB_SYS, err, "ktls_splice failure");
+            return -1;
+        }
+
+        /*
+         * The next record is not application data, e.g. it is a post-handshake
+         * message or an alert. Let the record layer deal with it. This also
+         * reads the application data that follows into the SSL object.
+         */
+        sc->rwstate = SSL_NOTHING;
+        if (!SSL_peek_ex(s, buf, 1, &n))
+            return (sc->shutdown & SSL_RECEIVED_SHUTDOWN) != 0 ? 0 : -1;
+    }
+
+    /*
+     * Data that has already been read into the SSL object has to be passed on
+     * first. Only consume what could be written.
+     */
+    while (total < size && SSL_pending(s) > 0) {
+        chunk = size - total < sizeof(buf) ? size - total : sizeof(buf);
+        if (!SSL_peek_ex(s, buf, chunk, &peeked))
+            break;
+        ret = write(fd, buf, peeked);
+        if (ret <= 0)
+            break;
+        if (!SSL_read_ex(s, buf, (size_t)ret, &n))
+            break;
+        total += n;
+        if ((size_t)ret < peeked)
+            break;
+    }
+
+    return total > 0 ? (ossl_ssize_t)total : -1;
+#endif
+}
+
 int SSL_write(SSL *s, const void *buf, int num)
 {
     int ret;
@@ -2651,6 +2785,108 @@ int SSL_write_ex2(SSL *s, const void *buf, size_t num, uint64_t flags,
     return ret;
 }
 
+int SSL_writev(SSL *s, const SSL_IOVEC *iov, size_t iovcnt, size_t *written)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+    size_t i = 0, j, off = 0, total = 0, num, tmpwrit;
+    int gather, ret;
+
+    *written = 0;
+
+    /* Skip leading empty segments */
+    while (i < iovcnt && iov[i].len == 0)
+        i++;
+    if (i == iovcnt)
+        return SSL_write_ex(s, NULL, 0, written);
+
+    /*
+     * For TLS and DTLS the record layer builds the records straight from the
+     * segments, so that a record can span several of them. KTLS needs each
+     * record in a single buffer, and may still be enabled by the handshake,
+     * so then and for QUIC the segments are written one at a time.
+     */
+    gather = sc != NULL && !SSL_in_init(s) && !BIO_get_ktls_send(sc->wbio);
+
+    for (;;) {
+        num = iov[i].len - off;
+        if (gather) {
+            for (j = i + 1; j < iovcnt && iov[j].len <= SIZE_MAX - num; j++)
+                num += iov[j].len;
+            /* DTLS writes a single record at a time */
+            if (SSL_CONNECTION_IS_DTLS(sc)
+                    && num > ssl_get_max_send_fragment(sc))
+                num = ssl_get_max_send_fragment(sc);
+            sc->rlayer.wiov = &iov[i];
+            sc->rlayer.wiovoff = off;
+        }
+
+        ret = SSL_write_ex(s, (const unsigned char *)iov[i].base + off, num,
+                           &tmpwrit);
+        if (gather)
+            sc->rlayer.wiov = NULL;
+        if (ret <= 0)
+            break;
+        total += tmpwrit;
+
+        /* Advance past what was written */
+        off += tmpwrit;
+        while (i < iovcnt && off >= iov[i].len) {
+            off -= iov[i].len;
+            i++;
+        }
+        if (i == iovcnt || tmpwrit < num)
+            break;
+    }
+
+    *written = total;
+    /* Like writev(2), report partial progress as success */
+    return total > 0 ? 1 : ret;
+}
+
+int SSL_readv(SSL *s, const SSL_IOVEC *iov, size_t iovcnt, size_t *readbytes)
+{
+    size_t i, off = 0, total = 0, tmpread;
+    int ret = 0;
+
+    *readbytes = 0;
+
+    for (i = 0; i < iovcnt; i++) {
+        off = 0;
+        while (off < iov[i].len) {
+            /*
+             * Once something has been read, only carry on while data is
+             * already available so that we never block waiting for more.
+             */
+            if (total > 0 && SSL_pending(s) == 0)
+                goto end;
+            ret = SSL_read_ex(s, (unsigned char *)iov[i].base + off,
+                              iov[i].len - off, &tmpread);
+            if (ret <= 0)
+                goto end;
+            off += tmpread;
+            total += tmpread;
+        }
+    }
+
+ end:
+    *readbytes = total;
+    return total > 0 ? 1 : ret;
+}
+
+int SSL_write_donate(SSL *s, const void *buf, size_t num, uint64_t flags,
+                     SSL_write_release_cb_fn release_cb, void *arg,
+                     size_t *written)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC(s))
+        return ossl_quic_write_donate(s, buf, num, flags, release_cb, arg,
+                                      written);
+#endif
+
+    ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+    return 0;
+}
+
 int SSL_write_early_data(SSL *s, const void *buf, size_t num, size_t *written)
 {
     int ret, early_data_state;
@@ -3042,9 +3278,13 @@ long SSL_callback_ctrl(SSL *s, int cmd, void (*fp) (void))
     return s->method->ssl_callback_ctrl(s, cmd, fp);
 }
 
+/*
+ * With more than one shard this only gives access to the sessions of the
+ * first one, see SSL_CTX_sessions(3).
+ */
 LHASH_OF(SSL_SESSION) *SSL_CTX_sessions(SSL_CTX *ctx)
 {
-    return ctx->sessions;
+    return ctx->sess_shards[0].sessions;
 }
 
 static int ssl_tsan_load(SSL_CTX *ctx, TSAN_QUALIFIER int *stat)
@@ -3103,6 +3343,51 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
         return l;
     case SSL_CTRL_GET_SESS_CACHE_SIZE:
         return (long)ctx->session_cache_size;
+    case SSL_CTRL_SET_SESS_CACHE_SHARDS:
+        /* Sessions cannot be moved between shards */
+        if (ssl_session_cache_count(ctx) != 0) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+            return 0;
+        }
+        if (larg <= 0 || larg > SSL_SESS_CACHE_MAX_SHARDS) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+            return 0;
+        }
+        return ssl_session_cache_init(ctx, (size_t)larg);
+    case SSL_CTRL_GET_SESS_CACHE_SHARDS:
+        return (long)ctx->sess_shard_count;
+#ifndef OPENSSL_NO_QUIC
+    case SSL_CTRL_SET_QUIC_CC:
+        if (larg < SSL_QUIC_CC_NEWRENO || larg > SSL_QUIC_CC_BBR2) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+            return 0;
+        }
+        ctx->quic_cc_alg = (int)larg;
+        return 1;
+    case SSL_CTRL_GET_QUIC_CC:
+        return ctx->quic_cc_alg;
+#endif
+    case SSL_CTRL_SET_RECORD_BUFFER_POOL_SIZE:
+        if (larg < 0) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+            return 0;
+        }
+        if (ctx->rbufpool == NULL) {
+            if (larg == 0)
+                return 1;
+            if ((ctx->rbufpool = ossl_record_buffer_pool_new()) == NULL) {
+                ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+                return 0;
+            }
+        }
+        return ossl_record_buffer_pool_set_max_idle(ctx->rbufpool,
+                                                    (size_t)larg);
+    case SSL_CTRL_GET_RECORD_BUFFER_POOL_SIZE:
+    case SSL_CTRL_RECORD_BUFFER_POOL_IDLE:
+    case SSL_CTRL_RECORD_BUFFER_POOL_IN_USE:
+    case SSL_CTRL_RECORD_BUFFER_POOL_HITS:
+    case SSL_CTRL_RECORD_BUFFER_POOL_MISSES:
+        return ossl_record_buffer_pool_get_stat(ctx->rbufpool, cmd);
     case SSL_CTRL_SET_SESS_CACHE_MODE:
         l = ctx->session_cache_mode;
         ctx->session_cache_mode = larg;
@@ -3111,7 +3396,7 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
         return ctx->session_cache_mode;
 
     case SSL_CTRL_SESS_NUMBER:
-        return lh_SSL_SESSION_num_items(ctx->sessions);
+        return (long)ssl_session_cache_count(ctx);
     case SSL_CTRL_SESS_CONNECT:
         return ssl_tsan_load(ctx, &ctx->stats.sess_connect);
     case SSL_CTRL_SESS_CONNECT_GOOD:
@@ -3134,6 +3419,16 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
         return ssl_tsan_load(ctx, &ctx->stats.sess_timeout);
     case SSL_CTRL_SESS_CACHE_FULL:
         return ssl_tsan_load(ctx, &ctx->stats.sess_cache_full);
+    case SSL_CTRL_SESS_EXPIRED:
+        return ssl_tsan_load(ctx, &ctx->stats.sess_expired);
+    case SSL_CTRL_SESS_EXPIRE_TICKS:
+        return ssl_tsan_load(ctx, &ctx->stats.sess_expire_ticks);
+    case SSL_CTRL_SESS_EXPIRE_TICK_MAX:
+        return ssl_tsan_load(ctx, &ctx->stats.sess_expire_tick_max);
+    case SSL_CTRL_SESS_EXPIRE_LOCK_TIME:
+        return ssl_tsan_load(ctx, &ctx->stats.sess_expire_lock_us);
+    case SSL_CTRL_SESS_EXPIRE_LOCK_TIME_MAX:
+        return ssl_tsan_load(ctx, &ctx->stats.sess_expire_lock_us_max);
     case SSL_CTRL_MODE:
         return (ctx->mode |= larg);
     case SSL_CTRL_CLEAR_MODE:
@@ -3813,42 +4108,6 @@ int SSL_export_keying_material_early(SSL *s, unsigned char *out, size_t olen,
                                               context, contextlen);
 }
 
-static unsigned long ssl_session_hash(const SSL_SESSION *a)
-{
-    const unsigned char *session_id = a->session_id;
-    unsigned long l;
-    unsigned char tmp_storage[4];
-
-    if (a->session_id_length < sizeof(tmp_storage)) {
-        memset(tmp_storage, 0, sizeof(tmp_storage));
-        memcpy(tmp_storage, a->session_id, a->session_id_length);
-        session_id = tmp_storage;
-    }
-
-    l = (unsigned long)
-        ((unsigned long)session_id[0]) |
-        ((unsigned long)session_id[1] << 8L) |
-        ((unsigned long)session_id[2] << 16L) |
-        ((unsigned long)session_id[3] << 24L);
-    return l;
-}
-
-/*
- * NB: If this function (or indeed the hash function which uses a sort of
- * coarser function than this one) is changed, ensure
- * SSL_CTX_has_matching_session_id() is checked accordingly. It relies on
- * being able to construct an SSL_SESSION that will collide with any existing
- * session with a matching session ID.
- */
-static int ssl_session_cmp(const SSL_SESSION *a, const SSL_SESSION *b)
-{
-    if (a->ssl_version != b->ssl_version)
-        return 1;
-    if (a->session_id_length != b->session_id_length)
-        return 1;
-    return memcmp(a->session_id, b->session_id, a->session_id_length);
-}
-
 /*
  * These wrapper functions should remain rather than redeclaring
  * SSL_SESSION_hash and SSL_SESSION_cmp for void* types and casting each
@@ -3920,8 +4179,7 @@ SSL_CTX *SSL_CTX_new_ex(OSSL_LIB_CTX *libctx, const char *propq,
     ret->max_cert_list = SSL_MAX_CERT_LIST_DEFAULT;
     ret->verify_mode = SSL_VERIFY_NONE;
 
-    ret->sessions = lh_SSL_SESSION_new(ssl_session_hash, ssl_session_cmp);
-    if (ret->sessions == NULL) {
+    if (!ssl_session_cache_init(ret, 1)) {
         ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
         goto err;
     }
@@ -4169,11 +4427,11 @@ void SSL_CTX_free(SSL_CTX *a)
      * free ex_data, then finally free the cache.
      * (See ticket [openssl.org #212].)
      */
-    if (a->sessions != NULL)
+    if (a->sess_shards != NULL)
         SSL_CTX_flush_sessions_ex(a, 0);
 
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_SSL_CTX, a, &a->ex_data);
-    lh_SSL_SESSION_free(a->sessions);
+    ssl_session_cache_free(a);
     X509_STORE_free(a->cert_store);
 #ifndef OPENSSL_NO_CT
     CTLOG_STORE_free(a->ctlog_store);
@@ -4235,6 +4493,8 @@ void SSL_CTX_free(SSL_CTX *a)
     OPENSSL_free(a->client_cert_type);
     OPENSSL_free(a->server_cert_type);
 
+    ossl_record_buffer_pool_free(a->rbufpool);
+
     CRYPTO_THREAD_lock_free(a->lock);
     CRYPTO_FREE_REF(&a->references);
 #ifdef TSAN_REQUIRES_LOCKING
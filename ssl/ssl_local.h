@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2025 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright (c) 2002, Oracle and/or its affiliates. All rights reserved
  * Copyright 2005 Nokia. All rights reserved.
  *
@@ -559,10 +559,12 @@ struct ssl_session_st {
     SSL_CTX *owner;
 
     /*
-     * These are used to make removal of session-ids more efficient and to
-     * implement a maximum cache size. Access requires protection of ctx->lock.
+     * These link the session into a timing wheel slot of the owning session
+     * cache shard, |pprev| points at whatever points at this session. Used to
+     * expire sessions and to implement a maximum cache size. Access requires
+     * protection of the lock of the owning session cache shard.
      */
-    struct ssl_session_st *prev, *next;
+    struct ssl_session_st **pprev, *next;
     CRYPTO_REF_COUNT references;
 };
 
@@ -787,6 +789,34 @@ typedef struct {
 
 # define TLS_GROUP_FFDHE_FOR_TLS1_3 (TLS_GROUP_FFDHE|TLS_GROUP_ONLY_FOR_TLS1_3)
 
+/* Upper bound for SSL_CTX_sess_set_cache_shards() */
+# define SSL_SESS_CACHE_MAX_SHARDS  1024
+
+/*
+ * Session expiry uses a hierarchical timing wheel with a resolution of one
+ * second.  Level n has SSL_SESS_WHEEL_SLOTS slots of 64^n seconds each, so
+ * four levels cover about 194 days, later timeouts are parked in the last
+ * level until they come into range.
+ */
+# define SSL_SESS_WHEEL_BITS        6
+# define SSL_SESS_WHEEL_SLOTS       (1 << SSL_SESS_WHEEL_BITS)
+# define SSL_SESS_WHEEL_MASK        (SSL_SESS_WHEEL_SLOTS - 1)
+# define SSL_SESS_WHEEL_LEVELS      4
+
+/*
+ * One shard of the internal session cache.  A session always lives in the
+ * shard selected by its session id, see ssl_session_shard().  The shard's
+ * lock protects the hash, the timing wheel and the pprev/next fields of the
+ * sessions in it.
+ */
+typedef struct ssl_sess_shard_st {
+    CRYPTO_RWLOCK *lock;
+    LHASH_OF(SSL_SESSION) *sessions;
+    /* The next second to be expired, all earlier slots are empty */
+    uint64_t wheel_tick;
+    struct ssl_session_st *wheel[SSL_SESS_WHEEL_LEVELS][SSL_SESS_WHEEL_SLOTS];
+} SSL_SESS_SHARD;
+
 struct ssl_ctx_st {
     OSSL_LIB_CTX *libctx;
 
@@ -797,14 +827,14 @@ struct ssl_ctx_st {
     /* TLSv1.3 specific ciphersuites */
     STACK_OF(SSL_CIPHER) *tls13_ciphersuites;
     struct x509_store_st /* X509_STORE */ *cert_store;
-    LHASH_OF(SSL_SESSION) *sessions;
+    /* The internal session cache, split into |sess_shard_count| shards */
+    SSL_SESS_SHARD *sess_shards;
+    size_t sess_shard_count;
     /*
      * Most session-ids that will be cached, default is
      * SSL_SESSION_CACHE_MAX_SIZE_DEFAULT. 0 is unlimited.
      */
     size_t session_cache_size;
-    struct ssl_session_st *session_cache_head;
-    struct ssl_session_st *session_cache_tail;
     /*
      * This can have one of 2 values, ored together, SSL_SESS_CACHE_CLIENT,
      * SSL_SESS_CACHE_SERVER, Default is SSL_SESSION_CACHE_SERVER, which
@@ -841,6 +871,11 @@ struct ssl_ctx_st {
         TSAN_QUALIFIER int sess_miss;          /* session lookup misses */
         TSAN_QUALIFIER int sess_timeout;       /* reuse attempt on timeouted session */
         TSAN_QUALIFIER int sess_cache_full;    /* session removed due to full cache */
+        TSAN_QUALIFIER int sess_expired;       /* sessions expired from the cache */
+        TSAN_QUALIFIER int sess_expire_ticks;  /* timing wheel ticks processed */
+        TSAN_QUALIFIER int sess_expire_tick_max; /* most sessions expired in a tick */
+        TSAN_QUALIFIER int sess_expire_lock_us; /* shard lock held to expire, us */
+        TSAN_QUALIFIER int sess_expire_lock_us_max; /* longest such hold, us */
         TSAN_QUALIFIER int sess_hit;           /* session reuse actually done */
         TSAN_QUALIFIER int sess_cb_hit;        /* session-id that was not in
                                                 * the cache was passed back via
@@ -970,6 +1005,9 @@ struct ssl_ctx_st {
     /* The default read buffer length to use (0 means not set) */
     size_t default_read_buf_len;
 
+    /* Pool of idle record layer buffers, or NULL if not enabled */
+    RECORD_BUFFER_POOL *rbufpool;
+
 # ifndef OPENSSL_NO_ENGINE
     /*
      * Engine to pass requests for client certs to
@@ -1177,6 +1215,11 @@ struct ssl_ctx_st {
 # ifndef OPENSSL_NO_QLOG
     char *qlog_title; /* Session title for qlog */
 # endif
+
+# ifndef OPENSSL_NO_QUIC
+    /* Congestion controller for new QUIC connections (SSL_QUIC_CC_*) */
+    int quic_cc_alg;
+# endif
 };
 
 typedef struct cert_pkey_st CERT_PKEY;
@@ -2480,6 +2523,12 @@ __owur CERT *ssl_cert_dup(CERT *cert);
 void ssl_cert_clear_certs(CERT *c);
 void ssl_cert_free(CERT *c);
 __owur int ssl_generate_session_id(SSL_CONNECTION *s, SSL_SESSION *ss);
+__owur int ssl_session_cache_init(SSL_CTX *ctx, size_t shards);
+void ssl_session_cache_free(SSL_CTX *ctx);
+__owur size_t ssl_session_cache_count(SSL_CTX *ctx);
+__owur SSL_SESS_SHARD *ssl_session_shard(SSL_CTX *ctx,
+                                         const unsigned char *sess_id,
+                                         size_t sess_id_len);
 __owur int ssl_get_new_session(SSL_CONNECTION *s, int session);
 __owur SSL_SESSION *lookup_sess_in_cache(SSL_CONNECTION *s,
                                          const unsigned char *sess_id,
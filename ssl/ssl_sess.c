@@ -20,12 +20,21 @@
 #include "ssl_local.h"
 #include "statem/statem_local.h"
 
-static void SSL_SESSION_list_remove(SSL_CTX *ctx, SSL_SESSION *s);
-static void SSL_SESSION_list_add(SSL_CTX *ctx, SSL_SESSION *s);
+static void session_wheel_remove(SSL_SESSION *s);
+static void session_wheel_add(SSL_CTX *ctx, SSL_SESS_SHARD *shard,
+                              SSL_SESSION *s);
+static SSL_SESSION *session_wheel_first(SSL_SESS_SHARD *shard);
+static size_t session_wheel_expire(SSL_CTX *ctx, SSL_SESS_SHARD *shard,
+                                   OSSL_TIME now, SSL_SESSION **expired,
+                                   size_t max);
+static void session_expire_lock_stats(SSL_CTX *ctx, OSSL_TIME held);
 static int remove_session_lock(SSL_CTX *ctx, SSL_SESSION *c, int lck);
 
 DEFINE_STACK_OF(SSL_SESSION)
 
+/* Most due sessions that SSL_CTX_add_session() expires in one call */
+#define SSL_SESS_EXPIRE_BATCH   16
+
 __owur static ossl_inline int sess_timedout(OSSL_TIME t, SSL_SESSION *ss)
 {
     return ossl_time_compare(t, ss->calc_timeout) > 0;
@@ -49,6 +58,137 @@ void ssl_session_calculate_timeout(SSL_SESSION *ss)
     ss->calc_timeout = ossl_time_add(ss->time, ss->timeout);
 }
 
+static unsigned long ssl_session_hash(const SSL_SESSION *a)
+{
+    const unsigned char *session_id = a->session_id;
+    unsigned long l;
+    unsigned char tmp_storage[4];
+
+    if (a->session_id_length < sizeof(tmp_storage)) {
+        memset(tmp_storage, 0, sizeof(tmp_storage));
+        memcpy(tmp_storage, a->session_id, a->session_id_length);
+        session_id = tmp_storage;
+    }
+
+    l = (unsigned long)
+        ((unsigned long)session_id[0]) |
+        ((unsigned long)session_id[1] << 8L) |
+        ((unsigned long)session_id[2] << 16L) |
+        ((unsigned long)session_id[3] << 24L);
+    return l;
+}
+
+/*
+ * NB: If this function (or indeed the hash function which uses a sort of
+ * coarser function than this one) is changed, ensure
+ * SSL_CTX_has_matching_session_id() is checked accordingly. It relies on
+ * being able to construct an SSL_SESSION that will collide with any existing
+ * session with a matching session ID.
+ */
+static int ssl_session_cmp(const SSL_SESSION *a, const SSL_SESSION *b)
+{
+    if (a->ssl_version != b->ssl_version)
+        return 1;
+    if (a->session_id_length != b->session_id_length)
+        return 1;
+    return memcmp(a->session_id, b->session_id, a->session_id_length);
+}
+
+static void session_shards_free(SSL_SESS_SHARD *shards, size_t n)
+{
+    size_t i;
+
+    if (shards == NULL)
+        return;
+    for (i = 0; i < n; i++) {
+        lh_SSL_SESSION_free(shards[i].sessions);
+        CRYPTO_THREAD_lock_free(shards[i].lock);
+    }
+    OPENSSL_free(shards);
+}
+
+/*
+ * (Re)creates the internal session cache of |ctx| with |shards| shards.
+ * Any previous cache must be empty.
+ */
+int ssl_session_cache_init(SSL_CTX *ctx, size_t shards)
+{
+    SSL_SESS_SHARD *new_shards;
+    size_t i;
+
+    if (shards == 0 || shards > SSL_SESS_CACHE_MAX_SHARDS)
+        return 0;
+
+    new_shards = OPENSSL_zalloc(sizeof(*new_shards) * shards);
+    if (new_shards == NULL)
+        return 0;
+    for (i = 0; i < shards; i++) {
+        new_shards[i].lock = CRYPTO_THREAD_lock_new();
+        new_shards[i].sessions = lh_SSL_SESSION_new(ssl_session_hash,
+                                                    ssl_session_cmp);
+        if (new_shards[i].lock == NULL || new_shards[i].sessions == NULL) {
+            session_shards_free(new_shards, i + 1);
+            return 0;
+        }
+        new_shards[i].wheel_tick = ossl_time2seconds(ossl_time_now());
+    }
+
+    session_shards_free(ctx->sess_shards, ctx->sess_shard_count);
+    ctx->sess_shards = new_shards;
+    ctx->sess_shard_count = shards;
+    return 1;
+}
+
+void ssl_session_cache_free(SSL_CTX *ctx)
+{
+    session_shards_free(ctx->sess_shards, ctx->sess_shard_count);
+    ctx->sess_shards = NULL;
+    ctx->sess_shard_count = 0;
+}
+
+/* Number of sessions in the internal cache, the sum over all shards */
+size_t ssl_session_cache_count(SSL_CTX *ctx)
+{
+    size_t i, n = 0;
+
+    for (i = 0; i < ctx->sess_shard_count; i++)
+        n += lh_SSL_SESSION_num_items(ctx->sess_shards[i].sessions);
+    return n;
+}
+
+/*
+ * Returns the cache shard that holds, or would hold, sessions with the given
+ * id.  The whole id is hashed (FNV-1a) rather than just the bytes that
+ * ssl_session_hash() looks at, since application supplied ids may well share
+ * a common prefix.
+ */
+SSL_SESS_SHARD *ssl_session_shard(SSL_CTX *ctx, const unsigned char *sess_id,
+                                  size_t sess_id_len)
+{
+    uint32_t h = 0x811c9dc5;
+    size_t i;
+
+    if (ctx->sess_shard_count == 1)
+        return ctx->sess_shards;
+
+    for (i = 0; i < sess_id_len; i++)
+        h = (h ^ sess_id[i]) * 0x01000193;
+    return &ctx->sess_shards[h % ctx->sess_shard_count];
+}
+
+/*
+ * The per shard equivalent of SSL_CTX_sess_get_cache_size(), 0 if the cache
+ * size is unlimited.
+ */
+static size_t session_shard_cache_size(const SSL_CTX *ctx)
+{
+    size_t sz = ctx->session_cache_size / ctx->sess_shard_count;
+
+    if (ctx->session_cache_size > 0 && sz == 0)
+        sz = 1;
+    return sz;
+}
+
 /*
  * SSL_get_session() and SSL_get1_session() are problematic in TLS1.3 because,
  * unlike in earlier protocol versions, the session ticket may not have been
@@ -141,10 +281,10 @@ static SSL_SESSION *ssl_session_dup_intern(const SSL_SESSION *src, int ticket)
         return NULL;
 
     /*
-     * src is logically read-only but the prev/next pointers are not, they are
+     * src is logically read-only but the pprev/next pointers are not, they are
      * part of the session cache and can be modified concurrently.
      */
-    memcpy(dest, src, offsetof(SSL_SESSION, prev));
+    memcpy(dest, src, offsetof(SSL_SESSION, pprev));
 
     /*
      * Set the various pointers to NULL so that we can call SSL_SESSION_free in
@@ -167,7 +307,7 @@ static SSL_SESSION *ssl_session_dup_intern(const SSL_SESSION *src, int ticket)
     memset(&dest->ex_data, 0, sizeof(dest->ex_data));
 
     /* As the copy is not in the cache, we remove the associated pointers */
-    dest->prev = NULL;
+    dest->pprev = NULL;
     dest->next = NULL;
     dest->owner = NULL;
 
@@ -498,6 +638,7 @@ SSL_SESSION *lookup_sess_in_cache(SSL_CONNECTION *s,
 
     if ((s->session_ctx->session_cache_mode
          & SSL_SESS_CACHE_NO_INTERNAL_LOOKUP) == 0) {
+        SSL_SESS_SHARD *shard;
         SSL_SESSION data;
 
         data.ssl_version = s->version;
@@ -507,14 +648,15 @@ SSL_SESSION *lookup_sess_in_cache(SSL_CONNECTION *s,
         memcpy(data.session_id, sess_id, sess_id_len);
         data.session_id_length = sess_id_len;
 
-        if (!CRYPTO_THREAD_read_lock(s->session_ctx->lock))
+        shard = ssl_session_shard(s->session_ctx, sess_id, sess_id_len);
+        if (!CRYPTO_THREAD_read_lock(shard->lock))
             return NULL;
-        ret = lh_SSL_SESSION_retrieve(s->session_ctx->sessions, &data);
+        ret = lh_SSL_SESSION_retrieve(shard->sessions, &data);
         if (ret != NULL) {
             /* don't allow other threads to steal it: */
             SSL_SESSION_up_ref(ret);
         }
-        CRYPTO_THREAD_unlock(s->session_ctx->lock);
+        CRYPTO_THREAD_unlock(shard->lock);
         if (ret == NULL)
             ssl_tsan_counter(s->session_ctx, &s->session_ctx->stats.sess_miss);
     }
@@ -718,8 +860,12 @@ int ssl_get_prev_session(SSL_CONNECTION *s, CLIENTHELLO_MSG *hello)
 
 int SSL_CTX_add_session(SSL_CTX *ctx, SSL_SESSION *c)
 {
-    int ret = 0;
+    int ret = 0, walked = 0;
     SSL_SESSION *s;
+    SSL_SESS_SHARD *shard;
+    SSL_SESSION *expired[SSL_SESS_EXPIRE_BATCH];
+    size_t cache_size, i, nexpired = 0;
+    OSSL_TIME start, walk = ossl_time_zero();
 
     /*
      * add just 1 reference count for the SSL_CTX's session cache even though
@@ -731,20 +877,28 @@ int SSL_CTX_add_session(SSL_CTX *ctx, SSL_SESSION *c)
      * if session c is in already in cache, we take back the increment later
      */
 
-    if (!CRYPTO_THREAD_write_lock(ctx->lock)) {
+    shard = ssl_session_shard(ctx, c->session_id, c->session_id_length);
+    if (!CRYPTO_THREAD_write_lock(shard->lock)) {
         SSL_SESSION_free(c);
         return 0;
     }
-    s = lh_SSL_SESSION_insert(ctx->sessions, c);
+    start = ossl_time_now();
+
+    /* An empty wheel can simply be moved on to the present */
+    if (lh_SSL_SESSION_num_items(shard->sessions) == 0
+            && shard->wheel_tick < ossl_time2seconds(start))
+        shard->wheel_tick = ossl_time2seconds(start);
+
+    s = lh_SSL_SESSION_insert(shard->sessions, c);
 
     /*
      * s != NULL iff we already had a session with the given PID. In this
      * case, s == c should hold (then we did not really modify
-     * ctx->sessions), or we're in trouble.
+     * shard->sessions), or we're in trouble.
      */
     if (s != NULL && s != c) {
         /* We *are* in trouble ... */
-        SSL_SESSION_list_remove(ctx, s);
+        session_wheel_remove(s);
         SSL_SESSION_free(s);
         /*
          * ... so pretend the other session did not exist in cache (we cannot
@@ -754,12 +908,12 @@ int SSL_CTX_add_session(SSL_CTX *ctx, SSL_SESSION *c)
          */
         s = NULL;
     } else if (s == NULL &&
-               lh_SSL_SESSION_retrieve(ctx->sessions, c) == NULL) {
+               lh_SSL_SESSION_retrieve(shard->sessions, c) == NULL) {
         /* s == NULL can also mean OOM error in lh_SSL_SESSION_insert ... */
 
         /*
          * ... so take back the extra reference and also don't add
-         * the session to the SSL_SESSION_list at this time
+         * the session to the timing wheel at this time
          */
         s = c;
     }
@@ -778,9 +932,11 @@ int SSL_CTX_add_session(SSL_CTX *ctx, SSL_SESSION *c)
 
         ret = 1;
 
-        if (SSL_CTX_sess_get_cache_size(ctx) > 0) {
-            while (SSL_CTX_sess_number(ctx) >= SSL_CTX_sess_get_cache_size(ctx)) {
-                if (!remove_session_lock(ctx, ctx->session_cache_tail, 0))
+        /* The size limit is applied per shard */
+        cache_size = session_shard_cache_size(ctx);
+        if (cache_size > 0) {
+            while (lh_SSL_SESSION_num_items(shard->sessions) >= cache_size) {
+                if (!remove_session_lock(ctx, session_wheel_first(shard), 0))
                     break;
                 else
                     ssl_tsan_counter(ctx, &ctx->stats.sess_cache_full);
@@ -788,7 +944,24 @@ int SSL_CTX_add_session(SSL_CTX *ctx, SSL_SESSION *c)
         }
     }
 
-    SSL_SESSION_list_add(ctx, c);
+    session_wheel_add(ctx, shard, c);
+
+    /*
+     * Expire a few due sessions of this shard, which spreads the cost of
+     * expiry over additions instead of leaving it all to a flush.
+     */
+    if ((ctx->session_cache_mode & SSL_SESS_CACHE_NO_AUTO_CLEAR) == 0) {
+        uint64_t tick = shard->wheel_tick;
+
+        walk = ossl_time_now();
+        nexpired = session_wheel_expire(ctx, shard, start, expired,
+                                        OSSL_NELEM(expired));
+        /* Only account for the walk, and only if the wheel had to move */
+        if (nexpired > 0 || shard->wheel_tick != tick) {
+            walked = 1;
+            walk = ossl_time_subtract(ossl_time_now(), walk);
+        }
+    }
 
     if (s != NULL) {
         /*
@@ -799,7 +972,12 @@ int SSL_CTX_add_session(SSL_CTX *ctx, SSL_SESSION *c)
         SSL_SESSION_free(s);    /* s == c */
         ret = 0;
     }
-    CRYPTO_THREAD_unlock(ctx->lock);
+    CRYPTO_THREAD_unlock(shard->lock);
+
+    if (walked)
+        session_expire_lock_stats(ctx, walk);
+    for (i = 0; i < nexpired; i++)
+        SSL_SESSION_free(expired[i]);
     return ret;
 }
 
@@ -811,22 +989,24 @@ int SSL_CTX_remove_session(SSL_CTX *ctx, SSL_SESSION *c)
 static int remove_session_lock(SSL_CTX *ctx, SSL_SESSION *c, int lck)
 {
     SSL_SESSION *r;
+    SSL_SESS_SHARD *shard;
     int ret = 0;
 
     if ((c != NULL) && (c->session_id_length != 0)) {
+        shard = ssl_session_shard(ctx, c->session_id, c->session_id_length);
         if (lck) {
-            if (!CRYPTO_THREAD_write_lock(ctx->lock))
+            if (!CRYPTO_THREAD_write_lock(shard->lock))
                 return 0;
         }
-        if ((r = lh_SSL_SESSION_retrieve(ctx->sessions, c)) != NULL) {
+        if ((r = lh_SSL_SESSION_retrieve(shard->sessions, c)) != NULL) {
             ret = 1;
-            r = lh_SSL_SESSION_delete(ctx->sessions, r);
-            SSL_SESSION_list_remove(ctx, r);
+            r = lh_SSL_SESSION_delete(shard->sessions, r);
+            session_wheel_remove(r);
         }
         c->not_resumable = 1;
 
         if (lck)
-            CRYPTO_THREAD_unlock(ctx->lock);
+            CRYPTO_THREAD_unlock(shard->lock);
 
         if (ctx->remove_session_cb != NULL)
             ctx->remove_session_cb(ctx, c);
@@ -923,16 +1103,19 @@ int SSL_SESSION_set1_id(SSL_SESSION *s, const unsigned char *sid,
 long SSL_SESSION_set_timeout(SSL_SESSION *s, long t)
 {
     OSSL_TIME new_timeout = ossl_seconds2time(t);
+    SSL_SESS_SHARD *shard;
 
     if (s == NULL || t < 0)
         return 0;
     if (s->owner != NULL) {
-        if (!CRYPTO_THREAD_write_lock(s->owner->lock))
+        shard = ssl_session_shard(s->owner, s->session_id,
+                                  s->session_id_length);
+        if (!CRYPTO_THREAD_write_lock(shard->lock))
             return 0;
         s->timeout = new_timeout;
         ssl_session_calculate_timeout(s);
-        SSL_SESSION_list_add(s->owner, s);
-        CRYPTO_THREAD_unlock(s->owner->lock);
+        session_wheel_add(s->owner, shard, s);
+        CRYPTO_THREAD_unlock(shard->lock);
     } else {
         s->timeout = new_timeout;
         ssl_session_calculate_timeout(s);
@@ -964,16 +1147,19 @@ time_t SSL_SESSION_get_time_ex(const SSL_SESSION *s)
 time_t SSL_SESSION_set_time_ex(SSL_SESSION *s, time_t t)
 {
     OSSL_TIME new_time = ossl_time_from_time_t(t);
+    SSL_SESS_SHARD *shard;
 
     if (s == NULL)
         return 0;
     if (s->owner != NULL) {
-        if (!CRYPTO_THREAD_write_lock(s->owner->lock))
+        shard = ssl_session_shard(s->owner, s->session_id,
+                                  s->session_id_length);
+        if (!CRYPTO_THREAD_write_lock(shard->lock))
             return 0;
         s->time = new_time;
         ssl_session_calculate_timeout(s);
-        SSL_SESSION_list_add(s->owner, s);
-        CRYPTO_THREAD_unlock(s->owner->lock);
+        session_wheel_add(s->owner, shard, s);
+        CRYPTO_THREAD_unlock(shard->lock);
     } else {
         s->time = new_time;
         ssl_session_calculate_timeout(s);
@@ -1203,48 +1389,68 @@ void SSL_CTX_flush_sessions(SSL_CTX *s, long t)
 void SSL_CTX_flush_sessions_ex(SSL_CTX *s, time_t t)
 {
     STACK_OF(SSL_SESSION) *sk;
-    SSL_SESSION *current;
+    SSL_SESSION *current, *expired[SSL_SESS_EXPIRE_BATCH];
+    SSL_SESS_SHARD *shard;
     unsigned long i;
+    size_t n, j, nexpired, lvl, slot;
     const OSSL_TIME timeout = ossl_time_from_time_t(t);
-
-    if (!CRYPTO_THREAD_write_lock(s->lock))
-        return;
+    OSSL_TIME start;
 
     sk = sk_SSL_SESSION_new_null();
-    i = lh_SSL_SESSION_get_down_load(s->sessions);
-    lh_SSL_SESSION_set_down_load(s->sessions, 0);
 
     /*
-     * Iterate over the list from the back (oldest), and stop
-     * when a session can no longer be removed.
-     * Add the session to a temporary list to be freed outside
-     * the SSL_CTX lock.
-     * But still do the remove_session_cb() within the lock.
+     * The shards are flushed one after the other, so that lookups and
+     * additions only ever wait for the flush of a single shard.
      */
-    while (s->session_cache_tail != NULL) {
-        current = s->session_cache_tail;
-        if (t == 0 || sess_timedout(timeout, current)) {
-            lh_SSL_SESSION_delete(s->sessions, current);
-            SSL_SESSION_list_remove(s, current);
-            current->not_resumable = 1;
-            if (s->remove_session_cb != NULL)
-                s->remove_session_cb(s, current);
-            /*
-             * Throw the session on a stack, it's entirely plausible
-             * that while freeing outside the critical section, the
-             * session could be re-added, so avoid using the next/prev
-             * pointers. If the stack failed to create, or the session
-             * couldn't be put on the stack, just free it here
-             */
-            if (sk == NULL || !sk_SSL_SESSION_push(sk, current))
-                SSL_SESSION_free(current);
-        } else {
+    for (n = 0; n < s->sess_shard_count; n++) {
+        shard = &s->sess_shards[n];
+        if (!CRYPTO_THREAD_write_lock(shard->lock))
             break;
+        start = ossl_time_now();
+
+        i = lh_SSL_SESSION_get_down_load(shard->sessions);
+        lh_SSL_SESSION_set_down_load(shard->sessions, 0);
+
+        /*
+         * Add the expired sessions to a temporary list to be freed outside
+         * the shard lock. But still do the remove_session_cb() within the
+         * lock. It's entirely plausible that while freeing outside the
+         * critical section, the session could be re-added, so the
+         * pprev/next pointers are not used for that. If the stack failed to
+         * create, or the session couldn't be put on the stack, just free it
+         * here.
+         */
+        if (t == 0) {
+            /* Everything goes, however far in the future it expires */
+            for (lvl = 0; lvl < SSL_SESS_WHEEL_LEVELS; lvl++) {
+                for (slot = 0; slot < SSL_SESS_WHEEL_SLOTS; slot++) {
+                    while ((current = shard->wheel[lvl][slot]) != NULL) {
+                        lh_SSL_SESSION_delete(shard->sessions, current);
+                        session_wheel_remove(current);
+                        current->not_resumable = 1;
+                        if (s->remove_session_cb != NULL)
+                            s->remove_session_cb(s, current);
+                        if (sk == NULL || !sk_SSL_SESSION_push(sk, current))
+                            SSL_SESSION_free(current);
+                    }
+                }
+            }
+        } else {
+            /* Only the slots that are due up to |t| need to be looked at */
+            do {
+                nexpired = session_wheel_expire(s, shard, timeout, expired,
+                                                OSSL_NELEM(expired));
+                for (j = 0; j < nexpired; j++)
+                    if (sk == NULL || !sk_SSL_SESSION_push(sk, expired[j]))
+                        SSL_SESSION_free(expired[j]);
+            } while (nexpired == OSSL_NELEM(expired));
         }
-    }
 
-    lh_SSL_SESSION_set_down_load(s->sessions, i);
-    CRYPTO_THREAD_unlock(s->lock);
+        lh_SSL_SESSION_set_down_load(shard->sessions, i);
+        CRYPTO_THREAD_unlock(shard->lock);
+        session_expire_lock_stats(s, ossl_time_subtract(ossl_time_now(),
+                                                        start));
+    }
 
     sk_SSL_SESSION_pop_free(sk, SSL_SESSION_free);
 }
@@ -1261,84 +1467,266 @@ int ssl_clear_bad_session(SSL_CONNECTION *s)
         return 0;
 }
 
-/* locked by SSL_CTX in the calling function */
-static void SSL_SESSION_list_remove(SSL_CTX *ctx, SSL_SESSION *s)
+static void session_expire_stats(SSL_CTX *ctx, int expired, int ticks,
+                                 int tick_max)
+{
+    if (ssl_tsan_lock(ctx)) {
+        tsan_add(&ctx->stats.sess_expired, expired);
+        tsan_add(&ctx->stats.sess_expire_ticks, ticks);
+        if (tsan_load(&ctx->stats.sess_expire_tick_max) < tick_max)
+            tsan_store(&ctx->stats.sess_expire_tick_max, tick_max);
+        ssl_tsan_unlock(ctx);
+    }
+}
+
+/* Accounts for a shard lock that was held for |held| to expire sessions */
+static void session_expire_lock_stats(SSL_CTX *ctx, OSSL_TIME held)
 {
-    if ((s->next == NULL) || (s->prev == NULL))
+    uint64_t held_us = ossl_time2us(held);
+    int us = held_us > INT_MAX ? INT_MAX : (int)held_us;
+
+    if (ssl_tsan_lock(ctx)) {
+        /* The total saturates rather than wrapping around */
+        if (tsan_load(&ctx->stats.sess_expire_lock_us) > INT_MAX - us)
+            tsan_store(&ctx->stats.sess_expire_lock_us, INT_MAX);
+        else
+            tsan_add(&ctx->stats.sess_expire_lock_us, us);
+        if (tsan_load(&ctx->stats.sess_expire_lock_us_max) < us)
+            tsan_store(&ctx->stats.sess_expire_lock_us_max, us);
+        ssl_tsan_unlock(ctx);
+    }
+}
+
+/*
+ * The timing wheel tick a session is due in: the first whole second after
+ * its timeout.
+ */
+static ossl_inline uint64_t session_expiry_tick(const SSL_SESSION *s)
+{
+    return ossl_time2seconds(s->calc_timeout) + 1;
+}
+
+/* locked by the session cache shard in the calling function */
+static void session_wheel_remove(SSL_SESSION *s)
+{
+    if (s->pprev == NULL)
         return;
 
-    if (s->next == (SSL_SESSION *)&(ctx->session_cache_tail)) {
-        /* last element in list */
-        if (s->prev == (SSL_SESSION *)&(ctx->session_cache_head)) {
-            /* only one element in list */
-            ctx->session_cache_head = NULL;
-            ctx->session_cache_tail = NULL;
-        } else {
-            ctx->session_cache_tail = s->prev;
-            s->prev->next = (SSL_SESSION *)&(ctx->session_cache_tail);
+    if (s->next != NULL)
+        s->next->pprev = s->pprev;
+    *s->pprev = s->next;
+    s->pprev = NULL;
+    s->next = NULL;
+    s->owner = NULL;
+}
+
+/*
+ * Links |s| into the slot of the level of the timing wheel whose range
+ * covers its expiry.  Sessions that are overdue go into the slot that is
+ * expired next.  Timeouts beyond the range of the last level are parked as
+ * far out as it reaches, and moved on when that slot cascades.
+ */
+static void session_wheel_insert(SSL_SESS_SHARD *shard, SSL_SESSION *s)
+{
+    uint64_t expires = session_expiry_tick(s);
+    const uint64_t range = (uint64_t)1 << (SSL_SESS_WHEEL_BITS
+                                           * SSL_SESS_WHEEL_LEVELS);
+    SSL_SESSION **slot;
+    size_t lvl;
+
+    if (expires < shard->wheel_tick)
+        expires = shard->wheel_tick;
+    else if (expires - shard->wheel_tick >= range)
+        expires = shard->wheel_tick + range - 1;
+
+    for (lvl = 0; lvl < SSL_SESS_WHEEL_LEVELS - 1; lvl++)
+        if (expires - shard->wheel_tick
+                < (uint64_t)1 << (SSL_SESS_WHEEL_BITS * (lvl + 1)))
+            break;
+
+    slot = &shard->wheel[lvl][(expires >> (SSL_SESS_WHEEL_BITS * lvl))
+                              & SSL_SESS_WHEEL_MASK];
+    s->next = *slot;
+    if (s->next != NULL)
+        s->next->pprev = &s->next;
+    s->pprev = slot;
+    *slot = s;
+}
+
+static void session_wheel_add(SSL_CTX *ctx, SSL_SESS_SHARD *shard,
+                              SSL_SESSION *s)
+{
+    session_wheel_remove(s);
+    session_wheel_insert(shard, s);
+    s->owner = ctx;
+}
+
+/* Re-files all sessions of a higher level slot that has come into range */
+static void session_wheel_cascade(SSL_SESS_SHARD *shard, size_t lvl,
+                                  size_t slot)
+{
+    SSL_SESSION *s, *next;
+
+    s = shard->wheel[lvl][slot];
+    shard->wheel[lvl][slot] = NULL;
+    for (; s != NULL; s = next) {
+        next = s->next;
+        session_wheel_insert(shard, s);
+    }
+}
+
+/*
+ * Returns the session of |shard| that is (about) the first to expire, which
+ * is the one to drop when the shard is full.  Only the slots are ordered, not
+ * the sessions within a slot.  The current slot of a higher level can only
+ * hold sessions that are a full turn of that level away, so it is looked at
+ * last.
+ */
+static SSL_SESSION *session_wheel_first(SSL_SESS_SHARD *shard)
+{
+    SSL_SESSION *s;
+    size_t lvl, i, cur;
+
+    for (lvl = 0; lvl < SSL_SESS_WHEEL_LEVELS; lvl++) {
+        cur = (size_t)(shard->wheel_tick >> (SSL_SESS_WHEEL_BITS * lvl));
+        for (i = lvl == 0 ? 0 : 1; i <= SSL_SESS_WHEEL_SLOTS; i++) {
+            s = shard->wheel[lvl][(cur + i) & SSL_SESS_WHEEL_MASK];
+            if (s != NULL)
+                return s;
         }
-    } else {
-        if (s->prev == (SSL_SESSION *)&(ctx->session_cache_head)) {
-            /* first element in list */
-            ctx->session_cache_head = s->next;
-            s->next->prev = (SSL_SESSION *)&(ctx->session_cache_head);
-        } else {
-            /* middle of list */
-            s->next->prev = s->prev;
-            s->prev->next = s->next;
+    }
+    return NULL;
+}
+
+/*
+ * Returns the first tick after the current one at which the timing wheel of
+ * |shard| has something to do, which is a level 0 slot holding sessions or a
+ * higher level slot holding sessions to be cascaded, or |limit| if that comes
+ * first.  No level is looked at for more than one revolution.
+ */
+static uint64_t session_wheel_next_tick(const SSL_SESS_SHARD *shard,
+                                        uint64_t limit)
+{
+    uint64_t next = limit, t;
+    size_t lvl, i, shift;
+
+    for (lvl = 0; lvl < SSL_SESS_WHEEL_LEVELS; lvl++) {
+        shift = SSL_SESS_WHEEL_BITS * lvl;
+        for (i = 1; i <= SSL_SESS_WHEEL_SLOTS; i++) {
+            /* A slot of level n cascades when all lower levels wrap */
+            t = ((shard->wheel_tick >> shift) + i) << shift;
+            if (t >= next)
+                break;
+            if (shard->wheel[lvl][(t >> shift) & SSL_SESS_WHEEL_MASK] != NULL) {
+                next = t;
+                break;
+            }
         }
     }
-    s->prev = s->next = NULL;
-    s->owner = NULL;
+    return next;
 }
 
-static void SSL_SESSION_list_add(SSL_CTX *ctx, SSL_SESSION *s)
-{
-    SSL_SESSION *next;
+/*
+ * Moves the timing wheel of |shard| forward to |now|, expiring the sessions
+ * in the slots passed on the way.  Slots with nothing to do are skipped.  At
+ * most |max| sessions are expired and handed back in |expired| for the caller
+ * to free once it has released the shard lock; the wheel stops in the current
+ * slot if there are more.  Returns the number of sessions expired.
+ * Locked by the session cache shard in the calling function.
+ */
+static size_t session_wheel_expire(SSL_CTX *ctx, SSL_SESS_SHARD *shard,
+                                   OSSL_TIME now, SSL_SESSION **expired,
+                                   size_t max)
+{
+    const uint64_t now_tick = ossl_time2seconds(now);
+    SSL_SESSION *s, *next, *keep = NULL;
+    size_t n = 0, lvl, slot;
+    int ticks = 0, tick_expired = 0, tick_max = 0;
+
+    if (lh_SSL_SESSION_num_items(shard->sessions) == 0) {
+        /* Nothing to do however many ticks have passed */
+        if (shard->wheel_tick <= now_tick)
+            shard->wheel_tick = now_tick + 1;
+        return 0;
+    }
+
+    if (shard->wheel_tick > now_tick + 1) {
+        /*
+         * A flush for a time in the future, or a clock that went backwards,
+         * has left the wheel ahead of |now|.  Everything added since then
+         * that is due before the wheel catches up was filed into its current
+         * slot, so that slot is searched instead of moving the wheel.
+         */
+        slot = (size_t)(shard->wheel_tick & SSL_SESS_WHEEL_MASK);
+        for (s = shard->wheel[0][slot]; s != NULL && n < max; s = next) {
+            next = s->next;
+            /* Due at the same tick as if the wheel had moved */
+            if (session_expiry_tick(s) > now_tick)
+                continue;
+            session_wheel_remove(s);
+            lh_SSL_SESSION_delete(shard->sessions, s);
+            s->not_resumable = 1;
+            if (ctx->remove_session_cb != NULL)
+                ctx->remove_session_cb(ctx, s);
+            expired[n++] = s;
+        }
+        if (n > 0)
+            session_expire_stats(ctx, (int)n, 0, 0);
+        return n;
+    }
 
-    if ((s->next != NULL) && (s->prev != NULL))
-        SSL_SESSION_list_remove(ctx, s);
+    while (shard->wheel_tick <= now_tick && n < max) {
+        slot = (size_t)(shard->wheel_tick & SSL_SESS_WHEEL_MASK);
+        if (slot == 0) {
+            for (lvl = 1; lvl < SSL_SESS_WHEEL_LEVELS; lvl++) {
+                size_t hslot = (size_t)(shard->wheel_tick
+                                        >> (SSL_SESS_WHEEL_BITS * lvl))
+                               & SSL_SESS_WHEEL_MASK;
 
-    if (ctx->session_cache_head == NULL) {
-        ctx->session_cache_head = s;
-        ctx->session_cache_tail = s;
-        s->prev = (SSL_SESSION *)&(ctx->session_cache_head);
-        s->next = (SSL_SESSION *)&(ctx->session_cache_tail);
-    } else {
-        if (timeoutcmp(s, ctx->session_cache_head) >= 0) {
-            /*
-             * if we timeout after (or the same time as) the first
-             * session, put us first - usual case
-             */
-            s->next = ctx->session_cache_head;
-            s->next->prev = s;
-            s->prev = (SSL_SESSION *)&(ctx->session_cache_head);
-            ctx->session_cache_head = s;
-        } else if (timeoutcmp(s, ctx->session_cache_tail) < 0) {
-            /* if we timeout before the last session, put us last */
-            s->prev = ctx->session_cache_tail;
-            s->prev->next = s;
-            s->next = (SSL_SESSION *)&(ctx->session_cache_tail);
-            ctx->session_cache_tail = s;
-        } else {
-            /*
-             * we timeout somewhere in-between - if there is only
-             * one session in the cache it will be caught above
-             */
-            next = ctx->session_cache_head->next;
-            while (next != (SSL_SESSION*)&(ctx->session_cache_tail)) {
-                if (timeoutcmp(s, next) >= 0) {
-                    s->next = next;
-                    s->prev = next->prev;
-                    next->prev->next = s;
-                    next->prev = s;
+                session_wheel_cascade(shard, lvl, hslot);
+                if (hslot != 0)
                     break;
-                }
-                next = next->next;
             }
         }
+
+        while ((s = shard->wheel[0][slot]) != NULL && n < max) {
+            session_wheel_remove(s);
+            if (!sess_timedout(now, s)) {
+                /* Only if the clock went backwards, file it again below */
+                s->next = keep;
+                keep = s;
+                continue;
+            }
+            lh_SSL_SESSION_delete(shard->sessions, s);
+            s->not_resumable = 1;
+            if (ctx->remove_session_cb != NULL)
+                ctx->remove_session_cb(ctx, s);
+            expired[n++] = s;
+            tick_expired++;
+        }
+        if (shard->wheel[0][slot] != NULL)
+            break;
+
+        shard->wheel_tick = session_wheel_next_tick(shard, now_tick + 1);
+        ticks++;
+        if (tick_expired > tick_max)
+            tick_max = tick_expired;
+        tick_expired = 0;
+        while ((s = keep) != NULL) {
+            keep = s->next;
+            session_wheel_add(ctx, shard, s);
+        }
     }
-    s->owner = ctx;
+    while ((s = keep) != NULL) {
+        keep = s->next;
+        session_wheel_add(ctx, shard, s);
+    }
+
+    if (tick_expired > tick_max)
+        tick_max = tick_expired;
+    if (n > 0 || ticks > 0)
+        session_expire_stats(ctx, (int)n, ticks, tick_max);
+    return n;
 }
 
 void SSL_CTX_sess_set_new_cb(SSL_CTX *ctx,
@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -452,6 +452,101 @@ static int test_bio_dgram(int idx)
                                bio_dgram_cases[idx].local);
 }
 
+/*
+ * Test sending several datagrams as one buffer with GSO, receiving them either
+ * separately (idx == 0) or coalesced again by GRO (idx == 1).
+ */
+static int test_bio_dgram_gso(int idx)
+{
+    int testresult = 0;
+    BIO *b1 = NULL, *b2 = NULL;
+    int fd1 = -1, fd2 = -1;
+    BIO_ADDR *addr1 = NULL, *addr2 = NULL;
+    union BIO_sock_info_u info1 = {0}, info2 = {0};
+    struct in_addr ina;
+    unsigned char tx_buf[340], rx_buf[512];
+    BIO_MSG tx_msg, rx_msg;
+    size_t num_processed = 0, off = 0, seg, len, piece, expect, i;
+
+    ina.s_addr = htonl(0x7f000001UL);
+    for (i = 0; i < sizeof(tx_buf); i++)
+        tx_buf[i] = (unsigned char)(i * 7);
+
+    if (!TEST_ptr(addr1 = BIO_ADDR_new())
+        || !TEST_ptr(addr2 = BIO_ADDR_new())
+        || !TEST_true(BIO_ADDR_rawmake(addr1, AF_INET, &ina, sizeof(ina), 0))
+        || !TEST_true(BIO_ADDR_rawmake(addr2, AF_INET, &ina, sizeof(ina), 0))
+        || !TEST_int_ge(fd1 = BIO_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, 0), 0)
+        || !TEST_int_ge(fd2 = BIO_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, 0), 0)
+        || !TEST_int_gt(BIO_bind(fd1, addr1, 0), 0)
+        || !TEST_int_gt(BIO_bind(fd2, addr2, 0), 0))
+        goto err;
+
+    info1.addr = addr1;
+    info2.addr = addr2;
+    if (!TEST_int_gt(BIO_sock_info(fd1, BIO_SOCK_INFO_ADDRESS, &info1), 0)
+        || !TEST_int_gt(BIO_sock_info(fd2, BIO_SOCK_INFO_ADDRESS, &info2), 0)
+        || !TEST_ptr(b1 = BIO_new_dgram(fd1, 0))
+        || !TEST_ptr(b2 = BIO_new_dgram(fd2, 0)))
+        goto err;
+
+    if (!BIO_dgram_get_gso_cap(b1)
+        || (idx == 1 && !BIO_dgram_get_gro_cap(b2))) {
+        testresult = TEST_skip("UDP segmentation offload not supported");
+        goto err;
+    }
+
+    if (!TEST_true(BIO_dgram_set_gso_enable(b1, 1))
+        || (idx == 1 && !TEST_true(BIO_dgram_set_gro_enable(b2, 1))))
+        goto err;
+
+    memset(&tx_msg, 0, sizeof(tx_msg));
+    tx_msg.data     = tx_buf;
+    tx_msg.data_len = sizeof(tx_buf);
+    tx_msg.peer     = addr2;
+    tx_msg.flags    = 100;
+    if (!TEST_true(do_sendmmsg(b1, &tx_msg, 1, 0, &num_processed))
+        || !TEST_size_t_eq(num_processed, 1)
+        || !TEST_size_t_eq(tx_msg.data_len, sizeof(tx_buf)))
+        goto err;
+
+    /* Whatever the coalescing, the segments must be as they were sent */
+    while (off < sizeof(tx_buf)) {
+        memset(&rx_msg, 0, sizeof(rx_msg));
+        rx_msg.data     = rx_buf;
+        rx_msg.data_len = sizeof(rx_buf);
+        if (!TEST_true(do_recvmmsg(b2, &rx_msg, 1, 0, &num_processed)))
+            goto err;
+
+        seg = (size_t)(rx_msg.flags & BIO_MSG_SEGMENT_SIZE_MASK);
+        if (idx == 0 && !TEST_size_t_eq(seg, 0))
+            goto err;
+        if (seg == 0)
+            seg = rx_msg.data_len;
+        for (len = 0; len < rx_msg.data_len; len += piece, off += piece) {
+            piece = rx_msg.data_len - len < seg ? rx_msg.data_len - len : seg;
+            expect = sizeof(tx_buf) - off < 100 ? sizeof(tx_buf) - off : 100;
+            if (!TEST_size_t_eq(piece, expect)
+                || !TEST_mem_eq(rx_buf + len, piece, tx_buf + off, piece))
+                goto err;
+        }
+    }
+    if (!TEST_size_t_eq(off, sizeof(tx_buf)))
+        goto err;
+
+    testresult = 1;
+err:
+    BIO_free(b1);
+    BIO_free(b2);
+    if (fd1 >= 0)
+        BIO_closesocket(fd1);
+    if (fd2 >= 0)
+        BIO_closesocket(fd2);
+    BIO_ADDR_free(addr1);
+    BIO_ADDR_free(addr2);
+    return testresult;
+}
+
 # if !defined(OPENSSL_NO_CHACHA)
 static int random_data(const uint32_t *key, uint8_t *data, size_t data_len, size_t offset)
 {
@@ -785,6 +880,7 @@ int setup_tests(void)
 
 #if !defined(OPENSSL_NO_DGRAM) && !defined(OPENSSL_NO_SOCK)
     ADD_ALL_TESTS(test_bio_dgram, OSSL_NELEM(bio_dgram_cases));
+    ADD_ALL_TESTS(test_bio_dgram_gso, 2);
 # if !defined(OPENSSL_NO_CHACHA)
     ADD_ALL_TESTS(test_bio_dgram_pair, 3);
 # endif
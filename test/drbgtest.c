@@ -1,5 +1,5 @@
 /*
- * Copyright 2011-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2011-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -886,6 +886,101 @@ err:
     return ret;
 }
 
+/*
+ * Returns a value which changes whenever |drbg| generates output: the number
+ * of generate calls since the last reseed, and the number of reseeds.
+ */
+static unsigned int generate_counter(EVP_RAND_CTX *drbg)
+{
+    return prov_rand(drbg)->generate_counter + (reseed_counter(drbg) << 16);
+}
+
+/*
+ * Test that small RAND_bytes_ex() requests are served from the buffer of the
+ * <public> DRBG, and that the buffered bytes are not used any more when they
+ * should not.
+ */
+static int test_rand_public_buffer(void)
+{
+    OSSL_LIB_CTX *libctx = NULL;
+    EVP_RAND_CTX *public;
+    unsigned char buf1[RANDOM_SIZE], buf2[RANDOM_SIZE], large[2048];
+    unsigned int counter;
+    int i, ret = 0;
+#if defined(OPENSSL_SYS_UNIX)
+    int fd[2], status;
+    pid_t pid;
+#endif
+
+    if (!TEST_ptr(libctx = OSSL_LIB_CTX_new())
+        || !TEST_size_t_eq(RAND_get_public_buffer_size(libctx), 0)
+        || !TEST_true(RAND_set_public_buffer_size(libctx, 4096))
+        || !TEST_size_t_eq(RAND_get_public_buffer_size(libctx), 4096)
+        || !TEST_int_gt(RAND_bytes_ex(libctx, buf1, sizeof(buf1), 0), 0)
+        || !TEST_ptr(public = RAND_get0_public(libctx)))
+        goto err;
+
+    /* The DRBG is not used again until the buffer runs out */
+    counter = generate_counter(public);
+    for (i = 0; i < 100; i++)
+        if (!TEST_int_gt(RAND_bytes_ex(libctx, buf2, sizeof(buf2), 0), 0)
+            || !TEST_mem_ne(buf1, sizeof(buf1), buf2, sizeof(buf2)))
+            goto err;
+    if (!TEST_uint_eq(generate_counter(public), counter))
+        goto err;
+
+    /* Large requests go to the DRBG */
+    if (!TEST_int_gt(RAND_bytes_ex(libctx, large, sizeof(large), 0), 0)
+        || !TEST_uint_ne(generate_counter(public), counter))
+        goto err;
+
+    /* Reseeding throws the buffered bytes away */
+    RAND_seed(buf1, sizeof(buf1));
+    counter = generate_counter(public);
+    if (!TEST_int_gt(RAND_bytes_ex(libctx, buf1, sizeof(buf1), 0), 0)
+        || !TEST_uint_ne(generate_counter(public), counter))
+        goto err;
+
+#if defined(OPENSSL_SYS_UNIX)
+    /* A child process does not hand out the bytes buffered by its parent */
+    if (!TEST_int_ge(pipe(fd), 0))
+        goto err;
+    if (!TEST_int_ge(pid = fork(), 0)) {
+        close(fd[0]);
+        close(fd[1]);
+        goto err;
+    } else if (pid == 0) {
+        close(fd[0]);
+        ret = RAND_bytes_ex(libctx, buf2, sizeof(buf2), 0) > 0
+              && write(fd[1], buf2, sizeof(buf2)) == sizeof(buf2);
+        close(fd[1]);
+        exit(ret == 0);
+    }
+    close(fd[1]);
+    if (!TEST_int_gt(RAND_bytes_ex(libctx, buf1, sizeof(buf1), 0), 0)
+        || !TEST_int_eq(waitpid(pid, &status, 0), pid)
+        || !TEST_int_eq(status, 0)
+        || !TEST_true(read(fd[0], buf2, sizeof(buf2)) == sizeof(buf2))
+        || !TEST_mem_ne(buf1, sizeof(buf1), buf2, sizeof(buf2))) {
+        close(fd[0]);
+        goto err;
+    }
+    close(fd[0]);
+#endif
+
+    /* Buffering can be turned off again */
+    counter = generate_counter(public);
+    if (!TEST_true(RAND_set_public_buffer_size(libctx, 0))
+        || !TEST_int_gt(RAND_bytes_ex(libctx, buf1, sizeof(buf1), 0), 0)
+        || !TEST_uint_ne(generate_counter(public), counter))
+        goto err;
+
+    ret = 1;
+err:
+    OSSL_LIB_CTX_free(libctx);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_rand_reseed);
@@ -893,6 +988,7 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_rand_fork_safety, RANDOM_SIZE);
 #endif
     ADD_TEST(test_rand_prediction_resistance);
+    ADD_TEST(test_rand_public_buffer);
 #if defined(OPENSSL_THREADS)
     ADD_TEST(test_multi_thread);
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2001-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2001-2025 The OpenSSL Project Authors. All Rights Reserved.
  * Copyright (c) 2002, Oracle and/or its affiliates. All rights reserved
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
@@ -1266,6 +1266,38 @@ static const struct nistp_test_params nistp_tests_params[] = {
      /* d */
      "c477f9f65c22cce20657faa5b2d1d8122336f851a508a1ed04e479c34985bf96",
      },
+    {
+     /* P-384, d is even so that the test can halve it */
+     NID_secp384r1,
+     384,
+     /* p */
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
+     "ffffffff0000000000000000ffffffff",
+     /* a */
+     "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
+     "ffffffff0000000000000000fffffffc",
+     /* b */
+     "b3312fa7e23ee7e4988e056be3f82d19181d9c6efe8141120314088f5013875a"
+     "c656398d8a2ed19d2a85c8edd3ec2aef",
+     /* Qx */
+     "96dcf7290f602f468a62d23517c4c76cb3282db8a76432d4f9f66224ee9a71bf"
+     "689b18dc9acb3b49c84455d6a2af1345",
+     /* Qy */
+     "6999b5d7ff54c12793f2c7f2466d6eca87c4536cdb02d8a09f6b50658066b7a3"
+     "92155f1c5dd2d73254481d1a67c66695",
+     /* Gx */
+     "aa87ca22be8b05378eb1c71ef320ad746e1d3b628ba79b9859f741e082542a38"
+     "5502f25dbf55296c3a545e3872760ab7",
+     /* Gy */
+     "3617de4a96262c6f5d9e98bf9292dc29f8f41dbd289a147ce9da3113b5f0b8c0"
+     "0a60b1ce1d7e819d7a431d7c90ea0e5f",
+     /* order */
+     "ffffffffffffffffffffffffffffffffffffffffffffffffc7634d81f4372ddf"
+     "581a0db248b0a77aecec196accc52973",
+     /* d */
+     "6b9d3dad2e1b8c1c05b19875b6659f4de23c3b667bf297ba9aa47740787137d8"
+     "96d5724e4c70a825f872c9ea60d2edf4",
+     },
     {
      /* P-521 */
      NID_secp521r1,
@@ -1317,7 +1349,7 @@ static int nistp_single_test(int idx)
     BIGNUM *n = NULL, *m = NULL, *order = NULL, *yplusone = NULL;
     EC_GROUP *NISTP = NULL;
     EC_POINT *G = NULL, *P = NULL, *Q = NULL, *Q_CHECK = NULL;
-    int r = 0;
+    int i, r = 0;
 
     TEST_note("NIST curve P-%d (optimised implementation):",
               test->degree);
@@ -1361,6 +1393,52 @@ static int nistp_single_test(int idx)
         || !TEST_int_eq(EC_GROUP_get_degree(NISTP), test->degree))
         goto err;
 
+    /*
+     * Fixed point multiplication uses different tables than random point
+     * multiplication, check that they agree, also for scalars that end in
+     * zero digits or that are larger than the order
+     */
+    for (i = 0; i < 40; i++) {
+        switch (i) {
+        case 0:
+            BN_zero(m);
+            break;
+        case 1:
+        case 2:
+        case 3:
+            if (!TEST_true(BN_set_word(m, 15 + i)))
+                goto err;
+            break;
+        case 4:
+            if (!TEST_true(BN_sub(m, order, BN_value_one())))
+                goto err;
+            break;
+        case 5:
+            if (!TEST_ptr(BN_copy(m, order)))
+                goto err;
+            break;
+        case 6:
+            BN_zero(m);
+            if (!TEST_true(BN_set_bit(m, test->degree))
+                || !TEST_true(BN_sub(m, m, BN_value_one())))
+                goto err;
+            break;
+        case 7:
+            if (!TEST_true(BN_set_word(m, 0x10))
+                || !TEST_true(BN_lshift(m, m, test->degree - 5)))
+                goto err;
+            break;
+        default:
+            if (!TEST_true(BN_rand_range(m, order)))
+                goto err;
+            break;
+        }
+        if (!TEST_true(EC_POINT_mul(NISTP, Q, m, NULL, NULL, ctx))
+            || !TEST_true(EC_POINT_mul(NISTP, P, NULL, G, m, ctx))
+            || !TEST_int_eq(0, EC_POINT_cmp(NISTP, Q, P, ctx)))
+            goto err;
+    }
+
     TEST_note("NIST test vectors ... ");
     if (!TEST_true(BN_hex2bn(&n, test->d)))
         goto err;
@@ -1445,6 +1523,205 @@ err:
     return r;
 }
 
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+static const int multi_mul_curves[] = {
+    NID_X9_62_prime256v1,
+    NID_secp384r1,
+    NID_secp256k1,
+# ifndef OPENSSL_NO_EC2M
+    NID_sect283r1,
+# endif
+};
+
+/*
+ * Test EC_POINTs_mul() with enough points for the bucket method to be used,
+ * against the sum of the results of EC_POINTs_mul() on a few points at a time.
+ */
+static int multi_mul_test(int idx)
+{
+    const size_t num = 200, chunk = 8;
+    BN_CTX *ctx = NULL;
+    EC_GROUP *group = NULL;
+    EC_POINT *R = NULL, *S = NULL, *T = NULL;
+    EC_POINT **points = NULL;
+    BIGNUM **scalars = NULL;
+    const BIGNUM *order;
+    BIGNUM *g_scalar = NULL;
+    size_t i;
+    int r = 0;
+
+    if (!TEST_ptr(ctx = BN_CTX_new())
+        || !TEST_ptr(group = EC_GROUP_new_by_curve_name(multi_mul_curves[idx]))
+        || !TEST_ptr(order = EC_GROUP_get0_order(group))
+        || !TEST_ptr(R = EC_POINT_new(group))
+        || !TEST_ptr(S = EC_POINT_new(group))
+        || !TEST_ptr(T = EC_POINT_new(group))
+        || !TEST_ptr(g_scalar = BN_new())
+        || !TEST_ptr(points = OPENSSL_zalloc(num * sizeof(*points)))
+        || !TEST_ptr(scalars = OPENSSL_zalloc(num * sizeof(*scalars))))
+        goto err;
+
+    for (i = 0; i < num; i++) {
+        if (!TEST_ptr(points[i] = EC_POINT_new(group))
+            || !TEST_ptr(scalars[i] = BN_new())
+            || !TEST_true(BN_rand_range(scalars[i], order))
+            || !TEST_true(EC_POINT_mul(group, points[i], scalars[i], NULL,
+                                       NULL, ctx))
+            || !TEST_true(BN_rand_range(scalars[i], order)))
+            goto err;
+    }
+
+    /* Repeated and opposite points, and a point at infinity */
+    if (!TEST_true(EC_POINT_copy(points[1], points[0]))
+        || !TEST_true(EC_POINT_copy(points[2], points[0]))
+        || !TEST_true(EC_POINT_invert(group, points[2], ctx))
+        || !TEST_true(EC_POINT_set_to_infinity(group, points[3]))
+        /* Zero, negative, too long scalars and the order */
+        || !TEST_true(BN_copy(scalars[4], BN_value_one()))
+        || !TEST_true(BN_sub_word(scalars[4], 1))
+        || !TEST_true(BN_copy(scalars[1], scalars[0]))
+        || !TEST_true(BN_copy(scalars[2], scalars[0]))
+        || !TEST_true(BN_copy(scalars[6], scalars[5]))
+        || !TEST_true(BN_add(scalars[7], scalars[7], order))
+        || !TEST_true(BN_lshift(scalars[7], scalars[7], 5))
+        || !TEST_true(BN_copy(scalars[8], order))
+        || !TEST_true(BN_rand_range(g_scalar, order)))
+        goto err;
+    BN_set_negative(scalars[5], 1);
+
+    if (!TEST_true(EC_POINTs_mul(group, R, g_scalar, num,
+                                 (const EC_POINT **)points,
+                                 (const BIGNUM **)scalars, ctx))
+        || !TEST_true(EC_POINT_mul(group, S, g_scalar, NULL, NULL, ctx)))
+        goto err;
+    for (i = 0; i < num; i += chunk) {
+        if (!TEST_true(EC_POINTs_mul(group, T, NULL, chunk,
+                                     (const EC_POINT **)points + i,
+                                     (const BIGNUM **)scalars + i, ctx))
+            || !TEST_true(EC_POINT_add(group, S, S, T, ctx)))
+            goto err;
+    }
+    if (!TEST_int_eq(EC_POINT_cmp(group, R, S, ctx), 0))
+        goto err;
+
+    /* With all the scalars negated, the sum is -R */
+    for (i = 0; i < num; i++)
+        BN_set_negative(scalars[i], !BN_is_negative(scalars[i]));
+    BN_set_negative(g_scalar, 1);
+    if (!TEST_true(EC_POINTs_mul(group, S, g_scalar, num,
+                                 (const EC_POINT **)points,
+                                 (const BIGNUM **)scalars, ctx))
+        || !TEST_true(EC_POINT_add(group, S, S, R, ctx))
+        || !TEST_true(EC_POINT_is_at_infinity(group, S)))
+        goto err;
+
+    r = 1;
+
+ err:
+    if (points != NULL)
+        for (i = 0; i < num; i++)
+            EC_POINT_free(points[i]);
+    if (scalars != NULL)
+        for (i = 0; i < num; i++)
+            BN_free(scalars[i]);
+    OPENSSL_free(points);
+    OPENSSL_free(scalars);
+    BN_free(g_scalar);
+    EC_POINT_free(R);
+    EC_POINT_free(S);
+    EC_POINT_free(T);
+    EC_GROUP_free(group);
+    BN_CTX_free(ctx);
+    return r;
+}
+
+/*
+ * Precomputed multiples of the generator are shared by all the groups of
+ * a library context for the same curve, check that groups which borrow them
+ * compute the same as a group that does without.
+ */
+static int shared_precompute_test(void)
+{
+    OSSL_LIB_CTX *libctx = NULL, *ref_libctx = NULL;
+    BN_CTX *ctx = NULL;
+    EC_GROUP *group = NULL, *copy = NULL, *fresh = NULL, *ref = NULL;
+    EC_POINT *P = NULL, *R = NULL, *S = NULL;
+    BIGNUM *m = NULL, *n = NULL;
+    const BIGNUM *order;
+    int r = 0;
+
+    if (!TEST_ptr(libctx = OSSL_LIB_CTX_new())
+        || !TEST_ptr(ref_libctx = OSSL_LIB_CTX_new())
+        || !TEST_ptr(ctx = BN_CTX_new())
+        || !TEST_ptr(group = EC_GROUP_new_by_curve_name_ex(libctx, NULL,
+                                                           NID_brainpoolP256r1))
+        || !TEST_ptr(copy = EC_GROUP_dup(group))
+        || !TEST_ptr(ref = EC_GROUP_new_by_curve_name_ex(ref_libctx, NULL,
+                                                         NID_brainpoolP256r1))
+        || !TEST_ptr(order = EC_GROUP_get0_order(group))
+        || !TEST_ptr(P = EC_POINT_new(group))
+        || !TEST_ptr(R = EC_POINT_new(group))
+        || !TEST_ptr(S = EC_POINT_new(group))
+        || !TEST_ptr(m = BN_new())
+        || !TEST_ptr(n = BN_new())
+        || !TEST_true(BN_rand_range(m, order))
+        || !TEST_true(BN_rand_range(n, order))
+        || !TEST_true(EC_POINT_mul(group, P, m, NULL, NULL, ctx))
+        || !TEST_true(BN_rand_range(m, order)))
+        goto err;
+
+    /* The reference group is explicit, so it never uses precomputation */
+    EC_GROUP_set_curve_name(ref, NID_undef);
+    if (!TEST_true(EC_POINT_mul(ref, R, n, P, m, ctx))
+        || !TEST_false(EC_GROUP_have_precompute_mult(ref)))
+        goto err;
+
+    if (!TEST_false(EC_GROUP_have_precompute_mult(group))
+        || !TEST_true(EC_GROUP_precompute_mult(group, ctx))
+        || !TEST_true(EC_GROUP_have_precompute_mult(group))
+        || !TEST_true(EC_POINT_mul(group, S, n, P, m, ctx))
+        || !TEST_int_eq(EC_POINT_cmp(group, R, S, ctx), 0))
+        goto err;
+
+    /* An explicit copy and a group created later pick them up */
+    EC_GROUP_set_curve_name(copy, NID_undef);
+    if (!TEST_true(EC_GROUP_precompute_mult(copy, ctx))
+        || !TEST_true(EC_GROUP_have_precompute_mult(copy))
+        || !TEST_true(EC_POINT_mul(copy, S, n, P, m, ctx))
+        || !TEST_int_eq(EC_POINT_cmp(group, R, S, ctx), 0)
+        || !TEST_ptr(fresh = EC_GROUP_new_by_curve_name_ex(libctx, NULL,
+                                                           NID_brainpoolP256r1))
+        || !TEST_true(EC_POINT_mul(fresh, S, n, P, m, ctx))
+        || !TEST_int_eq(EC_POINT_cmp(group, R, S, ctx), 0))
+        goto err;
+
+    /* Leave the cache with the last reference when the context goes away */
+    EC_GROUP_free(group);
+    EC_GROUP_free(copy);
+    EC_GROUP_free(fresh);
+    group = copy = fresh = NULL;
+    OSSL_LIB_CTX_free(libctx);
+    libctx = NULL;
+
+    r = 1;
+
+ err:
+    BN_free(m);
+    BN_free(n);
+    EC_POINT_free(P);
+    EC_POINT_free(R);
+    EC_POINT_free(S);
+    EC_GROUP_free(group);
+    EC_GROUP_free(copy);
+    EC_GROUP_free(fresh);
+    EC_GROUP_free(ref);
+    BN_CTX_free(ctx);
+    OSSL_LIB_CTX_free(libctx);
+    OSSL_LIB_CTX_free(ref_libctx);
+    return r;
+}
+#endif
+
 static const unsigned char p521_named[] = {
     0x06, 0x05, 0x2b, 0x81, 0x04, 0x00, 0x23,
 };
@@ -3137,6 +3414,10 @@ int setup_tests(void)
     ADD_ALL_TESTS(char2_curve_test, OSSL_NELEM(char2_curve_tests));
 #endif
     ADD_ALL_TESTS(nistp_single_test, OSSL_NELEM(nistp_tests_params));
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+    ADD_ALL_TESTS(multi_mul_test, OSSL_NELEM(multi_mul_curves));
+    ADD_TEST(shared_precompute_test);
+#endif
     ADD_ALL_TESTS(internal_curve_test, crv_len);
     ADD_ALL_TESTS(internal_curve_test_method, crv_len);
     ADD_TEST(group_field_test);
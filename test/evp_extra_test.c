@@ -1,5 +1,5 @@
 /*
- * Copyright 2015-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2015-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -1556,6 +1556,318 @@ static int test_EVP_PKEY_sign(int tst)
     return ret;
 }
 
+/*
+ * Test EVP_PKEY_sign_batch() with:
+ * 0: RSA with PKCS#1 v1.5 padding and SHA-256
+ * 1: RSA with PSS padding and SHA-256
+ * 2: RSA with PKCS#1 v1.5 padding and no digest
+ * 3: EC, which has no batch implementation
+ */
+static int test_EVP_PKEY_sign_batch(int tst)
+{
+    int ret = 0;
+    size_t i, sigsize = 0;
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL;
+    unsigned char tbs[5][32];
+    unsigned char *sig = NULL;
+    const unsigned char *tbsp[5];
+    unsigned char *sigp[5];
+    size_t tbslen[5], siglen[5];
+
+    if (tst == 3) {
+#ifndef OPENSSL_NO_EC
+        if (!TEST_ptr(pkey = load_example_ec_key()))
+            goto out;
+#else
+        return TEST_skip("EC disabled");
+#endif
+    } else if (!TEST_ptr(pkey = load_example_rsa_key())) {
+        goto out;
+    }
+
+    ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey, NULL);
+    if (!TEST_ptr(ctx)
+            || !TEST_int_gt(EVP_PKEY_sign_init(ctx), 0))
+        goto out;
+    if (tst == 0 || tst == 1) {
+        if (!TEST_int_gt(EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()), 0))
+            goto out;
+    }
+    if (tst == 1
+            && !TEST_int_gt(EVP_PKEY_CTX_set_rsa_padding(ctx,
+                                                         RSA_PKCS1_PSS_PADDING),
+                            0))
+        goto out;
+    if (!TEST_int_gt(EVP_PKEY_sign(ctx, NULL, &sigsize, tbs[0],
+                                   sizeof(tbs[0])), 0)
+            || !TEST_ptr(sig = OPENSSL_malloc(sigsize * OSSL_NELEM(tbs))))
+        goto out;
+
+    for (i = 0; i < OSSL_NELEM(tbs); i++) {
+        memset(tbs[i], (int)i + 1, sizeof(tbs[i]));
+        tbsp[i] = tbs[i];
+        tbslen[i] = sizeof(tbs[i]);
+        sigp[i] = sig + i * sigsize;
+    }
+
+    /* Test sending signature buffers that are too short is rejected */
+    if (!TEST_int_le(EVP_PKEY_sign_batch(ctx, OSSL_NELEM(tbs), sigp, siglen,
+                                         1, tbsp, tbslen), 0)
+            || !TEST_int_gt(EVP_PKEY_sign_batch(ctx, OSSL_NELEM(tbs), sigp,
+                                                siglen, sigsize, tbsp, tbslen),
+                            0))
+        goto out;
+
+    /* Test each of the signatures round-trips, and only for its own input */
+    if (!TEST_int_gt(EVP_PKEY_verify_init(ctx), 0))
+        goto out;
+    if (tst == 0 || tst == 1) {
+        if (!TEST_int_gt(EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()), 0))
+            goto out;
+    }
+    if (tst == 1
+            && !TEST_int_gt(EVP_PKEY_CTX_set_rsa_padding(ctx,
+                                                         RSA_PKCS1_PSS_PADDING),
+                            0))
+        goto out;
+    for (i = 0; i < OSSL_NELEM(tbs); i++) {
+        if (!TEST_size_t_le(siglen[i], sigsize)
+                || !TEST_int_gt(EVP_PKEY_verify(ctx, sigp[i], siglen[i],
+                                                tbsp[i], tbslen[i]), 0)
+                || !TEST_int_le(EVP_PKEY_verify(ctx, sigp[i], siglen[i],
+                                                tbsp[(i + 1) % OSSL_NELEM(tbs)],
+                                                tbslen[i]), 0))
+            goto out;
+    }
+
+    ret = 1;
+ out:
+    EVP_PKEY_CTX_free(ctx);
+    OPENSSL_free(sig);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+
+/*
+ * Test EVP_PKEY_verify_batch() with:
+ * 0: EC, with the batched ECDSA verification
+ * 1: ED25519, 2: ED448 and 3: RSA, which have no batch implementation and are
+ *    verified one signature at a time
+ * Enough signatures are used for the batched implementation to split them up.
+ */
+static int test_EVP_PKEY_verify_batch(int tst)
+{
+    int ret = 0;
+    size_t i, sigsize = 0;
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_SIGNATURE *sigalg = NULL;
+    unsigned char tbs[70][32];
+    unsigned char *sig = NULL;
+    const unsigned char *tbsp[70], *sigp[70];
+    size_t tbslen[70], siglen[70];
+    int results[70];
+
+    switch (tst) {
+    case 0:
+#ifndef OPENSSL_NO_EC
+        pkey = load_example_ec_key();
+        break;
+#else
+        return TEST_skip("EC disabled");
+#endif
+    case 1:
+    case 2:
+#ifndef OPENSSL_NO_ECX
+        pkey = EVP_PKEY_Q_keygen(testctx, NULL, tst == 1 ? "ED25519" : "ED448");
+        /* EdDSA signs whole messages, so needs EVP_PKEY_*_message_init() */
+        if (!TEST_ptr(sigalg = EVP_SIGNATURE_fetch(testctx,
+                                                   tst == 1 ? "ED25519"
+                                                            : "ED448",
+                                                   NULL)))
+            goto out;
+        break;
+#else
+        return TEST_skip("ECX disabled");
+#endif
+    default:
+        pkey = load_example_rsa_key();
+        break;
+    }
+    if (!TEST_ptr(pkey))
+        goto out;
+
+    ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey, NULL);
+    if (!TEST_ptr(ctx)
+            || !TEST_int_gt(sigalg != NULL
+                            ? EVP_PKEY_sign_message_init(ctx, sigalg, NULL)
+                            : EVP_PKEY_sign_init(ctx), 0)
+            || !TEST_int_gt(EVP_PKEY_sign(ctx, NULL, &sigsize, tbs[0],
+                                          sizeof(tbs[0])), 0)
+            || !TEST_ptr(sig = OPENSSL_malloc(sigsize * OSSL_NELEM(tbs))))
+        goto out;
+
+    for (i = 0; i < OSSL_NELEM(tbs); i++) {
+        memset(tbs[i], (int)i + 1, sizeof(tbs[i]));
+        tbsp[i] = tbs[i];
+        tbslen[i] = sizeof(tbs[i]);
+        sigp[i] = sig + i * sigsize;
+        siglen[i] = sigsize;
+        if ((sigalg != NULL
+             && !TEST_int_gt(EVP_PKEY_sign_message_init(ctx, sigalg, NULL), 0))
+                || !TEST_int_gt(EVP_PKEY_sign(ctx, sig + i * sigsize,
+                                              &siglen[i], tbs[i], tbslen[i]),
+                                0))
+            goto out;
+    }
+
+    if (!TEST_int_gt(sigalg != NULL
+                     ? EVP_PKEY_verify_message_init(ctx, sigalg, NULL)
+                     : EVP_PKEY_verify_init(ctx), 0)
+            || !TEST_int_eq(EVP_PKEY_verify_batch(ctx, OSSL_NELEM(tbs), sigp,
+                                                  siglen, tbsp, tbslen,
+                                                  results), 1)
+            || !TEST_int_eq(EVP_PKEY_verify_batch(ctx, OSSL_NELEM(tbs), sigp,
+                                                  siglen, tbsp, tbslen, NULL),
+                            1)
+            || !TEST_int_eq(EVP_PKEY_verify_batch(ctx, 0, NULL, NULL, NULL,
+                                                  NULL, NULL), 1))
+        goto out;
+    for (i = 0; i < OSSL_NELEM(tbs); i++)
+        if (!TEST_int_eq(results[i], 1))
+            goto out;
+
+    /* Test the invalid signatures are picked out from the rest */
+    sig[3 * sigsize + siglen[3] - 1] ^= 1;
+    tbs[66][0] ^= 1;
+    if (!TEST_int_eq(EVP_PKEY_verify_batch(ctx, OSSL_NELEM(tbs), sigp, siglen,
+                                           tbsp, tbslen, results), 0)
+            || !TEST_int_eq(EVP_PKEY_verify_batch(ctx, OSSL_NELEM(tbs), sigp,
+                                                  siglen, tbsp, tbslen, NULL),
+                            0))
+        goto out;
+    for (i = 0; i < OSSL_NELEM(tbs); i++)
+        if (!TEST_int_eq(results[i], i != 3 && i != 66))
+            goto out;
+
+    ret = 1;
+ out:
+    EVP_PKEY_CTX_free(ctx);
+    EVP_SIGNATURE_free(sigalg);
+    OPENSSL_free(sig);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+
+#ifndef OPENSSL_NO_ECX
+/*
+ * Ed25519 verification checks the strict equation [s]B - [h]A == R. Check that
+ * EVP_PKEY_verify_batch() does too, by making a signature whose R is A plus a
+ * point of order two, (0, -1), and whose s is a * (1 + h) mod l, so that it
+ * only satisfies the cofactored equation that batch verification would use.
+ */
+static int test_EVP_PKEY_verify_batch_ed25519_torsion(void)
+{
+    static const unsigned char seed[32] = {
+        0x9d, 0x61, 0xb1, 0x9d, 0xef, 0xfd, 0x5a, 0x60, 0xba, 0x84, 0x4a, 0xf4,
+        0x92, 0xec, 0x2c, 0xc4, 0x44, 0x49, 0xc5, 0x69, 0x7b, 0x32, 0x69, 0x19,
+        0x70, 0x3b, 0x7e, 0x8c, 0x60, 0x05, 0x1b, 0x1a
+    };
+    static const unsigned char l[32] = {
+        0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2,
+        0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+    };
+    static const unsigned char tbs[2][8] = { "message", "torsion" };
+    unsigned char pub[32], buf[96], md[64], sig[2][64];
+    const unsigned char *tbsp[2] = { tbs[0], tbs[1] }, *sigp[2];
+    size_t tbslen[2] = { sizeof(tbs[0]), sizeof(tbs[1]) };
+    size_t siglen[2] = { sizeof(sig[0]), sizeof(sig[1]) };
+    size_t publen = sizeof(pub), mdlen;
+    int results[2], ret = 0;
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_SIGNATURE *sigalg = NULL;
+    BN_CTX *bnctx = NULL;
+    BIGNUM *a, *h, *order, *y;
+
+    if (!TEST_ptr(bnctx = BN_CTX_new_ex(testctx)))
+        goto out;
+    BN_CTX_start(bnctx);
+    a = BN_CTX_get(bnctx);
+    h = BN_CTX_get(bnctx);
+    order = BN_CTX_get(bnctx);
+    if (!TEST_ptr(y = BN_CTX_get(bnctx))
+            || !TEST_ptr(pkey = EVP_PKEY_new_raw_private_key_ex(testctx,
+                                                                "ED25519", NULL,
+                                                                seed,
+                                                                sizeof(seed)))
+            || !TEST_true(EVP_PKEY_get_raw_public_key(pkey, pub, &publen))
+            || !TEST_ptr(sigalg = EVP_SIGNATURE_fetch(testctx, "ED25519", NULL))
+            || !TEST_ptr(ctx = EVP_PKEY_CTX_new_from_pkey(testctx, pkey, NULL))
+            || !TEST_int_gt(EVP_PKEY_sign_message_init(ctx, sigalg, NULL), 0)
+            || !TEST_int_gt(EVP_PKEY_sign(ctx, sig[0], &siglen[0], tbs[0],
+                                          tbslen[0]), 0))
+        goto out;
+
+    /* The secret scalar a, from the clamped hash of the seed */
+    if (!TEST_true(EVP_Q_digest(testctx, "SHA512", NULL, seed, sizeof(seed),
+                                md, &mdlen)))
+        goto out;
+    md[0] &= 248;
+    md[31] &= 63;
+    md[31] |= 64;
+    if (!TEST_ptr(BN_lebin2bn(md, 32, a))
+            || !TEST_ptr(BN_lebin2bn(l, sizeof(l), order)))
+        goto out;
+
+    /* R = A + (0, -1) = (-x, -y), encoded as p - y and the negated sign */
+    memcpy(buf, pub, 32);
+    buf[31] &= 0x7f;
+    if (!TEST_ptr(BN_lebin2bn(buf, 32, y))
+            || !TEST_true(BN_set_bit(h, 255))
+            || !TEST_true(BN_sub_word(h, 19))
+            || !TEST_true(BN_sub(y, h, y))
+            || !TEST_int_eq(BN_bn2lebinpad(y, sig[1], 32), 32))
+        goto out;
+    sig[1][31] |= (pub[31] & 0x80) ^ 0x80;
+
+    /* s = a * (1 + h) mod l, with h = SHA512(R || A || M) mod l */
+    memcpy(buf, sig[1], 32);
+    memcpy(buf + 32, pub, 32);
+    memcpy(buf + 64, tbs[1], tbslen[1]);
+    if (!TEST_true(EVP_Q_digest(testctx, "SHA512", NULL, buf,
+                                64 + tbslen[1], md, &mdlen))
+            || !TEST_ptr(BN_lebin2bn(md, sizeof(md), h))
+            || !TEST_true(BN_add_word(h, 1))
+            || !TEST_true(BN_mod_mul(h, h, a, order, bnctx))
+            || !TEST_int_eq(BN_bn2lebinpad(h, sig[1] + 32, 32), 32))
+        goto out;
+
+    sigp[0] = sig[0];
+    sigp[1] = sig[1];
+    if (!TEST_int_gt(EVP_PKEY_verify_message_init(ctx, sigalg, NULL), 0)
+            || !TEST_int_eq(EVP_PKEY_verify(ctx, sig[1], siglen[1], tbs[1],
+                                            tbslen[1]), 0)
+            || !TEST_int_gt(EVP_PKEY_verify_message_init(ctx, sigalg, NULL), 0)
+            || !TEST_int_eq(EVP_PKEY_verify_batch(ctx, 2, sigp, siglen, tbsp,
+                                                  tbslen, results), 0)
+            || !TEST_int_eq(results[0], 1)
+            || !TEST_int_eq(results[1], 0))
+        goto out;
+
+    ret = 1;
+ out:
+    BN_CTX_end(bnctx);
+    BN_CTX_free(bnctx);
+    EVP_PKEY_CTX_free(ctx);
+    EVP_SIGNATURE_free(sigalg);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+#endif
+
 #ifndef OPENSSL_NO_DEPRECATED_3_0
 static int test_EVP_PKEY_sign_with_app_method(int tst)
 {
@@ -5965,6 +6277,11 @@ int setup_tests(void)
     ADD_TEST(test_EVP_Digest);
     ADD_TEST(test_EVP_md_null);
     ADD_ALL_TESTS(test_EVP_PKEY_sign, 3);
+    ADD_ALL_TESTS(test_EVP_PKEY_sign_batch, 4);
+    ADD_ALL_TESTS(test_EVP_PKEY_verify_batch, 4);
+#ifndef OPENSSL_NO_ECX
+    ADD_TEST(test_EVP_PKEY_verify_batch_ed25519_torsion);
+#endif
 #ifndef OPENSSL_NO_DEPRECATED_3_0
     ADD_ALL_TESTS(test_EVP_PKEY_sign_with_app_method, 2);
 #endif
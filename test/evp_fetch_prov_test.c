@@ -16,6 +16,7 @@
 
 #include <string.h>
 #include <openssl/sha.h>
+#include <openssl/err.h>
 #include <openssl/evp.h>
 #include <openssl/provider.h>
 #include "internal/sizes.h"
@@ -142,6 +143,44 @@ err:
     return rc;
 }
 
+/*
+ * Check that a fetch doesn't return a method that was cached before the
+ * default properties changed or the provider behind it was unloaded.
+ */
+static int test_stale_EVP_MD_fetch(void)
+{
+    OSSL_LIB_CTX *ctx = NULL;
+    OSSL_PROVIDER *prov = NULL;
+    EVP_MD *md = NULL;
+    int ret = 0;
+
+    if (!TEST_ptr(ctx = OSSL_LIB_CTX_new())
+        || !TEST_ptr(prov = OSSL_PROVIDER_load(ctx, "default"))
+        || !TEST_ptr(md = EVP_MD_fetch(ctx, "SHA2-256", NULL)))
+        goto err;
+    EVP_MD_free(md);
+
+    if (!TEST_true(EVP_set_default_properties(ctx, "provider=base"))
+        || !TEST_ptr_null(md = EVP_MD_fetch(ctx, "SHA2-256", NULL))
+        || !TEST_true(EVP_set_default_properties(ctx, NULL))
+        || !TEST_ptr(md = EVP_MD_fetch(ctx, "SHA2-256", NULL)))
+        goto err;
+    EVP_MD_free(md);
+
+    if (!TEST_true(OSSL_PROVIDER_unload(prov)))
+        goto err;
+    prov = NULL;
+    if (!TEST_ptr_null(md = EVP_MD_fetch(ctx, "SHA2-256", NULL)))
+        goto err;
+    ERR_clear_error();
+    ret = 1;
+ err:
+    EVP_MD_free(md);
+    OSSL_PROVIDER_unload(prov);
+    OSSL_LIB_CTX_free(ctx);
+    return ret;
+}
+
 static X509_ALGOR *make_algor(int nid)
 {
     X509_ALGOR *algor;
@@ -405,6 +444,7 @@ int setup_tests(void)
         ADD_TEST(test_implicit_EVP_MD_fetch);
         ADD_TEST(test_explicit_EVP_MD_fetch_by_name);
         ADD_ALL_TESTS_NOSUBTEST(test_explicit_EVP_MD_fetch_by_X509_ALGOR, 2);
+        ADD_TEST(test_stale_EVP_MD_fetch);
     } else {
         ADD_TEST(test_implicit_EVP_CIPHER_fetch);
         ADD_TEST(test_explicit_EVP_CIPHER_fetch_by_name);
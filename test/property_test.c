@@ -603,6 +603,58 @@ err:
     return res;
 }
 
+static int test_query_cache_deferred_flush(void)
+{
+    OSSL_METHOD_STORE *store;
+    OSSL_PROVIDER prov1 = { 1 }, prov2 = { 2 };
+    void *result = NULL;
+    int res = 0;
+
+    if (!TEST_ptr(store = ossl_method_store_new(NULL))
+        || !add_property_names("n", NULL)
+        || !TEST_true(ossl_method_store_add(store, &prov1, 1, "n=1", "a",
+                                            &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_add(store, &prov1, 2, "n=1", "b",
+                                            &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_cache_set(store, &prov1, 1, "", "a",
+                                                  &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_cache_set(store, &prov1, 2, "", "b",
+                                                  &up_ref, &down_ref)))
+        goto err;
+
+    /* Additions made with the store reserved are flushed on release */
+    if (!TEST_true(ossl_method_lock_store(store))
+        || !TEST_true(ossl_method_store_add(store, &prov2, 1, "n=2", "c",
+                                            &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_add(store, &prov2, 2, "n=2", "d",
+                                            &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_cache_get(store, NULL, 1, "",
+                                                  &result))
+        || !TEST_true(ossl_method_unlock_store(store))
+        || !TEST_false(ossl_method_store_cache_get(store, NULL, 1, "",
+                                                   &result))
+        || !TEST_false(ossl_method_store_cache_get(store, NULL, 2, "",
+                                                   &result)))
+        goto err;
+
+    /* Removing a provider flushes all of its algorithms */
+    if (!TEST_true(ossl_method_store_cache_set(store, &prov2, 1, "n=2", "c",
+                                               &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_cache_set(store, &prov1, 2, "n=1", "b",
+                                                  &up_ref, &down_ref))
+        || !TEST_true(ossl_method_store_remove_all_provided(store, &prov2))
+        || !TEST_false(ossl_method_store_cache_get(store, NULL, 1, "n=2",
+                                                   &result))
+        || !TEST_false(ossl_method_store_cache_get(store, NULL, 2, "n=1",
+                                                   &result)))
+        goto err;
+    res = 1;
+
+err:
+    ossl_method_store_free(store);
+    return res;
+}
+
 static int test_fips_mode(void)
 {
     int ret = 0;
@@ -699,6 +751,7 @@ int setup_tests(void)
     ADD_TEST(test_register_deregister);
     ADD_TEST(test_property);
     ADD_TEST(test_query_cache_stochastic);
+    ADD_TEST(test_query_cache_deferred_flush);
     ADD_TEST(test_fips_mode);
     ADD_ALL_TESTS(test_property_list_to_string, OSSL_NELEM(to_string_tests));
     return 1;
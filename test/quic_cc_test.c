@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -13,6 +13,7 @@
 #include "testutil.h"
 #include <openssl/ssl.h>
 #include "internal/quic_cc.h"
+#include "internal/quic_pacer.h"
 #include "internal/priority_queue.h"
 
 /*
@@ -33,6 +34,22 @@ static void step_time(uint32_t ms)
     fake_time = ossl_time_add(fake_time, ossl_ms2time(ms));
 }
 
+/*
+ * Congestion Controllers
+ * ======================
+ */
+static const OSSL_CC_METHOD *const cc_methods[] = {
+    &ossl_cc_newreno_method,
+    &ossl_cc_cubic_method,
+    &ossl_cc_bbr2_method
+};
+
+static const char *const cc_names[] = {
+    "NewReno",
+    "CUBIC",
+    "BBRv2"
+};
+
 /*
  * Network Simulation
  * ==================
@@ -325,12 +342,12 @@ static int dump_state(const OSSL_CC_METHOD *ccm, OSSL_CC_DATA *cc,
  * capacity. The average estimated channel capacity should not be too far from
  * the actual channel capacity.
  */
-static int test_simulate(void)
+static int test_simulate(int idx)
 {
     int testresult = 0;
     int rc;
     int have_sim = 0;
-    const OSSL_CC_METHOD *ccm = &ossl_cc_newreno_method;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
     OSSL_CC_DATA *cc = NULL;
     size_t mdpl = 1472;
     uint64_t total_sent = 0, total_to_send, allowance;
@@ -474,17 +491,447 @@ err:
     return testresult;
 }
 
+/*
+ * Bottleneck Test
+ * ===============
+ *
+ * Simulates a path made of a bottleneck link with a given rate and a drop-tail
+ * queue, followed by a given propagation delay, optionally with random loss.
+ * Unlike the network simulator above, packets which are sent faster than the
+ * bottleneck can forward them queue up, which increases their RTT. Each
+ * congestion controller drives the path for a while, and we report the goodput
+ * and the mean queueing delay it achieves. Optionally, transmissions are paced
+ * by a QUIC_PACER placed in front of the congestion controller.
+ */
+struct link_sim {
+    const OSSL_CC_METHOD *ccm;
+    OSSL_CC_DATA         *cc;
+    QUIC_PACER           *pacer; /* NULL if not paced */
+
+    uint64_t    rate;       /* bytes/s */
+    OSSL_TIME   delay;      /* one-way propagation delay */
+    uint64_t    buf_len;    /* bytes */
+    uint32_t    loss_ppm;   /* random loss, in parts per million */
+    OSSL_TIME   ack_agg;    /* acks are released at multiples of this */
+    uint32_t    seed;
+
+    /* Time at which the bottleneck will have forwarded all queued packets. */
+    OSSL_TIME   link_free;
+    PRIORITY_QUEUE_OF(NET_PKT) *pkts;
+
+    uint64_t    total_acked, total_lost; /* bytes */
+    OSSL_TIME   total_queue_delay, max_queue_delay;
+    uint64_t    num_queued;
+
+    /* Largest volume sent back to back at a single point in time. */
+    OSSL_TIME   burst_time;
+    uint64_t    burst, max_burst;
+};
+
+static const struct bottleneck_st {
+    const char  *name;
+    uint64_t    rate;       /* bytes/s */
+    uint32_t    rtt;        /* ms */
+    uint32_t    buf_pct;    /* queue size relative to the BDP */
+    uint32_t    loss_ppm;
+    uint32_t    ack_agg;    /* ms, 0 for none */
+} bottlenecks[] = {
+    /* 100 Mb/s over 150 ms, with a BDP sized buffer */
+    { "clean", 12500000, 150, 100, 0, 0 },
+    /* The same with 0.01% random loss */
+    { "lossy", 12500000, 150, 100, 100, 0 },
+};
+
+static int link_sim_send(struct link_sim *s, size_t sz)
+{
+    NET_PKT *pkt = OPENSSL_zalloc(sizeof(*pkt));
+    OSSL_TIME start, queue_delay;
+    uint64_t queued;
+
+    if (!TEST_ptr(pkt))
+        return 0;
+
+    start       = ossl_time_max(fake_time, s->link_free);
+    queue_delay = ossl_time_subtract(start, fake_time);
+    queued      = ossl_time2ticks(queue_delay) * s->rate / OSSL_TIME_SECOND;
+
+    pkt->tx_time    = fake_time;
+    pkt->size       = sz;
+
+    if (queued + sz > s->buf_len) {
+        /* Tail drop, noticed about when the packet would have been acked. */
+        pkt->success    = 0;
+        pkt->next_time  = ossl_time_add(start, ossl_time_multiply(s->delay, 2));
+    } else {
+        s->link_free    = ossl_time_add(start,
+                                        ossl_ticks2time(sz * OSSL_TIME_SECOND
+                                                        / s->rate));
+        pkt->next_time  = ossl_time_add(s->link_free,
+                                        ossl_time_multiply(s->delay, 2));
+
+        /* Hold the ack back until the next aggregation boundary. */
+        if (!ossl_time_is_zero(s->ack_agg)) {
+            uint64_t t = ossl_time2ticks(pkt->next_time);
+            uint64_t agg = ossl_time2ticks(s->ack_agg);
+
+            pkt->next_time = ossl_ticks2time((t + agg - 1) / agg * agg);
+        }
+
+        /* xorshift32 */
+        s->seed ^= s->seed << 13;
+        s->seed ^= s->seed >> 17;
+        s->seed ^= s->seed << 5;
+        pkt->success    = s->seed % 1000000 >= s->loss_ppm;
+
+        s->total_queue_delay = ossl_time_add(s->total_queue_delay,
+                                             queue_delay);
+        s->max_queue_delay = ossl_time_max(s->max_queue_delay, queue_delay);
+        ++s->num_queued;
+    }
+
+    if (ossl_time_compare(fake_time, s->burst_time) != 0) {
+        s->burst_time   = fake_time;
+        s->burst        = 0;
+    }
+    s->burst += sz;
+    if (s->burst > s->max_burst)
+        s->max_burst = s->burst;
+
+    if (s->pacer != NULL)
+        ossl_quic_pacer_on_data_sent(s->pacer, sz);
+
+    if (!TEST_true(s->ccm->on_data_sent(s->cc, sz))
+        || !TEST_true(ossl_pqueue_NET_PKT_push(s->pkts, pkt, &pkt->idx))) {
+        OPENSSL_free(pkt);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Delivers the acknowledgements and losses which have come due. */
+static int link_sim_process(struct link_sim *s)
+{
+    NET_PKT *pkt;
+
+    while ((pkt = ossl_pqueue_NET_PKT_peek(s->pkts)) != NULL
+           && ossl_time_compare(pkt->next_time, fake_time) <= 0) {
+        ossl_pqueue_NET_PKT_pop(s->pkts);
+
+        if (pkt->success) {
+            OSSL_CC_ACK_INFO ack_info = {0};
+
+            ack_info.tx_time = pkt->tx_time;
+            ack_info.tx_size = pkt->size;
+            s->total_acked += pkt->size;
+
+            if (!TEST_true(s->ccm->on_data_acked(s->cc, &ack_info)))
+                goto err;
+        } else {
+            OSSL_CC_LOSS_INFO loss_info = {0};
+
+            loss_info.tx_time = pkt->tx_time;
+            loss_info.tx_size = pkt->size;
+            s->total_lost += pkt->size;
+
+            if (!TEST_true(s->ccm->on_data_lost(s->cc, &loss_info))
+                || !TEST_true(s->ccm->on_data_lost_finished(s->cc, 0)))
+                goto err;
+        }
+
+        OPENSSL_free(pkt);
+    }
+
+    return 1;
+
+err:
+    OPENSSL_free(pkt);
+    return 0;
+}
+
+struct link_result {
+    double      goodput;        /* bytes/s */
+    double      queue_delay;    /* mean, in ms */
+    double      max_queue_delay; /* ms */
+    uint64_t    max_burst;      /* bytes */
+};
+
+static int run_bottleneck(const struct bottleneck_st *b, int idx, int paced,
+                          struct link_result *res)
+{
+    int testresult = 0, have_pacer = 0;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
+    struct link_sim sim = {0};
+    QUIC_PACER pacer;
+    size_t mdpl = 1472;
+    uint64_t bdp;
+    OSSL_TIME duration = ossl_ms2time(10000), end, next;
+    OSSL_PARAM params[2];
+    NET_PKT *pkt;
+
+    fake_time = TIME_BASE;
+    end = ossl_time_add(fake_time, duration);
+
+    bdp = b->rate * b->rtt / 1000;
+    sim.ccm         = ccm;
+    sim.rate        = b->rate;
+    sim.delay       = ossl_ms2time(b->rtt / 2);
+    sim.buf_len     = bdp * b->buf_pct / 100;
+    sim.loss_ppm    = b->loss_ppm;
+    sim.ack_agg     = ossl_ms2time(b->ack_agg);
+    sim.seed        = 0x2545f491;
+    sim.link_free   = fake_time;
+
+    if (!TEST_ptr(sim.pkts = ossl_pqueue_NET_PKT_new(net_pkt_cmp))
+        || !TEST_ptr(sim.cc = ccm->new(fake_now, NULL)))
+        goto err;
+
+    params[0] = OSSL_PARAM_construct_size_t(OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
+                                            &mdpl);
+    params[1] = OSSL_PARAM_construct_end();
+    if (!TEST_true(ccm->set_input_params(sim.cc, params)))
+        goto err;
+
+    ccm->reset(sim.cc);
+
+    if (paced) {
+        if (!TEST_true(ossl_quic_pacer_init(&pacer, ccm, sim.cc,
+                                            fake_now, NULL)))
+            goto err;
+        have_pacer = 1;
+        sim.pacer = &pacer;
+    }
+
+    while (ossl_time_compare(fake_time, end) < 0) {
+        if (!link_sim_process(&sim))
+            goto err;
+
+        /*
+         * Use all of our allowance in full-sized packets, like a download. As
+         * the TXP does, send a packet whenever the pacer allows anything.
+         */
+        while (ccm->get_tx_allowance(sim.cc) >= mdpl
+               && (!paced || ossl_quic_pacer_get_tx_allowance(&pacer) > 0))
+            if (!link_sim_send(&sim, mdpl))
+                goto err;
+
+        /* Skip to the next acknowledgement or loss, or pacer wakeup. */
+        pkt = ossl_pqueue_NET_PKT_peek(sim.pkts);
+        next = pkt != NULL ? pkt->next_time : ossl_time_infinite();
+        if (paced && ccm->get_tx_allowance(sim.cc) >= mdpl)
+            next = ossl_time_min(next,
+                                 ossl_quic_pacer_get_wakeup_deadline(&pacer));
+
+        /* Something must be in flight or paced as we could not send. */
+        if (!TEST_false(ossl_time_is_infinite(next))
+            || !TEST_uint64_t_gt(ossl_time2ticks(next),
+                                 ossl_time2ticks(fake_time)))
+            goto err;
+
+        fake_time = next;
+    }
+
+    res->goodput = (double)sim.total_acked
+        / ((double)ossl_time2ticks(duration) / OSSL_TIME_SECOND);
+    res->queue_delay = sim.num_queued == 0 ? 0.0
+        : (double)ossl_time2ticks(sim.total_queue_delay)
+          / sim.num_queued / OSSL_TIME_MS;
+    res->max_queue_delay = (double)ossl_time2ticks(sim.max_queue_delay)
+        / OSSL_TIME_MS;
+    res->max_burst = sim.max_burst;
+
+    TEST_info("%s link, %-7s%s: goodput %6.2f MB/s (%5.1f%%), "
+              "queueing delay %6.1f ms (max %6.1f ms), loss %5.2f%%, "
+              "max burst %llu kB",
+              b->name, cc_names[idx], paced ? " paced" : "",
+              res->goodput / 1e6, res->goodput * 100.0 / b->rate,
+              res->queue_delay, res->max_queue_delay,
+              sim.total_lost * 100.0 / (sim.total_acked + sim.total_lost),
+              (unsigned long long)(res->max_burst / 1000));
+
+    testresult = 1;
+err:
+    if (have_pacer)
+        ossl_quic_pacer_cleanup(&pacer);
+    if (sim.pkts != NULL)
+        ossl_pqueue_NET_PKT_pop_free(sim.pkts, do_free);
+    if (sim.cc != NULL)
+        ccm->free(sim.cc);
+    return testresult;
+}
+
+static int test_bottleneck(int idx)
+{
+    const struct bottleneck_st *b = &bottlenecks[idx];
+    struct link_result res[OSSL_NELEM(cc_methods)];
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(cc_methods); ++i)
+        if (!TEST_true(run_bottleneck(b, (int)i, 0, &res[i])))
+            return 0;
+
+    if (b->loss_ppm == 0) {
+        /* Every controller should manage to fill a clean pipe. */
+        for (i = 0; i < OSSL_NELEM(cc_methods); ++i)
+            if (!TEST_double_ge(res[i].goodput, b->rate * 0.7))
+                return 0;
+
+        /* BBR should not keep the buffer full, unlike loss-based control. */
+        if (!TEST_double_lt(res[2].queue_delay, res[0].queue_delay)
+            || !TEST_double_lt(res[2].queue_delay, res[1].queue_delay))
+            return 0;
+    } else {
+        /*
+         * Random loss hurts NewReno the most, CUBIC recovers faster, and BBR
+         * hardly notices it.
+         */
+        if (!TEST_double_gt(res[1].goodput, res[0].goodput)
+            || !TEST_double_gt(res[2].goodput, res[1].goodput))
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Pacing Test
+ * ===========
+ *
+ * Runs each congestion controller over a path with a shallow buffer on which
+ * acknowledgements arrive in batches, with and without pacing. Unpaced, the
+ * window opened by each batch is used in a burst at line rate which overflows
+ * the queue at the bottleneck.
+ */
+static const struct bottleneck_st shallow_link =
+    /* 100 Mb/s over 50 ms, with a tenth of the BDP of buffer and 5 ms batches */
+    { "shallow", 12500000, 50, 10, 0, 5 };
+
+static int test_pacing(int idx)
+{
+    struct link_result unpaced, paced;
+
+    if (!TEST_true(run_bottleneck(&shallow_link, idx, 0, &unpaced))
+        || !TEST_true(run_bottleneck(&shallow_link, idx, 1, &paced)))
+        return 0;
+
+    /* Pacing should avoid the bursts and the losses they cause. */
+    if (!TEST_uint64_t_lt(paced.max_burst, unpaced.max_burst)
+        || !TEST_double_gt(paced.goodput, unpaced.goodput)
+        || !TEST_double_ge(paced.goodput, shallow_link.rate * 0.5))
+        return 0;
+
+    return 1;
+}
+
+/*
+ * Checks the pacer against the rate published by the congestion controller:
+ * there is no pacing before the first RTT sample, and after that no more than
+ * a small burst above the rate can be sent in any interval.
+ */
+static int test_pacer(int idx)
+{
+    int testresult = 0, have_pacer = 0;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
+    OSSL_CC_DATA *cc = NULL;
+    OSSL_CC_ACK_INFO ack_info = {0};
+    QUIC_PACER pacer;
+    OSSL_PARAM params[2];
+    OSSL_TIME start, deadline;
+    size_t mdpl = 1472;
+    uint64_t rate, sent = 0, limit;
+    int i;
+
+    fake_time = TIME_BASE;
+
+    if (!TEST_ptr(cc = ccm->new(fake_now, NULL)))
+        goto err;
+
+    params[0] = OSSL_PARAM_construct_size_t(OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
+                                            &mdpl);
+    params[1] = OSSL_PARAM_construct_end();
+    if (!TEST_true(ccm->set_input_params(cc, params)))
+        goto err;
+
+    ccm->reset(cc);
+
+    if (!TEST_true(ossl_quic_pacer_init(&pacer, ccm, cc, fake_now, NULL)))
+        goto err;
+    have_pacer = 1;
+
+    /* Without an RTT estimate, the window alone applies. */
+    if (!TEST_uint64_t_eq(ossl_quic_pacer_get_rate(&pacer), 0)
+        || !TEST_uint64_t_eq(ossl_quic_pacer_get_tx_allowance(&pacer),
+                             ccm->get_tx_allowance(cc)))
+        goto err;
+
+    ack_info.tx_time = fake_time;
+    ack_info.tx_size = mdpl;
+    ossl_quic_pacer_on_data_sent(&pacer, mdpl);
+    if (!TEST_true(ccm->on_data_sent(cc, mdpl)))
+        goto err;
+
+    step_time(100);
+    if (!TEST_true(ccm->on_data_acked(cc, &ack_info))
+        || !TEST_uint64_t_gt(rate = ossl_quic_pacer_get_rate(&pacer), 0))
+        goto err;
+
+    /*
+     * Send whenever the pacer lets us until the window is used up, sleeping
+     * until the wakeup deadline otherwise.
+     */
+    start = fake_time;
+    for (i = 0; i < 1000; ++i) {
+        while (ossl_quic_pacer_get_tx_allowance(&pacer) > 0) {
+            ossl_quic_pacer_on_data_sent(&pacer, mdpl);
+            if (!TEST_true(ccm->on_data_sent(cc, mdpl)))
+                goto err;
+            sent += mdpl;
+        }
+
+        if (ccm->get_tx_allowance(cc) == 0)
+            break;
+
+        deadline = ossl_quic_pacer_get_wakeup_deadline(&pacer);
+        if (!TEST_uint64_t_gt(ossl_time2ticks(deadline),
+                              ossl_time2ticks(fake_time))
+            || !TEST_false(ossl_time_is_infinite(deadline)))
+            goto err;
+        fake_time = deadline;
+    }
+
+    /* The window must have been spread out, and not sent in one go. */
+    if (!TEST_uint64_t_eq(ossl_quic_pacer_get_rate(&pacer), rate)
+        || !TEST_uint64_t_gt(ossl_time2ticks(fake_time),
+                             ossl_time2ticks(start)))
+        goto err;
+
+    /* Allow for a burst of at most a couple of datagrams or a millisecond. */
+    limit = rate * ossl_time2ticks(ossl_time_subtract(fake_time, start))
+            / OSSL_TIME_SECOND
+        + (rate / 1000 > 2 * mdpl ? rate / 1000 : 2 * mdpl) + mdpl;
+    if (!TEST_uint64_t_le(sent, limit))
+        goto err;
+
+    testresult = 1;
+err:
+    if (have_pacer)
+        ossl_quic_pacer_cleanup(&pacer);
+    if (cc != NULL)
+        ccm->free(cc);
+    return testresult;
+}
+
 /*
  * Sanity Test
  * ===========
  *
  * Basic test of the congestion control APIs.
  */
-static int test_sanity(void)
+static int test_sanity(int idx)
 {
     int testresult = 0;
     OSSL_CC_DATA *cc = NULL;
-    const OSSL_CC_METHOD *ccm = &ossl_cc_newreno_method;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
     OSSL_CC_LOSS_INFO loss_info = {0};
     OSSL_CC_ACK_INFO ack_info = {0};
     uint64_t allowance, allowance2;
@@ -623,7 +1070,10 @@ int setup_tests(void)
         "\"State\"\n");
 #endif
 
-    ADD_TEST(test_simulate);
-    ADD_TEST(test_sanity);
+    ADD_ALL_TESTS(test_simulate, OSSL_NELEM(cc_methods));
+    ADD_ALL_TESTS(test_sanity, OSSL_NELEM(cc_methods));
+    ADD_ALL_TESTS(test_bottleneck, OSSL_NELEM(bottlenecks));
+    ADD_ALL_TESTS(test_pacer, OSSL_NELEM(cc_methods));
+    ADD_ALL_TESTS(test_pacing, OSSL_NELEM(cc_methods));
     return 1;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright 2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2023-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -99,8 +99,68 @@ err:
     return testresult;
 }
 
+static int test_lcidm_steering(int idx)
+{
+    int testresult = 0;
+    QUIC_LCIDM *lcidm = NULL, *lcidm_0 = NULL;
+    unsigned int steer_bits = idx + 1, steer_id, id;
+    QUIC_CONN_ID lcid;
+    OSSL_QUIC_FRAME_NEW_CONN_ID ncid_frame;
+    int i;
+
+    if (!TEST_ptr(lcidm = ossl_quic_lcidm_new(NULL, 10))
+        || !TEST_ptr(lcidm_0 = ossl_quic_lcidm_new(NULL, 0)))
+        goto err;
+
+    if (!TEST_false(ossl_quic_lcidm_get_steering_id(lcidm, &cid8_1, &id))
+        || !TEST_false(ossl_quic_lcidm_set_steering(lcidm,
+                                                    QUIC_LCIDM_MAX_STEER_BITS + 1,
+                                                    0))
+        || !TEST_false(ossl_quic_lcidm_set_steering(lcidm, steer_bits,
+                                                    1U << steer_bits))
+        || !TEST_false(ossl_quic_lcidm_set_steering(lcidm_0, steer_bits, 0))
+        || !TEST_true(ossl_quic_lcidm_set_steering(lcidm_0, 0, 0)))
+        goto err;
+
+    for (steer_id = 0; steer_id < (1U << steer_bits); ++steer_id) {
+        if (!TEST_true(ossl_quic_lcidm_set_steering(lcidm, steer_bits,
+                                                    steer_id))
+            || !TEST_true(ossl_quic_lcidm_generate_initial(lcidm,
+                                                           ptrs + (steer_id % 8),
+                                                           &lcid))
+            || !TEST_true(ossl_quic_lcidm_get_steering_id(lcidm, &lcid, &id))
+            || !TEST_uint_eq(id, steer_id))
+            goto err;
+
+        for (i = 0; i < 4; ++i)
+            if (!TEST_true(ossl_quic_lcidm_generate(lcidm, ptrs + (steer_id % 8),
+                                                    &ncid_frame))
+                || !TEST_true(ossl_quic_lcidm_get_steering_id(lcidm,
+                                                              &ncid_frame.conn_id,
+                                                              &id))
+                || !TEST_uint_eq(id, steer_id))
+                goto err;
+
+        /* A CID of another length, such as an ODCID, carries no steering ID */
+        if (!TEST_false(ossl_quic_lcidm_get_steering_id(lcidm, &cid8_1, &id))
+            || !TEST_true(ossl_quic_lcidm_cull(lcidm, ptrs + (steer_id % 8))))
+            goto err;
+    }
+
+    if (!TEST_true(ossl_quic_lcidm_set_steering(lcidm, 0, 0))
+        || !TEST_false(ossl_quic_lcidm_get_steering_id(lcidm, &lcid, &id)))
+        goto err;
+
+    testresult = 1;
+err:
+    ossl_quic_lcidm_free(lcidm);
+    ossl_quic_lcidm_free(lcidm_0);
+    return testresult;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_lcidm);
+    ADD_ALL_TESTS(test_lcidm_steering, QUIC_LCIDM_MAX_STEER_BITS);
     return 1;
 }
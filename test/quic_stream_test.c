@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -338,6 +338,190 @@ static int test_sstream_bulk(int idx)
     return testresult;
 }
 
+#define REF_NUM_CHUNKS      32
+#define REF_MAX_CHUNK_LEN   1000
+
+struct ref_chunk {
+    unsigned char   *buf;       /* NULL for data appended by copying */
+    size_t          start, len;
+    int             released;
+};
+
+static void ref_release_cb(const void *buf, size_t buf_len, void *arg)
+{
+    struct ref_chunk *chunk = arg;
+
+    if (buf == chunk->buf && buf_len == chunk->len)
+        ++chunk->released;
+}
+
+/*
+ * Appends a random mix of copied and referenced data, then transmits, loses,
+ * and acknowledges it in random order, checking that each referenced buffer is
+ * given back exactly once, as soon as all of its data has been acknowledged.
+ */
+static int test_sstream_ref(int idx)
+{
+    int testresult = 0;
+    QUIC_SSTREAM *sstream = NULL;
+    OSSL_QUIC_FRAME_STREAM hdr;
+    OSSL_QTX_IOVEC iov[2];
+    struct ref_chunk chunks[REF_NUM_CHUNKS];
+    unsigned char *ref_buf = NULL, *dst_buf = NULL, *acked = NULL;
+    size_t i, j, k, l, num_iov, consumed, total = 0, rd, *ranges = NULL, tmp;
+    size_t num_ranges = 0;
+
+    memset(chunks, 0, sizeof(chunks));
+
+    if (!TEST_ptr(sstream = ossl_quic_sstream_new(REF_NUM_CHUNKS
+                                                  * REF_MAX_CHUNK_LEN))
+        || !TEST_ptr(ref_buf = OPENSSL_malloc(REF_NUM_CHUNKS
+                                              * REF_MAX_CHUNK_LEN))
+        || !TEST_ptr(dst_buf = OPENSSL_malloc(REF_NUM_CHUNKS
+                                              * REF_MAX_CHUNK_LEN)))
+        goto err;
+
+    for (i = 0; i < REF_NUM_CHUNKS; ++i) {
+        chunks[i].start = total;
+        chunks[i].len   = (test_random() % REF_MAX_CHUNK_LEN) + 1;
+        for (j = 0; j < chunks[i].len; ++j)
+            ref_buf[total + j] = (unsigned char)(test_random() & 0xFF);
+
+        if ((test_random() & 1) != 0) {
+            if (!TEST_ptr(chunks[i].buf = OPENSSL_memdup(ref_buf + total,
+                                                         chunks[i].len))
+                || !TEST_true(ossl_quic_sstream_append_ref(sstream,
+                                                           chunks[i].buf,
+                                                           chunks[i].len,
+                                                           ref_release_cb,
+                                                           &chunks[i])))
+                goto err;
+        } else if (!TEST_true(ossl_quic_sstream_append(sstream,
+                                                       ref_buf + total,
+                                                       chunks[i].len,
+                                                       &consumed))
+                   || !TEST_size_t_eq(consumed, chunks[i].len)) {
+            goto err;
+        }
+
+        total += chunks[i].len;
+    }
+
+    if (!TEST_uint64_t_eq(ossl_quic_sstream_get_cur_size(sstream), total))
+        goto err;
+
+    /* Transmit everything, losing the first frame once. */
+    for (k = 0; k < 2; ++k) {
+        for (rd = 0; rd < total;) {
+            num_iov = OSSL_NELEM(iov);
+            if (!TEST_true(ossl_quic_sstream_get_stream_frame(sstream, 0, &hdr,
+                                                              iov, &num_iov))
+                || !TEST_uint64_t_eq(hdr.offset, rd)
+                || !TEST_true(compare_iov(ref_buf + rd, (size_t)hdr.len,
+                                          iov, num_iov))
+                || !TEST_true(ossl_quic_sstream_mark_transmitted(sstream,
+                                                                 hdr.offset,
+                                                                 hdr.offset
+                                                                 + hdr.len - 1)))
+                goto err;
+
+            memcpy(dst_buf + rd, ref_buf + rd, (size_t)hdr.len);
+            rd += (size_t)hdr.len;
+
+            if (k == 0) {
+                if (!TEST_true(ossl_quic_sstream_mark_lost(sstream, hdr.offset,
+                                                           hdr.offset
+                                                           + hdr.len - 1)))
+                    goto err;
+                break;
+            }
+        }
+    }
+
+    num_iov = OSSL_NELEM(iov);
+    if (!TEST_mem_eq(dst_buf, rd, ref_buf, total)
+        || !TEST_false(ossl_quic_sstream_get_stream_frame(sstream, 0, &hdr,
+                                                          iov, &num_iov)))
+        goto err;
+
+    /* Acknowledge the stream in random pieces in a random order. */
+    if (!TEST_ptr(ranges = OPENSSL_malloc(sizeof(*ranges) * (total + 1)))
+        || !TEST_ptr(acked = OPENSSL_zalloc(total)))
+        goto err;
+
+    for (i = 0; i < total; i += l) {
+        l = (test_random() % 500) + 1;
+        ranges[num_ranges++] = i;
+    }
+    ranges[num_ranges] = total;
+
+    for (i = 0; i < num_ranges; ++i) {
+        j = test_random() % num_ranges;
+        tmp = ranges[i];
+        ranges[i] = ranges[j];
+        ranges[j] = tmp;
+    }
+
+    for (i = 0; i < num_ranges; ++i) {
+        /* Find the end of the piece, i.e. the next boundary after its start. */
+        l = total;
+        for (j = 0; j < num_ranges; ++j)
+            if (ranges[j] > ranges[i] && ranges[j] < l)
+                l = ranges[j];
+
+        if (!TEST_true(ossl_quic_sstream_mark_acked(sstream, ranges[i], l - 1)))
+            goto err;
+
+        memset(acked + ranges[i], 1, l - ranges[i]);
+
+        for (k = 0; k < REF_NUM_CHUNKS; ++k) {
+            if (chunks[k].buf == NULL)
+                continue;
+
+            j = 0;
+            while (j < chunks[k].len && acked[chunks[k].start + j])
+                ++j;
+
+            if (!TEST_int_eq(chunks[k].released, j == chunks[k].len))
+                goto err;
+        }
+    }
+
+    if (!TEST_true(ossl_quic_sstream_is_totally_acked(sstream))
+        || !TEST_size_t_eq(ossl_quic_sstream_get_buffer_used(sstream), 0))
+        goto err;
+
+    /* Buffers still referenced when the stream is freed are given back then. */
+    for (k = 0; k < REF_NUM_CHUNKS; ++k)
+        if (chunks[k].buf != NULL)
+            break;
+
+    if (k < REF_NUM_CHUNKS) {
+        chunks[k].released = 0;
+        if (!TEST_true(ossl_quic_sstream_append_ref(sstream, chunks[k].buf,
+                                                    chunks[k].len,
+                                                    ref_release_cb,
+                                                    &chunks[k])))
+            goto err;
+
+        ossl_quic_sstream_free(sstream);
+        sstream = NULL;
+        if (!TEST_int_eq(chunks[k].released, 1))
+            goto err;
+    }
+
+    testresult = 1;
+ err:
+    ossl_quic_sstream_free(sstream);
+    for (i = 0; i < REF_NUM_CHUNKS; ++i)
+        OPENSSL_free(chunks[i].buf);
+    OPENSSL_free(ref_buf);
+    OPENSSL_free(dst_buf);
+    OPENSSL_free(acked);
+    OPENSSL_free(ranges);
+    return testresult;
+}
+
 static int test_single_copy_read(QUIC_RSTREAM *qrs,
                                  unsigned char *buf, size_t size,
                                  size_t *readbytes, int *fin)
@@ -472,6 +656,119 @@ static int test_rstream_simple(int idx)
     return ret;
 }
 
+static int check_segments(const SSL_READ_SEGMENT *segs, size_t num_segs,
+                          size_t readbytes, const unsigned char *expected)
+{
+    size_t i, off = 0;
+
+    for (i = 0; i < num_segs; ++i) {
+        if (!TEST_size_t_le(segs[i].data_len, readbytes - off)
+            || !TEST_mem_eq(segs[i].data, segs[i].data_len,
+                            expected + off, segs[i].data_len))
+            return 0;
+        off += segs[i].data_len;
+    }
+
+    return TEST_size_t_eq(off, readbytes);
+}
+
+static int test_rstream_segments(int idx)
+{
+    QUIC_RSTREAM *rstream = NULL;
+    unsigned char copy[sizeof(simple_data)];
+    SSL_READ_SEGMENT segs[4];
+    size_t nsegs = 0, readbytes = 0;
+    int fin = 0, ret = 0;
+    int use_rbuf = idx > 0;
+
+    memcpy(copy, simple_data, sizeof(copy));
+
+    if (!TEST_ptr(rstream = ossl_quic_rstream_new(NULL, NULL, 0)))
+        goto err;
+
+    if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 5,
+                                                copy + 5, 10, 0))
+        || !TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 0,
+                                                   copy, 5, 0))
+        || (use_rbuf
+            && !TEST_true(ossl_quic_rstream_resize_rbuf(rstream, 32)))
+        || (use_rbuf && !TEST_true(ossl_quic_rstream_move_to_rbuf(rstream)))
+        || !TEST_true(ossl_quic_rstream_peek_segments(rstream, segs,
+                                                      OSSL_NELEM(segs),
+                                                      &nsegs, &readbytes,
+                                                      &fin))
+        || !TEST_false(fin)
+        || !TEST_size_t_eq(readbytes, 15)
+        || !TEST_true(check_segments(segs, nsegs, readbytes, simple_data))
+        || (!use_rbuf && !TEST_ptr_eq(segs[0].data, copy)))
+        goto err;
+
+    /*
+     * Receiving a frame which encompasses the pinned data must not
+     * invalidate it, nor may the ring buffer be resized.
+     */
+    if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 0,
+                                                simple_data, 20, 0))
+        || (use_rbuf
+            && !TEST_false(ossl_quic_rstream_resize_rbuf(rstream, 64)))
+        || !TEST_true(check_segments(segs, nsegs, readbytes, simple_data))
+        || (!use_rbuf && !TEST_ptr_eq(segs[0].data, copy)))
+        goto err;
+
+    /* Partial release; the remainder is returned again. */
+    if (!TEST_true(ossl_quic_rstream_release_segments(rstream, 7, &fin))
+        || !TEST_false(fin)
+        || !TEST_false(ossl_quic_rstream_release_segments(rstream, 1, &fin))
+        || !TEST_true(ossl_quic_rstream_peek_segments(rstream, segs,
+                                                      OSSL_NELEM(segs),
+                                                      &nsegs, &readbytes,
+                                                      &fin))
+        || !TEST_false(fin)
+        || !TEST_size_t_eq(readbytes, 13)
+        || !TEST_true(check_segments(segs, nsegs, readbytes, simple_data + 7))
+        || !TEST_false(ossl_quic_rstream_release_segments(rstream, 14, &fin))
+        || !TEST_true(ossl_quic_rstream_release_segments(rstream, 13, &fin))
+        || !TEST_false(fin))
+        goto err;
+
+    /* With a ring buffer of 32 bytes, the remaining data wraps around. */
+    if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 20,
+                                                simple_data + 20,
+                                                sizeof(simple_data) - 20, 1))
+        || (use_rbuf && !TEST_true(ossl_quic_rstream_move_to_rbuf(rstream)))
+        || !TEST_true(ossl_quic_rstream_peek_segments(rstream, segs, 1,
+                                                      &nsegs, &readbytes,
+                                                      &fin))
+        || !TEST_size_t_eq(nsegs, 1)
+        || !TEST_true(check_segments(segs, nsegs, readbytes, simple_data + 20))
+        || (use_rbuf && !TEST_size_t_eq(readbytes, 12))
+        || (use_rbuf && !TEST_false(fin))
+        || !TEST_true(ossl_quic_rstream_peek_segments(rstream, segs,
+                                                      OSSL_NELEM(segs),
+                                                      &nsegs, &readbytes,
+                                                      &fin))
+        || !TEST_true(fin)
+        || !TEST_size_t_eq(readbytes, sizeof(simple_data) - 20)
+        || !TEST_true(check_segments(segs, nsegs, readbytes, simple_data + 20))
+        || !TEST_true(ossl_quic_rstream_release_segments(rstream, readbytes,
+                                                         &fin))
+        || !TEST_true(fin)
+        || !TEST_true(ossl_quic_rstream_peek_segments(rstream, segs,
+                                                      OSSL_NELEM(segs),
+                                                      &nsegs, &readbytes,
+                                                      &fin))
+        || !TEST_true(fin)
+        || !TEST_size_t_eq(nsegs, 0)
+        || !TEST_size_t_eq(readbytes, 0))
+        goto err;
+
+    ret = 1;
+
+ err:
+    ossl_quic_rstream_free(rstream);
+    return ret;
+}
+
 static int test_rstream_random(int idx)
 {
     unsigned char *bulk_data = NULL;
@@ -599,7 +896,9 @@ int setup_tests(void)
 {
     ADD_TEST(test_sstream_simple);
     ADD_ALL_TESTS(test_sstream_bulk, 100);
+    ADD_ALL_TESTS(test_sstream_ref, 100);
     ADD_ALL_TESTS(test_rstream_simple, 4);
+    ADD_ALL_TESTS(test_rstream_segments, 2);
     ADD_ALL_TESTS(test_rstream_random, 100);
     return 1;
 }
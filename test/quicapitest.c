@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -1665,6 +1665,384 @@ static int test_bw_limit(void)
     return testresult;
 }
 
+#define TEST_CC_DATA_SIZE   (256 * 1024)
+#define TEST_CC_MAX_LOOPS   10000
+
+/*
+ * Test that the congestion controller can be selected on the SSL_CTX and per
+ * connection, and that data can be exchanged with each of them.
+ */
+static int test_quic_cc(int idx)
+{
+    static const long algs[] = {
+        SSL_QUIC_CC_NEWRENO, SSL_QUIC_CC_CUBIC, SSL_QUIC_CC_BBR2
+    };
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL_CTX *sctx = SSL_CTX_new_ex(libctx, NULL, TLS_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    int testresult = 0;
+    unsigned char *msg = NULL, *recvbuf = NULL;
+    size_t sendlen = TEST_CC_DATA_SIZE;
+    size_t recvlen = TEST_CC_DATA_SIZE;
+    size_t written, readbytes;
+    int loops = 0;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_ptr(sctx)
+            || !TEST_long_eq(SSL_CTX_get_quic_cc(sctx), SSL_QUIC_CC_NEWRENO)
+            || !TEST_false(SSL_CTX_set_quic_cc(sctx, -1))
+            || !TEST_false(SSL_CTX_set_quic_cc(sctx, SSL_QUIC_CC_BBR2 + 1))
+            || !TEST_true(SSL_CTX_set_quic_cc(sctx, algs[idx]))
+            || !TEST_long_eq(SSL_CTX_get_quic_cc(sctx), algs[idx]))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(qtest_create_quic_objects(libctx, cctx, sctx, cert,
+                                             privkey, QTEST_FLAG_FAKE_TIME,
+                                             &qtserv, &clientquic, NULL,
+                                             NULL)))
+        goto err;
+
+    /* The client connection is configured on its own */
+    if (!TEST_long_eq(SSL_get_quic_cc(clientquic), SSL_QUIC_CC_NEWRENO)
+            || !TEST_false(SSL_set_quic_cc(clientquic, SSL_QUIC_CC_BBR2 + 1))
+            || !TEST_true(SSL_set_quic_cc(clientquic, algs[idx]))
+            || !TEST_long_eq(SSL_get_quic_cc(clientquic), algs[idx]))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    /* Connections accepted by the server use the SSL_CTX setting */
+    if (!TEST_int_eq(ossl_quic_channel_get_cc_alg(ossl_quic_tserver_get_channel(qtserv)),
+                     (int)algs[idx]))
+        goto err;
+
+    /* The congestion controller cannot be changed once started */
+    if (!TEST_false(SSL_set_quic_cc(clientquic, SSL_QUIC_CC_NEWRENO))
+            || !TEST_long_eq(SSL_get_quic_cc(clientquic), algs[idx]))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_ptr(msg = OPENSSL_zalloc(TEST_SINGLE_WRITE_SIZE))
+            || !TEST_ptr(recvbuf = OPENSSL_zalloc(TEST_SINGLE_WRITE_SIZE)))
+        goto err;
+
+    while (recvlen > 0) {
+        if (!TEST_int_lt(++loops, TEST_CC_MAX_LOOPS))
+            goto err;
+
+        qtest_add_time(1);
+
+        if (sendlen > 0) {
+            if (SSL_write_ex(clientquic, msg,
+                             sendlen > TEST_SINGLE_WRITE_SIZE
+                             ? TEST_SINGLE_WRITE_SIZE : sendlen,
+                             &written))
+                sendlen -= written;
+            else if (!TEST_int_eq(SSL_get_error(clientquic, 0),
+                                  SSL_ERROR_WANT_WRITE))
+                goto err;
+        } else {
+            SSL_handle_events(clientquic);
+        }
+
+        if (ossl_quic_tserver_read(qtserv, 0, recvbuf,
+                                   recvlen > TEST_SINGLE_WRITE_SIZE
+                                   ? TEST_SINGLE_WRITE_SIZE : recvlen,
+                                   &readbytes))
+            recvlen -= readbytes;
+
+        ossl_quic_tserver_tick(qtserv);
+    }
+
+    testresult = 1;
+ err:
+    OPENSSL_free(msg);
+    OPENSSL_free(recvbuf);
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+
+    return testresult;
+}
+
+#define TEST_DONATE_BUFS        8
+#define TEST_DONATE_BUF_SIZE    (64 * 1024)
+#define TEST_DONATE_COPY_SIZE   100
+
+static void donate_release_cb(const void *buf, size_t num, void *arg)
+{
+    int *released = arg;
+
+    if (num == TEST_DONATE_BUF_SIZE)
+        ++*released;
+}
+
+/*
+ * Test that buffers donated with SSL_write_donate() are sent correctly, also
+ * when interleaved with data written by copying, and that each is given back
+ * exactly once after the peer has acknowledged it.
+ */
+static int test_write_donate(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL_CTX *tlsctx = SSL_CTX_new_ex(libctx, NULL, TLS_client_method());
+    SSL *clientquic = NULL, *tls = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    int testresult = 0, i, loops = 0;
+    int released[TEST_DONATE_BUFS] = { 0 };
+    unsigned char *bufs[TEST_DONATE_BUFS] = { NULL };
+    unsigned char *expected = NULL, *recvbuf = NULL;
+    unsigned char copybuf[TEST_DONATE_COPY_SIZE];
+    size_t total = 0, recvlen = 0, written, readbytes;
+    int all_released;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_ptr(tlsctx)
+            || !TEST_ptr(tls = SSL_new(tlsctx)))
+        goto err;
+
+    /* Only QUIC supports donated buffers */
+    if (!TEST_false(SSL_write_donate(tls, copybuf, sizeof(copybuf), 0,
+                                     donate_release_cb, &released[0],
+                                     &written)))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                             privkey, QTEST_FLAG_FAKE_TIME,
+                                             &qtserv, &clientquic, NULL,
+                                             NULL))
+            || !TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    if (!TEST_ptr(expected = OPENSSL_malloc(TEST_DONATE_BUFS
+                                            * (TEST_DONATE_BUF_SIZE
+                                               + TEST_DONATE_COPY_SIZE)))
+            || !TEST_ptr(recvbuf = OPENSSL_malloc(TEST_DONATE_BUFS
+                                                  * (TEST_DONATE_BUF_SIZE
+                                                     + TEST_DONATE_COPY_SIZE))))
+        goto err;
+
+    /* A release callback is mandatory */
+    if (!TEST_false(SSL_write_donate(clientquic, copybuf, sizeof(copybuf), 0,
+                                     NULL, NULL, &written)))
+        goto err;
+    ERR_clear_error();
+
+    for (i = 0; i < TEST_DONATE_BUFS; ++i) {
+        if (!TEST_ptr(bufs[i] = OPENSSL_malloc(TEST_DONATE_BUF_SIZE)))
+            goto err;
+
+        memset(bufs[i], 'a' + i, TEST_DONATE_BUF_SIZE);
+        memset(copybuf, 'A' + i, sizeof(copybuf));
+
+        /*
+         * The whole buffer is always accepted, regardless of flow control and
+         * of the size of the stream buffer.
+         */
+        if (!TEST_true(SSL_write_donate(clientquic, bufs[i],
+                                        TEST_DONATE_BUF_SIZE,
+                                        i == TEST_DONATE_BUFS - 1
+                                        ? SSL_WRITE_FLAG_CONCLUDE : 0,
+                                        donate_release_cb, &released[i],
+                                        &written))
+                || !TEST_size_t_eq(written, TEST_DONATE_BUF_SIZE))
+            goto err;
+
+        memcpy(expected + total, bufs[i], TEST_DONATE_BUF_SIZE);
+        total += TEST_DONATE_BUF_SIZE;
+
+        if (i == TEST_DONATE_BUFS - 1)
+            break;
+
+        if (!TEST_true(SSL_write_ex(clientquic, copybuf, sizeof(copybuf),
+                                    &written))
+                || !TEST_size_t_eq(written, sizeof(copybuf)))
+            goto err;
+
+        memcpy(expected + total, copybuf, sizeof(copybuf));
+        total += sizeof(copybuf);
+    }
+
+    /* Nothing can have been acknowledged yet */
+    for (i = 0; i < TEST_DONATE_BUFS; ++i)
+        if (!TEST_int_eq(released[i], 0))
+            goto err;
+
+    /* The stream has been concluded */
+    if (!TEST_false(SSL_write_donate(clientquic, bufs[0], TEST_DONATE_BUF_SIZE,
+                                     0, donate_release_cb, &released[0],
+                                     &written)))
+        goto err;
+    ERR_clear_error();
+
+    do {
+        if (!TEST_int_lt(++loops, TEST_CC_MAX_LOOPS))
+            goto err;
+
+        qtest_add_time(1);
+        SSL_handle_events(clientquic);
+
+        if (recvlen < total
+                && ossl_quic_tserver_read(qtserv, 0, recvbuf + recvlen,
+                                          total - recvlen, &readbytes))
+            recvlen += readbytes;
+
+        ossl_quic_tserver_tick(qtserv);
+
+        all_released = 1;
+        for (i = 0; i < TEST_DONATE_BUFS; ++i)
+            if (released[i] == 0)
+                all_released = 0;
+    } while (recvlen < total || !all_released);
+
+    if (!TEST_mem_eq(recvbuf, recvlen, expected, total))
+        goto err;
+
+    for (i = 0; i < TEST_DONATE_BUFS; ++i)
+        if (!TEST_int_eq(released[i], 1))
+            goto err;
+
+    testresult = 1;
+ err:
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_free(tls);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(tlsctx);
+    /* Only free the buffers once they can no longer be referenced */
+    for (i = 0; i < TEST_DONATE_BUFS; ++i)
+        OPENSSL_free(bufs[i]);
+    OPENSSL_free(expected);
+    OPENSSL_free(recvbuf);
+
+    return testresult;
+}
+
+#define TEST_SEGS_TOTAL     (768 * 1024)
+
+/*
+ * Test that the client can read a stream without copying, and that releasing
+ * the data gives the peer more credit.
+ */
+static int test_read_segments(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL_CTX *tlsctx = SSL_CTX_new_ex(libctx, NULL, TLS_client_method());
+    SSL *clientquic = NULL, *tls = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    SSL_READ_SEGMENT segs[8];
+    unsigned char *data = NULL;
+    size_t i, nsegs, readbytes, off, sent = 0, recvd = 0, written;
+    uint64_t sid = UINT64_MAX;
+    int testresult = 0, loops = 0, concluded = 0, eos = 0;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_ptr(tlsctx)
+            || !TEST_ptr(tls = SSL_new(tlsctx))
+            || !TEST_ptr(data = OPENSSL_malloc(TEST_SEGS_TOTAL)))
+        goto err;
+
+    for (i = 0; i < TEST_SEGS_TOTAL; ++i)
+        data[i] = (unsigned char)(i * 7);
+
+    /* Only QUIC supports reading segments */
+    if (!TEST_false(SSL_read_peek_segments(tls, segs, OSSL_NELEM(segs),
+                                           &nsegs, &readbytes))
+            || !TEST_false(SSL_read_release_segments(tls, 0)))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                             privkey, QTEST_FLAG_FAKE_TIME,
+                                             &qtserv, &clientquic, NULL,
+                                             NULL))
+            || !TEST_true(qtest_create_quic_connection(qtserv, clientquic))
+            || !TEST_true(ossl_quic_tserver_stream_new(qtserv, 0, &sid)))
+        goto err;
+
+    /*
+     * Send more than the initial stream flow control window, so that the
+     * transfer can only complete if released data is credited to the peer.
+     */
+    while (!eos) {
+        if (!TEST_int_lt(++loops, TEST_CC_MAX_LOOPS))
+            goto err;
+
+        if (sent < TEST_SEGS_TOTAL) {
+            if (!TEST_true(ossl_quic_tserver_write(qtserv, sid, data + sent,
+                                                   TEST_SEGS_TOTAL - sent,
+                                                   &written)))
+                goto err;
+            sent += written;
+        } else if (!concluded) {
+            if (!TEST_true(ossl_quic_tserver_conclude(qtserv, sid)))
+                goto err;
+            concluded = 1;
+        }
+
+        ossl_quic_tserver_tick(qtserv);
+        qtest_add_time(1);
+
+        if (!SSL_read_peek_segments(clientquic, segs, OSSL_NELEM(segs), &nsegs,
+                                    &readbytes)) {
+            switch (SSL_get_error(clientquic, 0)) {
+            case SSL_ERROR_WANT_READ:
+                break;
+            case SSL_ERROR_ZERO_RETURN:
+                eos = 1;
+                break;
+            default:
+                TEST_error("unexpected error from SSL_read_peek_segments");
+                goto err;
+            }
+            continue;
+        }
+
+        if (!TEST_size_t_gt(readbytes, 0)
+                || !TEST_size_t_le(readbytes, sent - recvd))
+            goto err;
+
+        for (i = 0, off = recvd; i < nsegs; off += segs[i++].data_len)
+            if (!TEST_mem_eq(segs[i].data, segs[i].data_len,
+                             data + off, segs[i].data_len))
+                goto err;
+
+        if (!TEST_size_t_eq(off - recvd, readbytes)
+                || !TEST_false(SSL_read_release_segments(clientquic,
+                                                         readbytes + 1)))
+            goto err;
+        ERR_clear_error();
+
+        /* Only consume half of the data, the rest must be returned again */
+        if (readbytes > 1)
+            readbytes /= 2;
+
+        if (!TEST_true(SSL_read_release_segments(clientquic, readbytes)))
+            goto err;
+        recvd += readbytes;
+    }
+
+    if (!TEST_size_t_eq(recvd, TEST_SEGS_TOTAL))
+        goto err;
+
+    testresult = 1;
+ err:
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_free(tls);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(tlsctx);
+    OPENSSL_free(data);
+
+    return testresult;
+}
+
 enum {
     TPARAM_OP_DUP,
     TPARAM_OP_DROP,
@@ -2265,6 +2643,9 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_alpn, 2);
     ADD_ALL_TESTS(test_noisy_dgram, 2);
     ADD_TEST(test_bw_limit);
+    ADD_ALL_TESTS(test_quic_cc, 3);
+    ADD_TEST(test_write_donate);
+    ADD_TEST(test_read_segments);
     ADD_TEST(test_get_shutdown);
     ADD_ALL_TESTS(test_tparam, OSSL_NELEM(tparam_tests));
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2024 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2021-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the >License>).  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -12,6 +12,7 @@
 #include <openssl/bio.h>
 #include <openssl/core_names.h>
 #include <openssl/params.h>
+#include <openssl/sha.h>
 #include "crypto/rand.h"
 #include "testutil.h"
 
@@ -162,6 +163,105 @@ static int fips_health_tests(void)
     return 1;
 }
 
+/*
+ * Hash_DRBG with SHA2-256 computes requests of four digests or more with the
+ * multi-buffer SHA-256 code where available.  The output of the first
+ * request after instantiation is checked against Hash_df() and Hashgen() of
+ * SP 800-90Ar1 computed here one digest at a time.
+ */
+#define HASH_DRBG_SEEDLEN   (440 / 8)
+
+static int hash_df_sha256(const unsigned char *in, size_t inlen,
+                          unsigned char out[HASH_DRBG_SEEDLEN])
+{
+    unsigned char buf[1 + 4 + 64], md[2 * SHA256_DIGEST_LENGTH];
+    unsigned char counter;
+
+    if (!TEST_size_t_le(inlen, sizeof(buf) - 5))
+        return 0;
+    for (counter = 1; counter <= 2; counter++) {
+        /* counter || no_of_bits_to_return || input_string */
+        buf[0] = counter;
+        buf[1] = buf[2] = 0;
+        buf[3] = (HASH_DRBG_SEEDLEN * 8) >> 8;
+        buf[4] = (HASH_DRBG_SEEDLEN * 8) & 0xff;
+        memcpy(buf + 5, in, inlen);
+        if (!TEST_true(EVP_Digest(buf, 5 + inlen,
+                                  md + (counter - 1) * SHA256_DIGEST_LENGTH,
+                                  NULL, EVP_sha256(), NULL)))
+            return 0;
+    }
+    memcpy(out, md, HASH_DRBG_SEEDLEN);
+    return 1;
+}
+
+static int test_hash_drbg_multi_buffer(int idx)
+{
+    static const size_t lens[] = { 4 * 32, 7 * 32 + 5, 8 * 32, 19 * 32 + 31 };
+    unsigned char entropy[32], nonce[16], pers[] = "multi-buffer";
+    unsigned char seed[sizeof(entropy) + sizeof(nonce) + sizeof(pers) - 1];
+    unsigned char v[HASH_DRBG_SEEDLEN], md[SHA256_DIGEST_LENGTH];
+    unsigned char out[19 * 32 + 31], expected[19 * 32 + 31];
+    EVP_RAND *parent_alg = NULL, *drbg_alg = NULL;
+    EVP_RAND_CTX *parent = NULL, *drbg = NULL;
+    unsigned int strength = 256;
+    OSSL_PARAM params[4];
+    size_t i, n, len = lens[idx];
+    int j, res = 0;
+
+    for (i = 0; i < sizeof(entropy); i++)
+        entropy[i] = (unsigned char)(i * 7 + idx);
+    for (i = 0; i < sizeof(nonce); i++)
+        nonce[i] = (unsigned char)(0xa0 + i);
+
+    params[0] = OSSL_PARAM_construct_octet_string(OSSL_RAND_PARAM_TEST_ENTROPY,
+                                                  entropy, sizeof(entropy));
+    params[1] = OSSL_PARAM_construct_octet_string(OSSL_RAND_PARAM_TEST_NONCE,
+                                                  nonce, sizeof(nonce));
+    params[2] = OSSL_PARAM_construct_uint(OSSL_RAND_PARAM_STRENGTH, &strength);
+    params[3] = OSSL_PARAM_construct_end();
+    if (!TEST_ptr(parent_alg = EVP_RAND_fetch(NULL, "TEST-RAND", "-fips"))
+            || !TEST_ptr(drbg_alg = EVP_RAND_fetch(NULL, "HASH-DRBG", NULL))
+            || !TEST_ptr(parent = EVP_RAND_CTX_new(parent_alg, NULL))
+            || !TEST_true(EVP_RAND_CTX_set_params(parent, params))
+            || !TEST_ptr(drbg = EVP_RAND_CTX_new(drbg_alg, parent)))
+        goto err;
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_DRBG_PARAM_DIGEST,
+                                                 "SHA2-256", 0);
+    params[1] = OSSL_PARAM_construct_end();
+    if (!TEST_true(EVP_RAND_CTX_set_params(drbg, params))
+            || !TEST_true(EVP_RAND_instantiate(drbg, 0, 0, pers,
+                                               sizeof(pers) - 1, NULL))
+            || !TEST_true(EVP_RAND_generate(drbg, out, len, 0, 0, NULL, 0)))
+        goto err;
+
+    /* V = Hash_df(entropy || nonce || personalization string) */
+    memcpy(seed, entropy, sizeof(entropy));
+    memcpy(seed + sizeof(entropy), nonce, sizeof(nonce));
+    memcpy(seed + sizeof(entropy) + sizeof(nonce), pers, sizeof(pers) - 1);
+    if (!hash_df_sha256(seed, sizeof(seed), v))
+        goto err;
+
+    /* Hashgen(V): Hash(V) || Hash(V + 1) || ... */
+    for (i = 0; i < len; i += n) {
+        if (!TEST_true(EVP_Digest(v, sizeof(v), md, NULL, EVP_sha256(), NULL)))
+            goto err;
+        n = len - i < sizeof(md) ? len - i : sizeof(md);
+        memcpy(expected + i, md, n);
+        for (j = sizeof(v) - 1; j >= 0 && ++v[j] == 0; j--)
+            continue;
+    }
+    if (!TEST_mem_eq(out, len, expected, len))
+        goto err;
+    res = 1;
+ err:
+    EVP_RAND_CTX_free(drbg);
+    EVP_RAND_CTX_free(parent);
+    EVP_RAND_free(drbg_alg);
+    EVP_RAND_free(parent_alg);
+    return res;
+}
+
 int setup_tests(void)
 {
     char *configfile;
@@ -175,6 +275,7 @@ int setup_tests(void)
 
     ADD_TEST(test_rand);
     ADD_TEST(test_rand_uniform);
+    ADD_ALL_TESTS(test_hash_drbg_multi_buffer, 4);
 
     if (OSSL_PROVIDER_available(NULL, "fips")
             && fips_provider_version_ge(NULL, 3, 5, 0))
@@ -12,5 +12,9 @@ setup("test_load_cert_file");
 
 plan tests => 1;
 
+my $hashdir = "hashed";
+
+mkdir $hashdir;
+
 ok(run(test(["x509_load_cert_file_test", srctop_file("test", "certs", "leaf-chain.pem"),
-             srctop_file("test", "certs", "cyrillic_crl.pem")])));
+             srctop_file("test", "certs", "cyrillic_crl.pem"), $hashdir])));
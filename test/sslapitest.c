@@ -1017,6 +1017,9 @@ static int execute_test_large_message(const SSL_METHOD *smeth,
 
 #if !defined(OPENSSL_NO_SOCK) && !defined(OPENSSL_NO_KTLS) && \
     !(defined(OSSL_NO_USABLE_TLS1_3) && defined(OPENSSL_NO_TLS1_2))
+# include <errno.h>
+# include <fcntl.h>
+
 /* sock must be connected */
 static int ktls_chk_platform(int sock)
 {
@@ -1442,6 +1445,165 @@ end:
     return testresult;
 }
 
+#define SPLICE_SZ                       (16 * 4096)
+
+static int execute_test_ktls_splice(int tls_version, const char *cipher)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    unsigned char *buf, *buf_dst;
+    int cfd = -1, sfd = -1, pipefd[2] = { -1, -1 };
+    ossl_ssize_t ret;
+    ssize_t n;
+    size_t off = 0, chunk_size, got, written, filled = 0;
+    int err, testresult = 0;
+
+    buf = OPENSSL_zalloc(SPLICE_SZ);
+    buf_dst = OPENSSL_zalloc(SPLICE_SZ);
+    if (!TEST_ptr(buf) || !TEST_ptr(buf_dst)
+        || !TEST_true(create_test_sockets(&cfd, &sfd, SOCK_STREAM, NULL)))
+        goto end;
+
+    /* Skip this test if the platform does not support ktls */
+    if (!ktls_chk_platform(cfd)) {
+        testresult = TEST_skip("Kernel does not support KTLS");
+        goto end;
+    }
+
+    if (is_fips && strstr(cipher, "CHACHA") != NULL) {
+        testresult = TEST_skip("CHACHA is not supported in FIPS");
+        goto end;
+    }
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       tls_version, tls_version,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if (tls_version == TLS1_3_VERSION) {
+        if (!TEST_true(SSL_CTX_set_ciphersuites(cctx, cipher))
+            || !TEST_true(SSL_CTX_set_ciphersuites(sctx, cipher)))
+            goto end;
+    } else {
+        if (!TEST_true(SSL_CTX_set_cipher_list(cctx, cipher))
+            || !TEST_true(SSL_CTX_set_cipher_list(sctx, cipher)))
+            goto end;
+    }
+
+    if (!TEST_true(create_ssl_objects2(sctx, cctx, &serverssl,
+                                       &clientssl, sfd, cfd))
+        || !TEST_true(SSL_set_options(clientssl, SSL_OP_ENABLE_KTLS))
+        || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                            SSL_ERROR_NONE)))
+        goto end;
+
+    if (!BIO_get_ktls_recv(SSL_get_rbio(clientssl))) {
+        testresult = TEST_skip("Failed to enable KTLS RX for %s cipher %s",
+                               tls_version == TLS1_3_VERSION ? "TLS 1.3" :
+                               "TLS 1.2", cipher);
+        goto end;
+    }
+
+    if (!TEST_int_gt(RAND_bytes_ex(libctx, buf, SPLICE_SZ, 0), 0)
+        || !TEST_int_eq(pipe(pipefd), 0))
+        goto end;
+
+    while (off < SPLICE_SZ) {
+        chunk_size = min(SENDFILE_CHUNK, SPLICE_SZ - off);
+        if (!TEST_true(SSL_write_ex(serverssl, buf + off, chunk_size,
+                                    &written)))
+            goto end;
+
+        for (got = 0; got < chunk_size; got += (size_t)n) {
+            ret = SSL_splice(clientssl, pipefd[1], chunk_size - got, 0);
+            if (ret <= 0) {
+                if (!TEST_int_eq(SSL_get_error(clientssl, (int)ret),
+                                 SSL_ERROR_WANT_READ))
+                    goto end;
+                n = 0;
+                continue;
+            }
+            if (!TEST_size_t_le((size_t)ret, chunk_size - got))
+                goto end;
+            /* The pipe is large enough to hold a whole chunk */
+            n = read(pipefd[0], buf_dst + off + got, (size_t)ret);
+            if (!TEST_true(n == ret))
+                goto end;
+        }
+
+        /* verify the payload */
+        if (!TEST_mem_eq(buf_dst + off, chunk_size, buf + off, chunk_size))
+            goto end;
+
+        off += chunk_size;
+    }
+
+    /*
+     * With the pipe full, splice(2) fails with EAGAIN just as it does when no
+     * data has arrived yet. SSL_splice() must not report SSL_ERROR_WANT_READ
+     * then, as waiting for the socket would not help.
+     */
+    if (!TEST_int_eq(fcntl(pipefd[1], F_SETFL, O_NONBLOCK), 0))
+        goto end;
+    while ((n = write(pipefd[1], buf_dst, SPLICE_SZ)) > 0)
+        filled += (size_t)n;
+    if (!TEST_int_eq(errno, EAGAIN)
+        || !TEST_true(SSL_write_ex(serverssl, buf, 1, &written)))
+        goto end;
+    ret = SSL_splice(clientssl, pipefd[1], 1, 0);
+    err = errno;
+    if (!TEST_int_eq((int)ret, -1)
+        || !TEST_int_eq(SSL_get_error(clientssl, (int)ret), SSL_ERROR_SYSCALL)
+        || !TEST_int_eq(err, EAGAIN))
+        goto end;
+
+    /* Once the pipe has been drained the data goes through */
+    for (; filled > 0; filled -= (size_t)n)
+        if (!TEST_int_gt(n = read(pipefd[0], buf_dst,
+                                  min(filled, SPLICE_SZ)), 0))
+            goto end;
+    while ((ret = SSL_splice(clientssl, pipefd[1], 1, 0)) < 0) {
+        if (!TEST_int_eq(SSL_get_error(clientssl, (int)ret),
+                         SSL_ERROR_WANT_READ))
+            goto end;
+    }
+    if (!TEST_int_eq((int)ret, 1)
+        || !TEST_int_eq(read(pipefd[0], buf_dst, 1), 1)
+        || !TEST_uchar_eq(buf_dst[0], buf[0]))
+        goto end;
+
+    /* A close_notify alert is reported as the end of the data */
+    if (!TEST_int_ge(SSL_shutdown(serverssl), 0))
+        goto end;
+    while ((ret = SSL_splice(clientssl, pipefd[1], 1, 0)) < 0) {
+        if (!TEST_int_eq(SSL_get_error(clientssl, (int)ret),
+                         SSL_ERROR_WANT_READ))
+            goto end;
+    }
+    if (!TEST_int_eq((int)ret, 0)
+        || !TEST_int_eq(SSL_get_error(clientssl, 0), SSL_ERROR_ZERO_RETURN))
+        goto end;
+
+    testresult = 1;
+end:
+    SSL_free(clientssl);
+    SSL_free(serverssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    if (pipefd[0] != -1)
+        close(pipefd[0]);
+    if (pipefd[1] != -1)
+        close(pipefd[1]);
+    if (cfd != -1)
+        close(cfd);
+    if (sfd != -1)
+        close(sfd);
+    OPENSSL_free(buf);
+    OPENSSL_free(buf_dst);
+    return testresult;
+}
+
 static struct ktls_test_cipher {
     int tls_version;
     const char *cipher;
@@ -1506,6 +1668,16 @@ static int test_ktls_sendfile(int test)
     return execute_test_ktls_sendfile(cipher->tls_version, cipher->cipher,
                                       test & 1);
 }
+
+static int test_ktls_splice(int test)
+{
+    struct ktls_test_cipher *cipher;
+
+    OPENSSL_assert(test < (int)NUM_KTLS_TEST_CIPHERS);
+    cipher = &ktls_test_ciphers[test];
+
+    return execute_test_ktls_splice(cipher->tls_version, cipher->cipher);
+}
 #endif
 
 static int test_large_message_tls(void)
@@ -9320,10 +9492,9 @@ end:
 static int test_session_timeout(int test)
 {
     /*
-     * Test session ordering and timeout
-     * Can't explicitly test performance of the new code,
-     * but can test to see if the ordering of the sessions
-     * are correct, and they are removed as expected
+     * Test session timeout
+     * Can't explicitly test performance of the timing wheel,
+     * but can test to see if the sessions are removed as expected
      */
     SSL_SESSION *early = NULL;
     SSL_SESSION *middle = NULL;
@@ -9353,9 +9524,9 @@ static int test_session_timeout(int test)
         goto end;
 
     /* Make sure they are all added */
-    if (!TEST_ptr(early->prev)
-        || !TEST_ptr(middle->prev)
-        || !TEST_ptr(late->prev))
+    if (!TEST_ptr(early->pprev)
+        || !TEST_ptr(middle->pprev)
+        || !TEST_ptr(late->pprev))
         goto end;
 
     if (!TEST_time_t_ne(SSL_SESSION_set_time_ex(early, now - 10), 0)
@@ -9369,37 +9540,30 @@ static int test_session_timeout(int test)
         goto end;
 
     /* Make sure they are all still there */
-    if (!TEST_ptr(early->prev)
-        || !TEST_ptr(middle->prev)
-        || !TEST_ptr(late->prev))
-        goto end;
-
-    /* Make sure they are in the expected order */
-    if (!TEST_ptr_eq(late->next, middle)
-        || !TEST_ptr_eq(middle->next, early)
-        || !TEST_ptr_eq(early->prev, middle)
-        || !TEST_ptr_eq(middle->prev, late))
+    if (!TEST_ptr(early->pprev)
+        || !TEST_ptr(middle->pprev)
+        || !TEST_ptr(late->pprev))
         goto end;
 
     /* This should remove "early" */
     SSL_CTX_flush_sessions_ex(ctx, now + TIMEOUT - 1);
-    if (!TEST_ptr_null(early->prev)
-        || !TEST_ptr(middle->prev)
-        || !TEST_ptr(late->prev))
+    if (!TEST_ptr_null(early->pprev)
+        || !TEST_ptr(middle->pprev)
+        || !TEST_ptr(late->pprev))
         goto end;
 
     /* This should remove "middle" */
     SSL_CTX_flush_sessions_ex(ctx, now + TIMEOUT + 1);
-    if (!TEST_ptr_null(early->prev)
-        || !TEST_ptr_null(middle->prev)
-        || !TEST_ptr(late->prev))
+    if (!TEST_ptr_null(early->pprev)
+        || !TEST_ptr_null(middle->pprev)
+        || !TEST_ptr(late->pprev))
         goto end;
 
     /* This should remove "late" */
     SSL_CTX_flush_sessions_ex(ctx, now + TIMEOUT + 11);
-    if (!TEST_ptr_null(early->prev)
-        || !TEST_ptr_null(middle->prev)
-        || !TEST_ptr_null(late->prev))
+    if (!TEST_ptr_null(early->pprev)
+        || !TEST_ptr_null(middle->pprev)
+        || !TEST_ptr_null(late->pprev))
         goto end;
 
     /* Add them back in again */
@@ -9409,16 +9573,16 @@ static int test_session_timeout(int test)
         goto end;
 
     /* Make sure they are all added */
-    if (!TEST_ptr(early->prev)
-        || !TEST_ptr(middle->prev)
-        || !TEST_ptr(late->prev))
+    if (!TEST_ptr(early->pprev)
+        || !TEST_ptr(middle->pprev)
+        || !TEST_ptr(late->pprev))
         goto end;
 
     /* This should remove all of them */
     SSL_CTX_flush_sessions_ex(ctx, 0);
-    if (!TEST_ptr_null(early->prev)
-        || !TEST_ptr_null(middle->prev)
-        || !TEST_ptr_null(late->prev))
+    if (!TEST_ptr_null(early->pprev)
+        || !TEST_ptr_null(middle->pprev)
+        || !TEST_ptr_null(late->pprev))
         goto end;
 
     (void)SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_UPDATE_TIME
@@ -9440,6 +9604,175 @@ static int test_session_timeout(int test)
     return testresult;
 }
 
+/*
+ * Test that sessions with timeouts spread over all levels of the timing wheel
+ * are expired when they are due, and only then
+ */
+static int test_session_timing_wheel(int idx)
+{
+    SSL_CTX *ctx = NULL;
+    SSL_SESSION *sess[200] = { NULL };
+    unsigned char id[SSL3_SSL_SESSION_ID_LENGTH];
+    static const long checkpoints[] = { 5, 60, 64, 65, 1000, 4096, 20000 };
+    long expect;
+    time_t now = time(NULL);
+    size_t i, j;
+    int testresult = 0;
+
+    if (!TEST_ptr(ctx = SSL_CTX_new_ex(libctx, NULL, TLS_method()))
+        || !TEST_true(SSL_CTX_sess_set_cache_shards(ctx, idx == 0 ? 1 : 7)))
+        goto end;
+
+    for (i = 0; i < OSSL_NELEM(sess); i++) {
+        memset(id, (int)i, sizeof(id));
+        if (!TEST_ptr(sess[i] = SSL_SESSION_new())
+            || !TEST_true(SSL_SESSION_set1_id(sess[i], id, sizeof(id)))
+            || !TEST_time_t_ne(SSL_SESSION_set_time_ex(sess[i], now), 0)
+            /* The last one is beyond the range of the wheel */
+            || !TEST_long_ne(SSL_SESSION_set_timeout(sess[i],
+                                                     i == OSSL_NELEM(sess) - 1
+                                                     ? 300L * 86400
+                                                     : 10 + (long)i * 97), 0)
+            || !TEST_int_eq(SSL_CTX_add_session(ctx, sess[i]), 1))
+            goto end;
+    }
+
+    for (j = 0; j < OSSL_NELEM(checkpoints); j++) {
+        SSL_CTX_flush_sessions_ex(ctx, now + checkpoints[j]);
+        /* Sessions stay until the flush time is past their timeout */
+        for (i = 0, expect = 0; i < OSSL_NELEM(sess); i++) {
+            if (SSL_SESSION_get_timeout(sess[i]) >= checkpoints[j]) {
+                expect++;
+                if (!TEST_ptr(sess[i]->pprev))
+                    goto end;
+            } else if (!TEST_ptr_null(sess[i]->pprev)) {
+                goto end;
+            }
+        }
+        if (!TEST_long_eq(SSL_CTX_sess_number(ctx), expect)
+            || !TEST_long_eq(SSL_CTX_sess_expired(ctx),
+                             (long)OSSL_NELEM(sess) - expect))
+            goto end;
+    }
+    if (!TEST_long_gt(SSL_CTX_sess_expire_ticks(ctx), 0)
+        || !TEST_long_gt(SSL_CTX_sess_expire_tick_max(ctx), 0))
+        goto end;
+
+    /* The session parked beyond the range of the wheel */
+    SSL_CTX_flush_sessions_ex(ctx, now + 300L * 86400 + 1);
+    if (!TEST_long_eq(SSL_CTX_sess_number(ctx), 0))
+        goto end;
+
+    /* Empty stretches of the wheel are skipped, not walked a tick at a time */
+    if (!TEST_long_le(SSL_CTX_sess_expire_ticks(ctx),
+                      (long)(OSSL_NELEM(sess) * SSL_SESS_WHEEL_LEVELS
+                             * SSL_SESS_WHEEL_SLOTS)))
+        goto end;
+
+    /*
+     * The flush above left the wheel far ahead of the present. A session that
+     * is already due when it is added must still go with the next flush for
+     * the current time, while one that is not due yet stays.
+     */
+    if (!TEST_time_t_ne(SSL_SESSION_set_time_ex(sess[0], now - 100), 0)
+        || !TEST_long_ne(SSL_SESSION_set_timeout(sess[0], 10), 0)
+        || !TEST_time_t_ne(SSL_SESSION_set_time_ex(sess[1], now), 0)
+        || !TEST_long_ne(SSL_SESSION_set_timeout(sess[1], 1000), 0)
+        || !TEST_int_eq(SSL_CTX_add_session(ctx, sess[0]), 1)
+        || !TEST_int_eq(SSL_CTX_add_session(ctx, sess[1]), 1))
+        goto end;
+    SSL_CTX_flush_sessions_ex(ctx, time(NULL));
+    if (!TEST_ptr_null(sess[0]->pprev)
+        || !TEST_ptr(sess[1]->pprev)
+        || !TEST_long_eq(SSL_CTX_sess_number(ctx), 1))
+        goto end;
+
+    testresult = 1;
+ end:
+    SSL_CTX_free(ctx);
+    for (i = 0; i < OSSL_NELEM(sess); i++)
+        SSL_SESSION_free(sess[i]);
+    return testresult;
+}
+
+/*
+ * Test that a session cache split into shards behaves like a single one
+ */
+static int test_session_cache_shards(void)
+{
+    SSL_CTX *ctx = NULL;
+    SSL *ssl = NULL;
+    SSL_SESSION *sess[64] = { NULL };
+    unsigned char id[SSL3_SSL_SESSION_ID_LENGTH];
+    size_t i;
+    int testresult = 0;
+
+    if (!TEST_ptr(ctx = SSL_CTX_new_ex(libctx, NULL, TLS_server_method()))
+        || !TEST_long_eq(SSL_CTX_sess_get_cache_shards(ctx), 1)
+        || !TEST_false(SSL_CTX_sess_set_cache_shards(ctx, 0))
+        || !TEST_false(SSL_CTX_sess_set_cache_shards(ctx, 1025))
+        || !TEST_true(SSL_CTX_sess_set_cache_shards(ctx, 8))
+        || !TEST_long_eq(SSL_CTX_sess_get_cache_shards(ctx), 8)
+        || !TEST_ptr(ssl = SSL_new(ctx)))
+        goto end;
+
+    for (i = 0; i < OSSL_NELEM(sess); i++) {
+        memset(id, (int)i, sizeof(id));
+        id[0] = 0xAA;
+        if (!TEST_ptr(sess[i] = SSL_SESSION_new())
+            || !TEST_true(SSL_SESSION_set_protocol_version(sess[i],
+                                                           SSL_version(ssl)))
+            || !TEST_true(SSL_SESSION_set1_id(sess[i], id, sizeof(id)))
+            || !TEST_int_eq(SSL_CTX_add_session(ctx, sess[i]), 1))
+            goto end;
+    }
+
+    /* Adding a session again must not duplicate it */
+    if (!TEST_int_eq(SSL_CTX_add_session(ctx, sess[0]), 0)
+        || !TEST_long_eq(SSL_CTX_sess_number(ctx), OSSL_NELEM(sess)))
+        goto end;
+
+    for (i = 0; i < OSSL_NELEM(sess); i++) {
+        memset(id, (int)i, sizeof(id));
+        id[0] = 0xAA;
+        if (!TEST_true(SSL_has_matching_session_id(ssl, id, sizeof(id))))
+            goto end;
+    }
+
+    /* The shard count cannot change while there are sessions in the cache */
+    if (!TEST_false(SSL_CTX_sess_set_cache_shards(ctx, 4))
+        || !TEST_true(SSL_CTX_remove_session(ctx, sess[1]))
+        || !TEST_false(SSL_has_matching_session_id(ssl,
+                                                   sess[1]->session_id,
+                                                   sizeof(id)))
+        || !TEST_long_eq(SSL_CTX_sess_number(ctx), OSSL_NELEM(sess) - 1))
+        goto end;
+
+    SSL_CTX_flush_sessions_ex(ctx, 0);
+    if (!TEST_long_eq(SSL_CTX_sess_number(ctx), 0)
+        || !TEST_ptr_null(sess[0]->pprev)
+        || !TEST_true(SSL_CTX_sess_set_cache_shards(ctx, 4)))
+        goto end;
+
+    /* The size limit applies per shard, 8 / 4 = 2 sessions each */
+    SSL_CTX_sess_set_cache_size(ctx, 8);
+    for (i = 0; i < OSSL_NELEM(sess); i++) {
+        sess[i]->not_resumable = 0;
+        if (!TEST_int_eq(SSL_CTX_add_session(ctx, sess[i]), 1))
+            goto end;
+    }
+    if (!TEST_long_le(SSL_CTX_sess_number(ctx), 8))
+        goto end;
+
+    testresult = 1;
+ end:
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+    for (i = 0; i < OSSL_NELEM(sess); i++)
+        SSL_SESSION_free(sess[i]);
+    return testresult;
+}
+
 /*
  * Test that a session cache overflow works as expected
  * Test 0: TLSv1.3, timeout on new session later than old session
@@ -10975,6 +11308,194 @@ static int test_inherit_verify_param(void)
     return testresult;
 }
 
+/*
+ * Test SSL_writev() and SSL_readv(). Test 0 uses TLSv1.2, test 1 TLSv1.3 and
+ * test 2 DTLSv1.2.
+ */
+static int test_ssl_writev(int idx)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *serverssl = NULL, *clientssl = NULL;
+    static unsigned char hdr[40], body[5000], trailer[10];
+    unsigned char in[sizeof(hdr) + sizeof(body) + sizeof(trailer)];
+    unsigned char exp[sizeof(in)], out[3][2000];
+    SSL_IOVEC wiov[4], riov[3];
+    size_t written, readbytes, total = 0, i;
+    const SSL_METHOD *smeth = TLS_server_method(), *cmeth = TLS_client_method();
+    int version = idx == 0 ? TLS1_2_VERSION : TLS1_3_VERSION;
+    int testresult = 0;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return TEST_skip("No TLSv1.2 support");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (idx == 1)
+        return TEST_skip("No TLSv1.3 support");
+#endif
+    if (idx == 2) {
+#if defined(OPENSSL_NO_DTLS) || defined(OPENSSL_NO_DTLS1_2)
+        return TEST_skip("No DTLSv1.2 support");
+#else
+        smeth = DTLS_server_method();
+        cmeth = DTLS_client_method();
+        version = DTLS1_2_VERSION;
+#endif
+    }
+
+    memset(hdr, 'h', sizeof(hdr));
+    for (i = 0; i < sizeof(body); i++)
+        body[i] = (unsigned char)i;
+    memset(trailer, 't', sizeof(trailer));
+    memcpy(exp, hdr, sizeof(hdr));
+    memcpy(exp + sizeof(hdr), body, sizeof(body));
+    memcpy(exp + sizeof(hdr) + sizeof(body), trailer, sizeof(trailer));
+
+    /* An empty segment in the middle should simply be skipped */
+    wiov[0].base = hdr;
+    wiov[0].len = sizeof(hdr);
+    wiov[1].base = NULL;
+    wiov[1].len = 0;
+    wiov[2].base = body;
+    wiov[2].len = sizeof(body);
+    wiov[3].base = trailer;
+    wiov[3].len = sizeof(trailer);
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, smeth, cmeth, version, version,
+                                       &sctx, &cctx, cert, privkey))
+        || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                         NULL, NULL))
+        || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                            SSL_ERROR_NONE)))
+        goto end;
+
+    /*
+     * Use small records so that the header shares a record with the start of
+     * the body, most of the body is written in records of its own, and its
+     * tail shares a record with the trailer.
+     */
+    if (!TEST_true(SSL_set_max_send_fragment(clientssl, 512))
+        || !TEST_true(SSL_writev(clientssl, wiov, OSSL_NELEM(wiov), &written))
+        || !TEST_size_t_eq(written, sizeof(exp)))
+        goto end;
+
+    /* Records are read one at a time, so the first one must be full */
+    if (!TEST_true(SSL_read_ex(serverssl, in, sizeof(in), &readbytes))
+        || !TEST_size_t_eq(readbytes, 512))
+        goto end;
+    total = readbytes;
+
+    while (total < sizeof(exp)) {
+        for (i = 0; i < OSSL_NELEM(riov); i++) {
+            riov[i].base = out[i];
+            riov[i].len = sizeof(out[i]);
+        }
+        if (!TEST_true(SSL_readv(serverssl, riov, OSSL_NELEM(riov),
+                                 &readbytes))
+            || !TEST_size_t_le(total + readbytes, sizeof(exp)))
+            goto end;
+        for (i = 0; i < OSSL_NELEM(riov) && readbytes > 0; i++) {
+            size_t n = readbytes < riov[i].len ? readbytes : riov[i].len;
+
+            memcpy(in + total, out[i], n);
+            total += n;
+            readbytes -= n;
+        }
+    }
+    if (!TEST_mem_eq(in, total, exp, sizeof(exp)))
+        goto end;
+
+    /* Writing nothing at all behaves like a zero length SSL_write_ex() */
+    if (!TEST_int_eq(SSL_writev(clientssl, wiov + 1, 1, &written),
+                     SSL_write_ex(clientssl, "", 0, &readbytes))
+        || !TEST_size_t_eq(written, 0))
+        goto end;
+
+    testresult = 1;
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test that connections using SSL_MODE_RELEASE_BUFFERS share their record
+ * layer buffers through the SSL_CTX buffer pool
+ */
+static int test_record_buffer_pool(void)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *serverssl[2] = { NULL, NULL }, *clientssl[2] = { NULL, NULL };
+    const char msg[] = "Hello";
+    char buf[sizeof(msg)];
+    size_t written, readbytes;
+    int i, testresult = 0;
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), TLS1_VERSION, 0,
+                                       &sctx, &cctx, cert, privkey))
+        || !TEST_long_eq(SSL_CTX_get_record_buffer_pool_size(sctx), 0)
+        || !TEST_false(SSL_CTX_set_record_buffer_pool_size(sctx, -1))
+        || !TEST_true(SSL_CTX_set_record_buffer_pool_size(sctx, 1024 * 1024))
+        || !TEST_long_eq(SSL_CTX_get_record_buffer_pool_size(sctx),
+                         1024 * 1024))
+        goto end;
+    SSL_CTX_set_mode(sctx, SSL_MODE_RELEASE_BUFFERS);
+
+    for (i = 0; i < 2; i++) {
+        if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl[i],
+                                          &clientssl[i], NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl[i], clientssl[i],
+                                                SSL_ERROR_NONE))
+            || !TEST_true(SSL_write_ex(clientssl[i], msg, sizeof(msg),
+                                       &written))
+            || !TEST_true(SSL_read_ex(serverssl[i], buf, sizeof(buf),
+                                      &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg, sizeof(msg))
+            || !TEST_true(SSL_write_ex(serverssl[i], msg, sizeof(msg),
+                                       &written))
+            || !TEST_true(SSL_read_ex(clientssl[i], buf, sizeof(buf),
+                                      &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg, sizeof(msg)))
+            goto end;
+    }
+
+    /*
+     * Both idle servers have given their buffers back, and some of them have
+     * been reused.  The client SSL_CTX has no pool.
+     */
+    if (!TEST_long_eq(SSL_CTX_record_buffer_pool_in_use(sctx), 0)
+        || !TEST_long_gt(SSL_CTX_record_buffer_pool_idle(sctx), 0)
+        || !TEST_long_gt(SSL_CTX_record_buffer_pool_hits(sctx), 0)
+        || !TEST_long_gt(SSL_CTX_record_buffer_pool_misses(sctx), 0)
+        || !TEST_long_eq(SSL_CTX_record_buffer_pool_hits(cctx), 0))
+        goto end;
+
+    /* Shrinking the pool frees the idle buffers, but the servers still work */
+    if (!TEST_true(SSL_CTX_set_record_buffer_pool_size(sctx, 0))
+        || !TEST_long_eq(SSL_CTX_record_buffer_pool_idle(sctx), 0)
+        || !TEST_true(SSL_write_ex(clientssl[0], msg, sizeof(msg), &written))
+        || !TEST_true(SSL_read_ex(serverssl[0], buf, sizeof(buf), &readbytes))
+        || !TEST_mem_eq(buf, readbytes, msg, sizeof(msg))
+        || !TEST_long_eq(SSL_CTX_record_buffer_pool_idle(sctx), 0)
+        || !TEST_long_eq(SSL_CTX_record_buffer_pool_in_use(sctx), 0))
+        goto end;
+
+    testresult = 1;
+ end:
+    for (i = 0; i < 2; i++) {
+        SSL_free(serverssl[i]);
+        SSL_free(clientssl[i]);
+    }
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
 static int test_load_dhfile(void)
 {
 #ifndef OPENSSL_NO_DH
@@ -12502,6 +13023,7 @@ int setup_tests(void)
 # if !defined(OPENSSL_NO_TLS1_2) || !defined(OSSL_NO_USABLE_TLS1_3)
     ADD_ALL_TESTS(test_ktls, NUM_KTLS_TEST_CIPHERS * 4);
     ADD_ALL_TESTS(test_ktls_sendfile, NUM_KTLS_TEST_CIPHERS * 2);
+    ADD_ALL_TESTS(test_ktls_splice, NUM_KTLS_TEST_CIPHERS);
 # endif
 #endif
     ADD_TEST(test_large_message_tls);
@@ -12652,9 +13174,13 @@ int setup_tests(void)
     ADD_TEST(test_set_verify_cert_store_ssl_ctx);
     ADD_TEST(test_set_verify_cert_store_ssl);
     ADD_ALL_TESTS(test_session_timeout, 1);
+    ADD_ALL_TESTS(test_session_timing_wheel, 2);
+    ADD_TEST(test_session_cache_shards);
 #if !defined(OSSL_NO_USABLE_TLS1_3) || !defined(OPENSSL_NO_TLS1_2)
     ADD_ALL_TESTS(test_session_cache_overflow, 4);
 #endif
+    ADD_TEST(test_record_buffer_pool);
+    ADD_ALL_TESTS(test_ssl_writev, 3);
     ADD_TEST(test_load_dhfile);
 #ifndef OSSL_NO_USABLE_TLS1_3
     ADD_TEST(test_read_ahead_key_change);
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Measure how implicit fetches scale with the number of threads that
+ * perform them concurrently.  Each thread repeatedly fetches and frees the
+ * same digest, which after the first fetch is served from the method
+ * store's query cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <openssl/e_os2.h>
+
+#ifdef OPENSSL_SYS_UNIX
+# include <unistd.h>
+# include <sys/time.h>
+# include <openssl/evp.h>
+# include <openssl/err.h>
+# if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L \
+     && defined(OPENSSL_THREADS)
+#  include <pthread.h>
+#  define TIMING_FETCH_SUPPORTED
+
+static char *prog;
+static const char *algname = "SHA256";
+static const char *propq = NULL;
+static int count = 100000;
+
+static void *fetch_worker(void *arg)
+{
+    int i;
+    EVP_MD *md;
+
+    for (i = count; i > 0; i--) {
+        if ((md = EVP_MD_fetch(NULL, algname, propq)) == NULL) {
+            ERR_print_errors_fp(stderr);
+            exit(EXIT_FAILURE);
+        }
+        EVP_MD_free(md);
+    }
+    OPENSSL_thread_stop();
+    return NULL;
+}
+
+static double run_threads(int nthreads)
+{
+    pthread_t *threads;
+    struct timeval start, end;
+    int i;
+
+    threads = OPENSSL_malloc(sizeof(*threads) * nthreads);
+    if (threads == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (gettimeofday(&start, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < nthreads; i++)
+        if (pthread_create(&threads[i], NULL, fetch_worker, NULL) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    for (i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+    if (gettimeofday(&end, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    OPENSSL_free(threads);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [flags]\n", prog);
+    fprintf(stderr, "Flags:\n");
+    fprintf(stderr, "  -a alg  Digest to fetch (default SHA256)\n");
+    fprintf(stderr, "  -c #    Fetches per thread (default 100000)\n");
+    fprintf(stderr, "  -p q    Property query to fetch with\n");
+    fprintf(stderr, "  -t #    Maximum number of threads (default 8)\n");
+    exit(EXIT_FAILURE);
+}
+# endif
+#endif
+
+int main(int ac, char **av)
+{
+#ifdef TIMING_FETCH_SUPPORTED
+    int i, maxthreads = 8, nthreads;
+    double elapsed;
+    EVP_MD *md;
+
+    prog = av[0];
+    while ((i = getopt(ac, av, "a:c:p:t:")) != EOF) {
+        switch (i) {
+        default:
+            usage();
+            break;
+        case 'a':
+            algname = optarg;
+            break;
+        case 'c':
+            if ((count = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 'p':
+            propq = optarg;
+            break;
+        case 't':
+            if ((maxthreads = atoi(optarg)) <= 0)
+                usage();
+            break;
+        }
+    }
+
+    /* Populate the method store and the query cache */
+    if ((md = EVP_MD_fetch(NULL, algname, propq)) == NULL) {
+        ERR_print_errors_fp(stderr);
+        exit(EXIT_FAILURE);
+    }
+    EVP_MD_free(md);
+
+    printf("%8s %12s %16s %16s\n",
+           "threads", "seconds", "fetches/sec", "per thread");
+    for (nthreads = 1; ; nthreads *= 2) {
+        if (nthreads > maxthreads)
+            nthreads = maxthreads;
+        elapsed = run_threads(nthreads);
+        if (elapsed <= 0)
+            elapsed = 1e-6;
+        printf("%8d %12.3f %16.0f %16.0f\n", nthreads, elapsed,
+               (double)count * nthreads / elapsed, count / elapsed);
+        if (nthreads == maxthreads)
+            break;
+    }
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr,
+            "This tool is not supported on this platform for lack of POSIX1.2001 or thread support\n");
+    exit(EXIT_FAILURE);
+#endif
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Measure how many QUIC packets are moved per system call over a loopback
+ * UDP socket pair, with and without UDP segmentation offload. Packets are
+ * protected and queued by a QTX, flushed to the socket, and received and
+ * split back into datagrams by a demuxer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/e_os2.h>
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_QUIC)
+# include <unistd.h>
+# include <sys/time.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <arpa/inet.h>
+# include <openssl/bio.h>
+# include <openssl/err.h>
+# include "internal/quic_record_tx.h"
+# include "internal/quic_demux.h"
+# if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L
+#  define TIMING_QUIC_GSO_SUPPORTED
+
+#  define CONN_ID_LEN   8
+
+static char *prog;
+static int count = 200000;
+static int batch = 64;
+static int dgram_len = 1200;
+
+/* A filter BIO counting the calls made to the socket BIO below it. */
+static size_t send_calls, recv_calls, recv_msgs;
+
+static int count_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride, size_t num_msg,
+                          uint64_t flags, size_t *num_processed)
+{
+    ++send_calls;
+    return BIO_sendmmsg(BIO_next(b), msg, stride, num_msg, flags,
+                        num_processed);
+}
+
+static int count_recvmmsg(BIO *b, BIO_MSG *msg, size_t stride, size_t num_msg,
+                          uint64_t flags, size_t *num_processed)
+{
+    int ret;
+
+    ++recv_calls;
+    ret = BIO_recvmmsg(BIO_next(b), msg, stride, num_msg, flags,
+                       num_processed);
+    if (ret)
+        recv_msgs += *num_processed;
+    return ret;
+}
+
+static long count_ctrl(BIO *b, int cmd, long num, void *ptr)
+{
+    return BIO_ctrl(BIO_next(b), cmd, num, ptr);
+}
+
+static int count_create(BIO *b)
+{
+    BIO_set_init(b, 1);
+    return 1;
+}
+
+static BIO_METHOD *count_method(void)
+{
+    BIO_METHOD *meth = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_FILTER,
+                                    "counting filter");
+
+    if (meth == NULL
+        || !BIO_meth_set_sendmmsg(meth, count_sendmmsg)
+        || !BIO_meth_set_recvmmsg(meth, count_recvmmsg)
+        || !BIO_meth_set_ctrl(meth, count_ctrl)
+        || !BIO_meth_set_create(meth, count_create)) {
+        BIO_meth_free(meth);
+        return NULL;
+    }
+    return meth;
+}
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s: %s failed\n", prog, what);
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+static int make_socket(struct sockaddr_in *sin)
+{
+    socklen_t len = sizeof(*sin);
+    int fd, bufsize = 8 * 1024 * 1024;
+
+    if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+        fail("socket");
+    memset(sin, 0, sizeof(*sin));
+    sin->sin_family = AF_INET;
+    sin->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)sin, sizeof(*sin)) < 0
+        || getsockname(fd, (struct sockaddr *)sin, &len) < 0)
+        fail("bind");
+    /* Best effort, so that a whole batch fits in the receive queue */
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+    (void)setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+    if (!BIO_socket_nbio(fd, 1))
+        fail("BIO_socket_nbio");
+    return fd;
+}
+
+static size_t received;
+
+static void count_urxe(QUIC_URXE *e, void *arg, const QUIC_CONN_ID *dcid)
+{
+    ++received;
+    ossl_quic_demux_release_urxe((QUIC_DEMUX *)arg, e);
+}
+
+static void run(BIO_METHOD *meth, int offload)
+{
+    static const unsigned char secret[32] = { 1 };
+    static unsigned char payload[65536];
+    struct sockaddr_in tx_addr, rx_addr;
+    int tx_fd, rx_fd, i, j, idle;
+    BIO *tx_sock, *rx_sock, *tx_bio, *rx_bio;
+    OSSL_QTX_ARGS args = { 0 };
+    OSSL_QTX *qtx;
+    QUIC_DEMUX *demux;
+    QUIC_PKT_HDR hdr;
+    OSSL_QTX_PKT pkt = { 0 };
+    OSSL_QTX_IOVEC iov;
+    size_t payload_len, sent = 0;
+    QUIC_PN pn = 0;
+    struct timeval start, end;
+    double elapsed;
+
+    tx_fd = make_socket(&tx_addr);
+    rx_fd = make_socket(&rx_addr);
+    if (connect(tx_fd, (struct sockaddr *)&rx_addr, sizeof(rx_addr)) < 0
+        || connect(rx_fd, (struct sockaddr *)&tx_addr, sizeof(tx_addr)) < 0)
+        fail("connect");
+
+    if ((tx_sock = BIO_new_dgram(tx_fd, BIO_CLOSE)) == NULL
+        || (rx_sock = BIO_new_dgram(rx_fd, BIO_CLOSE)) == NULL
+        || (tx_bio = BIO_new(meth)) == NULL
+        || (rx_bio = BIO_new(meth)) == NULL)
+        fail("BIO_new");
+    BIO_push(tx_bio, tx_sock);
+    BIO_push(rx_bio, rx_sock);
+
+    if (offload && (!BIO_dgram_get_gso_cap(tx_bio)
+                    || !BIO_dgram_get_gro_cap(rx_bio))) {
+        printf("%-8s %s\n", "offload", "not supported on this platform");
+        goto end;
+    }
+
+    args.bio     = tx_bio;
+    args.mdpl    = dgram_len;
+    args.use_gso = offload;
+    if ((qtx = ossl_qtx_new(&args)) == NULL
+        || !ossl_qtx_provide_secret(qtx, QUIC_ENC_LEVEL_1RTT,
+                                    QRL_SUITE_AES128GCM, NULL,
+                                    secret, sizeof(secret)))
+        fail("QTX setup");
+
+    /* Short header: first byte, DCID and a 4 byte PN, then the AEAD tag */
+    if (!ossl_qtx_calculate_plaintext_payload_len(qtx, QUIC_ENC_LEVEL_1RTT,
+                                                  dgram_len - 1 - CONN_ID_LEN
+                                                  - 4, &payload_len))
+        fail("payload length");
+
+    if ((demux = ossl_quic_demux_new(rx_bio, CONN_ID_LEN, NULL, NULL)) == NULL)
+        fail("ossl_quic_demux_new");
+    ossl_quic_demux_set_default_handler(demux, count_urxe, demux);
+    ossl_quic_demux_set_gro(demux, offload);
+
+    memset(&hdr, 0, sizeof(hdr));
+    iov.buf         = payload;
+    iov.buf_len     = payload_len;
+    pkt.hdr         = &hdr;
+    pkt.iovec       = &iov;
+    pkt.num_iovec   = 1;
+
+    send_calls = recv_calls = recv_msgs = received = 0;
+    if (gettimeofday(&start, NULL) < 0)
+        fail("gettimeofday");
+    for (i = 0; i < count; i += batch) {
+        for (j = 0; j < batch && i + j < count; j++) {
+            hdr.type                = QUIC_PKT_TYPE_1RTT;
+            hdr.pn_len              = 4;
+            hdr.dst_conn_id.id_len  = CONN_ID_LEN;
+            pkt.pn                  = pn++;
+            if (!ossl_qtx_write_pkt(qtx, &pkt))
+                fail("ossl_qtx_write_pkt");
+        }
+        while (ossl_qtx_get_queue_len_datagrams(qtx) > 0)
+            if (ossl_qtx_flush_net(qtx) == QTX_FLUSH_NET_RES_PERMANENT_FAIL)
+                fail("ossl_qtx_flush_net");
+        sent += j;
+
+        /* Loopback delivers synchronously, anything still missing was lost */
+        for (idle = 0; received < sent && idle < 2; )
+            if (ossl_quic_demux_pump(demux) != QUIC_DEMUX_PUMP_RES_OK)
+                ++idle;
+    }
+    if (gettimeofday(&end, NULL) < 0)
+        fail("gettimeofday");
+
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+    if (elapsed <= 0)
+        elapsed = 1e-6;
+    printf("%-8s %10zu %10zu %12.0f %14.2f %14.2f %14.2f\n",
+           offload ? "offload" : "plain", sent, received, sent / elapsed,
+           (double)sent / send_calls, (double)received / recv_calls,
+           (double)received / (recv_msgs != 0 ? recv_msgs : 1));
+
+    ossl_quic_demux_free(demux);
+    ossl_qtx_free(qtx);
+ end:
+    BIO_free_all(tx_bio);
+    BIO_free_all(rx_bio);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [flags]\n", prog);
+    fprintf(stderr, "Flags:\n");
+    fprintf(stderr, "  -b #    Packets queued before each flush (default 64)\n");
+    fprintf(stderr, "  -n #    Number of packets to send (default 200000)\n");
+    fprintf(stderr, "  -s #    Datagram size (default 1200)\n");
+    exit(EXIT_FAILURE);
+}
+# endif
+#endif
+
+int main(int ac, char **av)
+{
+#ifdef TIMING_QUIC_GSO_SUPPORTED
+    BIO_METHOD *meth;
+    int i;
+
+    prog = av[0];
+    while ((i = getopt(ac, av, "b:n:s:")) != EOF) {
+        switch (i) {
+        default:
+            usage();
+            break;
+        case 'b':
+            if ((batch = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 'n':
+            if ((count = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 's':
+            if ((dgram_len = atoi(optarg)) < QUIC_MIN_INITIAL_DGRAM_LEN
+                || dgram_len > 65000)
+                usage();
+            break;
+        }
+    }
+
+    if ((meth = count_method()) == NULL)
+        fail("BIO_meth_new");
+
+    printf("%-8s %10s %10s %12s %14s %14s %14s\n", "mode", "sent",
+           "received", "packets/sec", "pkts/send call", "pkts/recv call",
+           "pkts/recv msg");
+    run(meth, 0);
+    run(meth, 1);
+    BIO_meth_free(meth);
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr,
+            "This tool is not supported on this platform for lack of POSIX1.2001 or QUIC support\n");
+    exit(EXIT_FAILURE);
+#endif
+}
@@ -0,0 +1,475 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Measure how QUIC server throughput scales with the number of worker threads
+ * sharing one UDP port. Like util/quicserver.c, each worker serves a
+ * connection using a QUIC_TSERVER, here on its own SO_REUSEPORT socket. The
+ * workers embed their index in the connection IDs they issue, and forward
+ * datagrams which the kernel delivered to the wrong socket to the owning
+ * worker. One client thread per worker downloads a stream from the server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/e_os2.h>
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_QUIC)
+# include <unistd.h>
+# include <sys/time.h>
+# include <sys/select.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <arpa/inet.h>
+# include <openssl/bio.h>
+# include <openssl/ssl.h>
+# include <openssl/err.h>
+# include "internal/quic_lcidm.h"
+# include "internal/quic_tserver.h"
+# include "internal/time.h"
+# if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L \
+     && defined(OPENSSL_THREADS) && defined(SO_REUSEPORT)
+#  include <pthread.h>
+#  define TIMING_QUIC_SERVER_SUPPORTED
+
+typedef struct fwd_st FWD;
+
+struct fwd_st {
+    FWD             *next;
+    BIO_ADDR        *peer;
+    size_t          data_len;
+    unsigned char   data[1];
+};
+
+typedef struct worker_st {
+    pthread_t       thread;
+    QUIC_TSERVER    *srv;
+    /* The following are protected by fwd_lock */
+    FWD             *head, *tail;   /* Datagrams forwarded to this worker */
+    BIO_ADDR        *offered_peer;  /* Peer offered to us by another worker */
+    int             busy;           /* Have we accepted our connection? */
+} WORKER;
+
+static char *prog;
+static const char *certfile, *keyfile;
+static size_t nbytes = 64 * 1024 * 1024;
+static int seg_offload;
+static int nworkers;
+static unsigned int steer_bits;
+static WORKER *workers;
+static struct sockaddr_in server_addr;
+static SSL_CTX *client_ctx;
+static pthread_mutex_t fwd_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t nforwarded, failures;
+static int stop;
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s: %s failed\n", prog, what);
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+static int addr_eq(const BIO_ADDR *a, const BIO_ADDR *b)
+{
+    unsigned char abuf[16], bbuf[16];
+    size_t alen = sizeof(abuf), blen = sizeof(bbuf);
+
+    return BIO_ADDR_family(a) == BIO_ADDR_family(b)
+        && BIO_ADDR_rawport(a) == BIO_ADDR_rawport(b)
+        && BIO_ADDR_rawaddress(a, abuf, &alen)
+        && BIO_ADDR_rawaddress(b, bbuf, &blen)
+        && alen == blen && memcmp(abuf, bbuf, alen) == 0;
+}
+
+/*
+ * Called by a worker for a datagram belonging to another worker, or for a
+ * connection attempt it cannot accept. The latter is offered to an idle
+ * worker, the same one for every datagram from the same peer.
+ */
+static void forward_cb(const unsigned char *data, size_t data_len,
+                       const BIO_ADDR *peer, const BIO_ADDR *local,
+                       unsigned int steer_id, void *arg)
+{
+    WORKER *w = NULL;
+    FWD *f;
+    int i;
+
+    pthread_mutex_lock(&fwd_lock);
+    if (steer_id == QUIC_PORT_STEER_ANY) {
+        for (i = 0; i < nworkers && w == NULL; i++)
+            if (workers[i].offered_peer != NULL
+                && addr_eq(workers[i].offered_peer, peer))
+                w = &workers[i];
+        for (i = 0; i < nworkers && w == NULL; i++)
+            if (!workers[i].busy && workers[i].offered_peer == NULL
+                && (workers[i].offered_peer = BIO_ADDR_dup(peer)) != NULL)
+                w = &workers[i];
+    } else if (steer_id < (unsigned int)nworkers) {
+        w = &workers[steer_id];
+    }
+
+    if (w != NULL
+        && (f = OPENSSL_malloc(sizeof(*f) + data_len)) != NULL) {
+        if ((f->peer = BIO_ADDR_dup(peer)) == NULL) {
+            OPENSSL_free(f);
+        } else {
+            memcpy(f->data, data, data_len);
+            f->data_len = data_len;
+            f->next = NULL;
+            if (w->tail != NULL)
+                w->tail->next = f;
+            else
+                w->head = f;
+            w->tail = f;
+            ++nforwarded;
+        }
+    }
+    pthread_mutex_unlock(&fwd_lock);
+}
+
+static int drain_forwarded(WORKER *w)
+{
+    FWD *f, *next;
+    int any;
+
+    pthread_mutex_lock(&fwd_lock);
+    f = w->head;
+    w->head = w->tail = NULL;
+    pthread_mutex_unlock(&fwd_lock);
+
+    any = f != NULL;
+    for (; f != NULL; f = next) {
+        next = f->next;
+        ossl_quic_tserver_inject_forwarded(w->srv, f->data, f->data_len,
+                                           f->peer, NULL);
+        BIO_ADDR_free(f->peer);
+        OPENSSL_free(f);
+    }
+    return any;
+}
+
+/*
+ * As in util/quicserver.c, but never sleep for long as forwarded datagrams
+ * do not wake us up.
+ */
+static void wait_for_activity(QUIC_TSERVER *qtserv)
+{
+    fd_set readfds, writefds;
+    struct timeval timeout;
+    int sock;
+    OSSL_TIME deadline, cap;
+
+    BIO_get_fd(ossl_quic_tserver_get0_rbio(qtserv), &sock);
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
+    if (ossl_quic_tserver_get_net_read_desired(qtserv))
+        FD_SET(sock, &readfds);
+    if (ossl_quic_tserver_get_net_write_desired(qtserv))
+        FD_SET(sock, &writefds);
+
+    cap = ossl_time_add(ossl_time_now(), ossl_ms2time(1));
+    deadline = ossl_time_min(ossl_quic_tserver_get_deadline(qtserv), cap);
+    timeout = ossl_time_to_timeval(ossl_time_subtract(deadline,
+                                                      ossl_time_now()));
+    select(sock + 1, &readfds, &writefds, NULL, &timeout);
+}
+
+static void *server_worker(void *arg)
+{
+    WORKER *w = arg;
+    static const unsigned char buf[16384];
+    size_t sent = 0, written;
+    uint64_t stream_id = UINT64_MAX;
+    int concluded = 0, done;
+
+    for (;;) {
+        int progress = drain_forwarded(w);
+
+        ossl_quic_tserver_tick(w->srv);
+        /*
+         * Keep receiving after our connection has ended, as other workers may
+         * still rely on us to forward their datagrams.
+         */
+        if (ossl_quic_tserver_is_term_any(w->srv)) {
+            pthread_mutex_lock(&fwd_lock);
+            done = stop;
+            pthread_mutex_unlock(&fwd_lock);
+            if (done)
+                break;
+            wait_for_activity(w->srv);
+            continue;
+        }
+        if (!ossl_quic_tserver_is_connected(w->srv)) {
+            wait_for_activity(w->srv);
+            continue;
+        }
+
+        if (!w->busy) {
+            pthread_mutex_lock(&fwd_lock);
+            w->busy = 1;
+            pthread_mutex_unlock(&fwd_lock);
+        }
+
+        if (stream_id == UINT64_MAX
+            && !ossl_quic_tserver_stream_new(w->srv, 1, &stream_id))
+            break;
+
+        if (sent < nbytes) {
+            written = 0;
+            if (!ossl_quic_tserver_write(w->srv, stream_id, buf,
+                                         nbytes - sent < sizeof(buf)
+                                         ? nbytes - sent : sizeof(buf),
+                                         &written))
+                break;
+            sent += written;
+            progress |= written > 0;
+        } else if (!concluded) {
+            concluded = ossl_quic_tserver_conclude(w->srv, stream_id);
+            progress = 1;
+        }
+
+        if (!progress)
+            wait_for_activity(w->srv);
+    }
+    OPENSSL_thread_stop();
+    return NULL;
+}
+
+static void *client_worker(void *arg)
+{
+    static const unsigned char alpn[] = {
+        8, 'o', 's', 's', 'l', 't', 'e', 's', 't'
+    };
+    unsigned char buf[16384];
+    size_t received = 0, n;
+    BIO_ADDR *peer;
+    BIO *bio;
+    SSL *ssl, *stream;
+    int fd;
+
+    if ((fd = BIO_socket(AF_INET, SOCK_DGRAM, 0, 0)) < 0
+        || (peer = BIO_ADDR_new()) == NULL
+        || !BIO_ADDR_rawmake(peer, AF_INET, &server_addr.sin_addr,
+                             sizeof(server_addr.sin_addr),
+                             server_addr.sin_port)
+        || !BIO_connect(fd, peer, 0)
+        || !BIO_socket_nbio(fd, 1)
+        || (bio = BIO_new_dgram(fd, BIO_CLOSE)) == NULL
+        || (ssl = SSL_new(client_ctx)) == NULL)
+        fail("client setup");
+
+    SSL_set_bio(ssl, bio, bio);
+    if (!SSL_set1_initial_peer_addr(ssl, peer)
+        || SSL_set_alpn_protos(ssl, alpn, sizeof(alpn)) != 0
+        || !SSL_set_default_stream_mode(ssl, SSL_DEFAULT_STREAM_MODE_NONE)
+        || SSL_connect(ssl) != 1
+        || (stream = SSL_accept_stream(ssl, 0)) == NULL)
+        fail("client connection");
+
+    while (SSL_read_ex(stream, buf, sizeof(buf), &n))
+        received += n;
+    if (SSL_get_error(stream, 0) != SSL_ERROR_ZERO_RETURN
+        || received != nbytes) {
+        ERR_print_errors_fp(stderr);
+        pthread_mutex_lock(&fwd_lock);
+        ++failures;
+        pthread_mutex_unlock(&fwd_lock);
+    }
+    SSL_free(stream);
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    BIO_ADDR_free(peer);
+    OPENSSL_thread_stop();
+    return NULL;
+}
+
+static int make_socket(void)
+{
+    socklen_t len = sizeof(server_addr);
+    int fd, on = 1;
+
+    if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+        fail("socket");
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0
+        || bind(fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0
+        || getsockname(fd, (struct sockaddr *)&server_addr, &len) < 0)
+        fail("bind");
+    if (!BIO_socket_nbio(fd, 1))
+        fail("BIO_socket_nbio");
+    return fd;
+}
+
+static int num_busy(void)
+{
+    int i, n = 0;
+
+    pthread_mutex_lock(&fwd_lock);
+    for (i = 0; i < nworkers; i++)
+        n += workers[i].busy;
+    pthread_mutex_unlock(&fwd_lock);
+    return n;
+}
+
+static double run(int n)
+{
+    QUIC_TSERVER_ARGS args = { 0 };
+    pthread_t *clients;
+    struct timeval start, end;
+    BIO *bio;
+    int i, wait;
+
+    nworkers = n;
+    workers = OPENSSL_zalloc(sizeof(*workers) * n);
+    clients = OPENSSL_malloc(sizeof(*clients) * n);
+    if (workers == NULL || clients == NULL)
+        fail("malloc");
+
+    /* Every run binds a fresh port, all workers share it */
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (i = 0; i < n; i++) {
+        if ((bio = BIO_new_dgram(make_socket(), BIO_CLOSE)) == NULL
+            || !BIO_up_ref(bio))
+            fail("BIO_new_dgram");
+        args.net_rbio = args.net_wbio = bio;
+        args.use_seg_offload = seg_offload;
+        if ((workers[i].srv = ossl_quic_tserver_new(&args, certfile,
+                                                    keyfile)) == NULL
+            || !ossl_quic_tserver_set_steering(workers[i].srv, steer_bits, i,
+                                               forward_cb, NULL))
+            fail("ossl_quic_tserver_new");
+    }
+
+    nforwarded = failures = 0;
+    stop = 0;
+    if (gettimeofday(&start, NULL) < 0)
+        fail("gettimeofday");
+    for (i = 0; i < n; i++)
+        if (pthread_create(&workers[i].thread, NULL, server_worker,
+                           &workers[i]) != 0)
+            fail("pthread_create");
+
+    /*
+     * Each worker accepts a single connection, so connect one client at a
+     * time to let each connection attempt find an idle worker.
+     */
+    for (i = 0; i < n; i++) {
+        if (pthread_create(&clients[i], NULL, client_worker, NULL) != 0)
+            fail("pthread_create");
+        for (wait = 0; num_busy() <= i && failures == 0; wait++) {
+            if (wait == 10000)
+                fail("connection setup");
+            usleep(1000);
+        }
+    }
+
+    for (i = 0; i < n; i++)
+        pthread_join(clients[i], NULL);
+    if (gettimeofday(&end, NULL) < 0)
+        fail("gettimeofday");
+
+    pthread_mutex_lock(&fwd_lock);
+    stop = 1;
+    pthread_mutex_unlock(&fwd_lock);
+    for (i = 0; i < n; i++)
+        pthread_join(workers[i].thread, NULL);
+    if (failures != 0)
+        fail("transfer");
+
+    for (i = 0; i < n; i++) {
+        drain_forwarded(&workers[i]);
+        BIO_ADDR_free(workers[i].offered_peer);
+        ossl_quic_tserver_free(workers[i].srv);
+    }
+    OPENSSL_free(workers);
+    OPENSSL_free(clients);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [flags] certfile keyfile\n", prog);
+    fprintf(stderr, "Flags:\n");
+    fprintf(stderr, "  -g      Use UDP segmentation offload where available\n");
+    fprintf(stderr, "  -n #    Megabytes sent on each connection (default 64)\n");
+    fprintf(stderr, "  -t #    Maximum number of workers (default 4)\n");
+    exit(EXIT_FAILURE);
+}
+# endif
+#endif
+
+int main(int ac, char **av)
+{
+#ifdef TIMING_QUIC_SERVER_SUPPORTED
+    int i, maxworkers = 4, n;
+    double elapsed;
+
+    prog = av[0];
+    while ((i = getopt(ac, av, "gn:t:")) != EOF) {
+        switch (i) {
+        default:
+            usage();
+            break;
+        case 'g':
+            seg_offload = 1;
+            break;
+        case 'n':
+            if ((i = atoi(optarg)) <= 0)
+                usage();
+            nbytes = (size_t)i * 1024 * 1024;
+            break;
+        case 't':
+            if ((maxworkers = atoi(optarg)) <= 0
+                || maxworkers > (1 << QUIC_LCIDM_MAX_STEER_BITS))
+                usage();
+            break;
+        }
+    }
+    if (ac - optind != 2)
+        usage();
+    certfile = av[optind];
+    keyfile = av[optind + 1];
+
+    /* The steering ID must distinguish all the workers */
+    while ((1 << steer_bits) < maxworkers)
+        ++steer_bits;
+    if (steer_bits == 0)
+        steer_bits = 1;
+
+    if ((client_ctx = SSL_CTX_new(OSSL_QUIC_client_method())) == NULL)
+        fail("SSL_CTX_new");
+    SSL_CTX_set_verify(client_ctx, SSL_VERIFY_NONE, NULL);
+
+    printf("%8s %12s %12s %12s %12s\n", "workers", "seconds", "MB/sec",
+           "per worker", "forwarded");
+    for (n = 1; ; n *= 2) {
+        if (n > maxworkers)
+            n = maxworkers;
+        elapsed = run(n);
+        if (elapsed <= 0)
+            elapsed = 1e-6;
+        printf("%8d %12.3f %12.1f %12.1f %12zu\n", n, elapsed,
+               (double)nbytes * n / elapsed / (1024 * 1024),
+               (double)nbytes / elapsed / (1024 * 1024), nforwarded);
+        if (n == maxworkers)
+            break;
+    }
+    SSL_CTX_free(client_ctx);
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr,
+            "This tool is not supported on this platform for lack of POSIX1.2001, thread, SO_REUSEPORT or QUIC support\n");
+    exit(EXIT_FAILURE);
+#endif
+}
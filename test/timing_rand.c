@@ -0,0 +1,151 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Measure the throughput of small RAND_bytes() requests, such as those for
+ * nonces and IVs, made by many threads at once. With -b the output of the
+ * public DRBG of each thread is buffered, see RAND_set_public_buffer_size(3).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <openssl/e_os2.h>
+
+#ifdef OPENSSL_SYS_UNIX
+# include <unistd.h>
+# include <sys/time.h>
+# include <openssl/crypto.h>
+# include <openssl/rand.h>
+# include <openssl/err.h>
+# if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L \
+     && defined(OPENSSL_THREADS)
+#  include <pthread.h>
+#  define TIMING_RAND_SUPPORTED
+
+static char *prog;
+static int count = 1000000;
+static int reqsize = 16;
+
+static void *rand_worker(void *arg)
+{
+    unsigned char buf[1024];
+    int i;
+
+    for (i = count; i > 0; i--)
+        if (RAND_bytes(buf, reqsize) <= 0) {
+            ERR_print_errors_fp(stderr);
+            exit(EXIT_FAILURE);
+        }
+    OPENSSL_thread_stop();
+    return NULL;
+}
+
+static double run_threads(int nthreads)
+{
+    pthread_t *threads;
+    struct timeval start, end;
+    int i;
+
+    threads = OPENSSL_malloc(sizeof(*threads) * nthreads);
+    if (threads == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (gettimeofday(&start, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < nthreads; i++)
+        if (pthread_create(&threads[i], NULL, rand_worker, NULL) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    for (i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+    if (gettimeofday(&end, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    OPENSSL_free(threads);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [flags]\n", prog);
+    fprintf(stderr, "Flags:\n");
+    fprintf(stderr, "  -b #    Size of the per-thread output buffer (default 0, none)\n");
+    fprintf(stderr, "  -c #    Requests per thread (default 1000000)\n");
+    fprintf(stderr, "  -s #    Size of each request in bytes, up to 1024 (default 16)\n");
+    fprintf(stderr, "  -t #    Maximum number of threads (default 8)\n");
+    exit(EXIT_FAILURE);
+}
+# endif
+#endif
+
+int main(int ac, char **av)
+{
+#ifdef TIMING_RAND_SUPPORTED
+    int i, maxthreads = 8, nthreads;
+    long bufsize = 0;
+    double elapsed;
+
+    prog = av[0];
+    while ((i = getopt(ac, av, "b:c:s:t:")) != EOF) {
+        switch (i) {
+        default:
+            usage();
+            break;
+        case 'b':
+            if ((bufsize = atol(optarg)) < 0)
+                usage();
+            break;
+        case 'c':
+            if ((count = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 's':
+            if ((reqsize = atoi(optarg)) <= 0 || reqsize > 1024)
+                usage();
+            break;
+        case 't':
+            if ((maxthreads = atoi(optarg)) <= 0)
+                usage();
+            break;
+        }
+    }
+
+    if (!RAND_set_public_buffer_size(NULL, (size_t)bufsize)) {
+        ERR_print_errors_fp(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%d byte requests, %ld byte buffer\n", reqsize, bufsize);
+    printf("%8s %12s %16s %16s\n", "threads", "seconds", "requests/sec",
+           "per thread");
+    for (nthreads = 1; ; nthreads *= 2) {
+        if (nthreads > maxthreads)
+            nthreads = maxthreads;
+        elapsed = run_threads(nthreads);
+        if (elapsed <= 0)
+            elapsed = 1e-6;
+        printf("%8d %12.3f %16.0f %16.0f\n", nthreads, elapsed,
+               (double)count * nthreads / elapsed, count / elapsed);
+        if (nthreads == maxthreads)
+            break;
+    }
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr,
+            "This tool is not supported on this platform for lack of POSIX1.2001 or thread support\n");
+    exit(EXIT_FAILURE);
+#endif
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Measure lock contention on the internal session cache of a single SSL_CTX.
+ * Each thread performs a mix of session id lookups, which is what session
+ * resumption does on a server, and session additions, which evict the oldest
+ * sessions once the cache is full.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/e_os2.h>
+
+#ifdef OPENSSL_SYS_UNIX
+# include <unistd.h>
+# include <sys/time.h>
+# include <openssl/ssl.h>
+# include <openssl/err.h>
+# if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L \
+     && defined(OPENSSL_THREADS)
+#  include <pthread.h>
+#  define TIMING_SESS_CACHE_SUPPORTED
+
+static char *prog;
+static SSL_CTX *ctx;
+static int version;
+static int count = 100000;
+static int nsessions = 20000;
+static int write_pct = 10;
+
+static void make_id(unsigned char *id, uint32_t n)
+{
+    memset(id, 0, SSL_MAX_SSL_SESSION_ID_LENGTH);
+    memcpy(id, &n, sizeof(n));
+    /* Spread the ids in the same way as random ids would be */
+    n *= 0x9e3779b1;
+    memcpy(id + SSL_MAX_SSL_SESSION_ID_LENGTH - sizeof(n), &n, sizeof(n));
+}
+
+static int add_session(uint32_t n)
+{
+    SSL_SESSION *sess;
+    unsigned char id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+    int ok;
+
+    make_id(id, n);
+    if ((sess = SSL_SESSION_new()) == NULL)
+        return 0;
+    ok = SSL_SESSION_set_protocol_version(sess, version)
+        && SSL_SESSION_set1_id(sess, id, sizeof(id))
+        && SSL_CTX_add_session(ctx, sess);
+    SSL_SESSION_free(sess);
+    return ok;
+}
+
+static void *sess_cache_worker(void *arg)
+{
+    SSL *ssl;
+    unsigned char id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+    uint32_t seed = (uint32_t)(size_t)arg * 2654435761U + 1;
+    uint32_t next = (uint32_t)nsessions + (uint32_t)(size_t)arg * count;
+    size_t hits = 0;
+    int i;
+
+    if ((ssl = SSL_new(ctx)) == NULL) {
+        ERR_print_errors_fp(stderr);
+        exit(EXIT_FAILURE);
+    }
+    for (i = count; i > 0; i--) {
+        /* xorshift32 */
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        if ((int)(seed % 100) < write_pct) {
+            /* These may fail when another thread evicts at the same time */
+            add_session(next++);
+        } else {
+            make_id(id, seed % (uint32_t)nsessions);
+            if (SSL_has_matching_session_id(ssl, id, sizeof(id)))
+                hits++;
+        }
+    }
+    SSL_free(ssl);
+    OPENSSL_thread_stop();
+    return (void *)hits;
+}
+
+static double run_threads(int nthreads, size_t *hits)
+{
+    pthread_t *threads;
+    struct timeval start, end;
+    void *res;
+    int i;
+
+    threads = OPENSSL_malloc(sizeof(*threads) * nthreads);
+    if (threads == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (gettimeofday(&start, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < nthreads; i++)
+        if (pthread_create(&threads[i], NULL, sess_cache_worker,
+                           (void *)(size_t)(i + 1)) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    for (*hits = 0, i = 0; i < nthreads; i++)
+        if (pthread_join(threads[i], &res) == 0)
+            *hits += (size_t)res;
+    if (gettimeofday(&end, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    OPENSSL_free(threads);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [flags]\n", prog);
+    fprintf(stderr, "Flags:\n");
+    fprintf(stderr, "  -c #    Operations per thread (default 100000)\n");
+    fprintf(stderr, "  -n #    Number of cached sessions (default 20000)\n");
+    fprintf(stderr, "  -s #    Number of session cache shards (default 1)\n");
+    fprintf(stderr, "  -t #    Maximum number of threads (default 8)\n");
+    fprintf(stderr, "  -w #    Percentage of operations that add a session (default 10)\n");
+    exit(EXIT_FAILURE);
+}
+# endif
+#endif
+
+int main(int ac, char **av)
+{
+#ifdef TIMING_SESS_CACHE_SUPPORTED
+    int i, maxthreads = 8, nthreads, shards = 1;
+    double elapsed;
+    size_t hits;
+    SSL *ssl;
+
+    prog = av[0];
+    while ((i = getopt(ac, av, "c:n:s:t:w:")) != EOF) {
+        switch (i) {
+        default:
+            usage();
+            break;
+        case 'c':
+            if ((count = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 'n':
+            if ((nsessions = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 's':
+            if ((shards = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 't':
+            if ((maxthreads = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 'w':
+            if ((write_pct = atoi(optarg)) < 0 || write_pct > 100)
+                usage();
+            break;
+        }
+    }
+
+    if ((ctx = SSL_CTX_new(TLS_server_method())) == NULL
+        || !SSL_CTX_sess_set_cache_shards(ctx, shards)
+        || (ssl = SSL_new(ctx)) == NULL) {
+        ERR_print_errors_fp(stderr);
+        exit(EXIT_FAILURE);
+    }
+    /* Sessions must carry the version that lookups are done with */
+    version = SSL_version(ssl);
+    SSL_free(ssl);
+    SSL_CTX_sess_set_cache_size(ctx, nsessions);
+
+    /* Fill the cache */
+    for (i = 0; i < nsessions; i++)
+        if (!add_session((uint32_t)i)) {
+            ERR_print_errors_fp(stderr);
+            exit(EXIT_FAILURE);
+        }
+
+    printf("%d shard(s), %ld cached sessions, %d%% additions\n",
+           shards, SSL_CTX_sess_number(ctx), write_pct);
+    printf("%8s %12s %16s %16s %12s\n", "threads", "seconds", "ops/sec",
+           "per thread", "lookup hits");
+    for (nthreads = 1; ; nthreads *= 2) {
+        if (nthreads > maxthreads)
+            nthreads = maxthreads;
+        elapsed = run_threads(nthreads, &hits);
+        if (elapsed <= 0)
+            elapsed = 1e-6;
+        printf("%8d %12.3f %16.0f %16.0f %12zu\n", nthreads, elapsed,
+               (double)count * nthreads / elapsed, count / elapsed, hits);
+        if (nthreads == maxthreads)
+            break;
+    }
+    SSL_CTX_free(ctx);
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr,
+            "This tool is not supported on this platform for lack of POSIX1.2001 or thread support\n");
+    exit(EXIT_FAILURE);
+#endif
+}
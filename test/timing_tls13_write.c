@@ -0,0 +1,214 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Measure the bulk throughput of SSL_write_ex() on a TLS 1.3 connection
+ * writing full 16 KiB records, which are encrypted straight from the
+ * caller's buffer with AES-GCM and ChaCha20-Poly1305. The connection runs
+ * over a BIO pair, the records written by the client are discarded unless
+ * the server is asked to read them. The data written can be taken from a
+ * source buffer larger than the caches, which is what serving large objects
+ * looks like.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/e_os2.h>
+
+#ifdef OPENSSL_SYS_UNIX
+# include <unistd.h>
+# include <sys/time.h>
+# include <openssl/bio.h>
+# include <openssl/ssl.h>
+# include <openssl/err.h>
+# include "internal/nelem.h"
+# define TIMING_TLS13_WRITE_SUPPORTED
+
+static const char *default_suites[] = {
+    "TLS_AES_128_GCM_SHA256",
+    "TLS_AES_256_GCM_SHA384",
+    "TLS_CHACHA20_POLY1305_SHA256",
+};
+
+static char *prog;
+static const char *certfile, *keyfile;
+static size_t nbytes = 1024 * 1024 * 1024;
+static size_t srclen = 16384;
+static size_t wsize = 16384;
+static int server_reads;
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s: %s failed\n", prog, what);
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+/* Moves the handshake along on both sides until it is complete */
+static void do_handshake(SSL *client, SSL *server)
+{
+    int i, cret = 0, sret = 0;
+
+    for (i = 0; i < 100 && (cret != 1 || sret != 1); i++) {
+        if (cret != 1)
+            cret = SSL_do_handshake(client);
+        if (sret != 1)
+            sret = SSL_do_handshake(server);
+    }
+    if (cret != 1 || sret != 1)
+        fail("handshake");
+}
+
+static double run(const char *suite, const unsigned char *src)
+{
+    static unsigned char buf[65536];
+    SSL_CTX *sctx, *cctx;
+    SSL *server, *client;
+    BIO *sbio, *cbio;
+    struct timeval start, end;
+    size_t sent, off = 0, n, written;
+
+    if ((sctx = SSL_CTX_new(TLS_server_method())) == NULL
+        || (cctx = SSL_CTX_new(TLS_client_method())) == NULL
+        || !SSL_CTX_set_min_proto_version(sctx, TLS1_3_VERSION)
+        || !SSL_CTX_set_min_proto_version(cctx, TLS1_3_VERSION)
+        || !SSL_CTX_set_ciphersuites(sctx, suite)
+        || !SSL_CTX_set_ciphersuites(cctx, suite)
+        || SSL_CTX_use_certificate_chain_file(sctx, certfile) != 1
+        || SSL_CTX_use_PrivateKey_file(sctx, keyfile, SSL_FILETYPE_PEM) != 1)
+        fail("SSL_CTX setup");
+    SSL_CTX_set_mode(cctx, SSL_MODE_ENABLE_PARTIAL_WRITE
+                           | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+    if ((server = SSL_new(sctx)) == NULL
+        || (client = SSL_new(cctx)) == NULL
+        || !BIO_new_bio_pair(&sbio, 1024 * 1024, &cbio, 1024 * 1024))
+        fail("SSL setup");
+    SSL_set_bio(server, sbio, sbio);
+    SSL_set_bio(client, cbio, cbio);
+    SSL_set_accept_state(server);
+    SSL_set_connect_state(client);
+    do_handshake(client, server);
+
+    if (gettimeofday(&start, NULL) < 0)
+        fail("gettimeofday");
+    for (sent = 0; sent < nbytes; sent += written) {
+        n = wsize;
+        if (n > nbytes - sent)
+            n = nbytes - sent;
+        if (n > srclen - off)
+            n = srclen - off;
+        if (!SSL_write_ex(client, src + off, n, &written))
+            fail("SSL_write_ex");
+        if ((off += written) == srclen)
+            off = 0;
+
+        /* Take the records off the BIO pair, decrypting them if asked to */
+        if (server_reads) {
+            while (SSL_read_ex(server, buf, sizeof(buf), &n))
+                continue;
+            if (SSL_get_error(server, 0) != SSL_ERROR_WANT_READ)
+                fail("SSL_read_ex");
+        } else {
+            while (BIO_read(sbio, buf, sizeof(buf)) > 0)
+                continue;
+        }
+    }
+    if (gettimeofday(&end, NULL) < 0)
+        fail("gettimeofday");
+
+    SSL_free(client);
+    SSL_free(server);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [flags] certfile keyfile [ciphersuite...]\n",
+            prog);
+    fprintf(stderr, "Flags:\n");
+    fprintf(stderr, "  -m #    Kilobytes of source data cycled through (default 16)\n");
+    fprintf(stderr, "  -n #    Megabytes written with each ciphersuite (default 1024)\n");
+    fprintf(stderr, "  -r      Let the server read and decrypt the records\n");
+    fprintf(stderr, "  -w #    Bytes passed to each SSL_write_ex() (default 16384)\n");
+    exit(EXIT_FAILURE);
+}
+#endif
+
+int main(int ac, char **av)
+{
+#ifdef TIMING_TLS13_WRITE_SUPPORTED
+    const char **suites = default_suites;
+    int i, nsuites = OSSL_NELEM(default_suites);
+    unsigned char *src;
+    double elapsed;
+
+    prog = av[0];
+    while ((i = getopt(ac, av, "m:n:rw:")) != EOF) {
+        switch (i) {
+        default:
+            usage();
+            break;
+        case 'm':
+            if ((i = atoi(optarg)) <= 0)
+                usage();
+            srclen = (size_t)i * 1024;
+            break;
+        case 'n':
+            if ((i = atoi(optarg)) <= 0)
+                usage();
+            nbytes = (size_t)i * 1024 * 1024;
+            break;
+        case 'r':
+            server_reads = 1;
+            break;
+        case 'w':
+            if ((i = atoi(optarg)) <= 0)
+                usage();
+            wsize = (size_t)i;
+            break;
+        }
+    }
+    if (ac - optind < 2)
+        usage();
+    certfile = av[optind];
+    keyfile = av[optind + 1];
+    if (ac - optind > 2) {
+        suites = (const char **)av + optind + 2;
+        nsuites = ac - optind - 2;
+    }
+
+    if ((src = OPENSSL_malloc(srclen)) == NULL)
+        fail("malloc");
+    for (i = 0; (size_t)i < srclen; i++)
+        src[i] = (unsigned char)i;
+
+    printf("%zu bytes per write, %zu KiB of source data, %s\n", wsize,
+           srclen / 1024, server_reads ? "server reads" : "records discarded");
+    printf("%-32s %12s %12s\n", "ciphersuite", "seconds", "MB/sec");
+    for (i = 0; i < nsuites; i++) {
+        elapsed = run(suites[i], src);
+        if (elapsed <= 0)
+            elapsed = 1e-6;
+        printf("%-32s %12.3f %12.1f\n", suites[i], elapsed,
+               (double)nbytes / elapsed / (1024 * 1024));
+    }
+    OPENSSL_free(src);
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr,
+            "This tool is not supported on this platform\n");
+    exit(EXIT_FAILURE);
+#endif
+}
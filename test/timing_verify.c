@@ -0,0 +1,237 @@
+/*
+ * Copyright 2025 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Measure certificate verification throughput against a single X509_STORE
+ * shared by all threads, as a server verifying client certificates does.
+ * The store holds a large number of trust anchors besides the one which
+ * issued the certificate being verified, so that the time taken to look up
+ * issuers in the store and any contention between the threads doing so show.
+ * With -C the verified chain cache of the store is enabled, and all but the
+ * first verification are cache hits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <openssl/e_os2.h>
+
+#ifdef OPENSSL_SYS_UNIX
+# include <unistd.h>
+# include <sys/time.h>
+# include <openssl/evp.h>
+# include <openssl/x509.h>
+# include <openssl/x509v3.h>
+# include <openssl/err.h>
+# if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L \
+     && defined(OPENSSL_THREADS)
+#  include <pthread.h>
+#  define TIMING_VERIFY_SUPPORTED
+
+static char *prog;
+static X509_STORE *store;
+static X509 *leaf;
+static int count = 10000;
+
+static void fail(void)
+{
+    ERR_print_errors_fp(stderr);
+    exit(EXIT_FAILURE);
+}
+
+static X509 *make_cert(const char *subject, const char *issuer,
+                       EVP_PKEY *key, EVP_PKEY *signkey, long serial, int ca)
+{
+    X509 *x = X509_new();
+    X509_NAME *subj = X509_NAME_new(), *iss = X509_NAME_new();
+    X509V3_CTX v3ctx;
+    X509_EXTENSION *ext = NULL;
+
+    if (x == NULL || subj == NULL || iss == NULL
+        || !X509_set_version(x, X509_VERSION_3)
+        || !ASN1_INTEGER_set(X509_get_serialNumber(x), serial)
+        || !X509_NAME_add_entry_by_txt(subj, "CN", MBSTRING_ASC,
+                                       (const unsigned char *)subject,
+                                       -1, -1, 0)
+        || !X509_NAME_add_entry_by_txt(iss, "CN", MBSTRING_ASC,
+                                       (const unsigned char *)issuer,
+                                       -1, -1, 0)
+        || !X509_set_subject_name(x, subj)
+        || !X509_set_issuer_name(x, iss)
+        || X509_gmtime_adj(X509_getm_notBefore(x), -3600) == NULL
+        || X509_gmtime_adj(X509_getm_notAfter(x), 86400) == NULL
+        || !X509_set_pubkey(x, key))
+        fail();
+
+    X509V3_set_ctx(&v3ctx, NULL, x, NULL, NULL, 0);
+    if ((ext = X509V3_EXT_conf_nid(NULL, &v3ctx, NID_basic_constraints,
+                                   ca ? "critical,CA:TRUE"
+                                      : "critical,CA:FALSE")) == NULL
+        || !X509_add_ext(x, ext, -1)
+        || X509_sign(x, signkey, NULL) <= 0)
+        fail();
+
+    X509_EXTENSION_free(ext);
+    X509_NAME_free(subj);
+    X509_NAME_free(iss);
+    return x;
+}
+
+static void *verify_worker(void *arg)
+{
+    X509_STORE_CTX *ctx;
+    int i;
+
+    for (i = count; i > 0; i--) {
+        if ((ctx = X509_STORE_CTX_new()) == NULL
+            || !X509_STORE_CTX_init(ctx, store, leaf, NULL))
+            fail();
+        if (X509_verify_cert(ctx) != 1) {
+            fprintf(stderr, "%s: verification failed: %s\n", prog,
+                    X509_verify_cert_error_string(X509_STORE_CTX_get_error(ctx)));
+            exit(EXIT_FAILURE);
+        }
+        X509_STORE_CTX_free(ctx);
+    }
+    OPENSSL_thread_stop();
+    return NULL;
+}
+
+static double run_threads(int nthreads)
+{
+    pthread_t *threads;
+    struct timeval start, end;
+    int i;
+
+    threads = OPENSSL_malloc(sizeof(*threads) * nthreads);
+    if (threads == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (gettimeofday(&start, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < nthreads; i++)
+        if (pthread_create(&threads[i], NULL, verify_worker, NULL) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    for (i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+    if (gettimeofday(&end, NULL) < 0) {
+        perror("gettimeofday");
+        exit(EXIT_FAILURE);
+    }
+    OPENSSL_free(threads);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [flags]\n", prog);
+    fprintf(stderr, "Flags:\n");
+    fprintf(stderr, "  -C #    Size of the verified chain cache (default 0, disabled)\n");
+    fprintf(stderr, "  -c #    Verifications per thread (default 10000)\n");
+    fprintf(stderr, "  -n #    Number of other trust anchors (default 10000)\n");
+    fprintf(stderr, "  -t #    Maximum number of threads (default 8)\n");
+    exit(EXIT_FAILURE);
+}
+# endif
+#endif
+
+int main(int ac, char **av)
+{
+#ifdef TIMING_VERIFY_SUPPORTED
+    int i, maxthreads = 8, nthreads, nanchors = 10000, cachesize = 0;
+    double elapsed;
+    EVP_PKEY *cakey, *leafkey;
+    X509 *x;
+    char name[64];
+
+    prog = av[0];
+    while ((i = getopt(ac, av, "C:c:n:t:")) != EOF) {
+        switch (i) {
+        default:
+            usage();
+            break;
+        case 'C':
+            if ((cachesize = atoi(optarg)) < 0)
+                usage();
+            break;
+        case 'c':
+            if ((count = atoi(optarg)) <= 0)
+                usage();
+            break;
+        case 'n':
+            if ((nanchors = atoi(optarg)) < 0)
+                usage();
+            break;
+        case 't':
+            if ((maxthreads = atoi(optarg)) <= 0)
+                usage();
+            break;
+        }
+    }
+
+    if ((cakey = EVP_EC_gen("P-256")) == NULL
+        || (leafkey = EVP_EC_gen("P-256")) == NULL
+        || (store = X509_STORE_new()) == NULL
+        || !X509_STORE_set_chain_cache_size(store, cachesize))
+        fail();
+
+    /*
+     * The other trust anchors share the key of the real one, only their names
+     * matter.
+     */
+    for (i = 0; i < nanchors; i++) {
+        BIO_snprintf(name, sizeof(name), "Trust anchor %d", i);
+        x = make_cert(name, name, cakey, cakey, i + 2, 1);
+        if (!X509_STORE_add_cert(store, x))
+            fail();
+        X509_free(x);
+    }
+    x = make_cert("Root CA", "Root CA", cakey, cakey, 1, 1);
+    if (!X509_STORE_add_cert(store, x))
+        fail();
+    X509_free(x);
+    leaf = make_cert("Leaf", "Root CA", leafkey, cakey, 1, 0);
+
+    printf("%d trust anchors\n", nanchors + 1);
+    printf("%8s %12s %16s %16s\n", "threads", "seconds", "verifies/sec",
+           "per thread");
+    for (nthreads = 1; ; nthreads *= 2) {
+        if (nthreads > maxthreads)
+            nthreads = maxthreads;
+        elapsed = run_threads(nthreads);
+        if (elapsed <= 0)
+            elapsed = 1e-6;
+        printf("%8d %12.3f %16.0f %16.0f\n", nthreads, elapsed,
+               (double)count * nthreads / elapsed, count / elapsed);
+        if (nthreads == maxthreads)
+            break;
+    }
+
+    if (cachesize > 0)
+        printf("chain cache: %llu hits, %llu misses\n",
+               (unsigned long long)X509_STORE_get_chain_cache_hits(store),
+               (unsigned long long)X509_STORE_get_chain_cache_misses(store));
+
+    X509_free(leaf);
+    X509_STORE_free(store);
+    EVP_PKEY_free(cakey);
+    EVP_PKEY_free(leafkey);
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr,
+            "This tool is not supported on this platform for lack of POSIX1.2001 or thread support\n");
+    exit(EXIT_FAILURE);
+#endif
+}
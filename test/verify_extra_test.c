@@ -1,5 +1,5 @@
 /*
- * Copyright 2015-2022 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2015-2025 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -290,6 +290,138 @@ static int test_purpose_any(void)
     return do_test_purpose(X509_PURPOSE_ANY, 1);
 }
 
+static int verify_with_store(X509_STORE *store, X509 *eecert,
+                             STACK_OF(X509) *untrusted, int purpose,
+                             X509_STORE_CTX_verify_cb cb, int *chain_len)
+{
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    int ret = -1;
+
+    if (TEST_ptr(ctx)
+            && TEST_true(X509_STORE_CTX_init(ctx, store, eecert, untrusted))
+            && TEST_true(X509_STORE_CTX_set_purpose(ctx, purpose))) {
+        if (cb != NULL)
+            X509_STORE_CTX_set_verify_cb(ctx, cb);
+        ret = X509_verify_cert(ctx);
+        if (chain_len != NULL)
+            *chain_len = sk_X509_num(X509_STORE_CTX_get0_chain(ctx));
+    }
+    X509_STORE_CTX_free(ctx);
+    return ret;
+}
+
+static int verify_cb_accept(int ok, X509_STORE_CTX *ctx)
+{
+    return ok;
+}
+
+static int test_chain_cache(void)
+{
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *untrcert = load_cert_from_file(ca_cert);
+    X509 *trcert = load_cert_from_file(sroot_cert);
+    X509 *other = load_cert_from_file(root_f);
+    STACK_OF(X509) *untrusted = sk_X509_new_null();
+    X509_STORE *store = X509_STORE_new();
+    int len = 0, testresult = 0;
+
+    if (!TEST_ptr(eecert)
+            || !TEST_ptr(untrcert)
+            || !TEST_ptr(trcert)
+            || !TEST_ptr(other)
+            || !TEST_ptr(untrusted)
+            || !TEST_ptr(store)
+            || !TEST_true(X509_STORE_add_cert(store, trcert))
+            || !TEST_true(sk_X509_push(untrusted, untrcert)))
+        goto err;
+    untrcert = NULL;
+
+    /* Disabled by default */
+    if (!TEST_size_t_eq(X509_STORE_get_chain_cache_size(store), 0)
+            || !TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                              X509_PURPOSE_SSL_SERVER,
+                                              NULL, NULL), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_misses(store), 0)
+            || !TEST_true(X509_STORE_set_chain_cache_size(store, 16))
+            || !TEST_size_t_eq(X509_STORE_get_chain_cache_size(store), 16))
+        goto err;
+
+    /* The first verification fills the cache, the second one hits */
+    if (!TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                       X509_PURPOSE_SSL_SERVER, NULL, NULL), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_misses(store), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_hits(store), 0)
+            || !TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                              X509_PURPOSE_SSL_SERVER,
+                                              NULL, &len), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_hits(store), 1)
+            || !TEST_int_eq(len, 3))
+        goto err;
+
+    /* Other parameters or untrusted certs miss, failures are not cached */
+    if (!TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                       X509_PURPOSE_SSL_CLIENT, NULL, NULL), 0)
+            || !TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                              X509_PURPOSE_SSL_CLIENT,
+                                              NULL, NULL), 0)
+            || !TEST_int_eq(verify_with_store(store, eecert, NULL,
+                                              X509_PURPOSE_SSL_SERVER,
+                                              NULL, NULL), 0)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_misses(store), 4)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_hits(store), 1))
+        goto err;
+
+    /* Verifications with a callback do not use the cache */
+    if (!TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                       X509_PURPOSE_SSL_SERVER,
+                                       verify_cb_accept, NULL), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_misses(store), 4)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_hits(store), 1))
+        goto err;
+
+    /* Neither do verifications which check policies */
+    if (!TEST_true(X509_STORE_set_flags(store, X509_V_FLAG_POLICY_CHECK))
+            || !TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                              X509_PURPOSE_SSL_SERVER,
+                                              NULL, NULL), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_misses(store), 4)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_hits(store), 1)
+            || !TEST_true(X509_VERIFY_PARAM_clear_flags(X509_STORE_get0_param(store),
+                                                        X509_V_FLAG_POLICY_CHECK)))
+        goto err;
+
+    /* Adding to the store invalidates the cache */
+    if (!TEST_true(X509_STORE_add_cert(store, other))
+            || !TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                              X509_PURPOSE_SSL_SERVER,
+                                              NULL, NULL), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_misses(store), 5)
+            || !TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                              X509_PURPOSE_SSL_SERVER,
+                                              NULL, NULL), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_hits(store), 2))
+        goto err;
+
+    if (!TEST_true(X509_STORE_set_chain_cache_size(store, 0))
+            || !TEST_size_t_eq(X509_STORE_get_chain_cache_size(store), 0)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_hits(store), 0)
+            || !TEST_int_eq(verify_with_store(store, eecert, untrusted,
+                                              X509_PURPOSE_SSL_SERVER,
+                                              NULL, NULL), 1)
+            || !TEST_uint64_t_eq(X509_STORE_get_chain_cache_misses(store), 0))
+        goto err;
+
+    testresult = 1;
+ err:
+    OSSL_STACK_OF_X509_free(untrusted);
+    X509_STORE_free(store);
+    X509_free(eecert);
+    X509_free(untrcert);
+    X509_free(trcert);
+    X509_free(other);
+    return testresult;
+}
+
 OPT_TEST_DECLARE_USAGE("certs-dir\n")
 
 int setup_tests(void)
@@ -322,6 +454,7 @@ int setup_tests(void)
     ADD_TEST(test_purpose_ssl_client);
     ADD_TEST(test_purpose_ssl_server);
     ADD_TEST(test_purpose_any);
+    ADD_TEST(test_chain_cache);
     return 1;
  err:
     cleanup_tests();
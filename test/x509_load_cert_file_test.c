@@ -6,13 +6,25 @@
  */
 
 #include <stdio.h>
+#include <time.h>
+#ifndef OPENSSL_NO_POSIX_IO
+# include <sys/types.h>
+# ifdef _WIN32
+#  include <sys/utime.h>
+# else
+#  include <utime.h>
+# endif
+#endif
+#include <openssl/crypto.h>
 #include <openssl/err.h>
+#include <openssl/pem.h>
 #include <openssl/x509_vfy.h>
 
 #include "testutil.h"
 
 static const char *chain;
 static const char *crl;
+static const char *hashdir;
 
 static int test_load_cert_file(void)
 {
@@ -49,7 +61,173 @@ err:
     return ret;
 }
 
-OPT_TEST_DECLARE_USAGE("cert.pem [crl.pem]\n")
+/*
+ * Objects pushed onto the stack returned by X509_STORE_get0_objects() must be
+ * found by lookups in the store just like added ones
+ */
+static int test_get0_objects_push(void)
+{
+    int ret = 0;
+    X509_STORE *store = NULL, *other = NULL;
+    X509_LOOKUP *lookup = NULL;
+    X509_STORE_CTX *ctx = NULL;
+    STACK_OF(X509) *certs = NULL, *found = NULL;
+    X509_OBJECT *obj = NULL;
+    X509 *x;
+
+    if (!TEST_ptr(other = X509_STORE_new())
+        || !TEST_ptr(lookup = X509_STORE_add_lookup(other, X509_LOOKUP_file()))
+        || !TEST_true(X509_load_cert_file(lookup, chain, X509_FILETYPE_PEM))
+        || !TEST_ptr(certs = X509_STORE_get1_all_certs(other))
+        || !TEST_int_gt(sk_X509_num(certs), 1))
+        goto err;
+
+    if (!TEST_ptr(store = X509_STORE_new())
+        || !TEST_true(X509_STORE_add_cert(store, sk_X509_value(certs, 0)))
+        || !TEST_ptr(ctx = X509_STORE_CTX_new())
+        || !TEST_true(X509_STORE_CTX_init(ctx, store, NULL, NULL)))
+        goto err;
+
+    x = sk_X509_value(certs, 1);
+    if (!TEST_ptr(obj = X509_OBJECT_new())
+        || !TEST_true(X509_OBJECT_set1_X509(obj, x))
+        || !TEST_true(sk_X509_OBJECT_push(X509_STORE_get0_objects(store), obj)))
+        goto err;
+    obj = NULL;
+
+    if (!TEST_ptr(found = X509_STORE_CTX_get1_certs(ctx,
+                                                    X509_get_subject_name(x)))
+        || !TEST_int_eq(sk_X509_num(found), 1)
+        || !TEST_int_eq(X509_cmp(sk_X509_value(found, 0), x), 0))
+        goto err;
+    OSSL_STACK_OF_X509_free(found);
+    found = NULL;
+
+    /* Objects added in the usual way are still found as well */
+    x = sk_X509_value(certs, 0);
+    if (!TEST_ptr(found = X509_STORE_CTX_get1_certs(ctx,
+                                                    X509_get_subject_name(x)))
+        || !TEST_int_eq(sk_X509_num(found), 1))
+        goto err;
+
+    ret = 1;
+
+err:
+    X509_OBJECT_free(obj);
+    X509_STORE_CTX_free(ctx);
+    OSSL_STACK_OF_X509_free(found);
+    OSSL_STACK_OF_X509_free(certs);
+    X509_STORE_free(store);
+    X509_STORE_free(other);
+    return ret;
+}
+
+#ifndef OPENSSL_NO_POSIX_IO
+/* Writes |x| to |dir| under the name which X509_LOOKUP_hash_dir() expects */
+static int write_hashed_cert(const char *dir, X509 *x)
+{
+    char path[1024];
+    BIO *out;
+    int ok = 0;
+
+    BIO_snprintf(path, sizeof(path), "%s/%08lx.0", dir,
+                 X509_NAME_hash_ex(X509_get_subject_name(x), NULL, NULL, NULL));
+    if (TEST_ptr(out = BIO_new_file(path, "w")))
+        ok = TEST_true(PEM_write_bio_X509(out, x));
+    BIO_free(out);
+    return ok;
+}
+
+/*
+ * Sets the modification time of |dir| explicitly, so that whether it changed
+ * doesn't depend on the timestamp resolution of the file system.
+ */
+static int set_dir_mtime(const char *dir, time_t mtime)
+{
+    struct utimbuf times;
+
+    times.actime = times.modtime = mtime;
+    return TEST_int_eq(utime(dir, &times), 0);
+}
+
+static int test_preload_dir(void)
+{
+    int ret = 0, i;
+    X509_STORE *store = NULL;
+    X509_STORE_CTX *ctx = NULL;
+    X509_LOOKUP *lookup = NULL;
+    X509_OBJECT *obj = NULL;
+    STACK_OF(X509) *certs = NULL, *loaded = NULL;
+    time_t start = time(NULL), preloaded;
+
+    /* Get the certificates of the chain file, to spread them over files */
+    if (!TEST_ptr(store = X509_STORE_new())
+        || !TEST_ptr(lookup = X509_STORE_add_lookup(store, X509_LOOKUP_file()))
+        || !TEST_true(X509_load_cert_file(lookup, chain, X509_FILETYPE_PEM))
+        || !TEST_ptr(certs = X509_STORE_get1_all_certs(store))
+        || !TEST_int_eq(sk_X509_num(certs), 4))
+        goto err;
+    X509_STORE_free(store);
+    store = NULL;
+
+    for (i = 0; i < 3; i++)
+        if (!write_hashed_cert(hashdir, sk_X509_value(certs, i)))
+            goto err;
+    if (!set_dir_mtime(hashdir, start - 20))
+        goto err;
+
+    if (!TEST_ptr(store = X509_STORE_new())
+        || !TEST_ptr(lookup = X509_STORE_add_lookup(store,
+                                                    X509_LOOKUP_hash_dir()))
+        || !TEST_true(X509_LOOKUP_add_dir(lookup, hashdir, X509_FILETYPE_PEM)))
+        goto err;
+
+    /* Errors queued before preloading are kept */
+    ERR_raise(ERR_LIB_X509, ERR_R_PASSED_INVALID_ARGUMENT);
+    if (!TEST_true(X509_LOOKUP_preload_dir(lookup))
+        || !TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                        ERR_R_PASSED_INVALID_ARGUMENT)
+        || !TEST_ptr(loaded = X509_STORE_get1_all_certs(store))
+        || !TEST_int_eq(sk_X509_num(loaded), 3))
+        goto err;
+    ERR_clear_error();
+    preloaded = time(NULL);
+
+    /*
+     * A file added after the directory was preloaded is found once the
+     * directory is checked again for changes, which happens at most once
+     * a second.
+     */
+    if (!write_hashed_cert(hashdir, sk_X509_value(certs, 3))
+        || !set_dir_mtime(hashdir, start - 10))
+        goto err;
+    while (time(NULL) <= preloaded)
+        OSSL_sleep(50);
+    if (!TEST_ptr(ctx = X509_STORE_CTX_new())
+        || !TEST_true(X509_STORE_CTX_init(ctx, store, NULL, NULL))
+        || !TEST_ptr(obj = X509_STORE_CTX_get_obj_by_subject(ctx, X509_LU_X509,
+                             X509_get_subject_name(sk_X509_value(certs, 3))))
+        || !TEST_int_eq(X509_cmp(X509_OBJECT_get0_X509(obj),
+                                 sk_X509_value(certs, 3)), 0))
+        goto err;
+    OSSL_STACK_OF_X509_free(loaded);
+    if (!TEST_ptr(loaded = X509_STORE_get1_all_certs(store))
+        || !TEST_int_eq(sk_X509_num(loaded), 4))
+        goto err;
+
+    ret = 1;
+
+err:
+    X509_OBJECT_free(obj);
+    X509_STORE_CTX_free(ctx);
+    OSSL_STACK_OF_X509_free(certs);
+    OSSL_STACK_OF_X509_free(loaded);
+    X509_STORE_free(store);
+    return ret;
+}
+#endif
+
+OPT_TEST_DECLARE_USAGE("cert.pem [crl.pem [hashdir]]\n")
 
 int setup_tests(void)
 {
@@ -63,7 +241,13 @@ int setup_tests(void)
         return 0;
 
     crl = test_get_argument(1);
+    hashdir = test_get_argument(2);
 
     ADD_TEST(test_load_cert_file);
+    ADD_TEST(test_get0_objects_push);
+#ifndef OPENSSL_NO_POSIX_IO
+    if (hashdir != NULL)
+        ADD_TEST(test_preload_dir);
+#endif
     return 1;
 }